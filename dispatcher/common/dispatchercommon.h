@@ -17,6 +17,7 @@
 #include "jf_err.h"
 #include "jf_messaging.h"
 #include "jf_hlisthead.h"
+#include "jf_queue.h"
 
 /* --- constant definitions --------------------------------------------------------------------- */
 
@@ -44,6 +45,8 @@ typedef struct
     /**Reference number*/
     olint_t dm_nRef;
     u16 dm_u16Reserved[3];
+    /**Link in the message queue of dispatcher daemon.*/
+    jf_queue_link_t dm_jqlMsgQueue;
     /**The message size*/
     olsize_t dm_sMsg;
     /**The start of the message*/
@@ -79,7 +79,8 @@ typedef struct
 
     jf_mutex_t id_jmMsgLock;
     jf_sem_t id_jsMsgSem;
-    jf_queue_t id_jqMsgQueue;
+    /**The message queue, the link is in the message so no memory is allocated for enqueue.*/
+    jf_iqueue_t id_jiqMsgQueue;
     
 } internal_dispatcher_t;
 
@@ -98,6 +99,24 @@ static jf_linklist_t ls_jlServConfig;
 
 /* --- private routine section ------------------------------------------------------------------ */
 
+/** Dequeue dispatcher message.
+ *
+ *  @return The message, NULL if the queue is empty.
+ */
+static dispatcher_msg_t * _dequeueDispatcherMsg(internal_dispatcher_t * pid)
+{
+    jf_queue_link_t * pjql = NULL;
+
+    jf_mutex_acquire(&pid->id_jmMsgLock);
+    pjql = jf_iqueue_dequeue(&pid->id_jiqMsgQueue);
+    jf_mutex_release(&pid->id_jmMsgLock);
+
+    if (pjql == NULL)
+        return NULL;
+
+    return jf_iqueue_getEntry(pjql, dispatcher_msg_t, dm_jqlMsgQueue);
+}
+
 /** Queue dispatcher message.
  */
 static u32 _fnDispatcherQueueServServerMsg(u8 * pu8Msg, olsize_t sMsg)
@@ -116,7 +135,7 @@ static u32 _fnDispatcherQueueServServerMsg(u8 * pu8Msg, olsize_t sMsg)
     {
         /*Add the message to the queue.*/
         jf_mutex_acquire(&pid->id_jmMsgLock);
-        u32Ret = jf_queue_enqueue(&pid->id_jqMsgQueue, pdm);
+        jf_iqueue_enqueue(&pid->id_jiqMsgQueue, &pdm->dm_jqlMsgQueue);
         jf_mutex_release(&pid->id_jmMsgLock);
     }
 
@@ -153,9 +172,7 @@ static u32 _dispatchMsg(internal_dispatcher_t * pid)
     u32 u32Ret = JF_ERR_NO_ERROR;
     dispatcher_msg_t * pdm = NULL;
 
-    jf_mutex_acquire(&pid->id_jmMsgLock);
-    pdm = jf_queue_dequeue(&pid->id_jqMsgQueue);
-    jf_mutex_release(&pid->id_jmMsgLock);
+    pdm = _dequeueDispatcherMsg(pid);
 
     while ((pdm != NULL) && (u32Ret == JF_ERR_NO_ERROR))
     {
@@ -172,11 +189,7 @@ static u32 _dispatchMsg(internal_dispatcher_t * pid)
 
         /*Get the next message.*/
         if (u32Ret == JF_ERR_NO_ERROR)
-        {
-            jf_mutex_acquire(&pid->id_jmMsgLock);
-            pdm = jf_queue_dequeue(&pid->id_jqMsgQueue);
-            jf_mutex_release(&pid->id_jmMsgLock);
-        }
+            pdm = _dequeueDispatcherMsg(pid);
     }
 
     return u32Ret;
@@ -242,6 +255,7 @@ u32 initDispatcher(dispatcher_param_t * pdp)
     ol_bzero(pid, sizeof(internal_dispatcher_t));
 
     pid->id_pstrConfigDir = pdp->dp_pstrConfigDir;
+    jf_iqueue_init(&pid->id_jiqMsgQueue);
     jf_linklist_init(&ls_jlServConfig);
 
     /*Change the working directory.*/
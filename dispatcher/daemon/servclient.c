@@ -257,6 +257,10 @@ static u32 _dispatchMsgToServ(dispatcher_serv_client_t * pdsc, dispatcher_msg_t
     /*Send the message to service.*/
     u32Ret = dispatcher_xfer_sendMsg(pdsc->dsc_pdxXfer, pdm);
 
+    /*The message is not queued, release the reference.*/
+    if (u32Ret != JF_ERR_NO_ERROR)
+        decDispatcherMsgRef(pdm);
+
     return u32Ret;
 }
 
@@ -463,6 +467,8 @@ u32 createDispatcherServClients(
         jjccp.jjccp_pstrName = DISPATCHER_SUBSCRIBED_MSG_CACHE;
         jjccp.jjccp_sObj = sizeof(dispatcher_subscribed_msg_t);
         JF_FLAG_SET(jjccp.jjccp_jfCache, JF_JIUKUN_CACHE_CREATE_FLAG_ZERO);
+        /*The entry is looked up by message id for every message, keep it in one cache line.*/
+        JF_FLAG_SET(jjccp.jjccp_jfCache, JF_JIUKUN_CACHE_CREATE_FLAG_HWCACHE_ALIGN);
 
         u32Ret = jf_jiukun_createCache(&ls_pjjcSubscribedMsg, &jjccp);
     }
@@ -234,6 +234,10 @@ u32 sendDispatcherMessagingMsg(dispatcher_msg_t * pdm)
     /*Send the message to dispatcher daemon.*/
     u32Ret = dispatcher_xfer_sendMsg(pdmc->dmc_pdxXfer, pdm);
 
+    /*The message is not queued, free it.*/
+    if (u32Ret != JF_ERR_NO_ERROR)
+        freeDispatcherMsg(&pdm);
+
     return u32Ret;
 }
 
@@ -33,6 +33,10 @@
  */
 #define DISPATCHER_XFER_INITIAL_BUFFER_SIZE            (2048)
 
+/** The default maximum number of message in queue if it's not specified.
+ */
+#define DISPATCHER_XFER_DEFAULT_MAX_NUM_MSG            (64)
+
 /** Define the internal dispatcher xfer data type.
  */
 typedef struct internal_dispatcher_xfer
@@ -47,8 +51,8 @@ typedef struct internal_dispatcher_xfer
 
     /**Mutex lock for the message queue.*/
     jf_mutex_t idx_jmMsg;
-    /**Message queue.*/
-    jf_queue_t idx_jqMsg;
+    /**Message queue, the number of slots is decided by the maximum number of message.*/
+    jf_ringqueue_t idx_jrqMsg;
     /**xfer is paused if it's TRUE.*/
     boolean_t idx_bPause;
     u8 idx_u8Reserved[7];
@@ -76,8 +80,8 @@ static u32 _enqueueDispatcherXferMsgToQueue(
 
     jf_mutex_acquire(&pidx->idx_jmMsg);
     /*If the request queue is empty, chain should be waken up.*/
-    *pbWakeup = jf_queue_isEmpty(&pidx->idx_jqMsg);
-    jf_queue_enqueue(&pidx->idx_jqMsg, pdm);
+    *pbWakeup = jf_ringqueue_isEmpty(&pidx->idx_jrqMsg);
+    u32Ret = jf_ringqueue_enqueue(&pidx->idx_jrqMsg, pdm);
     jf_mutex_release(&pidx->idx_jmMsg);
 
     return u32Ret;
@@ -88,7 +92,7 @@ static dispatcher_msg_t * _dequeueDispatcherXferMsgFromQueue(internal_dispatcher
     dispatcher_msg_t * pdm = NULL;
 
     jf_mutex_acquire(&pidx->idx_jmMsg);
-    pdm = jf_queue_dequeue(&pidx->idx_jqMsg);
+    pdm = jf_ringqueue_dequeue(&pidx->idx_jrqMsg);
     jf_mutex_release(&pidx->idx_jmMsg);
 
     return pdm;
@@ -99,7 +103,7 @@ static dispatcher_msg_t * _peekDispatcherXferMsgFromQueue(internal_dispatcher_xf
     dispatcher_msg_t * pdm = NULL;
 
     jf_mutex_acquire(&pidx->idx_jmMsg);
-    pdm = jf_queue_peek(&pidx->idx_jqMsg);
+    pdm = jf_ringqueue_peek(&pidx->idx_jrqMsg);
     jf_mutex_release(&pidx->idx_jmMsg);
 
     return pdm;
@@ -186,7 +190,7 @@ u32 dispatcher_xfer_destroy(dispatcher_xfer_t ** ppXfer)
         destroyDispatcherXferObjectPool(&pidx->idx_pdxopPool);
 
     /*Finalize the message queue and free all the message.*/
-    jf_queue_finiQueueAndData(&pidx->idx_jqMsg, fnFreeDispatcherMsg);
+    jf_ringqueue_finiQueueAndData(&pidx->idx_jrqMsg, fnFreeDispatcherMsg);
     jf_mutex_fini(&pidx->idx_jmMsg);
 
     jf_jiukun_freeMemory((void **)ppXfer);
@@ -217,8 +221,13 @@ u32 dispatcher_xfer_create(
         pidx->idx_u32MaxNumMsg = pdxcp->dxcp_u32MaxNumMsg;
 
         jf_mutex_init(&pidx->idx_jmMsg);
-        jf_queue_init(&pidx->idx_jqMsg);
+        u32Ret = jf_ringqueue_init(
+            &pidx->idx_jrqMsg, (pidx->idx_u32MaxNumMsg > 0) ?
+            pidx->idx_u32MaxNumMsg : DISPATCHER_XFER_DEFAULT_MAX_NUM_MSG);
+    }
 
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
         /*Add the oject header to network chain.*/
         u32Ret = jf_network_appendToChain(pjnc, pidx);
     }
@@ -303,12 +312,12 @@ u32 dispatcher_xfer_clearMsgQueue(dispatcher_xfer_t * pXfer)
     /*TODO: delete the message in the xfer object as the message is going to be destroyed.*/
 
     jf_mutex_acquire(&pidx->idx_jmMsg);
-    pdm = jf_queue_dequeue(&pidx->idx_jqMsg);
+    pdm = jf_ringqueue_dequeue(&pidx->idx_jrqMsg);
     while (pdm != NULL)
     {
         freeDispatcherMsg(&pdm);
 
-        pdm = jf_queue_dequeue(&pidx->idx_jqMsg);
+        pdm = jf_ringqueue_dequeue(&pidx->idx_jrqMsg);
     }
     jf_mutex_release(&pidx->idx_jmMsg);
 
@@ -52,7 +52,7 @@ typedef struct
 {
     /**Maximum message size.*/
     olsize_t dxcp_sMaxMsg;
-    /**Maximum number of message.*/
+    /**Maximum number of message in queue, a default number is used if it's 0.*/
     u32 dxcp_u32MaxNumMsg;
     /**The address of remote server.*/
     jf_ipaddr_t * dxcp_pjiRemote;
@@ -84,6 +84,8 @@ DISPATCHERXFERAPI u32 DISPATCHERXFERCALL dispatcher_xfer_create(
  *  @param pdm [in] The message to send.
  *
  *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ *  @retval JF_ERR_BUFFER_IS_FULL The message queue is full, the message is not queued.
  */
 DISPATCHERXFERAPI u32 DISPATCHERXFERCALL dispatcher_xfer_sendMsg(
     dispatcher_xfer_t * pXfer, dispatcher_msg_t * pdm);
@@ -30,6 +30,57 @@
 
 /* --- private routine section ------------------------------------------------------------------ */
 
+/** Allocate memory for the packet header, the memory is from arena if the packet header is
+ *  allocated from arena.
+ */
+static u32 _allocHttpparserMemory(
+    jf_httpparser_packet_header_t * pjhph, void ** pptr, olsize_t size)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+
+    if (pjhph->jhph_pjjaArena != NULL)
+        u32Ret = jf_jiukun_allocArenaMemory(pjhph->jhph_pjjaArena, pptr, size);
+    else
+        u32Ret = jf_jiukun_allocMemory(pptr, size);
+
+    return u32Ret;
+}
+
+/** Free memory of the packet header, nothing is done if the memory is from arena.
+ */
+static void _freeHttpparserMemory(jf_httpparser_packet_header_t * pjhph, void ** pptr)
+{
+    if (pjhph->jhph_pjjaArena != NULL)
+        *pptr = NULL;
+    else
+        jf_jiukun_freeMemory(pptr);
+}
+
+static u32 _duplicateHttpparserString(
+    jf_httpparser_packet_header_t * pjhph, olchar_t ** ppstrDest, const olchar_t * pstrSource,
+    const olsize_t sSource)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    olchar_t * pstr = NULL;
+
+    if (pjhph->jhph_pjjaArena == NULL)
+        return jf_string_duplicateWithLen(ppstrDest, pstrSource, sSource);
+
+    *ppstrDest = NULL;
+    if (sSource > 0)
+    {
+        u32Ret = jf_jiukun_allocArenaMemory(pjhph->jhph_pjjaArena, (void **)&pstr, sSource + 1);
+        if (u32Ret == JF_ERR_NO_ERROR)
+        {
+            ol_memcpy(pstr, pstrSource, sSource);
+            pstr[sSource] = '\0';
+            *ppstrDest = pstr;
+        }
+    }
+
+    return u32Ret;
+}
+
 static u32 _parseHttpStartLine(
     jf_httpparser_packet_header_t * retval, jf_string_parse_result_field_t * field)
 {
@@ -146,7 +197,8 @@ static u32 _parseHttpHeaderLine(
         }
 
         /*Instantiate a new header entry for each token.*/
-        u32Ret = jf_jiukun_allocMemory((void **)&node, sizeof(jf_httpparser_packet_header_field_t));
+        u32Ret = _allocHttpparserMemory(
+            retval, (void **)&node, sizeof(jf_httpparser_packet_header_field_t));
         if (u32Ret == JF_ERR_NO_ERROR)
         {
             ol_bzero(node, sizeof(jf_httpparser_packet_header_field_t));
@@ -164,7 +216,7 @@ static u32 _parseHttpHeaderLine(
             }
             if ((node->jhphf_pstrName == NULL) || (node->jhphf_sName == 0))
             {
-                jf_jiukun_freeMemory((void **)&node);
+                _freeHttpparserMemory(retval, (void **)&node);
                 u32Ret = JF_ERR_INVALID_HTTP_HEADER_LINE;
                 break;
             }
@@ -228,6 +280,13 @@ u32 jf_httpparser_destroyPacketHeader(jf_httpparser_packet_header_t ** ppHeader)
     jf_httpparser_packet_header_field_t *node = packet->jhph_pjhphfFirst;
     jf_httpparser_packet_header_field_t *nextnode;
 
+    if (packet->jhph_pjjaArena != NULL)
+    {
+        /*All memory is from arena, it's released when the arena is reset or destroyed.*/
+        *ppHeader = NULL;
+        return u32Ret;
+    }
+
     /*Iterate through all the headers.*/
     while (node != NULL)
     {
@@ -401,16 +460,29 @@ olint_t jf_httpparser_unescapeHttpData(olchar_t * data)
 
 u32 jf_httpparser_parsePacketHeader(
     jf_httpparser_packet_header_t ** ppHeader, olchar_t * pstrBuf, olsize_t sOffset, olsize_t sBuf)
+{
+    return jf_httpparser_parsePacketHeaderInArena(ppHeader, pstrBuf, sOffset, sBuf, NULL);
+}
+
+u32 jf_httpparser_parsePacketHeaderInArena(
+    jf_httpparser_packet_header_t ** ppHeader, olchar_t * pstrBuf, olsize_t sOffset, olsize_t sBuf,
+    jf_jiukun_arena_t * pArena)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
     jf_httpparser_packet_header_t * retval = NULL;
     jf_string_parse_result_t * pPacket = NULL;
     jf_string_parse_result_field_t * headerline = NULL, * field = NULL;
 
-    u32Ret = jf_jiukun_allocMemory((void **)&retval, sizeof(jf_httpparser_packet_header_t));
+    if (pArena != NULL)
+        u32Ret = jf_jiukun_allocArenaMemory(
+            pArena, (void **)&retval, sizeof(jf_httpparser_packet_header_t));
+    else
+        u32Ret = jf_jiukun_allocMemory((void **)&retval, sizeof(jf_httpparser_packet_header_t));
+
     if (u32Ret == JF_ERR_NO_ERROR)
     {
         ol_bzero(retval, sizeof(jf_httpparser_packet_header_t));
+        retval->jhph_pjjaArena = pArena;
         /* All the headers are delineated with a CRLF, so we parse on that */
         u32Ret = jf_string_parse(&pPacket, pstrBuf, sOffset, sBuf, "\r\n", 2);
     }
@@ -702,7 +774,8 @@ u32 jf_httpparser_setVersion(
 
     /*Duplicate the string.*/
     if (pstrVersion != NULL)
-        u32Ret = jf_string_duplicateWithLen(&(pjhph->jhph_pstrVersion), pstrVersion, sVersion);
+        u32Ret = _duplicateHttpparserString(
+            pjhph, &(pjhph->jhph_pstrVersion), pstrVersion, sVersion);
 
     if (u32Ret == JF_ERR_NO_ERROR)
     {
@@ -723,8 +796,8 @@ u32 jf_httpparser_setStatusCode(
 
     if (pstrStatusData != NULL)
     {
-        u32Ret = jf_string_duplicateWithLen(
-            &(pjhph->jhph_pstrStatusData), pstrStatusData, sStatusData);
+        u32Ret = _duplicateHttpparserString(
+            pjhph, &(pjhph->jhph_pstrStatusData), pstrStatusData, sStatusData);
     }
 
     if (u32Ret == JF_ERR_NO_ERROR)
@@ -743,7 +816,8 @@ u32 jf_httpparser_setDirective(
     u32 u32Ret = JF_ERR_NO_ERROR;
 
     if (pstrDirective != NULL)
-        u32Ret = jf_string_duplicateWithLen(&pjhph->jhph_pstrDirective, pstrDirective, sDirective);
+        u32Ret = _duplicateHttpparserString(
+            pjhph, &pjhph->jhph_pstrDirective, pstrDirective, sDirective);
 
     if (u32Ret == JF_ERR_NO_ERROR)
     {
@@ -751,8 +825,8 @@ u32 jf_httpparser_setDirective(
 
         if (pstrDirectiveObj != NULL)
         {
-            u32Ret = jf_string_duplicateWithLen(
-                &pjhph->jhph_pstrDirectiveObj, pstrDirectiveObj, sDirectiveObj);
+            u32Ret = _duplicateHttpparserString(
+                pjhph, &pjhph->jhph_pstrDirectiveObj, pstrDirectiveObj, sDirectiveObj);
         }
 
         if (u32Ret == JF_ERR_NO_ERROR)
@@ -762,7 +836,7 @@ u32 jf_httpparser_setDirective(
         }
         else
         {
-            jf_string_free(&(pjhph->jhph_pstrDirective));
+            _freeHttpparserMemory(pjhph, (void **)&(pjhph->jhph_pstrDirective));
         }
     }
 
@@ -776,7 +850,11 @@ u32 jf_httpparser_setBody(
 
     if (bAlloc)
     {
-        u32Ret = jf_jiukun_cloneMemory((void **)&pjhph->jhph_pu8Body, pu8Body, sBody);
+        if (pjhph->jhph_pjjaArena != NULL)
+            u32Ret = jf_jiukun_cloneArenaMemory(
+                pjhph->jhph_pjjaArena, (void **)&pjhph->jhph_pu8Body, pu8Body, sBody);
+        else
+            u32Ret = jf_jiukun_cloneMemory((void **)&pjhph->jhph_pu8Body, pu8Body, sBody);
         if (u32Ret == JF_ERR_NO_ERROR)
         {
             pjhph->jhph_bAllocBody = bAlloc;
@@ -801,7 +879,8 @@ u32 jf_httpparser_addHeaderLine(
     jf_httpparser_packet_header_field_t * node = NULL;
     
     /*Create the header node.*/
-    u32Ret = jf_jiukun_allocMemory((void **)&node, sizeof(jf_httpparser_packet_header_field_t));
+    u32Ret = _allocHttpparserMemory(
+        pjhph, (void **)&node, sizeof(jf_httpparser_packet_header_field_t));
     if (u32Ret == JF_ERR_NO_ERROR)
     {
         ol_bzero(node, sizeof(jf_httpparser_packet_header_field_t));
@@ -815,12 +894,13 @@ u32 jf_httpparser_addHeaderLine(
         }
         else
         {
-            u32Ret = jf_string_duplicateWithLen(&(node->jhphf_pstrName), pstrName, sName);
+            u32Ret = _duplicateHttpparserString(pjhph, &(node->jhphf_pstrName), pstrName, sName);
             if (u32Ret == JF_ERR_NO_ERROR)
             {
                 node->jhphf_sName = sName;
 
-                u32Ret = jf_string_duplicateWithLen(&(node->jhphf_pstrData), pstrData, sData);
+                u32Ret = _duplicateHttpparserString(
+                    pjhph, &(node->jhphf_pstrData), pstrData, sData);
             }
 
             if (u32Ret == JF_ERR_NO_ERROR)
@@ -830,12 +910,12 @@ u32 jf_httpparser_addHeaderLine(
             else
             {
                 if (node->jhphf_pstrName != NULL)
-                    jf_string_free(&(node->jhphf_pstrName));
+                    _freeHttpparserMemory(pjhph, (void **)&(node->jhphf_pstrName));
 
                 if (node->jhphf_pstrData != NULL)
-                    jf_string_free(&(node->jhphf_pstrData));
+                    _freeHttpparserMemory(pjhph, (void **)&(node->jhphf_pstrData));
 
-                jf_jiukun_freeMemory((void **)&node);
+                _freeHttpparserMemory(pjhph, (void **)&node);
             }
         }
     }
@@ -0,0 +1,259 @@
+/**
+ *  @file arena.c
+ *
+ *  @brief The arena memory allocation system
+ *
+ *  @author Min Zhang
+ *
+ *  @note
+ *  -# Arena is a bump allocator for request-scoped allocation, the memory is carved from chunks
+ *   of jiukun pages and is never freed individually. All memory is released by resetting or
+ *   destroying the arena.
+ *  -# The arena data structure is placed at the beginning of the first chunk, the first chunk is
+ *   kept when the arena is reset.
+ *  -# The memory larger than the chunk is allocated with a dedicated chunk, the current chunk is
+ *   not changed in this case so the free space in it is not wasted.
+ *  -# Arena is not thread safe.
+ */
+
+/* --- standard C lib header files -------------------------------------------------------------- */
+#include <stdio.h>
+#include <string.h>
+
+/* --- internal header files -------------------------------------------------------------------- */
+#include "jf_basic.h"
+#include "jf_limit.h"
+#include "jf_err.h"
+#include "jf_jiukun.h"
+
+/* --- private data/data structure section ------------------------------------------------------ */
+
+/** The memory allocated from arena is aligned to the size of pointer.
+ */
+#define ARENA_ALIGN_SIZE           (BYTES_PER_POINTER)
+
+/** Maximum order of chunk, the same as the maximum memory size of jf_jiukun_allocMemory().
+ */
+#define MAX_ARENA_CHUNK_ORDER      (JF_JIUKUN_MAX_MEMORY_ORDER - JF_JIUKUN_PAGE_SHIFT)
+
+/** The chunk header, placed at the beginning of each chunk.
+ */
+typedef struct arena_chunk
+{
+    /**The next chunk.*/
+    struct arena_chunk * ac_pacNext;
+    /**Order of pages of the chunk.*/
+    u32 ac_u32Order;
+    u32 ac_u32Reserved;
+} arena_chunk_t;
+
+typedef struct internal_jiukun_arena
+{
+    /**The first chunk, the arena is in it.*/
+    arena_chunk_t * ija_pacFirst;
+    /**The chunks allocated after the first chunk, the latest is the head.*/
+    arena_chunk_t * ija_pacChunk;
+    /**The free memory in current chunk.*/
+    u8 * ija_pu8Free;
+    /**The end of current chunk.*/
+    u8 * ija_pu8End;
+    /**Order of pages for the chunk.*/
+    u32 ija_u32ChunkOrder;
+    u32 ija_u32Reserved;
+} internal_jiukun_arena_t;
+
+#define ARENA_CHUNK_HEADER_SIZE    ALIGN(sizeof(arena_chunk_t), ARENA_ALIGN_SIZE)
+
+#define ARENA_HEADER_SIZE          ALIGN(sizeof(internal_jiukun_arena_t), ARENA_ALIGN_SIZE)
+
+/* --- private routine section ------------------------------------------------------------------ */
+
+static u32 _allocArenaChunk(u32 u32Order, arena_chunk_t ** ppChunk)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    arena_chunk_t * pac = NULL;
+
+    u32Ret = jf_jiukun_allocPage((void **)&pac, u32Order, 0);
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        pac->ac_pacNext = NULL;
+        pac->ac_u32Order = u32Order;
+        *ppChunk = pac;
+    }
+
+    return u32Ret;
+}
+
+static void _freeArenaChunkList(arena_chunk_t * pac)
+{
+    arena_chunk_t * pNext = NULL;
+
+    while (pac != NULL)
+    {
+        pNext = pac->ac_pacNext;
+        jf_jiukun_freePage((void **)&pac);
+        pac = pNext;
+    }
+}
+
+/** Get the order of the chunk to hold the memory with the size.
+ */
+static u32 _getArenaChunkOrder(olsize_t size, u32 * pu32Order)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Order = 0;
+
+    while ((JF_JIUKUN_PAGE_SIZE << u32Order) < ARENA_CHUNK_HEADER_SIZE + size)
+        u32Order ++;
+
+    if (u32Order > MAX_ARENA_CHUNK_ORDER)
+        u32Ret = JF_ERR_UNSUPPORTED_MEMORY_SIZE;
+    else
+        *pu32Order = u32Order;
+
+    return u32Ret;
+}
+
+/** Allocate memory from a new chunk when the current chunk is full.
+ */
+static u32 _allocArenaMemoryFromNewChunk(
+    internal_jiukun_arena_t * pija, void ** pptr, olsize_t size)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    arena_chunk_t * pac = NULL;
+    u32 u32Order = pija->ija_u32ChunkOrder;
+
+    if (ARENA_CHUNK_HEADER_SIZE + size > (JF_JIUKUN_PAGE_SIZE << u32Order))
+        /*The memory is larger than the chunk, allocate a dedicated chunk.*/
+        u32Ret = _getArenaChunkOrder(size, &u32Order);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = _allocArenaChunk(u32Order, &pac);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        pac->ac_pacNext = pija->ija_pacChunk;
+        pija->ija_pacChunk = pac;
+
+        *pptr = (u8 *)pac + ARENA_CHUNK_HEADER_SIZE;
+
+        if (u32Order == pija->ija_u32ChunkOrder)
+        {
+            /*Switch to the new chunk.*/
+            pija->ija_pu8Free = (u8 *)*pptr + size;
+            pija->ija_pu8End = (u8 *)pac + (JF_JIUKUN_PAGE_SIZE << u32Order);
+        }
+    }
+
+    return u32Ret;
+}
+
+/* --- public routine section ------------------------------------------------------------------- */
+
+u32 jf_jiukun_createArena(
+    jf_jiukun_arena_t ** ppArena, jf_jiukun_arena_create_param_t * pjjacp)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_jiukun_arena_t * pija = NULL;
+    arena_chunk_t * pac = NULL;
+
+    assert((ppArena != NULL) && (pjjacp != NULL));
+
+    *ppArena = NULL;
+
+    if (pjjacp->jjacp_u8ChunkOrder > MAX_ARENA_CHUNK_ORDER)
+        u32Ret = JF_ERR_INVALID_PARAM;
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = _allocArenaChunk(pjjacp->jjacp_u8ChunkOrder, &pac);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        pija = (internal_jiukun_arena_t *)((u8 *)pac + ARENA_CHUNK_HEADER_SIZE);
+        ol_bzero(pija, sizeof(*pija));
+
+        pija->ija_pacFirst = pac;
+        pija->ija_u32ChunkOrder = pjjacp->jjacp_u8ChunkOrder;
+
+        jf_jiukun_resetArena(pija);
+
+        *ppArena = pija;
+    }
+
+    return u32Ret;
+}
+
+u32 jf_jiukun_destroyArena(jf_jiukun_arena_t ** ppArena)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_jiukun_arena_t * pija = NULL;
+    arena_chunk_t * pac = NULL;
+
+    assert((ppArena != NULL) && (*ppArena != NULL));
+
+    pija = (internal_jiukun_arena_t *)*ppArena;
+    *ppArena = NULL;
+
+    _freeArenaChunkList(pija->ija_pacChunk);
+
+    /*The arena is in the first chunk, it's invalid after the chunk is freed.*/
+    pac = pija->ija_pacFirst;
+    jf_jiukun_freePage((void **)&pac);
+
+    return u32Ret;
+}
+
+void jf_jiukun_resetArena(jf_jiukun_arena_t * pArena)
+{
+    internal_jiukun_arena_t * pija = (internal_jiukun_arena_t *)pArena;
+
+    assert(pArena != NULL);
+
+    _freeArenaChunkList(pija->ija_pacChunk);
+    pija->ija_pacChunk = NULL;
+
+    pija->ija_pu8Free = (u8 *)pija + ARENA_HEADER_SIZE;
+    pija->ija_pu8End = (u8 *)pija->ija_pacFirst + (JF_JIUKUN_PAGE_SIZE << pija->ija_u32ChunkOrder);
+}
+
+u32 jf_jiukun_allocArenaMemory(jf_jiukun_arena_t * pArena, void ** pptr, olsize_t size)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_jiukun_arena_t * pija = (internal_jiukun_arena_t *)pArena;
+
+    assert((pArena != NULL) && (pptr != NULL) && (size > 0));
+
+    size = ALIGN(size, ARENA_ALIGN_SIZE);
+
+    if ((olsize_t)(pija->ija_pu8End - pija->ija_pu8Free) >= size)
+    {
+        /*Fast path, bump the pointer in current chunk.*/
+        *pptr = pija->ija_pu8Free;
+        pija->ija_pu8Free += size;
+    }
+    else
+    {
+        *pptr = NULL;
+        u32Ret = _allocArenaMemoryFromNewChunk(pija, pptr, size);
+    }
+
+    return u32Ret;
+}
+
+u32 jf_jiukun_cloneArenaMemory(
+    jf_jiukun_arena_t * pArena, void ** pptr, const u8 * pu8Buffer, olsize_t size)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+
+    assert((pptr != NULL) && (pu8Buffer != NULL) && (size > 0));
+
+    u32Ret = jf_jiukun_allocArenaMemory(pArena, pptr, size);
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ol_memcpy(*pptr, pu8Buffer, size);
+    }
+
+    return u32Ret;
+}
+
+/*------------------------------------------------------------------------------------------------*/
@@ -6,14 +6,35 @@
  *  @author Min Zhang
  *
  *  @note
+ *  -# Each CPU has a try-lock page cache for page order 0 to 3. The pages are moved between the
+ *   page cache and the buddy free lists in batch with the global lock, allocation and free of page
+ *   in the cache only take the mutex of the page cache.
+ *  -# The page cache is not lock-free. Its mutex is acquired with try, it fails only if another
+ *   thread on the same CPU is using the page cache, the buddy free lists are used in this case.
+ *  -# The page in page cache is marked as allocated, so it's not coalesced with the buddy.
+ *  -# The free page block returned to OS is flagged, the flag is inherited by the halves when the
+ *   block is split and cleared when the block is allocated or coalesced. The block is not
+ *   returned again if it's flagged.
  *
  */
 
 /* --- standard C lib header files -------------------------------------------------------------- */
+#if defined(LINUX)
+    /*For sched_getcpu().*/
+    #define _GNU_SOURCE
+#endif
+
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 
+#if defined(LINUX)
+    #include <sched.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/syscall.h>
+#endif
+
 /* --- internal header files -------------------------------------------------------------------- */
 #include "jf_basic.h"
 #include "jf_limit.h"
@@ -48,15 +69,75 @@ typedef struct buddy_zone
 
     u8 * bz_pu8Pool;
     u8 * bz_pu8PoolEnd;
+
+    /** the mapping of the pool, NULL if the pool is from heap */
+    u8 * bz_pu8Map;
+    olsize_t bz_sMap;
+    /** the NUMA node of the pool */
+    u32 bz_u32Node;
+    u32 bz_u32Reserved;
 } buddy_zone_t;
 
 #define MAX_BUDDY_ZONES  20
 
+/** The size of huge page, the pool is aligned to it for transparent huge page.
+ */
+#define BUDDY_HUGE_PAGE_SIZE  (2 * 1024 * 1024)
+
+/** Maximum NUMA node supported by the node mask of mbind.
+ */
+#define BUDDY_MAX_NUMA_NODE   (64)
+
+/** Memory policy for mbind, prefer the specified node but fall back to other nodes.
+ */
+#define BUDDY_MPOL_PREFERRED  (1)
+
+/** Maximum page order for page cache.
+ */
+#define BUDDY_PAGE_CACHE_MAX_ORDER   (3)
+
+/** Maximum number of page cache, the CPU with larger id shares the page cache.
+ */
+#define MAX_BUDDY_PAGE_CACHES        (64)
+
+/** Number of pages moved between page cache and buddy free lists for order 0, the number is halved
+ *  for each higher order.
+ */
+#define BUDDY_PAGE_CACHE_BATCH       (8)
+
+/** The page cache is drained when the number of pages is larger than batch multiplied by it.
+ */
+#define BUDDY_PAGE_CACHE_HIGH_RATIO  (4)
+
+typedef struct
+{
+    /** page list, the latest freed page is the head */
+    jf_listhead_t bpl_jlPage;
+    /** number of pages in the list */
+    u32 bpl_u32Count;
+    /** number of pages moved in batch */
+    u32 bpl_u32Batch;
+    /** the high watermark to drain the list */
+    u32 bpl_u32High;
+    u32 bpl_u32Reserved;
+} buddy_page_list_t;
+
+/** The per-CPU try-lock page cache.
+ */
+typedef struct
+{
+    /** acquired with try in allocation and free, the caller falls back to buddy free lists */
+    jf_mutex_t bpc_jmLock;
+    buddy_page_list_t bpc_bplList[BUDDY_PAGE_CACHE_MAX_ORDER + 1];
+} buddy_page_cache_t;
+
 typedef struct
 {
     boolean_t ijb_bInitialized;
     boolean_t ijb_bNoGrow;
-    u8 ijb_u8Reserved[6];
+    boolean_t ijb_bHugePage;
+    boolean_t ijb_bNuma;
+    u8 ijb_u8Reserved[4];
 
     u32 ijb_u32MaxOrder;
     u32 ijb_u32Reserved[2];
@@ -64,6 +145,10 @@ typedef struct
     u32 ijb_u32NumOfZone;
     buddy_zone_t * ijb_pbzZone[MAX_BUDDY_ZONES];
 
+    /** number of page cache, 0 if page cache is disabled */
+    u32 ijb_u32NumOfPageCache;
+    buddy_page_cache_t * ijb_pbpcPageCache[MAX_BUDDY_PAGE_CACHES];
+
     jf_mutex_t ijb_jmLock;
 } internal_jiukun_buddy_t;
 
@@ -89,7 +174,8 @@ static inline ulong _getPageOrder(jiukun_page_t * page)
 }
 
 static jiukun_page_t * _expand(
-    buddy_zone_t * zone, jiukun_page_t * page, olint_t low, olint_t high, free_area_t * area)
+    buddy_zone_t * zone, jiukun_page_t * page, olint_t low, olint_t high, free_area_t * area,
+    boolean_t bReleased)
 {
     ulong size = 1 << high;
 
@@ -102,6 +188,8 @@ static jiukun_page_t * _expand(
         jf_listhead_add(&(area->fa_jlFree), &(page[size].jp_jlLru));
         area->fa_u32Free++;
         _setPageOrder(&page[size], high);
+        if (bReleased)
+            setJpReleased((&page[size]));
     }
 
     return page;
@@ -115,6 +203,7 @@ static jiukun_page_t * _rmqueue(buddy_zone_t * zone, u32 order)
     free_area_t * area;
     u32 current_order;
     jiukun_page_t * page;
+    boolean_t bReleased;
 
     for (current_order = order; current_order < zone->bz_u32MaxOrder; ++current_order)
     {
@@ -125,10 +214,12 @@ static jiukun_page_t * _rmqueue(buddy_zone_t * zone, u32 order)
         page = jf_listhead_getEntry(area->fa_jlFree.jl_pjlNext, jiukun_page_t, jp_jlLru);
         jf_listhead_del(&page->jp_jlLru);
         _clearPageOrder(page);
+        bReleased = isJpReleased(page);
+        clearJpReleased(page);
         area->fa_u32Free--;
         zone->bz_u32FreePages -= 1UL << order;
 
-        return _expand(zone, page, order, current_order, area);
+        return _expand(zone, page, order, current_order, area, bReleased);
     }
 
     return NULL;
@@ -188,6 +279,8 @@ static inline void _freeOnePage(
         area = zone->bz_faFreeArea + order;
         area->fa_u32Free--;
         _clearPageOrder(buddy);
+        /*Part of the coalesced block is in use, it's not released.*/
+        clearJpReleased(buddy);
         page = (buddy_idx > page_idx) ? page : buddy;
         page_idx = pageToIndex(page, zone->bz_papPage);
         order++;
@@ -209,6 +302,14 @@ static u32 _destroyBuddyZone(buddy_zone_t ** ppZone)
     if (pbz->bz_papPage != NULL)
         jf_mem_free((void **)&(pbz->bz_papPage));
 
+#if defined(LINUX)
+    if (pbz->bz_pu8Map != NULL)
+    {
+        munmap(pbz->bz_pu8Map, pbz->bz_sMap);
+        pbz->bz_pu8Pool = NULL;
+    }
+#endif
+
     if (pbz->bz_pu8Pool != NULL)
         jf_mem_free((void **)&(pbz->bz_pu8Pool));
 
@@ -230,19 +331,97 @@ static void _initBuddyPage(
 
 }
 
+/** Get the NUMA node of the CPU the caller is running on.
+ */
+static u32 _getCurrentNumaNode(void)
+{
+    u32 u32Node = 0;
+#if defined(LINUX)
+    u32 u32Cpu = 0;
+
+    if (syscall(SYS_getcpu, &u32Cpu, &u32Node, NULL) != 0)
+        u32Node = 0;
+#endif
+    return u32Node;
+}
+
+#if defined(LINUX)
+/** Map the pool with huge page or for NUMA node.
+ *
+ *  @note
+ *  -# Explicit huge page is tried first, if no huge page is reserved in system, map the pool with
+ *   normal page and advise the kernel to use transparent huge page.
+ *  -# The pool is bound to the node before it's touched, so the pages are allocated on that node.
+ */
+static u32 _mapBuddyZonePool(
+    internal_jiukun_buddy_t * piab, buddy_zone_t * pbz, olsize_t sPool)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u8 * pu8Map = MAP_FAILED;
+    ulong ulNodeMask = 0;
+
+    if (piab->ijb_bHugePage && ((sPool % BUDDY_HUGE_PAGE_SIZE) == 0))
+    {
+        pu8Map = mmap(
+            NULL, sPool, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (pu8Map != MAP_FAILED)
+        {
+            pbz->bz_pu8Map = pbz->bz_pu8Pool = pu8Map;
+            pbz->bz_sMap = sPool;
+        }
+    }
+
+    if (pu8Map == MAP_FAILED)
+    {
+        /*Map more memory so the pool can be aligned to huge page.*/
+        pbz->bz_sMap = piab->ijb_bHugePage ? sPool + BUDDY_HUGE_PAGE_SIZE : sPool;
+        pu8Map = mmap(
+            NULL, pbz->bz_sMap, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (pu8Map == MAP_FAILED)
+            u32Ret = JF_ERR_OUT_OF_MEMORY;
+    }
+
+    if ((u32Ret == JF_ERR_NO_ERROR) && (pbz->bz_pu8Map == NULL))
+    {
+        pbz->bz_pu8Map = pbz->bz_pu8Pool = pu8Map;
+
+        if (piab->ijb_bHugePage)
+        {
+            pbz->bz_pu8Pool = (u8 *)(((ulong)pu8Map + BUDDY_HUGE_PAGE_SIZE - 1) &
+                                     ~((ulong)BUDDY_HUGE_PAGE_SIZE - 1));
+            madvise(pbz->bz_pu8Pool, sPool, MADV_HUGEPAGE);
+        }
+    }
+
+    if ((u32Ret == JF_ERR_NO_ERROR) && piab->ijb_bNuma && (pbz->bz_u32Node < BUDDY_MAX_NUMA_NODE))
+    {
+        ulNodeMask = 1UL << pbz->bz_u32Node;
+        /*The pool still works without the policy, just log the error.*/
+        if (syscall(SYS_mbind, pbz->bz_pu8Pool, sPool, BUDDY_MPOL_PREFERRED, &ulNodeMask,
+                    BUDDY_MAX_NUMA_NODE, 0) != 0)
+            jf_logger_logErrMsg(
+                JF_ERR_OPERATION_FAIL, "bind jiukun zone to node %u", pbz->bz_u32Node);
+    }
+
+    return u32Ret;
+}
+#endif
+
 static u32 _createBuddyZone(
-    buddy_zone_t ** ppZone, u32 u32MaxOrder, u32 u32ZoneId)
+    internal_jiukun_buddy_t * piab, buddy_zone_t ** ppZone, u32 u32ZoneId, u32 u32Node)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
     buddy_zone_t * pbz = NULL;
     u32 u32Index;
+    u32 u32MaxOrder = piab->ijb_u32MaxOrder;
 
     jf_logger_logInfoMsg(
-        "create jiukun zone, order: %u, zoneid: %u", u32MaxOrder, u32ZoneId);
+        "create jiukun zone, order: %u, zoneid: %u, node: %u", u32MaxOrder, u32ZoneId, u32Node);
 
     u32Ret = jf_mem_calloc((void **)&pbz, sizeof(buddy_zone_t));
     if (u32Ret == JF_ERR_NO_ERROR)
     {
+        pbz->bz_u32Node = u32Node;
         pbz->bz_u32MaxOrder = u32MaxOrder;
         pbz->bz_u32NumOfPage = 1UL << (pbz->bz_u32MaxOrder - 1);
         pbz->bz_u32FreePages = pbz->bz_u32NumOfPage;
@@ -260,13 +439,20 @@ static u32 _createBuddyZone(
 
         pbz->bz_faFreeArea[pbz->bz_u32MaxOrder - 1].fa_u32Free = 1;
         _setPageOrder(pbz->bz_papPage, pbz->bz_u32MaxOrder - 1);
+        /*The pool is not touched, no physical memory is used.*/
+        setJpReleased((&pbz->bz_papPage[0]));
 
         jf_listhead_add(
             &(pbz->bz_faFreeArea[pbz->bz_u32MaxOrder - 1].fa_jlFree),
             &(pbz->bz_papPage[0].jp_jlLru));
 
-        u32Ret = jf_mem_alloc(
-            (void **)&(pbz->bz_pu8Pool), pbz->bz_u32NumOfPage * BUDDY_PAGE_SIZE);
+#if defined(LINUX)
+        if (piab->ijb_bHugePage || piab->ijb_bNuma)
+            u32Ret = _mapBuddyZonePool(piab, pbz, pbz->bz_u32NumOfPage * BUDDY_PAGE_SIZE);
+        else
+#endif
+            u32Ret = jf_mem_alloc(
+                (void **)&(pbz->bz_pu8Pool), pbz->bz_u32NumOfPage * BUDDY_PAGE_SIZE);
     }
 
     if (u32Ret == JF_ERR_NO_ERROR)
@@ -285,18 +471,21 @@ static u32 _createBuddyZone(
     return u32Ret;
 }
 
-static jiukun_page_t * _allocPages(
-    internal_jiukun_buddy_t * piab, u32 u32Order, jf_flag_t flag)
+/** Find the zone with least free pages left after allocation, the zone on the specified node is
+ *  preferred if bAnyNode is FALSE.
+ */
+static u32 _findBuddyZone(
+    internal_jiukun_buddy_t * piab, u32 u32Pages, u32 u32Node, boolean_t bAnyNode)
 {
-    u32 u32Ret = JF_ERR_NO_ERROR;
-    u32 u32Pages = 1UL << u32Order;
     u32 u32Index, u32Left = U32_MAX, u32Id = U32_MAX;
     buddy_zone_t * pbz;
-    jiukun_page_t * page;
 
     for (u32Index = 0; u32Index < piab->ijb_u32NumOfZone; u32Index ++)
     {
         pbz = piab->ijb_pbzZone[u32Index];
+        if ((! bAnyNode) && (pbz->bz_u32Node != u32Node))
+            continue;
+
         if ((pbz->bz_u32FreePages >= u32Pages) && (u32Left > pbz->bz_u32FreePages - u32Pages))
         {
             u32Left = pbz->bz_u32FreePages - u32Pages;
@@ -304,6 +493,22 @@ static jiukun_page_t * _allocPages(
         }
     }
 
+    return u32Id;
+}
+
+static jiukun_page_t * _allocPages(
+    internal_jiukun_buddy_t * piab, u32 u32Order, jf_flag_t flag)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Pages = 1UL << u32Order;
+    u32 u32Id = U32_MAX, u32Node = 0;
+    buddy_zone_t * pbz;
+    jiukun_page_t * page;
+
+    if (piab->ijb_bNuma)
+        u32Node = _getCurrentNumaNode();
+
+    u32Id = _findBuddyZone(piab, u32Pages, u32Node, ! piab->ijb_bNuma);
     if (u32Id != U32_MAX)
     {
         page = _rmqueue(piab->ijb_pbzZone[u32Id], u32Order);
@@ -313,12 +518,11 @@ static jiukun_page_t * _allocPages(
 
     /*maximum zone is reached*/
     if ((piab->ijb_u32NumOfZone == MAX_BUDDY_ZONES) || piab->ijb_bNoGrow)
-        return NULL;
+        u32Ret = JF_ERR_JIUKUN_OUT_OF_MEMORY;
 
     if (u32Ret == JF_ERR_NO_ERROR)
         u32Ret = _createBuddyZone(
-            &(piab->ijb_pbzZone[piab->ijb_u32NumOfZone]),
-            piab->ijb_u32MaxOrder, piab->ijb_u32NumOfZone);
+            piab, &(piab->ijb_pbzZone[piab->ijb_u32NumOfZone]), piab->ijb_u32NumOfZone, u32Node);
 
     if (u32Ret == JF_ERR_NO_ERROR)
     {
@@ -330,10 +534,324 @@ static jiukun_page_t * _allocPages(
             return page;
     }
 
+    /*fall back to the zones on other nodes*/
+    if (piab->ijb_bNuma)
+    {
+        u32Id = _findBuddyZone(piab, u32Pages, u32Node, TRUE);
+        if (u32Id != U32_MAX)
+            return _rmqueue(piab->ijb_pbzZone[u32Id], u32Order);
+    }
+
     return NULL;
 }
 
+/** Get the CPU the caller is running on.
+ */
+static u32 _getCurrentCpu(void)
+{
+    u32 u32Cpu = 0;
+#if defined(LINUX)
+    olint_t nCpu = sched_getcpu();
+
+    /*CPU 0 is valid, -1 is returned on error.*/
+    if (nCpu >= 0)
+        u32Cpu = (u32)nCpu;
+#elif defined(WINDOWS)
+    u32Cpu = (u32)GetCurrentProcessorNumber();
+#endif
+    return u32Cpu;
+}
+
+static u32 _getNumOfCpu(void)
+{
+    u32 u32Num = 1;
+#if defined(LINUX)
+    long lNum = sysconf(_SC_NPROCESSORS_CONF);
+
+    if (lNum > 0)
+        u32Num = (u32)lNum;
+#elif defined(WINDOWS)
+    SYSTEM_INFO si;
+
+    GetSystemInfo(&si);
+    u32Num = (u32)si.dwNumberOfProcessors;
+#endif
+    return u32Num;
+}
+
+/** Move pages from the buddy free lists to the page list, the page cache lock must be held.
+ */
+static void _fillBuddyPageList(
+    internal_jiukun_buddy_t * piab, buddy_page_list_t * pbpl, u32 u32Order, jf_flag_t flag)
+{
+    u32 u32Index;
+    jiukun_page_t * pap;
+
+    jf_mutex_acquire(&(piab->ijb_jmLock));
+
+    for (u32Index = 0; u32Index < pbpl->bpl_u32Batch; u32Index ++)
+    {
+        pap = _allocPages(piab, u32Order, flag);
+        if (pap == NULL)
+            break;
+
+        _setPageOrder(pap, u32Order);
+        setJpAllocated(pap);
+        setJpCached(pap);
+        jf_listhead_addTail(&(pbpl->bpl_jlPage), &(pap->jp_jlLru));
+        pbpl->bpl_u32Count ++;
+    }
+
+    jf_mutex_release(&(piab->ijb_jmLock));
+}
+
+/** Move pages from the tail of the page list to the buddy free lists, the page cache lock must be
+ *  held.
+ */
+static void _drainBuddyPageList(
+    internal_jiukun_buddy_t * piab, buddy_page_list_t * pbpl, u32 u32Count)
+{
+    jiukun_page_t * pap;
+
+    jf_mutex_acquire(&(piab->ijb_jmLock));
+
+    while ((u32Count > 0) && (pbpl->bpl_u32Count > 0))
+    {
+        pap = jf_listhead_getEntry(pbpl->bpl_jlPage.jl_pjlPrev, jiukun_page_t, jp_jlLru);
+        jf_listhead_del(&(pap->jp_jlLru));
+        pbpl->bpl_u32Count --;
+        u32Count --;
+
+        clearJpCached(pap);
+        _freeOnePage(piab->ijb_pbzZone[getJpZoneId(pap)], pap, getJpOrder(pap));
+    }
+
+    jf_mutex_release(&(piab->ijb_jmLock));
+}
+
+/** Return all pages in page caches to the buddy free lists.
+ */
+static void _drainBuddyPageCache(internal_jiukun_buddy_t * piab)
+{
+    u32 u32Index, u32Order;
+    buddy_page_cache_t * pbpc;
+    buddy_page_list_t * pbpl;
+
+    for (u32Index = 0; u32Index < piab->ijb_u32NumOfPageCache; u32Index ++)
+    {
+        pbpc = piab->ijb_pbpcPageCache[u32Index];
+
+        jf_mutex_acquire(&(pbpc->bpc_jmLock));
+        for (u32Order = 0; u32Order <= BUDDY_PAGE_CACHE_MAX_ORDER; u32Order ++)
+        {
+            pbpl = &(pbpc->bpc_bplList[u32Order]);
+            if (pbpl->bpl_u32Count > 0)
+                _drainBuddyPageList(piab, pbpl, pbpl->bpl_u32Count);
+        }
+        jf_mutex_release(&(pbpc->bpc_jmLock));
+    }
+}
+
+/** Try to allocate page from the page cache of current CPU, the mutex of the page cache is
+ *  acquired with try.
+ *
+ *  @return The page or NULL if the page cache is in use or no page is available.
+ */
+static jiukun_page_t * _tryAllocCachedPage(
+    internal_jiukun_buddy_t * piab, u32 u32Order, jf_flag_t flag)
+{
+    buddy_page_cache_t * pbpc;
+    buddy_page_list_t * pbpl;
+    jiukun_page_t * pap = NULL;
+
+    pbpc = piab->ijb_pbpcPageCache[_getCurrentCpu() % piab->ijb_u32NumOfPageCache];
+
+    if (jf_mutex_tryAcquire(&(pbpc->bpc_jmLock)) != JF_ERR_NO_ERROR)
+        return NULL;
+
+    pbpl = &(pbpc->bpc_bplList[u32Order]);
+    if (pbpl->bpl_u32Count == 0)
+        _fillBuddyPageList(piab, pbpl, u32Order, flag);
+
+    if (pbpl->bpl_u32Count > 0)
+    {
+        pap = jf_listhead_getEntry(pbpl->bpl_jlPage.jl_pjlNext, jiukun_page_t, jp_jlLru);
+        jf_listhead_del(&(pap->jp_jlLru));
+        pbpl->bpl_u32Count --;
+        clearJpCached(pap);
+    }
+
+    jf_mutex_release(&(pbpc->bpc_jmLock));
+
+    return pap;
+}
+
+/** Try to free page to the page cache of current CPU, the mutex of the page cache is acquired
+ *  with try.
+ *
+ *  @return TRUE if the page is freed to page cache.
+ */
+static boolean_t _tryFreeCachedPage(
+    internal_jiukun_buddy_t * piab, jiukun_page_t * pap, u32 u32Order)
+{
+    buddy_page_cache_t * pbpc;
+    buddy_page_list_t * pbpl;
+
+    pbpc = piab->ijb_pbpcPageCache[_getCurrentCpu() % piab->ijb_u32NumOfPageCache];
+
+    if (jf_mutex_tryAcquire(&(pbpc->bpc_jmLock)) != JF_ERR_NO_ERROR)
+        return FALSE;
+
+    pbpl = &(pbpc->bpc_bplList[u32Order]);
+
+    /*The page is hot in CPU cache, add it to the head.*/
+    setJpCached(pap);
+    jf_listhead_add(&(pbpl->bpl_jlPage), &(pap->jp_jlLru));
+    pbpl->bpl_u32Count ++;
+
+    if (pbpl->bpl_u32Count > pbpl->bpl_u32High)
+        _drainBuddyPageList(piab, pbpl, pbpl->bpl_u32Batch);
+
+    jf_mutex_release(&(pbpc->bpc_jmLock));
+
+    return TRUE;
+}
+
+static u32 _destroyBuddyPageCache(buddy_page_cache_t ** ppCache)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+
+    jf_mutex_fini(&((*ppCache)->bpc_jmLock));
+
+    jf_mem_free((void **)ppCache);
+
+    return u32Ret;
+}
+
+static u32 _createBuddyPageCache(buddy_page_cache_t ** ppCache)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    buddy_page_cache_t * pbpc = NULL;
+    buddy_page_list_t * pbpl;
+    u32 u32Order;
+
+    u32Ret = jf_mem_calloc((void **)&pbpc, sizeof(buddy_page_cache_t));
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        for (u32Order = 0; u32Order <= BUDDY_PAGE_CACHE_MAX_ORDER; u32Order ++)
+        {
+            pbpl = &(pbpc->bpc_bplList[u32Order]);
+            jf_listhead_init(&(pbpl->bpl_jlPage));
+            pbpl->bpl_u32Batch = BUDDY_PAGE_CACHE_BATCH >> u32Order;
+            pbpl->bpl_u32High = pbpl->bpl_u32Batch * BUDDY_PAGE_CACHE_HIGH_RATIO;
+        }
+
+        u32Ret = jf_mutex_init(&(pbpc->bpc_jmLock));
+        if (u32Ret != JF_ERR_NO_ERROR)
+            jf_mem_free((void **)&pbpc);
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        *ppCache = pbpc;
+
+    return u32Ret;
+}
+
+static u32 _initBuddyPageCache(internal_jiukun_buddy_t * piab)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Index, u32NumOfCache;
+
+    u32NumOfCache = _getNumOfCpu();
+    if (u32NumOfCache > MAX_BUDDY_PAGE_CACHES)
+        u32NumOfCache = MAX_BUDDY_PAGE_CACHES;
+
+    jf_logger_logInfoMsg("init jiukun page cache, num: %u", u32NumOfCache);
+
+    for (u32Index = 0; (u32Index < u32NumOfCache) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+    {
+        u32Ret = _createBuddyPageCache(&(piab->ijb_pbpcPageCache[u32Index]));
+        if (u32Ret == JF_ERR_NO_ERROR)
+            piab->ijb_u32NumOfPageCache ++;
+    }
+
+    return u32Ret;
+}
+
+static void _finiBuddyPageCache(internal_jiukun_buddy_t * piab)
+{
+    u32 u32Index;
+
+    _drainBuddyPageCache(piab);
+
+    for (u32Index = 0; u32Index < piab->ijb_u32NumOfPageCache; u32Index ++)
+        _destroyBuddyPageCache(&(piab->ijb_pbpcPageCache[u32Index]));
+
+    piab->ijb_u32NumOfPageCache = 0;
+}
+
+#if defined(LINUX)
+/** Return the free page blocks in the zone to OS, the global lock must be held.
+ */
+static u64 _releaseBuddyZone(
+    internal_jiukun_buddy_t * piab, buddy_zone_t * pbz, u32 u32MinOrder, ulong ulGranule)
+{
+    u64 u64Bytes = 0;
+    u32 u32Order;
+    jf_listhead_t * pjl;
+    jiukun_page_t * pap;
+    u8 * pu8Start, * pu8End;
+
+    for (u32Order = u32MinOrder; u32Order < pbz->bz_u32MaxOrder; u32Order ++)
+    {
+        jf_listhead_forEach(&(pbz->bz_faFreeArea[u32Order].fa_jlFree), pjl)
+        {
+            pap = jf_listhead_getEntry(pjl, jiukun_page_t, jp_jlLru);
+            if (isJpReleased(pap))
+                continue;
+
+            /*The pool may not be aligned to the granule, only the whole granule is released.*/
+            pu8Start = pbz->bz_pu8Pool + (pap - pbz->bz_papPage) * BUDDY_PAGE_SIZE;
+            pu8End = pu8Start + (BUDDY_PAGE_SIZE << u32Order);
+            pu8Start = (u8 *)(((ulong)pu8Start + ulGranule - 1) & ~(ulGranule - 1));
+            pu8End = (u8 *)((ulong)pu8End & ~(ulGranule - 1));
+            if (pu8Start >= pu8End)
+                continue;
+
+            if (madvise(pu8Start, pu8End - pu8Start, MADV_DONTNEED) == 0)
+            {
+                setJpReleased(pap);
+                u64Bytes += pu8End - pu8Start;
+            }
+        }
+    }
+
+    return u64Bytes;
+}
+#endif
+
 #if defined(DEBUG_JIUKUN)
+static void _dumpBuddyPageCache(internal_jiukun_buddy_t * piab)
+{
+    u32 u32Index, u32Order;
+    buddy_page_cache_t * pbpc;
+
+    for (u32Index = 0; u32Index < piab->ijb_u32NumOfPageCache; u32Index ++)
+    {
+        pbpc = piab->ijb_pbpcPageCache[u32Index];
+
+        jf_mutex_acquire(&(pbpc->bpc_jmLock));
+        for (u32Order = 0; u32Order <= BUDDY_PAGE_CACHE_MAX_ORDER; u32Order ++)
+        {
+            if (pbpc->bpc_bplList[u32Order].bpl_u32Count != 0)
+                jf_logger_logInfoMsg(
+                    "page cache: %u, order: %u, page: %u", u32Index, u32Order,
+                    pbpc->bpc_bplList[u32Order].bpl_u32Count);
+        }
+        jf_mutex_release(&(pbpc->bpc_jmLock));
+    }
+}
+
 static void _dumpBuddyZone(buddy_zone_t * pbz)
 {
     u32 u32Index;
@@ -343,6 +861,7 @@ static void _dumpBuddyZone(buddy_zone_t * pbz)
     boolean_t bNoErrMsg = FALSE;
 
     jf_logger_logInfoMsg("  max page: %u, %p", pbz->bz_u32NumOfPage, pbz->bz_papPage);
+    jf_logger_logInfoMsg("  node: %u, mapped: %u", pbz->bz_u32Node, (pbz->bz_pu8Map != NULL));
     jf_logger_logInfoMsg("  free page: %u", pbz->bz_u32FreePages);
 
     for (u32Index = 0; u32Index < pbz->bz_u32MaxOrder; u32Index ++)
@@ -374,6 +893,9 @@ static void _dumpBuddy(internal_jiukun_buddy_t * piab)
 {
     u32 u32Index;
 
+    /*The page cache lock is acquired before the global lock.*/
+    _dumpBuddyPageCache(piab);
+
     jf_mutex_acquire(&piab->ijb_jmLock);
     for (u32Index = 0; u32Index < piab->ijb_u32NumOfZone; u32Index ++)
     {
@@ -411,8 +933,13 @@ u32 initJiukunBuddy(buddy_param_t * pbp)
 
     piab->ijb_u32MaxOrder = pbp->bp_u8MaxOrder + 1;
     piab->ijb_bNoGrow = pbp->bp_bNoGrow;
+#if defined(LINUX)
+    piab->ijb_bHugePage = pbp->bp_bHugePage;
+    piab->ijb_bNuma = pbp->bp_bNuma;
+#endif
 
-    u32Ret = _createBuddyZone(&(piab->ijb_pbzZone[0]), piab->ijb_u32MaxOrder, 0);
+    u32Ret = _createBuddyZone(
+        piab, &(piab->ijb_pbzZone[0]), 0, piab->ijb_bNuma ? _getCurrentNumaNode() : 0);
     if (u32Ret == JF_ERR_NO_ERROR)
     {
         piab->ijb_u32NumOfZone ++;
@@ -420,6 +947,9 @@ u32 initJiukunBuddy(buddy_param_t * pbp)
         u32Ret = jf_mutex_init(&(piab->ijb_jmLock));
     }
 
+    if ((u32Ret == JF_ERR_NO_ERROR) && (! pbp->bp_bNoPageCache))
+        u32Ret = _initBuddyPageCache(piab);
+
     if (u32Ret == JF_ERR_NO_ERROR)
         piab->ijb_bInitialized = TRUE;
     else
@@ -436,6 +966,9 @@ u32 finiJiukunBuddy(void)
 
     jf_logger_logInfoMsg("fini jiukun buddy");
 
+    /*Return the pages in page cache, so they are not reported as leak.*/
+    _finiBuddyPageCache(piab);
+
 #if defined(DEBUG_JIUKUN)
     _dumpBuddy(piab);
 #endif
@@ -483,6 +1016,7 @@ u32 getJiukunPage(jiukun_page_t ** ppPage, u32 u32Order, jf_flag_t flag)
     internal_jiukun_buddy_t * piab = &ls_ijbBuddy;
     jiukun_page_t * pap = NULL;
     olint_t retrycount = 0;
+    boolean_t bDrained = FALSE;
 
     assert(piab->ijb_bInitialized);
     assert(ppPage != NULL);
@@ -495,22 +1029,53 @@ u32 getJiukunPage(jiukun_page_t ** ppPage, u32 u32Order, jf_flag_t flag)
     if (u32Order >= piab->ijb_u32MaxOrder)
         return JF_ERR_INVALID_JIUKUN_PAGE_ORDER;
 
-    do
+    /*Try the page cache with its mutex, no global lock if the page cache has page.*/
+    if ((u32Order <= BUDDY_PAGE_CACHE_MAX_ORDER) && (piab->ijb_u32NumOfPageCache > 0))
+        pap = _tryAllocCachedPage(piab, u32Order, flag);
+
+    while (pap == NULL)
     {
         jf_mutex_acquire(&(piab->ijb_jmLock));
         pap = _allocPages(piab, u32Order, flag);
+        if (pap != NULL)
+        {
+            /*Mark the page as allocated with the lock, otherwise the page may be coalesced as free
+              buddy by another thread.*/
+            _setPageOrder(pap, u32Order);
+            setJpAllocated(pap);
+        }
         jf_mutex_release(&(piab->ijb_jmLock));
 
+        if ((pap == NULL) && (piab->ijb_u32NumOfPageCache > 0) && (! bDrained))
+        {
+            /*The free pages may be in page caches of other CPUs, return them and try again.*/
+            _drainBuddyPageCache(piab);
+            bDrained = TRUE;
+            continue;
+        }
+
         if (pap == NULL)
         {
             reapJiukun(TRUE);
 
+            /*The reaped pages may be returned to the page caches, try the cache first and drain
+              the caches again in next round.*/
+            bDrained = FALSE;
+            if ((u32Order <= BUDDY_PAGE_CACHE_MAX_ORDER) && (piab->ijb_u32NumOfPageCache > 0))
+                pap = _tryAllocCachedPage(piab, u32Order, flag);
+        }
+
+        if (pap == NULL)
+        {
             if (retrycount > 0)
                 sleep(retrycount);
 
             retrycount ++;
+
+            if (! JF_FLAG_GET(flag, JF_JIUKUN_PAGE_ALLOC_FLAG_WAIT))
+                break;
         }
-    } while ((pap == NULL) && JF_FLAG_GET(flag, JF_JIUKUN_PAGE_ALLOC_FLAG_WAIT));
+    }
 
     if (pap == NULL)
     {
@@ -518,8 +1083,6 @@ u32 getJiukunPage(jiukun_page_t ** ppPage, u32 u32Order, jf_flag_t flag)
     }
     else
     {
-        _setPageOrder(pap, u32Order);
-        setJpAllocated(pap);
         *ppPage = pap;
 #if defined(DEBUG_JIUKUN)
         jf_logger_logDebugMsg("get jiukun page, page: %p", pap);
@@ -544,12 +1107,19 @@ void putJiukunPage(jiukun_page_t ** ppPage)
     jf_logger_logInfoMsg("put jiukun page, paga addr: %p, order: %u", *ppPage, u32Order);
 #endif
 
-    if (! isJpAllocated((*ppPage)))
+    if (! isJpAllocated((*ppPage)) || isJpCached((*ppPage)))
     {
         jf_logger_logErrMsg(JF_ERR_JIUKUN_FREE_UNALLOCATED, "put jiukun page");
         abort();
     }
 
+    if ((u32Order <= BUDDY_PAGE_CACHE_MAX_ORDER) && (piab->ijb_u32NumOfPageCache > 0) &&
+        _tryFreeCachedPage(piab, *ppPage, u32Order))
+    {
+        *ppPage = NULL;
+        return;
+    }
+
     jf_mutex_acquire(&(piab->ijb_jmLock));
 
     _freeOnePage(piab->ijb_pbzZone[u32ZoneId], *ppPage, u32Order);
@@ -600,6 +1170,33 @@ jiukun_page_t * addrToJiukunPage(void * pAddr)
     return pbz->bz_papPage + ((u8 *)pAddr - pbz->bz_pu8Pool) / BUDDY_PAGE_SIZE;
 }
 
+u64 releaseJiukunBuddy(u32 u32MinOrder)
+{
+    internal_jiukun_buddy_t * piab = &ls_ijbBuddy;
+    u64 u64Bytes = 0;
+#if defined(LINUX)
+    u32 u32Index;
+    ulong ulGranule = (ulong)sysconf(_SC_PAGESIZE);
+
+    assert(piab->ijb_bInitialized);
+
+    /*The page in page cache can be coalesced after it's returned to buddy free lists.*/
+    _drainBuddyPageCache(piab);
+
+    if (piab->ijb_bHugePage)
+        ulGranule = BUDDY_HUGE_PAGE_SIZE;
+
+    jf_mutex_acquire(&(piab->ijb_jmLock));
+
+    for (u32Index = 0; u32Index < piab->ijb_u32NumOfZone; u32Index ++)
+        u64Bytes += _releaseBuddyZone(piab, piab->ijb_pbzZone[u32Index], u32MinOrder, ulGranule);
+
+    jf_mutex_release(&(piab->ijb_jmLock));
+#endif
+
+    return u64Bytes;
+}
+
 #if defined(DEBUG_JIUKUN)
 void dumpJiukunBuddy(void)
 {
@@ -17,9 +17,11 @@
 
 /* --- internal header files -------------------------------------------------------------------- */
 #include "jf_basic.h"
+#include "jf_flag.h"
 #include "jf_listhead.h"
 #include "jf_err.h"
 #include "jf_jiukun.h"
+#include "jf_atomic.h"
 
 /* --- constant definitions --------------------------------------------------------------------- */
 
@@ -35,6 +37,9 @@ typedef enum jiukun_page_flag
 {
     JP_FLAG_ALLOCATED = 0,/**< page is allocated */
     JP_FLAG_SLAB,         /**< page is used by slab */
+    JP_FLAG_CACHED,       /**< page is in page cache */
+    JP_FLAG_SAMPLED,      /**< page has sampled allocation for profiling */
+    JP_FLAG_RELEASED,     /**< free page block is returned to OS */
 } jiukun_page_flag_t;
 
 /** Jiukun page data structure
@@ -56,6 +61,17 @@ typedef struct jiukun_page
 #define clearJpSlab(page) (JF_FLAG_CLEAR(page->jp_jfPage, JP_FLAG_SLAB))
 #define isJpSlab(page) (JF_FLAG_GET(page->jp_jfPage, JP_FLAG_SLAB))
 
+#define setJpCached(page) (JF_FLAG_SET(page->jp_jfPage, JP_FLAG_CACHED))
+#define clearJpCached(page) (JF_FLAG_CLEAR(page->jp_jfPage, JP_FLAG_CACHED))
+#define isJpCached(page) (JF_FLAG_GET(page->jp_jfPage, JP_FLAG_CACHED))
+
+#define clearJpSampled(page) (JF_FLAG_CLEAR(page->jp_jfPage, JP_FLAG_SAMPLED))
+#define isJpSampled(page) (JF_FLAG_GET(page->jp_jfPage, JP_FLAG_SAMPLED))
+
+#define setJpReleased(page) (JF_FLAG_SET(page->jp_jfPage, JP_FLAG_RELEASED))
+#define clearJpReleased(page) (JF_FLAG_CLEAR(page->jp_jfPage, JP_FLAG_RELEASED))
+#define isJpReleased(page) (JF_FLAG_GET(page->jp_jfPage, JP_FLAG_RELEASED))
+
 /** order is at bit 48 ~ 55
  */
 #define setJpOrder(page, order) (JF_FLAG_SET_VALUE(page->jp_jfPage, 55, 48, order))
@@ -68,11 +84,32 @@ typedef struct jiukun_page
 
 #define pageToIndex(page, base) ((u32)(page - base))
 
+/** Set the sampled flag of the page.
+ *
+ *  @note
+ *  -# The flag is set when the object in the page is allocated, no lock is held and other threads
+ *   may allocate objects from the same page, so the flag is set atomically.
+ */
+static inline void setJpSampled(jiukun_page_t * page)
+{
+    jf_flag_t flag;
+
+    do
+    {
+        flag = jf_atomic_loadU64(&page->jp_jfPage);
+        if (JF_FLAG_GET(flag, JP_FLAG_SAMPLED))
+            break;
+    } while (! jf_atomic_casU64(&page->jp_jfPage, flag, flag | JF_FLAG_MASK(JP_FLAG_SAMPLED)));
+}
+
 typedef struct
 {
     u8 bp_u8MaxOrder;
     boolean_t bp_bNoGrow;
-    u8 bp_u8Reserved[6];
+    boolean_t bp_bHugePage;
+    boolean_t bp_bNuma;
+    boolean_t bp_bNoPageCache;
+    u8 bp_u8Reserved[3];
 } buddy_param_t;
 
 /* --- functional routines ---------------------------------------------------------------------- */
@@ -84,6 +121,14 @@ u32 finiJiukunBuddy(void);
 void dumpJiukunBuddy(void);
 #endif
 
+/** Return the pages in page caches to buddy free lists and return the free page blocks to OS.
+ *
+ *  @param u32MinOrder [in] minimum order of free page block returned to OS
+ *
+ *  @return bytes returned to OS
+ */
+u64 releaseJiukunBuddy(u32 u32MinOrder);
+
 u32 getJiukunPage(jiukun_page_t ** ppPage, u32 u32Order, jf_flag_t flag);
 
 void putJiukunPage(jiukun_page_t ** ppPage);
@@ -1,19 +1,77 @@
+/* Size classes of general cache, 4 classes per power of two (quarter steps) from 32 bytes to
+ * 8Mb. The lookup in slab.c computes the index of the class from the size, the list should be kept
+ * in this form.
+ */
 	CACHE(32)
+	CACHE(40)
+	CACHE(48)
+	CACHE(56)
 	CACHE(64)
+	CACHE(80)
+	CACHE(96)
+	CACHE(112)
 	CACHE(128)
+	CACHE(160)
+	CACHE(192)
+	CACHE(224)
 	CACHE(256)
+	CACHE(320)
+	CACHE(384)
+	CACHE(448)
 	CACHE(512)
+	CACHE(640)
+	CACHE(768)
+	CACHE(896)
 	CACHE(1024)
+	CACHE(1280)
+	CACHE(1536)
+	CACHE(1792)
 	CACHE(2048)
+	CACHE(2560)
+	CACHE(3072)
+	CACHE(3584)
 	CACHE(4096)
+	CACHE(5120)
+	CACHE(6144)
+	CACHE(7168)
 	CACHE(8192)
+	CACHE(10240)
+	CACHE(12288)
+	CACHE(14336)
 	CACHE(16384)
+	CACHE(20480)
+	CACHE(24576)
+	CACHE(28672)
 	CACHE(32768)
+	CACHE(40960)
+	CACHE(49152)
+	CACHE(57344)
 	CACHE(65536)
+	CACHE(81920)
+	CACHE(98304)
+	CACHE(114688)
 	CACHE(131072)
+	CACHE(163840)
+	CACHE(196608)
+	CACHE(229376)
 	CACHE(262144)
+	CACHE(327680)
+	CACHE(393216)
+	CACHE(458752)
 	CACHE(524288)
-    CACHE(1048576)
-    CACHE(2097152)
-    CACHE(4194304)
-    CACHE(8388608)
+	CACHE(655360)
+	CACHE(786432)
+	CACHE(917504)
+	CACHE(1048576)
+	CACHE(1310720)
+	CACHE(1572864)
+	CACHE(1835008)
+	CACHE(2097152)
+	CACHE(2621440)
+	CACHE(3145728)
+	CACHE(3670016)
+	CACHE(4194304)
+	CACHE(5242880)
+	CACHE(6291456)
+	CACHE(7340032)
+	CACHE(8388608)
@@ -6,6 +6,8 @@
  *  @author Min Zhang
  *
  *  @note
+ *  -# If the reaping interval is set, a background thread is created to reap jiukun periodically.
+ *   The thread is waken up by the semaphore when jiukun is finalized.
  *  
  */
 
@@ -17,9 +19,13 @@
 #include "jf_basic.h"
 #include "jf_limit.h"
 #include "jf_jiukun.h"
+#include "jf_mutex.h"
+#include "jf_sem.h"
+#include "jf_thread.h"
 
 #include "buddy.h"
 #include "slab.h"
+#include "profile.h"
 #include "common.h"
 
 /* --- private data/data structure section ------------------------------------------------------ */
@@ -37,9 +43,21 @@ static u32 ls_u32OrderPrimes[] = {
 typedef struct
 {
     boolean_t ia_bInitialized;
-    u8 ia_u8Reserved[7];
-
-    u32 ia_u32Reserved[4];
+    boolean_t ia_bToTerminateReap;
+    u8 ia_u8Reserved[6];
+
+    u32 ia_u32ReapInterval;
+    u32 ia_u32ReapFreeSlab;
+    u32 ia_u32ReleaseOrder;
+    u32 ia_u32Reserved;
+
+    /**The background reaping thread.*/
+    jf_thread_id_t ia_jtiReap;
+    /**Wake up the reaping thread for termination.*/
+    jf_sem_t ia_jsReap;
+    /**Lock for reaping and the statistics.*/
+    jf_mutex_t ia_jmReap;
+    jf_jiukun_reap_stat_t ia_jjrsReap;
 } internal_jiukun_t;
 
 static internal_jiukun_t ls_iaJiukun;
@@ -51,6 +69,58 @@ static internal_jiukun_t ls_iaJiukun;
 
 /* --- private routine section ------------------------------------------------------------------ */
 
+static JF_THREAD_RETURN_VALUE _reapJiukunThread(void * pArg)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_jiukun_t * pia = (internal_jiukun_t *)pArg;
+
+    jf_logger_logInfoMsg("reap jiukun thread starts, interval: %u", pia->ia_u32ReapInterval);
+
+    while (! pia->ia_bToTerminateReap)
+    {
+        /*The semaphore is up when the thread is to terminate.*/
+        if (jf_sem_downWithTimeout(&pia->ia_jsReap, pia->ia_u32ReapInterval) == JF_ERR_NO_ERROR)
+            continue;
+
+        jf_jiukun_reap();
+    }
+
+    jf_logger_logInfoMsg("reap jiukun thread quits");
+
+    JF_THREAD_RETURN(u32Ret);
+}
+
+static u32 _startReapJiukunThread(internal_jiukun_t * pia)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+
+    u32Ret = jf_sem_init(&pia->ia_jsReap, 0, 1);
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        u32Ret = jf_thread_create(&pia->ia_jtiReap, NULL, _reapJiukunThread, pia);
+        if (u32Ret != JF_ERR_NO_ERROR)
+            jf_sem_fini(&pia->ia_jsReap);
+    }
+
+    return u32Ret;
+}
+
+static u32 _stopReapJiukunThread(internal_jiukun_t * pia)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32RetCode = 0;
+
+    pia->ia_bToTerminateReap = TRUE;
+    jf_sem_up(&pia->ia_jsReap);
+
+    jf_thread_waitForThreadTermination(pia->ia_jtiReap, &u32RetCode);
+    jf_thread_initId(&pia->ia_jtiReap);
+
+    jf_sem_fini(&pia->ia_jsReap);
+
+    return u32Ret;
+}
+
 /* --- public routine section ------------------------------------------------------------------- */
 
 u32 jf_jiukun_init(jf_jiukun_init_param_t * pjjip)
@@ -60,6 +130,7 @@ u32 jf_jiukun_init(jf_jiukun_init_param_t * pjjip)
     u32 u32NumOfPages;
     buddy_param_t bp;
     slab_param_t sp;
+    profile_param_t pp;
 
     if (pia->ia_bInitialized)
         return u32Ret;
@@ -68,28 +139,54 @@ u32 jf_jiukun_init(jf_jiukun_init_param_t * pjjip)
            (pjjip->jjip_sPool <= JF_JIUKUN_MAX_POOL_SIZE));
 
     ol_bzero(pia, sizeof(internal_jiukun_t));
+    jf_thread_initId(&pia->ia_jtiReap);
+    pia->ia_u32ReapInterval = pjjip->jjip_u32ReapInterval;
+    pia->ia_u32ReapFreeSlab = pjjip->jjip_u32ReapFreeSlab;
+    pia->ia_u32ReleaseOrder = pjjip->jjip_u32ReleaseOrder;
+    if (pia->ia_u32ReleaseOrder == 0)
+        pia->ia_u32ReleaseOrder = JF_JIUKUN_DEFAULT_RELEASE_ORDER;
+
     ol_bzero(&bp, sizeof(buddy_param_t));
     bp.bp_bNoGrow = pjjip->jjip_bNoGrow;
+    bp.bp_bHugePage = pjjip->jjip_bHugePage;
+    bp.bp_bNuma = pjjip->jjip_bNuma;
+    bp.bp_bNoPageCache = pjjip->jjip_bNoPageCache;
     u32NumOfPages = sizeToPages(pjjip->jjip_sPool);
 
     while (u32NumOfPages > ls_u32OrderPrimes[bp.bp_u8MaxOrder])
         bp.bp_u8MaxOrder ++;
 
     jf_logger_logInfoMsg(
-        "init aehter, size: %u, page: %u, order: %u",
-        pjjip->jjip_sPool, u32NumOfPages, bp.bp_u8MaxOrder);
+        "init aehter, size: %u, page: %u, order: %u, huge page: %u, numa: %u",
+        pjjip->jjip_sPool, u32NumOfPages, bp.bp_u8MaxOrder, bp.bp_bHugePage, bp.bp_bNuma);
 
     u32Ret = initJiukunBuddy(&bp);
+    if ((u32Ret == JF_ERR_NO_ERROR) && (pjjip->jjip_u32ProfileSample != 0))
+    {
+        ol_bzero(&pp, sizeof(profile_param_t));
+        pp.pp_u32Sample = pjjip->jjip_u32ProfileSample;
+
+        u32Ret = initJiukunProfile(&pp);
+    }
+
     if (u32Ret == JF_ERR_NO_ERROR)
     {
         ol_memset(&sp, 0, sizeof(slab_param_t));
+        sp.sp_bProfile = (pjjip->jjip_u32ProfileSample != 0);
 
         u32Ret = initJiukunSlab(&sp);
     }
 
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = jf_mutex_init(&pia->ia_jmReap);
+
     if (u32Ret == JF_ERR_NO_ERROR)
         pia->ia_bInitialized = TRUE;
-    else
+
+    if ((u32Ret == JF_ERR_NO_ERROR) && (pia->ia_u32ReapInterval != 0))
+        u32Ret = _startReapJiukunThread(pia);
+
+    if (u32Ret != JF_ERR_NO_ERROR)
         jf_jiukun_fini();
 
     return u32Ret;
@@ -104,8 +201,16 @@ u32 jf_jiukun_fini(void)
     jf_logger_logInfoMsg("fini jiukun");
 #endif
 
+    if (jf_thread_isValidId(&pia->ia_jtiReap))
+        _stopReapJiukunThread(pia);
+
+    if (pia->ia_bInitialized)
+        jf_mutex_fini(&pia->ia_jmReap);
+
     finiJiukunSlab();
 
+    finiJiukunProfile();
+
     finiJiukunBuddy();
 
     pia->ia_bInitialized = FALSE;
@@ -135,6 +240,46 @@ u32 reapJiukun(boolean_t bNoWait)
     return u32Ret;
 }
 
+u32 jf_jiukun_reap(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_jiukun_t * pia = &ls_iaJiukun;
+    olint_t nSlab = 0;
+    u64 u64Bytes = 0;
+
+    assert(pia->ia_bInitialized);
+
+    jf_mutex_acquire(&pia->ia_jmReap);
+
+    nSlab = trimJiukunSlab(pia->ia_u32ReapFreeSlab);
+    u64Bytes = releaseJiukunBuddy(pia->ia_u32ReleaseOrder);
+
+    pia->ia_jjrsReap.jjrs_u64Reap ++;
+    pia->ia_jjrsReap.jjrs_u64SlabReaped += nSlab;
+    pia->ia_jjrsReap.jjrs_u64ByteReleased += u64Bytes;
+
+    jf_mutex_release(&pia->ia_jmReap);
+
+    if ((nSlab != 0) || (u64Bytes != 0))
+        jf_logger_logDebugMsg("reap jiukun, slab: %d, released: %llu", nSlab, u64Bytes);
+
+    return u32Ret;
+}
+
+u32 jf_jiukun_getReapStat(jf_jiukun_reap_stat_t * pjjrs)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_jiukun_t * pia = &ls_iaJiukun;
+
+    assert(pia->ia_bInitialized);
+
+    jf_mutex_acquire(&pia->ia_jmReap);
+    ol_memcpy(pjjrs, &pia->ia_jjrsReap, sizeof(jf_jiukun_reap_stat_t));
+    jf_mutex_release(&pia->ia_jmReap);
+
+    return u32Ret;
+}
+
 #if defined(DEBUG_JIUKUN)
 void jf_jiukun_dump(void)
 {
@@ -143,6 +288,8 @@ void jf_jiukun_dump(void)
     assert(pia->ia_bInitialized);
 
     dumpJiukunBuddy();
+
+    dumpJiukunSlab();
 }
 #endif
 
@@ -12,9 +12,9 @@
 
 SONAME = jf_jiukun
 
-SOURCES = buddy.c slab.c jiukun.c
+SOURCES = buddy.c slab.c arena.c profile.c jiukun.c
 
-JIUTAI_SRCS = jf_mem.c jf_mutex.c
+JIUTAI_SRCS = jf_mem.c jf_mutex.c jf_sem.c jf_thread.c
 
 EXTRA_LIBS = -ljf_logger
 
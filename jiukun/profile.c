@@ -0,0 +1,536 @@
+/**
+ *  @file profile.c
+ *
+ *  @brief The allocation profiling for jiukun
+ *
+ *  @author Min Zhang
+ *
+ *  @note
+ *  -# Allocations are sampled by bytes, each thread counts down the bytes allocated, when the
+ *   counter reaches 0, the allocation is sampled and the counter is reset to a random value with
+ *   the mean of the sample size.
+ *  -# For each sampled allocation, the call stack is recorded as the allocation site, the site
+ *   keeps the live and total objects and bytes of the sampled allocations.
+ *  -# The allocation is sampled with the probability of "s/R - s*s/(4*R*R)" where s is the size
+ *   and R is the sample size, the allocation larger than 2*R is always sampled. The sample
+ *   represents "4*R*R/(4*R - s)" bytes, the estimated bytes are reported with the sampled bytes.
+ *  -# The page with sampled allocation is flagged, only the free of memory in the flagged page
+ *   looks up the sampled allocations.
+ *  -# The memory for profiling is allocated from heap, not from jiukun.
+ */
+
+/* --- standard C lib header files -------------------------------------------------------------- */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#if defined(LINUX)
+    #include <execinfo.h>
+#endif
+
+/* --- internal header files -------------------------------------------------------------------- */
+#include "jf_basic.h"
+#include "jf_limit.h"
+#include "jf_err.h"
+#include "jf_mem.h"
+#include "jf_mutex.h"
+
+#include "profile.h"
+
+/* --- private data/data structure section ------------------------------------------------------ */
+
+/** Maximum depth of call stack for allocation site.
+ */
+#define MAX_PROFILE_STACK_DEPTH    (16)
+
+/** Size of hash table for allocation site, must be power of 2.
+ */
+#define PROFILE_SITE_HASH_SIZE     (1024)
+
+/** Size of hash table for sampled allocation, must be power of 2.
+ */
+#define PROFILE_ALLOC_HASH_SIZE    (4096)
+
+/** Maximum number of sites logged when the profile is dumped to logger.
+ */
+#define MAX_PROFILE_LOG_SITE       (20)
+
+#if defined(LINUX)
+    #define PROFILE_THREAD_LOCAL   __thread
+#elif defined(WINDOWS)
+    #define PROFILE_THREAD_LOCAL   __declspec(thread)
+#endif
+
+typedef struct profile_site
+{
+    /** next site in hash bucket */
+    struct profile_site * ps_ppsNext;
+    u32 ps_u32Hash;
+    u32 ps_u32Depth;
+    void * ps_pStack[MAX_PROFILE_STACK_DEPTH];
+
+    /** sampled objects and bytes not freed */
+    u64 ps_u64LiveObj;
+    u64 ps_u64LiveByte;
+    /** estimated bytes not freed */
+    u64 ps_u64LiveEstimate;
+    /** all sampled objects and bytes */
+    u64 ps_u64AllocObj;
+    u64 ps_u64AllocByte;
+} profile_site_t;
+
+typedef struct profile_alloc
+{
+    /** next sampled allocation in hash bucket */
+    struct profile_alloc * pa_ppaNext;
+    void * pa_pMem;
+    olsize_t pa_sMem;
+    u32 pa_u32Reserved;
+    u64 pa_u64Estimate;
+    profile_site_t * pa_ppsSite;
+} profile_alloc_t;
+
+typedef struct
+{
+    boolean_t ijp_bInitialized;
+    u8 ijp_u8Reserved[3];
+    u32 ijp_u32Sample;
+
+    u32 ijp_u32NumOfSite;
+    u32 ijp_u32Reserved;
+
+    profile_site_t * ijp_ppsSite[PROFILE_SITE_HASH_SIZE];
+    profile_alloc_t * ijp_ppaAlloc[PROFILE_ALLOC_HASH_SIZE];
+
+    jf_mutex_t ijp_jmLock;
+} internal_jiukun_profile_t;
+
+static internal_jiukun_profile_t ls_ijpProfile;
+
+/** Bytes to be allocated before next sample, 0 if the counter is not started.
+ */
+static PROFILE_THREAD_LOCAL s64 ls_s64ProfileCountdown = 0;
+
+static PROFILE_THREAD_LOCAL u32 ls_u32ProfileSeed = 0;
+
+/* --- private routine section ------------------------------------------------------------------ */
+
+/** Xorshift PRNG, the seed is from the address of the thread local variable so each thread has
+ *  different sequence.
+ */
+static u32 _getProfileRand(void)
+{
+    if (ls_u32ProfileSeed == 0)
+        ls_u32ProfileSeed = (u32)(ulong)&ls_u32ProfileSeed | 1;
+
+    ls_u32ProfileSeed ^= ls_u32ProfileSeed << 13;
+    ls_u32ProfileSeed ^= ls_u32ProfileSeed >> 17;
+    ls_u32ProfileSeed ^= ls_u32ProfileSeed << 5;
+
+    return ls_u32ProfileSeed;
+}
+
+/** Get the bytes to next sample, it's uniform in [1, 2 * sample size) so the mean is the sample
+ *  size and the allocation pattern with fixed period is not aliased.
+ */
+static s64 _getProfileInterval(internal_jiukun_profile_t * pijp)
+{
+    return 1 + (s64)(_getProfileRand() % (2 * (u64)pijp->ijp_u32Sample));
+}
+
+static inline u32 _hashProfilePointer(void * ptr, u32 u32Size)
+{
+    ulong ul = (ulong)ptr;
+
+    ul ^= ul >> 17;
+    ul *= 0x9E3779B1UL;
+
+    return (u32)(ul >> 7) & (u32Size - 1);
+}
+
+/** FNV-1a hash of the call stack.
+ */
+static u32 _hashProfileStack(void ** pStack, u32 u32Depth)
+{
+    u32 u32Hash = 2166136261U, u32Index;
+    ulong ul;
+    u32 u32Byte;
+
+    for (u32Index = 0; u32Index < u32Depth; u32Index ++)
+    {
+        ul = (ulong)pStack[u32Index];
+        for (u32Byte = 0; u32Byte < sizeof(ulong); u32Byte ++)
+        {
+            u32Hash ^= (u32)(ul & 0xFF);
+            u32Hash *= 16777619U;
+            ul >>= 8;
+        }
+    }
+
+    return u32Hash;
+}
+
+/** Find the site with the call stack, create it if not found. The lock must be held.
+ */
+static profile_site_t * _getProfileSite(
+    internal_jiukun_profile_t * pijp, void ** pStack, u32 u32Depth)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Hash = _hashProfileStack(pStack, u32Depth);
+    profile_site_t ** ppps = &pijp->ijp_ppsSite[u32Hash & (PROFILE_SITE_HASH_SIZE - 1)];
+    profile_site_t * pps = *ppps;
+
+    while (pps != NULL)
+    {
+        if ((pps->ps_u32Hash == u32Hash) && (pps->ps_u32Depth == u32Depth) &&
+            (ol_memcmp(pps->ps_pStack, pStack, u32Depth * sizeof(void *)) == 0))
+            return pps;
+
+        pps = pps->ps_ppsNext;
+    }
+
+    u32Ret = jf_mem_calloc((void **)&pps, sizeof(profile_site_t));
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        pps->ps_u32Hash = u32Hash;
+        pps->ps_u32Depth = u32Depth;
+        ol_memcpy(pps->ps_pStack, pStack, u32Depth * sizeof(void *));
+
+        pps->ps_ppsNext = *ppps;
+        *ppps = pps;
+        pijp->ijp_u32NumOfSite ++;
+    }
+
+    return pps;
+}
+
+static u32 _writeProfileFile(internal_jiukun_profile_t * pijp, const olchar_t * pstrFile)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    FILE * fp = NULL;
+    u32 u32Index, u32Depth;
+    profile_site_t * pps;
+    u64 u64LiveObj = 0, u64LiveByte = 0, u64AllocObj = 0, u64AllocByte = 0;
+#if defined(LINUX)
+    FILE * fpMap = NULL;
+    olchar_t strLine[512];
+#endif
+
+    fp = fopen(pstrFile, "w");
+    if (fp == NULL)
+        return JF_ERR_FAIL_OPEN_FILE;
+
+    for (u32Index = 0; u32Index < PROFILE_SITE_HASH_SIZE; u32Index ++)
+    {
+        for (pps = pijp->ijp_ppsSite[u32Index]; pps != NULL; pps = pps->ps_ppsNext)
+        {
+            u64LiveObj += pps->ps_u64LiveObj;
+            u64LiveByte += pps->ps_u64LiveByte;
+            u64AllocObj += pps->ps_u64AllocObj;
+            u64AllocByte += pps->ps_u64AllocByte;
+        }
+    }
+
+    /*Legacy heap profile format of pprof, the counts are sampled, pprof scales them with the
+      sample size.*/
+    fprintf(
+        fp, "heap profile: %llu: %llu [%llu: %llu] @ heap_v2/%u\n", u64LiveObj, u64LiveByte,
+        u64AllocObj, u64AllocByte, pijp->ijp_u32Sample);
+
+    for (u32Index = 0; u32Index < PROFILE_SITE_HASH_SIZE; u32Index ++)
+    {
+        for (pps = pijp->ijp_ppsSite[u32Index]; pps != NULL; pps = pps->ps_ppsNext)
+        {
+            fprintf(
+                fp, "%llu: %llu [%llu: %llu] @", pps->ps_u64LiveObj, pps->ps_u64LiveByte,
+                pps->ps_u64AllocObj, pps->ps_u64AllocByte);
+            for (u32Depth = 0; u32Depth < pps->ps_u32Depth; u32Depth ++)
+                fprintf(fp, " %p", pps->ps_pStack[u32Depth]);
+            fprintf(fp, "\n");
+        }
+    }
+
+#if defined(LINUX)
+    /*The mapping is required by pprof to symbolize the addresses.*/
+    fprintf(fp, "\nMAPPED_LIBRARIES:\n");
+    fpMap = fopen("/proc/self/maps", "r");
+    if (fpMap != NULL)
+    {
+        while (fgets(strLine, sizeof(strLine), fpMap) != NULL)
+            fputs(strLine, fp);
+
+        fclose(fpMap);
+    }
+#endif
+
+    fclose(fp);
+
+    return u32Ret;
+}
+
+static olint_t _compareProfileSite(const void * pA, const void * pB)
+{
+    const profile_site_t * ppsA = *(const profile_site_t **)pA;
+    const profile_site_t * ppsB = *(const profile_site_t **)pB;
+
+    if (ppsA->ps_u64LiveEstimate > ppsB->ps_u64LiveEstimate)
+        return -1;
+    if (ppsA->ps_u64LiveEstimate < ppsB->ps_u64LiveEstimate)
+        return 1;
+
+    return 0;
+}
+
+/** Log the sites with most estimated live bytes.
+ */
+static u32 _logProfile(internal_jiukun_profile_t * pijp)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    profile_site_t ** ppps = NULL;
+    profile_site_t * pps;
+    u32 u32Index, u32Num = 0, u32Depth;
+#if defined(LINUX)
+    olchar_t ** ppstrSymbol = NULL;
+#endif
+
+    jf_logger_logInfoMsg(
+        "dump jiukun profile, sample: %u, site: %u", pijp->ijp_u32Sample, pijp->ijp_u32NumOfSite);
+
+    if (pijp->ijp_u32NumOfSite == 0)
+        return u32Ret;
+
+    u32Ret = jf_mem_alloc((void **)&ppps, pijp->ijp_u32NumOfSite * sizeof(profile_site_t *));
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        for (u32Index = 0; u32Index < PROFILE_SITE_HASH_SIZE; u32Index ++)
+            for (pps = pijp->ijp_ppsSite[u32Index]; pps != NULL; pps = pps->ps_ppsNext)
+                ppps[u32Num ++] = pps;
+
+        qsort(ppps, u32Num, sizeof(profile_site_t *), _compareProfileSite);
+
+        for (u32Index = 0; (u32Index < u32Num) && (u32Index < MAX_PROFILE_LOG_SITE); u32Index ++)
+        {
+            pps = ppps[u32Index];
+            if (pps->ps_u64LiveEstimate == 0)
+                break;
+
+            jf_logger_logInfoMsg(
+                "site %u, live: %llu bytes estimated, %llu objs %llu bytes sampled, "
+                "total: %llu objs %llu bytes sampled", u32Index, pps->ps_u64LiveEstimate,
+                pps->ps_u64LiveObj, pps->ps_u64LiveByte, pps->ps_u64AllocObj,
+                pps->ps_u64AllocByte);
+
+#if defined(LINUX)
+            ppstrSymbol = backtrace_symbols(pps->ps_pStack, pps->ps_u32Depth);
+#endif
+            for (u32Depth = 0; u32Depth < pps->ps_u32Depth; u32Depth ++)
+            {
+#if defined(LINUX)
+                if (ppstrSymbol != NULL)
+                {
+                    jf_logger_logInfoMsg("    %s", ppstrSymbol[u32Depth]);
+                    continue;
+                }
+#endif
+                jf_logger_logInfoMsg("    %p", pps->ps_pStack[u32Depth]);
+            }
+#if defined(LINUX)
+            if (ppstrSymbol != NULL)
+                free(ppstrSymbol);
+#endif
+        }
+
+        jf_mem_free((void **)&ppps);
+    }
+
+    return u32Ret;
+}
+
+/* --- public routine section ------------------------------------------------------------------- */
+
+u32 initJiukunProfile(profile_param_t * ppp)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_jiukun_profile_t * pijp = &ls_ijpProfile;
+
+    assert((ppp != NULL) && (ppp->pp_u32Sample > 0));
+    assert(! pijp->ijp_bInitialized);
+
+    jf_logger_logInfoMsg("init jiukun profile, sample: %u", ppp->pp_u32Sample);
+
+    ol_bzero(pijp, sizeof(internal_jiukun_profile_t));
+    pijp->ijp_u32Sample = ppp->pp_u32Sample;
+
+    u32Ret = jf_mutex_init(&pijp->ijp_jmLock);
+    if (u32Ret == JF_ERR_NO_ERROR)
+        pijp->ijp_bInitialized = TRUE;
+
+    return u32Ret;
+}
+
+u32 finiJiukunProfile(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_jiukun_profile_t * pijp = &ls_ijpProfile;
+    u32 u32Index;
+    profile_site_t * pps;
+    profile_alloc_t * ppa;
+
+    if (! pijp->ijp_bInitialized)
+        return u32Ret;
+
+    jf_logger_logInfoMsg("fini jiukun profile");
+
+    for (u32Index = 0; u32Index < PROFILE_ALLOC_HASH_SIZE; u32Index ++)
+    {
+        while (pijp->ijp_ppaAlloc[u32Index] != NULL)
+        {
+            ppa = pijp->ijp_ppaAlloc[u32Index];
+            pijp->ijp_ppaAlloc[u32Index] = ppa->pa_ppaNext;
+            jf_mem_free((void **)&ppa);
+        }
+    }
+
+    for (u32Index = 0; u32Index < PROFILE_SITE_HASH_SIZE; u32Index ++)
+    {
+        while (pijp->ijp_ppsSite[u32Index] != NULL)
+        {
+            pps = pijp->ijp_ppsSite[u32Index];
+            pijp->ijp_ppsSite[u32Index] = pps->ps_ppsNext;
+            jf_mem_free((void **)&pps);
+        }
+    }
+
+    jf_mutex_fini(&pijp->ijp_jmLock);
+
+    pijp->ijp_bInitialized = FALSE;
+
+    return u32Ret;
+}
+
+boolean_t sampleJiukunProfile(void * ptr, olsize_t size)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_jiukun_profile_t * pijp = &ls_ijpProfile;
+    void * pStack[MAX_PROFILE_STACK_DEPTH + 1];
+    u32 u32Depth = 0;
+    profile_site_t * pps = NULL;
+    profile_alloc_t * ppa = NULL;
+    u32 u32Bucket;
+    u64 u64Sample = pijp->ijp_u32Sample;
+
+    if (ls_s64ProfileCountdown == 0)
+        /*The first allocation of the thread.*/
+        ls_s64ProfileCountdown = _getProfileInterval(pijp);
+
+    ls_s64ProfileCountdown -= size;
+    if (ls_s64ProfileCountdown > 0)
+        return FALSE;
+
+    ls_s64ProfileCountdown = _getProfileInterval(pijp);
+
+    /*The first frame is this routine, it's not recorded.*/
+#if defined(LINUX)
+    u32Depth = (u32)backtrace(pStack, MAX_PROFILE_STACK_DEPTH + 1);
+#elif defined(WINDOWS)
+    u32Depth = (u32)CaptureStackBackTrace(0, MAX_PROFILE_STACK_DEPTH + 1, pStack, NULL);
+#endif
+    if (u32Depth > 0)
+        u32Depth --;
+
+    u32Ret = jf_mem_calloc((void **)&ppa, sizeof(profile_alloc_t));
+    if (u32Ret != JF_ERR_NO_ERROR)
+        return FALSE;
+
+    ppa->pa_pMem = ptr;
+    ppa->pa_sMem = size;
+    ppa->pa_u64Estimate = (u64)size;
+    if ((u64)size < 2 * u64Sample)
+        /*Inverse of the probability the allocation is sampled.*/
+        ppa->pa_u64Estimate = 4 * u64Sample * u64Sample / (4 * u64Sample - size);
+
+    u32Bucket = _hashProfilePointer(ptr, PROFILE_ALLOC_HASH_SIZE);
+
+    jf_mutex_acquire(&pijp->ijp_jmLock);
+
+    pps = _getProfileSite(pijp, &pStack[1], u32Depth);
+    if (pps != NULL)
+    {
+        pps->ps_u64LiveObj ++;
+        pps->ps_u64LiveByte += size;
+        pps->ps_u64LiveEstimate += ppa->pa_u64Estimate;
+        pps->ps_u64AllocObj ++;
+        pps->ps_u64AllocByte += size;
+
+        ppa->pa_ppsSite = pps;
+        ppa->pa_ppaNext = pijp->ijp_ppaAlloc[u32Bucket];
+        pijp->ijp_ppaAlloc[u32Bucket] = ppa;
+    }
+
+    jf_mutex_release(&pijp->ijp_jmLock);
+
+    if (pps == NULL)
+    {
+        jf_mem_free((void **)&ppa);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+void removeJiukunProfile(void * ptr)
+{
+    internal_jiukun_profile_t * pijp = &ls_ijpProfile;
+    profile_alloc_t ** pppa, * ppa = NULL;
+    profile_site_t * pps;
+
+    pppa = &pijp->ijp_ppaAlloc[_hashProfilePointer(ptr, PROFILE_ALLOC_HASH_SIZE)];
+
+    jf_mutex_acquire(&pijp->ijp_jmLock);
+
+    while (*pppa != NULL)
+    {
+        if ((*pppa)->pa_pMem == ptr)
+        {
+            ppa = *pppa;
+            *pppa = ppa->pa_ppaNext;
+
+            pps = ppa->pa_ppsSite;
+            pps->ps_u64LiveObj --;
+            pps->ps_u64LiveByte -= ppa->pa_sMem;
+            pps->ps_u64LiveEstimate -= ppa->pa_u64Estimate;
+            break;
+        }
+
+        pppa = &(*pppa)->pa_ppaNext;
+    }
+
+    jf_mutex_release(&pijp->ijp_jmLock);
+
+    if (ppa != NULL)
+        jf_mem_free((void **)&ppa);
+}
+
+u32 jf_jiukun_dumpProfile(const olchar_t * pstrFile)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_jiukun_profile_t * pijp = &ls_ijpProfile;
+
+    if (! pijp->ijp_bInitialized)
+        return JF_ERR_NOT_INITIALIZED;
+
+    jf_mutex_acquire(&pijp->ijp_jmLock);
+
+    if (pstrFile != NULL)
+        u32Ret = _writeProfileFile(pijp, pstrFile);
+    else
+        u32Ret = _logProfile(pijp);
+
+    jf_mutex_release(&pijp->ijp_jmLock);
+
+    return u32Ret;
+}
+
+/*------------------------------------------------------------------------------------------------*/
+
+
@@ -0,0 +1,57 @@
+/**
+ *  @file profile.h
+ *
+ *  @brief Profile header file, provide some functional routine for allocation profiling
+ *
+ *  @author Min Zhang
+ *
+ *  @note
+ *
+ */
+
+#ifndef JIUKUN_PROFILE_H
+#define JIUKUN_PROFILE_H
+
+/* --- standard C lib header files -------------------------------------------------------------- */
+
+/* --- internal header files -------------------------------------------------------------------- */
+#include "jf_basic.h"
+#include "jf_err.h"
+#include "jf_jiukun.h"
+
+/* --- constant definitions --------------------------------------------------------------------- */
+
+/* --- data structures -------------------------------------------------------------------------- */
+
+typedef struct
+{
+    /** sample one allocation per the bytes on average */
+    u32 pp_u32Sample;
+    u32 pp_u32Reserved[3];
+} profile_param_t;
+
+/* --- functional routines ---------------------------------------------------------------------- */
+u32 initJiukunProfile(profile_param_t * ppp);
+
+u32 finiJiukunProfile(void);
+
+/** Count the allocation and record it if it's sampled.
+ *
+ *  @param ptr [in] The allocated memory.
+ *  @param size [in] The size requested by caller.
+ *
+ *  @return TRUE if the allocation is sampled.
+ */
+boolean_t sampleJiukunProfile(void * ptr, olsize_t size);
+
+/** Remove the sampled allocation from profile.
+ *
+ *  @param ptr [in] The memory to be freed.
+ */
+void removeJiukunProfile(void * ptr);
+
+#endif /*JIUKUN_PROFILE_H*/
+
+/*------------------------------------------------------------------------------------------------*/
+
+
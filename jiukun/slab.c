@@ -20,9 +20,11 @@
 #include "jf_limit.h"
 #include "jf_mem.h"
 #include "jf_mutex.h"
+#include "jf_atomic.h"
 
 #include "common.h"
 #include "slab.h"
+#include "profile.h"
 
 /* --- private data/data structure section ------------------------------------------------------ */
 
@@ -51,6 +53,8 @@ typedef u32 slab_bufctl_t;
 typedef struct
 {
     jf_listhead_t s_jlList;
+    /**Pointer to the pages of the slab.*/
+    void * s_pPage;
     /**Pointer to objects.*/
     void * s_pMem;
     /**Num of objs active in slab.*/
@@ -94,6 +98,9 @@ typedef struct slab_cache
 
     /**Lock for the full, partial and free list.*/
     jf_mutex_t sc_jmCache;
+    /**Objs freed when the lock is held by other thread. They are linked by the word at
+       sc_u32FreeLink of the obj and returned to slabs by the thread acquiring the lock.*/
+    void * volatile sc_pRemoteFree;
     /**List for fully used slab.*/
     jf_listhead_t sc_jlFull;
     /**List for partial slab.*/
@@ -107,9 +114,28 @@ typedef struct slab_cache
     /**Page flags.*/
     jf_flag_t sc_jfPage;
 
+    /**Alignment of objects.*/
+    u32 sc_u32Align;
+    /**Color offset of slab.*/
+    u32 sc_u32ColorOff;
+    /**Number of colors, the offset of slab is in [0, sc_u32Color * sc_u32ColorOff).*/
+    u32 sc_u32Color;
+    /**Color of the next slab.*/
+    u32 sc_u32ColorNext;
+
     /**Cache for slab_t.*/
     struct slab_cache * sc_pscSlab;
 
+    /**Constructor of objs.*/
+    jf_jiukun_fnConstructObject_t sc_fnCtor;
+    /**Destructor of objs.*/
+    jf_jiukun_fnDestructObject_t sc_fnDtor;
+    /**Reference count of shared cache.*/
+    u32 sc_u32Ref;
+    /**Offset of the link of remote free list in the obj. It's 0 if the cache has no constructor,
+       otherwise the link is after the real obj so the constructed state is kept.*/
+    u32 sc_u32FreeLink;
+
     /**Cache name.*/
     olchar_t sc_strName[CACHE_NAME_LEN];
     /**Linked in cache_cache.*/
@@ -123,6 +149,12 @@ typedef struct slab_cache
     ulong sc_ulNumReaped;
     ulong sc_ulNumErrors;
 #endif
+#if DEBUG_JIUKUN
+    /**Number of allocation of memory from the general cache, protected by sc_jmCache.*/
+    u64 sc_u64Alloc;
+    /**Bytes requested by the allocation, to compute the internal fragmentation.*/
+    u64 sc_u64Request;
+#endif
 } slab_cache_t;
 
 
@@ -176,18 +208,30 @@ static olsize_t ls_sCacheSize[] =
 #undef CACHE
 } ;
 
-#define MAX_NUM_OF_GENERAL_CACHE  20
+/** Number of general cache, the sentinel is not counted.
+ */
+#define NUM_OF_GENERAL_CACHE      ((u32)(sizeof(ls_sCacheSize) / sizeof(ls_sCacheSize[0])) - 1)
+
+#define MAX_NUM_OF_GENERAL_CACHE  (80)
+
+/** The minimum size of general cache.
+ */
+#define MIN_GENERAL_CACHE_SIZE    (32)
 
 typedef struct internal_jiukun_slab
 {
     boolean_t ijs_bInitialized;
-    u8 ijs_u8Reserved[7];
+    /**Allocation profiling is enabled.*/
+    boolean_t ijs_bProfile;
+    u8 ijs_u8Reserved[6];
     /**New caches are linked to ijs_scCacheCache.sc_jlNext.*/
     slab_cache_t ijs_scCacheCache;
 
     u32 ijs_u32OffSlabLimit;
 
     jf_mutex_t ijs_smLock;
+    /**Lock for finding and creating the shared cache.*/
+    jf_mutex_t ijs_jmSharedCache;
 
     u8 ijs_u8Reserved2[16];
 
@@ -263,13 +307,13 @@ void _dumpSlabCache(slab_cache_t * pCache)
 #endif
 
 static inline u32 _allocObj(
-    internal_jiukun_slab_t * pijs, slab_cache_t * pCache, void ** ppObj);
+    internal_jiukun_slab_t * pijs, slab_cache_t * pCache, olsize_t sRequest, void ** ppObj);
 
 
 /** Cal the num objs, wastage, and bytes left over for a given slab size.
  */
 static void _slabCacheEstimate(
-    ulong jporder, olsize_t size,
+    ulong jporder, olsize_t size, u32 align,
     jf_flag_t flag, olsize_t * left_over, u32 * num)
 {
     olint_t i;
@@ -283,7 +327,7 @@ static void _slabCacheEstimate(
         extra = sizeof(slab_bufctl_t);
     }
     i = 0;
-    while (i * size + ALIGN(base + i * extra, SLAB_ALIGN_SIZE) <= wastage)
+    while (i * size + ALIGN(base + i * extra, align) <= wastage)
         i++;
     if (i > 0)
         i--;
@@ -293,7 +337,7 @@ static void _slabCacheEstimate(
 
     *num = i;
     wastage -= i * size;
-    wastage -= ALIGN(base + i * extra, SLAB_ALIGN_SIZE);
+    wastage -= ALIGN(base + i * extra, align);
     *left_over = wastage;
 }
 
@@ -313,6 +357,8 @@ static inline void _freePages(
     while (i--)
     {
         clearJpSlab(page);
+        /*The page may be used by other cache, the sampled allocation is no longer in the page.*/
+        clearJpSampled(page);
         page++;
     }
 
@@ -360,29 +406,30 @@ static inline void * _allocOneObjFromTail(slab_cache_t * pCache, slab_t * slabp)
     return objp;
 }
 
-/** Get the memory for a slab management obj.
+/** Get the memory for a slab management obj. The objs start after the color offset and the
+ *  on-slab management obj.
  */
 static inline slab_t * _slabMgmt(
-    internal_jiukun_slab_t * pijs, slab_cache_t * pCache, u8 * objp)
+    internal_jiukun_slab_t * pijs, slab_cache_t * pCache, u8 * objp, olint_t offset)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
     slab_t * slabp = NULL;
-    olint_t offset = 0;
 
     if (OFF_SLAB(pCache))
     {
         /*Slab management obj is off-slab.*/
-        u32Ret = _allocObj(pijs, pCache->sc_pscSlab, (void **)&slabp);
+        u32Ret = _allocObj(pijs, pCache->sc_pscSlab, 0, (void **)&slabp);
         if (u32Ret != JF_ERR_NO_ERROR)
             return NULL;
     }
     else
     {
-        slabp = (slab_t *)objp;
-        offset = ALIGN(
-            pCache->sc_u32Num * sizeof(slab_bufctl_t) + sizeof(slab_t), SLAB_ALIGN_SIZE);
+        slabp = (slab_t *)(objp + offset);
+        offset += ALIGN(
+            pCache->sc_u32Num * sizeof(slab_bufctl_t) + sizeof(slab_t), pCache->sc_u32Align);
     }
     slabp->s_u32InUse = 0;
+    slabp->s_pPage = objp;
     slabp->s_pMem = objp + offset;
 
     return slabp;
@@ -409,6 +456,20 @@ static inline void _initSlabCacheObjs(slab_cache_t * pCache, slab_t * slabp)
     slabp->s_sbFree = 0;
 }
 
+/** Get the obj returned to user with the index in slab.
+ */
+static inline void * _getSlabObj(slab_cache_t * pCache, slab_t * slabp, u32 u32Index)
+{
+    u8 * objp = (u8 *)slabp->s_pMem + pCache->sc_u32ObjSize * u32Index;
+
+#if DEBUG_JIUKUN
+    if (JF_FLAG_GET(pCache->sc_jfCache, SC_FLAG_RED_ZONE))
+        objp += SLAB_ALIGN_SIZE;
+#endif
+
+    return objp;
+}
+
 /** Grow the number of slabs within a cache. This is called by allocObj() when
  *  there are no active objs left in a cache.
  */
@@ -420,9 +481,19 @@ static u32 _growSlabCache(
     jiukun_page_t * page;
     void * objp;
     u32 i;
+    olint_t offset = 0;
 
     JF_FLAG_SET(pCache->sc_jfCache, SC_FLAG_GROWN);
 
+    /*Get the color offset of the slab, the cache lock is held.*/
+    if (pCache->sc_u32Color > 0)
+    {
+        offset = pCache->sc_u32ColorNext * pCache->sc_u32ColorOff;
+        pCache->sc_u32ColorNext ++;
+        if (pCache->sc_u32ColorNext >= pCache->sc_u32Color)
+            pCache->sc_u32ColorNext = 0;
+    }
+
     /*Get mem for the objs.*/
     jpflag |= pCache->sc_jfPage;
     u32Ret = jf_jiukun_allocPage(&objp, pCache->sc_u32Order, jpflag);
@@ -432,7 +503,7 @@ static u32 _growSlabCache(
         jf_logger_logInfoMsg("grow cache, addr: %p", objp);
 #endif
         /*Get slab management.*/
-        slabp = _slabMgmt(pijs, pCache, objp);
+        slabp = _slabMgmt(pijs, pCache, objp, offset);
         if (slabp == NULL)
         {
             _freePages(pijs, pCache, objp);
@@ -455,6 +526,13 @@ static u32 _growSlabCache(
 
         _initSlabCacheObjs(pCache, slabp);
 
+        /*Construct the objs, they are kept in constructed state until the slab is destroyed.*/
+        if (pCache->sc_fnCtor != NULL)
+        {
+            for (i = 0; i < pCache->sc_u32Num; i ++)
+                pCache->sc_fnCtor(_getSlabObj(pCache, slabp, i));
+        }
+
         /*Make slab active.*/
         jf_listhead_addTail(&(pCache->sc_jlFree), &(slabp->s_jlList));
         STATS_INC_GROWN(pCache);
@@ -485,8 +563,51 @@ static inline void _unlockSlabCache(
     jf_mutex_release(&pijs->ijs_smLock);
 }
 
+static inline void _freeOneObj(
+    internal_jiukun_slab_t * pijs, slab_cache_t *pCache, u8 * objp);
+
+/** Push the obj to the remote free list of the cache, the lock of the cache is not required.
+ */
+static inline void _pushRemoteFreeObj(slab_cache_t * pCache, void * objp)
+{
+    void * head;
+
+    do
+    {
+        head = jf_atomic_loadPointer(&pCache->sc_pRemoteFree);
+        *(void **)((u8 *)objp + pCache->sc_u32FreeLink) = head;
+    } while (! jf_atomic_casPointer(&pCache->sc_pRemoteFree, head, objp));
+}
+
+/** Return the objs in remote free list to slabs, the lock of the cache must be held.
+ *
+ *  @note
+ *  -# The whole list is taken with one exchange, so there is no ABA problem with the push.
+ */
+static inline void _drainRemoteFreeObj(internal_jiukun_slab_t * pijs, slab_cache_t * pCache)
+{
+    void * objp, * next;
+
+    if (jf_atomic_loadPointer(&pCache->sc_pRemoteFree) == NULL)
+        return;
+
+    objp = jf_atomic_exchangePointer(&pCache->sc_pRemoteFree, NULL);
+    while (objp != NULL)
+    {
+        next = *(void **)((u8 *)objp + pCache->sc_u32FreeLink);
+        _freeOneObj(pijs, pCache, objp);
+        objp = next;
+    }
+}
+
+/** Allocate obj from the cache.
+ *
+ *  @note
+ *  -# The requested size is counted for the allocation of memory from general cache in debug
+ *   build, it's 0 for other allocations.
+ */
 static inline u32 _allocObj(
-    internal_jiukun_slab_t * pijs, slab_cache_t * pCache, void ** ppObj)
+    internal_jiukun_slab_t * pijs, slab_cache_t * pCache, olsize_t sRequest, void ** ppObj)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
     jf_listhead_t * entry;
@@ -502,6 +623,9 @@ static inline u32 _allocObj(
 
     jf_mutex_acquire(&pCache->sc_jmCache);
 
+    /*Objs freed by other threads may make the partial or full slab available.*/
+    _drainRemoteFreeObj(pijs, pCache);
+
     while (*ppObj == NULL)
     {
         entry = pCache->sc_jlPartial.jl_pjlNext;
@@ -527,6 +651,15 @@ static inline u32 _allocObj(
         *ppObj = _allocOneObjFromTail(pCache, slabp);
     }
 
+#if DEBUG_JIUKUN
+    /*Count the allocation with the lock held, no extra lock for the statistics.*/
+    if ((*ppObj != NULL) && (sRequest != 0))
+    {
+        pCache->sc_u64Alloc ++;
+        pCache->sc_u64Request += sRequest;
+    }
+#endif
+
     jf_mutex_release(&pCache->sc_jmCache);
 
     _unlockSlabCache(pijs, pCache);
@@ -624,18 +757,31 @@ static inline void _freeOneObj(
     }
 }
 
+/** Free the obj to the cache.
+ *
+ *  @note
+ *  -# The free never waits for the lock of the cache. If the lock is held by other thread, e.g.
+ *   the obj is allocated by producer thread and freed by consumer thread, the obj is pushed to the
+ *   remote free list and it's returned to slab by the thread acquiring the lock later.
+ *  -# The lock of cache chain is not required as the free doesn't block the reaper for long.
+ *  -# The link of remote free list of the cache with constructor is after the real obj, so the
+ *   obj is still in constructed state when it's returned to slab.
+ */
 static inline void _freeObj(
     internal_jiukun_slab_t * pijs, slab_cache_t * pCache, void ** pptr)
 {
     assert(! JF_FLAG_GET(pCache->sc_jfCache, SC_FLAG_DESTROY));
 
-    _lockSlabCache(pijs, pCache);
-
-    jf_mutex_acquire(&pCache->sc_jmCache);
-    _freeOneObj(pijs, pCache, *pptr);
-    jf_mutex_release(&pCache->sc_jmCache);
-
-    _unlockSlabCache(pijs, pCache);
+    if (jf_mutex_tryAcquire(&pCache->sc_jmCache) == JF_ERR_NO_ERROR)
+    {
+        _drainRemoteFreeObj(pijs, pCache);
+        _freeOneObj(pijs, pCache, *pptr);
+        jf_mutex_release(&pCache->sc_jmCache);
+    }
+    else
+    {
+        _pushRemoteFreeObj(pCache, *pptr);
+    }
 
     *pptr = NULL;
 }
@@ -647,6 +793,13 @@ static void _destroySlab(
     internal_jiukun_slab_t * pijs, slab_cache_t * pCache, slab_t * slabp)
 {
     slab_t * pSlab = slabp;
+    u32 u32Index;
+
+    if (pCache->sc_fnDtor != NULL)
+    {
+        for (u32Index = 0; u32Index < pCache->sc_u32Num; u32Index ++)
+            pCache->sc_fnDtor(_getSlabObj(pCache, slabp, u32Index));
+    }
 
 #if DEBUG_JIUKUN
     if (JF_FLAG_GET(pCache->sc_jfCache, SC_FLAG_RED_ZONE))
@@ -666,8 +819,9 @@ static void _destroySlab(
     }
 #endif
 
-    _freePages(pijs, pCache, (u8 *)slabp->s_pMem);
+    _freePages(pijs, pCache, slabp->s_pPage);
     if (OFF_SLAB(pCache))
+        /*The free doesn't require the lock of cache chain, it's safe for reaper holding it.*/
         _freeObj(pijs, pCache->sc_pscSlab, (void **)&pSlab);
 }
 
@@ -701,6 +855,9 @@ static u32 _destroySlabCache(internal_jiukun_slab_t * pijs, slab_cache_t * psc)
 
     jf_logger_logInfoMsg("destroy jiukun cache %s", psc->sc_strName);
 
+    /*No obj is freed to the cache being destroyed, the lock is not required.*/
+    _drainRemoteFreeObj(pijs, psc);
+
     _destroySlabCacheSlabs(pijs, psc, &psc->sc_jlFree);
 
     _destroySlabCacheSlabs(pijs, psc, &psc->sc_jlPartial);
@@ -712,18 +869,50 @@ static u32 _destroySlabCache(internal_jiukun_slab_t * pijs, slab_cache_t * psc)
     return u32Ret;
 }
 
+/** Get the index of the most significant bit, the word should not be 0.
+ */
+static inline u32 _getMsb(u32 u32Word)
+{
+#if defined(LINUX)
+    return 31 - __builtin_clz(u32Word);
+#else
+    u32 u32Msb = 0;
+
+    while (u32Word >>= 1)
+        u32Msb ++;
+
+    return u32Msb;
+#endif
+}
+
+/** Map the size to the index of general cache.
+ *
+ *  @note
+ *  -# There are 4 classes per power of two. For size s larger than 32, let t = s - 1,
+ *   k = msb(t) and q = t >> (k - 2) which is in [4, 7], the smallest class holding s is
+ *   (q + 1) << (k - 2) and its index is (k - 5) * 4 + q - 3.
+ *  -# Size not larger than 32 (including 0) is folded to class 0 by or'ing 31 to t, the
+ *   comparisons are evaluated to 0 or 1 so no branch is required.
+ *  -# Size larger than the largest class results in an index beyond the last class.
+ */
+static inline u32 _getGeneralCacheIndex(olsize_t size)
+{
+    u32 t = (u32)size - (size != 0);
+    t |= (t < MIN_GENERAL_CACHE_SIZE - 1) * (MIN_GENERAL_CACHE_SIZE - 1);
+    u32 k = _getMsb(t);
+
+    return (k << 2) + (t >> (k - 2)) - 23;
+}
+
 static slab_cache_t * _findGeneralSlabCache(
     internal_jiukun_slab_t * pijs, olsize_t size, olint_t gfpflags)
 {
-    general_cache_t * pgc = &(pijs->ijs_gcGeneral[0]);
+    u32 u32Index = _getGeneralCacheIndex(size);
 
-    for ( ; pgc->gc_sSize != OLSIZE_MAX; pgc ++)
-    {
-        if (size > pgc->gc_sSize)
-            continue;
-        break;
-    }
-    return pgc->gc_pscCache;
+    if (u32Index >= NUM_OF_GENERAL_CACHE)
+        return NULL;
+
+    return pijs->ijs_gcGeneral[u32Index].gc_pscCache;
 }
 
 static u32 _createSlabCache(
@@ -734,6 +923,12 @@ static u32 _createSlabCache(
     olsize_t left_over, slab_size;
     slab_cache_t * pCache = NULL;
     u32 realobjsize = pjjccp->jjccp_sObj;
+    /*The size and flags are adjusted locally, the parameter of caller is not changed, so it can be
+      used again to create the same shared cache.*/
+    olsize_t sObj = pjjccp->jjccp_sObj;
+    jf_flag_t jfCache = pjjccp->jjccp_jfCache;
+    u32 freelink = 0;
+    u32 align = SLAB_ALIGN_SIZE;
 #ifdef DEBUG_JIUKUN
     jf_listhead_t * pjl;
 #endif
@@ -742,47 +937,70 @@ static u32 _createSlabCache(
         "create slab cache, %s, size: %u, flag: 0x%llX",
         pjjccp->jjccp_pstrName, pjjccp->jjccp_sObj, pjjccp->jjccp_jfCache);
 
+    if (pjjccp->jjccp_fnCtor != NULL)
+    {
+        /*Reserve a word after the real obj for the link of remote free list, the link doesn't
+          overwrite the constructed obj.*/
+        freelink = ALIGN(realobjsize, BYTES_PER_POINTER);
+        sObj = freelink + BYTES_PER_POINTER;
+    }
+
+    if (JF_FLAG_GET(jfCache, JF_JIUKUN_CACHE_CREATE_FLAG_PAD))
+    {
+        /*Objs are aligned to cache line and occupy the whole lines.*/
+        align = JF_JIUKUN_CACHE_LINE_SIZE;
+        sObj = ALIGN(sObj, JF_JIUKUN_CACHE_LINE_SIZE);
+    }
+    else if (JF_FLAG_GET(jfCache, JF_JIUKUN_CACHE_CREATE_FLAG_HWCACHE_ALIGN))
+    {
+        /*Small objs are packed in cache line with the alignment of power of two fraction of the
+          line, so no obj crosses the line.*/
+        align = JF_JIUKUN_CACHE_LINE_SIZE;
+        while ((align > SLAB_ALIGN_SIZE) && (sObj <= (align >> 1)))
+            align >>= 1;
+    }
+
 #if DEBUG_JIUKUN
-    /*Do not red zone large object, causes severe fragmentation.*/
-    if (pjjccp->jjccp_sObj < (BUDDY_PAGE_SIZE >> 3))
-        JF_FLAG_SET(pjjccp->jjccp_jfCache, SC_FLAG_RED_ZONE);
+    /*Do not red zone large object, causes severe fragmentation. Do not red zone aligned object,
+      the red zone breaks the alignment.*/
+    if ((sObj < (BUDDY_PAGE_SIZE >> 3)) && (align == SLAB_ALIGN_SIZE))
+        JF_FLAG_SET(jfCache, SC_FLAG_RED_ZONE);
 
 #endif
 
     /*Check that size is in terms of words. This is needed to avoid unaligned accesses for some
       archs when redzoning is used, and makes sure any on-slab bufctl's are also correctly
       aligned.*/
-    pjjccp->jjccp_sObj = ALIGN(pjjccp->jjccp_sObj, SLAB_ALIGN_SIZE);
+    sObj = ALIGN(sObj, align);
 
     /*Get cache's description obj.*/
-    u32Ret = _allocObj(pijs, &(pijs->ijs_scCacheCache), (void **)&pCache);
+    u32Ret = _allocObj(pijs, &(pijs->ijs_scCacheCache), 0, (void **)&pCache);
     if (u32Ret == JF_ERR_NO_ERROR)
     {
         ol_memset(pCache, 0, sizeof(slab_cache_t));
 
 #if DEBUG_JIUKUN
-        if (JF_FLAG_GET(pjjccp->jjccp_jfCache, SC_FLAG_RED_ZONE))
+        if (JF_FLAG_GET(jfCache, SC_FLAG_RED_ZONE))
         {
-            pjjccp->jjccp_sObj += 2 * SLAB_ALIGN_SIZE;   /* words for redzone */
+            sObj += 2 * SLAB_ALIGN_SIZE;   /* words for redzone */
         }
 #endif
         /*Determine if the slab management is 'on' or 'off' slab.*/
-        if (pjjccp->jjccp_sObj >= (BUDDY_PAGE_SIZE >> 3))
+        if (sObj >= (BUDDY_PAGE_SIZE >> 3))
             /*Size is large, assume best to place the slab management obj off-slab (should allow
               better packing of objs).*/
-            JF_FLAG_SET(pjjccp->jjccp_jfCache, SC_FLAG_OFF_SLAB);
+            JF_FLAG_SET(jfCache, SC_FLAG_OFF_SLAB);
     }
 
     if (u32Ret == JF_ERR_NO_ERROR)
     {
+        u32 break_flag = 0;
+
         /*Cal size (in pages) of slabs, and the num of objs per slab.*/
         do
         {
-            u32 break_flag = 0;
-
             _slabCacheEstimate(
-                pCache->sc_u32Order, pjjccp->jjccp_sObj,
-                pjjccp->jjccp_jfCache, &left_over, &pCache->sc_u32Num);
+                pCache->sc_u32Order, sObj, align, jfCache, &left_over, &pCache->sc_u32Num);
             if (break_flag)
                 break;
             if (pCache->sc_u32Order >= MAX_JP_ORDER)
@@ -792,7 +1010,7 @@ static u32 _createSlabCache(
                 pCache->sc_u32Order++;
                 continue;
             }
-            if (JF_FLAG_GET(pjjccp->jjccp_jfCache, SC_FLAG_OFF_SLAB) &&
+            if (JF_FLAG_GET(jfCache, SC_FLAG_OFF_SLAB) &&
                 (pCache->sc_u32Num > pijs->ijs_u32OffSlabLimit))
             {
                 /*This num of objs will cause problems.*/
@@ -802,14 +1020,17 @@ static u32 _createSlabCache(
             }
             if ((left_over * 8) <= (BUDDY_PAGE_SIZE << pCache->sc_u32Order))
                 break;  /* Acceptable internal fragmentation. */
+
+            /*Too much left over, try the next order.*/
+            pCache->sc_u32Order++;
         } while (1);
     }
 
     if (u32Ret == JF_ERR_NO_ERROR)
     {
         jf_logger_logInfoMsg(
-            "create slab cache, %s, size: %u, order: %u, num: %u",
-            pjjccp->jjccp_pstrName, pjjccp->jjccp_sObj, pCache->sc_u32Order, pCache->sc_u32Num);
+            "create slab cache, %s, size: %u, align: %u, order: %u, num: %u",
+            pjjccp->jjccp_pstrName, sObj, align, pCache->sc_u32Order, pCache->sc_u32Num);
 
         if (pCache->sc_u32Num == 0)
         {
@@ -820,32 +1041,46 @@ static u32 _createSlabCache(
 
     if (u32Ret == JF_ERR_NO_ERROR)
     {
-        slab_size = ALIGN(
-            pCache->sc_u32Num * sizeof(slab_bufctl_t) + sizeof(slab_t), SLAB_ALIGN_SIZE);
+        slab_size = ALIGN(pCache->sc_u32Num * sizeof(slab_bufctl_t) + sizeof(slab_t), align);
 
         /*If the slab has been placed off-slab, and we have enough space then move it on-slab.*/
-        if (JF_FLAG_GET(pjjccp->jjccp_jfCache, SC_FLAG_OFF_SLAB) && (left_over >= slab_size))
+        if (JF_FLAG_GET(jfCache, SC_FLAG_OFF_SLAB) && (left_over >= slab_size))
         {
-            JF_FLAG_CLEAR(pjjccp->jjccp_jfCache, SC_FLAG_OFF_SLAB);
+            JF_FLAG_CLEAR(jfCache, SC_FLAG_OFF_SLAB);
             left_over -= slab_size;
         }
 
-        pCache->sc_jfCache = pjjccp->jjccp_jfCache;
+        pCache->sc_jfCache = jfCache;
         pCache->sc_jfPage = 0;
+        pCache->sc_u32Align = align;
+
+        /*The left over is used to color the slabs, the color offset is aligned so the objs are
+          still aligned.*/
+        if (JF_FLAG_GET(jfCache, JF_JIUKUN_CACHE_CREATE_FLAG_COLOR))
+        {
+            pCache->sc_u32ColorOff = JF_JIUKUN_CACHE_LINE_SIZE;
+            if (pjjccp->jjccp_sOffset != 0)
+                pCache->sc_u32ColorOff = ALIGN(pjjccp->jjccp_sOffset, align);
+            pCache->sc_u32Color = left_over / pCache->sc_u32ColorOff + 1;
+        }
 
         u32Ret = jf_mutex_init(&(pCache->sc_jmCache));
     }
 
     if (u32Ret == JF_ERR_NO_ERROR)
     {
-        pCache->sc_u32ObjSize = pjjccp->jjccp_sObj;
+        pCache->sc_u32ObjSize = sObj;
         pCache->sc_u32RealObjSize = realobjsize;
+        pCache->sc_u32FreeLink = freelink;
+        pCache->sc_fnCtor = pjjccp->jjccp_fnCtor;
+        pCache->sc_fnDtor = pjjccp->jjccp_fnDtor;
+        pCache->sc_u32Ref = 1;
 
         jf_listhead_init(&(pCache->sc_jlFull));
         jf_listhead_init(&(pCache->sc_jlPartial));
         jf_listhead_init(&(pCache->sc_jlFree));
 
-        if (JF_FLAG_GET(pjjccp->jjccp_jfCache, SC_FLAG_OFF_SLAB))
+        if (JF_FLAG_GET(jfCache, SC_FLAG_OFF_SLAB))
             pCache->sc_pscSlab = _findGeneralSlabCache(pijs, slab_size, 0);
         ol_strncpy(pCache->sc_strName, pjjccp->jjccp_pstrName, CACHE_NAME_LEN - 1);
 
@@ -869,6 +1104,66 @@ static u32 _createSlabCache(
     return u32Ret;
 }
 
+/** Find the shared cache with the same name, the reference count is increased if it's found.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR The cache is found or no cache with the name.
+ *  @retval JF_ERR_FAIL_CREATE_JIUKUN_CACHE The object size or constructor doesn't match.
+ */
+static u32 _findSharedSlabCache(
+    internal_jiukun_slab_t * pijs, jf_jiukun_cache_create_param_t * pjjccp,
+    slab_cache_t ** ppCache)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    slab_cache_t * pc;
+    jf_listhead_t * pjl;
+
+    *ppCache = NULL;
+
+    jf_mutex_acquire(&(pijs->ijs_smLock));
+
+    jf_listhead_forEach(&(pijs->ijs_scCacheCache.sc_jlNext), pjl)
+    {
+        pc = jf_listhead_getEntry(pjl, slab_cache_t, sc_jlNext);
+
+        if (JF_FLAG_GET(pc->sc_jfCache, JF_JIUKUN_CACHE_CREATE_FLAG_SHARED) &&
+            (ol_strcmp(pc->sc_strName, pjjccp->jjccp_pstrName) == 0))
+        {
+            if ((pc->sc_u32RealObjSize != pjjccp->jjccp_sObj) ||
+                (pc->sc_fnCtor != pjjccp->jjccp_fnCtor))
+            {
+                u32Ret = JF_ERR_FAIL_CREATE_JIUKUN_CACHE;
+                jf_logger_logErrMsg(
+                    u32Ret, "find shared cache, %s, size %u or constructor doesn't match",
+                    pc->sc_strName, (u32)pjjccp->jjccp_sObj);
+                break;
+            }
+
+            pc->sc_u32Ref ++;
+            *ppCache = pc;
+            break;
+        }
+    }
+
+    jf_mutex_release(&(pijs->ijs_smLock));
+
+    return u32Ret;
+}
+
+/** Remove the cache from the chain of caches and destroy it.
+ */
+static void _removeSlabCache(internal_jiukun_slab_t * pijs, slab_cache_t * psc)
+{
+    jf_mutex_acquire(&(pijs->ijs_smLock));
+    /*The chain is never empty, cache_cache is never destroyed.*/
+    jf_listhead_del(&(psc->sc_jlNext));
+    JF_FLAG_SET(psc->sc_jfCache, SC_FLAG_DESTROY);
+    jf_mutex_release(&(pijs->ijs_smLock));
+
+    _destroySlabCache(pijs, psc);
+    _freeObj(pijs, &pijs->ijs_scCacheCache, (void **)&psc);
+}
+
 static u32 _initSlabCache(internal_jiukun_slab_t * pijs)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
@@ -886,16 +1181,19 @@ static u32 _initSlabCache(internal_jiukun_slab_t * pijs)
     jf_listhead_init(&(pkc->sc_jlFree));
 
     pkc->sc_u32ObjSize = sizeof(slab_cache_t);
+    pkc->sc_u32Align = SLAB_ALIGN_SIZE;
     JF_FLAG_SET(pkc->sc_jfCache, JF_JIUKUN_CACHE_CREATE_FLAG_NOREAP);
     ol_strcpy(pkc->sc_strName, "cache_cache");
 
-    _slabCacheEstimate(0, pkc->sc_u32ObjSize, 0, &left_over, &(pkc->sc_u32Num));
+    _slabCacheEstimate(
+        0, pkc->sc_u32ObjSize, pkc->sc_u32Align, 0, &left_over, &(pkc->sc_u32Num));
 
     sizes = &(pijs->ijs_gcGeneral[0]);
 
     while ((ls_sCacheSize[u16NumOfSize] != OLSIZE_MAX) && (u32Ret == JF_ERR_NO_ERROR))
     {
         sizes->gc_sSize = ls_sCacheSize[u16NumOfSize];
+        assert(_getGeneralCacheIndex(sizes->gc_sSize) == u16NumOfSize);
         ol_snprintf(name, sizeof(name), "size-%d", sizes->gc_sSize);
 
         ol_memset(&jjccp, 0, sizeof(jjccp));
@@ -931,16 +1229,24 @@ static u32 _initSlabCache(internal_jiukun_slab_t * pijs)
     return u32Ret;
 }
 
-/** Shrink slab cache.
+/** Destroy the free slabs of the cache, the specified number of free slabs are kept.
  */
 static olint_t _shrinkSlabCache(
-    internal_jiukun_slab_t * pijs, slab_cache_t * pCache)
+    internal_jiukun_slab_t * pijs, slab_cache_t * pCache, u32 u32Keep)
 {
     slab_t * slabp;
     olint_t ret = 0;
     jf_listhead_t * p;
+    u32 u32Free = 0;
+
+    _drainRemoteFreeObj(pijs, pCache);
 
-    while (1)
+    jf_listhead_forEach(&(pCache->sc_jlFree), p)
+    {
+        u32Free ++;
+    }
+
+    while (u32Free > u32Keep)
     {
         p = pCache->sc_jlFree.jl_pjlPrev;
         if (p == &(pCache->sc_jlFree))
@@ -954,6 +1260,7 @@ static olint_t _shrinkSlabCache(
 
         _destroySlab(pijs, pCache, slabp);
         ret++;
+        u32Free --;
     }
 
     return ret;
@@ -995,9 +1302,14 @@ u32 initJiukunSlab(slab_param_t * psp)
     assert(psp != NULL);
     assert(! pijs->ijs_bInitialized);
 
+    pijs->ijs_bProfile = psp->sp_bProfile;
+
     if (u32Ret == JF_ERR_NO_ERROR)
         u32Ret = jf_mutex_init(&(pijs->ijs_smLock));
 
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = jf_mutex_init(&(pijs->ijs_jmSharedCache));
+
     if (u32Ret == JF_ERR_NO_ERROR)
         u32Ret = _initSlabCache(pijs);
 
@@ -1032,6 +1344,7 @@ u32 finiJiukunSlab(void)
     psc = &(pijs->ijs_scCacheCache);
     _destroySlabCache(pijs, psc);
 
+    jf_mutex_fini(&(pijs->ijs_jmSharedCache));
     jf_mutex_fini(&(pijs->ijs_smLock));
 
     pijs->ijs_bInitialized = FALSE;
@@ -1053,8 +1366,20 @@ u32 jf_jiukun_createCache(
     assert((pjjccp->jjccp_pstrName != NULL) &&
            (pjjccp->jjccp_sObj >= SLAB_ALIGN_SIZE) &&
            (pjjccp->jjccp_sObj <= (1 << MAX_JP_ORDER) * BUDDY_PAGE_SIZE));
+    assert((pjjccp->jjccp_fnCtor == NULL) ||
+           ! JF_FLAG_GET(pjjccp->jjccp_jfCache, JF_JIUKUN_CACHE_CREATE_FLAG_ZERO));
+
+    if (! JF_FLAG_GET(pjjccp->jjccp_jfCache, JF_JIUKUN_CACHE_CREATE_FLAG_SHARED))
+        return _createSlabCache(pijs, ppCache, pjjccp);
+
+    /*The lock is held until the cache is created, so only one cache is created.*/
+    jf_mutex_acquire(&(pijs->ijs_jmSharedCache));
+
+    u32Ret = _findSharedSlabCache(pijs, pjjccp, (slab_cache_t **)ppCache);
+    if ((u32Ret == JF_ERR_NO_ERROR) && (*ppCache == NULL))
+        u32Ret = _createSlabCache(pijs, ppCache, pjjccp);
 
-    u32Ret = _createSlabCache(pijs, ppCache, pjjccp);
+    jf_mutex_release(&(pijs->ijs_jmSharedCache));
 
     return u32Ret;
 }
@@ -1070,15 +1395,18 @@ u32 jf_jiukun_destroyCache(jf_jiukun_cache_t ** ppCache)
     psc = (slab_cache_t *) *ppCache;
     *ppCache = NULL;
 
-    /*Find the cache in the chain of caches.*/
-    jf_mutex_acquire(&(pijs->ijs_smLock));
-    /*The chain is never empty, cache_cache is never destroyed.*/
-    jf_listhead_del(&(psc->sc_jlNext));
-    JF_FLAG_SET(psc->sc_jfCache, SC_FLAG_DESTROY);
-    jf_mutex_release(&(pijs->ijs_smLock));
+    if (! JF_FLAG_GET(psc->sc_jfCache, JF_JIUKUN_CACHE_CREATE_FLAG_SHARED))
+    {
+        _removeSlabCache(pijs, psc);
+        return u32Ret;
+    }
 
-    _destroySlabCache(pijs, psc);
-    _freeObj(pijs, &pijs->ijs_scCacheCache, (void **)&psc);
+    /*The shared cache is destroyed by the last creator.*/
+    jf_mutex_acquire(&(pijs->ijs_jmSharedCache));
+    psc->sc_u32Ref --;
+    if (psc->sc_u32Ref == 0)
+        _removeSlabCache(pijs, psc);
+    jf_mutex_release(&(pijs->ijs_jmSharedCache));
 
     return u32Ret;
 }
@@ -1136,7 +1464,7 @@ olint_t reapJiukunSlab(boolean_t bNoWait)
         _dumpSlabCache(searchp);
 #endif
 
-        ret += _shrinkSlabCache(pijs, searchp);
+        ret += _shrinkSlabCache(pijs, searchp, 0);
 
         jf_mutex_release(&(searchp->sc_jmCache));
     }
@@ -1146,6 +1474,104 @@ olint_t reapJiukunSlab(boolean_t bNoWait)
     return ret;
 }
 
+olint_t trimJiukunSlab(u32 u32FreeSlab)
+{
+    internal_jiukun_slab_t * pijs = &ls_iasSlab;
+    slab_cache_t * searchp;
+    olint_t ret = 0;
+    jf_listhead_t * pjl;
+
+    assert(pijs->ijs_bInitialized);
+
+    /*Cache is being created or destroyed, trim it next time.*/
+    if (jf_mutex_tryAcquire(&(pijs->ijs_smLock)) != JF_ERR_NO_ERROR)
+        return ret;
+
+    jf_listhead_forEach(&(pijs->ijs_scCacheCache.sc_jlNext), pjl)
+    {
+        searchp = jf_listhead_getEntry(pjl, slab_cache_t, sc_jlNext);
+
+        if (JF_FLAG_GET(searchp->sc_jfCache, JF_JIUKUN_CACHE_CREATE_FLAG_NOREAP) ||
+            JF_FLAG_GET(searchp->sc_jfCache, SC_FLAG_GROWN) ||
+            JF_FLAG_GET(searchp->sc_jfCache, SC_FLAG_LOCKED))
+            continue;
+
+        jf_mutex_acquire(&(searchp->sc_jmCache));
+        ret += _shrinkSlabCache(pijs, searchp, u32FreeSlab);
+        jf_mutex_release(&(searchp->sc_jmCache));
+    }
+
+    jf_mutex_release(&(pijs->ijs_smLock));
+
+    return ret;
+}
+
+#if defined(DEBUG_JIUKUN)
+void dumpJiukunSlab(void)
+{
+    internal_jiukun_slab_t * pijs = &ls_iasSlab;
+    general_cache_t * pgc = NULL;
+    slab_cache_t * psc = NULL;
+    jf_listhead_t * pjl = NULL;
+    slab_t * slabp = NULL;
+    u32 u32Index = 0, u32Slabs = 0, u32InUse = 0;
+    u64 u64Slab = 0, u64InUse = 0, u64Alloc = 0;
+    u32 u32Internal = 0, u32External = 0;
+
+    assert(pijs->ijs_bInitialized);
+
+    jf_logger_logInfoMsg("dump jiukun slab, general cache");
+
+    for (u32Index = 0; u32Index < NUM_OF_GENERAL_CACHE; u32Index ++)
+    {
+        pgc = &pijs->ijs_gcGeneral[u32Index];
+        psc = pgc->gc_pscCache;
+        u32Slabs = u32InUse = 0;
+
+        jf_mutex_acquire(&psc->sc_jmCache);
+        _drainRemoteFreeObj(pijs, psc);
+
+        jf_listhead_forEach(&psc->sc_jlFull, pjl)
+        {
+            u32Slabs ++;
+            u32InUse += psc->sc_u32Num;
+        }
+        jf_listhead_forEach(&psc->sc_jlPartial, pjl)
+        {
+            slabp = jf_listhead_getEntry(pjl, slab_t, s_jlList);
+            u32Slabs ++;
+            u32InUse += slabp->s_u32InUse;
+        }
+        jf_listhead_forEach(&psc->sc_jlFree, pjl)
+        {
+            u32Slabs ++;
+        }
+        u64Alloc = psc->sc_u64Alloc;
+        u32Internal = 0;
+        if (u64Alloc != 0)
+            /*Bytes wasted by rounding up the requested size to the class size.*/
+            u32Internal = (u32)(100 - psc->sc_u64Request * 100 / (u64Alloc * pgc->gc_sSize));
+
+        jf_mutex_release(&psc->sc_jmCache);
+
+        if (u64Alloc == 0)
+            continue;
+
+        /*Bytes of the slabs not used by the active objects.*/
+        u64Slab = (u64)u32Slabs * (BUDDY_PAGE_SIZE << psc->sc_u32Order);
+        u64InUse = (u64)u32InUse * pgc->gc_sSize;
+        u32External = 0;
+        if (u64Slab != 0)
+            u32External = (u32)((u64Slab - u64InUse) * 100 / u64Slab);
+
+        jf_logger_logInfoMsg(
+            "%s, alloc %llu, avg request %llu, internal frag %u%%, slabs %u, active %u, "
+            "external frag %u%%", psc->sc_strName, u64Alloc, psc->sc_u64Request / u64Alloc,
+            u32Internal, u32Slabs, u32InUse, u32External);
+    }
+}
+#endif
+
 void jf_jiukun_freeObject(jf_jiukun_cache_t * pCache, void ** pptr)
 {
     internal_jiukun_slab_t * pijs = &ls_iasSlab;
@@ -1153,6 +1579,9 @@ void jf_jiukun_freeObject(jf_jiukun_cache_t * pCache, void ** pptr)
     assert(pijs->ijs_bInitialized);
     assert((pCache != NULL) && (pptr != NULL) && (*pptr != NULL));
 
+    if (pijs->ijs_bProfile && isJpSampled(addrToJiukunPage(*pptr)))
+        removeJiukunProfile(*pptr);
+
     _freeObj(pijs, (slab_cache_t *)pCache, pptr);
     *pptr = NULL;
 }
@@ -1166,11 +1595,14 @@ u32 jf_jiukun_allocObject(jf_jiukun_cache_t * pCache, void ** pptr)
     assert(pijs->ijs_bInitialized);
     assert((pCache != NULL) && (pptr != NULL));
 
-    u32Ret = _allocObj(pijs, cache, pptr);
+    u32Ret = _allocObj(pijs, cache, 0, pptr);
     if (u32Ret == JF_ERR_NO_ERROR)
     {
         if (JF_FLAG_GET(cache->sc_jfCache, JF_JIUKUN_CACHE_CREATE_FLAG_ZERO))
             ol_memset(*pptr, 0, cache->sc_u32RealObjSize);
+
+        if (pijs->ijs_bProfile && sampleJiukunProfile(*pptr, cache->sc_u32RealObjSize))
+            setJpSampled(addrToJiukunPage(*pptr));
     }
 
 #if defined(DEBUG_JIUKUN_VERBOSE)
@@ -1184,19 +1616,21 @@ u32 jf_jiukun_allocMemory(void ** pptr, olsize_t size)
 {
     u32 u32Ret = JF_ERR_UNSUPPORTED_MEMORY_SIZE;
     internal_jiukun_slab_t * pijs = &ls_iasSlab;
-    general_cache_t * pgc = pijs->ijs_gcGeneral;
+    u32 u32Index = _getGeneralCacheIndex(size);
+    general_cache_t * pgc = NULL;
 
     assert(pijs->ijs_bInitialized);
 
     *pptr = NULL;
 
-    for ( ; pgc->gc_sSize != OLSIZE_MAX; pgc++) 
+    if (u32Index < NUM_OF_GENERAL_CACHE)
     {
-        if (size > pgc->gc_sSize)
-            continue;
+        pgc = &pijs->ijs_gcGeneral[u32Index];
 
-        u32Ret = _allocObj(pijs, pgc->gc_pscCache, pptr);
-        break;
+        u32Ret = _allocObj(pijs, pgc->gc_pscCache, size, pptr);
+        if ((u32Ret == JF_ERR_NO_ERROR) && pijs->ijs_bProfile &&
+            sampleJiukunProfile(*pptr, size))
+            setJpSampled(addrToJiukunPage(*pptr));
     }
 
 #if defined(DEBUG_JIUKUN_VERBOSE)
@@ -1211,6 +1645,7 @@ void jf_jiukun_freeMemory(void ** pptr)
     slab_cache_t * pCache;
     internal_jiukun_slab_t * pijs = &ls_iasSlab;
     void * objp = * pptr;
+    jiukun_page_t * pap;
 
     assert(pijs->ijs_bInitialized);
     assert((pptr != NULL) && (*pptr != NULL));
@@ -1219,7 +1654,13 @@ void jf_jiukun_freeMemory(void ** pptr)
     jf_logger_logInfoMsg("free sized obj, %p", *pptr);
 #endif
 
-    pCache = GET_PAGE_CACHE(addrToJiukunPage(objp));
+    pap = addrToJiukunPage(objp);
+    pCache = GET_PAGE_CACHE(pap);
+
+    /*Only the page with sampled allocation is looked up, the flag is cleared when the page is
+      returned to buddy.*/
+    if (pijs->ijs_bProfile && isJpSampled(pap))
+        removeJiukunProfile(objp);
 
     _freeObj(pijs, pCache, pptr);
 }
@@ -25,7 +25,9 @@
 /* --- data structures -------------------------------------------------------------------------- */
 typedef struct
 {
-    u8 sp_u8Reserved[16];
+    /** sample the allocation for profiling */
+    boolean_t sp_bProfile;
+    u8 sp_u8Reserved[15];
 } slab_param_t;
 
 /* --- functional routines ---------------------------------------------------------------------- */
@@ -41,6 +43,20 @@ u32 finiJiukunSlab(void);
  */
 olint_t reapJiukunSlab(boolean_t bNoWait);
 
+/** Destroy the free slabs beyond the watermark in each cache, the lock is not waited.
+ *
+ *  @param u32FreeSlab [in] number of free slabs kept in each cache
+ *
+ *  @return number of slabs destroyed
+ */
+olint_t trimJiukunSlab(u32 u32FreeSlab);
+
+#if defined(DEBUG_JIUKUN)
+/** Dump the general caches with the internal and external fragmentation of each size class.
+ */
+void dumpJiukunSlab(void);
+#endif
+
 #endif /*JIUKUN_SLAB_H*/
 
 /*------------------------------------------------------------------------------------------------*/
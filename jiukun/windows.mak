@@ -14,9 +14,10 @@ DLLNAME = jf_jiukun
 
 RESOURCE = jiukun
 
-SOURCES = buddy.c slab.c mempool.c jiukun.c
+SOURCES = buddy.c slab.c mempool.c arena.c profile.c jiukun.c
 
-JIUTAI_SRCS = $(JIUTAI_DIR)\jf_mem.c $(JIUTAI_DIR)\jf_mutex.c
+JIUTAI_SRCS = $(JIUTAI_DIR)\jf_mem.c $(JIUTAI_DIR)\jf_mutex.c $(JIUTAI_DIR)\jf_sem.c \
+    $(JIUTAI_DIR)\jf_thread.c
 
 EXTRA_DEFS = -DJIUFENG_JIUKUN_DLL
 
@@ -6,11 +6,14 @@
  *  @author Min Zhang
  *
  *  @note
- *  
+ *  -# The elements are stored in a contiguous buffer which is doubled when it's full, the buffer is
+ *   allocated from jiukun.
+ *  -# The buffer is not shrunk when elements are removed, it's freed when the array is destroyed.
  */
 
 /* --- standard C lib header files -------------------------------------------------------------- */
 #include <stdlib.h>
+#include <string.h>
 
 /* --- internal header files -------------------------------------------------------------------- */
 #include "jf_basic.h"
@@ -20,91 +23,91 @@
 
 /* --- private data/data structure section ------------------------------------------------------ */
 
-/** Define the internal array node data type.
+/** Capacity of the buffer when the first element is added.
  */
-typedef struct internal_jf_array_node_t
-{
-    /**The element of the node.*/
-    jf_array_element_t * ijan_pjaeElement;
-    /**The pointer to the next node.*/
-    struct internal_jf_array_node_t * ijan_pijanNext;
-} internal_jf_array_node_t;
+#define JF_ARRAY_MIN_CAPACITY                   (8)
+
+/** Maximum capacity of the buffer, the buffer is allocated from jiukun.
+ */
+#define JF_ARRAY_MAX_CAPACITY                   \
+    (JF_JIUKUN_MAX_MEMORY_SIZE / sizeof(jf_array_element_t *))
 
 /** Define the internal array data type.
  */
 typedef struct
 {
-    /**Number of node in the array.*/
+    /**Number of element in the array.*/
     u32 ija_u32ArraySize;
-    /**The first node in the array.*/
-    internal_jf_array_node_t * ija_pijanElements;
+    /**Number of element the buffer can hold.*/
+    u32 ija_u32Capacity;
+    /**The buffer of elements.*/
+    jf_array_element_t ** ija_ppjaeElements;
 } internal_jf_array_t;
 
 /* --- private routine section ------------------------------------------------------------------ */
 
-/** Get element at specified position.
+/** Make sure the buffer can hold the number of elements.
  */
-static u32 _getElementAt(internal_jf_array_t * pija, u32 u32Index, jf_array_element_t ** ppjae)
+static u32 _reserveArray(internal_jf_array_t * pija, u32 u32Capacity)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
-    internal_jf_array_node_t * pijan = NULL;
-    u32 u32Pos = 0;
+    jf_array_element_t ** ppjae = NULL;
+    u32 u32New;
+
+    if (u32Capacity <= pija->ija_u32Capacity)
+        return u32Ret;
+
+    if (u32Capacity > JF_ARRAY_MAX_CAPACITY)
+        return JF_ERR_OUT_OF_MEMORY;
 
-    pijan = pija->ija_pijanElements;
-    while ((u32Pos < u32Index) && (pijan != NULL))
+    /*Double the capacity so the append is amortized O(1).*/
+    u32New = pija->ija_u32Capacity * 2;
+    if (u32New < JF_ARRAY_MIN_CAPACITY)
+        u32New = JF_ARRAY_MIN_CAPACITY;
+    if (u32New < u32Capacity)
+        u32New = u32Capacity;
+    if (u32New > JF_ARRAY_MAX_CAPACITY)
+        u32New = JF_ARRAY_MAX_CAPACITY;
+
+    u32Ret = jf_jiukun_allocMemory((void **)&ppjae, u32New * sizeof(jf_array_element_t *));
+    if (u32Ret == JF_ERR_NO_ERROR)
     {
-        pijan = pijan->ijan_pijanNext;
-        u32Pos ++;
-    }
+        if (pija->ija_ppjaeElements != NULL)
+        {
+            ol_memcpy(
+                ppjae, pija->ija_ppjaeElements,
+                pija->ija_u32ArraySize * sizeof(jf_array_element_t *));
+            jf_jiukun_freeMemory((void **)&pija->ija_ppjaeElements);
+        }
 
-    if ((u32Pos == u32Index) && (pijan != NULL))
-        *ppjae = pijan->ijan_pjaeElement;
-    else
-        u32Ret = JF_ERR_OUT_OF_RANGE;
+        pija->ija_ppjaeElements = ppjae;
+        pija->ija_u32Capacity = u32New;
+    }
 
     return u32Ret;
 }
 
-/** Remove element at specified position.
+/** Remove the number of elements starting from the position, the elements after them are moved
+ *  forward.
  */
-static u32 _removeElementAt(
-    internal_jf_array_t * pija, u32 u32Index, jf_array_fnDestroyElement_t fnDestoryElement)
+static void _removeElementsAt(
+    internal_jf_array_t * pija, u32 u32Index, u32 u32Num,
+    jf_array_fnDestroyElement_t fnDestroyElement)
 {
-    u32 u32Ret = JF_ERR_NO_ERROR;
-    internal_jf_array_node_t * pijanPrevious = NULL, * pijan = NULL;
-    u32 u32Pos = 0;
+    u32 u32Pos;
 
-    pijan = pija->ija_pijanElements;
-    while ((u32Pos < u32Index) && (pijan != NULL))
+    /*Destroy the element by invoking the callback function.*/
+    if (fnDestroyElement != NULL)
     {
-        pijanPrevious = pijan;
-        pijan = pijan->ijan_pijanNext;
-        u32Pos ++;
+        for (u32Pos = u32Index; u32Pos < u32Index + u32Num; u32Pos ++)
+            fnDestroyElement(&pija->ija_ppjaeElements[u32Pos]);
     }
 
-    if ((u32Pos != u32Index) || (pijan == NULL))
-    {
-        /*Cannot find the node at the specified index.*/
-        u32Ret = JF_ERR_OUT_OF_RANGE;
-    }
-    else
-    {
-        /*Destroy the element by invoking the callback function.*/
-        if (fnDestoryElement != NULL)
-            fnDestoryElement(&(pijan->ijan_pjaeElement));
-
-        /*Adjust the list.*/
-        if (pijanPrevious != NULL)
-            pijanPrevious->ijan_pijanNext = pijan->ijan_pijanNext;
-        else
-            pija->ija_pijanElements = pijan->ijan_pijanNext;
-
-        pija->ija_u32ArraySize --;
-
-        jf_jiukun_freeMemory((void **)&pijan);
-    }
+    ol_memmove(
+        &pija->ija_ppjaeElements[u32Index], &pija->ija_ppjaeElements[u32Index + u32Num],
+        (pija->ija_u32ArraySize - u32Index - u32Num) * sizeof(jf_array_element_t *));
 
-    return u32Ret;
+    pija->ija_u32ArraySize -= u32Num;
 }
 
 /** Insert element at specified position.
@@ -112,31 +115,18 @@ static u32 _removeElementAt(
 static u32 _insertElementAt(internal_jf_array_t * pija, u32 u32Index, jf_array_element_t * pjae)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
-    internal_jf_array_node_t * pijanPrevious = NULL, * pijan = NULL, * pijanNew = NULL;
-    u32 u32Pos = 0;
 
-    pijanPrevious = NULL;
-    pijan = pija->ija_pijanElements;
-    while ((u32Pos < u32Index) && (pijan != NULL))
-    {
-        pijanPrevious = pijan;
-        pijan = pijan->ijan_pijanNext;
-        u32Pos ++;
-    }
+    if (u32Index > pija->ija_u32ArraySize)
+        u32Index = pija->ija_u32ArraySize;
 
-    u32Ret = jf_jiukun_allocMemory((void **)&pijanNew, sizeof(*pijanNew));
+    u32Ret = _reserveArray(pija, pija->ija_u32ArraySize + 1);
     if (u32Ret == JF_ERR_NO_ERROR)
     {
-        pijanNew->ijan_pjaeElement = pjae;
-
-        /*Adjust the list.*/
-        if (pijanPrevious == NULL)
-            pija->ija_pijanElements = pijanNew;
-        else
-            pijanPrevious->ijan_pijanNext = pijanNew;
-
-        pijanNew->ijan_pijanNext = pijan;
+        ol_memmove(
+            &pija->ija_ppjaeElements[u32Index + 1], &pija->ija_ppjaeElements[u32Index],
+            (pija->ija_u32ArraySize - u32Index) * sizeof(jf_array_element_t *));
 
+        pija->ija_ppjaeElements[u32Index] = pjae;
         pija->ija_u32ArraySize ++;
     }
 
@@ -150,12 +140,11 @@ u32 jf_array_create(jf_array_t ** ppja)
     u32 u32Ret = JF_ERR_NO_ERROR;
     internal_jf_array_t * pija = NULL;
 
-    /*Allocate memory for the array.*/
+    /*Allocate memory for the array, the buffer is allocated when the first element is added.*/
     u32Ret = jf_jiukun_allocMemory((void **)&pija, sizeof(*pija));
     if (u32Ret == JF_ERR_NO_ERROR)
     {
-        pija->ija_u32ArraySize = 0;
-        pija->ija_pijanElements = NULL;
+        ol_bzero(pija, sizeof(*pija));
 
         *ppja = (jf_array_t *) pija;
     }
@@ -172,8 +161,9 @@ u32 jf_array_destroy(jf_array_t ** ppja)
 
     pija = (internal_jf_array_t *) *ppja;
 
-    /*Destroy all elements in the array.*/
-    u32Ret = jf_array_removeAllElements(pija);
+    /*Free the buffer.*/
+    if (pija->ija_ppjaeElements != NULL)
+        jf_jiukun_freeMemory((void **)&pija->ija_ppjaeElements);
 
     /*Free the array.*/
     jf_jiukun_freeMemory(ppja);
@@ -190,6 +180,24 @@ u32 jf_array_getSize(jf_array_t * pja)
     return pija->ija_u32ArraySize;
 }
 
+u32 jf_array_getCapacity(jf_array_t * pja)
+{
+    internal_jf_array_t * pija = (internal_jf_array_t *) pja;
+
+    assert(pja != NULL);
+
+    return pija->ija_u32Capacity;
+}
+
+u32 jf_array_reserve(jf_array_t * pja, u32 u32Capacity)
+{
+    internal_jf_array_t * pija = (internal_jf_array_t *) pja;
+
+    assert(pja != NULL);
+
+    return _reserveArray(pija, u32Capacity);
+}
+
 u32 jf_array_getElementAt(jf_array_t * pja, u32 u32Index, jf_array_element_t ** ppjae)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
@@ -201,12 +209,49 @@ u32 jf_array_getElementAt(jf_array_t * pja, u32 u32Index, jf_array_element_t **
     if (u32Index >= pija->ija_u32ArraySize)
         u32Ret = JF_ERR_OUT_OF_RANGE;
     else
-        u32Ret = _getElementAt(pija, u32Index, ppjae);
+        *ppjae = pija->ija_ppjaeElements[u32Index];
+
+    return u32Ret;
+}
+
+u32 jf_array_setElementAt(jf_array_t * pja, u32 u32Index, jf_array_element_t * pjae)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_jf_array_t * pija = NULL;
+
+    assert(pja != NULL);
+
+    pija = (internal_jf_array_t *) pja;
+    if (u32Index >= pija->ija_u32ArraySize)
+        u32Ret = JF_ERR_OUT_OF_RANGE;
+    else
+        pija->ija_ppjaeElements[u32Index] = pjae;
 
     return u32Ret;
 }
 
 u32 jf_array_removeElementAt(jf_array_t * pja, u32 u32Index)
+{
+    return jf_array_removeElementsAt(pja, u32Index, 1);
+}
+
+u32 jf_array_removeElementsAt(jf_array_t * pja, u32 u32Index, u32 u32Num)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_jf_array_t * pija = NULL;
+
+    assert(pja != NULL);
+
+    pija = (internal_jf_array_t *) pja;
+    if ((u32Index >= pija->ija_u32ArraySize) || (u32Num > pija->ija_u32ArraySize - u32Index))
+        u32Ret = JF_ERR_OUT_OF_RANGE;
+    else
+        _removeElementsAt(pija, u32Index, u32Num, NULL);
+
+    return u32Ret;
+}
+
+u32 jf_array_swapRemoveElementAt(jf_array_t * pja, u32 u32Index)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
     internal_jf_array_t * pija = NULL;
@@ -220,7 +265,9 @@ u32 jf_array_removeElementAt(jf_array_t * pja, u32 u32Index)
     }
     else
     {
-        u32Ret = _removeElementAt(pija, u32Index, NULL);
+        /*Move the last element to the position.*/
+        pija->ija_u32ArraySize --;
+        pija->ija_ppjaeElements[u32Index] = pija->ija_ppjaeElements[pija->ija_u32ArraySize];
     }
 
     return u32Ret;
@@ -228,68 +275,35 @@ u32 jf_array_removeElementAt(jf_array_t * pja, u32 u32Index)
 
 u32 jf_array_removeElement(jf_array_t * pja, jf_array_element_t * pjae)
 {
-    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Ret = JF_ERR_NOT_FOUND;
     internal_jf_array_t * pija = NULL;
-    internal_jf_array_node_t * pijan = NULL, * pijanPrevious = NULL;
-    u32 u32Index = 0, u32Size = 0;
-    boolean_t bFound = FALSE;
+    u32 u32Index;
 
     assert(pja != NULL);
 
     pija = (internal_jf_array_t *) pja;
-    u32Size = pija->ija_u32ArraySize;
-    pijan = pija->ija_pijanElements;
-    while ((u32Index < u32Size) && (bFound == FALSE))
+    for (u32Index = 0; u32Index < pija->ija_u32ArraySize; u32Index ++)
     {
-        if (pijan->ijan_pjaeElement == pjae)
+        if (pija->ija_ppjaeElements[u32Index] == pjae)
         {
-            bFound = TRUE;
-        }
-        else
-        {
-            u32Index ++;
-            pijanPrevious = pijan;
-            pijan = pijan->ijan_pijanNext;
+            _removeElementsAt(pija, u32Index, 1, NULL);
+            u32Ret = JF_ERR_NO_ERROR;
+            break;
         }
     }
 
-    if (bFound == FALSE)
-    {
-        /*Not found.*/
-        u32Ret = JF_ERR_NOT_FOUND;
-    }
-    else
-    {
-        /*Remove the node.*/
-        if (pijanPrevious != NULL)
-            pijanPrevious->ijan_pijanNext = pijan->ijan_pijanNext;
-        else
-            pija->ija_pijanElements = pijan->ijan_pijanNext;
-        pija->ija_u32ArraySize --;
-        /*Free the node.*/
-        jf_jiukun_freeMemory((void **)&pijan);
-    }
-
     return u32Ret;
 }
 
 u32 jf_array_removeAllElements(jf_array_t * pja)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
-    u32 u32Index = 0, u32Size = 0, u32Ret2 = 0;
     internal_jf_array_t * pija = NULL;
 
     assert(pja != NULL);
 
     pija = (internal_jf_array_t *) pja;
-    u32Size = pija->ija_u32ArraySize;
-    while (u32Index < u32Size)
-    {
-        u32Ret2 = _removeElementAt(pija, 0, NULL);
-        if (u32Ret2 != JF_ERR_NO_ERROR)
-            u32Ret = u32Ret2;
-        u32Index = u32Index + 1;
-    }
+    pija->ija_u32ArraySize = 0;
 
     return u32Ret;
 }
@@ -315,44 +329,69 @@ u32 jf_array_appendElementTo(jf_array_t * pja, jf_array_element_t * pjae)
     assert(pja != NULL);
 
     pija = (internal_jf_array_t *) pja;
-    u32Ret = _insertElementAt(pija, pija->ija_u32ArraySize, pjae);
+    if (pija->ija_u32ArraySize == pija->ija_u32Capacity)
+        u32Ret = _reserveArray(pija, pija->ija_u32ArraySize + 1);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        pija->ija_ppjaeElements[pija->ija_u32ArraySize] = pjae;
+        pija->ija_u32ArraySize ++;
+    }
 
     return u32Ret;
 }
 
-u32 jf_array_destroyAllElements(jf_array_t * pja, jf_array_fnDestroyElement_t fnDestroyElement)
+u32 jf_array_appendElements(jf_array_t * pja, jf_array_element_t ** ppjae, u32 u32Num)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
-    u32 u32Index = 0, u32Size = 0;
     internal_jf_array_t * pija = NULL;
 
-    assert(pja != NULL);
+    assert((pja != NULL) && ((ppjae != NULL) || (u32Num == 0)));
 
     pija = (internal_jf_array_t *) pja;
-    u32Size = pija->ija_u32ArraySize;
-    while (u32Index < u32Size)
-    {
-        _removeElementAt(pija, 0, fnDestroyElement);
+    if (u32Num > JF_ARRAY_MAX_CAPACITY - pija->ija_u32ArraySize)
+        u32Ret = JF_ERR_OUT_OF_MEMORY;
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = _reserveArray(pija, pija->ija_u32ArraySize + u32Num);
 
-        u32Index ++;
+    if ((u32Ret == JF_ERR_NO_ERROR) && (u32Num > 0))
+    {
+        ol_memcpy(
+            &pija->ija_ppjaeElements[pija->ija_u32ArraySize], ppjae,
+            u32Num * sizeof(jf_array_element_t *));
+        pija->ija_u32ArraySize += u32Num;
     }
 
     return u32Ret;
 }
 
+u32 jf_array_destroyAllElements(jf_array_t * pja, jf_array_fnDestroyElement_t fnDestroyElement)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_jf_array_t * pija = NULL;
+
+    assert(pja != NULL);
+
+    pija = (internal_jf_array_t *) pja;
+    if (pija->ija_u32ArraySize > 0)
+        _removeElementsAt(pija, 0, pija->ija_u32ArraySize, fnDestroyElement);
+
+    return u32Ret;
+}
+
 u32 jf_array_destroyArrayAndElements(
     jf_array_t ** ppja, jf_array_fnDestroyElement_t fnDestroyElement)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
-    internal_jf_array_t * pija = (internal_jf_array_t *)*ppja;
 
     assert((ppja != NULL) && (*ppja != NULL));
 
     /*Destroy all elements in the array.*/
-    u32Ret = jf_array_destroyAllElements(pija, fnDestroyElement);
+    u32Ret = jf_array_destroyAllElements(*ppja, fnDestroyElement);
 
     /*Free the array.*/
-    jf_jiukun_freeMemory(ppja);
+    jf_array_destroy(ppja);
 
     return u32Ret;
 }
@@ -360,30 +399,36 @@ u32 jf_array_destroyArrayAndElements(
 u32 jf_array_findElement(
     jf_array_t * pja, jf_array_element_t ** ppElement, jf_array_fnFindElement_t fnFindElement,
     void * pKey)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Index = 0;
+
+    u32Ret = jf_array_findElementIndex(pja, &u32Index, fnFindElement, pKey);
+    if (u32Ret == JF_ERR_NO_ERROR)
+        *ppElement = ((internal_jf_array_t *)pja)->ija_ppjaeElements[u32Index];
+
+    return u32Ret;
+}
+
+u32 jf_array_findElementIndex(
+    jf_array_t * pja, u32 * pu32Index, jf_array_fnFindElement_t fnFindElement, void * pKey)
 {
     u32 u32Ret = JF_ERR_NOT_FOUND;
-    u32 u32Index = 0, u32Size = 0;
+    u32 u32Index = 0;
     internal_jf_array_t * pija = NULL;
-    internal_jf_array_node_t * pijan = NULL;
 
     assert(pja != NULL);
 
     pija = (internal_jf_array_t *) pja;
-    pijan = pija->ija_pijanElements;
-    u32Size = pija->ija_u32ArraySize;
 
-    while (u32Index < u32Size)
+    for (u32Index = 0; u32Index < pija->ija_u32ArraySize; u32Index ++)
     {
-        if (fnFindElement(pijan->ijan_pjaeElement, pKey))
+        if (fnFindElement(pija->ija_ppjaeElements[u32Index], pKey))
         {
-            *ppElement = pijan->ijan_pjaeElement;
+            *pu32Index = u32Index;
             u32Ret = JF_ERR_NO_ERROR;
             break;
         }
-
-        pijan = pijan->ijan_pijanNext;
-
-        u32Index ++;
     }
 
     return u32Ret;
@@ -393,27 +438,17 @@ u32 jf_array_traverse(
     jf_array_t * pja, jf_array_fnOpOnElement_t fnOpOnElement, void * pData)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
-    u32 u32Index = 0, u32Size = 0;
+    u32 u32Index = 0;
     internal_jf_array_t * pija = NULL;
-    internal_jf_array_node_t * pijan = NULL;
 
     assert(pja != NULL);
 
     pija = (internal_jf_array_t *) pja;
-    pijan = pija->ija_pijanElements;
-    u32Size = pija->ija_u32ArraySize;
-
-    while (u32Index < u32Size)
-    {
-        fnOpOnElement(pijan->ijan_pjaeElement, pData);
-
-        pijan = pijan->ijan_pijanNext;
 
-        u32Index ++;
-    }
+    for (u32Index = 0; u32Index < pija->ija_u32ArraySize; u32Index ++)
+        fnOpOnElement(pija->ija_ppjaeElements[u32Index], pData);
 
     return u32Ret;
 }
 
 /*------------------------------------------------------------------------------------------------*/
-
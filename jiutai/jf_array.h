@@ -10,6 +10,11 @@
  *  -# It is NOT thread safe. The caller should provide synchronization for the array if necessary.
  *  -# Link with jf_jiukun library for memory allocation.
  *  -# The array element can be the pointer to any type of data.
+ *  -# The elements are stored in a contiguous buffer, access by index is O(1), append is amortized
+ *   O(1). Insertion and removal in the middle move the elements after the position, use
+ *   jf_array_swapRemoveElementAt() if the order of elements doesn't matter.
+ *  -# The buffer is allocated from jiukun, the maximum number of elements is limited by the
+ *   maximum memory size of jiukun.
  */
 
 #ifndef JIUTAI_ARRAY_H
@@ -74,6 +79,25 @@ u32 jf_array_destroy(jf_array_t ** ppja);
  */
 u32 jf_array_getSize(jf_array_t * pja);
 
+/** Get the number of elements the array can hold without allocating memory.
+ *
+ *  @param pja [in] The pointer to the array.
+ *
+ *  @return The capacity.
+ */
+u32 jf_array_getCapacity(jf_array_t * pja);
+
+/** Make sure the array can hold the number of elements without allocating memory.
+ *
+ *  @param pja [in] The pointer to the array.
+ *  @param u32Capacity [in] The number of elements.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ *  @retval JF_ERR_OUT_OF_MEMORY Out of memory.
+ */
+u32 jf_array_reserve(jf_array_t * pja, u32 u32Capacity);
+
 /** Get element of array at specified position.
  *
  *  @param pja [in] The pointer to the array.
@@ -86,6 +110,18 @@ u32 jf_array_getSize(jf_array_t * pja);
  */
 u32 jf_array_getElementAt(jf_array_t * pja, u32 u32Index, jf_array_element_t ** ppjae);
 
+/** Replace element of array at specified position.
+ *
+ *  @param pja [in] The pointer to the array.
+ *  @param u32Index [in] The position of the element.
+ *  @param pjae [in] The new element.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ *  @retval JF_ERR_OUT_OF_RANGE The index is out of range.
+ */
+u32 jf_array_setElementAt(jf_array_t * pja, u32 u32Index, jf_array_element_t * pjae);
+
 /** Remove element from array at specified position.
  *
  *  @param pja [in] The pointer to the array.
@@ -97,6 +133,30 @@ u32 jf_array_getElementAt(jf_array_t * pja, u32 u32Index, jf_array_element_t **
  */
 u32 jf_array_removeElementAt(jf_array_t * pja, u32 u32Index);
 
+/** Remove a range of elements from array, the order of the rest elements is kept.
+ *
+ *  @param pja [in] The pointer to the array.
+ *  @param u32Index [in] The position of the first element.
+ *  @param u32Num [in] The number of elements to be removed.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ *  @retval JF_ERR_OUT_OF_RANGE The range is out of range.
+ */
+u32 jf_array_removeElementsAt(jf_array_t * pja, u32 u32Index, u32 u32Num);
+
+/** Remove element from array at specified position in O(1), the last element is moved to the
+ *  position.
+ *
+ *  @param pja [in] The pointer to the array.
+ *  @param u32Index [in] The position of the element.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ *  @retval JF_ERR_OUT_OF_RANGE The index is out of range.
+ */
+u32 jf_array_swapRemoveElementAt(jf_array_t * pja, u32 u32Index);
+
 /** Remove element from array with specified element.
  *
  *  @param pja [in] The pointer to the array.
@@ -108,7 +168,7 @@ u32 jf_array_removeElementAt(jf_array_t * pja, u32 u32Index);
  */
 u32 jf_array_removeElement(jf_array_t * pja, jf_array_element_t * pjae);
 
-/** Remove all elements from array.
+/** Remove all elements from array, the memory of the array is kept.
  *
  *  @param pja [in] The pointer to the array.
  *
@@ -129,7 +189,7 @@ u32 jf_array_removeAllElements(jf_array_t * pja);
  *
  *  @return The error code.
  *  @retval JF_ERR_NO_ERROR Success.
- *  @retval JF_ERR_JIUKUN_OUT_OF_MEMORY Out of memory.
+ *  @retval JF_ERR_OUT_OF_MEMORY Out of memory.
  */
 u32 jf_array_insertElementAt(jf_array_t * pja, u32 u32Index, jf_array_element_t * pjae);
 
@@ -140,10 +200,22 @@ u32 jf_array_insertElementAt(jf_array_t * pja, u32 u32Index, jf_array_element_t
  *
  *  @return The error code.
  *  @retval JF_ERR_NO_ERROR Success.
- *  @retval JF_ERR_JIUKUN_OUT_OF_MEMORY Out of memory.
+ *  @retval JF_ERR_OUT_OF_MEMORY Out of memory.
  */
 u32 jf_array_appendElementTo(jf_array_t * pja, jf_array_element_t * pjae);
 
+/** Append elements to array.
+ *
+ *  @param pja [in] The pointer to the array.
+ *  @param ppjae [in] The elements to be appended.
+ *  @param u32Num [in] The number of elements.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ *  @retval JF_ERR_OUT_OF_MEMORY Out of memory.
+ */
+u32 jf_array_appendElements(jf_array_t * pja, jf_array_element_t ** ppjae, u32 u32Num);
+
 /** Destroy all elements in array.
  *
  *  @param pja [in] The pointer to the array.
@@ -179,6 +251,20 @@ u32 jf_array_findElement(
     jf_array_t * pja, jf_array_element_t ** ppElement, jf_array_fnFindElement_t fnFindElement,
     void * pKey);
 
+/** Find element in array and return the position.
+ *
+ *  @param pja [in] The pointer to the array.
+ *  @param pu32Index [out] The position of the element found.
+ *  @param fnFindElement [in] The callback function to find elements, if TRUE, the element is found.
+ *  @param pKey [in] The argument for the callback function.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ *  @retval JF_ERR_NOT_FOUND The element is not found.
+ */
+u32 jf_array_findElementIndex(
+    jf_array_t * pja, u32 * pu32Index, jf_array_fnFindElement_t fnFindElement, void * pKey);
+
 /** Traverse array and do operation to each elements.
  *
  *  @param pja [in] The pointer to the array.
@@ -0,0 +1,1096 @@
+/**
+ *  @file jf_art.c
+ *
+ *  @brief Adaptive radix tree implementation file.
+ *
+ *  @author Min Zhang
+ *
+ *  @note
+ *  -# The key of leaf includes the null terminator, so a key is never the prefix of another key
+ *   and every key ends in a leaf.
+ *  -# The child pointer to leaf is tagged with the lowest bit.
+ *  -# The inner node keeps at most ART_MAX_PREFIX bytes of the compressed prefix, the search
+ *   skips the rest of the prefix and the key is verified at the leaf. The insertion and the prefix
+ *   iteration get the rest of the prefix from the minimum leaf under the node.
+ *  -# The keys of the nodes with 4 and 16 children are sorted.
+ */
+
+/* --- standard C lib header files -------------------------------------------------------------- */
+#include <string.h>
+
+/* --- internal header files -------------------------------------------------------------------- */
+#include "jf_basic.h"
+#include "jf_limit.h"
+#include "jf_err.h"
+#include "jf_art.h"
+#include "jf_jiukun.h"
+
+/* --- private data/data structure section ------------------------------------------------------ */
+
+/** Maximum number of prefix bytes kept in inner node.
+ */
+#define ART_MAX_PREFIX                         (8)
+
+/** The node type.
+ */
+enum art_node_type
+{
+    ART_NODE4 = 0,
+    ART_NODE16,
+    ART_NODE48,
+    ART_NODE256,
+    ART_NUM_OF_NODE_TYPE,
+};
+
+/** The node shrinks to the smaller type when the number of children drops to the threshold.
+ */
+#define ART_NODE256_SHRINK                     (37)
+#define ART_NODE48_SHRINK                      (12)
+#define ART_NODE16_SHRINK                      (3)
+
+#define ART_IS_LEAF(p)                         (((ulong)(p)) & 1)
+#define ART_GET_LEAF(p)                        ((art_leaf_t *)((ulong)(p) & ~((ulong)1)))
+#define ART_TAG_LEAF(p)                        ((void *)((ulong)(p) | 1))
+
+/** The header of inner node.
+ */
+typedef struct
+{
+    u8 an_u8Type;
+    u8 an_u8Reserved;
+    u16 an_u16NumOfChild;
+    /**Length of the compressed prefix.*/
+    u32 an_u32PrefixLen;
+    u8 an_u8Prefix[ART_MAX_PREFIX];
+} art_node_t;
+
+typedef struct
+{
+    art_node_t an4_anNode;
+    u8 an4_u8Key[4];
+    u8 an4_u8Reserved[4];
+    void * an4_pChild[4];
+} art_node4_t;
+
+typedef struct
+{
+    art_node_t an16_anNode;
+    u8 an16_u8Key[16];
+    void * an16_pChild[16];
+} art_node16_t;
+
+typedef struct
+{
+    art_node_t an48_anNode;
+    /**The position plus 1 of the child for each key byte, 0 means no child.*/
+    u8 an48_u8Index[256];
+    void * an48_pChild[48];
+} art_node48_t;
+
+typedef struct
+{
+    art_node_t an256_anNode;
+    void * an256_pChild[256];
+} art_node256_t;
+
+typedef struct
+{
+    void * al_pValue;
+    /**Length of key including the null terminator.*/
+    u32 al_u32KeyLen;
+    u8 al_u8Key[];
+} art_leaf_t;
+
+typedef struct
+{
+    void * ia_pRoot;
+    u32 ia_u32NumOfKey;
+    u32 ia_u32NumOfNode[ART_NUM_OF_NODE_TYPE];
+    jf_jiukun_cache_t * ia_pjjcNode[ART_NUM_OF_NODE_TYPE];
+    jf_art_fnFreeValue_t ia_fnFreeValue;
+} internal_art_t;
+
+static olchar_t * ls_pstrArtNodeCache[ART_NUM_OF_NODE_TYPE] =
+{
+    "art_node4",
+    "art_node16",
+    "art_node48",
+    "art_node256",
+};
+
+static olsize_t ls_sArtNode[ART_NUM_OF_NODE_TYPE] =
+{
+    sizeof(art_node4_t),
+    sizeof(art_node16_t),
+    sizeof(art_node48_t),
+    sizeof(art_node256_t),
+};
+
+/* --- private routine section ------------------------------------------------------------------ */
+
+static u32 _allocArtNode(internal_art_t * pia, u8 u8Type, art_node_t ** ppan)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    art_node_t * pan = NULL;
+
+    u32Ret = jf_jiukun_allocObject(pia->ia_pjjcNode[u8Type], (void **)&pan);
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ol_bzero(pan, ls_sArtNode[u8Type]);
+        pan->an_u8Type = u8Type;
+        pia->ia_u32NumOfNode[u8Type] ++;
+        *ppan = pan;
+    }
+
+    return u32Ret;
+}
+
+static void _freeArtNode(internal_art_t * pia, art_node_t ** ppan)
+{
+    u8 u8Type = (*ppan)->an_u8Type;
+
+    pia->ia_u32NumOfNode[u8Type] --;
+    jf_jiukun_freeObject(pia->ia_pjjcNode[u8Type], (void **)ppan);
+}
+
+static u32 _allocArtLeaf(const u8 * pu8Key, u32 u32KeyLen, void * pValue, art_leaf_t ** ppal)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    art_leaf_t * pal = NULL;
+
+    u32Ret = jf_jiukun_allocMemory((void **)&pal, sizeof(art_leaf_t) + u32KeyLen);
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        pal->al_pValue = pValue;
+        pal->al_u32KeyLen = u32KeyLen;
+        ol_memcpy(pal->al_u8Key, pu8Key, u32KeyLen);
+        *ppal = pal;
+    }
+
+    return u32Ret;
+}
+
+static void _freeArtLeaf(art_leaf_t ** ppal)
+{
+    jf_jiukun_freeMemory((void **)ppal);
+}
+
+static boolean_t _isArtLeafMatched(art_leaf_t * pal, const u8 * pu8Key, u32 u32KeyLen)
+{
+    return (pal->al_u32KeyLen == u32KeyLen) && (ol_memcmp(pal->al_u8Key, pu8Key, u32KeyLen) == 0);
+}
+
+/** Copy the header of node except the type.
+ */
+static void _copyArtNodeHeader(art_node_t * panDest, art_node_t * panSrc)
+{
+    panDest->an_u16NumOfChild = panSrc->an_u16NumOfChild;
+    panDest->an_u32PrefixLen = panSrc->an_u32PrefixLen;
+    ol_memcpy(panDest->an_u8Prefix, panSrc->an_u8Prefix, ART_MAX_PREFIX);
+}
+
+/** Find the child for the key byte.
+ *
+ *  @return The pointer to the child slot, NULL if not found.
+ */
+static void ** _findArtChild(art_node_t * pan, u8 u8Key)
+{
+    art_node4_t * pan4;
+    art_node16_t * pan16;
+    art_node48_t * pan48;
+    art_node256_t * pan256;
+    u32 u32Index;
+
+    switch (pan->an_u8Type)
+    {
+    case ART_NODE4:
+        pan4 = (art_node4_t *)pan;
+        for (u32Index = 0; u32Index < pan->an_u16NumOfChild; u32Index ++)
+            if (pan4->an4_u8Key[u32Index] == u8Key)
+                return &pan4->an4_pChild[u32Index];
+        break;
+    case ART_NODE16:
+        pan16 = (art_node16_t *)pan;
+        for (u32Index = 0; u32Index < pan->an_u16NumOfChild; u32Index ++)
+            if (pan16->an16_u8Key[u32Index] == u8Key)
+                return &pan16->an16_pChild[u32Index];
+        break;
+    case ART_NODE48:
+        pan48 = (art_node48_t *)pan;
+        u32Index = pan48->an48_u8Index[u8Key];
+        if (u32Index != 0)
+            return &pan48->an48_pChild[u32Index - 1];
+        break;
+    case ART_NODE256:
+        pan256 = (art_node256_t *)pan;
+        if (pan256->an256_pChild[u8Key] != NULL)
+            return &pan256->an256_pChild[u8Key];
+        break;
+    }
+
+    return NULL;
+}
+
+/** Get the leaf with the smallest key under the node.
+ */
+static art_leaf_t * _getMinimumArtLeaf(void * pNode)
+{
+    art_node_t * pan = NULL;
+    u32 u32Index = 0;
+
+    while (! ART_IS_LEAF(pNode))
+    {
+        pan = pNode;
+        switch (pan->an_u8Type)
+        {
+        case ART_NODE4:
+            pNode = ((art_node4_t *)pan)->an4_pChild[0];
+            break;
+        case ART_NODE16:
+            pNode = ((art_node16_t *)pan)->an16_pChild[0];
+            break;
+        case ART_NODE48:
+            for (u32Index = 0; ((art_node48_t *)pan)->an48_u8Index[u32Index] == 0; u32Index ++)
+                ;
+            pNode = ((art_node48_t *)pan)->an48_pChild[
+                ((art_node48_t *)pan)->an48_u8Index[u32Index] - 1];
+            break;
+        case ART_NODE256:
+            for (u32Index = 0; ((art_node256_t *)pan)->an256_pChild[u32Index] == NULL; u32Index ++)
+                ;
+            pNode = ((art_node256_t *)pan)->an256_pChild[u32Index];
+            break;
+        }
+    }
+
+    return ART_GET_LEAF(pNode);
+}
+
+/** Get number of matched bytes in the prefix kept in node.
+ */
+static u32 _checkArtPrefix(art_node_t * pan, const u8 * pu8Key, u32 u32KeyLen, u32 u32Depth)
+{
+    u32 u32Max = MIN(MIN(pan->an_u32PrefixLen, ART_MAX_PREFIX), u32KeyLen - u32Depth);
+    u32 u32Index;
+
+    for (u32Index = 0; u32Index < u32Max; u32Index ++)
+        if (pan->an_u8Prefix[u32Index] != pu8Key[u32Depth + u32Index])
+            break;
+
+    return u32Index;
+}
+
+/** Get number of matched bytes in the prefix, the prefix not kept in node is read from the
+ *  minimum leaf. The result may be larger than the prefix length.
+ */
+static u32 _getArtPrefixMismatch(art_node_t * pan, const u8 * pu8Key, u32 u32KeyLen, u32 u32Depth)
+{
+    u32 u32Index = _checkArtPrefix(pan, pu8Key, u32KeyLen, u32Depth);
+    u32 u32Max;
+    art_leaf_t * pal = NULL;
+
+    if ((u32Index < ART_MAX_PREFIX) || (pan->an_u32PrefixLen <= ART_MAX_PREFIX))
+        return u32Index;
+
+    pal = _getMinimumArtLeaf(pan);
+    u32Max = MIN(pal->al_u32KeyLen, u32KeyLen) - u32Depth;
+    for (; u32Index < u32Max; u32Index ++)
+        if (pal->al_u8Key[u32Depth + u32Index] != pu8Key[u32Depth + u32Index])
+            break;
+
+    return u32Index;
+}
+
+/** Add child to the node which is not full, the keys are kept sorted.
+ */
+static void _addArtChildToSortedNode(
+    art_node_t * pan, u8 * pu8Keys, void ** ppChild, u8 u8Key, void * pChild)
+{
+    u32 u32Num = pan->an_u16NumOfChild, u32Pos;
+
+    for (u32Pos = 0; (u32Pos < u32Num) && (pu8Keys[u32Pos] < u8Key); u32Pos ++)
+        ;
+
+    ol_memmove(&pu8Keys[u32Pos + 1], &pu8Keys[u32Pos], u32Num - u32Pos);
+    ol_memmove(&ppChild[u32Pos + 1], &ppChild[u32Pos], (u32Num - u32Pos) * sizeof(void *));
+    pu8Keys[u32Pos] = u8Key;
+    ppChild[u32Pos] = pChild;
+    pan->an_u16NumOfChild ++;
+}
+
+static void _addArtChildToNode48(art_node48_t * pan48, u8 u8Key, void * pChild)
+{
+    u32 u32Pos = 0;
+
+    while (pan48->an48_pChild[u32Pos] != NULL)
+        u32Pos ++;
+
+    pan48->an48_pChild[u32Pos] = pChild;
+    pan48->an48_u8Index[u8Key] = (u8)(u32Pos + 1);
+    pan48->an48_anNode.an_u16NumOfChild ++;
+}
+
+/** Grow the full node to the larger type.
+ */
+static u32 _growArtNode(internal_art_t * pia, art_node_t * pan, art_node_t ** ppanNew)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    art_node_t * panNew = NULL;
+    art_node16_t * pan16;
+    art_node48_t * pan48;
+    art_node256_t * pan256;
+    u32 u32Index;
+
+    u32Ret = _allocArtNode(pia, pan->an_u8Type + 1, &panNew);
+    if (u32Ret != JF_ERR_NO_ERROR)
+        return u32Ret;
+
+    _copyArtNodeHeader(panNew, pan);
+
+    switch (pan->an_u8Type)
+    {
+    case ART_NODE4:
+        pan16 = (art_node16_t *)panNew;
+        ol_memcpy(pan16->an16_u8Key, ((art_node4_t *)pan)->an4_u8Key, 4);
+        ol_memcpy(pan16->an16_pChild, ((art_node4_t *)pan)->an4_pChild, 4 * sizeof(void *));
+        break;
+    case ART_NODE16:
+        pan48 = (art_node48_t *)panNew;
+        ol_memcpy(pan48->an48_pChild, ((art_node16_t *)pan)->an16_pChild, 16 * sizeof(void *));
+        for (u32Index = 0; u32Index < 16; u32Index ++)
+            pan48->an48_u8Index[((art_node16_t *)pan)->an16_u8Key[u32Index]] = (u8)(u32Index + 1);
+        break;
+    case ART_NODE48:
+        pan256 = (art_node256_t *)panNew;
+        pan48 = (art_node48_t *)pan;
+        for (u32Index = 0; u32Index < 256; u32Index ++)
+            if (pan48->an48_u8Index[u32Index] != 0)
+                pan256->an256_pChild[u32Index] =
+                    pan48->an48_pChild[pan48->an48_u8Index[u32Index] - 1];
+        break;
+    }
+
+    _freeArtNode(pia, &pan);
+    *ppanNew = panNew;
+
+    return u32Ret;
+}
+
+/** Add child to the node, the node grows if it's full.
+ *
+ *  @param pia [in] The tree.
+ *  @param ppRef [in/out] The pointer to the node, it's updated if the node grows.
+ *  @param u8Key [in] The key byte.
+ *  @param pChild [in] The child.
+ *
+ *  @return The error code.
+ */
+static u32 _addArtChild(internal_art_t * pia, void ** ppRef, u8 u8Key, void * pChild)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    art_node_t * pan = *ppRef;
+
+    if (((pan->an_u8Type == ART_NODE4) && (pan->an_u16NumOfChild == 4)) ||
+        ((pan->an_u8Type == ART_NODE16) && (pan->an_u16NumOfChild == 16)) ||
+        ((pan->an_u8Type == ART_NODE48) && (pan->an_u16NumOfChild == 48)))
+    {
+        u32Ret = _growArtNode(pia, pan, &pan);
+        if (u32Ret == JF_ERR_NO_ERROR)
+            *ppRef = pan;
+    }
+
+    if (u32Ret != JF_ERR_NO_ERROR)
+        return u32Ret;
+
+    switch (pan->an_u8Type)
+    {
+    case ART_NODE4:
+        _addArtChildToSortedNode(
+            pan, ((art_node4_t *)pan)->an4_u8Key, ((art_node4_t *)pan)->an4_pChild, u8Key, pChild);
+        break;
+    case ART_NODE16:
+        _addArtChildToSortedNode(
+            pan, ((art_node16_t *)pan)->an16_u8Key, ((art_node16_t *)pan)->an16_pChild, u8Key,
+            pChild);
+        break;
+    case ART_NODE48:
+        _addArtChildToNode48((art_node48_t *)pan, u8Key, pChild);
+        break;
+    case ART_NODE256:
+        ((art_node256_t *)pan)->an256_pChild[u8Key] = pChild;
+        pan->an_u16NumOfChild ++;
+        break;
+    }
+
+    return u32Ret;
+}
+
+/** Split the leaf, a node with 4 children is created for the leaf and the new leaf.
+ */
+static u32 _splitArtLeaf(
+    internal_art_t * pia, void ** ppRef, const u8 * pu8Key, u32 u32KeyLen, u32 u32Depth,
+    void * pValue)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    art_leaf_t * pal = ART_GET_LEAF(*ppRef), * palNew = NULL;
+    art_node_t * pan = NULL;
+    u32 u32Len = 0, u32Max;
+
+    if (_isArtLeafMatched(pal, pu8Key, u32KeyLen))
+        return JF_ERR_ALREADY_EXIST;
+
+    u32Ret = _allocArtNode(pia, ART_NODE4, &pan);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        u32Ret = _allocArtLeaf(pu8Key, u32KeyLen, pValue, &palNew);
+        if (u32Ret != JF_ERR_NO_ERROR)
+            _freeArtNode(pia, &pan);
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        /*The keys are different and null-terminated, the mismatch is before the end of keys.*/
+        u32Max = MIN(pal->al_u32KeyLen, u32KeyLen) - u32Depth;
+        while ((u32Len < u32Max) && (pal->al_u8Key[u32Depth + u32Len] == pu8Key[u32Depth + u32Len]))
+            u32Len ++;
+
+        pan->an_u32PrefixLen = u32Len;
+        ol_memcpy(pan->an_u8Prefix, pu8Key + u32Depth, MIN(u32Len, ART_MAX_PREFIX));
+
+        _addArtChild(pia, (void **)&pan, pal->al_u8Key[u32Depth + u32Len], *ppRef);
+        _addArtChild(pia, (void **)&pan, pu8Key[u32Depth + u32Len], ART_TAG_LEAF(palNew));
+        *ppRef = pan;
+    }
+
+    return u32Ret;
+}
+
+/** Split the prefix of node at the mismatch position, a node with 4 children is created for the
+ *  node and the new leaf.
+ */
+static u32 _splitArtPrefix(
+    internal_art_t * pia, void ** ppRef, const u8 * pu8Key, u32 u32KeyLen, u32 u32Depth,
+    u32 u32Diff, void * pValue)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    art_node_t * pan = *ppRef, * panNew = NULL;
+    art_leaf_t * pal = NULL, * palNew = NULL;
+
+    u32Ret = _allocArtNode(pia, ART_NODE4, &panNew);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        u32Ret = _allocArtLeaf(pu8Key, u32KeyLen, pValue, &palNew);
+        if (u32Ret != JF_ERR_NO_ERROR)
+            _freeArtNode(pia, &panNew);
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        panNew->an_u32PrefixLen = u32Diff;
+        ol_memcpy(panNew->an_u8Prefix, pan->an_u8Prefix, MIN(u32Diff, ART_MAX_PREFIX));
+
+        /*Remove the common prefix and the key byte from the old node.*/
+        if (pan->an_u32PrefixLen <= ART_MAX_PREFIX)
+        {
+            _addArtChild(pia, (void **)&panNew, pan->an_u8Prefix[u32Diff], pan);
+            pan->an_u32PrefixLen -= u32Diff + 1;
+            ol_memmove(
+                pan->an_u8Prefix, pan->an_u8Prefix + u32Diff + 1,
+                MIN(pan->an_u32PrefixLen, ART_MAX_PREFIX));
+        }
+        else
+        {
+            pal = _getMinimumArtLeaf(pan);
+            _addArtChild(pia, (void **)&panNew, pal->al_u8Key[u32Depth + u32Diff], pan);
+            pan->an_u32PrefixLen -= u32Diff + 1;
+            ol_memcpy(
+                pan->an_u8Prefix, pal->al_u8Key + u32Depth + u32Diff + 1,
+                MIN(pan->an_u32PrefixLen, ART_MAX_PREFIX));
+        }
+
+        _addArtChild(pia, (void **)&panNew, pu8Key[u32Depth + u32Diff], ART_TAG_LEAF(palNew));
+        *ppRef = panNew;
+    }
+
+    return u32Ret;
+}
+
+static u32 _insertArt(
+    internal_art_t * pia, void ** ppRef, const u8 * pu8Key, u32 u32KeyLen, u32 u32Depth,
+    void * pValue)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    art_node_t * pan = NULL;
+    art_leaf_t * pal = NULL;
+    void ** ppChild = NULL;
+    u32 u32Diff;
+
+    while (u32Ret == JF_ERR_NO_ERROR)
+    {
+        if (*ppRef == NULL)
+        {
+            u32Ret = _allocArtLeaf(pu8Key, u32KeyLen, pValue, &pal);
+            if (u32Ret == JF_ERR_NO_ERROR)
+                *ppRef = ART_TAG_LEAF(pal);
+            break;
+        }
+
+        if (ART_IS_LEAF(*ppRef))
+        {
+            u32Ret = _splitArtLeaf(pia, ppRef, pu8Key, u32KeyLen, u32Depth, pValue);
+            break;
+        }
+
+        pan = *ppRef;
+        if (pan->an_u32PrefixLen > 0)
+        {
+            u32Diff = _getArtPrefixMismatch(pan, pu8Key, u32KeyLen, u32Depth);
+            if (u32Diff < pan->an_u32PrefixLen)
+            {
+                u32Ret = _splitArtPrefix(pia, ppRef, pu8Key, u32KeyLen, u32Depth, u32Diff, pValue);
+                break;
+            }
+            u32Depth += pan->an_u32PrefixLen;
+        }
+
+        ppChild = _findArtChild(pan, pu8Key[u32Depth]);
+        if (ppChild == NULL)
+        {
+            u32Ret = _allocArtLeaf(pu8Key, u32KeyLen, pValue, &pal);
+            if (u32Ret == JF_ERR_NO_ERROR)
+            {
+                u32Ret = _addArtChild(pia, ppRef, pu8Key[u32Depth], ART_TAG_LEAF(pal));
+                if (u32Ret != JF_ERR_NO_ERROR)
+                    _freeArtLeaf(&pal);
+            }
+            break;
+        }
+
+        ppRef = ppChild;
+        u32Depth ++;
+    }
+
+    return u32Ret;
+}
+
+/** Remove the child from the node with sorted keys.
+ */
+static void _removeArtChildFromSortedNode(
+    art_node_t * pan, u8 * pu8Keys, void ** ppChild, void ** ppSlot)
+{
+    u32 u32Num = pan->an_u16NumOfChild, u32Pos = (u32)(ppSlot - ppChild);
+
+    ol_memmove(&pu8Keys[u32Pos], &pu8Keys[u32Pos + 1], u32Num - u32Pos - 1);
+    ol_memmove(&ppChild[u32Pos], &ppChild[u32Pos + 1], (u32Num - u32Pos - 1) * sizeof(void *));
+    pan->an_u16NumOfChild --;
+}
+
+/** The node with 4 children has only one child, the node is replaced by the child and the prefix
+ *  is merged to the child.
+ */
+static void _collapseArtNode4(internal_art_t * pia, void ** ppRef, art_node4_t * pan4)
+{
+    void * pChild = pan4->an4_pChild[0];
+    art_node_t * panChild = NULL;
+    u8 u8Prefix[ART_MAX_PREFIX];
+    u32 u32Len = pan4->an4_anNode.an_u32PrefixLen, u32Sub;
+
+    if (! ART_IS_LEAF(pChild))
+    {
+        panChild = pChild;
+        ol_memcpy(u8Prefix, pan4->an4_anNode.an_u8Prefix, ART_MAX_PREFIX);
+        if (u32Len < ART_MAX_PREFIX)
+        {
+            u8Prefix[u32Len] = pan4->an4_u8Key[0];
+            u32Len ++;
+        }
+        if (u32Len < ART_MAX_PREFIX)
+        {
+            u32Sub = MIN(panChild->an_u32PrefixLen, ART_MAX_PREFIX - u32Len);
+            ol_memcpy(&u8Prefix[u32Len], panChild->an_u8Prefix, u32Sub);
+            u32Len += u32Sub;
+        }
+
+        ol_memcpy(panChild->an_u8Prefix, u8Prefix, MIN(u32Len, ART_MAX_PREFIX));
+        panChild->an_u32PrefixLen += pan4->an4_anNode.an_u32PrefixLen + 1;
+    }
+
+    *ppRef = pChild;
+    _freeArtNode(pia, (art_node_t **)&pan4);
+}
+
+/** Shrink the node to the smaller type. The memory is not allocated if the smaller node is not
+ *  available, the node is kept.
+ */
+static void _shrinkArtNode(internal_art_t * pia, void ** ppRef)
+{
+    art_node_t * pan = *ppRef, * panNew = NULL;
+    art_node16_t * pan16;
+    art_node48_t * pan48;
+    art_node256_t * pan256;
+    u32 u32Index, u32Pos = 0;
+
+    if (_allocArtNode(pia, pan->an_u8Type - 1, &panNew) != JF_ERR_NO_ERROR)
+        return;
+
+    _copyArtNodeHeader(panNew, pan);
+
+    switch (pan->an_u8Type)
+    {
+    case ART_NODE16:
+        ol_memcpy(((art_node4_t *)panNew)->an4_u8Key, ((art_node16_t *)pan)->an16_u8Key, 4);
+        ol_memcpy(
+            ((art_node4_t *)panNew)->an4_pChild, ((art_node16_t *)pan)->an16_pChild,
+            4 * sizeof(void *));
+        break;
+    case ART_NODE48:
+        pan16 = (art_node16_t *)panNew;
+        pan48 = (art_node48_t *)pan;
+        for (u32Index = 0; u32Index < 256; u32Index ++)
+        {
+            if (pan48->an48_u8Index[u32Index] != 0)
+            {
+                pan16->an16_u8Key[u32Pos] = (u8)u32Index;
+                pan16->an16_pChild[u32Pos] = pan48->an48_pChild[pan48->an48_u8Index[u32Index] - 1];
+                u32Pos ++;
+            }
+        }
+        break;
+    case ART_NODE256:
+        pan48 = (art_node48_t *)panNew;
+        pan256 = (art_node256_t *)pan;
+        for (u32Index = 0; u32Index < 256; u32Index ++)
+        {
+            if (pan256->an256_pChild[u32Index] != NULL)
+            {
+                pan48->an48_pChild[u32Pos] = pan256->an256_pChild[u32Index];
+                pan48->an48_u8Index[u32Index] = (u8)(u32Pos + 1);
+                u32Pos ++;
+            }
+        }
+        break;
+    }
+
+    _freeArtNode(pia, &pan);
+    *ppRef = panNew;
+}
+
+/** Remove the child from the node, the node shrinks if it has few children.
+ */
+static void _removeArtChild(internal_art_t * pia, void ** ppRef, u8 u8Key, void ** ppSlot)
+{
+    art_node_t * pan = *ppRef;
+    art_node48_t * pan48;
+
+    switch (pan->an_u8Type)
+    {
+    case ART_NODE4:
+        _removeArtChildFromSortedNode(
+            pan, ((art_node4_t *)pan)->an4_u8Key, ((art_node4_t *)pan)->an4_pChild, ppSlot);
+        if (pan->an_u16NumOfChild == 1)
+            _collapseArtNode4(pia, ppRef, (art_node4_t *)pan);
+        break;
+    case ART_NODE16:
+        _removeArtChildFromSortedNode(
+            pan, ((art_node16_t *)pan)->an16_u8Key, ((art_node16_t *)pan)->an16_pChild, ppSlot);
+        if (pan->an_u16NumOfChild == ART_NODE16_SHRINK)
+            _shrinkArtNode(pia, ppRef);
+        break;
+    case ART_NODE48:
+        pan48 = (art_node48_t *)pan;
+        pan48->an48_pChild[pan48->an48_u8Index[u8Key] - 1] = NULL;
+        pan48->an48_u8Index[u8Key] = 0;
+        pan->an_u16NumOfChild --;
+        if (pan->an_u16NumOfChild == ART_NODE48_SHRINK)
+            _shrinkArtNode(pia, ppRef);
+        break;
+    case ART_NODE256:
+        ((art_node256_t *)pan)->an256_pChild[u8Key] = NULL;
+        pan->an_u16NumOfChild --;
+        if (pan->an_u16NumOfChild == ART_NODE256_SHRINK)
+            _shrinkArtNode(pia, ppRef);
+        break;
+    }
+}
+
+static u32 _removeArt(
+    internal_art_t * pia, void ** ppRef, const u8 * pu8Key, u32 u32KeyLen, void ** ppValue)
+{
+    art_node_t * pan = NULL;
+    art_leaf_t * pal = NULL;
+    void ** ppChild = NULL;
+    u32 u32Depth = 0;
+
+    while (*ppRef != NULL)
+    {
+        if (ART_IS_LEAF(*ppRef))
+        {
+            /*Only the root can be leaf here.*/
+            pal = ART_GET_LEAF(*ppRef);
+            if (! _isArtLeafMatched(pal, pu8Key, u32KeyLen))
+                break;
+
+            *ppRef = NULL;
+            if (ppValue != NULL)
+                *ppValue = pal->al_pValue;
+            _freeArtLeaf(&pal);
+            return JF_ERR_NO_ERROR;
+        }
+
+        pan = *ppRef;
+        if (pan->an_u32PrefixLen > 0)
+        {
+            if (_checkArtPrefix(pan, pu8Key, u32KeyLen, u32Depth) !=
+                MIN(pan->an_u32PrefixLen, ART_MAX_PREFIX))
+                break;
+            u32Depth += pan->an_u32PrefixLen;
+        }
+
+        if (u32Depth >= u32KeyLen)
+            break;
+
+        ppChild = _findArtChild(pan, pu8Key[u32Depth]);
+        if (ppChild == NULL)
+            break;
+
+        if (ART_IS_LEAF(*ppChild))
+        {
+            pal = ART_GET_LEAF(*ppChild);
+            if (! _isArtLeafMatched(pal, pu8Key, u32KeyLen))
+                break;
+
+            _removeArtChild(pia, ppRef, pu8Key[u32Depth], ppChild);
+            if (ppValue != NULL)
+                *ppValue = pal->al_pValue;
+            _freeArtLeaf(&pal);
+            return JF_ERR_NO_ERROR;
+        }
+
+        ppRef = ppChild;
+        u32Depth ++;
+    }
+
+    return JF_ERR_NOT_FOUND;
+}
+
+static art_leaf_t * _searchArt(internal_art_t * pia, const u8 * pu8Key, u32 u32KeyLen)
+{
+    void * pNode = pia->ia_pRoot;
+    art_node_t * pan = NULL;
+    art_leaf_t * pal = NULL;
+    void ** ppChild = NULL;
+    u32 u32Depth = 0;
+
+    while (pNode != NULL)
+    {
+        if (ART_IS_LEAF(pNode))
+        {
+            pal = ART_GET_LEAF(pNode);
+            if (_isArtLeafMatched(pal, pu8Key, u32KeyLen))
+                return pal;
+            break;
+        }
+
+        pan = pNode;
+        if (pan->an_u32PrefixLen > 0)
+        {
+            /*The prefix not kept in node is skipped, the key is verified at the leaf.*/
+            if (_checkArtPrefix(pan, pu8Key, u32KeyLen, u32Depth) !=
+                MIN(pan->an_u32PrefixLen, ART_MAX_PREFIX))
+                break;
+            u32Depth += pan->an_u32PrefixLen;
+        }
+
+        if (u32Depth >= u32KeyLen)
+            break;
+
+        ppChild = _findArtChild(pan, pu8Key[u32Depth]);
+        pNode = (ppChild != NULL) ? *ppChild : NULL;
+        u32Depth ++;
+    }
+
+    return NULL;
+}
+
+/** Iterate all keys under the node in order.
+ */
+static u32 _iterateArtNode(void * pNode, jf_art_fnOpEntry_t fnOpEntry, void * pArg)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    art_node_t * pan = NULL;
+    art_leaf_t * pal = NULL;
+    art_node48_t * pan48;
+    u32 u32Index;
+
+    if (ART_IS_LEAF(pNode))
+    {
+        pal = ART_GET_LEAF(pNode);
+        return fnOpEntry((const olchar_t *)pal->al_u8Key, pal->al_pValue, pArg);
+    }
+
+    pan = pNode;
+    switch (pan->an_u8Type)
+    {
+    case ART_NODE4:
+        for (u32Index = 0; (u32Index < pan->an_u16NumOfChild) && (u32Ret == JF_ERR_NO_ERROR);
+             u32Index ++)
+            u32Ret = _iterateArtNode(((art_node4_t *)pan)->an4_pChild[u32Index], fnOpEntry, pArg);
+        break;
+    case ART_NODE16:
+        for (u32Index = 0; (u32Index < pan->an_u16NumOfChild) && (u32Ret == JF_ERR_NO_ERROR);
+             u32Index ++)
+            u32Ret = _iterateArtNode(
+                ((art_node16_t *)pan)->an16_pChild[u32Index], fnOpEntry, pArg);
+        break;
+    case ART_NODE48:
+        pan48 = (art_node48_t *)pan;
+        for (u32Index = 0; (u32Index < 256) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+            if (pan48->an48_u8Index[u32Index] != 0)
+                u32Ret = _iterateArtNode(
+                    pan48->an48_pChild[pan48->an48_u8Index[u32Index] - 1], fnOpEntry, pArg);
+        break;
+    case ART_NODE256:
+        for (u32Index = 0; (u32Index < 256) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+            if (((art_node256_t *)pan)->an256_pChild[u32Index] != NULL)
+                u32Ret = _iterateArtNode(
+                    ((art_node256_t *)pan)->an256_pChild[u32Index], fnOpEntry, pArg);
+        break;
+    }
+
+    return u32Ret;
+}
+
+static u32 _iterateArtPrefix(
+    internal_art_t * pia, const u8 * pu8Prefix, u32 u32PrefixLen, jf_art_fnOpEntry_t fnOpEntry,
+    void * pArg)
+{
+    void * pNode = pia->ia_pRoot;
+    art_node_t * pan = NULL;
+    art_leaf_t * pal = NULL;
+    void ** ppChild = NULL;
+    u32 u32Depth = 0, u32Match;
+
+    while (pNode != NULL)
+    {
+        if (ART_IS_LEAF(pNode))
+        {
+            pal = ART_GET_LEAF(pNode);
+            if ((pal->al_u32KeyLen > u32PrefixLen) &&
+                (ol_memcmp(pal->al_u8Key, pu8Prefix, u32PrefixLen) == 0))
+                return fnOpEntry((const olchar_t *)pal->al_u8Key, pal->al_pValue, pArg);
+            break;
+        }
+
+        /*The path is verified, all keys under the node have the prefix.*/
+        if (u32Depth == u32PrefixLen)
+            return _iterateArtNode(pNode, fnOpEntry, pArg);
+
+        pan = pNode;
+        if (pan->an_u32PrefixLen > 0)
+        {
+            u32Match = _getArtPrefixMismatch(pan, pu8Prefix, u32PrefixLen, u32Depth);
+            u32Match = MIN(u32Match, pan->an_u32PrefixLen);
+
+            if (u32Depth + u32Match == u32PrefixLen)
+                return _iterateArtNode(pNode, fnOpEntry, pArg);
+
+            if (u32Match < pan->an_u32PrefixLen)
+                break;
+
+            u32Depth += pan->an_u32PrefixLen;
+        }
+
+        ppChild = _findArtChild(pan, pu8Prefix[u32Depth]);
+        pNode = (ppChild != NULL) ? *ppChild : NULL;
+        u32Depth ++;
+    }
+
+    return JF_ERR_NO_ERROR;
+}
+
+static void _destroyArtNode(internal_art_t * pia, void * pNode)
+{
+    art_node_t * pan = NULL;
+    art_leaf_t * pal = NULL;
+    art_node48_t * pan48;
+    u32 u32Index;
+
+    if (ART_IS_LEAF(pNode))
+    {
+        pal = ART_GET_LEAF(pNode);
+        if (pia->ia_fnFreeValue != NULL)
+            pia->ia_fnFreeValue(&pal->al_pValue);
+        _freeArtLeaf(&pal);
+        return;
+    }
+
+    pan = pNode;
+    switch (pan->an_u8Type)
+    {
+    case ART_NODE4:
+        for (u32Index = 0; u32Index < pan->an_u16NumOfChild; u32Index ++)
+            _destroyArtNode(pia, ((art_node4_t *)pan)->an4_pChild[u32Index]);
+        break;
+    case ART_NODE16:
+        for (u32Index = 0; u32Index < pan->an_u16NumOfChild; u32Index ++)
+            _destroyArtNode(pia, ((art_node16_t *)pan)->an16_pChild[u32Index]);
+        break;
+    case ART_NODE48:
+        pan48 = (art_node48_t *)pan;
+        for (u32Index = 0; u32Index < 256; u32Index ++)
+            if (pan48->an48_u8Index[u32Index] != 0)
+                _destroyArtNode(pia, pan48->an48_pChild[pan48->an48_u8Index[u32Index] - 1]);
+        break;
+    case ART_NODE256:
+        for (u32Index = 0; u32Index < 256; u32Index ++)
+            if (((art_node256_t *)pan)->an256_pChild[u32Index] != NULL)
+                _destroyArtNode(pia, ((art_node256_t *)pan)->an256_pChild[u32Index]);
+        break;
+    }
+
+    _freeArtNode(pia, &pan);
+}
+
+/* --- public routine section ------------------------------------------------------------------- */
+
+u32 jf_art_create(jf_art_t ** ppja, jf_art_create_param_t * pjacp)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_art_t * pia = NULL;
+    jf_jiukun_cache_create_param_t jjccp;
+    u8 u8Type;
+
+    assert((ppja != NULL) && (pjacp != NULL));
+
+    u32Ret = jf_jiukun_allocMemory((void **)&pia, sizeof(internal_art_t));
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ol_bzero(pia, sizeof(internal_art_t));
+        pia->ia_fnFreeValue = pjacp->jacp_fnFreeValue;
+    }
+
+    for (u8Type = ART_NODE4; (u8Type < ART_NUM_OF_NODE_TYPE) && (u32Ret == JF_ERR_NO_ERROR);
+         u8Type ++)
+    {
+        ol_bzero(&jjccp, sizeof(jjccp));
+        jjccp.jjccp_pstrName = ls_pstrArtNodeCache[u8Type];
+        jjccp.jjccp_sObj = ls_sArtNode[u8Type];
+        JF_FLAG_SET(jjccp.jjccp_jfCache, JF_JIUKUN_CACHE_CREATE_FLAG_SHARED);
+        JF_FLAG_SET(jjccp.jjccp_jfCache, JF_JIUKUN_CACHE_CREATE_FLAG_HWCACHE_ALIGN);
+
+        u32Ret = jf_jiukun_createCache(&pia->ia_pjjcNode[u8Type], &jjccp);
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        *ppja = pia;
+    else if (pia != NULL)
+        jf_art_destroy((jf_art_t **)&pia);
+
+    return u32Ret;
+}
+
+u32 jf_art_destroy(jf_art_t ** ppja)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_art_t * pia = NULL;
+    u8 u8Type;
+
+    assert((ppja != NULL) && (*ppja != NULL));
+
+    pia = (internal_art_t *) *ppja;
+
+    if (pia->ia_pRoot != NULL)
+        _destroyArtNode(pia, pia->ia_pRoot);
+
+    for (u8Type = ART_NODE4; u8Type < ART_NUM_OF_NODE_TYPE; u8Type ++)
+        if (pia->ia_pjjcNode[u8Type] != NULL)
+            jf_jiukun_destroyCache(&pia->ia_pjjcNode[u8Type]);
+
+    jf_jiukun_freeMemory(ppja);
+
+    return u32Ret;
+}
+
+u32 jf_art_insert(jf_art_t * pja, const olchar_t * pstrKey, void * pValue)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_art_t * pia = (internal_art_t *)pja;
+
+    assert((pja != NULL) && (pstrKey != NULL));
+
+    u32Ret = _insertArt(
+        pia, &pia->ia_pRoot, (const u8 *)pstrKey, (u32)ol_strlen(pstrKey) + 1, 0, pValue);
+    if (u32Ret == JF_ERR_NO_ERROR)
+        pia->ia_u32NumOfKey ++;
+
+    return u32Ret;
+}
+
+u32 jf_art_remove(jf_art_t * pja, const olchar_t * pstrKey, void ** ppValue)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_art_t * pia = (internal_art_t *)pja;
+
+    assert((pja != NULL) && (pstrKey != NULL));
+
+    u32Ret = _removeArt(
+        pia, &pia->ia_pRoot, (const u8 *)pstrKey, (u32)ol_strlen(pstrKey) + 1, ppValue);
+    if (u32Ret == JF_ERR_NO_ERROR)
+        pia->ia_u32NumOfKey --;
+
+    return u32Ret;
+}
+
+u32 jf_art_get(jf_art_t * pja, const olchar_t * pstrKey, void ** ppValue)
+{
+    u32 u32Ret = JF_ERR_NOT_FOUND;
+    internal_art_t * pia = (internal_art_t *)pja;
+    art_leaf_t * pal = NULL;
+
+    assert((pja != NULL) && (pstrKey != NULL) && (ppValue != NULL));
+
+    pal = _searchArt(pia, (const u8 *)pstrKey, (u32)ol_strlen(pstrKey) + 1);
+    if (pal != NULL)
+    {
+        *ppValue = pal->al_pValue;
+        u32Ret = JF_ERR_NO_ERROR;
+    }
+
+    return u32Ret;
+}
+
+u32 jf_art_iteratePrefix(
+    jf_art_t * pja, const olchar_t * pstrPrefix, jf_art_fnOpEntry_t fnOpEntry, void * pArg)
+{
+    internal_art_t * pia = (internal_art_t *)pja;
+
+    assert((pja != NULL) && (pstrPrefix != NULL) && (fnOpEntry != NULL));
+
+    return _iterateArtPrefix(
+        pia, (const u8 *)pstrPrefix, (u32)ol_strlen(pstrPrefix), fnOpEntry, pArg);
+}
+
+u32 jf_art_getSize(jf_art_t * pja)
+{
+    internal_art_t * pia = (internal_art_t *)pja;
+
+    return pia->ia_u32NumOfKey;
+}
+
+void jf_art_getStat(jf_art_t * pja, jf_art_stat_t * pjas)
+{
+    internal_art_t * pia = (internal_art_t *)pja;
+
+    assert((pja != NULL) && (pjas != NULL));
+
+    ol_bzero(pjas, sizeof(*pjas));
+    pjas->jas_u32NumOfKey = pia->ia_u32NumOfKey;
+    pjas->jas_u32NumOfNode4 = pia->ia_u32NumOfNode[ART_NODE4];
+    pjas->jas_u32NumOfNode16 = pia->ia_u32NumOfNode[ART_NODE16];
+    pjas->jas_u32NumOfNode48 = pia->ia_u32NumOfNode[ART_NODE48];
+    pjas->jas_u32NumOfNode256 = pia->ia_u32NumOfNode[ART_NODE256];
+}
+
+/*------------------------------------------------------------------------------------------------*/
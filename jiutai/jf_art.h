@@ -0,0 +1,166 @@
+/**
+ *  @file jf_art.h
+ *
+ *  @brief Header file for adaptive radix tree common object.
+ *
+ *  @author Min Zhang
+ *
+ *  @note
+ *  -# Routines declared in this file are included in jf_art object.
+ *  -# Link with jf_jiukun library for memory allocation.
+ *  -# This object is not thread safe.
+ *  -# The key is null-terminated string and it's unique in the tree. The keys are iterated in
+ *   lexicographic order.
+ *  -# The inner node has 4, 16, 48 or 256 children, it grows and shrinks with the number of
+ *   children. The common prefix of keys is compressed into the inner node.
+ *  -# The inner nodes are allocated from jiukun caches shared by all adaptive radix trees.
+ */
+
+/*------------------------------------------------------------------------------------------------*/
+#ifndef JIUTAI_ART_H
+#define JIUTAI_ART_H
+
+/* --- standard C lib header files -------------------------------------------------------------- */
+
+/* --- internal header files -------------------------------------------------------------------- */
+#include "jf_basic.h"
+#include "jf_err.h"
+
+/* --- constant definitions --------------------------------------------------------------------- */
+
+/** Define the adaptive radix tree data type.
+ */
+typedef void  jf_art_t;
+
+/* --- data structures -------------------------------------------------------------------------- */
+
+/** The callback function to free the value when the tree is destroyed.
+ */
+typedef u32 (* jf_art_fnFreeValue_t)(void ** ppValue);
+
+/** The callback function to operate on the key and value when iterating the tree.
+ *
+ *  @note
+ *  -# The iteration will stop if the return code is not JF_ERR_NO_ERROR.
+ *  -# The tree cannot be changed in the callback function.
+ */
+typedef u32 (* jf_art_fnOpEntry_t)(const olchar_t * pstrKey, void * pValue, void * pArg);
+
+/** Define the parameter data type for creating adaptive radix tree.
+ */
+typedef struct
+{
+    /**Callback function to free the value, it's optional.*/
+    jf_art_fnFreeValue_t jacp_fnFreeValue;
+    u32 jacp_u32Reserved[4];
+} jf_art_create_param_t;
+
+/** Define the statistic data type of adaptive radix tree.
+ */
+typedef struct
+{
+    /**Number of keys.*/
+    u32 jas_u32NumOfKey;
+    /**Number of inner nodes with 4 children.*/
+    u32 jas_u32NumOfNode4;
+    /**Number of inner nodes with 16 children.*/
+    u32 jas_u32NumOfNode16;
+    /**Number of inner nodes with 48 children.*/
+    u32 jas_u32NumOfNode48;
+    /**Number of inner nodes with 256 children.*/
+    u32 jas_u32NumOfNode256;
+    u32 jas_u32Reserved[3];
+} jf_art_stat_t;
+
+/* --- functional routines ---------------------------------------------------------------------- */
+
+/** Create the adaptive radix tree.
+ *
+ *  @param ppja [out] The tree to be created and returned.
+ *  @param pjacp [in] The parameter for creating the tree.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ *  @retval JF_ERR_OUT_OF_MEMORY Out of memory.
+ */
+u32 jf_art_create(jf_art_t ** ppja, jf_art_create_param_t * pjacp);
+
+/** Destroy the adaptive radix tree, the values are freed if the callback function is specified.
+ *
+ *  @param ppja [in/out] The tree to be destroyed.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ */
+u32 jf_art_destroy(jf_art_t ** ppja);
+
+/** Insert the key and value to the tree, the key is copied.
+ *
+ *  @param pja [in] The tree.
+ *  @param pstrKey [in] The key.
+ *  @param pValue [in] The value.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ *  @retval JF_ERR_ALREADY_EXIST The key is in the tree.
+ *  @retval JF_ERR_OUT_OF_MEMORY Out of memory.
+ */
+u32 jf_art_insert(jf_art_t * pja, const olchar_t * pstrKey, void * pValue);
+
+/** Remove the key from the tree, the value is returned and not freed.
+ *
+ *  @param pja [in] The tree.
+ *  @param pstrKey [in] The key.
+ *  @param ppValue [out] The value of the key, it can be NULL.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ *  @retval JF_ERR_NOT_FOUND The key is not found.
+ */
+u32 jf_art_remove(jf_art_t * pja, const olchar_t * pstrKey, void ** ppValue);
+
+/** Get the value of the key.
+ *
+ *  @param pja [in] The tree.
+ *  @param pstrKey [in] The key.
+ *  @param ppValue [out] The value of the key.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ *  @retval JF_ERR_NOT_FOUND The key is not found.
+ */
+u32 jf_art_get(jf_art_t * pja, const olchar_t * pstrKey, void ** ppValue);
+
+/** Iterate the keys starting with the prefix in lexicographic order.
+ *
+ *  @param pja [in] The tree.
+ *  @param pstrPrefix [in] The prefix, all keys are iterated if it's empty string.
+ *  @param fnOpEntry [in] The callback function to operate on the key and value.
+ *  @param pArg [in] The argument for the callback function.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ */
+u32 jf_art_iteratePrefix(
+    jf_art_t * pja, const olchar_t * pstrPrefix, jf_art_fnOpEntry_t fnOpEntry, void * pArg);
+
+/** Get number of keys in the tree.
+ *
+ *  @param pja [in] The tree.
+ *
+ *  @return Number of keys.
+ */
+u32 jf_art_getSize(jf_art_t * pja);
+
+/** Get the statistic of the tree.
+ *
+ *  @param pja [in] The tree.
+ *  @param pjas [out] The statistic.
+ *
+ *  @return Void.
+ */
+void jf_art_getStat(jf_art_t * pja, jf_art_stat_t * pjas);
+
+#endif /*JIUTAI_ART_H*/
+
+/*------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,329 @@
+/**
+ *  @file jf_atomic.h
+ *
+ *  @brief Header file defines the atomic operations.
+ *
+ *  @author Min Zhang
+ *
+ *  @note
+ *  -# The routines are inline and no library is required.
+ *  -# Load has acquire semantic, store has release semantic, the read-modify-write operations are
+ *   sequentially consistent.
+ *  -# The variable must be naturally aligned.
+ *  -# The wait and wake routines block the thread on the address of a u32 variable, they are based
+ *   on futex on Linux and WaitOnAddress on Windows which requires Synchronization.lib.
+ *
+ */
+
+#ifndef JIUTAI_ATOMIC_H
+#define JIUTAI_ATOMIC_H
+
+/* --- standard C lib header files -------------------------------------------------------------- */
+#if defined(LINUX)
+    #include <unistd.h>
+    #include <errno.h>
+    #include <time.h>
+    #include <sys/syscall.h>
+    #include <linux/futex.h>
+#elif defined(WINDOWS)
+    #include <windows.h>
+#endif
+
+/* --- internal header files -------------------------------------------------------------------- */
+#include "jf_basic.h"
+
+/* --- constant definitions --------------------------------------------------------------------- */
+
+/** Wait without timeout.
+ */
+#define JF_ATOMIC_WAIT_FOREVER              (0xFFFFFFFF)
+
+/* --- data structures -------------------------------------------------------------------------- */
+
+/* --- functional routines ---------------------------------------------------------------------- */
+
+#if defined(LINUX)
+
+static inline u32 jf_atomic_loadU32(volatile u32 * pu32Var)
+{
+    return __atomic_load_n(pu32Var, __ATOMIC_ACQUIRE);
+}
+
+static inline void jf_atomic_storeU32(volatile u32 * pu32Var, u32 u32Value)
+{
+    __atomic_store_n(pu32Var, u32Value, __ATOMIC_RELEASE);
+}
+
+/** Add the value to the variable.
+ *
+ *  @return The value before the addition.
+ */
+static inline u32 jf_atomic_fetchAddU32(volatile u32 * pu32Var, u32 u32Value)
+{
+    return __atomic_fetch_add(pu32Var, u32Value, __ATOMIC_SEQ_CST);
+}
+
+/** Set the variable to the new value if it equals to the expected value.
+ *
+ *  @return TRUE if the variable is set.
+ */
+static inline boolean_t jf_atomic_casU32(volatile u32 * pu32Var, u32 u32Expected, u32 u32Value)
+{
+    return __atomic_compare_exchange_n(
+        pu32Var, &u32Expected, u32Value, FALSE, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+static inline u32 jf_atomic_exchangeU32(volatile u32 * pu32Var, u32 u32Value)
+{
+    return __atomic_exchange_n(pu32Var, u32Value, __ATOMIC_SEQ_CST);
+}
+
+static inline u64 jf_atomic_loadU64(volatile u64 * pu64Var)
+{
+    return __atomic_load_n(pu64Var, __ATOMIC_ACQUIRE);
+}
+
+static inline void jf_atomic_storeU64(volatile u64 * pu64Var, u64 u64Value)
+{
+    __atomic_store_n(pu64Var, u64Value, __ATOMIC_RELEASE);
+}
+
+/** Add the value to the variable.
+ *
+ *  @return The value before the addition.
+ */
+static inline u64 jf_atomic_fetchAddU64(volatile u64 * pu64Var, u64 u64Value)
+{
+    return __atomic_fetch_add(pu64Var, u64Value, __ATOMIC_SEQ_CST);
+}
+
+/** Set the variable to the new value if it equals to the expected value.
+ *
+ *  @return TRUE if the variable is set.
+ */
+static inline boolean_t jf_atomic_casU64(volatile u64 * pu64Var, u64 u64Expected, u64 u64Value)
+{
+    return __atomic_compare_exchange_n(
+        pu64Var, &u64Expected, u64Value, FALSE, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+static inline void * jf_atomic_loadPointer(void * volatile * ppVar)
+{
+    return __atomic_load_n(ppVar, __ATOMIC_ACQUIRE);
+}
+
+static inline void jf_atomic_storePointer(void * volatile * ppVar, void * pValue)
+{
+    __atomic_store_n(ppVar, pValue, __ATOMIC_RELEASE);
+}
+
+/** Set the pointer to the new value.
+ *
+ *  @return The value before the exchange.
+ */
+static inline void * jf_atomic_exchangePointer(void * volatile * ppVar, void * pValue)
+{
+    return __atomic_exchange_n(ppVar, pValue, __ATOMIC_SEQ_CST);
+}
+
+/** Set the pointer to the new value if it equals to the expected value.
+ *
+ *  @return TRUE if the pointer is set.
+ */
+static inline boolean_t jf_atomic_casPointer(
+    void * volatile * ppVar, void * pExpected, void * pValue)
+{
+    return __atomic_compare_exchange_n(
+        ppVar, &pExpected, pValue, FALSE, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+/** Full memory barrier.
+ */
+static inline void jf_atomic_fence(void)
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+/** Acquire memory barrier, the loads before it are not reordered with the loads and stores after
+ *  it.
+ */
+static inline void jf_atomic_fenceAcquire(void)
+{
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+}
+
+/** Hint the CPU in spin wait loop.
+ */
+static inline void jf_atomic_pause(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+/** Block the thread if the variable equals to the expected value until it's woken up or timed out.
+ *  The caller should check the variable again as the wake up can be spurious.
+ *
+ *  @param pu32Var [in] The variable.
+ *  @param u32Expected [in] The expected value.
+ *  @param u32Timeout [in] The timeout in millisecond, JF_ATOMIC_WAIT_FOREVER for no timeout.
+ *
+ *  @return FALSE if timed out, otherwise TRUE.
+ */
+static inline boolean_t jf_atomic_waitU32(volatile u32 * pu32Var, u32 u32Expected, u32 u32Timeout)
+{
+    struct timespec ts, * pts = NULL;
+
+    if (u32Timeout != JF_ATOMIC_WAIT_FOREVER)
+    {
+        ts.tv_sec = u32Timeout / 1000;
+        ts.tv_nsec = (u32Timeout % 1000) * 1000000;
+        pts = &ts;
+    }
+
+    if ((syscall(SYS_futex, pu32Var, FUTEX_WAIT_PRIVATE, u32Expected, pts, NULL, 0) == -1) &&
+        (errno == ETIMEDOUT))
+        return FALSE;
+
+    return TRUE;
+}
+
+/** Wake up the threads blocked on the variable.
+ *
+ *  @param pu32Var [in] The variable.
+ *  @param bAll [in] Wake up all threads if it's TRUE, otherwise one thread.
+ */
+static inline void jf_atomic_wakeU32(volatile u32 * pu32Var, boolean_t bAll)
+{
+    syscall(SYS_futex, pu32Var, FUTEX_WAKE_PRIVATE, bAll ? 0x7FFFFFFF : 1, NULL, NULL, 0);
+}
+
+#elif defined(WINDOWS)
+
+static inline u32 jf_atomic_loadU32(volatile u32 * pu32Var)
+{
+    u32 u32Value = *pu32Var;
+
+    MemoryBarrier();
+
+    return u32Value;
+}
+
+static inline void jf_atomic_storeU32(volatile u32 * pu32Var, u32 u32Value)
+{
+    MemoryBarrier();
+
+    *pu32Var = u32Value;
+}
+
+static inline u32 jf_atomic_fetchAddU32(volatile u32 * pu32Var, u32 u32Value)
+{
+    return (u32)InterlockedExchangeAdd((volatile LONG *)pu32Var, (LONG)u32Value);
+}
+
+static inline boolean_t jf_atomic_casU32(volatile u32 * pu32Var, u32 u32Expected, u32 u32Value)
+{
+    return (u32)InterlockedCompareExchange(
+        (volatile LONG *)pu32Var, (LONG)u32Value, (LONG)u32Expected) == u32Expected;
+}
+
+static inline u32 jf_atomic_exchangeU32(volatile u32 * pu32Var, u32 u32Value)
+{
+    return (u32)InterlockedExchange((volatile LONG *)pu32Var, (LONG)u32Value);
+}
+
+static inline u64 jf_atomic_loadU64(volatile u64 * pu64Var)
+{
+    u64 u64Value = *pu64Var;
+
+    MemoryBarrier();
+
+    return u64Value;
+}
+
+static inline void jf_atomic_storeU64(volatile u64 * pu64Var, u64 u64Value)
+{
+    MemoryBarrier();
+
+    *pu64Var = u64Value;
+}
+
+static inline u64 jf_atomic_fetchAddU64(volatile u64 * pu64Var, u64 u64Value)
+{
+    return (u64)InterlockedExchangeAdd64((volatile LONG64 *)pu64Var, (LONG64)u64Value);
+}
+
+static inline boolean_t jf_atomic_casU64(volatile u64 * pu64Var, u64 u64Expected, u64 u64Value)
+{
+    return (u64)InterlockedCompareExchange64(
+        (volatile LONG64 *)pu64Var, (LONG64)u64Value, (LONG64)u64Expected) == u64Expected;
+}
+
+static inline void * jf_atomic_loadPointer(void * volatile * ppVar)
+{
+    void * pValue = *ppVar;
+
+    MemoryBarrier();
+
+    return pValue;
+}
+
+static inline void jf_atomic_storePointer(void * volatile * ppVar, void * pValue)
+{
+    MemoryBarrier();
+
+    *ppVar = pValue;
+}
+
+static inline void * jf_atomic_exchangePointer(void * volatile * ppVar, void * pValue)
+{
+    return InterlockedExchangePointer(ppVar, pValue);
+}
+
+static inline boolean_t jf_atomic_casPointer(
+    void * volatile * ppVar, void * pExpected, void * pValue)
+{
+    return InterlockedCompareExchangePointer(ppVar, pValue, pExpected) == pExpected;
+}
+
+static inline void jf_atomic_fence(void)
+{
+    MemoryBarrier();
+}
+
+static inline void jf_atomic_fenceAcquire(void)
+{
+    MemoryBarrier();
+}
+
+static inline void jf_atomic_pause(void)
+{
+    YieldProcessor();
+}
+
+static inline boolean_t jf_atomic_waitU32(volatile u32 * pu32Var, u32 u32Expected, u32 u32Timeout)
+{
+    if (! WaitOnAddress(
+            pu32Var, &u32Expected, sizeof(u32),
+            (u32Timeout == JF_ATOMIC_WAIT_FOREVER) ? INFINITE : u32Timeout) &&
+        (GetLastError() == ERROR_TIMEOUT))
+        return FALSE;
+
+    return TRUE;
+}
+
+static inline void jf_atomic_wakeU32(volatile u32 * pu32Var, boolean_t bAll)
+{
+    if (bAll)
+        WakeByAddressAll((PVOID)pu32Var);
+    else
+        WakeByAddressSingle((PVOID)pu32Var);
+}
+
+#endif
+
+#endif /*JIUTAI_ATOMIC_H*/
+
+/*------------------------------------------------------------------------------------------------*/
+
+
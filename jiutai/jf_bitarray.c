@@ -0,0 +1,438 @@
+/**
+ *  @file jf_bitarray.c
+ *
+ *  @brief Implementation file for the routines of large bit array.
+ *
+ *  @author Min Zhang
+ *
+ *  @note
+ *  -# The bit array is scanned a word at a time, the word is compared as a whole, so the bit order
+ *   in bit array is not changed. Only the char containing the bit is checked bit by bit.
+ *  -# The operation set is selected when the object is loaded, the AVX2 operation set is used if
+ *   it's supported by the CPU, otherwise the generic operation set with 64bit word is used.
+ */
+
+/* --- standard C lib header files -------------------------------------------------------------- */
+#include <string.h>
+
+/* --- internal header files -------------------------------------------------------------------- */
+#include "jf_basic.h"
+#include "jf_limit.h"
+#include "jf_err.h"
+#include "jf_bitarray.h"
+
+#if defined(LINUX) && defined(__x86_64__)
+    #define BITARRAY_AVX2
+    #include <immintrin.h>
+#endif
+
+/* --- private data/data structure section ------------------------------------------------------ */
+
+/** Number of char in a word.
+ */
+#define BITARRAY_CHARS_PER_WORD        (sizeof(u64))
+
+/** Number of char in an AVX2 register.
+ */
+#define BITARRAY_CHARS_PER_AVX2        (32)
+
+/** The callback function to skip the chars with value "u8Skip", return the index of the first char
+ *  with other value or "u32Chars" if all chars are "u8Skip".
+ */
+typedef u32 (* fnSkipBitarrayChar_t)(const jf_bitarray_t * pjb, u32 u32Chars, u8 u8Skip);
+
+/** The callback function to count the set bits.
+ */
+typedef u32 (* fnCountBitarraySetBit_t)(const jf_bitarray_t * pjb, u32 u32Chars);
+
+/** The callback function for the logical operation.
+ */
+typedef void (* fnOperateBitarray_t)(
+    jf_bitarray_t * pDest, const jf_bitarray_t * pSrc1, const jf_bitarray_t * pSrc2,
+    u32 u32Chars);
+
+/** Define the operation set of bit array.
+ */
+typedef struct
+{
+    fnSkipBitarrayChar_t bo_fnSkipChar;
+    fnCountBitarraySetBit_t bo_fnCountSetBit;
+    fnOperateBitarray_t bo_fnAnd;
+    fnOperateBitarray_t bo_fnOr;
+    fnOperateBitarray_t bo_fnXor;
+    fnOperateBitarray_t bo_fnAndNot;
+} bitarray_ops_t;
+
+/* --- private routine section ------------------------------------------------------------------ */
+
+/** Count the set bits in word without the popcnt instruction.
+ */
+static inline u32 _countWordSetBit(u64 u64Word)
+{
+    u64Word = u64Word - ((u64Word >> 1) & 0x5555555555555555ULL);
+    u64Word = (u64Word & 0x3333333333333333ULL) + ((u64Word >> 2) & 0x3333333333333333ULL);
+    u64Word = (u64Word + (u64Word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+
+    return (u32)((u64Word * 0x0101010101010101ULL) >> 56);
+}
+
+/** Return the position of the first set bit in char, the char should not be 0.
+ */
+static inline u32 _findCharFirstSetBit(u8 u8Char)
+{
+    u32 u32Pos = 0;
+
+    while ((u8Char & 0x80) == 0)
+    {
+        u8Char <<= 1;
+        u32Pos ++;
+    }
+
+    return u32Pos;
+}
+
+static u32 _skipBitarrayChar(const jf_bitarray_t * pjb, u32 u32Chars, u8 u8Skip)
+{
+    u32 u32Index = 0;
+    u64 u64Word, u64Skip = (u8Skip == 0) ? 0 : U64_MAX;
+
+    for (; u32Index + BITARRAY_CHARS_PER_WORD <= u32Chars; u32Index += BITARRAY_CHARS_PER_WORD)
+    {
+        ol_memcpy(&u64Word, pjb + u32Index, sizeof(u64Word));
+        if (u64Word != u64Skip)
+            break;
+    }
+
+    while ((u32Index < u32Chars) && (pjb[u32Index] == u8Skip))
+        u32Index ++;
+
+    return u32Index;
+}
+
+static u32 _countBitarraySetBit(const jf_bitarray_t * pjb, u32 u32Chars)
+{
+    u32 u32Index = 0, u32Count = 0;
+    u64 u64Word;
+
+    for (; u32Index + BITARRAY_CHARS_PER_WORD <= u32Chars; u32Index += BITARRAY_CHARS_PER_WORD)
+    {
+        ol_memcpy(&u64Word, pjb + u32Index, sizeof(u64Word));
+        u32Count += _countWordSetBit(u64Word);
+    }
+
+    for (; u32Index < u32Chars; u32Index ++)
+        u32Count += _countWordSetBit(pjb[u32Index]);
+
+    return u32Count;
+}
+
+/** Define the generic logical operation with 64bit word.
+ */
+#define BITARRAY_DEFINE_OPERATION(name, op)                                                     \
+static void name(                                                                               \
+    jf_bitarray_t * pDest, const jf_bitarray_t * pSrc1, const jf_bitarray_t * pSrc2,            \
+    u32 u32Chars)                                                                               \
+{                                                                                               \
+    u32 u32Index = 0;                                                                           \
+    u64 u64Word1, u64Word2;                                                                     \
+                                                                                                \
+    for (; u32Index + BITARRAY_CHARS_PER_WORD <= u32Chars; u32Index += BITARRAY_CHARS_PER_WORD) \
+    {                                                                                           \
+        ol_memcpy(&u64Word1, pSrc1 + u32Index, sizeof(u64Word1));                               \
+        ol_memcpy(&u64Word2, pSrc2 + u32Index, sizeof(u64Word2));                               \
+        u64Word1 = op(u64Word1, u64Word2);                                                      \
+        ol_memcpy(pDest + u32Index, &u64Word1, sizeof(u64Word1));                               \
+    }                                                                                           \
+                                                                                                \
+    for (; u32Index < u32Chars; u32Index ++)                                                    \
+        pDest[u32Index] = (u8)op(pSrc1[u32Index], pSrc2[u32Index]);                             \
+}
+
+#define BITARRAY_AND(a, b)      ((a) & (b))
+#define BITARRAY_OR(a, b)       ((a) | (b))
+#define BITARRAY_XOR(a, b)      ((a) ^ (b))
+#define BITARRAY_AND_NOT(a, b)  ((a) & ~(b))
+
+BITARRAY_DEFINE_OPERATION(_andBitarray, BITARRAY_AND)
+BITARRAY_DEFINE_OPERATION(_orBitarray, BITARRAY_OR)
+BITARRAY_DEFINE_OPERATION(_xorBitarray, BITARRAY_XOR)
+BITARRAY_DEFINE_OPERATION(_andNotBitarray, BITARRAY_AND_NOT)
+
+/** The generic operation set.
+ */
+static const bitarray_ops_t ls_boGeneric =
+{
+    _skipBitarrayChar,
+    _countBitarraySetBit,
+    _andBitarray,
+    _orBitarray,
+    _xorBitarray,
+    _andNotBitarray,
+};
+
+#if defined(BITARRAY_AVX2)
+
+__attribute__((target("avx2")))
+static u32 _skipBitarrayCharAvx2(const jf_bitarray_t * pjb, u32 u32Chars, u8 u8Skip)
+{
+    u32 u32Index = 0;
+    __m256i mSkip = _mm256_set1_epi8((s8)u8Skip), mData;
+
+    for (; u32Index + BITARRAY_CHARS_PER_AVX2 <= u32Chars; u32Index += BITARRAY_CHARS_PER_AVX2)
+    {
+        mData = _mm256_loadu_si256((const __m256i *)(pjb + u32Index));
+        if ((u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(mData, mSkip)) != U32_MAX)
+            break;
+    }
+
+    return u32Index + _skipBitarrayChar(pjb + u32Index, u32Chars - u32Index, u8Skip);
+}
+
+/** Count the set bits with the lookup table of nibble, the counts of chars are summed up to 64bit
+ *  lanes.
+ */
+__attribute__((target("avx2")))
+static u32 _countBitarraySetBitAvx2(const jf_bitarray_t * pjb, u32 u32Chars)
+{
+    u32 u32Index = 0;
+    u64 u64Sum[4];
+    __m256i mLookup = _mm256_setr_epi8(
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    __m256i mNibble = _mm256_set1_epi8(0x0F);
+    __m256i mZero = _mm256_setzero_si256(), mSum = _mm256_setzero_si256();
+    __m256i mData, mCount;
+
+    for (; u32Index + BITARRAY_CHARS_PER_AVX2 <= u32Chars; u32Index += BITARRAY_CHARS_PER_AVX2)
+    {
+        mData = _mm256_loadu_si256((const __m256i *)(pjb + u32Index));
+        mCount = _mm256_add_epi8(
+            _mm256_shuffle_epi8(mLookup, _mm256_and_si256(mData, mNibble)),
+            _mm256_shuffle_epi8(
+                mLookup, _mm256_and_si256(_mm256_srli_epi16(mData, 4), mNibble)));
+        mSum = _mm256_add_epi64(mSum, _mm256_sad_epu8(mCount, mZero));
+    }
+
+    _mm256_storeu_si256((__m256i *)u64Sum, mSum);
+
+    return (u32)(u64Sum[0] + u64Sum[1] + u64Sum[2] + u64Sum[3]) +
+        _countBitarraySetBit(pjb + u32Index, u32Chars - u32Index);
+}
+
+/** Define the logical operation with AVX2, the remaining chars are handled by the generic
+ *  operation.
+ */
+#define BITARRAY_DEFINE_OPERATION_AVX2(name, op, generic)                                      \
+__attribute__((target("avx2")))                                                                 \
+static void name(                                                                               \
+    jf_bitarray_t * pDest, const jf_bitarray_t * pSrc1, const jf_bitarray_t * pSrc2,            \
+    u32 u32Chars)                                                                               \
+{                                                                                               \
+    u32 u32Index = 0;                                                                           \
+    __m256i mData1, mData2;                                                                     \
+                                                                                                \
+    for (; u32Index + BITARRAY_CHARS_PER_AVX2 <= u32Chars; u32Index += BITARRAY_CHARS_PER_AVX2) \
+    {                                                                                           \
+        mData1 = _mm256_loadu_si256((const __m256i *)(pSrc1 + u32Index));                       \
+        mData2 = _mm256_loadu_si256((const __m256i *)(pSrc2 + u32Index));                       \
+        _mm256_storeu_si256((__m256i *)(pDest + u32Index), op);                                 \
+    }                                                                                           \
+                                                                                                \
+    generic(pDest + u32Index, pSrc1 + u32Index, pSrc2 + u32Index, u32Chars - u32Index);         \
+}
+
+BITARRAY_DEFINE_OPERATION_AVX2(
+    _andBitarrayAvx2, _mm256_and_si256(mData1, mData2), _andBitarray)
+BITARRAY_DEFINE_OPERATION_AVX2(
+    _orBitarrayAvx2, _mm256_or_si256(mData1, mData2), _orBitarray)
+BITARRAY_DEFINE_OPERATION_AVX2(
+    _xorBitarrayAvx2, _mm256_xor_si256(mData1, mData2), _xorBitarray)
+BITARRAY_DEFINE_OPERATION_AVX2(
+    _andNotBitarrayAvx2, _mm256_andnot_si256(mData2, mData1), _andNotBitarray)
+
+/** The operation set with AVX2.
+ */
+static const bitarray_ops_t ls_boAvx2 =
+{
+    _skipBitarrayCharAvx2,
+    _countBitarraySetBitAvx2,
+    _andBitarrayAvx2,
+    _orBitarrayAvx2,
+    _xorBitarrayAvx2,
+    _andNotBitarrayAvx2,
+};
+
+#endif
+
+/** The operation set in use.
+ */
+static const bitarray_ops_t * ls_pboBitarrayOps = &ls_boGeneric;
+
+#if defined(BITARRAY_AVX2)
+
+static boolean_t _isBitarrayAvx2Supported(void)
+{
+    __builtin_cpu_init();
+
+    return __builtin_cpu_supports("avx2") ? TRUE : FALSE;
+}
+
+/** Select the operation set when the object is loaded.
+ */
+__attribute__((constructor))
+static void _initBitarrayOps(void)
+{
+    if (_isBitarrayAvx2Supported())
+        ls_pboBitarrayOps = &ls_boAvx2;
+}
+
+#endif
+
+static u32 _findFirstBit(const jf_bitarray_t * pjb, u32 u32Bits, u32 u32Start, u8 u8Skip)
+{
+    u32 u32Chars, u32Index;
+    u8 u8Char;
+
+    if (u32Start >= u32Bits)
+        return u32Bits;
+
+    u32Chars = JF_BITARRAY_BITS_TO_CHARS(u32Bits);
+    u32Index = JF_BITARRAY_BIT_CHAR(u32Start);
+
+    /*Mask out the bits before the start position in the first char.*/
+    u8Char = (pjb[u32Index] ^ u8Skip) & (U8_MAX >> (u32Start % JF_BITARRAY_BITS_PER_UNIT));
+
+    if (u8Char == 0)
+    {
+        u32Index ++;
+        u32Index += ls_pboBitarrayOps->bo_fnSkipChar(pjb + u32Index, u32Chars - u32Index, u8Skip);
+        if (u32Index == u32Chars)
+            return u32Bits;
+
+        u8Char = pjb[u32Index] ^ u8Skip;
+    }
+
+    /*The spare bits in the last char may be found.*/
+    return MIN(u32Index * JF_BITARRAY_BITS_PER_UNIT + _findCharFirstSetBit(u8Char), u32Bits);
+}
+
+static void _fillBitarrayRange(jf_bitarray_t * pjb, u32 u32Start, u32 u32Count, boolean_t bSet)
+{
+    u32 u32First = JF_BITARRAY_BIT_CHAR(u32Start);
+    u32 u32Last = JF_BITARRAY_BIT_CHAR(u32Start + u32Count - 1);
+    u8 u8Head = U8_MAX >> (u32Start % JF_BITARRAY_BITS_PER_UNIT);
+    u8 u8Tail = (u8)(U8_MAX << (JF_BITARRAY_BITS_PER_UNIT - 1 -
+                                (u32Start + u32Count - 1) % JF_BITARRAY_BITS_PER_UNIT));
+
+    if (u32First == u32Last)
+    {
+        u8Head &= u8Tail;
+        u8Tail = u8Head;
+    }
+    else if (u32Last > u32First + 1)
+    {
+        ol_memset(pjb + u32First + 1, bSet ? U8_MAX : 0, u32Last - u32First - 1);
+    }
+
+    if (bSet)
+    {
+        pjb[u32First] |= u8Head;
+        pjb[u32Last] |= u8Tail;
+    }
+    else
+    {
+        pjb[u32First] &= (u8)~u8Head;
+        pjb[u32Last] &= (u8)~u8Tail;
+    }
+}
+
+/* --- public routine section ------------------------------------------------------------------- */
+
+u32 jf_bitarray_findFirstSetBit(const jf_bitarray_t * pjb, u32 u32Bits, u32 u32Start)
+{
+    return _findFirstBit(pjb, u32Bits, u32Start, 0);
+}
+
+u32 jf_bitarray_findFirstZeroBit(const jf_bitarray_t * pjb, u32 u32Bits, u32 u32Start)
+{
+    return _findFirstBit(pjb, u32Bits, u32Start, U8_MAX);
+}
+
+u32 jf_bitarray_countSetBit(const jf_bitarray_t * pjb, u32 u32Bits)
+{
+    u32 u32Chars = u32Bits / JF_BITARRAY_BITS_PER_UNIT;
+    u32 u32Remain = u32Bits % JF_BITARRAY_BITS_PER_UNIT;
+    u32 u32Count = ls_pboBitarrayOps->bo_fnCountSetBit(pjb, u32Chars);
+
+    /*The spare bits in the last char are not counted.*/
+    if (u32Remain > 0)
+        u32Count += _countWordSetBit(
+            pjb[u32Chars] & (u8)(U8_MAX << (JF_BITARRAY_BITS_PER_UNIT - u32Remain)));
+
+    return u32Count;
+}
+
+void jf_bitarray_setRange(jf_bitarray_t * pjb, u32 u32Start, u32 u32Count)
+{
+    if (u32Count > 0)
+        _fillBitarrayRange(pjb, u32Start, u32Count, TRUE);
+}
+
+void jf_bitarray_clearRange(jf_bitarray_t * pjb, u32 u32Start, u32 u32Count)
+{
+    if (u32Count > 0)
+        _fillBitarrayRange(pjb, u32Start, u32Count, FALSE);
+}
+
+void jf_bitarray_and(
+    jf_bitarray_t * pDest, const jf_bitarray_t * pSrc1, const jf_bitarray_t * pSrc2,
+    u32 u32Chars)
+{
+    ls_pboBitarrayOps->bo_fnAnd(pDest, pSrc1, pSrc2, u32Chars);
+}
+
+void jf_bitarray_or(
+    jf_bitarray_t * pDest, const jf_bitarray_t * pSrc1, const jf_bitarray_t * pSrc2,
+    u32 u32Chars)
+{
+    ls_pboBitarrayOps->bo_fnOr(pDest, pSrc1, pSrc2, u32Chars);
+}
+
+void jf_bitarray_xor(
+    jf_bitarray_t * pDest, const jf_bitarray_t * pSrc1, const jf_bitarray_t * pSrc2,
+    u32 u32Chars)
+{
+    ls_pboBitarrayOps->bo_fnXor(pDest, pSrc1, pSrc2, u32Chars);
+}
+
+void jf_bitarray_andNot(
+    jf_bitarray_t * pDest, const jf_bitarray_t * pSrc1, const jf_bitarray_t * pSrc2,
+    u32 u32Chars)
+{
+    ls_pboBitarrayOps->bo_fnAndNot(pDest, pSrc1, pSrc2, u32Chars);
+}
+
+u32 jf_bitarray_enableSimd(boolean_t bEnable)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+
+    if (! bEnable)
+    {
+        ls_pboBitarrayOps = &ls_boGeneric;
+    }
+    else
+    {
+#if defined(BITARRAY_AVX2)
+        if (_isBitarrayAvx2Supported())
+            ls_pboBitarrayOps = &ls_boAvx2;
+        else
+            u32Ret = JF_ERR_NOT_SUPPORTED;
+#else
+        u32Ret = JF_ERR_NOT_SUPPORTED;
+#endif
+    }
+
+    return u32Ret;
+}
+
+/*------------------------------------------------------------------------------------------------*/
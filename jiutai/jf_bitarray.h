@@ -9,6 +9,10 @@
  *  @note
  *  -# Bit arrays are implemented as arrays of unsigned chars.  Bit 0 is the MSB of char 0,
  *   and the last bit is the least significant (non-spare) bit of the last unsigned char.
+ *  -# The macros and inline functions work on the bit array with fixed size. The routines for
+ *   large bit array are included in jf_bitarray object, the size is specified in parameter.
+ *  -# The routines of jf_bitarray object scan the bit array a word at a time, the AVX2
+ *   instructions are used if they are supported by the CPU.
  *
  *  <HR>
  *
@@ -395,6 +399,124 @@ static inline boolean_t jf_bitarray_testClearBit(jf_bitarray_t * ba, u32 pos)
     return oldbit;
 }
 
+/** Find the first set bit from position "u32Start".
+ *
+ *  @param pjb [in] The bit array.
+ *  @param u32Bits [in] Number of bits in the bit array.
+ *  @param u32Start [in] The position to start with.
+ *
+ *  @return The position of the first set bit, "u32Bits" if the bit is not found.
+ */
+u32 jf_bitarray_findFirstSetBit(const jf_bitarray_t * pjb, u32 u32Bits, u32 u32Start);
+
+/** Find the first cleared bit from position "u32Start".
+ *
+ *  @param pjb [in] The bit array.
+ *  @param u32Bits [in] Number of bits in the bit array.
+ *  @param u32Start [in] The position to start with.
+ *
+ *  @return The position of the first cleared bit, "u32Bits" if the bit is not found.
+ */
+u32 jf_bitarray_findFirstZeroBit(const jf_bitarray_t * pjb, u32 u32Bits, u32 u32Start);
+
+/** Count the set bits in bit array.
+ *
+ *  @param pjb [in] The bit array.
+ *  @param u32Bits [in] Number of bits in the bit array.
+ *
+ *  @return Number of set bits.
+ */
+u32 jf_bitarray_countSetBit(const jf_bitarray_t * pjb, u32 u32Bits);
+
+/** Set "u32Count" bits starting from position "u32Start" to 1.
+ *
+ *  @param pjb [in] The bit array.
+ *  @param u32Start [in] The position to start with.
+ *  @param u32Count [in] Number of bits to set.
+ *
+ *  @return Void.
+ */
+void jf_bitarray_setRange(jf_bitarray_t * pjb, u32 u32Start, u32 u32Count);
+
+/** Clear "u32Count" bits starting from position "u32Start" to 0.
+ *
+ *  @param pjb [in] The bit array.
+ *  @param u32Start [in] The position to start with.
+ *  @param u32Count [in] Number of bits to clear.
+ *
+ *  @return Void.
+ */
+void jf_bitarray_clearRange(jf_bitarray_t * pjb, u32 u32Start, u32 u32Count);
+
+/** And the bit array "pSrc1" with "pSrc2", the result saves to "pDest".
+ *
+ *  @note
+ *  -# The destination bit array can be one of the source bit array.
+ *
+ *  @param pDest [out] The destination bit array.
+ *  @param pSrc1 [in] The first source bit array.
+ *  @param pSrc2 [in] The second source bit array.
+ *  @param u32Chars [in] Number of char in the bit arrays.
+ *
+ *  @return Void.
+ */
+void jf_bitarray_and(
+    jf_bitarray_t * pDest, const jf_bitarray_t * pSrc1, const jf_bitarray_t * pSrc2,
+    u32 u32Chars);
+
+/** Or the bit array "pSrc1" with "pSrc2", the result saves to "pDest".
+ *
+ *  @param pDest [out] The destination bit array.
+ *  @param pSrc1 [in] The first source bit array.
+ *  @param pSrc2 [in] The second source bit array.
+ *  @param u32Chars [in] Number of char in the bit arrays.
+ *
+ *  @return Void.
+ */
+void jf_bitarray_or(
+    jf_bitarray_t * pDest, const jf_bitarray_t * pSrc1, const jf_bitarray_t * pSrc2,
+    u32 u32Chars);
+
+/** Xor the bit array "pSrc1" with "pSrc2", the result saves to "pDest".
+ *
+ *  @param pDest [out] The destination bit array.
+ *  @param pSrc1 [in] The first source bit array.
+ *  @param pSrc2 [in] The second source bit array.
+ *  @param u32Chars [in] Number of char in the bit arrays.
+ *
+ *  @return Void.
+ */
+void jf_bitarray_xor(
+    jf_bitarray_t * pDest, const jf_bitarray_t * pSrc1, const jf_bitarray_t * pSrc2,
+    u32 u32Chars);
+
+/** Clear the bits of "pSrc1" which are set in "pSrc2", the result saves to "pDest".
+ *
+ *  @param pDest [out] The destination bit array.
+ *  @param pSrc1 [in] The first source bit array.
+ *  @param pSrc2 [in] The second source bit array.
+ *  @param u32Chars [in] Number of char in the bit arrays.
+ *
+ *  @return Void.
+ */
+void jf_bitarray_andNot(
+    jf_bitarray_t * pDest, const jf_bitarray_t * pSrc1, const jf_bitarray_t * pSrc2,
+    u32 u32Chars);
+
+/** Enable or disable the SIMD instructions.
+ *
+ *  @note
+ *  -# The SIMD instructions are enabled by default if they are supported by the CPU.
+ *  -# The routine is not thread safe, it's for test and benchmark.
+ *
+ *  @param bEnable [in] Enable the SIMD instructions if it's TRUE.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ *  @retval JF_ERR_NOT_SUPPORTED The SIMD instructions are not supported by the CPU.
+ */
+u32 jf_bitarray_enableSimd(boolean_t bEnable);
+
 #endif /*JIUTAI_BITARRAY_H*/
 
 /*------------------------------------------------------------------------------------------------*/
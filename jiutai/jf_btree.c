@@ -0,0 +1,915 @@
+/**
+ *  @file jf_btree.c
+ *
+ *  @brief B+tree implementation file.
+ *
+ *  @author Min Zhang
+ *
+ *  @note
+ *  -# The keys and values are in leaf nodes, the inner nodes have the separator keys. The child i
+ *   of inner node has the keys less than separator i, the child i + 1 has the keys not less than
+ *   separator i. The separator is not updated when the key is removed from leaf, it's still a
+ *   valid separator.
+ *  -# The node is split when it's full and merged with the sibling when it's less than half full.
+ *  -# The nodes required by the insertion are allocated before the tree is changed, the tree is
+ *   not changed if the memory is not available.
+ */
+
+/* --- standard C lib header files -------------------------------------------------------------- */
+#include <string.h>
+
+/* --- internal header files -------------------------------------------------------------------- */
+#include "jf_basic.h"
+#include "jf_limit.h"
+#include "jf_err.h"
+#include "jf_btree.h"
+#include "jf_jiukun.h"
+
+/* --- private data/data structure section ------------------------------------------------------ */
+
+/** The cache of leaf node shared by all B+trees.
+ */
+#define BTREE_LEAF_CACHE                       "btree_leaf"
+
+/** The cache of inner node shared by all B+trees.
+ */
+#define BTREE_INNER_CACHE                      "btree_inner"
+
+/** Maximum number of keys in node, the node is about 8 cache lines.
+ */
+#define BTREE_MAX_KEY                          (30)
+
+/** Minimum number of keys in node except the root.
+ */
+#define BTREE_MIN_KEY                          (BTREE_MAX_KEY / 2)
+
+/** Maximum height of the tree, it's far more than required as the node has at least 16 children.
+ */
+#define BTREE_MAX_HEIGHT                       (16)
+
+/** The header of node.
+ */
+typedef struct btree_node
+{
+    u16 bn_u16NumOfKey;
+    /**The node is leaf or not.*/
+    boolean_t bn_bLeaf;
+    u8 bn_u8Reserved[5];
+} btree_node_t;
+
+typedef struct btree_leaf
+{
+    btree_node_t bl_bnNode;
+    struct btree_leaf * bl_pblPrev;
+    struct btree_leaf * bl_pblNext;
+    u64 bl_u64Key[BTREE_MAX_KEY];
+    void * bl_pValue[BTREE_MAX_KEY];
+} btree_leaf_t;
+
+typedef struct btree_inner
+{
+    btree_node_t bi_bnNode;
+    u64 bi_u64Key[BTREE_MAX_KEY];
+    btree_node_t * bi_pbnChild[BTREE_MAX_KEY + 1];
+} btree_inner_t;
+
+/** The inner nodes from the root to the leaf and the position of the child in each node.
+ */
+typedef struct
+{
+    btree_inner_t * bp_pbiNode[BTREE_MAX_HEIGHT];
+    u32 bp_u32Index[BTREE_MAX_HEIGHT];
+    u32 bp_u32Depth;
+} btree_path_t;
+
+/** The nodes allocated before insertion.
+ */
+typedef struct
+{
+    btree_leaf_t * bs_pblLeaf;
+    btree_inner_t * bs_pbiInner[BTREE_MAX_HEIGHT];
+    u32 bs_u32NumOfInner;
+} btree_spare_t;
+
+typedef struct
+{
+    btree_node_t * ib_pbnRoot;
+    u32 ib_u32NumOfKey;
+    u32 ib_u32Height;
+    jf_jiukun_cache_t * ib_pjjcLeaf;
+    jf_jiukun_cache_t * ib_pjjcInner;
+    jf_btree_fnFreeValue_t ib_fnFreeValue;
+} internal_btree_t;
+
+/* --- private routine section ------------------------------------------------------------------ */
+
+/** Find the first position whose key is not less than the key.
+ */
+static u32 _lowerBoundInNode(const u64 * pu64Key, u32 u32Num, u64 u64Key)
+{
+    u32 u32Low = 0, u32High = u32Num, u32Mid;
+
+    while (u32Low < u32High)
+    {
+        u32Mid = (u32Low + u32High) / 2;
+        if (pu64Key[u32Mid] < u64Key)
+            u32Low = u32Mid + 1;
+        else
+            u32High = u32Mid;
+    }
+
+    return u32Low;
+}
+
+/** Find the first position whose key is larger than the key, it's the child having the key.
+ */
+static u32 _upperBoundInNode(const u64 * pu64Key, u32 u32Num, u64 u64Key)
+{
+    u32 u32Low = 0, u32High = u32Num, u32Mid;
+
+    while (u32Low < u32High)
+    {
+        u32Mid = (u32Low + u32High) / 2;
+        if (pu64Key[u32Mid] <= u64Key)
+            u32Low = u32Mid + 1;
+        else
+            u32High = u32Mid;
+    }
+
+    return u32Low;
+}
+
+/** Find the leaf which may have the key, the tree must not be empty.
+ *
+ *  @param pib [in] The B+tree.
+ *  @param u64Key [in] The key.
+ *  @param pbp [out] The path from root to leaf, it can be NULL.
+ *
+ *  @return The leaf.
+ */
+static btree_leaf_t * _findLeaf(internal_btree_t * pib, u64 u64Key, btree_path_t * pbp)
+{
+    btree_node_t * pbn = pib->ib_pbnRoot;
+    btree_inner_t * pbi = NULL;
+    u32 u32Index, u32Depth = 0;
+
+    while (! pbn->bn_bLeaf)
+    {
+        pbi = (btree_inner_t *)pbn;
+        u32Index = _upperBoundInNode(pbi->bi_u64Key, pbn->bn_u16NumOfKey, u64Key);
+
+        if (pbp != NULL)
+        {
+            pbp->bp_pbiNode[u32Depth] = pbi;
+            pbp->bp_u32Index[u32Depth] = u32Index;
+        }
+        u32Depth ++;
+
+        pbn = pbi->bi_pbnChild[u32Index];
+    }
+
+    if (pbp != NULL)
+        pbp->bp_u32Depth = u32Depth;
+
+    return (btree_leaf_t *)pbn;
+}
+
+static void _freeSpareNodes(internal_btree_t * pib, btree_spare_t * pbs)
+{
+    if (pbs->bs_pblLeaf != NULL)
+        jf_jiukun_freeObject(pib->ib_pjjcLeaf, (void **)&pbs->bs_pblLeaf);
+
+    while (pbs->bs_u32NumOfInner > 0)
+    {
+        pbs->bs_u32NumOfInner --;
+        jf_jiukun_freeObject(
+            pib->ib_pjjcInner, (void **)&pbs->bs_pbiInner[pbs->bs_u32NumOfInner]);
+    }
+}
+
+/** Allocate the nodes required by the insertion. The full leaf is split, the full inner nodes
+ *  from the parent of the leaf are split, a new root is required if all of them are full.
+ */
+static u32 _allocSpareNodes(
+    internal_btree_t * pib, btree_leaf_t * pbl, btree_path_t * pbp, btree_spare_t * pbs)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Depth = pbp->bp_u32Depth, u32Need = 0;
+
+    ol_bzero(pbs, sizeof(*pbs));
+
+    if ((pbl != NULL) && (pbl->bl_bnNode.bn_u16NumOfKey < BTREE_MAX_KEY))
+        return u32Ret;
+
+    /*The leaf is NULL for empty tree, a leaf is required as root.*/
+    u32Ret = jf_jiukun_allocObject(pib->ib_pjjcLeaf, (void **)&pbs->bs_pblLeaf);
+
+    if ((u32Ret == JF_ERR_NO_ERROR) && (pbl != NULL))
+    {
+        u32Need = 1;
+        while ((u32Depth > 0) &&
+               (pbp->bp_pbiNode[u32Depth - 1]->bi_bnNode.bn_u16NumOfKey == BTREE_MAX_KEY))
+        {
+            u32Need ++;
+            u32Depth --;
+        }
+        /*The inner node which is not full takes the separator, otherwise the root is split.*/
+        if (u32Depth > 0)
+            u32Need --;
+        else if (pib->ib_u32Height == BTREE_MAX_HEIGHT)
+            u32Ret = JF_ERR_REACH_MAX_RESOURCES;
+    }
+
+    while ((u32Ret == JF_ERR_NO_ERROR) && (pbs->bs_u32NumOfInner < u32Need))
+    {
+        u32Ret = jf_jiukun_allocObject(
+            pib->ib_pjjcInner, (void **)&pbs->bs_pbiInner[pbs->bs_u32NumOfInner]);
+        if (u32Ret == JF_ERR_NO_ERROR)
+            pbs->bs_u32NumOfInner ++;
+    }
+
+    if (u32Ret != JF_ERR_NO_ERROR)
+        _freeSpareNodes(pib, pbs);
+
+    return u32Ret;
+}
+
+static btree_inner_t * _getSpareInner(btree_spare_t * pbs)
+{
+    btree_inner_t * pbi = NULL;
+
+    assert(pbs->bs_u32NumOfInner > 0);
+
+    pbs->bs_u32NumOfInner --;
+    pbi = pbs->bs_pbiInner[pbs->bs_u32NumOfInner];
+    pbs->bs_pbiInner[pbs->bs_u32NumOfInner] = NULL;
+    pbi->bi_bnNode.bn_u16NumOfKey = 0;
+    pbi->bi_bnNode.bn_bLeaf = FALSE;
+
+    return pbi;
+}
+
+static btree_leaf_t * _getSpareLeaf(btree_spare_t * pbs)
+{
+    btree_leaf_t * pbl = pbs->bs_pblLeaf;
+
+    assert(pbl != NULL);
+
+    pbs->bs_pblLeaf = NULL;
+    pbl->bl_bnNode.bn_u16NumOfKey = 0;
+    pbl->bl_bnNode.bn_bLeaf = TRUE;
+    pbl->bl_pblPrev = pbl->bl_pblNext = NULL;
+
+    return pbl;
+}
+
+/** Insert the separator and the right node to the parent of the left node, the parent is split if
+ *  it's full.
+ */
+static void _insertIntoParent(
+    internal_btree_t * pib, btree_path_t * pbp, btree_spare_t * pbs, btree_node_t * pbnLeft,
+    u64 u64Sep, btree_node_t * pbnRight)
+{
+    btree_inner_t * pbi = NULL, * pbiNew = NULL;
+    u32 u32Index, u32Num, u32Mid;
+    u64 u64Key[BTREE_MAX_KEY + 1];
+    btree_node_t * pbnChild[BTREE_MAX_KEY + 2];
+
+    while (pbp->bp_u32Depth > 0)
+    {
+        pbp->bp_u32Depth --;
+        pbi = pbp->bp_pbiNode[pbp->bp_u32Depth];
+        u32Index = pbp->bp_u32Index[pbp->bp_u32Depth];
+        u32Num = pbi->bi_bnNode.bn_u16NumOfKey;
+
+        if (u32Num < BTREE_MAX_KEY)
+        {
+            ol_memmove(
+                &pbi->bi_u64Key[u32Index + 1], &pbi->bi_u64Key[u32Index],
+                (u32Num - u32Index) * sizeof(u64));
+            ol_memmove(
+                &pbi->bi_pbnChild[u32Index + 2], &pbi->bi_pbnChild[u32Index + 1],
+                (u32Num - u32Index) * sizeof(btree_node_t *));
+            pbi->bi_u64Key[u32Index] = u64Sep;
+            pbi->bi_pbnChild[u32Index + 1] = pbnRight;
+            pbi->bi_bnNode.bn_u16NumOfKey ++;
+            return;
+        }
+
+        /*Split the full node, the middle key goes up.*/
+        ol_memcpy(u64Key, pbi->bi_u64Key, u32Index * sizeof(u64));
+        u64Key[u32Index] = u64Sep;
+        ol_memcpy(
+            &u64Key[u32Index + 1], &pbi->bi_u64Key[u32Index], (u32Num - u32Index) * sizeof(u64));
+        ol_memcpy(pbnChild, pbi->bi_pbnChild, (u32Index + 1) * sizeof(btree_node_t *));
+        pbnChild[u32Index + 1] = pbnRight;
+        ol_memcpy(
+            &pbnChild[u32Index + 2], &pbi->bi_pbnChild[u32Index + 1],
+            (u32Num - u32Index) * sizeof(btree_node_t *));
+
+        u32Mid = (BTREE_MAX_KEY + 1) / 2;
+        pbiNew = _getSpareInner(pbs);
+
+        ol_memcpy(pbi->bi_u64Key, u64Key, u32Mid * sizeof(u64));
+        ol_memcpy(pbi->bi_pbnChild, pbnChild, (u32Mid + 1) * sizeof(btree_node_t *));
+        pbi->bi_bnNode.bn_u16NumOfKey = (u16)u32Mid;
+
+        ol_memcpy(pbiNew->bi_u64Key, &u64Key[u32Mid + 1], (BTREE_MAX_KEY - u32Mid) * sizeof(u64));
+        ol_memcpy(
+            pbiNew->bi_pbnChild, &pbnChild[u32Mid + 1],
+            (BTREE_MAX_KEY - u32Mid + 1) * sizeof(btree_node_t *));
+        pbiNew->bi_bnNode.bn_u16NumOfKey = (u16)(BTREE_MAX_KEY - u32Mid);
+
+        pbnLeft = (btree_node_t *)pbi;
+        u64Sep = u64Key[u32Mid];
+        pbnRight = (btree_node_t *)pbiNew;
+    }
+
+    /*The root is split, the tree grows one level.*/
+    pbiNew = _getSpareInner(pbs);
+    pbiNew->bi_u64Key[0] = u64Sep;
+    pbiNew->bi_pbnChild[0] = pbnLeft;
+    pbiNew->bi_pbnChild[1] = pbnRight;
+    pbiNew->bi_bnNode.bn_u16NumOfKey = 1;
+
+    pib->ib_pbnRoot = (btree_node_t *)pbiNew;
+    pib->ib_u32Height ++;
+}
+
+/** Insert the key to the full leaf, the leaf is split and the new leaf is after it.
+ */
+static void _splitLeaf(
+    internal_btree_t * pib, btree_path_t * pbp, btree_spare_t * pbs, btree_leaf_t * pbl,
+    u32 u32Pos, u64 u64Key, void * pValue)
+{
+    btree_leaf_t * pblNew = _getSpareLeaf(pbs);
+    u64 u64Keys[BTREE_MAX_KEY + 1];
+    void * pValues[BTREE_MAX_KEY + 1];
+    u32 u32Left = (BTREE_MAX_KEY + 1) / 2;
+
+    ol_memcpy(u64Keys, pbl->bl_u64Key, u32Pos * sizeof(u64));
+    ol_memcpy(pValues, pbl->bl_pValue, u32Pos * sizeof(void *));
+    u64Keys[u32Pos] = u64Key;
+    pValues[u32Pos] = pValue;
+    ol_memcpy(
+        &u64Keys[u32Pos + 1], &pbl->bl_u64Key[u32Pos], (BTREE_MAX_KEY - u32Pos) * sizeof(u64));
+    ol_memcpy(
+        &pValues[u32Pos + 1], &pbl->bl_pValue[u32Pos], (BTREE_MAX_KEY - u32Pos) * sizeof(void *));
+
+    ol_memcpy(pbl->bl_u64Key, u64Keys, u32Left * sizeof(u64));
+    ol_memcpy(pbl->bl_pValue, pValues, u32Left * sizeof(void *));
+    pbl->bl_bnNode.bn_u16NumOfKey = (u16)u32Left;
+
+    ol_memcpy(pblNew->bl_u64Key, &u64Keys[u32Left], (BTREE_MAX_KEY + 1 - u32Left) * sizeof(u64));
+    ol_memcpy(
+        pblNew->bl_pValue, &pValues[u32Left], (BTREE_MAX_KEY + 1 - u32Left) * sizeof(void *));
+    pblNew->bl_bnNode.bn_u16NumOfKey = (u16)(BTREE_MAX_KEY + 1 - u32Left);
+
+    pblNew->bl_pblPrev = pbl;
+    pblNew->bl_pblNext = pbl->bl_pblNext;
+    if (pbl->bl_pblNext != NULL)
+        pbl->bl_pblNext->bl_pblPrev = pblNew;
+    pbl->bl_pblNext = pblNew;
+
+    _insertIntoParent(
+        pib, pbp, pbs, (btree_node_t *)pbl, pblNew->bl_u64Key[0], (btree_node_t *)pblNew);
+}
+
+static u32 _insertBtree(internal_btree_t * pib, u64 u64Key, void * pValue)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    btree_leaf_t * pbl = NULL;
+    btree_path_t bp;
+    btree_spare_t bs;
+    u32 u32Pos = 0, u32Num;
+
+    bp.bp_u32Depth = 0;
+
+    if (pib->ib_pbnRoot != NULL)
+    {
+        pbl = _findLeaf(pib, u64Key, &bp);
+        u32Num = pbl->bl_bnNode.bn_u16NumOfKey;
+        u32Pos = _lowerBoundInNode(pbl->bl_u64Key, u32Num, u64Key);
+        if ((u32Pos < u32Num) && (pbl->bl_u64Key[u32Pos] == u64Key))
+            u32Ret = JF_ERR_ALREADY_EXIST;
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = _allocSpareNodes(pib, pbl, &bp, &bs);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        if (pbl == NULL)
+        {
+            pbl = _getSpareLeaf(&bs);
+            pbl->bl_u64Key[0] = u64Key;
+            pbl->bl_pValue[0] = pValue;
+            pbl->bl_bnNode.bn_u16NumOfKey = 1;
+            pib->ib_pbnRoot = (btree_node_t *)pbl;
+            pib->ib_u32Height = 1;
+        }
+        else if (pbl->bl_bnNode.bn_u16NumOfKey < BTREE_MAX_KEY)
+        {
+            u32Num = pbl->bl_bnNode.bn_u16NumOfKey;
+            ol_memmove(
+                &pbl->bl_u64Key[u32Pos + 1], &pbl->bl_u64Key[u32Pos],
+                (u32Num - u32Pos) * sizeof(u64));
+            ol_memmove(
+                &pbl->bl_pValue[u32Pos + 1], &pbl->bl_pValue[u32Pos],
+                (u32Num - u32Pos) * sizeof(void *));
+            pbl->bl_u64Key[u32Pos] = u64Key;
+            pbl->bl_pValue[u32Pos] = pValue;
+            pbl->bl_bnNode.bn_u16NumOfKey ++;
+        }
+        else
+        {
+            _splitLeaf(pib, &bp, &bs, pbl, u32Pos, u64Key, pValue);
+        }
+
+        pib->ib_u32NumOfKey ++;
+
+        assert((bs.bs_pblLeaf == NULL) && (bs.bs_u32NumOfInner == 0));
+    }
+
+    return u32Ret;
+}
+
+/** Remove the key and the child after it from inner node.
+ */
+static void _removeFromInner(btree_inner_t * pbi, u32 u32KeyIndex)
+{
+    u32 u32Num = pbi->bi_bnNode.bn_u16NumOfKey;
+
+    ol_memmove(
+        &pbi->bi_u64Key[u32KeyIndex], &pbi->bi_u64Key[u32KeyIndex + 1],
+        (u32Num - u32KeyIndex - 1) * sizeof(u64));
+    ol_memmove(
+        &pbi->bi_pbnChild[u32KeyIndex + 1], &pbi->bi_pbnChild[u32KeyIndex + 2],
+        (u32Num - u32KeyIndex - 1) * sizeof(btree_node_t *));
+    pbi->bi_bnNode.bn_u16NumOfKey --;
+}
+
+/** Move all keys of the right leaf to the left leaf, the right leaf is freed.
+ */
+static void _mergeLeaf(internal_btree_t * pib, btree_leaf_t * pblLeft, btree_leaf_t * pblRight)
+{
+    u32 u32Num = pblLeft->bl_bnNode.bn_u16NumOfKey, u32Right = pblRight->bl_bnNode.bn_u16NumOfKey;
+
+    ol_memcpy(&pblLeft->bl_u64Key[u32Num], pblRight->bl_u64Key, u32Right * sizeof(u64));
+    ol_memcpy(&pblLeft->bl_pValue[u32Num], pblRight->bl_pValue, u32Right * sizeof(void *));
+    pblLeft->bl_bnNode.bn_u16NumOfKey = (u16)(u32Num + u32Right);
+
+    pblLeft->bl_pblNext = pblRight->bl_pblNext;
+    if (pblRight->bl_pblNext != NULL)
+        pblRight->bl_pblNext->bl_pblPrev = pblLeft;
+
+    jf_jiukun_freeObject(pib->ib_pjjcLeaf, (void **)&pblRight);
+}
+
+/** Move the separator and all keys of the right node to the left node, the right node is freed.
+ */
+static void _mergeInner(
+    internal_btree_t * pib, btree_inner_t * pbiLeft, u64 u64Sep, btree_inner_t * pbiRight)
+{
+    u32 u32Num = pbiLeft->bi_bnNode.bn_u16NumOfKey, u32Right = pbiRight->bi_bnNode.bn_u16NumOfKey;
+
+    pbiLeft->bi_u64Key[u32Num] = u64Sep;
+    ol_memcpy(&pbiLeft->bi_u64Key[u32Num + 1], pbiRight->bi_u64Key, u32Right * sizeof(u64));
+    ol_memcpy(
+        &pbiLeft->bi_pbnChild[u32Num + 1], pbiRight->bi_pbnChild,
+        (u32Right + 1) * sizeof(btree_node_t *));
+    pbiLeft->bi_bnNode.bn_u16NumOfKey = (u16)(u32Num + 1 + u32Right);
+
+    jf_jiukun_freeObject(pib->ib_pjjcInner, (void **)&pbiRight);
+}
+
+/** Rebalance the inner nodes from the bottom of the path to the root.
+ */
+static void _rebalanceInner(internal_btree_t * pib, btree_path_t * pbp)
+{
+    btree_inner_t * pbi, * pbiParent, * pbiLeft, * pbiRight;
+    u32 u32Depth = pbp->bp_u32Depth, u32Index, u32Num;
+
+    while (u32Depth > 0)
+    {
+        u32Depth --;
+        pbi = pbp->bp_pbiNode[u32Depth];
+        u32Num = pbi->bi_bnNode.bn_u16NumOfKey;
+
+        if (u32Depth == 0)
+        {
+            /*The root has only one child, the tree shrinks one level.*/
+            if (u32Num == 0)
+            {
+                pib->ib_pbnRoot = pbi->bi_pbnChild[0];
+                pib->ib_u32Height --;
+                jf_jiukun_freeObject(pib->ib_pjjcInner, (void **)&pbi);
+            }
+            return;
+        }
+
+        if (u32Num >= BTREE_MIN_KEY)
+            return;
+
+        pbiParent = pbp->bp_pbiNode[u32Depth - 1];
+        u32Index = pbp->bp_u32Index[u32Depth - 1];
+        pbiLeft = (u32Index > 0) ? (btree_inner_t *)pbiParent->bi_pbnChild[u32Index - 1] : NULL;
+        pbiRight = (u32Index < pbiParent->bi_bnNode.bn_u16NumOfKey) ?
+            (btree_inner_t *)pbiParent->bi_pbnChild[u32Index + 1] : NULL;
+
+        if ((pbiLeft != NULL) && (pbiLeft->bi_bnNode.bn_u16NumOfKey > BTREE_MIN_KEY))
+        {
+            /*Rotate the last child of left sibling through the parent.*/
+            ol_memmove(&pbi->bi_u64Key[1], &pbi->bi_u64Key[0], u32Num * sizeof(u64));
+            ol_memmove(
+                &pbi->bi_pbnChild[1], &pbi->bi_pbnChild[0], (u32Num + 1) * sizeof(btree_node_t *));
+            pbi->bi_u64Key[0] = pbiParent->bi_u64Key[u32Index - 1];
+            pbi->bi_pbnChild[0] = pbiLeft->bi_pbnChild[pbiLeft->bi_bnNode.bn_u16NumOfKey];
+            pbi->bi_bnNode.bn_u16NumOfKey ++;
+
+            pbiParent->bi_u64Key[u32Index - 1] =
+                pbiLeft->bi_u64Key[pbiLeft->bi_bnNode.bn_u16NumOfKey - 1];
+            pbiLeft->bi_bnNode.bn_u16NumOfKey --;
+            return;
+        }
+
+        if ((pbiRight != NULL) && (pbiRight->bi_bnNode.bn_u16NumOfKey > BTREE_MIN_KEY))
+        {
+            /*Rotate the first child of right sibling through the parent.*/
+            pbi->bi_u64Key[u32Num] = pbiParent->bi_u64Key[u32Index];
+            pbi->bi_pbnChild[u32Num + 1] = pbiRight->bi_pbnChild[0];
+            pbi->bi_bnNode.bn_u16NumOfKey ++;
+
+            pbiParent->bi_u64Key[u32Index] = pbiRight->bi_u64Key[0];
+            u32Num = pbiRight->bi_bnNode.bn_u16NumOfKey;
+            ol_memmove(
+                &pbiRight->bi_u64Key[0], &pbiRight->bi_u64Key[1], (u32Num - 1) * sizeof(u64));
+            ol_memmove(
+                &pbiRight->bi_pbnChild[0], &pbiRight->bi_pbnChild[1],
+                u32Num * sizeof(btree_node_t *));
+            pbiRight->bi_bnNode.bn_u16NumOfKey --;
+            return;
+        }
+
+        if (pbiLeft != NULL)
+        {
+            _mergeInner(pib, pbiLeft, pbiParent->bi_u64Key[u32Index - 1], pbi);
+            _removeFromInner(pbiParent, u32Index - 1);
+        }
+        else
+        {
+            _mergeInner(pib, pbi, pbiParent->bi_u64Key[u32Index], pbiRight);
+            _removeFromInner(pbiParent, u32Index);
+        }
+    }
+}
+
+/** Rebalance the leaf which is less than half full, the leaf is not the root.
+ */
+static void _rebalanceLeaf(internal_btree_t * pib, btree_path_t * pbp, btree_leaf_t * pbl)
+{
+    btree_inner_t * pbiParent = pbp->bp_pbiNode[pbp->bp_u32Depth - 1];
+    u32 u32Index = pbp->bp_u32Index[pbp->bp_u32Depth - 1];
+    u32 u32Num = pbl->bl_bnNode.bn_u16NumOfKey;
+    btree_leaf_t * pblLeft = NULL, * pblRight = NULL;
+
+    if (u32Index > 0)
+        pblLeft = (btree_leaf_t *)pbiParent->bi_pbnChild[u32Index - 1];
+    if (u32Index < pbiParent->bi_bnNode.bn_u16NumOfKey)
+        pblRight = (btree_leaf_t *)pbiParent->bi_pbnChild[u32Index + 1];
+
+    if ((pblLeft != NULL) && (pblLeft->bl_bnNode.bn_u16NumOfKey > BTREE_MIN_KEY))
+    {
+        /*Borrow the last key of left sibling.*/
+        ol_memmove(&pbl->bl_u64Key[1], &pbl->bl_u64Key[0], u32Num * sizeof(u64));
+        ol_memmove(&pbl->bl_pValue[1], &pbl->bl_pValue[0], u32Num * sizeof(void *));
+        pblLeft->bl_bnNode.bn_u16NumOfKey --;
+        pbl->bl_u64Key[0] = pblLeft->bl_u64Key[pblLeft->bl_bnNode.bn_u16NumOfKey];
+        pbl->bl_pValue[0] = pblLeft->bl_pValue[pblLeft->bl_bnNode.bn_u16NumOfKey];
+        pbl->bl_bnNode.bn_u16NumOfKey ++;
+
+        pbiParent->bi_u64Key[u32Index - 1] = pbl->bl_u64Key[0];
+    }
+    else if ((pblRight != NULL) && (pblRight->bl_bnNode.bn_u16NumOfKey > BTREE_MIN_KEY))
+    {
+        /*Borrow the first key of right sibling.*/
+        pbl->bl_u64Key[u32Num] = pblRight->bl_u64Key[0];
+        pbl->bl_pValue[u32Num] = pblRight->bl_pValue[0];
+        pbl->bl_bnNode.bn_u16NumOfKey ++;
+
+        u32Num = pblRight->bl_bnNode.bn_u16NumOfKey - 1;
+        ol_memmove(&pblRight->bl_u64Key[0], &pblRight->bl_u64Key[1], u32Num * sizeof(u64));
+        ol_memmove(&pblRight->bl_pValue[0], &pblRight->bl_pValue[1], u32Num * sizeof(void *));
+        pblRight->bl_bnNode.bn_u16NumOfKey --;
+
+        pbiParent->bi_u64Key[u32Index] = pblRight->bl_u64Key[0];
+    }
+    else
+    {
+        if (pblLeft != NULL)
+        {
+            _mergeLeaf(pib, pblLeft, pbl);
+            _removeFromInner(pbiParent, u32Index - 1);
+        }
+        else
+        {
+            _mergeLeaf(pib, pbl, pblRight);
+            _removeFromInner(pbiParent, u32Index);
+        }
+
+        _rebalanceInner(pib, pbp);
+    }
+}
+
+static u32 _removeBtree(internal_btree_t * pib, u64 u64Key, void ** ppValue)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    btree_leaf_t * pbl = NULL;
+    btree_path_t bp;
+    u32 u32Pos = 0, u32Num = 0;
+
+    if (pib->ib_pbnRoot == NULL)
+        return JF_ERR_NOT_FOUND;
+
+    pbl = _findLeaf(pib, u64Key, &bp);
+    u32Num = pbl->bl_bnNode.bn_u16NumOfKey;
+    u32Pos = _lowerBoundInNode(pbl->bl_u64Key, u32Num, u64Key);
+    if ((u32Pos == u32Num) || (pbl->bl_u64Key[u32Pos] != u64Key))
+        return JF_ERR_NOT_FOUND;
+
+    if (ppValue != NULL)
+        *ppValue = pbl->bl_pValue[u32Pos];
+
+    ol_memmove(
+        &pbl->bl_u64Key[u32Pos], &pbl->bl_u64Key[u32Pos + 1], (u32Num - u32Pos - 1) * sizeof(u64));
+    ol_memmove(
+        &pbl->bl_pValue[u32Pos], &pbl->bl_pValue[u32Pos + 1],
+        (u32Num - u32Pos - 1) * sizeof(void *));
+    pbl->bl_bnNode.bn_u16NumOfKey --;
+    pib->ib_u32NumOfKey --;
+
+    if (bp.bp_u32Depth == 0)
+    {
+        /*The leaf is the root, the tree is empty if it has no key.*/
+        if (pbl->bl_bnNode.bn_u16NumOfKey == 0)
+        {
+            jf_jiukun_freeObject(pib->ib_pjjcLeaf, (void **)&pbl);
+            pib->ib_pbnRoot = NULL;
+            pib->ib_u32Height = 0;
+        }
+    }
+    else if (pbl->bl_bnNode.bn_u16NumOfKey < BTREE_MIN_KEY)
+    {
+        _rebalanceLeaf(pib, &bp, pbl);
+    }
+
+    return u32Ret;
+}
+
+static void _destroyBtreeNode(internal_btree_t * pib, btree_node_t * pbn)
+{
+    btree_inner_t * pbi = NULL;
+    btree_leaf_t * pbl = NULL;
+    u32 u32Index;
+
+    if (pbn->bn_bLeaf)
+    {
+        pbl = (btree_leaf_t *)pbn;
+        if (pib->ib_fnFreeValue != NULL)
+            for (u32Index = 0; u32Index < pbn->bn_u16NumOfKey; u32Index ++)
+                pib->ib_fnFreeValue(&pbl->bl_pValue[u32Index]);
+
+        jf_jiukun_freeObject(pib->ib_pjjcLeaf, (void **)&pbl);
+    }
+    else
+    {
+        pbi = (btree_inner_t *)pbn;
+        for (u32Index = 0; u32Index <= pbn->bn_u16NumOfKey; u32Index ++)
+            _destroyBtreeNode(pib, pbi->bi_pbnChild[u32Index]);
+
+        jf_jiukun_freeObject(pib->ib_pjjcInner, (void **)&pbi);
+    }
+}
+
+/* --- public routine section ------------------------------------------------------------------- */
+
+u32 jf_btree_create(jf_btree_t ** ppjb, jf_btree_create_param_t * pjbcp)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_btree_t * pib = NULL;
+    jf_jiukun_cache_create_param_t jjccp;
+
+    assert((ppjb != NULL) && (pjbcp != NULL));
+
+    u32Ret = jf_jiukun_allocMemory((void **)&pib, sizeof(internal_btree_t));
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ol_bzero(pib, sizeof(internal_btree_t));
+        pib->ib_fnFreeValue = pjbcp->jbcp_fnFreeValue;
+
+        ol_bzero(&jjccp, sizeof(jjccp));
+        jjccp.jjccp_pstrName = BTREE_LEAF_CACHE;
+        jjccp.jjccp_sObj = sizeof(btree_leaf_t);
+        JF_FLAG_SET(jjccp.jjccp_jfCache, JF_JIUKUN_CACHE_CREATE_FLAG_SHARED);
+        JF_FLAG_SET(jjccp.jjccp_jfCache, JF_JIUKUN_CACHE_CREATE_FLAG_HWCACHE_ALIGN);
+
+        u32Ret = jf_jiukun_createCache(&pib->ib_pjjcLeaf, &jjccp);
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        jjccp.jjccp_pstrName = BTREE_INNER_CACHE;
+        jjccp.jjccp_sObj = sizeof(btree_inner_t);
+
+        u32Ret = jf_jiukun_createCache(&pib->ib_pjjcInner, &jjccp);
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        *ppjb = pib;
+    else if (pib != NULL)
+        jf_btree_destroy((jf_btree_t **)&pib);
+
+    return u32Ret;
+}
+
+u32 jf_btree_destroy(jf_btree_t ** ppjb)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_btree_t * pib = NULL;
+
+    assert((ppjb != NULL) && (*ppjb != NULL));
+
+    pib = (internal_btree_t *) *ppjb;
+
+    if (pib->ib_pbnRoot != NULL)
+        _destroyBtreeNode(pib, pib->ib_pbnRoot);
+
+    if (pib->ib_pjjcInner != NULL)
+        jf_jiukun_destroyCache(&pib->ib_pjjcInner);
+
+    if (pib->ib_pjjcLeaf != NULL)
+        jf_jiukun_destroyCache(&pib->ib_pjjcLeaf);
+
+    jf_jiukun_freeMemory(ppjb);
+
+    return u32Ret;
+}
+
+u32 jf_btree_insert(jf_btree_t * pjb, u64 u64Key, void * pValue)
+{
+    internal_btree_t * pib = (internal_btree_t *)pjb;
+
+    assert(pjb != NULL);
+
+    return _insertBtree(pib, u64Key, pValue);
+}
+
+u32 jf_btree_remove(jf_btree_t * pjb, u64 u64Key, void ** ppValue)
+{
+    internal_btree_t * pib = (internal_btree_t *)pjb;
+
+    assert(pjb != NULL);
+
+    return _removeBtree(pib, u64Key, ppValue);
+}
+
+u32 jf_btree_get(jf_btree_t * pjb, u64 u64Key, void ** ppValue)
+{
+    u32 u32Ret = JF_ERR_NOT_FOUND;
+    internal_btree_t * pib = (internal_btree_t *)pjb;
+    btree_leaf_t * pbl = NULL;
+    u32 u32Pos;
+
+    assert((pjb != NULL) && (ppValue != NULL));
+
+    if (pib->ib_pbnRoot != NULL)
+    {
+        pbl = _findLeaf(pib, u64Key, NULL);
+        u32Pos = _lowerBoundInNode(pbl->bl_u64Key, pbl->bl_bnNode.bn_u16NumOfKey, u64Key);
+        if ((u32Pos < pbl->bl_bnNode.bn_u16NumOfKey) && (pbl->bl_u64Key[u32Pos] == u64Key))
+        {
+            *ppValue = pbl->bl_pValue[u32Pos];
+            u32Ret = JF_ERR_NO_ERROR;
+        }
+    }
+
+    return u32Ret;
+}
+
+u32 jf_btree_lowerBound(jf_btree_t * pjb, u64 u64Key, jf_btree_iterator_t * pjbi)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_btree_t * pib = (internal_btree_t *)pjb;
+    btree_leaf_t * pbl = NULL;
+    u32 u32Pos = 0;
+
+    assert((pjb != NULL) && (pjbi != NULL));
+
+    if (pib->ib_pbnRoot != NULL)
+    {
+        pbl = _findLeaf(pib, u64Key, NULL);
+        u32Pos = _lowerBoundInNode(pbl->bl_u64Key, pbl->bl_bnNode.bn_u16NumOfKey, u64Key);
+        /*The key may be in the next leaf as the separator is not updated after removal.*/
+        if (u32Pos == pbl->bl_bnNode.bn_u16NumOfKey)
+        {
+            pbl = pbl->bl_pblNext;
+            u32Pos = 0;
+        }
+    }
+
+    pjbi->jbi_pLeaf = pbl;
+    pjbi->jbi_u32Index = u32Pos;
+
+    if (pbl == NULL)
+        u32Ret = JF_ERR_NOT_FOUND;
+
+    return u32Ret;
+}
+
+u32 jf_btree_getFirst(jf_btree_t * pjb, jf_btree_iterator_t * pjbi)
+{
+    return jf_btree_lowerBound(pjb, 0, pjbi);
+}
+
+u32 jf_btree_getNext(jf_btree_iterator_t * pjbi)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    btree_leaf_t * pbl = pjbi->jbi_pLeaf;
+
+    assert(pbl != NULL);
+
+    pjbi->jbi_u32Index ++;
+    if (pjbi->jbi_u32Index == pbl->bl_bnNode.bn_u16NumOfKey)
+    {
+        pjbi->jbi_pLeaf = pbl->bl_pblNext;
+        pjbi->jbi_u32Index = 0;
+        if (pjbi->jbi_pLeaf == NULL)
+            u32Ret = JF_ERR_NOT_FOUND;
+    }
+
+    return u32Ret;
+}
+
+u64 jf_btree_getIteratorKey(jf_btree_iterator_t * pjbi)
+{
+    btree_leaf_t * pbl = pjbi->jbi_pLeaf;
+
+    return pbl->bl_u64Key[pjbi->jbi_u32Index];
+}
+
+void * jf_btree_getIteratorValue(jf_btree_iterator_t * pjbi)
+{
+    btree_leaf_t * pbl = pjbi->jbi_pLeaf;
+
+    return pbl->bl_pValue[pjbi->jbi_u32Index];
+}
+
+u32 jf_btree_iterateRange(
+    jf_btree_t * pjb, u64 u64From, u64 u64To, jf_btree_fnOpEntry_t fnOpEntry, void * pArg)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_btree_iterator_t jbi;
+    btree_leaf_t * pbl = NULL;
+    u32 u32Index;
+
+    assert((pjb != NULL) && (fnOpEntry != NULL));
+
+    if (jf_btree_lowerBound(pjb, u64From, &jbi) != JF_ERR_NO_ERROR)
+        return u32Ret;
+
+    /*Walk the leaves directly, the iterator is not required in the loop.*/
+    pbl = jbi.jbi_pLeaf;
+    u32Index = jbi.jbi_u32Index;
+    while ((pbl != NULL) && (u32Ret == JF_ERR_NO_ERROR))
+    {
+        for (; (u32Index < pbl->bl_bnNode.bn_u16NumOfKey) && (u32Ret == JF_ERR_NO_ERROR);
+             u32Index ++)
+        {
+            if (pbl->bl_u64Key[u32Index] > u64To)
+                return u32Ret;
+
+            u32Ret = fnOpEntry(pbl->bl_u64Key[u32Index], pbl->bl_pValue[u32Index], pArg);
+        }
+
+        pbl = pbl->bl_pblNext;
+        u32Index = 0;
+    }
+
+    return u32Ret;
+}
+
+u32 jf_btree_getSize(jf_btree_t * pjb)
+{
+    internal_btree_t * pib = (internal_btree_t *)pjb;
+
+    return pib->ib_u32NumOfKey;
+}
+
+u32 jf_btree_getHeight(jf_btree_t * pjb)
+{
+    internal_btree_t * pib = (internal_btree_t *)pjb;
+
+    return pib->ib_u32Height;
+}
+
+/*------------------------------------------------------------------------------------------------*/
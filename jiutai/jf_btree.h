@@ -0,0 +1,211 @@
+/**
+ *  @file jf_btree.h
+ *
+ *  @brief Header file for B+tree common object.
+ *
+ *  @author Min Zhang
+ *
+ *  @note
+ *  -# Routines declared in this file are included in jf_btree object.
+ *  -# Link with jf_jiukun library for memory allocation.
+ *  -# This object is not thread safe.
+ *  -# The key is u64 and it's unique in the tree. The keys are stored inline in wide nodes, a node
+ *   is a few cache lines and the search in node doesn't follow pointers.
+ *  -# The leaves are linked in key order, the range is iterated without going back to the root.
+ *  -# The nodes are allocated from jiukun caches shared by all B+trees.
+ */
+
+/*------------------------------------------------------------------------------------------------*/
+#ifndef JIUTAI_BTREE_H
+#define JIUTAI_BTREE_H
+
+/* --- standard C lib header files -------------------------------------------------------------- */
+
+/* --- internal header files -------------------------------------------------------------------- */
+#include "jf_basic.h"
+#include "jf_err.h"
+
+/* --- constant definitions --------------------------------------------------------------------- */
+
+/** Define the B+tree data type.
+ */
+typedef void  jf_btree_t;
+
+/* --- data structures -------------------------------------------------------------------------- */
+
+/** The callback function to free the value when the B+tree is destroyed.
+ */
+typedef u32 (* jf_btree_fnFreeValue_t)(void ** ppValue);
+
+/** The callback function to operate on the key and value when iterating the B+tree.
+ *
+ *  @note
+ *  -# The iteration will stop if the return code is not JF_ERR_NO_ERROR.
+ *  -# The B+tree cannot be changed in the callback function.
+ */
+typedef u32 (* jf_btree_fnOpEntry_t)(u64 u64Key, void * pValue, void * pArg);
+
+/** Define the parameter data type for creating B+tree.
+ */
+typedef struct
+{
+    /**Callback function to free the value, it's optional.*/
+    jf_btree_fnFreeValue_t jbcp_fnFreeValue;
+    u32 jbcp_u32Reserved[4];
+} jf_btree_create_param_t;
+
+/** Define the iterator data type of B+tree.
+ *
+ *  @note
+ *  -# The iterator is invalid after the B+tree is changed.
+ */
+typedef struct
+{
+    /**The leaf node.*/
+    void * jbi_pLeaf;
+    /**The position in leaf node.*/
+    u32 jbi_u32Index;
+    u32 jbi_u32Reserved;
+} jf_btree_iterator_t;
+
+/* --- functional routines ---------------------------------------------------------------------- */
+
+/** Create the B+tree.
+ *
+ *  @param ppjb [out] The B+tree to be created and returned.
+ *  @param pjbcp [in] The parameter for creating the B+tree.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ *  @retval JF_ERR_OUT_OF_MEMORY Out of memory.
+ */
+u32 jf_btree_create(jf_btree_t ** ppjb, jf_btree_create_param_t * pjbcp);
+
+/** Destroy the B+tree, the values are freed if the callback function is specified.
+ *
+ *  @param ppjb [in/out] The B+tree to be destroyed.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ */
+u32 jf_btree_destroy(jf_btree_t ** ppjb);
+
+/** Insert the key and value to the B+tree.
+ *
+ *  @param pjb [in] The B+tree.
+ *  @param u64Key [in] The key.
+ *  @param pValue [in] The value.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ *  @retval JF_ERR_ALREADY_EXIST The key is in the B+tree.
+ *  @retval JF_ERR_OUT_OF_MEMORY Out of memory.
+ */
+u32 jf_btree_insert(jf_btree_t * pjb, u64 u64Key, void * pValue);
+
+/** Remove the key from the B+tree, the value is returned and not freed.
+ *
+ *  @param pjb [in] The B+tree.
+ *  @param u64Key [in] The key.
+ *  @param ppValue [out] The value of the key, it can be NULL.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ *  @retval JF_ERR_NOT_FOUND The key is not found.
+ */
+u32 jf_btree_remove(jf_btree_t * pjb, u64 u64Key, void ** ppValue);
+
+/** Get the value of the key.
+ *
+ *  @param pjb [in] The B+tree.
+ *  @param u64Key [in] The key.
+ *  @param ppValue [out] The value of the key.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ *  @retval JF_ERR_NOT_FOUND The key is not found.
+ */
+u32 jf_btree_get(jf_btree_t * pjb, u64 u64Key, void ** ppValue);
+
+/** Find the first key which is not less than the specified key.
+ *
+ *  @param pjb [in] The B+tree.
+ *  @param u64Key [in] The key.
+ *  @param pjbi [out] The iterator pointing to the key found.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ *  @retval JF_ERR_NOT_FOUND All keys are less than the specified key.
+ */
+u32 jf_btree_lowerBound(jf_btree_t * pjb, u64 u64Key, jf_btree_iterator_t * pjbi);
+
+/** Get the smallest key.
+ *
+ *  @param pjb [in] The B+tree.
+ *  @param pjbi [out] The iterator pointing to the smallest key.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ *  @retval JF_ERR_NOT_FOUND The B+tree is empty.
+ */
+u32 jf_btree_getFirst(jf_btree_t * pjb, jf_btree_iterator_t * pjbi);
+
+/** Move the iterator to the next key.
+ *
+ *  @param pjbi [in/out] The iterator.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ *  @retval JF_ERR_NOT_FOUND The iterator is at the largest key.
+ */
+u32 jf_btree_getNext(jf_btree_iterator_t * pjbi);
+
+/** Get the key the iterator points to.
+ *
+ *  @param pjbi [in] The iterator.
+ *
+ *  @return The key.
+ */
+u64 jf_btree_getIteratorKey(jf_btree_iterator_t * pjbi);
+
+/** Get the value the iterator points to.
+ *
+ *  @param pjbi [in] The iterator.
+ *
+ *  @return The value.
+ */
+void * jf_btree_getIteratorValue(jf_btree_iterator_t * pjbi);
+
+/** Iterate the keys in range [u64From, u64To] in key order.
+ *
+ *  @param pjb [in] The B+tree.
+ *  @param u64From [in] The smallest key in range.
+ *  @param u64To [in] The largest key in range.
+ *  @param fnOpEntry [in] The callback function to operate on the key and value.
+ *  @param pArg [in] The argument for the callback function.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ */
+u32 jf_btree_iterateRange(
+    jf_btree_t * pjb, u64 u64From, u64 u64To, jf_btree_fnOpEntry_t fnOpEntry, void * pArg);
+
+/** Get number of keys in the B+tree.
+ *
+ *  @param pjb [in] The B+tree.
+ *
+ *  @return Number of keys.
+ */
+u32 jf_btree_getSize(jf_btree_t * pjb);
+
+/** Get the height of the B+tree, the tree with only one leaf has height 1.
+ *
+ *  @param pjb [in] The B+tree.
+ *
+ *  @return The height.
+ */
+u32 jf_btree_getHeight(jf_btree_t * pjb);
+
+#endif /*JIUTAI_BTREE_H*/
+
+/*------------------------------------------------------------------------------------------------*/
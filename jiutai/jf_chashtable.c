@@ -0,0 +1,861 @@
+/**
+ *  @file jf_chashtable.c
+ *
+ *  @brief Concurrent hash table implementation file.
+ *
+ *  @author Min Zhang
+ *
+ *  @note
+ *  -# The bucket is a singly linked list of immutable nodes, writer publishes a node with release
+ *   store and reader traverses the list with acquire load.
+ *  -# The stripe of bucket is the low bits of hash, the bucket array is never smaller than the
+ *   stripes, so the bucket and the buckets it's moved to are protected by the same stripe lock.
+ *  -# The retired objects are freed after 2 grace periods. A grace period flips the reader phase
+ *   and ends when the readers of the old phase are drained. The reclaiming never waits, it's
+ *   checked by writers, so the writer can be called in read section.
+ */
+
+/* --- standard C lib header files -------------------------------------------------------------- */
+#include <string.h>
+#if defined(LINUX)
+    #include <pthread.h>
+#endif
+
+/* --- internal header files -------------------------------------------------------------------- */
+#include "jf_basic.h"
+#include "jf_limit.h"
+#include "jf_err.h"
+#include "jf_chashtable.h"
+#include "jf_mutex.h"
+#include "jf_atomic.h"
+#include "jf_jiukun.h"
+
+/* --- private data/data structure section ------------------------------------------------------ */
+
+/** The cache of node shared by all concurrent hash tables.
+ */
+#define CHASHTABLE_NODE_CACHE                  "chashtable_node"
+
+/** Number of reader slots, the reader uses the slot hashed from thread id.
+ */
+#define CHASHTABLE_NUM_OF_READER_SLOT          (32)
+
+/** Minimum number of buckets.
+ */
+#define CHASHTABLE_MIN_SIZE                    (16)
+
+/** The table grows when number of entry is more than 3/4 of buckets.
+ */
+#define CHASHTABLE_MAX_LOAD(size)              ((size) - (size) / 4)
+
+/** Number of buckets moved by writer after each write operation during resize.
+ */
+#define CHASHTABLE_MIGRATE_BATCH               (8)
+
+/** Reclaim is tried when number of retired objects reaches the threshold.
+ */
+#define CHASHTABLE_RECLAIM_THRESHOLD           (64)
+
+/** Retired object type.
+ */
+enum chashtable_retire_type
+{
+    /**The node is freed, the entry is moved to another node.*/
+    CHASHTABLE_RETIRE_NODE = 0,
+    /**The node and the entry are freed.*/
+    CHASHTABLE_RETIRE_NODE_ENTRY,
+    /**The bucket array.*/
+    CHASHTABLE_RETIRE_BUCKET,
+};
+
+/** Header of retired object, it's not touched by readers.
+ */
+typedef struct chashtable_retire
+{
+    struct chashtable_retire * cr_pcrNext;
+    u8 cr_u8Type;
+    u8 cr_u8Reserved[7];
+} chashtable_retire_t;
+
+typedef struct chashtable_node
+{
+    chashtable_retire_t cn_crRetire;
+    struct chashtable_node * volatile cn_pcnNext;
+    u32 cn_u32Hash;
+    u32 cn_u32Reserved;
+    void * cn_pKey;
+    void * cn_pEntry;
+} chashtable_node_t;
+
+typedef struct chashtable_bucket
+{
+    chashtable_retire_t cb_crRetire;
+    u32 cb_u32Size;
+    u32 cb_u32Mask;
+    /**The bucket array the buckets are moving to.*/
+    struct chashtable_bucket * volatile cb_pcbNext;
+    /**The next bucket to be moved by writers.*/
+    volatile u32 cb_u32MigrateCursor;
+    /**Number of buckets moved.*/
+    volatile u32 cb_u32Moved;
+    chashtable_node_t * volatile cb_pcnBucket[];
+} chashtable_bucket_t;
+
+/** The reader counters of a slot, one counter for each phase.
+ */
+typedef struct chashtable_reader
+{
+    volatile u32 cr_u32Count[2];
+    u8 cr_u8Pad[JF_JIUKUN_CACHE_LINE_SIZE - 2 * sizeof(u32)];
+} chashtable_reader_t;
+
+typedef struct
+{
+    chashtable_reader_t ic_crReader[CHASHTABLE_NUM_OF_READER_SLOT];
+
+    /**The current bucket array.*/
+    chashtable_bucket_t * volatile ic_pcbBucket;
+    /**The reader phase, the low bit is the index of reader counter.*/
+    volatile u32 ic_u32Phase;
+    volatile u32 ic_u32NumOfEntry;
+    u32 ic_u32StripeMask;
+    u32 ic_u32Resizes;
+    u8 ic_u8KeyType;
+    u8 ic_u8Reserved[7];
+
+    /**Stripe locks, the stride is cache line.*/
+    u8 * ic_pu8Stripe;
+    u32 ic_u32StripeStride;
+    /**Number of stripe locks initialized.*/
+    u32 ic_u32NumOfStripe;
+
+    /**Lock for starting resize.*/
+    jf_mutex_t ic_jmResize;
+
+    /*start of retire lock protected section*/
+    jf_mutex_t ic_jmRetire;
+    /**Objects retired and not in grace period.*/
+    chashtable_retire_t * ic_pcrRetired;
+    volatile u32 ic_u32NumOfRetired;
+    /*end of retire lock protected section*/
+
+    /*start of reclaim lock protected section*/
+    jf_mutex_t ic_jmReclaim;
+    /**Objects in grace period.*/
+    chashtable_retire_t * ic_pcrGrace;
+    /**0: idle, 1: in the first grace period, 2: in the second grace period.*/
+    volatile u32 ic_u32GraceState;
+    /**The phase index whose readers are waited.*/
+    u32 ic_u32GraceIndex;
+    u32 ic_u32NumOfGrace;
+    u64 ic_u64GracePeriod;
+    /*end of reclaim lock protected section*/
+
+    jf_hashtable_fnCmpKeys_t ic_fnCmpKeys;
+    jf_hashtable_fnHashKey_t ic_fnHashKey;
+    jf_hashtable_fnGetKeyFromEntry_t ic_fnGetKeyFromEntry;
+    jf_hashtable_fnFreeEntry_t ic_fnFreeEntry;
+
+    jf_jiukun_cache_t * ic_pjjcNode;
+} internal_chashtable_t;
+
+/** The bucket moved to the new bucket array.
+ */
+static chashtable_node_t ls_cnMoved;
+
+#define CHASHTABLE_MOVED                       (&ls_cnMoved)
+
+/* --- private routine section ------------------------------------------------------------------ */
+
+static inline u32 _getReaderSlot(void)
+{
+#if defined(LINUX)
+    return (u32)jf_hashtable_hashPtr((void *)pthread_self(), 16) % CHASHTABLE_NUM_OF_READER_SLOT;
+#elif defined(WINDOWS)
+    return jf_hashtable_hashU32(GetCurrentThreadId(), 16) % CHASHTABLE_NUM_OF_READER_SLOT;
+#endif
+}
+
+static inline u32 _hashKey(internal_chashtable_t * pic, void * pKey)
+{
+    u32 u32Hash = 0;
+
+    switch (pic->ic_u8KeyType)
+    {
+    case JF_HASHTABLE_KEY_TYPE_U32:
+        u32Hash = jf_hashtable_hashU32((u32)(ulong)pKey, 32);
+        break;
+    case JF_HASHTABLE_KEY_TYPE_U64:
+    case JF_HASHTABLE_KEY_TYPE_POINTER:
+        u32Hash = (u32)jf_hashtable_hashU64((u64)(ulong)pKey, 32);
+        break;
+    case JF_HASHTABLE_KEY_TYPE_STRING:
+        u32Hash = (u32)jf_hashtable_hashPJW(pKey);
+        break;
+    default:
+        u32Hash = (u32)pic->ic_fnHashKey(pKey);
+        break;
+    }
+
+    return u32Hash;
+}
+
+static inline boolean_t _isKeyEqual(internal_chashtable_t * pic, void * pKey1, void * pKey2)
+{
+    if (pKey1 == pKey2)
+        return TRUE;
+    else if (pic->ic_u8KeyType == JF_HASHTABLE_KEY_TYPE_STRING)
+        return (ol_strcmp(pKey1, pKey2) == 0);
+    else if (pic->ic_u8KeyType == JF_HASHTABLE_KEY_TYPE_CALLBACK)
+        return (pic->ic_fnCmpKeys(pKey1, pKey2) == 0);
+
+    return FALSE;
+}
+
+static inline chashtable_node_t * _loadNode(chashtable_node_t * volatile * ppcn)
+{
+    return jf_atomic_loadPointer((void * volatile *)ppcn);
+}
+
+static inline void _storeNode(chashtable_node_t * volatile * ppcn, chashtable_node_t * pcn)
+{
+    jf_atomic_storePointer((void * volatile *)ppcn, pcn);
+}
+
+static inline chashtable_bucket_t * _loadBucket(chashtable_bucket_t * volatile * ppcb)
+{
+    return jf_atomic_loadPointer((void * volatile *)ppcb);
+}
+
+static inline jf_mutex_t * _getStripeLock(internal_chashtable_t * pic, u32 u32Hash)
+{
+    return (jf_mutex_t *)(pic->ic_pu8Stripe +
+                          (u32Hash & pic->ic_u32StripeMask) * pic->ic_u32StripeStride);
+}
+
+static u32 _createBucket(chashtable_bucket_t ** ppcb, u32 u32Size)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    olsize_t size = sizeof(chashtable_bucket_t) + u32Size * sizeof(chashtable_node_t *);
+    chashtable_bucket_t * pcb = NULL;
+
+    u32Ret = jf_jiukun_allocMemory((void **)&pcb, size);
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ol_bzero(pcb, size);
+        pcb->cb_crRetire.cr_u8Type = CHASHTABLE_RETIRE_BUCKET;
+        pcb->cb_u32Size = u32Size;
+        pcb->cb_u32Mask = u32Size - 1;
+
+        *ppcb = pcb;
+    }
+
+    return u32Ret;
+}
+
+static void _freeNodeList(internal_chashtable_t * pic, chashtable_node_t * pcn, boolean_t bEntry)
+{
+    chashtable_node_t * pNext;
+
+    while (pcn != NULL)
+    {
+        pNext = pcn->cn_pcnNext;
+
+        if (bEntry && (pic->ic_fnFreeEntry != NULL))
+            pic->ic_fnFreeEntry(&pcn->cn_pEntry);
+
+        jf_jiukun_freeObject(pic->ic_pjjcNode, (void **)&pcn);
+        pcn = pNext;
+    }
+}
+
+static void _freeRetiredList(internal_chashtable_t * pic, chashtable_retire_t * pcr)
+{
+    chashtable_retire_t * pNext;
+    chashtable_node_t * pcn;
+
+    while (pcr != NULL)
+    {
+        pNext = pcr->cr_pcrNext;
+
+        if (pcr->cr_u8Type == CHASHTABLE_RETIRE_BUCKET)
+        {
+            jf_jiukun_freeMemory((void **)&pcr);
+        }
+        else
+        {
+            pcn = (chashtable_node_t *)pcr;
+            pcn->cn_pcnNext = NULL;
+            _freeNodeList(pic, pcn, pcr->cr_u8Type == CHASHTABLE_RETIRE_NODE_ENTRY);
+        }
+
+        pcr = pNext;
+    }
+}
+
+/** Add the object to retired list, it's freed after grace period.
+ */
+static void _retireObject(internal_chashtable_t * pic, chashtable_retire_t * pcr, u8 u8Type)
+{
+    pcr->cr_u8Type = u8Type;
+
+    jf_mutex_acquire(&pic->ic_jmRetire);
+    pcr->cr_pcrNext = pic->ic_pcrRetired;
+    pic->ic_pcrRetired = pcr;
+    pic->ic_u32NumOfRetired ++;
+    jf_mutex_release(&pic->ic_jmRetire);
+}
+
+/** Flip the reader phase, return the index of the old phase.
+ */
+static inline u32 _flipPhase(internal_chashtable_t * pic)
+{
+    u32 u32Index = jf_atomic_fetchAddU32(&pic->ic_u32Phase, 1) & 1;
+
+    /*The reader counters are read after the flip.*/
+    jf_atomic_fence();
+
+    return u32Index;
+}
+
+static boolean_t _isPhaseDrained(internal_chashtable_t * pic, u32 u32Index)
+{
+    u32 u32Slot;
+
+    for (u32Slot = 0; u32Slot < CHASHTABLE_NUM_OF_READER_SLOT; u32Slot ++)
+        if (jf_atomic_loadU32(&pic->ic_crReader[u32Slot].cr_u32Count[u32Index]) != 0)
+            return FALSE;
+
+    return TRUE;
+}
+
+/** Move the grace period forward without waiting.
+ *
+ *  @note
+ *  -# The reader may get the old phase index and increase the counter after the phase is drained,
+ *   the reader sees the objects unlinked before the flip is unlinked, but it may keep the object
+ *   retired later. So the objects are freed after readers of both phases are drained.
+ */
+static void _tryReclaim(internal_chashtable_t * pic)
+{
+    chashtable_retire_t * pcr = NULL;
+
+    if (jf_mutex_tryAcquire(&pic->ic_jmReclaim) != JF_ERR_NO_ERROR)
+        return;
+
+    if ((pic->ic_u32GraceState == 0) &&
+        (jf_atomic_loadU32(&pic->ic_u32NumOfRetired) >= CHASHTABLE_RECLAIM_THRESHOLD))
+    {
+        jf_mutex_acquire(&pic->ic_jmRetire);
+        pic->ic_pcrGrace = pic->ic_pcrRetired;
+        pic->ic_u32NumOfGrace = pic->ic_u32NumOfRetired;
+        pic->ic_pcrRetired = NULL;
+        pic->ic_u32NumOfRetired = 0;
+        jf_mutex_release(&pic->ic_jmRetire);
+
+        /*The flip is a full barrier, the unlink is visible to the reader of new phase.*/
+        pic->ic_u32GraceIndex = _flipPhase(pic);
+        pic->ic_u32GraceState = 1;
+    }
+
+    if ((pic->ic_u32GraceState == 1) && _isPhaseDrained(pic, pic->ic_u32GraceIndex))
+    {
+        pic->ic_u32GraceIndex = _flipPhase(pic);
+        pic->ic_u32GraceState = 2;
+    }
+
+    if ((pic->ic_u32GraceState == 2) && _isPhaseDrained(pic, pic->ic_u32GraceIndex))
+    {
+        pcr = pic->ic_pcrGrace;
+        pic->ic_pcrGrace = NULL;
+        pic->ic_u32NumOfGrace = 0;
+        pic->ic_u32GraceState = 0;
+        pic->ic_u64GracePeriod ++;
+    }
+
+    jf_mutex_release(&pic->ic_jmReclaim);
+
+    _freeRetiredList(pic, pcr);
+}
+
+/** Copy the nodes in the bucket to the new bucket array, the bucket is marked as moved. The stripe
+ *  lock must be held.
+ */
+static u32 _migrateBucket(
+    internal_chashtable_t * pic, chashtable_bucket_t * pcb, u32 u32Index)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    chashtable_bucket_t * pNew = pcb->cb_pcbNext;
+    chashtable_node_t * pList[2] = {NULL, NULL}, * pcn, * pCopy = NULL, * pNext;
+    u32 u32Target;
+
+    pcn = pcb->cb_pcnBucket[u32Index];
+    if (pcn == CHASHTABLE_MOVED)
+        return u32Ret;
+
+    /*The buckets are split into bucket index and index + old size.*/
+    for (; (pcn != NULL) && (u32Ret == JF_ERR_NO_ERROR); pcn = pcn->cn_pcnNext)
+    {
+        u32Ret = jf_jiukun_allocObject(pic->ic_pjjcNode, (void **)&pCopy);
+        if (u32Ret == JF_ERR_NO_ERROR)
+        {
+            u32Target = (pcn->cn_u32Hash & pNew->cb_u32Mask) == u32Index ? 0 : 1;
+            pCopy->cn_u32Hash = pcn->cn_u32Hash;
+            pCopy->cn_pKey = pcn->cn_pKey;
+            pCopy->cn_pEntry = pcn->cn_pEntry;
+            pCopy->cn_pcnNext = pList[u32Target];
+            pList[u32Target] = pCopy;
+        }
+    }
+
+    if (u32Ret != JF_ERR_NO_ERROR)
+    {
+        _freeNodeList(pic, pList[0], FALSE);
+        _freeNodeList(pic, pList[1], FALSE);
+        return u32Ret;
+    }
+
+    _storeNode(&pNew->cb_pcnBucket[u32Index], pList[0]);
+    _storeNode(&pNew->cb_pcnBucket[u32Index + pcb->cb_u32Size], pList[1]);
+
+    /*Readers see the new buckets after they see the moved mark.*/
+    pcn = pcb->cb_pcnBucket[u32Index];
+    _storeNode(&pcb->cb_pcnBucket[u32Index], CHASHTABLE_MOVED);
+
+    for (; pcn != NULL; pcn = pNext)
+    {
+        pNext = pcn->cn_pcnNext;
+        _retireObject(pic, &pcn->cn_crRetire, CHASHTABLE_RETIRE_NODE);
+    }
+
+    /*The last mover replaces the bucket array.*/
+    if (jf_atomic_fetchAddU32(&pcb->cb_u32Moved, 1) + 1 == pcb->cb_u32Size)
+    {
+        jf_atomic_storePointer((void * volatile *)&pic->ic_pcbBucket, pNew);
+        _retireObject(pic, &pcb->cb_crRetire, CHASHTABLE_RETIRE_BUCKET);
+    }
+
+    return u32Ret;
+}
+
+/** Move a batch of buckets if resize is in progress.
+ *
+ *  @note
+ *  -# The cursor is advanced only after the bucket is moved. If the bucket fails to be moved, the
+ *   cursor stays and the bucket is tried again by the next writer, so the resize always completes.
+ */
+static void _helpMigrate(internal_chashtable_t * pic)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    chashtable_bucket_t * pcb = _loadBucket(&pic->ic_pcbBucket);
+    u32 u32Batch, u32Index;
+    jf_mutex_t * pjm;
+
+    if (_loadBucket(&pcb->cb_pcbNext) == NULL)
+        return;
+
+    for (u32Batch = 0; u32Batch < CHASHTABLE_MIGRATE_BATCH; u32Batch ++)
+    {
+        u32Index = jf_atomic_loadU32(&pcb->cb_u32MigrateCursor);
+        if (u32Index >= pcb->cb_u32Size)
+            break;
+
+        pjm = _getStripeLock(pic, u32Index);
+        jf_mutex_acquire(pjm);
+        u32Ret = _migrateBucket(pic, pcb, u32Index);
+        jf_mutex_release(pjm);
+
+        if (u32Ret != JF_ERR_NO_ERROR)
+            break;
+
+        /*Other helpers may move the same bucket, they find it's moved and only one of them
+          advances the cursor.*/
+        jf_atomic_casU32(&pcb->cb_u32MigrateCursor, u32Index, u32Index + 1);
+    }
+}
+
+/** Start resize if the table is overloaded and no resize is in progress.
+ */
+static void _tryResize(internal_chashtable_t * pic)
+{
+    chashtable_bucket_t * pcb, * pNew = NULL;
+
+    pcb = _loadBucket(&pic->ic_pcbBucket);
+    if ((jf_atomic_loadU32(&pic->ic_u32NumOfEntry) <= CHASHTABLE_MAX_LOAD(pcb->cb_u32Size)) ||
+        (_loadBucket(&pcb->cb_pcbNext) != NULL))
+        return;
+
+    if (jf_mutex_tryAcquire(&pic->ic_jmResize) != JF_ERR_NO_ERROR)
+        return;
+
+    /*Check again as the bucket array may be replaced.*/
+    pcb = _loadBucket(&pic->ic_pcbBucket);
+    if ((_loadBucket(&pcb->cb_pcbNext) == NULL) &&
+        (_createBucket(&pNew, pcb->cb_u32Size * 2) == JF_ERR_NO_ERROR))
+    {
+        jf_atomic_storePointer((void * volatile *)&pcb->cb_pcbNext, pNew);
+        pic->ic_u32Resizes ++;
+    }
+
+    jf_mutex_release(&pic->ic_jmResize);
+}
+
+/** Get the bucket array for writing the key, the buckets of the key in old bucket arrays are
+ *  moved. The stripe lock must be held.
+ */
+static chashtable_bucket_t * _getWriteBucket(internal_chashtable_t * pic, u32 u32Hash)
+{
+    chashtable_bucket_t * pcb = _loadBucket(&pic->ic_pcbBucket), * pNext;
+
+    while ((pNext = _loadBucket(&pcb->cb_pcbNext)) != NULL)
+    {
+        /*Write to the old bucket if it fails to be moved, it's moved later.*/
+        if (_migrateBucket(pic, pcb, u32Hash & pcb->cb_u32Mask) != JF_ERR_NO_ERROR)
+            break;
+
+        pcb = pNext;
+    }
+
+    return pcb;
+}
+
+/** Find the node with the key in the bucket list, the lock free version for readers.
+ */
+static chashtable_node_t * _findNode(internal_chashtable_t * pic, void * pKey, u32 u32Hash)
+{
+    chashtable_bucket_t * pcb = _loadBucket(&pic->ic_pcbBucket);
+    chashtable_node_t * pcn;
+
+    pcn = _loadNode(&pcb->cb_pcnBucket[u32Hash & pcb->cb_u32Mask]);
+    while (pcn == CHASHTABLE_MOVED)
+    {
+        pcb = _loadBucket(&pcb->cb_pcbNext);
+        pcn = _loadNode(&pcb->cb_pcnBucket[u32Hash & pcb->cb_u32Mask]);
+    }
+
+    for (; pcn != NULL; pcn = _loadNode(&pcn->cn_pcnNext))
+        if ((pcn->cn_u32Hash == u32Hash) && _isKeyEqual(pic, pKey, pcn->cn_pKey))
+            return pcn;
+
+    return NULL;
+}
+
+/** Write the entry to the hash table.
+ *
+ *  @param pic [in] The hash table.
+ *  @param pKey [in] The key.
+ *  @param pEntry [in] The entry, NULL to remove the entry with the key.
+ *  @param bOverwrite [in] Overwrite the entry with the same key.
+ */
+static u32 _writeEntry(
+    internal_chashtable_t * pic, void * pKey, void * pEntry, boolean_t bOverwrite)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Hash = _hashKey(pic, pKey), u32Token;
+    jf_mutex_t * pjm = _getStripeLock(pic, u32Hash);
+    chashtable_bucket_t * pcb;
+    chashtable_node_t * volatile * ppcn, * pcn, * pNew = NULL;
+
+    /*The bucket array may be retired by other writers.*/
+    u32Token = jf_chashtable_enterRead(pic);
+
+    if (pEntry != NULL)
+        u32Ret = jf_jiukun_allocObject(pic->ic_pjjcNode, (void **)&pNew);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        jf_mutex_acquire(pjm);
+
+        pcb = _getWriteBucket(pic, u32Hash);
+        ppcn = &pcb->cb_pcnBucket[u32Hash & pcb->cb_u32Mask];
+        for (pcn = *ppcn; pcn != NULL; ppcn = &pcn->cn_pcnNext, pcn = *ppcn)
+            if ((pcn->cn_u32Hash == u32Hash) && _isKeyEqual(pic, pKey, pcn->cn_pKey))
+                break;
+
+        if (pEntry == NULL)
+        {
+            if (pcn == NULL)
+            {
+                u32Ret = JF_ERR_HASH_ENTRY_NOT_FOUND;
+            }
+            else
+            {
+                _storeNode(ppcn, pcn->cn_pcnNext);
+                jf_atomic_fetchAddU32(&pic->ic_u32NumOfEntry, (u32)-1);
+            }
+        }
+        else if ((pcn != NULL) && ! bOverwrite)
+        {
+            u32Ret = JF_ERR_HASH_ENTRY_EXIST;
+        }
+        else
+        {
+            pNew->cn_u32Hash = u32Hash;
+            pNew->cn_pKey = pKey;
+            pNew->cn_pEntry = pEntry;
+
+            if (pcn != NULL)
+            {
+                /*Replace the node, the node is immutable for readers.*/
+                pNew->cn_pcnNext = pcn->cn_pcnNext;
+            }
+            else
+            {
+                ppcn = &pcb->cb_pcnBucket[u32Hash & pcb->cb_u32Mask];
+                pNew->cn_pcnNext = *ppcn;
+                jf_atomic_fetchAddU32(&pic->ic_u32NumOfEntry, 1);
+            }
+
+            _storeNode(ppcn, pNew);
+            pNew = NULL;
+        }
+
+        jf_mutex_release(pjm);
+
+        /*The removed or replaced node and entry are freed after grace period.*/
+        if ((u32Ret == JF_ERR_NO_ERROR) && (pcn != NULL))
+            _retireObject(
+                pic, &pcn->cn_crRetire, (pcn->cn_pEntry == pEntry) ?
+                CHASHTABLE_RETIRE_NODE : CHASHTABLE_RETIRE_NODE_ENTRY);
+    }
+
+    if (pNew != NULL)
+        jf_jiukun_freeObject(pic->ic_pjjcNode, (void **)&pNew);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        _tryResize(pic);
+        _helpMigrate(pic);
+    }
+
+    jf_chashtable_leaveRead(pic, u32Token);
+
+    _tryReclaim(pic);
+
+    return u32Ret;
+}
+
+/* --- public routine section ------------------------------------------------------------------- */
+
+u32 jf_chashtable_create(jf_chashtable_t ** ppjc, jf_chashtable_create_param_t * pjccp)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_chashtable_t * pic = NULL;
+    u32 u32Stripe = JF_CHASHTABLE_DEFAULT_STRIPE, u32Size = CHASHTABLE_MIN_SIZE, u32Index;
+    jf_jiukun_cache_create_param_t jjccp;
+
+    assert((ppjc != NULL) && (pjccp != NULL));
+    assert((pjccp->jccp_u8KeyType != JF_HASHTABLE_KEY_TYPE_CALLBACK) ||
+           ((pjccp->jccp_fnCmpKeys != NULL) && (pjccp->jccp_fnHashKey != NULL)));
+    assert(pjccp->jccp_fnGetKeyFromEntry != NULL);
+
+    if (pjccp->jccp_u32Stripe != 0)
+        for (u32Stripe = 1; u32Stripe < pjccp->jccp_u32Stripe; u32Stripe <<= 1)
+            ;
+
+    /*The stripe of bucket is not changed when the bucket is moved.*/
+    while ((u32Size < u32Stripe) || (CHASHTABLE_MAX_LOAD(u32Size) < pjccp->jccp_u32MinSize))
+        u32Size <<= 1;
+
+    u32Ret = jf_jiukun_allocMemory((void **)&pic, sizeof(internal_chashtable_t));
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ol_bzero(pic, sizeof(internal_chashtable_t));
+        pic->ic_u8KeyType = pjccp->jccp_u8KeyType;
+        pic->ic_u32StripeMask = u32Stripe - 1;
+        pic->ic_u32StripeStride = ALIGN(sizeof(jf_mutex_t), JF_JIUKUN_CACHE_LINE_SIZE);
+        pic->ic_fnCmpKeys = pjccp->jccp_fnCmpKeys;
+        pic->ic_fnHashKey = pjccp->jccp_fnHashKey;
+        pic->ic_fnGetKeyFromEntry = pjccp->jccp_fnGetKeyFromEntry;
+        pic->ic_fnFreeEntry = pjccp->jccp_fnFreeEntry;
+
+        u32Ret = jf_mutex_init(&pic->ic_jmResize);
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = jf_mutex_init(&pic->ic_jmRetire);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = jf_mutex_init(&pic->ic_jmReclaim);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ol_bzero(&jjccp, sizeof(jjccp));
+        jjccp.jjccp_pstrName = CHASHTABLE_NODE_CACHE;
+        jjccp.jjccp_sObj = sizeof(chashtable_node_t);
+        JF_FLAG_SET(jjccp.jjccp_jfCache, JF_JIUKUN_CACHE_CREATE_FLAG_SHARED);
+
+        u32Ret = jf_jiukun_createCache(&pic->ic_pjjcNode, &jjccp);
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = _createBucket((chashtable_bucket_t **)&pic->ic_pcbBucket, u32Size);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = jf_jiukun_allocMemory(
+            (void **)&pic->ic_pu8Stripe, u32Stripe * pic->ic_u32StripeStride);
+
+    for (u32Index = 0; (u32Index < u32Stripe) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+    {
+        u32Ret = jf_mutex_init(
+            (jf_mutex_t *)(pic->ic_pu8Stripe + u32Index * pic->ic_u32StripeStride));
+        if (u32Ret == JF_ERR_NO_ERROR)
+            pic->ic_u32NumOfStripe ++;
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        *ppjc = pic;
+    else if (pic != NULL)
+        jf_chashtable_destroy((jf_chashtable_t **)&pic);
+
+    return u32Ret;
+}
+
+u32 jf_chashtable_destroy(jf_chashtable_t ** ppjc)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_chashtable_t * pic = NULL;
+    chashtable_bucket_t * pcb, * pNext;
+    u32 u32Index;
+
+    assert((ppjc != NULL) && (*ppjc != NULL));
+
+    pic = (internal_chashtable_t *) *ppjc;
+
+    _freeRetiredList(pic, pic->ic_pcrRetired);
+    _freeRetiredList(pic, pic->ic_pcrGrace);
+
+    /*The buckets not moved are in old bucket array, the moved ones are in new bucket array.*/
+    for (pcb = pic->ic_pcbBucket; pcb != NULL; pcb = pNext)
+    {
+        pNext = pcb->cb_pcbNext;
+
+        for (u32Index = 0; u32Index < pcb->cb_u32Size; u32Index ++)
+            if (pcb->cb_pcnBucket[u32Index] != CHASHTABLE_MOVED)
+                _freeNodeList(pic, pcb->cb_pcnBucket[u32Index], TRUE);
+
+        jf_jiukun_freeMemory((void **)&pcb);
+    }
+
+    if (pic->ic_pu8Stripe != NULL)
+    {
+        for (u32Index = 0; u32Index < pic->ic_u32NumOfStripe; u32Index ++)
+            jf_mutex_fini((jf_mutex_t *)(pic->ic_pu8Stripe + u32Index * pic->ic_u32StripeStride));
+
+        jf_jiukun_freeMemory((void **)&pic->ic_pu8Stripe);
+    }
+
+    if (pic->ic_pjjcNode != NULL)
+        jf_jiukun_destroyCache(&pic->ic_pjjcNode);
+
+    jf_mutex_fini(&pic->ic_jmReclaim);
+    jf_mutex_fini(&pic->ic_jmRetire);
+    jf_mutex_fini(&pic->ic_jmResize);
+
+    jf_jiukun_freeMemory(ppjc);
+
+    return u32Ret;
+}
+
+u32 jf_chashtable_enterRead(jf_chashtable_t * pjc)
+{
+    internal_chashtable_t * pic = (internal_chashtable_t *)pjc;
+    u32 u32Slot = _getReaderSlot();
+    u32 u32Index = jf_atomic_loadU32(&pic->ic_u32Phase) & 1;
+
+    /*The increment is a full barrier, the reads in the section are not moved before it.*/
+    jf_atomic_fetchAddU32(&pic->ic_crReader[u32Slot].cr_u32Count[u32Index], 1);
+
+    return (u32Slot << 1) | u32Index;
+}
+
+void jf_chashtable_leaveRead(jf_chashtable_t * pjc, u32 u32Token)
+{
+    internal_chashtable_t * pic = (internal_chashtable_t *)pjc;
+
+    jf_atomic_fetchAddU32(&pic->ic_crReader[u32Token >> 1].cr_u32Count[u32Token & 1], (u32)-1);
+}
+
+u32 jf_chashtable_getEntry(jf_chashtable_t * pjc, void * pKey, void ** ppEntry)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_chashtable_t * pic = (internal_chashtable_t *)pjc;
+    chashtable_node_t * pcn;
+
+    pcn = _findNode(pic, pKey, _hashKey(pic, pKey));
+    if (pcn == NULL)
+        u32Ret = JF_ERR_HASH_ENTRY_NOT_FOUND;
+    else
+        *ppEntry = pcn->cn_pEntry;
+
+    return u32Ret;
+}
+
+boolean_t jf_chashtable_isKeyInTable(jf_chashtable_t * pjc, void * pKey)
+{
+    internal_chashtable_t * pic = (internal_chashtable_t *)pjc;
+    boolean_t bRet = FALSE;
+    u32 u32Token;
+
+    u32Token = jf_chashtable_enterRead(pjc);
+    bRet = (_findNode(pic, pKey, _hashKey(pic, pKey)) != NULL);
+    jf_chashtable_leaveRead(pjc, u32Token);
+
+    return bRet;
+}
+
+u32 jf_chashtable_insertEntry(jf_chashtable_t * pjc, void * pEntry)
+{
+    internal_chashtable_t * pic = (internal_chashtable_t *)pjc;
+
+    assert(pEntry != NULL);
+
+    return _writeEntry(pic, pic->ic_fnGetKeyFromEntry(pEntry), pEntry, FALSE);
+}
+
+u32 jf_chashtable_overwriteEntry(jf_chashtable_t * pjc, void * pEntry)
+{
+    internal_chashtable_t * pic = (internal_chashtable_t *)pjc;
+
+    assert(pEntry != NULL);
+
+    return _writeEntry(pic, pic->ic_fnGetKeyFromEntry(pEntry), pEntry, TRUE);
+}
+
+u32 jf_chashtable_removeEntry(jf_chashtable_t * pjc, void * pKey)
+{
+    internal_chashtable_t * pic = (internal_chashtable_t *)pjc;
+
+    return _writeEntry(pic, pKey, NULL, FALSE);
+}
+
+u32 jf_chashtable_getSize(jf_chashtable_t * pjc)
+{
+    internal_chashtable_t * pic = (internal_chashtable_t *)pjc;
+
+    return jf_atomic_loadU32(&pic->ic_u32NumOfEntry);
+}
+
+void jf_chashtable_getStat(jf_chashtable_t * pjc, jf_chashtable_stat_t * pStat)
+{
+    internal_chashtable_t * pic = (internal_chashtable_t *)pjc;
+    u32 u32Token;
+
+    ol_bzero(pStat, sizeof(*pStat));
+
+    u32Token = jf_chashtable_enterRead(pjc);
+    pStat->jcs_u32Size = _loadBucket(&pic->ic_pcbBucket)->cb_u32Size;
+    jf_chashtable_leaveRead(pjc, u32Token);
+
+    pStat->jcs_u32NumOfEntry = jf_atomic_loadU32(&pic->ic_u32NumOfEntry);
+    pStat->jcs_u32CountOfResizeOp = pic->ic_u32Resizes;
+
+    jf_mutex_acquire(&pic->ic_jmReclaim);
+    pStat->jcs_u32Retired = jf_atomic_loadU32(&pic->ic_u32NumOfRetired) + pic->ic_u32NumOfGrace;
+    pStat->jcs_u64GracePeriod = pic->ic_u64GracePeriod;
+    jf_mutex_release(&pic->ic_jmReclaim);
+}
+
+/*------------------------------------------------------------------------------------------------*/
+
+
@@ -0,0 +1,198 @@
+/**
+ *  @file jf_chashtable.h
+ *
+ *  @brief Header file for concurrent hash table common object.
+ *
+ *  @author Min Zhang
+ *
+ *  @note
+ *  -# Routines declared in this file are included in jf_chashtable object.
+ *  -# Link with jf_jiukun library for memory allocation, link with jf_mutex object.
+ *  -# The lookup is lock free, the insertion and removal lock one stripe of buckets. Readers
+ *   never block and are never blocked.
+ *  -# The hash table grows incrementally, the buckets are moved to the new bucket array a few at
+ *   a time by writers, readers follow the moved bucket to the new array.
+ *  -# The removed entry is freed after all readers which may see the entry have left the read
+ *   section. The entry returned by jf_chashtable_getEntry() is valid until the caller leaves the
+ *   read section.
+ */
+
+/*------------------------------------------------------------------------------------------------*/
+#ifndef JIUTAI_CHASHTABLE_H
+#define JIUTAI_CHASHTABLE_H
+
+/* --- standard C lib header files -------------------------------------------------------------- */
+
+/* --- internal header files -------------------------------------------------------------------- */
+#include "jf_basic.h"
+#include "jf_err.h"
+#include "jf_hashtable.h"
+
+/* --- constant definitions --------------------------------------------------------------------- */
+
+/** Define the concurrent hash table data type.
+ */
+typedef void  jf_chashtable_t;
+
+/** Default number of lock stripes.
+ */
+#define JF_CHASHTABLE_DEFAULT_STRIPE                 (64)
+
+/* --- data structures -------------------------------------------------------------------------- */
+
+/** Define the parameter data type for creating concurrent hash table.
+ */
+typedef struct
+{
+    /**Minimal number of entry by estimation.*/
+    u32 jccp_u32MinSize;
+    /**Number of lock stripes, it's rounded up to power of 2. 0 means
+       JF_CHASHTABLE_DEFAULT_STRIPE.*/
+    u32 jccp_u32Stripe;
+    /**Key type, the key types of jf_hashtable are supported.*/
+    u8 jccp_u8KeyType;
+    u8 jccp_u8Reserved[7];
+    /**Callback function to compare key, for callback key type.*/
+    jf_hashtable_fnCmpKeys_t jccp_fnCmpKeys;
+    /**Callback function to hash key, for callback key type.*/
+    jf_hashtable_fnHashKey_t jccp_fnHashKey;
+    /**Callback function to get key from entry.*/
+    jf_hashtable_fnGetKeyFromEntry_t jccp_fnGetKeyFromEntry;
+    /**Callback function to free the entry, it's optional. The entry is freed after grace
+       period.*/
+    jf_hashtable_fnFreeEntry_t jccp_fnFreeEntry;
+} jf_chashtable_create_param_t;
+
+/** Define the concurrent hash table statistic data type.
+ */
+typedef struct
+{
+    /**Number of entry in hash table.*/
+    u32 jcs_u32NumOfEntry;
+    /**Number of buckets.*/
+    u32 jcs_u32Size;
+    /**Count of resize operation.*/
+    u32 jcs_u32CountOfResizeOp;
+    /**Number of objects waiting for grace period.*/
+    u32 jcs_u32Retired;
+    /**Number of grace periods completed.*/
+    u64 jcs_u64GracePeriod;
+} jf_chashtable_stat_t;
+
+/* --- functional routines ---------------------------------------------------------------------- */
+
+/** Create concurrent hash table.
+ *
+ *  @param ppjc [out] The hash table to be created and returned.
+ *  @param pjccp [in] The parameter for creating hash table.
+ *
+ *  @return The error code.
+ */
+u32 jf_chashtable_create(jf_chashtable_t ** ppjc, jf_chashtable_create_param_t * pjccp);
+
+/** Destroy the concurrent hash table, all entries are freed.
+ *
+ *  @note
+ *  -# No other thread should access the hash table.
+ *
+ *  @param ppjc [in/out] The hash table to be destroyed.
+ *
+ *  @return The error code.
+ */
+u32 jf_chashtable_destroy(jf_chashtable_t ** ppjc);
+
+/** Enter the read section. The entry got from hash table in the read section is not freed until
+ *  the read section is left.
+ *
+ *  @note
+ *  -# The read section can be nested.
+ *
+ *  @param pjc [in] The hash table.
+ *
+ *  @return The token to leave the read section.
+ */
+u32 jf_chashtable_enterRead(jf_chashtable_t * pjc);
+
+/** Leave the read section.
+ *
+ *  @param pjc [in] The hash table.
+ *  @param u32Token [in] The token returned by jf_chashtable_enterRead().
+ *
+ *  @return Void.
+ */
+void jf_chashtable_leaveRead(jf_chashtable_t * pjc, u32 u32Token);
+
+/** Search for entry with this key, the caller must be in read section.
+ *
+ *  @param pjc [in] The hash table.
+ *  @param pKey [in] The key.
+ *  @param ppEntry [out] The entry found.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_HASH_ENTRY_NOT_FOUND The entry is not found.
+ */
+u32 jf_chashtable_getEntry(jf_chashtable_t * pjc, void * pKey, void ** ppEntry);
+
+/** Check if the key is in hash table.
+ *
+ *  @param pjc [in] The hash table.
+ *  @param pKey [in] The key to be checked.
+ *
+ *  @return The status.
+ *  @retval TRUE The key is in hash table.
+ *  @retval FALSE The key is not in hash table.
+ */
+boolean_t jf_chashtable_isKeyInTable(jf_chashtable_t * pjc, void * pKey);
+
+/** Insert an entry into the hash table but do not overwrite existing entry with the same key.
+ *
+ *  @param pjc [in] The hash table.
+ *  @param pEntry [in] The entry to be inserted.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_HASH_ENTRY_EXIST The entry with the same key is in hash table.
+ */
+u32 jf_chashtable_insertEntry(jf_chashtable_t * pjc, void * pEntry);
+
+/** Overwrite an existing entry with the same key or insert a new entry. The overwritten entry
+ *  is freed after grace period.
+ *
+ *  @param pjc [in] The hash table.
+ *  @param pEntry [in] The entry.
+ *
+ *  @return The error code.
+ */
+u32 jf_chashtable_overwriteEntry(jf_chashtable_t * pjc, void * pEntry);
+
+/** Remove the entry with the key, the entry is freed after grace period.
+ *
+ *  @param pjc [in] The hash table.
+ *  @param pKey [in] The key of the entry to be removed.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_HASH_ENTRY_NOT_FOUND The entry is not found.
+ */
+u32 jf_chashtable_removeEntry(jf_chashtable_t * pjc, void * pKey);
+
+/** Return the number of entries.
+ *
+ *  @param pjc [in] The hash table.
+ *
+ *  @return The number of entries.
+ */
+u32 jf_chashtable_getSize(jf_chashtable_t * pjc);
+
+/** Get the statistics of the hash table.
+ *
+ *  @param pjc [in] The hash table.
+ *  @param pStat [out] The statistics.
+ *
+ *  @return Void.
+ */
+void jf_chashtable_getStat(jf_chashtable_t * pjc, jf_chashtable_stat_t * pStat);
+
+#endif /*JIUTAI_CHASHTABLE_H*/
+
+/*------------------------------------------------------------------------------------------------*/
+
+
@@ -0,0 +1,559 @@
+/**
+ *  @file jf_epoch.c
+ *
+ *  @brief Implementation file for epoch based memory reclamation common object.
+ *
+ *  @author Min Zhang
+ *
+ *  @note
+ *  -# The global epoch is even and advanced by 2, the epoch of thread in read section is the
+ *   global epoch with the low bit set, so the epoch of thread is 0 only if it's not in read
+ *   section.
+ *  -# A reader may enter the read section with the previous epoch when the epoch is just
+ *   advanced, so the object retired in epoch N is freed when the global epoch is N + 4, after 2
+ *   advances.
+ *  -# Each thread has 3 bags for the retired objects, the bag is selected by the epoch. The bag
+ *   with old epoch is freed when it's reused.
+ */
+
+/* --- standard C lib header files -------------------------------------------------------------- */
+#include <stdio.h>
+#include <string.h>
+#if defined(LINUX)
+    #include <unistd.h>
+    #include <sys/syscall.h>
+    #include <linux/membarrier.h>
+#endif
+
+/* --- internal header files -------------------------------------------------------------------- */
+#include "jf_basic.h"
+#include "jf_limit.h"
+#include "jf_err.h"
+#include "jf_listhead.h"
+#include "jf_mutex.h"
+#include "jf_atomic.h"
+#include "jf_jiukun.h"
+#include "jf_epoch.h"
+
+/* --- private data/data structure section ------------------------------------------------------ */
+
+/** Default number of retired objects before the thread tries to advance the global epoch.
+ */
+#define EPOCH_DEFAULT_ADVANCE_THRESHOLD          (64)
+
+/** Number of bags of thread for retired objects.
+ */
+#define EPOCH_NUM_OF_BAG                         (3)
+
+/** Initial number of retired objects in bag, the bag grows double.
+ */
+#define EPOCH_BAG_INIT_SIZE                      (64)
+
+/** The epoch is advanced by 2.
+ */
+#define EPOCH_STEP                               (2)
+
+/** Number of advances for the grace period.
+ */
+#define EPOCH_GRACE_PERIOD                       (2 * EPOCH_STEP)
+
+/** Number of tries to advance the epoch before the thread is blocked in synchronize.
+ */
+#define EPOCH_SPIN_COUNT                         (10)
+
+/** Timeout in millisecond of waiting for the epoch advanced in synchronize, the thread tries to
+ *  advance the epoch after timeout as readers leaving read section don't wake it up.
+ */
+#define EPOCH_WAIT_TIMEOUT                       (1)
+
+/** The retired object.
+ */
+typedef struct
+{
+    jf_epoch_fnFree_t ed_fnFree;
+    void * ed_pObject;
+    void * ed_pArg;
+} epoch_deferred_t;
+
+/** The bag of retired objects.
+ */
+typedef struct
+{
+    /**The global epoch when the objects are retired.*/
+    u32 eb_u32Epoch;
+    u32 eb_u32NumOfDeferred;
+    u32 eb_u32Size;
+    u32 eb_u32Reserved;
+    epoch_deferred_t * eb_pedDeferred;
+} epoch_bag_t;
+
+struct internal_epoch;
+
+typedef struct
+{
+    /**The global epoch with the low bit set when the thread enters read section, 0 if the thread
+       is not in read section.*/
+    volatile u32 et_u32Epoch;
+    /**Nesting level of read section.*/
+    u32 et_u32Nest;
+    struct internal_epoch * et_pieEpoch;
+    /**Number of objects retired after the last try to advance the epoch.*/
+    u32 et_u32NumOfRetired;
+    u32 et_u32Reserved;
+    volatile u64 et_u64Retired;
+    volatile u64 et_u64Freed;
+    /**The thread list of the domain.*/
+    jf_listhead_t et_jlThread;
+    epoch_bag_t et_ebBag[EPOCH_NUM_OF_BAG];
+} epoch_thread_t;
+
+typedef struct internal_epoch
+{
+    /**The global epoch.*/
+    volatile u32 ie_u32Epoch;
+    /**Number of threads waiting for the epoch advanced.*/
+    volatile u32 ie_u32Waiter;
+    volatile u64 ie_u64Advance;
+    u32 ie_u32AdvanceThreshold;
+    boolean_t ie_bMembarrier;
+    u8 ie_u8Reserved[3];
+
+    /*start of thread lock protected section*/
+    jf_mutex_t ie_jmThread;
+    jf_listhead_t ie_jlThread;
+    u32 ie_u32NumOfThread;
+    u32 ie_u32Reserved;
+    /**Number of retired and freed objects of unregistered threads.*/
+    u64 ie_u64Retired;
+    u64 ie_u64Freed;
+    /*end of thread lock protected section*/
+} internal_epoch_t;
+
+/* --- private routine section ------------------------------------------------------------------ */
+
+/** Register the process for the membarrier system call.
+ */
+static boolean_t _registerMembarrier(void)
+{
+    boolean_t bRet = FALSE;
+
+#if defined(LINUX) && defined(__NR_membarrier)
+    long lCmd = syscall(__NR_membarrier, MEMBARRIER_CMD_QUERY, 0, 0);
+
+    if ((lCmd > 0) && ((lCmd & MEMBARRIER_CMD_PRIVATE_EXPEDITED) != 0) &&
+        (syscall(__NR_membarrier, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0, 0) == 0))
+        bRet = TRUE;
+#endif
+
+    return bRet;
+}
+
+/** Issue the memory barrier on all threads, the epochs of threads are read after it.
+ */
+static void _issueEpochBarrier(internal_epoch_t * pie)
+{
+#if defined(LINUX) && defined(__NR_membarrier)
+    if (pie->ie_bMembarrier &&
+        (syscall(__NR_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0, 0) == 0))
+        return;
+#endif
+
+    jf_atomic_fence();
+}
+
+/** Try to advance the global epoch.
+ *
+ *  @return TRUE if the global epoch is advanced by this thread or other threads.
+ */
+static boolean_t _tryAdvanceEpoch(internal_epoch_t * pie)
+{
+    boolean_t bRet = TRUE;
+    u32 u32Epoch = jf_atomic_loadU32(&pie->ie_u32Epoch), u32Local;
+    jf_listhead_t * pjl = NULL;
+    epoch_thread_t * pet = NULL;
+
+    /*The objects are unlinked before the epochs of threads are read.*/
+    _issueEpochBarrier(pie);
+
+    jf_mutex_acquire(&pie->ie_jmThread);
+
+    jf_listhead_forEach(&pie->ie_jlThread, pjl)
+    {
+        pet = jf_listhead_getEntry(pjl, epoch_thread_t, et_jlThread);
+        u32Local = jf_atomic_loadU32(&pet->et_u32Epoch);
+
+        /*The thread is in read section with the previous epoch.*/
+        if ((u32Local != 0) && (u32Local != (u32Epoch | 1)))
+        {
+            bRet = FALSE;
+            break;
+        }
+    }
+
+    jf_mutex_release(&pie->ie_jmThread);
+
+    if (bRet && jf_atomic_casU32(&pie->ie_u32Epoch, u32Epoch, u32Epoch + EPOCH_STEP))
+    {
+        jf_atomic_fetchAddU64(&pie->ie_u64Advance, 1);
+
+        if (jf_atomic_loadU32(&pie->ie_u32Waiter) != 0)
+            jf_atomic_wakeU32(&pie->ie_u32Epoch, TRUE);
+    }
+
+    return bRet;
+}
+
+static void _freeEpochBag(epoch_thread_t * pet, epoch_bag_t * peb)
+{
+    u32 u32Index;
+    epoch_deferred_t * ped = NULL;
+
+    for (u32Index = 0; u32Index < peb->eb_u32NumOfDeferred; u32Index ++)
+    {
+        ped = &peb->eb_pedDeferred[u32Index];
+        ped->ed_fnFree(ped->ed_pObject, ped->ed_pArg);
+    }
+
+    pet->et_u64Freed += peb->eb_u32NumOfDeferred;
+    peb->eb_u32NumOfDeferred = 0;
+}
+
+static u32 _growEpochBag(epoch_bag_t * peb)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Size = (peb->eb_u32Size == 0) ? EPOCH_BAG_INIT_SIZE : peb->eb_u32Size * 2;
+    epoch_deferred_t * ped = NULL;
+
+    u32Ret = jf_jiukun_allocMemory((void **)&ped, u32Size * sizeof(epoch_deferred_t));
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        if (peb->eb_pedDeferred != NULL)
+        {
+            ol_memcpy(ped, peb->eb_pedDeferred, peb->eb_u32NumOfDeferred * sizeof(*ped));
+            jf_jiukun_freeMemory((void **)&peb->eb_pedDeferred);
+        }
+
+        peb->eb_pedDeferred = ped;
+        peb->eb_u32Size = u32Size;
+    }
+
+    return u32Ret;
+}
+
+/** Free the bags whose grace period is over, or all bags if "bAll" is TRUE.
+ */
+static void _reclaimEpochThread(epoch_thread_t * pet, boolean_t bAll)
+{
+    u32 u32Epoch = jf_atomic_loadU32(&pet->et_pieEpoch->ie_u32Epoch), u32Index;
+    epoch_bag_t * peb = NULL;
+
+    for (u32Index = 0; u32Index < EPOCH_NUM_OF_BAG; u32Index ++)
+    {
+        peb = &pet->et_ebBag[u32Index];
+
+        if ((peb->eb_u32NumOfDeferred > 0) &&
+            (bAll || (u32Epoch - peb->eb_u32Epoch >= EPOCH_GRACE_PERIOD)))
+            _freeEpochBag(pet, peb);
+    }
+}
+
+/** Free the thread data, the retired objects are freed without waiting for grace period.
+ */
+static void _freeEpochThread(epoch_thread_t ** ppet)
+{
+    epoch_thread_t * pet = *ppet;
+    u32 u32Index;
+
+    _reclaimEpochThread(pet, TRUE);
+
+    for (u32Index = 0; u32Index < EPOCH_NUM_OF_BAG; u32Index ++)
+        if (pet->et_ebBag[u32Index].eb_pedDeferred != NULL)
+            jf_jiukun_freeMemory((void **)&pet->et_ebBag[u32Index].eb_pedDeferred);
+
+    jf_jiukun_freeMemory((void **)ppet);
+}
+
+static void _freeEpochMemory(void * pObject, void * pArg)
+{
+    jf_jiukun_freeMemory(&pObject);
+}
+
+static void _freeEpochObject(void * pObject, void * pArg)
+{
+    jf_jiukun_freeObject((jf_jiukun_cache_t *)pArg, &pObject);
+}
+
+/* --- public routine section ------------------------------------------------------------------- */
+
+u32 jf_epoch_create(jf_epoch_t ** ppje, jf_epoch_create_param_t * pjecp)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_epoch_t * pie = NULL;
+
+    assert((ppje != NULL) && (pjecp != NULL));
+
+    u32Ret = jf_jiukun_allocMemory((void **)&pie, sizeof(internal_epoch_t));
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ol_bzero(pie, sizeof(internal_epoch_t));
+        jf_listhead_init(&pie->ie_jlThread);
+        pie->ie_u32AdvanceThreshold = pjecp->jecp_u32AdvanceThreshold;
+        if (pie->ie_u32AdvanceThreshold == 0)
+            pie->ie_u32AdvanceThreshold = EPOCH_DEFAULT_ADVANCE_THRESHOLD;
+
+        if (! pjecp->jecp_bNoMembarrier)
+            pie->ie_bMembarrier = _registerMembarrier();
+
+        u32Ret = jf_mutex_init(&pie->ie_jmThread);
+        if (u32Ret == JF_ERR_NO_ERROR)
+            *ppje = pie;
+        else
+            jf_jiukun_freeMemory((void **)&pie);
+    }
+
+    return u32Ret;
+}
+
+u32 jf_epoch_destroy(jf_epoch_t ** ppje)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_epoch_t * pie = NULL;
+    jf_listhead_t * pjl = NULL, * pjln = NULL;
+    epoch_thread_t * pet = NULL;
+
+    assert((ppje != NULL) && (*ppje != NULL));
+
+    pie = *ppje;
+
+    jf_listhead_forEachSafe(&pie->ie_jlThread, pjl, pjln)
+    {
+        pet = jf_listhead_getEntry(pjl, epoch_thread_t, et_jlThread);
+        jf_listhead_del(&pet->et_jlThread);
+        _freeEpochThread(&pet);
+    }
+
+    jf_mutex_fini(&pie->ie_jmThread);
+
+    jf_jiukun_freeMemory(ppje);
+
+    return u32Ret;
+}
+
+u32 jf_epoch_registerThread(jf_epoch_t * pje, jf_epoch_thread_t ** ppjet)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_epoch_t * pie = pje;
+    epoch_thread_t * pet = NULL;
+
+    assert((pje != NULL) && (ppjet != NULL));
+
+    u32Ret = jf_jiukun_allocMemory((void **)&pet, sizeof(epoch_thread_t));
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ol_bzero(pet, sizeof(epoch_thread_t));
+        pet->et_pieEpoch = pie;
+
+        jf_mutex_acquire(&pie->ie_jmThread);
+        jf_listhead_add(&pie->ie_jlThread, &pet->et_jlThread);
+        pie->ie_u32NumOfThread ++;
+        jf_mutex_release(&pie->ie_jmThread);
+
+        *ppjet = pet;
+    }
+
+    return u32Ret;
+}
+
+u32 jf_epoch_unregisterThread(jf_epoch_thread_t ** ppjet)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    epoch_thread_t * pet = NULL;
+    internal_epoch_t * pie = NULL;
+
+    assert((ppjet != NULL) && (*ppjet != NULL));
+
+    pet = *ppjet;
+    pie = pet->et_pieEpoch;
+    assert(pet->et_u32Nest == 0);
+
+    jf_epoch_barrier(pet);
+
+    jf_mutex_acquire(&pie->ie_jmThread);
+    jf_listhead_del(&pet->et_jlThread);
+    pie->ie_u32NumOfThread --;
+    pie->ie_u64Retired += pet->et_u64Retired;
+    pie->ie_u64Freed += pet->et_u64Freed;
+    jf_mutex_release(&pie->ie_jmThread);
+
+    _freeEpochThread((epoch_thread_t **)ppjet);
+
+    return u32Ret;
+}
+
+void jf_epoch_enter(jf_epoch_thread_t * pjet)
+{
+    epoch_thread_t * pet = pjet;
+    u32 u32Epoch;
+
+    if (pet->et_u32Nest ++ > 0)
+        return;
+
+    u32Epoch = jf_atomic_loadU32(&pet->et_pieEpoch->ie_u32Epoch) | 1;
+
+#if defined(LINUX)
+    if (pet->et_pieEpoch->ie_bMembarrier)
+    {
+        /*The membarrier in advancing the epoch orders the store with the reads in read section.*/
+        pet->et_u32Epoch = u32Epoch;
+        __atomic_signal_fence(__ATOMIC_SEQ_CST);
+        return;
+    }
+#endif
+
+    /*The exchange is a full barrier, the reads in read section are not moved before it.*/
+    jf_atomic_exchangeU32(&pet->et_u32Epoch, u32Epoch);
+}
+
+void jf_epoch_leave(jf_epoch_thread_t * pjet)
+{
+    epoch_thread_t * pet = pjet;
+
+    assert(pet->et_u32Nest > 0);
+
+    if (-- pet->et_u32Nest > 0)
+        return;
+
+    /*The store has release semantic, the reads in read section are done before it.*/
+    jf_atomic_storeU32(&pet->et_u32Epoch, 0);
+}
+
+u32 jf_epoch_retire(
+    jf_epoch_thread_t * pjet, void * pObject, jf_epoch_fnFree_t fnFree, void * pArg)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    epoch_thread_t * pet = pjet;
+    internal_epoch_t * pie = pet->et_pieEpoch;
+    u32 u32Epoch = jf_atomic_loadU32(&pie->ie_u32Epoch);
+    epoch_bag_t * peb = &pet->et_ebBag[(u32Epoch / EPOCH_STEP) % EPOCH_NUM_OF_BAG];
+    epoch_deferred_t * ped = NULL;
+
+    /*The bag was used 3 advances ago, the grace period is over.*/
+    if ((peb->eb_u32NumOfDeferred > 0) && (peb->eb_u32Epoch != u32Epoch))
+        _freeEpochBag(pet, peb);
+
+    if (peb->eb_u32NumOfDeferred == peb->eb_u32Size)
+        u32Ret = _growEpochBag(peb);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ped = &peb->eb_pedDeferred[peb->eb_u32NumOfDeferred ++];
+        ped->ed_fnFree = fnFree;
+        ped->ed_pObject = pObject;
+        ped->ed_pArg = pArg;
+        peb->eb_u32Epoch = u32Epoch;
+        pet->et_u64Retired ++;
+
+        pet->et_u32NumOfRetired ++;
+        if (pet->et_u32NumOfRetired >= pie->ie_u32AdvanceThreshold)
+        {
+            pet->et_u32NumOfRetired = 0;
+            _tryAdvanceEpoch(pie);
+            _reclaimEpochThread(pet, FALSE);
+        }
+    }
+    else if (pet->et_u32Nest == 0)
+    {
+        /*The memory is not available, free the object after grace period.*/
+        jf_epoch_synchronize(pie);
+
+        fnFree(pObject, pArg);
+        pet->et_u64Retired ++;
+        pet->et_u64Freed ++;
+
+        u32Ret = JF_ERR_NO_ERROR;
+    }
+
+    return u32Ret;
+}
+
+u32 jf_epoch_retireMemory(jf_epoch_thread_t * pjet, void * pMemory)
+{
+    return jf_epoch_retire(pjet, pMemory, _freeEpochMemory, NULL);
+}
+
+u32 jf_epoch_retireObject(jf_epoch_thread_t * pjet, jf_jiukun_cache_t * pCache, void * pObject)
+{
+    return jf_epoch_retire(pjet, pObject, _freeEpochObject, pCache);
+}
+
+u32 jf_epoch_synchronize(jf_epoch_t * pje)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_epoch_t * pie = pje;
+    u32 u32Target = jf_atomic_loadU32(&pie->ie_u32Epoch) + EPOCH_GRACE_PERIOD;
+    u32 u32Epoch, u32Spin = 0;
+
+    while ((s32)(u32Target - (u32Epoch = jf_atomic_loadU32(&pie->ie_u32Epoch))) > 0)
+    {
+        if (_tryAdvanceEpoch(pie))
+            continue;
+
+        if (u32Spin < EPOCH_SPIN_COUNT)
+        {
+            jf_atomic_pause();
+            u32Spin ++;
+            continue;
+        }
+
+        jf_atomic_fetchAddU32(&pie->ie_u32Waiter, 1);
+        jf_atomic_waitU32(&pie->ie_u32Epoch, u32Epoch, EPOCH_WAIT_TIMEOUT);
+        jf_atomic_fetchAddU32(&pie->ie_u32Waiter, (u32)-1);
+    }
+
+    return u32Ret;
+}
+
+u32 jf_epoch_barrier(jf_epoch_thread_t * pjet)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    epoch_thread_t * pet = pjet;
+
+    assert(pet->et_u32Nest == 0);
+
+    u32Ret = jf_epoch_synchronize(pet->et_pieEpoch);
+
+    /*All objects retired before the grace period can be freed.*/
+    if (u32Ret == JF_ERR_NO_ERROR)
+        _reclaimEpochThread(pet, TRUE);
+
+    return u32Ret;
+}
+
+void jf_epoch_getStat(jf_epoch_t * pje, jf_epoch_stat_t * pjes)
+{
+    internal_epoch_t * pie = pje;
+    jf_listhead_t * pjl = NULL;
+    epoch_thread_t * pet = NULL;
+
+    ol_bzero(pjes, sizeof(*pjes));
+
+    pjes->jes_bMembarrier = pie->ie_bMembarrier;
+    pjes->jes_u64Advance = jf_atomic_loadU64(&pie->ie_u64Advance);
+
+    jf_mutex_acquire(&pie->ie_jmThread);
+
+    pjes->jes_u32NumOfThread = pie->ie_u32NumOfThread;
+    pjes->jes_u64Retired = pie->ie_u64Retired;
+    pjes->jes_u64Freed = pie->ie_u64Freed;
+
+    jf_listhead_forEach(&pie->ie_jlThread, pjl)
+    {
+        pet = jf_listhead_getEntry(pjl, epoch_thread_t, et_jlThread);
+        pjes->jes_u64Retired += pet->et_u64Retired;
+        pjes->jes_u64Freed += pet->et_u64Freed;
+    }
+
+    jf_mutex_release(&pie->ie_jmThread);
+}
+
+/*------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,236 @@
+/**
+ *  @file jf_epoch.h
+ *
+ *  @brief Header file for epoch based memory reclamation common object.
+ *
+ *  @author Min Zhang
+ *
+ *  @note
+ *  -# Routines declared in this file are included in jf_epoch object.
+ *  -# Link with jf_jiukun library for memory allocation, link with jf_mutex object.
+ *  -# The thread accessing the shared objects registers to the epoch domain. The reader accesses
+ *   the shared objects in read section, the writer unlinks the object and retires it. The retired
+ *   object is freed after grace period, when all readers which may see the object have left the
+ *   read section.
+ *  -# The domain has a global epoch, the reader records the global epoch when entering the read
+ *   section. The global epoch is advanced when all readers in read section have the current
+ *   epoch. The object retired in an epoch is freed after the global epoch is advanced twice.
+ *  -# On Linux, the reader uses compiler barrier only if the membarrier system call is supported,
+ *   the memory barrier is issued on all threads when the global epoch is advanced. Otherwise, the
+ *   reader uses full memory barrier when entering the read section.
+ *  -# The retired objects are kept in the bags of the thread, the callbacks are called by the
+ *   thread retiring the objects.
+ */
+
+/*------------------------------------------------------------------------------------------------*/
+#ifndef JIUTAI_EPOCH_H
+#define JIUTAI_EPOCH_H
+
+/* --- standard C lib header files -------------------------------------------------------------- */
+
+/* --- internal header files -------------------------------------------------------------------- */
+#include "jf_basic.h"
+#include "jf_err.h"
+#include "jf_jiukun.h"
+
+/* --- constant definitions --------------------------------------------------------------------- */
+
+/** Define the epoch domain data type.
+ */
+typedef void  jf_epoch_t;
+
+/** Define the thread data type of epoch domain.
+ */
+typedef void  jf_epoch_thread_t;
+
+/* --- data structures -------------------------------------------------------------------------- */
+
+/** The callback function to free the retired object.
+ */
+typedef void (* jf_epoch_fnFree_t)(void * pObject, void * pArg);
+
+/** Define the parameter data type for creating epoch domain.
+ */
+typedef struct
+{
+    /**Number of retired objects before the thread tries to advance the global epoch, 0 means
+       the default value.*/
+    u32 jecp_u32AdvanceThreshold;
+    /**Use full memory barrier in read section even if membarrier system call is supported.*/
+    boolean_t jecp_bNoMembarrier;
+    u8 jecp_u8Reserved[11];
+} jf_epoch_create_param_t;
+
+/** Define the statistic data type of epoch domain.
+ */
+typedef struct
+{
+    /**Number of registered threads.*/
+    u32 jes_u32NumOfThread;
+    /**The membarrier system call is used.*/
+    boolean_t jes_bMembarrier;
+    u8 jes_u8Reserved[3];
+    /**Number of times the global epoch is advanced.*/
+    u64 jes_u64Advance;
+    /**Number of objects retired.*/
+    u64 jes_u64Retired;
+    /**Number of retired objects freed.*/
+    u64 jes_u64Freed;
+} jf_epoch_stat_t;
+
+/* --- functional routines ---------------------------------------------------------------------- */
+
+/** Create the epoch domain.
+ *
+ *  @param ppje [out] The epoch domain to be created and returned.
+ *  @param pjecp [in] The parameter for creating epoch domain.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ *  @retval JF_ERR_OUT_OF_MEMORY Out of memory.
+ */
+u32 jf_epoch_create(jf_epoch_t ** ppje, jf_epoch_create_param_t * pjecp);
+
+/** Destroy the epoch domain.
+ *
+ *  @note
+ *  -# The threads should be unregistered, the threads not unregistered are unregistered and the
+ *   objects retired by the threads are freed.
+ *
+ *  @param ppje [in/out] The epoch domain to be destroyed.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ */
+u32 jf_epoch_destroy(jf_epoch_t ** ppje);
+
+/** Register the calling thread to the epoch domain.
+ *
+ *  @param pje [in] The epoch domain.
+ *  @param ppjet [out] The thread data returned, it's used by the calling thread only.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ *  @retval JF_ERR_OUT_OF_MEMORY Out of memory.
+ */
+u32 jf_epoch_registerThread(jf_epoch_t * pje, jf_epoch_thread_t ** ppjet);
+
+/** Unregister the thread, the objects retired by the thread are freed after grace period.
+ *
+ *  @note
+ *  -# The thread should not be in read section.
+ *
+ *  @param ppjet [in/out] The thread data.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ */
+u32 jf_epoch_unregisterThread(jf_epoch_thread_t ** ppjet);
+
+/** Enter the read section, the shared objects accessed in read section are not freed until the
+ *  thread leaves the read section.
+ *
+ *  @note
+ *  -# The read section can be nested.
+ *  -# The read section should be short, the retired objects are not freed when the thread is in
+ *   read section.
+ *
+ *  @param pjet [in] The thread data.
+ *
+ *  @return Void.
+ */
+void jf_epoch_enter(jf_epoch_thread_t * pjet);
+
+/** Leave the read section.
+ *
+ *  @param pjet [in] The thread data.
+ *
+ *  @return Void.
+ */
+void jf_epoch_leave(jf_epoch_thread_t * pjet);
+
+/** Retire the object unlinked from the shared data structure, the object is freed with the
+ *  callback function after grace period.
+ *
+ *  @note
+ *  -# The callback function is called by the thread retiring the object, it's called in later
+ *   retire, barrier or when the thread is unregistered.
+ *  -# If the memory for the retired object is not available, the routine waits for grace period
+ *   and frees the object. If the thread is in read section, the routine returns error.
+ *
+ *  @param pjet [in] The thread data.
+ *  @param pObject [in] The object to be freed.
+ *  @param fnFree [in] The callback function to free the object.
+ *  @param pArg [in] The argument for the callback function.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ *  @retval JF_ERR_OUT_OF_MEMORY Out of memory and the thread is in read section.
+ */
+u32 jf_epoch_retire(
+    jf_epoch_thread_t * pjet, void * pObject, jf_epoch_fnFree_t fnFree, void * pArg);
+
+/** Retire the memory allocated by jf_jiukun_allocMemory(), the memory is freed by
+ *  jf_jiukun_freeMemory() after grace period.
+ *
+ *  @param pjet [in] The thread data.
+ *  @param pMemory [in] The memory to be freed.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ */
+u32 jf_epoch_retireMemory(jf_epoch_thread_t * pjet, void * pMemory);
+
+/** Retire the object allocated by jf_jiukun_allocObject(), the object is freed by
+ *  jf_jiukun_freeObject() after grace period.
+ *
+ *  @param pjet [in] The thread data.
+ *  @param pCache [in] The cache of the object.
+ *  @param pObject [in] The object to be freed.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ */
+u32 jf_epoch_retireObject(jf_epoch_thread_t * pjet, jf_jiukun_cache_t * pCache, void * pObject);
+
+/** Wait for grace period, all readers in read section when the routine is called have left the
+ *  read section when the routine returns.
+ *
+ *  @note
+ *  -# The routine should not be called in read section, it deadlocks.
+ *
+ *  @param pje [in] The epoch domain.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ */
+u32 jf_epoch_synchronize(jf_epoch_t * pje);
+
+/** Wait for grace period and free all objects retired by the thread.
+ *
+ *  @note
+ *  -# The routine should not be called in read section, it deadlocks.
+ *
+ *  @param pjet [in] The thread data.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ */
+u32 jf_epoch_barrier(jf_epoch_thread_t * pjet);
+
+/** Get the statistic of the epoch domain.
+ *
+ *  @note
+ *  -# The number of retired and freed objects of registered threads are read without lock, they
+ *   may be not accurate.
+ *
+ *  @param pje [in] The epoch domain.
+ *  @param pjes [out] The statistic.
+ *
+ *  @return Void.
+ */
+void jf_epoch_getStat(jf_epoch_t * pje, jf_epoch_stat_t * pjes);
+
+#endif /*JIUTAI_EPOCH_H*/
+
+/*------------------------------------------------------------------------------------------------*/
@@ -185,6 +185,7 @@
 #define JF_ERR_HASHTABLE_ERROR_START (JF_ERR_HASHTABLE_ERROR << JF_ERR_CODE_MODULE_SHIFT)
 
 #define JF_ERR_HASH_ENTRY_NOT_FOUND (JF_ERR_HASHTABLE_ERROR_START + 0x0)
+#define JF_ERR_HASH_ENTRY_EXIST (JF_ERR_HASHTABLE_ERROR_START + 0x1)
 
 /* conffile error */
 #define JF_ERR_CONFFILE_ERROR_START (JF_ERR_CONFFILE_ERROR << JF_ERR_CODE_MODULE_SHIFT)
@@ -226,6 +227,7 @@
 #define JF_ERR_FAIL_STOP_THREAD (JF_ERR_THREAD_ERROR_START + JF_ERR_CODE_FLAG_SYSTEM + 0x1)
 #define JF_ERR_FAIL_WAIT_THREAD_TERMINATION (JF_ERR_THREAD_ERROR_START + JF_ERR_CODE_FLAG_SYSTEM + 0x2)
 #define JF_ERR_FAIL_TERMINATE_THREAD (JF_ERR_THREAD_ERROR_START + JF_ERR_CODE_FLAG_SYSTEM + 0x3)
+#define JF_ERR_FAIL_SET_THREAD_AFFINITY (JF_ERR_THREAD_ERROR_START + JF_ERR_CODE_FLAG_SYSTEM + 0x4)
 
 /* sharedmemory */
 #define JF_ERR_SHAREDMEMORY_ERROR_START (JF_ERR_SHAREDMEMORY_ERROR << JF_ERR_CODE_MODULE_SHIFT)
@@ -330,6 +332,8 @@
 #define JF_ERR_SOCKET_CONNECTION_NOT_SETUP (JF_ERR_NETWORK_ERROR_START + 0xD)
 #define JF_ERR_SOCKET_LOCAL_CLOSED (JF_ERR_NETWORK_ERROR_START + 0xE)
 #define JF_ERR_SOCKET_POOL_EMPTY (JF_ERR_NETWORK_ERROR_START + 0xF)
+#define JF_ERR_NAME_SERVER_NOT_FOUND (JF_ERR_NETWORK_ERROR_START + 0x10)
+#define JF_ERR_INVALID_DNS_MESSAGE (JF_ERR_NETWORK_ERROR_START + 0x11)
 
 #define JF_ERR_FAIL_CREATE_SOCKET (JF_ERR_NETWORK_ERROR_START + JF_ERR_CODE_FLAG_SYSTEM + 0x0)
 #define JF_ERR_FAIL_BIND_SOCKET (JF_ERR_NETWORK_ERROR_START + JF_ERR_CODE_FLAG_SYSTEM + 0x1)
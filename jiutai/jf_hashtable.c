@@ -14,6 +14,9 @@
 #include <stdio.h>
 #include <signal.h>
 #include <string.h>
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+#endif
 
 /* --- internal header files -------------------------------------------------------------------- */
 
@@ -30,17 +33,51 @@ typedef struct hash_table_bucket
     struct hash_table_bucket *htb_phtbNext;
 } hash_table_bucket_t;
 
+/** The slot of flat hash table, the key is saved so the entry is not touched when probing.
+ */
+typedef struct hash_table_slot
+{
+    void * hts_pKey;
+    void * hts_pEntry;
+} hash_table_slot_t;
+
+/** Number of slots in a group, the control tags of a group are probed at a time.
+ */
+#define HT_GROUP_SIZE                  (16)
+
+/** Control tag of slot. The tag of full slot is the low 7 bits of hash, the high bit is set for
+ *  empty and deleted slot.
+ */
+#define HT_CTRL_EMPTY                  ((u8)0x80)
+#define HT_CTRL_DELETED                ((u8)0xFE)
+
+/** Maximum load factor of flat hash table is 7/8, deleted slots are counted.
+ */
+#define HT_FLAT_MAX_LOAD(cap)          ((cap) - (cap) / 8)
+
 typedef struct _hash_table
 {
     u32 iht_u32NumOfEntry;
+    /**Number of bucket for chained hash table, number of slot for flat hash table.*/
     u32 iht_u32Size;
     u32 iht_u32Threshold;
     u32 iht_u32Resizes;
     u32 iht_u32PrimesIndex;
-    u32 iht_u32Reserved[3];
+    u8 iht_u8Type;
+    u8 iht_u8KeyType;
+    u8 iht_u8Reserved[2];
+    /**Number of slot can be used before rehash, flat hash table only.*/
+    u32 iht_u32GrowthLeft;
+    /**Number of deleted slot, flat hash table only.*/
+    u32 iht_u32Tombstone;
 
     hash_table_bucket_t ** iht_phtbBucket;
 
+    /**Control tags of the slots, flat hash table only.*/
+    u8 * iht_pu8Ctrl;
+    /**The slot array, flat hash table only.*/
+    hash_table_slot_t * iht_phtsSlot;
+
     jf_hashtable_fnCmpKeys_t iht_fnCmpKeys;
     jf_hashtable_fnHashKey_t iht_fnHashKey;
     jf_hashtable_fnGetKeyFromEntry_t iht_fnGetKeyFromEntry;
@@ -135,45 +172,46 @@ static hash_table_bucket_t ** _getPositionOfKey(internal_hash_table_t * piht, vo
     return p;
 }
 
-static u32 _resizeHashTable(internal_hash_table_t ** ppiht)
+/** Resize the chained hash table to the next prime, the buckets are moved to the new bucket array
+ *  so the hash table itself is not changed.
+ */
+static u32 _resizeHashTable(internal_hash_table_t * piht)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
-    internal_hash_table_t *newIht;
-    olint_t i;
-    internal_hash_table_t * piht = *ppiht;
+    hash_table_bucket_t ** pphtbOld = piht->iht_phtbBucket;
+    u32 u32OldSize = piht->iht_u32Size, i;
     jf_hashtable_fnGetKeyFromEntry_t fnGetKeyFromEntry = piht->iht_fnGetKeyFromEntry;
-    jf_hashtable_create_param_t jhcp;
-
-    ol_memset(&jhcp, 0, sizeof(jf_hashtable_create_param_t));
-
-    jhcp.jhcp_u32MinSize = primes[piht->iht_u32PrimesIndex + 1];
-    jhcp.jhcp_fnCmpKeys = piht->iht_fnCmpKeys;
-    jhcp.jhcp_fnHashKey = piht->iht_fnHashKey;
-    jhcp.jhcp_fnGetKeyFromEntry = piht->iht_fnGetKeyFromEntry;
-    jhcp.jhcp_fnFreeEntry = piht->iht_fnFreeEntry;
+    u32 u32Size = primes[piht->iht_u32PrimesIndex + 1];
 
-    u32Ret = jf_hashtable_create((jf_hashtable_t **)&newIht, &jhcp);
+    u32Ret = jf_jiukun_allocMemory(
+        (void **)&piht->iht_phtbBucket, u32Size * sizeof(hash_table_bucket_t *));
     if (u32Ret == JF_ERR_NO_ERROR)
     {
-        for (i = 0; i < piht->iht_u32Size; i++)
+        ol_bzero(piht->iht_phtbBucket, u32Size * sizeof(hash_table_bucket_t *));
+        piht->iht_u32PrimesIndex ++;
+        piht->iht_u32Size = u32Size;
+        piht->iht_u32Threshold = ((u32Size << 2) + 4) / 5;
+        piht->iht_u32Resizes ++;
+
+        for (i = 0; i < u32OldSize; i++)
         {
             hash_table_bucket_t *p, *tmp;
 
-            for (p = piht->iht_phtbBucket[i]; p != NULL; p = tmp)
+            for (p = pphtbOld[i]; p != NULL; p = tmp)
             {
                 hash_table_bucket_t **position = (hash_table_bucket_t **)
-                    _getPositionOfKey(newIht, fnGetKeyFromEntry(p->htb_pEntry));
+                    _getPositionOfKey(piht, fnGetKeyFromEntry(p->htb_pEntry));
                 tmp = p->htb_phtbNext;
                 p->htb_phtbNext = *position;
                 *position = p;
-                newIht->iht_u32NumOfEntry++;
             }
         }
 
-        jf_jiukun_freeMemory((void **)&piht->iht_phtbBucket);
-        jf_jiukun_freeMemory((void **)ppiht);
-        newIht->iht_u32Resizes = piht->iht_u32Resizes + 1;
-        **ppiht = *newIht;
+        jf_jiukun_freeMemory((void **)&pphtbOld);
+    }
+    else
+    {
+        piht->iht_phtbBucket = pphtbOld;
     }
 
     return u32Ret;
@@ -189,7 +227,7 @@ static u32 _insertAtPosition(
 
     if (piht->iht_u32NumOfEntry >= piht->iht_u32Threshold)
     {
-        u32Ret = _resizeHashTable(&piht);
+        u32Ret = _resizeHashTable(piht);
     }
 
     if (u32Ret == JF_ERR_NO_ERROR)
@@ -232,6 +270,400 @@ static u32 _overwriteAtPosition(
     return u32Ret;
 }
 
+/* flat hash table routines */
+
+/** Return the index of the lowest set bit, the mask must not be 0.
+ */
+static inline u32 _getLowestBitIndex(u32 u32Mask)
+{
+#if defined(LINUX)
+    return (u32)__builtin_ctz(u32Mask);
+#else
+    u32 u32Index = 0;
+
+    while ((u32Mask & 1) == 0)
+    {
+        u32Mask >>= 1;
+        u32Index ++;
+    }
+
+    return u32Index;
+#endif
+}
+
+/** The finalizer of murmur3 hash, every bit of the key affects every bit of the hash.
+ */
+static inline u32 _mixFlatHashU32(u32 u32Key)
+{
+    u32Key ^= u32Key >> 16;
+    u32Key *= 0x85EBCA6BU;
+    u32Key ^= u32Key >> 13;
+    u32Key *= 0xC2B2AE35U;
+    u32Key ^= u32Key >> 16;
+
+    return u32Key;
+}
+
+static inline u32 _mixFlatHashU64(u64 u64Key)
+{
+    u64Key ^= u64Key >> 33;
+    u64Key *= 0xFF51AFD7ED558CCDULL;
+    u64Key ^= u64Key >> 33;
+    u64Key *= 0xC4CEB9FE1A85EC53ULL;
+    u64Key ^= u64Key >> 33;
+
+    return (u32)u64Key;
+}
+
+/** FNV-1a hash of string, the low bits used by tag are weak so the hash is mixed.
+ */
+static inline u32 _hashFlatString(const olchar_t * pstrKey)
+{
+    u32 u32Hash = 2166136261U;
+
+    while (*pstrKey != '\0')
+    {
+        u32Hash ^= (u8)*pstrKey;
+        u32Hash *= 16777619U;
+        pstrKey ++;
+    }
+
+    return _mixFlatHashU32(u32Hash);
+}
+
+static inline u32 _hashFlatKey(internal_hash_table_t * piht, void * pKey)
+{
+    u32 u32Hash = 0;
+
+    switch (piht->iht_u8KeyType)
+    {
+    case JF_HASHTABLE_KEY_TYPE_U32:
+        u32Hash = _mixFlatHashU32((u32)(ulong)pKey);
+        break;
+    case JF_HASHTABLE_KEY_TYPE_U64:
+    case JF_HASHTABLE_KEY_TYPE_POINTER:
+        u32Hash = _mixFlatHashU64((u64)(ulong)pKey);
+        break;
+    case JF_HASHTABLE_KEY_TYPE_STRING:
+        u32Hash = _hashFlatString(pKey);
+        break;
+    default:
+        /*The hash from user may be weak, e.g. the integer key itself.*/
+        u32Hash = _mixFlatHashU32((u32)piht->iht_fnHashKey(pKey));
+        break;
+    }
+
+    return u32Hash;
+}
+
+static inline boolean_t _isFlatKeyEqual(internal_hash_table_t * piht, void * pKey1, void * pKey2)
+{
+    if (pKey1 == pKey2)
+        return TRUE;
+    else if (piht->iht_u8KeyType == JF_HASHTABLE_KEY_TYPE_STRING)
+        return (ol_strcmp(pKey1, pKey2) == 0);
+    else if (piht->iht_u8KeyType == JF_HASHTABLE_KEY_TYPE_CALLBACK)
+        return (piht->iht_fnCmpKeys(pKey1, pKey2) == 0);
+
+    return FALSE;
+}
+
+/** Return the bit mask of the slots in the group with the control tag.
+ */
+static inline u32 _matchFlatGroup(const u8 * pu8Ctrl, u8 u8Tag)
+{
+#if defined(__SSE2__)
+    __m128i group = _mm_loadu_si128((const __m128i *)pu8Ctrl);
+
+    return (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((olchar_t)u8Tag)));
+#else
+    u32 u32Mask = 0, u32Index;
+
+    for (u32Index = 0; u32Index < HT_GROUP_SIZE; u32Index ++)
+        if (pu8Ctrl[u32Index] == u8Tag)
+            u32Mask |= 1U << u32Index;
+
+    return u32Mask;
+#endif
+}
+
+/** Return the bit mask of the empty and deleted slots in the group.
+ */
+static inline u32 _matchFlatGroupFree(const u8 * pu8Ctrl)
+{
+#if defined(__SSE2__)
+    return (u32)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)pu8Ctrl));
+#else
+    u32 u32Mask = 0, u32Index;
+
+    for (u32Index = 0; u32Index < HT_GROUP_SIZE; u32Index ++)
+        if (pu8Ctrl[u32Index] & HT_CTRL_EMPTY)
+            u32Mask |= 1U << u32Index;
+
+    return u32Mask;
+#endif
+}
+
+/** Find the slot with the key. The groups are probed with triangular numbers, all groups are
+ *  visited as the number of groups is power of two.
+ *
+ *  @return The index of slot or -1 if the key is not found.
+ */
+static olint_t _findFlatSlot(internal_hash_table_t * piht, void * pKey, u32 u32Hash)
+{
+    u32 u32GroupMask = piht->iht_u32Size / HT_GROUP_SIZE - 1;
+    u32 u32Group = (u32Hash >> 7) & u32GroupMask, u32Step, u32Mask, u32Index;
+    u8 u8Tag = (u8)(u32Hash & 0x7F);
+    u8 * pu8Ctrl;
+
+    for (u32Step = 0; u32Step <= u32GroupMask; u32Step ++)
+    {
+        pu8Ctrl = piht->iht_pu8Ctrl + u32Group * HT_GROUP_SIZE;
+
+        for (u32Mask = _matchFlatGroup(pu8Ctrl, u8Tag); u32Mask != 0; u32Mask &= u32Mask - 1)
+        {
+            u32Index = u32Group * HT_GROUP_SIZE + _getLowestBitIndex(u32Mask);
+            if (_isFlatKeyEqual(piht, pKey, piht->iht_phtsSlot[u32Index].hts_pKey))
+                return (olint_t)u32Index;
+        }
+
+        /*The probe stops at the group with empty slot.*/
+        if (_matchFlatGroup(pu8Ctrl, HT_CTRL_EMPTY) != 0)
+            break;
+
+        u32Group = (u32Group + u32Step + 1) & u32GroupMask;
+    }
+
+    return -1;
+}
+
+/** Find the first empty or deleted slot in the probe sequence of the hash.
+ */
+static u32 _findFlatFreeSlot(u8 * pu8Ctrl, u32 u32Size, u32 u32Hash)
+{
+    u32 u32GroupMask = u32Size / HT_GROUP_SIZE - 1;
+    u32 u32Group = (u32Hash >> 7) & u32GroupMask, u32Step = 0, u32Mask;
+
+    /*There is always free slot as the load factor is less than 1.*/
+    while ((u32Mask = _matchFlatGroupFree(pu8Ctrl + u32Group * HT_GROUP_SIZE)) == 0)
+    {
+        u32Step ++;
+        u32Group = (u32Group + u32Step) & u32GroupMask;
+    }
+
+    return u32Group * HT_GROUP_SIZE + _getLowestBitIndex(u32Mask);
+}
+
+/** Rehash the flat hash table to the new size, the deleted slots are purged.
+ */
+static u32 _rehashFlatHashTable(internal_hash_table_t * piht, u32 u32Size)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u8 * pu8Ctrl = NULL;
+    hash_table_slot_t * phts = NULL;
+    u32 u32Index, u32Slot;
+
+    u32Ret = jf_jiukun_allocMemory((void **)&pu8Ctrl, u32Size);
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = jf_jiukun_allocMemory((void **)&phts, u32Size * sizeof(hash_table_slot_t));
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ol_memset(pu8Ctrl, HT_CTRL_EMPTY, u32Size);
+
+        for (u32Index = 0; u32Index < piht->iht_u32Size; u32Index ++)
+        {
+            if (piht->iht_pu8Ctrl[u32Index] & HT_CTRL_EMPTY)
+                continue;
+
+            u32Slot = _findFlatFreeSlot(
+                pu8Ctrl, u32Size, _hashFlatKey(piht, piht->iht_phtsSlot[u32Index].hts_pKey));
+            pu8Ctrl[u32Slot] = piht->iht_pu8Ctrl[u32Index];
+            phts[u32Slot] = piht->iht_phtsSlot[u32Index];
+        }
+
+        if (piht->iht_pu8Ctrl != NULL)
+        {
+            jf_jiukun_freeMemory((void **)&piht->iht_pu8Ctrl);
+            jf_jiukun_freeMemory((void **)&piht->iht_phtsSlot);
+            piht->iht_u32Resizes ++;
+        }
+
+        piht->iht_pu8Ctrl = pu8Ctrl;
+        piht->iht_phtsSlot = phts;
+        piht->iht_u32Size = u32Size;
+        piht->iht_u32GrowthLeft = HT_FLAT_MAX_LOAD(u32Size) - piht->iht_u32NumOfEntry;
+        piht->iht_u32Tombstone = 0;
+    }
+    else if (pu8Ctrl != NULL)
+    {
+        jf_jiukun_freeMemory((void **)&pu8Ctrl);
+    }
+
+    return u32Ret;
+}
+
+static u32 _insertFlatSlot(
+    internal_hash_table_t * piht, void * pKey, u32 u32Hash, void * pEntry)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Size = piht->iht_u32Size, u32Slot;
+
+    if (piht->iht_u32GrowthLeft == 0)
+    {
+        /*Double the size if the table is more than half full, otherwise purge deleted slots.*/
+        if (piht->iht_u32NumOfEntry >= HT_FLAT_MAX_LOAD(u32Size) / 2)
+            u32Size <<= 1;
+
+        u32Ret = _rehashFlatHashTable(piht, u32Size);
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        u32Slot = _findFlatFreeSlot(piht->iht_pu8Ctrl, piht->iht_u32Size, u32Hash);
+
+        if (piht->iht_pu8Ctrl[u32Slot] == HT_CTRL_DELETED)
+            piht->iht_u32Tombstone --;
+        else
+            piht->iht_u32GrowthLeft --;
+
+        piht->iht_pu8Ctrl[u32Slot] = (u8)(u32Hash & 0x7F);
+        piht->iht_phtsSlot[u32Slot].hts_pKey = pKey;
+        piht->iht_phtsSlot[u32Slot].hts_pEntry = pEntry;
+        piht->iht_u32NumOfEntry ++;
+    }
+
+    return u32Ret;
+}
+
+/** Erase the slot. The slot is set to empty if there is empty slot in the group as no probe passes
+ *  the group, otherwise it's set to deleted.
+ */
+static void _eraseFlatSlot(internal_hash_table_t * piht, u32 u32Slot)
+{
+    u8 * pu8Group = piht->iht_pu8Ctrl + (u32Slot & ~(HT_GROUP_SIZE - 1));
+
+    if (_matchFlatGroup(pu8Group, HT_CTRL_EMPTY) != 0)
+    {
+        piht->iht_pu8Ctrl[u32Slot] = HT_CTRL_EMPTY;
+        piht->iht_u32GrowthLeft ++;
+    }
+    else
+    {
+        piht->iht_pu8Ctrl[u32Slot] = HT_CTRL_DELETED;
+        piht->iht_u32Tombstone ++;
+    }
+
+    piht->iht_phtsSlot[u32Slot].hts_pKey = NULL;
+    piht->iht_phtsSlot[u32Slot].hts_pEntry = NULL;
+    piht->iht_u32NumOfEntry --;
+}
+
+static u32 _putFlatEntry(internal_hash_table_t * piht, void * pEntry, boolean_t bOverwrite)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    void * pKey = piht->iht_fnGetKeyFromEntry(pEntry);
+    u32 u32Hash = _hashFlatKey(piht, pKey);
+    olint_t nSlot = _findFlatSlot(piht, pKey, u32Hash);
+
+    if (nSlot < 0)
+    {
+        u32Ret = _insertFlatSlot(piht, pKey, u32Hash, pEntry);
+    }
+    else if (bOverwrite)
+    {
+        piht->iht_fnFreeEntry(&piht->iht_phtsSlot[nSlot].hts_pEntry);
+        piht->iht_phtsSlot[nSlot].hts_pKey = pKey;
+        piht->iht_phtsSlot[nSlot].hts_pEntry = pEntry;
+    }
+
+    return u32Ret;
+}
+
+static u32 _removeFlatEntry(internal_hash_table_t * piht, void * pEntry)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    void * pKey = piht->iht_fnGetKeyFromEntry(pEntry);
+    olint_t nSlot = _findFlatSlot(piht, pKey, _hashFlatKey(piht, pKey));
+    void * pOld;
+
+    if (nSlot >= 0)
+    {
+        pOld = piht->iht_phtsSlot[nSlot].hts_pEntry;
+        _eraseFlatSlot(piht, (u32)nSlot);
+        piht->iht_fnFreeEntry(&pOld);
+    }
+    else
+    {
+        u32Ret = JF_ERR_HASH_ENTRY_NOT_FOUND;
+    }
+
+    return u32Ret;
+}
+
+static inline hash_table_slot_t * _getFlatSlotOfKey(internal_hash_table_t * piht, void * pKey)
+{
+    olint_t nSlot = _findFlatSlot(piht, pKey, _hashFlatKey(piht, pKey));
+
+    return (nSlot < 0) ? NULL : &piht->iht_phtsSlot[nSlot];
+}
+
+/** Get the number of groups probed to find the slot.
+ */
+static u32 _getFlatProbeLength(internal_hash_table_t * piht, u32 u32Slot)
+{
+    u32 u32GroupMask = piht->iht_u32Size / HT_GROUP_SIZE - 1;
+    u32 u32Hash = _hashFlatKey(piht, piht->iht_phtsSlot[u32Slot].hts_pKey);
+    u32 u32Group = (u32Hash >> 7) & u32GroupMask, u32Step = 0;
+
+    while ((u32Group != u32Slot / HT_GROUP_SIZE) && (u32Step <= u32GroupMask))
+    {
+        u32Step ++;
+        u32Group = (u32Group + u32Step) & u32GroupMask;
+    }
+
+    return u32Step + 1;
+}
+
+static void _getFlatStat(internal_hash_table_t * piht, jf_hashtable_stat_t * stat)
+{
+    u32 u32Index, u32Probe, u32InGroup = 0;
+
+    for (u32Index = 0; u32Index < piht->iht_u32Size; u32Index ++)
+    {
+        if ((u32Index % HT_GROUP_SIZE) == 0)
+            u32InGroup = 0;
+
+        if (piht->iht_pu8Ctrl[u32Index] & HT_CTRL_EMPTY)
+            continue;
+
+        u32InGroup ++;
+        if (stat->jhs_u32BucketIndexWithMaxEntries < u32InGroup)
+            stat->jhs_u32BucketIndexWithMaxEntries = u32InGroup;
+
+        u32Probe = _getFlatProbeLength(piht, u32Index);
+        if (u32Probe > 1)
+            stat->jhs_u32Collisions ++;
+        if (stat->jhs_u32MaxProbeLength < u32Probe)
+            stat->jhs_u32MaxProbeLength = u32Probe;
+        stat->jhs_u32TotalProbeLength += u32Probe;
+    }
+
+    stat->jhs_u32NumOfTombstone = piht->iht_u32Tombstone;
+}
+
+static void _incrementFlatIterator(jf_hashtable_iterator_t * pIterator)
+{
+    internal_hash_table_t * piht = (internal_hash_table_t *)pIterator->jhi_htTable;
+    olint_t i = pIterator->jhi_nPos + 1;
+
+    while ((i < piht->iht_u32Size) && (piht->iht_pu8Ctrl[i] & HT_CTRL_EMPTY))
+        i ++;
+
+    pIterator->jhi_nPos = i;
+    pIterator->jhi_pCursor = (i < piht->iht_u32Size) ? &piht->iht_phtsSlot[i] : NULL;
+}
+
 /* --- public routine section ------------------------------------------------------------------- */
 
 u32 jf_hashtable_create(jf_hashtable_t ** ppht, jf_hashtable_create_param_t * pjhcp)
@@ -242,10 +674,15 @@ u32 jf_hashtable_create(jf_hashtable_t ** ppht, jf_hashtable_create_param_t * pj
 
     assert((ppht != NULL) && (pjhcp != NULL));
 
+    assert((pjhcp->jhcp_u8Type == JF_HASHTABLE_TYPE_FLAT) ||
+           (pjhcp->jhcp_u8KeyType == JF_HASHTABLE_KEY_TYPE_CALLBACK));
+
     u32Ret = jf_jiukun_allocMemory((void **)&piht, sizeof(internal_hash_table_t));
     if (u32Ret == JF_ERR_NO_ERROR)
     {
         ol_memset(piht, 0, sizeof(internal_hash_table_t));
+        piht->iht_u8Type = pjhcp->jhcp_u8Type;
+        piht->iht_u8KeyType = pjhcp->jhcp_u8KeyType;
 
         while (pjhcp->jhcp_u32MinSize > primes[u32PrimesIndex])
             u32PrimesIndex++;
@@ -265,14 +702,28 @@ u32 jf_hashtable_create(jf_hashtable_t ** ppht, jf_hashtable_create_param_t * pj
         piht->iht_u32Threshold = (((piht->iht_u32Size) << 2) + 4) / 5;
         piht->iht_u32Resizes = 0;
 
-        u32Ret = jf_jiukun_allocMemory(
-            (void **)&(piht->iht_phtbBucket), piht->iht_u32Size * sizeof(hash_table_bucket_t *));
+        if (piht->iht_u8Type == JF_HASHTABLE_TYPE_FLAT)
+        {
+            u32 u32Size = HT_GROUP_SIZE;
+
+            while (HT_FLAT_MAX_LOAD(u32Size) < pjhcp->jhcp_u32MinSize)
+                u32Size <<= 1;
+
+            piht->iht_u32Size = 0;
+            u32Ret = _rehashFlatHashTable(piht, u32Size);
+        }
+        else
+        {
+            u32Ret = jf_jiukun_allocMemory(
+                (void **)&(piht->iht_phtbBucket),
+                piht->iht_u32Size * sizeof(hash_table_bucket_t *));
+            if (u32Ret == JF_ERR_NO_ERROR)
+                ol_bzero(piht->iht_phtbBucket, piht->iht_u32Size * sizeof(hash_table_bucket_t *));
+        }
     }
 
     if (u32Ret == JF_ERR_NO_ERROR)
     {
-        ol_bzero(piht->iht_phtbBucket, piht->iht_u32Size * sizeof(hash_table_bucket_t *));
-
         *ppht = piht;
     }
     else if (piht != NULL)
@@ -312,6 +763,16 @@ u32 jf_hashtable_destroy(jf_hashtable_t ** ppht)
         jf_jiukun_freeMemory((void **)&(piht->iht_phtbBucket));
     }
 
+    if (piht->iht_pu8Ctrl != NULL)
+    {
+        for (i = 0; i < piht->iht_u32Size; i++)
+            if (! (piht->iht_pu8Ctrl[i] & HT_CTRL_EMPTY))
+                fnFreeEntry(&(piht->iht_phtsSlot[i].hts_pEntry));
+
+        jf_jiukun_freeMemory((void **)&(piht->iht_pu8Ctrl));
+        jf_jiukun_freeMemory((void **)&(piht->iht_phtsSlot));
+    }
+
     jf_jiukun_freeMemory((void **)ppht);
 
     return u32Ret;
@@ -321,9 +782,12 @@ u32 jf_hashtable_insertEntry(jf_hashtable_t * pht, void * pEntry)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
     internal_hash_table_t * piht = (internal_hash_table_t *)pht;
-    hash_table_bucket_t **position =
-        _getPositionOfKey(piht, (piht->iht_fnGetKeyFromEntry) (pEntry));
+    hash_table_bucket_t **position;
+
+    if (piht->iht_u8Type == JF_HASHTABLE_TYPE_FLAT)
+        return _putFlatEntry(piht, pEntry, FALSE);
 
+    position = _getPositionOfKey(piht, (piht->iht_fnGetKeyFromEntry) (pEntry));
     if (*position == NULL)
         u32Ret = _insertAtPosition(pht, position, pEntry);
 
@@ -335,9 +799,12 @@ u32 jf_hashtable_removeEntry(jf_hashtable_t * pht, void * pEntry)
     u32 u32Ret = JF_ERR_NO_ERROR;
     internal_hash_table_t * piht = (internal_hash_table_t *)pht;
     hash_table_bucket_t * tmp;
-    hash_table_bucket_t ** position =
-        _getPositionOfKey(piht, (piht->iht_fnGetKeyFromEntry) (pEntry));
+    hash_table_bucket_t ** position;
 
+    if (piht->iht_u8Type == JF_HASHTABLE_TYPE_FLAT)
+        return _removeFlatEntry(piht, pEntry);
+
+    position = _getPositionOfKey(piht, (piht->iht_fnGetKeyFromEntry) (pEntry));
     tmp = *position;
     if (tmp != NULL)
     {
@@ -358,9 +825,12 @@ u32 jf_hashtable_overwriteEntry(jf_hashtable_t * pht, void * pEntry)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
     internal_hash_table_t * piht = (internal_hash_table_t *)pht;
-    hash_table_bucket_t ** position =
-        _getPositionOfKey(piht, (piht->iht_fnGetKeyFromEntry) (pEntry));
+    hash_table_bucket_t ** position;
+
+    if (piht->iht_u8Type == JF_HASHTABLE_TYPE_FLAT)
+        return _putFlatEntry(piht, pEntry, TRUE);
 
+    position = _getPositionOfKey(piht, (piht->iht_fnGetKeyFromEntry) (pEntry));
     if (*position)
     {
         u32Ret = _overwriteAtPosition(piht, position, pEntry);
@@ -377,8 +847,21 @@ u32 jf_hashtable_getEntry(jf_hashtable_t * pht, void * pKey, void ** ppEntry)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
     internal_hash_table_t * piht = (internal_hash_table_t *)pht;
-    hash_table_bucket_t ** bucket = _getPositionOfKey(piht, pKey);
+    hash_table_bucket_t ** bucket;
+    hash_table_slot_t * phts;
 
+    if (piht->iht_u8Type == JF_HASHTABLE_TYPE_FLAT)
+    {
+        phts = _getFlatSlotOfKey(piht, pKey);
+        if (phts == NULL)
+            u32Ret = JF_ERR_HASH_ENTRY_NOT_FOUND;
+        else
+            *ppEntry = phts->hts_pEntry;
+
+        return u32Ret;
+    }
+
+    bucket = _getPositionOfKey(piht, pKey);
     if ((*bucket) == NULL)
         u32Ret = JF_ERR_HASH_ENTRY_NOT_FOUND;
     else
@@ -391,8 +874,12 @@ boolean_t jf_hashtable_isKeyInTable(jf_hashtable_t * pht, void * pKey)
 {
     boolean_t bRet = FALSE;
     internal_hash_table_t * piht = (internal_hash_table_t *)pht;
-    hash_table_bucket_t **position = _getPositionOfKey(piht, pKey);
+    hash_table_bucket_t **position;
+
+    if (piht->iht_u8Type == JF_HASHTABLE_TYPE_FLAT)
+        return (_getFlatSlotOfKey(piht, pKey) != NULL);
 
+    position = _getPositionOfKey(piht, pKey);
     if (*position != NULL)
         bRet = TRUE;
 
@@ -403,9 +890,12 @@ boolean_t jf_hashtable_isEntryInTable(jf_hashtable_t * pht, void * pEntry)
 {
     boolean_t bRet = FALSE;
     internal_hash_table_t * piht = (internal_hash_table_t *)pht;
-    hash_table_bucket_t **position =
-        _getPositionOfKey(piht, (piht->iht_fnGetKeyFromEntry) (pEntry));
+    hash_table_bucket_t **position;
 
+    if (piht->iht_u8Type == JF_HASHTABLE_TYPE_FLAT)
+        return (_getFlatSlotOfKey(piht, piht->iht_fnGetKeyFromEntry(pEntry)) != NULL);
+
+    position = _getPositionOfKey(piht, (piht->iht_fnGetKeyFromEntry) (pEntry));
     if (*position != NULL)
         bRet = TRUE;
 
@@ -424,6 +914,18 @@ void jf_hashtable_getStat(jf_hashtable_t * pht, jf_hashtable_stat_t * stat)
     internal_hash_table_t * piht = (internal_hash_table_t *)pht;
     olint_t collisions = 0, maxentries = 0, i;
 
+    ol_bzero(stat, sizeof(*stat));
+
+    stat->jhs_u32NumOfEntry = piht->iht_u32NumOfEntry;
+    stat->jhs_u32Size = piht->iht_u32Size;
+    stat->jhs_u32CountOfResizeOp = piht->iht_u32Resizes;
+
+    if (piht->iht_u8Type == JF_HASHTABLE_TYPE_FLAT)
+    {
+        _getFlatStat(piht, stat);
+        return;
+    }
+
     for (i = 0; i < piht->iht_u32Size; i++)
     {
         hash_table_bucket_t *p = piht->iht_phtbBucket[i];
@@ -432,8 +934,12 @@ void jf_hashtable_getStat(jf_hashtable_t * pht, jf_hashtable_stat_t * stat)
         {
             olint_t j = 1;
 
+            stat->jhs_u32TotalProbeLength ++;
             for (p = p->htb_phtbNext; p != NULL; p = p->htb_phtbNext)
+            {
                 j++;
+                stat->jhs_u32TotalProbeLength += j;
+            }
 
             if (maxentries < j)
                 maxentries = j;
@@ -442,11 +948,9 @@ void jf_hashtable_getStat(jf_hashtable_t * pht, jf_hashtable_stat_t * stat)
         }
     }
 
-    stat->jhs_u32NumOfEntry = piht->iht_u32NumOfEntry;
-    stat->jhs_u32Size = piht->iht_u32Size;
     stat->jhs_u32Collisions = collisions;
     stat->jhs_u32BucketIndexWithMaxEntries = maxentries;
-    stat->jhs_u32CountOfResizeOp = piht->iht_u32Resizes;
+    stat->jhs_u32MaxProbeLength = maxentries;
 }
 
 /* iterator routines */
@@ -466,6 +970,12 @@ void jf_hashtable_incrementIterator(jf_hashtable_iterator_t * pIterator)
 {
     hash_table_bucket_t * current = (hash_table_bucket_t *)pIterator->jhi_pCursor;
 
+    if (((internal_hash_table_t *)pIterator->jhi_htTable)->iht_u8Type == JF_HASHTABLE_TYPE_FLAT)
+    {
+        _incrementFlatIterator(pIterator);
+        return;
+    }
+
     /*Check the next bucket ot the bucket.*/
     if ((current != NULL) && (current->htb_phtbNext != NULL))
     {
@@ -517,6 +1027,9 @@ void * jf_hashtable_getEntryFromIterator(jf_hashtable_iterator_t * pIterator)
 
     if (bucket == NULL)
         return NULL;
+    else if (((internal_hash_table_t *)pIterator->jhi_htTable)->iht_u8Type ==
+             JF_HASHTABLE_TYPE_FLAT)
+        return ((hash_table_slot_t *)pIterator->jhi_pCursor)->hts_pEntry;
     else
         return bucket->htb_pEntry;
 }
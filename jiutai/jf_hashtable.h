@@ -10,6 +10,9 @@
  *  -# This is an implementation of a general hash table. It assumes that keys for entry stored in
  *   the hash table can be extracted from the entry.
  *  -# Link with jf_jiukun library for memory allocation.
+ *  -# The chained hash table allocates a bucket for each entry. The flat hash table stores the
+ *   entries in a power of two slot array with one byte control tag per slot, 16 tags are probed
+ *   at a time with SSE2 if it's available.
  */
 
 /*------------------------------------------------------------------------------------------------*/
@@ -46,13 +49,45 @@ typedef u32 (* jf_hashtable_fnFreeEntry_t) (void ** ppEntry);
 
 /* --- data structures -------------------------------------------------------------------------- */
 
+/** Define the hash table type.
+ */
+typedef enum jf_hashtable_type
+{
+    /**Chained buckets, prime sized.*/
+    JF_HASHTABLE_TYPE_CHAIN = 0,
+    /**Open addressing, power of two sized, entries are stored inline.*/
+    JF_HASHTABLE_TYPE_FLAT,
+} jf_hashtable_type_t;
+
+/** Define the key type of flat hash table. The key is returned by the callback function to get key
+ *  from entry. The callback functions to hash and compare key are not used if the key type is not
+ *  callback.
+ */
+typedef enum jf_hashtable_key_type
+{
+    /**The key is hashed and compared by callback functions.*/
+    JF_HASHTABLE_KEY_TYPE_CALLBACK = 0,
+    /**The key is u32 integer casted to pointer.*/
+    JF_HASHTABLE_KEY_TYPE_U32,
+    /**The key is u64 integer casted to pointer, 64bit only.*/
+    JF_HASHTABLE_KEY_TYPE_U64,
+    /**The key is pointer, the pointer is compared, not the content.*/
+    JF_HASHTABLE_KEY_TYPE_POINTER,
+    /**The key is zero terminated string.*/
+    JF_HASHTABLE_KEY_TYPE_STRING,
+} jf_hashtable_key_type_t;
+
 /** Define the parameter data type for creating hash table.
  */
 typedef struct
 {
     /**Minimal number of entry by estimation.*/
     u32 jhcp_u32MinSize;
-    u32 jhcp_u32Reserved;
+    /**Hash table type, chain by default.*/
+    u8 jhcp_u8Type;
+    /**Key type for flat hash table, callback by default.*/
+    u8 jhcp_u8KeyType;
+    u8 jhcp_u8Reserved[2];
     /**Callback function to compare key.*/
     jf_hashtable_fnCmpKeys_t jhcp_fnCmpKeys;
     /**Callback function to hash key.*/
@@ -78,6 +113,13 @@ typedef struct
     u32 jhs_u32BucketIndexWithMaxEntries;
     /**Count of resize operation.*/
     u32 jhs_u32CountOfResizeOp;
+    /**Maximum probe length. The probe length of an entry is the number of buckets visited in the
+       chain, or the number of slot groups probed in flat hash table to find the entry.*/
+    u32 jhs_u32MaxProbeLength;
+    /**Total probe length of all entries, divided by number of entry for the average.*/
+    u32 jhs_u32TotalProbeLength;
+    /**Number of deleted slots which are not reused yet, flat hash table only.*/
+    u32 jhs_u32NumOfTombstone;
 } jf_hashtable_stat_t;
 
 /** The definition of this structure is placed here because it should be possible to allocate an
@@ -87,9 +129,9 @@ typedef struct
 {
     /**The hash table this iterator attached to.*/
     jf_hashtable_t * jhi_htTable;
-    /**The position of the hash table bucket array.*/
+    /**The position of the hash table bucket array or slot array.*/
     olint_t jhi_nPos;
-    /**The cursor to the hash table bucket.*/
+    /**The cursor to the hash table bucket or slot.*/
     void * jhi_pCursor;
 } jf_hashtable_iterator_t;
 
@@ -18,6 +18,7 @@
 
 /* --- internal header files -------------------------------------------------------------------- */
 #include "jf_basic.h"
+#include "jf_jiukun.h"
 
 #undef HTTPPARSERAPI
 #undef HTTPPARSERCALL
@@ -117,6 +118,8 @@ typedef struct jf_httpparser_packet_header
     jf_httpparser_packet_header_field_t * jhph_pjhphfFirst;
     /**The last field of the http packet header.*/
     jf_httpparser_packet_header_field_t * jhph_pjhphfLast;
+    /**The arena the packet header is allocated from, NULL if it's allocated from jiukun.*/
+    jf_jiukun_arena_t * jhph_pjjaArena;
 } jf_httpparser_packet_header_t;
 
 /* --- functional routines ---------------------------------------------------------------------- */
@@ -146,6 +149,26 @@ HTTPPARSERAPI u32 HTTPPARSERCALL jf_httpparser_destroyPacketHeader(
 HTTPPARSERAPI u32 HTTPPARSERCALL jf_httpparser_parsePacketHeader(
     jf_httpparser_packet_header_t ** ppHeader, olchar_t * pstrBuf, olsize_t sOffset, olsize_t sBuf);
 
+/** Parses the HTTP headers from a buffer, into a packetheader structure allocated from arena.
+ *
+ *  @note
+ *  -# The packet header, the header fields and the strings set or added to the packet header
+ *   later are allocated from the arena.
+ *  -# jf_httpparser_destroyPacketHeader() frees nothing for the packet header, the memory is
+ *   released when the arena is reset or destroyed.
+ *
+ *  @param ppHeader [out] The parsed packet header structure.
+ *  @param pstrBuf [in] The buffer to parse.
+ *  @param sOffset [in] The offset of the buffer to start parsing.
+ *  @param sBuf [in] The length of the buffer to parse.
+ *  @param pArena [in] The arena to allocate memory from.
+ *
+ *  @return The error code.
+ */
+HTTPPARSERAPI u32 HTTPPARSERCALL jf_httpparser_parsePacketHeaderInArena(
+    jf_httpparser_packet_header_t ** ppHeader, olchar_t * pstrBuf, olsize_t sOffset, olsize_t sBuf,
+    jf_jiukun_arena_t * pArena);
+
 /** Clones a packet header.
  *
  *  @note jf_httpparser_parsePacketHeader() does not copy any data, the data will become invalid
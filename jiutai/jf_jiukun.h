@@ -47,6 +47,11 @@
 #define JF_JIUKUN_PAGE_SIZE          (1 << JF_JIUKUN_PAGE_SHIFT)
 #define JF_JIUKUN_PAGE_MASK          (~(JF_JIUKUN_PAGE_SIZE - 1))
 
+/** The size of cache line, objects are aligned to it if the cache is created with
+ *  JF_JIUKUN_CACHE_CREATE_FLAG_HWCACHE_ALIGN.
+ */
+#define JF_JIUKUN_CACHE_LINE_SIZE    (64)
+
 /** Maximum order for page allocation, maximum pages in one pool is (1 << JF_JIUKUN_MAX_PAGE_ORDER).
  */
 #define JF_JIUKUN_MAX_PAGE_ORDER     (14)
@@ -56,6 +61,10 @@
 #define JF_JIUKUN_MAX_MEMORY_ORDER   (23)
 #define JF_JIUKUN_MAX_MEMORY_SIZE    (1 << JF_JIUKUN_MAX_MEMORY_ORDER)
 
+/** The default minimum order of free page block returned to OS by reaping.
+ */
+#define JF_JIUKUN_DEFAULT_RELEASE_ORDER   (4)
+
 /** The maximum object size createJiukunCache() can specify.
  */
 #define JF_JIUKUN_MAX_OBJECT_ORDER   (20)
@@ -71,10 +80,43 @@ typedef struct
     olsize_t jjip_sPool;
     /**No grow when the initial pool is full.*/
     boolean_t jjip_bNoGrow;
-    u8 jjip_u8Reserved[3];
-    u32 jjip_u32Reserved[7];
+    /**Back the pool with huge pages, explicit huge page is tried first, then transparent huge
+       page. Linux only.*/
+    boolean_t jjip_bHugePage;
+    /**Create pool per NUMA node, the memory is allocated from the pool of the caller's node.
+       Linux only.*/
+    boolean_t jjip_bNuma;
+    /**No per-CPU page cache, all pages are allocated from the buddy free lists with the global
+       lock.*/
+    boolean_t jjip_bNoPageCache;
+    /**Sample one allocation per the bytes on average for profiling, 0 to disable profiling. The
+       profile is dumped with jf_jiukun_dumpProfile().*/
+    u32 jjip_u32ProfileSample;
+    /**Interval of the background reaping in millisecond, 0 to disable the reaping thread. The
+       reaping can be run with jf_jiukun_reap() instead, e.g. by a timer of network chain.*/
+    u32 jjip_u32ReapInterval;
+    /**Number of free slabs kept in each cache after reaping.*/
+    u32 jjip_u32ReapFreeSlab;
+    /**Minimum order of free page block returned to OS after reaping, a small order returns more
+       memory with more system calls. 0 for JF_JIUKUN_DEFAULT_RELEASE_ORDER.*/
+    u32 jjip_u32ReleaseOrder;
+    u32 jjip_u32Reserved[3];
 } jf_jiukun_init_param_t;
 
+/** Statistics of reaping.
+ */
+typedef struct
+{
+    /**Number of reaping.*/
+    u64 jjrs_u64Reap;
+    /**Number of free slabs destroyed.*/
+    u64 jjrs_u64SlabReaped;
+    /**Bytes of free pages returned to OS, the page block coalesced with a returned buddy is
+       counted again when it's returned.*/
+    u64 jjrs_u64ByteReleased;
+    u64 jjrs_u64Reserved[5];
+} jf_jiukun_reap_stat_t;
+
 /** Jiukun cache data structure.
  */
 typedef void  jf_jiukun_cache_t;
@@ -96,16 +138,40 @@ typedef enum jf_jiukun_cache_create_flag
     JF_JIUKUN_CACHE_CREATE_FLAG_ZERO,
     /**Wait if memory fails to be allocated.*/
     JF_JIUKUN_CACHE_CREATE_FLAG_WAIT,
+    /**Align objects to cache line, the small object is aligned to a fraction of cache line so it
+       doesn't cross the line.*/
+    JF_JIUKUN_CACHE_CREATE_FLAG_HWCACHE_ALIGN,
+    /**Pad objects to the multiple of cache line, an object doesn't share cache line with other
+       objects. It's for the object written by different threads to avoid false sharing.*/
+    JF_JIUKUN_CACHE_CREATE_FLAG_PAD,
+    /**Color slabs, the objects in different slabs start at different offsets so they are spread
+       over cache sets.*/
+    JF_JIUKUN_CACHE_CREATE_FLAG_COLOR,
+    /**Share the cache with the same name. The existing cache is returned with reference count
+       increased, the cache is destroyed when it's destroyed by all the creators.*/
+    JF_JIUKUN_CACHE_CREATE_FLAG_SHARED,
 } jf_jiukun_cache_create_flag_t;
 
+/** The callback function to construct the object when the object is added to the cache.
+ */
+typedef void (* jf_jiukun_fnConstructObject_t)(void * pObj);
+
+/** The callback function to destruct the object when the object is removed from the cache.
+ */
+typedef void (* jf_jiukun_fnDestructObject_t)(void * pObj);
+
 typedef struct
 {
     olchar_t * jjccp_pstrName;
     u8 jjccp_u8Reserved[4];
     olsize_t jjccp_sObj;
+    /**The color offset of slab if JF_JIUKUN_CACHE_CREATE_FLAG_COLOR is set, 0 means cache line.*/
     olsize_t jjccp_sOffset;
     jf_flag_t jjccp_jfCache;
-    u32 jjccp_u32Reserved2[4];
+    /**Constructor of object, it's optional.*/
+    jf_jiukun_fnConstructObject_t jjccp_fnCtor;
+    /**Destructor of object, it's optional.*/
+    jf_jiukun_fnDestructObject_t jjccp_fnDtor;
 } jf_jiukun_cache_create_param_t;
 
 /** Flags for allocating jiukun page memory used by jf_jiukun_allocPage().
@@ -116,12 +182,45 @@ typedef enum jf_jiukun_page_alloc_flag
     JF_JIUKUN_PAGE_ALLOC_FLAG_WAIT = 0,
 } jf_jiukun_page_alloc_flag_t;
 
+/** Jiukun arena data structure.
+ */
+typedef void  jf_jiukun_arena_t;
+
+/** The parameter for creating arena.
+ */
+typedef struct
+{
+    /**Order of pages for each chunk, 0 means one page per chunk. The memory larger than the chunk
+       is allocated with a dedicated chunk.*/
+    u8 jjacp_u8ChunkOrder;
+    u8 jjacp_u8Reserved[7];
+    u32 jjacp_u32Reserved[2];
+} jf_jiukun_arena_create_param_t;
+
 /* --- functional routines ---------------------------------------------------------------------- */
 
 JIUKUNAPI u32 JIUKUNCALL jf_jiukun_init(jf_jiukun_init_param_t * pjjip);
 
 JIUKUNAPI u32 JIUKUNCALL jf_jiukun_fini(void);
 
+/** Reap jiukun, destroy the free slabs beyond the watermark and return the free pages to OS.
+ *
+ *  @note
+ *  -# The routine is called by the background reaping thread if the reaping interval is set.
+ *  -# The cache which is created with JF_JIUKUN_CACHE_CREATE_FLAG_NOREAP is not reaped.
+ *
+ *  @return The error code.
+ */
+JIUKUNAPI u32 JIUKUNCALL jf_jiukun_reap(void);
+
+/** Get the statistics of reaping.
+ *
+ *  @param pjjrs [out] The statistics.
+ *
+ *  @return The error code.
+ */
+JIUKUNAPI u32 JIUKUNCALL jf_jiukun_getReapStat(jf_jiukun_reap_stat_t * pjjrs);
+
 /* Jiukun page allocator. */
 
 /** Get memory from jiukun page allocator.
@@ -136,7 +235,18 @@ JIUKUNAPI void JIUKUNCALL jf_jiukun_freePage(void ** pptr);
  */
 
 /** Create a jiukun cache.
- *  
+ *
+ *  @note
+ *  -# If constructor is specified, the object is constructed when the slab is grown and it's
+ *   destructed when the slab is destroyed. The object allocated is in the constructed state, the
+ *   caller must return the object to the constructed state before freeing it, so the
+ *   initialization is not required for every allocation.
+ *  -# The constructor is called with the lock of the cache held, it should not allocate object
+ *   from the same cache.
+ *  -# JF_JIUKUN_CACHE_CREATE_FLAG_ZERO cannot be used with constructor.
+ *  -# The shared cache is found by name, the object size and the constructor should be the same
+ *   for all creators, otherwise JF_ERR_FAIL_CREATE_JIUKUN_CACHE is returned.
+ *
  *  @param ppCache [out] A pointer to the cache on success, NULL on failure.
  *  @param pjjccp [in] The parameters for creating a cache.
  *
@@ -186,6 +296,81 @@ JIUKUNAPI u32 JIUKUNCALL jf_jiukun_memcpy(void * pDest, const void * pSource, ol
 JIUKUNAPI u32 JIUKUNCALL jf_jiukun_strncpy(
     olchar_t * pDest, const olchar_t * pSource, olsize_t size);
 
+/** jiukun arena
+ *
+ *  @note
+ *  -# Arena is a bump allocator for request-scoped allocation. The memory is carved from jiukun
+ *   pages and cannot be freed individually, all memory is released when the arena is reset or
+ *   destroyed.
+ *  -# Arena is not thread safe.
+ */
+
+/** Create an arena.
+ *
+ *  @param ppArena [out] The arena created.
+ *  @param pjjacp [in] The parameters for creating the arena.
+ *
+ *  @return The error code.
+ */
+JIUKUNAPI u32 JIUKUNCALL jf_jiukun_createArena(
+    jf_jiukun_arena_t ** ppArena, jf_jiukun_arena_create_param_t * pjjacp);
+
+/** Destroy an arena, all memory allocated from the arena is freed.
+ *
+ *  @param ppArena [in/out] The arena to destroy.
+ *
+ *  @return The error code.
+ */
+JIUKUNAPI u32 JIUKUNCALL jf_jiukun_destroyArena(jf_jiukun_arena_t ** ppArena);
+
+/** Reset an arena, all memory allocated from the arena is freed except the first chunk.
+ *
+ *  @param pArena [in] The arena to reset.
+ *
+ *  @return Void.
+ */
+JIUKUNAPI void JIUKUNCALL jf_jiukun_resetArena(jf_jiukun_arena_t * pArena);
+
+/** Allocate memory from arena.
+ *
+ *  @param pArena [in] The arena to allocate from.
+ *  @param pptr [out] The pointer to the allocated memory.
+ *  @param size [in] Bytes of memory are required.
+ *
+ *  @return The error code.
+ */
+JIUKUNAPI u32 JIUKUNCALL jf_jiukun_allocArenaMemory(
+    jf_jiukun_arena_t * pArena, void ** pptr, olsize_t size);
+
+/** Allocate memory from arena and copy the buffer to it.
+ *
+ *  @param pArena [in] The arena to allocate from.
+ *  @param pptr [out] The pointer to the allocated memory.
+ *  @param pu8Buffer [in] The buffer to copy.
+ *  @param size [in] Size of the buffer.
+ *
+ *  @return The error code.
+ */
+JIUKUNAPI u32 JIUKUNCALL jf_jiukun_cloneArenaMemory(
+    jf_jiukun_arena_t * pArena, void ** pptr, const u8 * pu8Buffer, olsize_t size);
+
+/** Dump the allocation profile.
+ *
+ *  @note
+ *  -# Profiling is enabled by jjip_u32ProfileSample when jiukun is initialized. The memory
+ *   allocated by jf_jiukun_allocMemory() and jf_jiukun_allocObject() is sampled.
+ *  -# If the file is NULL, the sites with most live bytes are logged. Otherwise the profile is
+ *   written to the file in the legacy heap profile format of pprof.
+ *  -# The routine can be called in the signal handler registered by
+ *   jf_thread_registerSignalHandlers(), the handler is not run in the signal context.
+ *
+ *  @param pstrFile [in] The file for the profile.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NOT_INITIALIZED Profiling is not enabled.
+ */
+JIUKUNAPI u32 JIUKUNCALL jf_jiukun_dumpProfile(const olchar_t * pstrFile);
+
 /*debug*/
 #if defined(DEBUG_JIUKUN)
 JIUKUNAPI void JIUKUNCALL jf_jiukun_dump(void);
@@ -68,6 +68,19 @@
  */
 typedef void  jf_network_socket_t;
 
+/** Define the socket tuning profile for stream socket.
+ */
+typedef enum jf_network_socket_profile
+{
+    /**Leave the socket options as the system default.*/
+    JF_NETWORK_SOCKET_PROFILE_DEFAULT = 0,
+    /**Disable Nagle algorithm, busy poll the device queue and use small socket buffers. It's
+       for request/response traffic with small message.*/
+    JF_NETWORK_SOCKET_PROFILE_LOW_LATENCY,
+    /**Large socket buffers and limited unsent data in kernel. It's for bulk data transfer.*/
+    JF_NETWORK_SOCKET_PROFILE_BULK,
+} jf_network_socket_profile_t;
+
 /** Define the network async socket data type.
  */
 typedef void  jf_network_asocket_t;
@@ -128,6 +141,32 @@ typedef struct
     jf_network_fnPostSelectChainObject_t jncoh_fnPostSelect;
 } jf_network_chain_object_header_t;
 
+/** Statistics of the chain, the counters of system call are used to measure the cost per message.
+ *
+ *  @note
+ *  -# Most counters are updated in the chain thread without lock. The counter of wakeup is updated
+ *   by the caller thread, it may be inaccurate if the chain is waked up by multiple threads.
+ */
+typedef struct
+{
+    /**Number of select() calls.*/
+    u64 jncs_u64Select;
+    /**Number of send() calls to wake up the chain.*/
+    u64 jncs_u64Wakeup;
+    /**Number of recv() calls to read the wakeup socket.*/
+    u64 jncs_u64WakeupRecv;
+    /**Number of send() calls by the async sockets in the chain.*/
+    u64 jncs_u64Send;
+    /**Number of recv() calls by the async sockets in the chain.*/
+    u64 jncs_u64Recv;
+    /**Number of setsockopt() calls by the async sockets in the chain, e.g. cork.*/
+    u64 jncs_u64SockOpt;
+    /**Number of bytes sent by the async sockets in the chain.*/
+    u64 jncs_u64BytesSent;
+    /**Number of bytes received by the async sockets in the chain.*/
+    u64 jncs_u64BytesRecv;
+} jf_network_chain_stat_t;
+
 /** Define the network utimer data type.
  */
 typedef void  jf_network_utimer_t;
@@ -181,13 +220,17 @@ typedef struct
 {
     /**The initial size of the receive buffer.*/
     olsize_t jnacp_sInitialBuf;
-    /**The max number of simultaneous connections that will be allowed.*/
+    /**The max number of simultaneous connections that will be allowed, up to 100000. The chain
+       uses select(), on Linux the connection with socket equal to or larger than FD_SETSIZE
+       (1024 by default) is rejected, so the actual number is less than FD_SETSIZE.*/
     u32 jnacp_u32MaxConn;
     u32 jnacp_u32Reserved;
     jf_ipaddr_t jnacp_jiServer;
     /**The port number to bind to. 0 will select a random port.*/
     u16 jnacp_u16ServerPort;
-    u16 jnacp_u16Reserved[3];
+    /**The socket tuning profile applied to accepted connection, jf_network_socket_profile_t.*/
+    u8 jnacp_u8SocketProfile;
+    u8 jnacp_u8Reserved[5];
     /**Function that triggers when a connection is established.*/
     jf_network_fnAssocketOnConnect_t jnacp_fnOnConnect;
     /**Function that triggers when a connection is closed.*/
@@ -232,6 +275,17 @@ typedef u32 (* jf_network_fnAcsocketOnSendData_t)(
     jf_network_acsocket_t * pAcsocket, jf_network_asocket_t * pAsocket, u32 u32Status,
     u8 * pu8Buffer, olsize_t sBuf, void * pUser);
 
+/** The function is to check the health of an idle connection in the connection pool.
+ *
+ *  @note
+ *  -# The function is called in the chain thread periodically for the idle connection.
+ *  -# If error is returned, the connection is closed and removed from the pool.
+ *
+ *  @param pUser [in] The user object bound to the connection, it's NULL for pre-warmed connection.
+ */
+typedef u32 (* jf_network_fnAcsocketOnHealthCheck_t)(
+    jf_network_acsocket_t * pAcsocket, jf_network_asocket_t * pAsocket, void * pUser);
+
 /** Define parameter for creating async client socket.
  */
 typedef struct
@@ -240,7 +294,17 @@ typedef struct
     olsize_t jnacp_sInitialBuf;
     /**The max number of simultaneous connections that will be allowed.*/
     u32 jnacp_u32MaxConn;
-    u8 jnacp_u8Reserved[8];
+    /**The max number of pooled connections to one endpoint, 0 means no limit.*/
+    u16 jnacp_u16MaxConnPerEndpoint;
+    /**The max number of outstanding requests on one pooled connection, 0 means 1.*/
+    u16 jnacp_u16MaxRequestPerConn;
+    /**Idle pooled connection is closed after the timeout in second, 0 means never.*/
+    u16 jnacp_u16IdleTimeout;
+    /**The interval in second to check the health of idle pooled connection, 0 means never.*/
+    u16 jnacp_u16HealthCheckInterval;
+    /**The socket tuning profile applied to connection, jf_network_socket_profile_t.*/
+    u8 jnacp_u8SocketProfile;
+    u8 jnacp_u8Reserved[7];
     /**Callback function that triggers when a connection is established.*/
     jf_network_fnAcsocketOnConnect_t jnacp_fnOnConnect;
     /**Callback function that triggers when a connection is closed.*/
@@ -249,9 +313,66 @@ typedef struct
     jf_network_fnAcsocketOnData_t jnacp_fnOnData;
     /**Callback function that triggers when pending sends are complete.*/
     jf_network_fnAcsocketOnSendData_t jnacp_fnOnSendData;
+    /**Callback function to check the health of idle pooled connection, it's optional.*/
+    jf_network_fnAcsocketOnHealthCheck_t jnacp_fnOnHealthCheck;
     olchar_t * jnacp_pstrName;
 } jf_network_acsocket_create_param_t;
 
+/*  Async DNS resolver.
+ */
+
+/** Define the network async resolver data type.
+ */
+typedef void  jf_network_resolver_t;
+
+/** Maximum length of the host name to resolve.
+ */
+#define JF_NETWORK_RESOLVER_MAX_HOST_NAME_LEN   (256)
+
+/** Maximum number of addresses returned for one host name.
+ */
+#define JF_NETWORK_RESOLVER_MAX_ADDR            (8)
+
+/** The function is to notify upper layer the result of the name resolution.
+ *
+ *  @note
+ *  -# The function is always called in the thread running the network chain.
+ *  -# The address array is valid only in the callback function.
+ *
+ *  @param pstrName [in] The host name to resolve.
+ *  @param u32Status [in] The result of the resolution, JF_ERR_NO_ERROR on success.
+ *  @param pjiAddr [in] The address array.
+ *  @param u16NumOfAddr [in] Number of addresses in the array.
+ *  @param pUser [in] The user object passed to jf_network_resolveHostName().
+ */
+typedef u32 (* jf_network_fnResolverOnResult_t)(
+    const olchar_t * pstrName, u32 u32Status, jf_ipaddr_t * pjiAddr, u16 u16NumOfAddr,
+    void * pUser);
+
+/** Define parameter for creating async resolver.
+ */
+typedef struct
+{
+    /**The name server. It's used only when the port is not 0, otherwise the name servers in
+       resolv.conf are used.*/
+    jf_ipaddr_t jnrcp_jiServer;
+    /**The port of the name server.*/
+    u16 jnrcp_u16ServerPort;
+    u16 jnrcp_u16Reserved[3];
+    /**Timeout in second of a query. The setting in resolv.conf is used if it's 0.*/
+    u32 jnrcp_u32Timeout;
+    /**Number of attempts to each name server. The setting in resolv.conf is used if it's 0.*/
+    u32 jnrcp_u32Attempts;
+    /**Maximum number of entries in the cache. Default value is used if it's 0.*/
+    u32 jnrcp_u32MaxCacheEntry;
+    u32 jnrcp_u32Reserved;
+    /**Path of the resolver configuration file, "/etc/resolv.conf" if it's NULL.*/
+    olchar_t * jnrcp_pstrResolvConf;
+    /**Path of the static host table file, "/etc/hosts" if it's NULL.*/
+    olchar_t * jnrcp_pstrHosts;
+    olchar_t * jnrcp_pstrName;
+} jf_network_resolver_create_param_t;
+
 
 /* --- functional routines ---------------------------------------------------------------------- */
 
@@ -689,6 +810,19 @@ NETWORKAPI boolean_t NETWORKCALL jf_network_isSocketSetInFdSet(
 NETWORKAPI void NETWORKCALL jf_network_setSocketToFdSet(
     jf_network_socket_t * pSocket, fd_set * set);
 
+/** Check if the socket can be set to fd set.
+ *
+ *  @note
+ *  -# On Linux, the socket equal to or larger than FD_SETSIZE cannot be set to fd set.
+ *
+ *  @param pSocket [in] The socket to check.
+ *
+ *  @return The status.
+ *  @retval TRUE The socket can be set to fd set.
+ *  @retval FALSE The socket cannot be set to fd set.
+ */
+NETWORKAPI boolean_t NETWORKCALL jf_network_isSocketFitInFdSet(jf_network_socket_t * pSocket);
+
 /** Clear fd set.
  *
  *  @param set [in] The fd set to clear.
@@ -726,6 +860,34 @@ NETWORKAPI u32 NETWORKCALL jf_network_setSocketOption(
     jf_network_socket_t * pSocket, olint_t level, olint_t optname, void * pOptval,
     olsize_t sOptval);
 
+/** Apply the tuning profile to the stream socket.
+ *
+ *  @note
+ *  -# The options not supported by the platform are ignored.
+ *
+ *  @param pSocket [in] The stream socket.
+ *  @param u8Profile [in] The socket profile, jf_network_socket_profile_t.
+ *
+ *  @return The error code.
+ */
+NETWORKAPI u32 NETWORKCALL jf_network_setSocketProfile(
+    jf_network_socket_t * pSocket, u8 u8Profile);
+
+/** Cork or uncork the stream socket.
+ *
+ *  @note
+ *  -# When the socket is corked, the partial frame is not sent until the socket is uncorked. It's
+ *   used to coalesce multi-part message into full frames.
+ *  -# JF_ERR_NOT_SUPPORTED is returned if the platform doesn't support cork.
+ *
+ *  @param pSocket [in] The stream socket.
+ *  @param bCork [in] Cork the socket if it's TRUE, otherwise uncork the socket.
+ *
+ *  @return The error code.
+ */
+NETWORKAPI u32 NETWORKCALL jf_network_setSocketCork(
+    jf_network_socket_t * pSocket, boolean_t bCork);
+
 /*  Async socket. */
 
 /** Get options on async socket.
@@ -830,6 +992,24 @@ NETWORKAPI u32 NETWORKCALL jf_network_stopChain(jf_network_chain_t * pChain);
  */
 NETWORKAPI u32 NETWORKCALL jf_network_wakeupChain(jf_network_chain_t * pChain);
 
+/** Get the statistics of the chain.
+ *
+ *  @param pChain [in] The chain.
+ *  @param pStat [out] The statistics of the chain.
+ *
+ *  @return The error code.
+ */
+NETWORKAPI u32 NETWORKCALL jf_network_getChainStat(
+    jf_network_chain_t * pChain, jf_network_chain_stat_t * pStat);
+
+/** Clear the statistics of the chain.
+ *
+ *  @param pChain [in] The chain.
+ *
+ *  @return The error code.
+ */
+NETWORKAPI u32 NETWORKCALL jf_network_clearChainStat(jf_network_chain_t * pChain);
+
 /*  Network utimer definition.
  */
 
@@ -892,6 +1072,11 @@ NETWORKAPI void NETWORKCALL jf_network_dumpUtimerItem(jf_network_utimer_t * pUti
  */
 
 /** Create async server socket.
+ *
+ *  @note
+ *  -# The async sockets for the connections are created on demand, the receive buffer of the
+ *   connection is allocated when data is coming and released when the data is consumed.
+ *  -# The number of connections is limited by the fd set of the chain.
  *
  *  @param pChain [in] The chain to add this assocket to.
  *  @param ppAssocket [out] The async server socket.
@@ -1091,6 +1276,61 @@ NETWORKAPI u32 NETWORKCALL jf_network_sendAcsocketStaticData(
 NETWORKAPI void NETWORKCALL jf_network_getLocalInterfaceOfAcsocket(
     jf_network_acsocket_t * pAcsocket, jf_network_asocket_t * pAsocket, jf_ipaddr_t * pjiAddr);
 
+/** Acquire a pooled connection to the endpoint from the async client socket.
+ *
+ *  @note
+ *  -# The connection is selected in the order: idle connection, pre-warmed connection in progress,
+ *   new connection, connection with the least outstanding requests.
+ *  -# If an established connection is selected, it's returned in ppAsocket. Otherwise ppAsocket is
+ *   set to NULL and jf_network_fnAcsocketOnConnect_t is called when the connection is established.
+ *  -# The user object is bound to the connection when the connection is claimed from idle state.
+ *   If the connection is shared with other requests, the bound user object is not changed.
+ *  -# Call jf_network_releaseAcsocketConnection() when the request is finished.
+ *
+ *  @param pAcsocket [in] The async client socket.
+ *  @param pjiRemote [in] The remote interface of the endpoint.
+ *  @param u16RemotePort [in] The remote port of the endpoint.
+ *  @param pUser [in] User object that will be passed to other method.
+ *  @param ppAsocket [out] The async socket representing the connection.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_SOCKET_POOL_EMPTY No connection is available.
+ */
+NETWORKAPI u32 NETWORKCALL jf_network_acquireAcsocketConnection(
+    jf_network_acsocket_t * pAcsocket, jf_ipaddr_t * pjiRemote, u16 u16RemotePort, void * pUser,
+    jf_network_asocket_t ** ppAsocket);
+
+/** Release a pooled connection acquired by jf_network_acquireAcsocketConnection().
+ *
+ *  @note
+ *  -# The connection becomes idle if there is no outstanding request. The events of the idle
+ *   connection are not passed to upper layer until it's acquired again.
+ *
+ *  @param pAcsocket [in] The async client socket.
+ *  @param pAsocket [in] The async socket representing the connection.
+ *
+ *  @return The error code.
+ */
+NETWORKAPI u32 NETWORKCALL jf_network_releaseAcsocketConnection(
+    jf_network_acsocket_t * pAcsocket, jf_network_asocket_t * pAsocket);
+
+/** Pre-warm the connection pool by setting up connections to the endpoint in advance.
+ *
+ *  @note
+ *  -# The existing pooled connections to the endpoint are counted.
+ *
+ *  @param pAcsocket [in] The async client socket.
+ *  @param pjiRemote [in] The remote interface of the endpoint.
+ *  @param u16RemotePort [in] The remote port of the endpoint.
+ *  @param u16NumOfConn [in] The number of connections to the endpoint.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_SOCKET_POOL_EMPTY Not all connections can be set up.
+ */
+NETWORKAPI u32 NETWORKCALL jf_network_prewarmAcsocket(
+    jf_network_acsocket_t * pAcsocket, jf_ipaddr_t * pjiRemote, u16 u16RemotePort,
+    u16 u16NumOfConn);
+
 /** Resolve host name to IP.
  *
  *  @param pstrName [in] The host name.
@@ -1101,6 +1341,55 @@ NETWORKAPI void NETWORKCALL jf_network_getLocalInterfaceOfAcsocket(
 NETWORKAPI u32 NETWORKCALL jf_network_getHostByName(
     const olchar_t * pstrName, struct hostent ** ppHostent);
 
+/*  Network async resolver routine.
+ */
+
+/** Create an async resolver and add it to the chain.
+ *
+ *  @note
+ *  -# The static host table and the resolver configuration file are parsed in this function.
+ *  -# The query is sent to name server with UDP, the result is cached according to TTL.
+ *
+ *  @param pChain [in] The chain object to add the resolver to.
+ *  @param ppResolver [out] The resolver object created.
+ *  @param pjnrcp [in] The parameter for creating the resolver.
+ *
+ *  @return The error code.
+ */
+NETWORKAPI u32 NETWORKCALL jf_network_createResolver(
+    jf_network_chain_t * pChain, jf_network_resolver_t ** ppResolver,
+    jf_network_resolver_create_param_t * pjnrcp);
+
+/** Destroy the async resolver.
+ *
+ *  @note
+ *  -# The callback function is not called for the pending requests.
+ *
+ *  @param ppResolver [in/out] The resolver object to destroy.
+ *
+ *  @return The error code.
+ */
+NETWORKAPI u32 NETWORKCALL jf_network_destroyResolver(jf_network_resolver_t ** ppResolver);
+
+/** Resolve host name to IP asynchronously.
+ *
+ *  @note
+ *  -# The function can be called in any thread, it never blocks.
+ *  -# The result is notified by the callback function in the thread running the chain.
+ *  -# Numeric address, static host table and cache are checked before the query is sent.
+ *
+ *  @param pResolver [in] The resolver object.
+ *  @param pstrName [in] The host name.
+ *  @param u8AddrType [in] The address type, JF_IPADDR_TYPE_V4 or JF_IPADDR_TYPE_V6.
+ *  @param fnOnResult [in] The callback function for the result.
+ *  @param pUser [in] The user object passed to the callback function.
+ *
+ *  @return The error code.
+ */
+NETWORKAPI u32 NETWORKCALL jf_network_resolveHostName(
+    jf_network_resolver_t * pResolver, const olchar_t * pstrName, u8 u8AddrType,
+    jf_network_fnResolverOnResult_t fnOnResult, void * pUser);
+
 #endif /*JIUFENG_NETWORK_H */
 
 /*------------------------------------------------------------------------------------------------*/
@@ -144,5 +144,54 @@ void * jf_queue_peek(jf_queue_t * pQueue)
         return pQueue->jq_pjqnHead->jqn_pData;
 }
 
+u32 jf_ringqueue_init(jf_ringqueue_t * pjrq, u32 u32Capacity)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Slot = 1;
+
+    assert(pjrq != NULL);
+
+    ol_bzero(pjrq, sizeof(*pjrq));
+
+    if ((u32Capacity == 0) || (u32Capacity > (U32_MAX >> 1) + 1))
+        return JF_ERR_INVALID_PARAM;
+
+    /*Round up the capacity to power of 2, so the index is wrapped by mask.*/
+    while (u32Slot < u32Capacity)
+        u32Slot <<= 1;
+
+    u32Ret = jf_jiukun_allocMemory((void **)&pjrq->jrq_ppData, u32Slot * sizeof(void *));
+    if (u32Ret == JF_ERR_NO_ERROR)
+        pjrq->jrq_u32Mask = u32Slot - 1;
+
+    return u32Ret;
+}
+
+void jf_ringqueue_fini(jf_ringqueue_t * pjrq)
+{
+    assert(pjrq != NULL);
+
+    if (pjrq->jrq_ppData != NULL)
+        jf_jiukun_freeMemory((void **)&pjrq->jrq_ppData);
+
+    ol_bzero(pjrq, sizeof(*pjrq));
+}
+
+void jf_ringqueue_finiQueueAndData(jf_ringqueue_t * pjrq, jf_queue_fnFreeData_t fnFreeData)
+{
+    void * pData = NULL;
+
+    assert(pjrq != NULL);
+
+    /*The queue is empty if it's not initialized.*/
+    while (! jf_ringqueue_isEmpty(pjrq))
+    {
+        pData = jf_ringqueue_dequeue(pjrq);
+        fnFreeData(&pData);
+    }
+
+    jf_ringqueue_fini(pjrq);
+}
+
 /*------------------------------------------------------------------------------------------------*/
 
@@ -10,6 +10,11 @@
  *  -# The item is first in, first out.
  *  -# Link with jf_jiukun library for memory allocation.
  *  -# The object is not thread safe.
+ *  -# jf_queue allocates a node for each item. The intrusive queue jf_iqueue has the link embedded
+ *   in the item, the enqueue and dequeue don't allocate memory. The item can be in only one
+ *   intrusive queue with the same link at a time.
+ *  -# jf_ringqueue is a bounded queue with power of 2 slots, the memory is allocated when the
+ *   queue is initialized.
  *  
  */
 
@@ -22,6 +27,7 @@
 /* --- internal header files -------------------------------------------------------------------- */
 #include "jf_basic.h"
 #include "jf_err.h"
+#include "jf_listhead.h"
 
 /* --- constant definitions --------------------------------------------------------------------- */
 
@@ -51,6 +57,42 @@ typedef struct jf_queue
  */
 typedef u32 (* jf_queue_fnFreeData_t)(void ** ppData);
 
+/** Define the link data type of intrusive queue, it's embedded in the item.
+ */
+typedef struct jf_queue_link
+{
+    /**The next link.*/
+    struct jf_queue_link * jql_pjqlNext;
+} jf_queue_link_t;
+
+/** Define the intrusive queue data type.
+ *
+ *  @note
+ *  -# The tail points to the head if the queue is empty, so the queue cannot be copied.
+ */
+typedef struct jf_iqueue
+{
+    /**The head link.*/
+    jf_queue_link_t * jiq_pjqlHead;
+    /**Pointer to the next link of the tail.*/
+    jf_queue_link_t ** jiq_ppjqlTail;
+} jf_iqueue_t;
+
+/** Define the ring queue data type.
+ */
+typedef struct jf_ringqueue
+{
+    /**The slots.*/
+    void ** jrq_ppData;
+    /**Number of slots minus 1, number of slots is power of 2.*/
+    u32 jrq_u32Mask;
+    /**The index of the head, it's not wrapped.*/
+    u32 jrq_u32Head;
+    /**The index of the tail, it's not wrapped.*/
+    u32 jrq_u32Tail;
+    u32 jrq_u32Reserved;
+} jf_ringqueue_t;
+
 /* --- functional routines ---------------------------------------------------------------------- */
 
 /** Initialize an empty Queue.
@@ -122,6 +164,207 @@ void * jf_queue_dequeue(jf_queue_t * pQueue);
  */
 void * jf_queue_peek(jf_queue_t * pQueue);
 
+/** Initialize an empty intrusive queue.
+ *
+ *  @param pjiq [in] The intrusive queue to be initialized.
+ *
+ *  @return Void.
+ */
+static inline void jf_iqueue_init(jf_iqueue_t * pjiq)
+{
+    pjiq->jiq_pjqlHead = NULL;
+    pjiq->jiq_ppjqlTail = &pjiq->jiq_pjqlHead;
+}
+
+/** Check to see if an intrusive queue is empty.
+ *
+ *  @param pjiq [in] The intrusive queue to check.
+ *
+ *  @return The queue empty state.
+ *  @retval TRUE the queue is empty.
+ *  @retval FALSE the queue is not empty.
+ */
+static inline boolean_t jf_iqueue_isEmpty(jf_iqueue_t * pjiq)
+{
+    return (pjiq->jiq_pjqlHead == NULL) ? TRUE : FALSE;
+}
+
+/** Add an item to the end of the intrusive queue.
+ *
+ *  @param pjiq [in] The intrusive queue to add.
+ *  @param pjql [in] The link embedded in the item.
+ *
+ *  @return Void.
+ */
+static inline void jf_iqueue_enqueue(jf_iqueue_t * pjiq, jf_queue_link_t * pjql)
+{
+    pjql->jql_pjqlNext = NULL;
+    *pjiq->jiq_ppjqlTail = pjql;
+    pjiq->jiq_ppjqlTail = &pjql->jql_pjqlNext;
+}
+
+/** Remove an item from the head of the intrusive queue.
+ *
+ *  @param pjiq [in] The intrusive queue to remove an item from.
+ *
+ *  @return The link embedded in the item, NULL if the queue is empty.
+ */
+static inline jf_queue_link_t * jf_iqueue_dequeue(jf_iqueue_t * pjiq)
+{
+    jf_queue_link_t * pjql = pjiq->jiq_pjqlHead;
+
+    if (pjql != NULL)
+    {
+        pjiq->jiq_pjqlHead = pjql->jql_pjqlNext;
+        if (pjiq->jiq_pjqlHead == NULL)
+            pjiq->jiq_ppjqlTail = &pjiq->jiq_pjqlHead;
+    }
+
+    return pjql;
+}
+
+/** Peek an item from the head of the intrusive queue, the item is still in the queue.
+ *
+ *  @param pjiq [in] The intrusive queue to peek an item from.
+ *
+ *  @return The link embedded in the item, NULL if the queue is empty.
+ */
+static inline jf_queue_link_t * jf_iqueue_peek(jf_iqueue_t * pjiq)
+{
+    return pjiq->jiq_pjqlHead;
+}
+
+/** Get the struct for this link.
+ *
+ *  @param ptr [in] The jf_queue_link_t pointer, it cannot be NULL.
+ *  @param type [in] The type of the struct this is embedded in.
+ *  @param member [in] The name of the link within the struct.
+ */
+#define jf_iqueue_getEntry(ptr, type, member) \
+    container_of(ptr, type, member)
+
+/** Initialize an empty ring queue.
+ *
+ *  @note
+ *  -# The number of slots is the capacity rounded up to power of 2.
+ *
+ *  @param pjrq [in] The ring queue to be initialized.
+ *  @param u32Capacity [in] The minimum number of items the queue can hold.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ *  @retval JF_ERR_INVALID_PARAM Invalid capacity.
+ *  @retval JF_ERR_OUT_OF_MEMORY Out of memory.
+ */
+u32 jf_ringqueue_init(jf_ringqueue_t * pjrq, u32 u32Capacity);
+
+/** Finalize the ring queue.
+ *
+ *  @param pjrq [in] The ring queue to finalize.
+ *
+ *  @return Void.
+ */
+void jf_ringqueue_fini(jf_ringqueue_t * pjrq);
+
+/** Finalize the ring queue and data.
+ *
+ *  @param pjrq [in] The ring queue to finalize.
+ *  @param fnFreeData [in] The call back function to free data.
+ *
+ *  @return Void.
+ */
+void jf_ringqueue_finiQueueAndData(jf_ringqueue_t * pjrq, jf_queue_fnFreeData_t fnFreeData);
+
+/** Get number of items in the ring queue.
+ *
+ *  @param pjrq [in] The ring queue.
+ *
+ *  @return Number of items.
+ */
+static inline u32 jf_ringqueue_getSize(jf_ringqueue_t * pjrq)
+{
+    return pjrq->jrq_u32Tail - pjrq->jrq_u32Head;
+}
+
+/** Check to see if a ring queue is empty.
+ *
+ *  @param pjrq [in] The ring queue to check.
+ *
+ *  @return The queue empty state.
+ *  @retval TRUE the queue is empty.
+ *  @retval FALSE the queue is not empty.
+ */
+static inline boolean_t jf_ringqueue_isEmpty(jf_ringqueue_t * pjrq)
+{
+    return (pjrq->jrq_u32Tail == pjrq->jrq_u32Head) ? TRUE : FALSE;
+}
+
+/** Check to see if a ring queue is full.
+ *
+ *  @param pjrq [in] The ring queue to check.
+ *
+ *  @return The queue full state.
+ *  @retval TRUE the queue is full.
+ *  @retval FALSE the queue is not full.
+ */
+static inline boolean_t jf_ringqueue_isFull(jf_ringqueue_t * pjrq)
+{
+    return (pjrq->jrq_u32Tail - pjrq->jrq_u32Head > pjrq->jrq_u32Mask) ? TRUE : FALSE;
+}
+
+/** Add an item to the end of the ring queue.
+ *
+ *  @param pjrq [in] The ring queue to add.
+ *  @param pData [in] The data to add to the queue.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ *  @retval JF_ERR_BUFFER_IS_FULL The queue is full.
+ */
+static inline u32 jf_ringqueue_enqueue(jf_ringqueue_t * pjrq, void * pData)
+{
+    if (jf_ringqueue_isFull(pjrq))
+        return JF_ERR_BUFFER_IS_FULL;
+
+    pjrq->jrq_ppData[pjrq->jrq_u32Tail & pjrq->jrq_u32Mask] = pData;
+    pjrq->jrq_u32Tail ++;
+
+    return JF_ERR_NO_ERROR;
+}
+
+/** Remove an item from the head of the ring queue.
+ *
+ *  @param pjrq [in] The ring queue to remove an item from.
+ *
+ *  @return The data, NULL if the queue is empty.
+ */
+static inline void * jf_ringqueue_dequeue(jf_ringqueue_t * pjrq)
+{
+    void * pData = NULL;
+
+    if (! jf_ringqueue_isEmpty(pjrq))
+    {
+        pData = pjrq->jrq_ppData[pjrq->jrq_u32Head & pjrq->jrq_u32Mask];
+        pjrq->jrq_u32Head ++;
+    }
+
+    return pData;
+}
+
+/** Peek an item from the head of the ring queue, the item is still in the queue.
+ *
+ *  @param pjrq [in] The ring queue to peek an item from.
+ *
+ *  @return The data, NULL if the queue is empty.
+ */
+static inline void * jf_ringqueue_peek(jf_ringqueue_t * pjrq)
+{
+    if (jf_ringqueue_isEmpty(pjrq))
+        return NULL;
+
+    return pjrq->jrq_ppData[pjrq->jrq_u32Head & pjrq->jrq_u32Mask];
+}
+
 #endif /*JIUTAI_QUEUE_H*/
 
 /*------------------------------------------------------------------------------------------------*/
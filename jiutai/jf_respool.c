@@ -6,7 +6,16 @@
  *  @author Min Zhang
  *
  *  @note
- *  
+ *  -# The free fulltime resources are in a lock free stack, getting and putting fulltime resource
+ *   don't take the lock of the pool. The fulltime resources are created with lock held and they
+ *   are not freed until the pool is destroyed, so the resource popped from the stack is always
+ *   valid.
+ *  -# The head of the stack has the position of the top resource and a tag which is increased by
+ *   each change, so the ABA problem is avoided with 64 bits compare and swap.
+ *  -# The parttime resources are in an array protected by the lock, the busy resources are before
+ *   the free resources.
+ *  -# The threads waiting for resource block on the put sequence which is increased when a
+ *   resource is put.
  */
 
 /* --- standard C lib header files -------------------------------------------------------------- */
@@ -20,6 +29,8 @@
 #include "jf_array.h"
 #include "jf_mutex.h"
 #include "jf_jiukun.h"
+#include "jf_atomic.h"
+#include "jf_time.h"
 
 /* --- private data/data structure section ------------------------------------------------------ */
 
@@ -43,11 +54,15 @@ typedef struct
 {
     /**Fulltime resource or not.*/
     boolean_t ir_bFulltime;
-    u8 ir_u8Reserved[7];
+    u8 ir_u8Reserved[3];
+    /**The resource state, it's changed atomically for fulltime resource.*/
+    volatile u32 ir_u32State;
     /**Pointer to the resource pool.*/
     struct internal_resource_pool * ir_pirpPool;
-    /**The resource state.*/
-    internal_resource_state_t ir_irsResourceState;
+    /**Position of the resource in fulltime table or parttime array.*/
+    u32 ir_u32Index;
+    /**Position plus 1 of the next free fulltime resource in stack, 0 means the end of stack.*/
+    volatile u32 ir_u32NextFree;
     /**The data of the resource.*/
     jf_respool_resource_data_t * ir_pjrrdData;
 } internal_resource_t;
@@ -62,11 +77,42 @@ typedef struct internal_resource_pool
     u32 irp_u32MaxResources;
     /**Release the parttime resource immediately after use.*/
     boolean_t irp_bImmediateRelease;
-    /**Synchronize the access to the resources.*/
+    u8 irp_u8Reserved[7];
+
+    /**Stack of free fulltime resources. The low 32 bits are the position plus 1 of the top
+       resource, the high 32 bits are the tag.*/
+    volatile u64 irp_u64FreeFulltime;
+    /**Number of fulltime resources, it's increased with lock held.*/
+    volatile u32 irp_u32NumOfFulltime;
+    /**Number of busy resources in parttime array, it's protected by lock.*/
+    u32 irp_u32NumOfBusyParttime;
+    /**Increased when a resource is put, the thread waiting for resource blocks on it.*/
+    volatile u32 irp_u32PutSeq;
+    /**Number of threads waiting for resource.*/
+    volatile u32 irp_u32NumOfWaiter;
+    /**Number of busy resources.*/
+    volatile u32 irp_u32NumOfBusy;
+    /**Peak number of busy resources.*/
+    volatile u32 irp_u32PeakBusy;
+
+    /**Number of get operations.*/
+    volatile u64 irp_u64NumOfGet;
+    /**Number of get operations served by the stack of free fulltime resources.*/
+    volatile u64 irp_u64NumOfFastGet;
+    /**Number of get operations which wait for resource.*/
+    volatile u64 irp_u64NumOfWait;
+    /**Number of get operations which time out.*/
+    volatile u64 irp_u64NumOfTimeout;
+    /**Total wait time in microsecond.*/
+    volatile u64 irp_u64WaitTime;
+    /**Maximum wait time in microsecond.*/
+    volatile u64 irp_u64MaxWaitTime;
+
+    /**Synchronize the creation of resource and the access to parttime resources.*/
     jf_mutex_t irp_jmLock;
-    /**Array contains fulltime resources.*/
-    jf_array_t * irp_pjaFulltimeResources;
-    /**Array contains parttime resources.*/    
+    /**Table of fulltime resources, the size is the minimum number of resources.*/
+    internal_resource_t ** irp_ppirFulltime;
+    /**Array contains parttime resources, the busy resources are before the free resources.*/
     jf_array_t * irp_pjaParttimeResources;
 
     /**The callback function to create resource.*/
@@ -106,7 +152,7 @@ static u32 _validateParam(jf_respool_create_param_t * pjrcp)
 
 /** Lock resource pool.
  *
- *  @param pirp [in] The pointer to the resource pool. 
+ *  @param pirp [in] The pointer to the resource pool.
  *
  *  @return The error code.
  *  @retval JF_ERR_NO_ERROR Success.
@@ -124,7 +170,7 @@ static u32 _lockResourcePool(internal_resource_pool_t * pirp)
 
 /** Unlock resource pool.
  *
- *  @param pirp [in] The pointer to the resource pool. 
+ *  @param pirp [in] The pointer to the resource pool.
  *
  *  @return The error code.
  *  @retval JF_ERR_NO_ERROR Success.
@@ -134,16 +180,37 @@ static u32 _unlockResourcePool(internal_resource_pool_t * pirp)
     u32 u32Ret = JF_ERR_NO_ERROR;
 
     jf_logger_logInfoMsg("unlock resource pool");
-        
+
     u32Ret = jf_mutex_release(&(pirp->irp_jmLock));
 
     return u32Ret;
 }
 
+/** Get the monotonic time in microsecond.
+ */
+static u64 _getResourcePoolTime(void)
+{
+    struct timespec ts;
+
+    jf_time_getClockTime(CLOCK_MONOTONIC, &ts);
+
+    return (u64)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/** Set the variable to the value if the value is larger.
+ */
+static void _updateResourcePoolMaxU64(volatile u64 * pu64Max, u64 u64Value)
+{
+    u64 u64Old = jf_atomic_loadU64(pu64Max);
+
+    while ((u64Value > u64Old) && (! jf_atomic_casU64(pu64Max, u64Old, u64Value)))
+        u64Old = jf_atomic_loadU64(pu64Max);
+}
+
 /** Destroy a resource.
  *
- *  @param pirp [in] The pointer to the resource pool. 
- *  @param ppir [in/out] The pointer to the resource to be destroyed. 
+ *  @param pirp [in] The pointer to the resource pool.
+ *  @param ppir [in/out] The pointer to the resource to be destroyed.
  *   After destruction, it will be set to NULL.
  *
  *  @return The error code.
@@ -157,7 +224,7 @@ static u32 _destroyResourceInPool(internal_resource_pool_t * pirp, internal_reso
     jf_logger_logDebugMsg("destroy resource");
 
     u32Ret = pirp->irp_fnDestroyResource((jf_respool_resource_t *)pir, &pir->ir_pjrrdData);
-    
+
     jf_jiukun_freeMemory((void **)ppir);
 
     return u32Ret;
@@ -178,7 +245,7 @@ static u32 _destroyArrayResource(jf_array_element_t ** ppjae)
 
 /** Check whether the resource is free.
  *
- *  @param pir [in] The pointer to the resource. 
+ *  @param pir [in] The pointer to the resource.
  *
  *  @return The free state of the resource.
  *  @retval TRUE the resource is free.
@@ -188,7 +255,7 @@ static boolean_t _isPoolResourceFree(internal_resource_t * pir)
 {
     boolean_t bFree = FALSE;
 
-    if (pir->ir_irsResourceState == IRS_FREE)
+    if (jf_atomic_loadU32(&pir->ir_u32State) == IRS_FREE)
         bFree = TRUE;
 
     return bFree;
@@ -207,34 +274,130 @@ static u32 _setPoolResourceState(
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
 
-    pir->ir_irsResourceState = irs;
+    jf_atomic_storeU32(&pir->ir_u32State, irs);
 
     return u32Ret;
 }
 
-static boolean_t _findArrayResource(jf_array_element_t * pjae, void * pKey)
+/** Pop a free fulltime resource from stack, the lock of pool is not required.
+ *
+ *  @param pirp [in] The pointer to the resource pool.
+ *
+ *  @return The resource or NULL if the stack is empty.
+ */
+static internal_resource_t * _popFulltimeResource(internal_resource_pool_t * pirp)
 {
-    boolean_t bFound = FALSE, bFree = FALSE;
-    internal_resource_t * pir = (internal_resource_t *) pjae;
+    internal_resource_t * pir = NULL;
+    u64 u64Head, u64New;
+    u32 u32Top;
 
-    jf_logger_logDebugMsg("find array resource");
+    do
+    {
+        u64Head = jf_atomic_loadU64(&pirp->irp_u64FreeFulltime);
+        u32Top = (u32)u64Head;
+        if (u32Top == 0)
+            return NULL;
+
+        /*The resource may be popped by other thread, the next position read here is discarded
+          as the tag is changed.*/
+        pir = pirp->irp_ppirFulltime[u32Top - 1];
+        u64New = (((u64Head >> 32) + 1) << 32) | jf_atomic_loadU32(&pir->ir_u32NextFree);
+    } while (! jf_atomic_casU64(&pirp->irp_u64FreeFulltime, u64Head, u64New));
+
+    _setPoolResourceState(pir, IRS_BUSY);
+
+    return pir;
+}
 
-    bFree = _isPoolResourceFree(pir);
-    if (bFree)
+/** Push a free fulltime resource to stack, the lock of pool is not required.
+ *
+ *  @param pirp [in] The pointer to the resource pool.
+ *  @param pir [in] The resource.
+ *
+ *  @return Void.
+ */
+static void _pushFulltimeResource(internal_resource_pool_t * pirp, internal_resource_t * pir)
+{
+    u64 u64Head, u64New;
+
+    do
     {
-        jf_logger_logDebugMsg(
-            "find free resource from %s array", (pir->ir_bFulltime ? "fulltime" : "parttime"));
-        _setPoolResourceState(pir, IRS_BUSY);
-        bFound = TRUE;
-    }
+        u64Head = jf_atomic_loadU64(&pirp->irp_u64FreeFulltime);
+        jf_atomic_storeU32(&pir->ir_u32NextFree, (u32)u64Head);
+        u64New = (((u64Head >> 32) + 1) << 32) | (pir->ir_u32Index + 1);
+    } while (! jf_atomic_casU64(&pirp->irp_u64FreeFulltime, u64Head, u64New));
+}
+
+/** Count the busy resource and update the peak.
+ */
+static void _markResourceBusy(internal_resource_pool_t * pirp)
+{
+    u32 u32Busy = jf_atomic_fetchAddU32(&pirp->irp_u32NumOfBusy, 1) + 1;
+    u32 u32Peak = jf_atomic_loadU32(&pirp->irp_u32PeakBusy);
+
+    while ((u32Busy > u32Peak) && (! jf_atomic_casU32(&pirp->irp_u32PeakBusy, u32Peak, u32Busy)))
+        u32Peak = jf_atomic_loadU32(&pirp->irp_u32PeakBusy);
+}
+
+/** Uncount the busy resource, it must be called before the resource can be got by others.
+ */
+static void _markResourceFree(internal_resource_pool_t * pirp)
+{
+    jf_atomic_fetchAddU32(&pirp->irp_u32NumOfBusy, (u32)-1);
+}
+
+/** Swap 2 resources in parttime array, the position saved in resource is updated.
+ *
+ *  @param pja [in] The array contains the resources.
+ *  @param u32Index1 [in] The position of the first resource.
+ *  @param u32Index2 [in] The position of the second resource.
+ *
+ *  @return Void.
+ */
+static void _swapResourceInPoolArray(jf_array_t * pja, u32 u32Index1, u32 u32Index2)
+{
+    internal_resource_t * pir1 = NULL, * pir2 = NULL;
+
+    if (u32Index1 == u32Index2)
+        return;
+
+    jf_array_getElementAt(pja, u32Index1, (jf_array_element_t **)&pir1);
+    jf_array_getElementAt(pja, u32Index2, (jf_array_element_t **)&pir2);
 
-    return bFound;
+    jf_array_setElementAt(pja, u32Index1, pir2);
+    jf_array_setElementAt(pja, u32Index2, pir1);
+
+    pir1->ir_u32Index = u32Index2;
+    pir2->ir_u32Index = u32Index1;
 }
 
-/** Check whether the maximum resources are reached in array.
+/** Remove the resource from array in O(1), the last resource in array is moved to the position of
+ *  the removed resource.
+ *
+ *  @param pja [in] The array contains the resource.
+ *  @param pir [in] The resource to be removed.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ */
+static u32 _removeResourceFromPoolArray(jf_array_t * pja, internal_resource_t * pir)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_resource_t * pirMoved = NULL;
+
+    u32Ret = jf_array_swapRemoveElementAt(pja, pir->ir_u32Index);
+    if ((u32Ret == JF_ERR_NO_ERROR) &&
+        (jf_array_getElementAt(pja, pir->ir_u32Index, (jf_array_element_t **)&pirMoved) ==
+         JF_ERR_NO_ERROR))
+        pirMoved->ir_u32Index = pir->ir_u32Index;
+
+    return u32Ret;
+}
+
+/** Check whether the maximum resources are reached, the lock of pool must be held.
  *
  *  @param pirp [in] The pointer to the resource pool.
- *  @param bFulltime [in] specify which array should be checked.
+ *  @param bFulltime [in] specify which type of resources should be checked.
  *
  *  @return The error code.
  *  @retval JF_ERR_NO_ERROR Success.
@@ -248,7 +411,7 @@ static u32 _isMaxPoolResourcesReached(
 
     if (bFulltime)
     {
-        u32Size = jf_array_getSize(pirp->irp_pjaFulltimeResources);
+        u32Size = pirp->irp_u32NumOfFulltime;
         if (u32Size == pirp->irp_u32MinResources)
         {
             jf_logger_logInfoMsg("max fulltime resource is reached");
@@ -268,60 +431,62 @@ static u32 _isMaxPoolResourcesReached(
     return u32Ret;
 }
 
-/** Create a resource and add it to the array.
+/** Create a busy resource, the lock of pool must be held.
  *
  *  @param pirp [in] The pointer to the resource pool.
  *  @param bFulltime [in] specify if the resource is fulltime or parttime.
- *  @param state [in] The resource state.
  *  @param ppjrr [in/out] The pointer to the resource to be created and returned.
  *
  *  @return The error code.
  *  @retval JF_ERR_NO_ERROR Success.
+ *  @retval JF_ERR_REACH_MAX_RESOURCES Reach maximum resources.
  */
 static u32 _createResourceInPoolArray(
-    internal_resource_pool_t * pirp, boolean_t bFulltime,
-    internal_resource_state_t state, jf_respool_resource_t ** ppjrr)
+    internal_resource_pool_t * pirp, boolean_t bFulltime, jf_respool_resource_t ** ppjrr)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
     internal_resource_t * pir = NULL;
-    jf_array_t * pja;
-
-    if (bFulltime)
-        pja = pirp->irp_pjaFulltimeResources;
-    else
-        pja = pirp->irp_pjaParttimeResources;
+    jf_array_t * pja = pirp->irp_pjaParttimeResources;
 
     jf_logger_logDebugMsg(
         "create resource in %s array", (bFulltime ? "fulltime" : "parttime"));
 
+    u32Ret = _isMaxPoolResourcesReached(pirp, bFulltime);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = jf_jiukun_allocMemory((void **)&pir, sizeof(internal_resource_t));
+
     if (u32Ret == JF_ERR_NO_ERROR)
     {
-        _lockResourcePool(pirp);
+        ol_bzero(pir, sizeof(internal_resource_t));
 
-        if (u32Ret == JF_ERR_NO_ERROR)
-            u32Ret = _isMaxPoolResourcesReached(pirp, bFulltime);
+        pir->ir_bFulltime = bFulltime;
+        pir->ir_pirpPool = pirp;
+        _setPoolResourceState(pir, IRS_BUSY);
 
-        if (u32Ret == JF_ERR_NO_ERROR)
-            u32Ret = jf_jiukun_allocMemory((void **)&pir, sizeof(internal_resource_t));
+        u32Ret = pirp->irp_fnCreateResource(pir, &pir->ir_pjrrdData);
+    }
 
-        if (u32Ret == JF_ERR_NO_ERROR)
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        if (bFulltime)
         {
-            ol_bzero(pir, sizeof(internal_resource_t));
-
-            pir->ir_bFulltime = bFulltime;
-            pir->ir_pirpPool = pirp;
-            _setPoolResourceState(pir, state);
-
-            u32Ret = pirp->irp_fnCreateResource(pir, &pir->ir_pjrrdData);
+            /*The table is reserved, publish the resource after it's in table.*/
+            pir->ir_u32Index = pirp->irp_u32NumOfFulltime;
+            pirp->irp_ppirFulltime[pir->ir_u32Index] = pir;
+            jf_atomic_storeU32(&pirp->irp_u32NumOfFulltime, pir->ir_u32Index + 1);
         }
-    
-        if (u32Ret == JF_ERR_NO_ERROR)
+        else
         {
-            /* append the resource to the array */
+            /*Append the resource to the array and move it before the free resources.*/
+            pir->ir_u32Index = jf_array_getSize(pja);
             u32Ret = jf_array_appendElementTo(pja, (jf_array_element_t *)pir);
+            if (u32Ret == JF_ERR_NO_ERROR)
+            {
+                _swapResourceInPoolArray(pja, pir->ir_u32Index, pirp->irp_u32NumOfBusyParttime);
+                pirp->irp_u32NumOfBusyParttime ++;
+            }
         }
-
-        _unlockResourcePool(pirp);
     }
 
     if (u32Ret == JF_ERR_NO_ERROR)
@@ -332,46 +497,71 @@ static u32 _createResourceInPoolArray(
     return u32Ret;
 }
 
-/** Create resource.
+/** Get free parttime resource, the lock of pool must be held. The first free resource is the one
+ *  after the busy resources.
  *
- *  @param pirp [in] The pointer to the resource pool.
- *  @param ppjrr [in/out] The pointer to the resource to be created.
+ *  @param pirp [in] The pointer to internal resource pool.
+ *  @param ppRes [in/out] The pointer to the resource.
  *
  *  @return The error code.
  *  @retval JF_ERR_NO_ERROR Success.
- *  @retval JF_ERR_OUT_OF_MEMORY Out of memeory.
- *  @retval JF_ERR_INVALID_PARAM Invalid parameter.
+ *  @retval JF_ERR_NOT_FOUND No free resource in array.
  */
-static u32 _createResourceInPool(
-    internal_resource_pool_t * pirp, jf_respool_resource_t ** ppjrr)
+static u32 _getResourceFromPoolArray(
+    internal_resource_pool_t * pirp, jf_respool_resource_t ** ppRes)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_resource_t * pir = NULL;
 
-    u32Ret = _createResourceInPoolArray(pirp, TRUE, IRS_BUSY, ppjrr);
-    if (u32Ret != JF_ERR_NO_ERROR)
+    u32Ret = jf_array_getElementAt(
+        pirp->irp_pjaParttimeResources, pirp->irp_u32NumOfBusyParttime,
+        (jf_array_element_t **)&pir);
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        jf_logger_logDebugMsg("find free resource from parttime array");
+        _setPoolResourceState(pir, IRS_BUSY);
+        pirp->irp_u32NumOfBusyParttime ++;
+        *ppRes = pir;
+    }
+    else
     {
-        u32Ret = _createResourceInPoolArray(pirp, FALSE, IRS_BUSY, ppjrr);
+        u32Ret = JF_ERR_NOT_FOUND;
     }
 
-    return u32Ret;    
+    return u32Ret;
 }
 
-/** Destroy all resources in array
+/** Get resource from pool with lock held. The resource is from the stack of free fulltime
+ *  resources, the free parttime resources or a new created resource.
  *
- *  @param pirp [in] The pointer to the resource pool to be destroyed. 
- *  @param ppja [in/out] The pointer to the array to be destroyed. 
+ *  @param pirp [in] The pointer to internal resource pool.
+ *  @param ppRes [in/out] The pointer to the resource.
  *
  *  @return The error code.
  *  @retval JF_ERR_NO_ERROR Success.
+ *  @retval JF_ERR_REACH_MAX_RESOURCES Reach maximum resources.
  */
-static u32 _destroyResourceArray(internal_resource_pool_t * pirp, jf_array_t ** ppja)
+static u32 _getResourceFromPoolLocked(
+    internal_resource_pool_t * pirp, jf_respool_resource_t ** ppRes)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
 
     u32Ret = _lockResourcePool(pirp);
     if (u32Ret == JF_ERR_NO_ERROR)
     {
-        jf_array_destroyArrayAndElements(ppja, _destroyArrayResource);
+        /*The fulltime resource may be put after the stack is checked.*/
+        *ppRes = _popFulltimeResource(pirp);
+        if (*ppRes == NULL)
+            u32Ret = _createResourceInPoolArray(pirp, TRUE, ppRes);
+
+        if (u32Ret != JF_ERR_NO_ERROR)
+        {
+            jf_logger_logDebugMsg("get resource from parttime pool array");
+            u32Ret = _getResourceFromPoolArray(pirp, ppRes);
+        }
+
+        if (u32Ret != JF_ERR_NO_ERROR)
+            u32Ret = _createResourceInPoolArray(pirp, FALSE, ppRes);
 
         _unlockResourcePool(pirp);
     }
@@ -379,116 +569,146 @@ static u32 _destroyResourceArray(internal_resource_pool_t * pirp, jf_array_t **
     return u32Ret;
 }
 
-/** Destroy all resources in pool.
+/** Try to get resource from pool without waiting.
  *
- *  @param pirp [in] The pointer to the resource pool to be destroyed. 
+ *  @param pirp [in] The pointer to internal resource pool.
+ *  @param ppRes [in/out] The pointer to the resource.
  *
  *  @return The error code.
  *  @retval JF_ERR_NO_ERROR Success.
+ *  @retval JF_ERR_REACH_MAX_RESOURCES Reach maximum resources.
  */
-static u32 _destroyAllResources(internal_resource_pool_t * pirp)
+static u32 _tryGetResourceFromPool(
+    internal_resource_pool_t * pirp, jf_respool_resource_t ** ppRes)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
 
-    /*Destroy the full time resource.*/
-    jf_logger_logDebugMsg("destroy resource in fulltime array");
-    u32Ret = _destroyResourceArray(pirp, &pirp->irp_pjaFulltimeResources);
-    if (u32Ret != JF_ERR_NO_ERROR)
-    {
-        jf_logger_logErrMsg(
-            u32Ret, "failed to destroy full time resource array of resource pool %s",
-            pirp->irp_strName);
-    }
+    /*Fast path, get resource from the stack of free fulltime resources.*/
+    *ppRes = _popFulltimeResource(pirp);
+    if (*ppRes != NULL)
+        jf_atomic_fetchAddU64(&pirp->irp_u64NumOfFastGet, 1);
+    else
+        u32Ret = _getResourceFromPoolLocked(pirp, ppRes);
 
-    /*Destroy the part time resource.*/
-    jf_logger_logDebugMsg("destroy resource in parttime array");
-    u32Ret = _destroyResourceArray(pirp, &pirp->irp_pjaParttimeResources);
-    if (u32Ret != JF_ERR_NO_ERROR)
-    {
-        jf_logger_logErrMsg(
-            u32Ret, "failed to destroy part time resource array of resource pool %s",
-            pirp->irp_strName);
-    }
+    if (u32Ret == JF_ERR_NO_ERROR)
+        _markResourceBusy(pirp);
 
     return u32Ret;
 }
 
-/** Create a resource pool according to the parameters.
+/** Wait until resource is put or timeout.
  *
- *  @param ppirp [in/out] The pointer to the resource pool to be created and returned.
- *  @param pjrcp [in] The parameters for creating the resource pool.
+ *  @note
+ *  -# The waiter is counted before the put sequence is read, so the putter either sees the waiter
+ *   or changes the put sequence after the waiter reads it, the wake up is not lost.
+ *
+ *  @param pirp [in] The pointer to internal resource pool.
+ *  @param ppRes [in/out] The pointer to the resource.
+ *  @param u32Timeout [in] The timeout in millisecond.
  *
  *  @return The error code.
  *  @retval JF_ERR_NO_ERROR Success.
- *  @retval JF_ERR_OUT_OF_MEMORY Out of memeory.
- *  @retval JF_ERR_INVALID_PARAM Invalid parameter.
- *
+ *  @retval JF_ERR_TIMEOUT Timeout.
  */
-static u32 _createResourcePool(
-    internal_resource_pool_t ** ppirp, jf_respool_create_param_t * pjrcp)
+static u32 _waitResourceInPool(
+    internal_resource_pool_t * pirp, jf_respool_resource_t ** ppRes, u32 u32Timeout)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
-    internal_resource_pool_t * pirp;
+    u64 u64Start = _getResourcePoolTime(), u64Elapsed = 0;
+    u32 u32Seq, u32Wait = JF_ATOMIC_WAIT_FOREVER;
 
-    u32Ret = jf_jiukun_allocMemory((void **)&pirp, sizeof(internal_resource_pool_t));
-    if (u32Ret == JF_ERR_NO_ERROR)
-    {
-        ol_bzero(pirp, sizeof(internal_resource_pool_t));
+    jf_logger_logDebugMsg("wait resource in pool");
 
-        u32Ret = jf_mutex_init(&(pirp->irp_jmLock));
-    }
+    jf_atomic_fetchAddU32(&pirp->irp_u32NumOfWaiter, 1);
+    jf_atomic_fetchAddU64(&pirp->irp_u64NumOfWait, 1);
 
-    if (u32Ret == JF_ERR_NO_ERROR)
+    do
     {
-        u32Ret = jf_array_create(&(pirp->irp_pjaFulltimeResources));
-    }
+        u32Seq = jf_atomic_loadU32(&pirp->irp_u32PutSeq);
 
-    if (u32Ret == JF_ERR_NO_ERROR)
-    {
-        u32Ret = jf_array_create(&(pirp->irp_pjaParttimeResources));
-    }
-    
-    if (u32Ret == JF_ERR_NO_ERROR)
-    {
-        pirp->irp_fnCreateResource = pjrcp->jrcp_fnCreateResource;
-        pirp->irp_fnDestroyResource = pjrcp->jrcp_fnDestroyResource;
+        u32Ret = _tryGetResourceFromPool(pirp, ppRes);
+        if (u32Ret != JF_ERR_REACH_MAX_RESOURCES)
+            break;
 
-        pirp->irp_u32MaxResources = pjrcp->jrcp_u32MaxResources;
-        pirp->irp_u32MinResources = pjrcp->jrcp_u32MinResources;
+        if (u32Timeout != JF_RESPOOL_WAIT_FOREVER)
+        {
+            u64Elapsed = (_getResourcePoolTime() - u64Start) / 1000;
+            if (u64Elapsed >= u32Timeout)
+            {
+                u32Ret = JF_ERR_TIMEOUT;
+                break;
+            }
+            u32Wait = u32Timeout - (u32)u64Elapsed;
+        }
 
-        pirp->irp_bImmediateRelease = TRUE;
-        
-        ol_strcpy(pirp->irp_strName, pjrcp->jrcp_pstrName);
-    }
+        jf_atomic_waitU32(&pirp->irp_u32PutSeq, u32Seq, u32Wait);
+    } while (TRUE);
 
-    if (u32Ret == JF_ERR_NO_ERROR)
-        *ppirp = pirp;
-    else
-        jf_respool_destroy((jf_respool_t **)&pirp);
+    jf_atomic_fetchAddU32(&pirp->irp_u32NumOfWaiter, (u32)-1);
+
+    u64Elapsed = _getResourcePoolTime() - u64Start;
+    jf_atomic_fetchAddU64(&pirp->irp_u64WaitTime, u64Elapsed);
+    _updateResourcePoolMaxU64(&pirp->irp_u64MaxWaitTime, u64Elapsed);
+    if (u32Ret == JF_ERR_TIMEOUT)
+        jf_atomic_fetchAddU64(&pirp->irp_u64NumOfTimeout, 1);
 
     return u32Ret;
 }
 
-/** Get resource from array in resource pool.
+/** Get resource from resource pool.
  *
  *  @param pirp [in] The pointer to internal resource pool.
- *  @param pja [in] The array contains resources.
- *  @param ppRes [in/out] The pointer to the resource. 
+ *  @param ppRes [in/out] The pointer to the resource.
+ *  @param u32Timeout [in] The timeout in millisecond if no resource is available, 0 for no wait.
  *
  *  @return The error code.
  *  @retval JF_ERR_NO_ERROR Success.
  */
-static u32 _getResourceFromPoolArray(
-    internal_resource_pool_t * pirp, jf_array_t * pja, jf_respool_resource_t ** ppRes)
+static u32 _getResourceFromPool(
+    internal_resource_pool_t * pirp, jf_respool_resource_t ** ppRes, u32 u32Timeout)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
 
-    *ppRes = NULL;
+    jf_atomic_fetchAddU64(&pirp->irp_u64NumOfGet, 1);
+
+    u32Ret = _tryGetResourceFromPool(pirp, ppRes);
+
+    if ((u32Ret == JF_ERR_REACH_MAX_RESOURCES) && (u32Timeout != 0))
+        u32Ret = _waitResourceInPool(pirp, ppRes, u32Timeout);
+
+    return u32Ret;
+}
+
+/** Destroy all resources in pool.
+ *
+ *  @param pirp [in] The pointer to the resource pool to be destroyed.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ */
+static u32 _destroyAllResources(internal_resource_pool_t * pirp)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Index;
 
     u32Ret = _lockResourcePool(pirp);
     if (u32Ret == JF_ERR_NO_ERROR)
     {
-        u32Ret = jf_array_findElement(pja, (jf_array_element_t **)ppRes, _findArrayResource, NULL);
+        /*Destroy the full time resource.*/
+        jf_logger_logDebugMsg("destroy fulltime resource");
+        if (pirp->irp_ppirFulltime != NULL)
+        {
+            for (u32Index = 0; u32Index < pirp->irp_u32NumOfFulltime; u32Index ++)
+                _destroyResourceInPool(pirp, &pirp->irp_ppirFulltime[u32Index]);
+
+            jf_jiukun_freeMemory((void **)&pirp->irp_ppirFulltime);
+        }
+
+        /*Destroy the part time resource.*/
+        jf_logger_logDebugMsg("destroy resource in parttime array");
+        if (pirp->irp_pjaParttimeResources != NULL)
+            jf_array_destroyArrayAndElements(
+                &pirp->irp_pjaParttimeResources, _destroyArrayResource);
 
         _unlockResourcePool(pirp);
     }
@@ -496,43 +716,77 @@ static u32 _getResourceFromPoolArray(
     return u32Ret;
 }
 
-/** Get resource from resource pool.
+/** Create a resource pool according to the parameters.
  *
- *  @param pirp [in] The pointer to internal resource pool.
- *  @param ppRes [in/out] The pointer to the resource. 
+ *  @param ppirp [in/out] The pointer to the resource pool to be created and returned.
+ *  @param pjrcp [in] The parameters for creating the resource pool.
  *
  *  @return The error code.
  *  @retval JF_ERR_NO_ERROR Success.
+ *  @retval JF_ERR_OUT_OF_MEMORY Out of memeory.
+ *  @retval JF_ERR_INVALID_PARAM Invalid parameter.
+ *
  */
-static u32 _getResourceFromPool(
-    internal_resource_pool_t * pirp, jf_respool_resource_t ** ppRes)
+static u32 _createResourcePool(
+    internal_resource_pool_t ** ppirp, jf_respool_create_param_t * pjrcp)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_resource_pool_t * pirp = NULL;
 
-    /*Get resource from fulltime array*/
-    jf_logger_logDebugMsg("get resource from fulltime pool array");
-    u32Ret = _getResourceFromPoolArray(pirp, pirp->irp_pjaFulltimeResources, ppRes);
-    if (u32Ret != JF_ERR_NO_ERROR)
+    u32Ret = jf_jiukun_allocMemory((void **)&pirp, sizeof(internal_resource_pool_t));
+    if (u32Ret == JF_ERR_NO_ERROR)
     {
-        jf_logger_logDebugMsg("get resource from parttime pool array");
-        u32Ret = _getResourceFromPoolArray(pirp, pirp->irp_pjaParttimeResources, ppRes);
+        ol_bzero(pirp, sizeof(internal_resource_pool_t));
+
+        u32Ret = jf_mutex_init(&(pirp->irp_jmLock));
     }
 
-    if (u32Ret != JF_ERR_NO_ERROR)
+    /*The table of fulltime resources is not grown, so it can be read without lock.*/
+    if ((u32Ret == JF_ERR_NO_ERROR) && (pjrcp->jrcp_u32MinResources > 0))
+        u32Ret = jf_jiukun_allocMemory(
+            (void **)&pirp->irp_ppirFulltime,
+            pjrcp->jrcp_u32MinResources * sizeof(internal_resource_t *));
+
+    if (u32Ret == JF_ERR_NO_ERROR)
     {
-        u32Ret = _createResourceInPool(pirp, ppRes);
+        u32Ret = jf_array_create(&(pirp->irp_pjaParttimeResources));
     }
-    
+
+    /*Reserve the memory so the array is not grown when resource is created.*/
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = jf_array_reserve(
+            pirp->irp_pjaParttimeResources,
+            pjrcp->jrcp_u32MaxResources - pjrcp->jrcp_u32MinResources);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        pirp->irp_fnCreateResource = pjrcp->jrcp_fnCreateResource;
+        pirp->irp_fnDestroyResource = pjrcp->jrcp_fnDestroyResource;
+
+        pirp->irp_u32MaxResources = pjrcp->jrcp_u32MaxResources;
+        pirp->irp_u32MinResources = pjrcp->jrcp_u32MinResources;
+
+        pirp->irp_bImmediateRelease = TRUE;
+
+        ol_strcpy(pirp->irp_strName, pjrcp->jrcp_pstrName);
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        *ppirp = pirp;
+    else if (pirp != NULL)
+        jf_respool_destroy((jf_respool_t **)&pirp);
+
     return u32Ret;
 }
 
 /** Put resource in resource pool.
  *
  *  @param pirp [in] The pointer to internal resource pool.
- *  @param ppjrr [in/out] The pointer to the resource. 
+ *  @param ppjrr [in/out] The pointer to the resource.
  *
  *  @return The error code.
  *  @retval JF_ERR_NO_ERROR Success.
+ *  @retval JF_ERR_INVALID_PARAM The resource is not busy.
  *
  */
 static u32 _putResourceInPool(
@@ -540,23 +794,53 @@ static u32 _putResourceInPool(
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
     internal_resource_t * pir = (internal_resource_t *)*ppjrr;
+    jf_array_t * pja = pirp->irp_pjaParttimeResources;
 
-    u32Ret = _lockResourcePool(pirp);
-    if (u32Ret == JF_ERR_NO_ERROR)
+    if (pir->ir_bFulltime)
     {
-        if (pir->ir_bFulltime)
+        /*The resource is put twice if it's not busy.*/
+        if (jf_atomic_casU32(&pir->ir_u32State, IRS_BUSY, IRS_FREE))
         {
-            _setPoolResourceState(pir, IRS_FREE);
+            _markResourceFree(pirp);
+            _pushFulltimeResource(pirp, pir);
         }
-        else if (pirp->irp_bImmediateRelease)
+        else
+            u32Ret = JF_ERR_INVALID_PARAM;
+    }
+    else
+    {
+        u32Ret = _lockResourcePool(pirp);
+        if (u32Ret == JF_ERR_NO_ERROR)
         {
-            u32Ret = jf_array_removeElement(
-                pirp->irp_pjaParttimeResources, (jf_array_element_t *)pir);
+            if (_isPoolResourceFree(pir))
+                u32Ret = JF_ERR_INVALID_PARAM;
+
+            /*Move the resource to the first free position.*/
             if (u32Ret == JF_ERR_NO_ERROR)
-                _destroyResourceInPool(pirp, &pir);
+            {
+                _markResourceFree(pirp);
+                pirp->irp_u32NumOfBusyParttime --;
+                _swapResourceInPoolArray(pja, pir->ir_u32Index, pirp->irp_u32NumOfBusyParttime);
+                _setPoolResourceState(pir, IRS_FREE);
+            }
+
+            if ((u32Ret == JF_ERR_NO_ERROR) && pirp->irp_bImmediateRelease)
+            {
+                u32Ret = _removeResourceFromPoolArray(pja, pir);
+                if (u32Ret == JF_ERR_NO_ERROR)
+                    _destroyResourceInPool(pirp, &pir);
+            }
+
+            _unlockResourcePool(pirp);
         }
+    }
 
-        _unlockResourcePool(pirp);
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        /*Wake up one waiter, a resource is free or a parttime resource can be created.*/
+        jf_atomic_fetchAddU32(&pirp->irp_u32PutSeq, 1);
+        if (jf_atomic_loadU32(&pirp->irp_u32NumOfWaiter) > 0)
+            jf_atomic_wakeU32(&pirp->irp_u32PutSeq, FALSE);
     }
 
     *ppjrr = NULL;
@@ -566,7 +850,7 @@ static u32 _putResourceInPool(
 
 /** Find the free parttime resources, and release them.
  *
- *  @param pirp [in] The pointer to the internal resource pool. 
+ *  @param pirp [in] The pointer to the internal resource pool.
  *
  *  @return The error code.
  *  @retval JF_ERR_NO_ERROR Success.
@@ -575,35 +859,21 @@ static u32 _reapResourceInPool(internal_resource_pool_t * pirp)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
     jf_array_t * pja;
-    internal_resource_t * pir;
-    boolean_t bFree;
-    u32 u32Index = 0, u32Size = 0;
-    
+    internal_resource_t * pir = NULL;
+    u32 u32Size = 0;
+
     u32Ret = _lockResourcePool(pirp);
     if (u32Ret == JF_ERR_NO_ERROR)
     {
-        /*The resource can be timed out.*/
+        /*The free resources are after the busy resources, release them from the end of array.*/
         pja = pirp->irp_pjaParttimeResources;
-        u32Index = 0;
         u32Size = jf_array_getSize(pja);
-        while ((u32Ret == JF_ERR_NO_ERROR) && (u32Index < u32Size))
+        while (u32Size > pirp->irp_u32NumOfBusyParttime)
         {
-            u32Ret = jf_array_getElementAt(pja, u32Index, (jf_array_element_t **)&pir);
-            if (u32Ret == JF_ERR_NO_ERROR)
-            {
-                /*Try to destroy it if it free.*/
-                bFree = _isPoolResourceFree(pir);
-                if (bFree)
-                {
-                    pirp->irp_fnDestroyResource(pir, &pir->ir_pjrrdData);
-                    jf_array_removeElementAt(pja, u32Index);
-                    u32Size --;
-                }
-                else
-                {
-                    u32Index ++;
-                }
-            }
+            u32Size --;
+            jf_array_getElementAt(pja, u32Size, (jf_array_element_t **)&pir);
+            jf_array_removeElementAt(pja, u32Size);
+            _destroyResourceInPool(pirp, &pir);
         }
 
         _unlockResourcePool(pirp);
@@ -639,7 +909,7 @@ u32 jf_respool_destroy(jf_respool_t ** ppjr)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
     internal_resource_pool_t * pirp = NULL;
-    
+
     assert(ppjr != NULL);
 
     pirp = (internal_resource_pool_t *)*ppjr;
@@ -667,14 +937,25 @@ u32 jf_respool_getResource(jf_respool_t * pjr, jf_respool_resource_t ** ppRes)
     assert((pjr != NULL) && (ppRes != NULL));
 
     jf_logger_logDebugMsg("get resource from pool");
-    
+
     /*Get resource from pool.*/
-    u32Ret = _getResourceFromPool(pirp, ppRes);
-    if (u32Ret != JF_ERR_NO_ERROR)
-    {
-        u32Ret = _createResourceInPool(pirp, ppRes);
-    }
-    
+    u32Ret = _getResourceFromPool(pirp, ppRes, 0);
+
+    return u32Ret;
+}
+
+u32 jf_respool_getResourceWithTimeout(
+    jf_respool_t * pjr, jf_respool_resource_t ** ppRes, u32 u32Timeout)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_resource_pool_t * pirp = (internal_resource_pool_t *)pjr;
+
+    assert((pjr != NULL) && (ppRes != NULL));
+
+    jf_logger_logDebugMsg("get resource from pool with timeout %u", u32Timeout);
+
+    u32Ret = _getResourceFromPool(pirp, ppRes, u32Timeout);
+
     return u32Ret;
 }
 
@@ -686,7 +967,7 @@ u32 jf_respool_putResource(jf_respool_t * pjr, jf_respool_resource_t ** ppRes)
     assert((pjr != NULL) && (ppRes != NULL));
 
     jf_logger_logDebugMsg("put resource in pool");
-    
+
     u32Ret = _putResourceInPool(pirp, ppRes);
 
     return u32Ret;
@@ -696,7 +977,7 @@ u32 jf_respool_reapResource(jf_respool_t * pjr)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
     internal_resource_pool_t * pirp;
-    
+
     assert(pjr != NULL);
 
     pirp = (internal_resource_pool_t *)pjr;
@@ -705,5 +986,29 @@ u32 jf_respool_reapResource(jf_respool_t * pjr)
     return u32Ret;
 }
 
-/*------------------------------------------------------------------------------------------------*/
+void jf_respool_getStat(jf_respool_t * pjr, jf_respool_stat_t * pjrs)
+{
+    internal_resource_pool_t * pirp = (internal_resource_pool_t *)pjr;
+
+    assert((pjr != NULL) && (pjrs != NULL));
+
+    ol_bzero(pjrs, sizeof(*pjrs));
+
+    pjrs->jrs_u32MaxResources = pirp->irp_u32MaxResources;
+    pjrs->jrs_u32NumOfFulltime = jf_atomic_loadU32(&pirp->irp_u32NumOfFulltime);
+    pjrs->jrs_u32NumOfBusy = jf_atomic_loadU32(&pirp->irp_u32NumOfBusy);
+    pjrs->jrs_u32PeakBusy = jf_atomic_loadU32(&pirp->irp_u32PeakBusy);
+    pjrs->jrs_u32NumOfWaiter = jf_atomic_loadU32(&pirp->irp_u32NumOfWaiter);
+    pjrs->jrs_u64NumOfGet = jf_atomic_loadU64(&pirp->irp_u64NumOfGet);
+    pjrs->jrs_u64NumOfFastGet = jf_atomic_loadU64(&pirp->irp_u64NumOfFastGet);
+    pjrs->jrs_u64NumOfWait = jf_atomic_loadU64(&pirp->irp_u64NumOfWait);
+    pjrs->jrs_u64NumOfTimeout = jf_atomic_loadU64(&pirp->irp_u64NumOfTimeout);
+    pjrs->jrs_u64WaitTime = jf_atomic_loadU64(&pirp->irp_u64WaitTime);
+    pjrs->jrs_u64MaxWaitTime = jf_atomic_loadU64(&pirp->irp_u64MaxWaitTime);
+
+    _lockResourcePool(pirp);
+    pjrs->jrs_u32NumOfParttime = jf_array_getSize(pirp->irp_pjaParttimeResources);
+    _unlockResourcePool(pirp);
+}
 
+/*------------------------------------------------------------------------------------------------*/
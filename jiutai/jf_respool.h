@@ -8,7 +8,7 @@
  *
  *  @note
  *  -# Routines declared in this file are included in jf_respool object.
- *  -# Link with jf_mutex and jf_array common object.
+ *  -# Link with jf_mutex, jf_array and jf_time common object.
  *  -# Link with jiukun library for memory allocation.
  *  -# The object is thread safe.
  *
@@ -25,6 +25,10 @@
 
 /* --- constant definitions --------------------------------------------------------------------- */
 
+/** Wait for resource until it's available.
+ */
+#define JF_RESPOOL_WAIT_FOREVER                  (0xFFFFFFFF)
+
 /* --- data structures -------------------------------------------------------------------------- */
 
 /** Define the resource pool data type.
@@ -88,6 +92,36 @@ typedef struct
     u32 jrcp_u32Reserved2[4];
 } jf_respool_create_param_t;
 
+/** The statistics of resource pool.
+ */
+typedef struct
+{
+    /**Maximum number of resources.*/
+    u32 jrs_u32MaxResources;
+    /**Number of fulltime resources.*/
+    u32 jrs_u32NumOfFulltime;
+    /**Number of parttime resources.*/
+    u32 jrs_u32NumOfParttime;
+    /**Number of busy resources.*/
+    u32 jrs_u32NumOfBusy;
+    /**Peak number of busy resources.*/
+    u32 jrs_u32PeakBusy;
+    /**Number of threads waiting for resource.*/
+    u32 jrs_u32NumOfWaiter;
+    /**Number of get operations.*/
+    u64 jrs_u64NumOfGet;
+    /**Number of get operations which don't take the lock.*/
+    u64 jrs_u64NumOfFastGet;
+    /**Number of get operations which wait for resource.*/
+    u64 jrs_u64NumOfWait;
+    /**Number of get operations which time out.*/
+    u64 jrs_u64NumOfTimeout;
+    /**Total wait time in microsecond.*/
+    u64 jrs_u64WaitTime;
+    /**Maximum wait time in microsecond.*/
+    u64 jrs_u64MaxWaitTime;
+} jf_respool_stat_t;
+
 /* --- functional routines ---------------------------------------------------------------------- */
 
 /** Create a resource pool according to the parameters.
@@ -125,6 +159,25 @@ u32 jf_respool_destroy(jf_respool_t ** ppjr);
  */
 u32 jf_respool_getResource(jf_respool_t * pjr, jf_respool_resource_t ** ppRes);
 
+/** Get resource from resource pool, wait if no resource is available.
+ *
+ *  @note
+ *  -# The free fulltime resource is got without lock.
+ *  -# The waiting thread is woken up when a resource is put.
+ *
+ *  @param pjr [in] The pointer to resource pool.
+ *  @param ppRes [in/out] The pointer to the resource.
+ *  @param u32Timeout [in] The timeout in millisecond, 0 for no wait, JF_RESPOOL_WAIT_FOREVER to
+ *   wait until resource is available.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ *  @retval JF_ERR_REACH_MAX_RESOURCES Reach maximum resources and no wait.
+ *  @retval JF_ERR_TIMEOUT No resource is available before timeout.
+ */
+u32 jf_respool_getResourceWithTimeout(
+    jf_respool_t * pjr, jf_respool_resource_t ** ppRes, u32 u32Timeout);
+
 /** Put resource in resource pool.
  *
  *  @note
@@ -138,6 +191,24 @@ u32 jf_respool_getResource(jf_respool_t * pjr, jf_respool_resource_t ** ppRes);
  */
 u32 jf_respool_putResource(jf_respool_t * pjr, jf_respool_resource_t ** ppRes);
 
+/** Release the free parttime resources in resource pool.
+ *
+ *  @param pjr [in] The pointer to resource pool.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ */
+u32 jf_respool_reapResource(jf_respool_t * pjr);
+
+/** Get the statistics of resource pool.
+ *
+ *  @param pjr [in] The pointer to resource pool.
+ *  @param pjrs [out] The statistics of resource pool.
+ *
+ *  @return Void.
+ */
+void jf_respool_getStat(jf_respool_t * pjr, jf_respool_stat_t * pjrs);
+
 #endif /*JIUTAI_RESPOOL_H*/
 
 /*------------------------------------------------------------------------------------------------*/
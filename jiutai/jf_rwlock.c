@@ -6,7 +6,10 @@
  *  @author Min Zhang
  *
  *  @note
- *  
+ *  -# The distributed read-write lock and sequence lock are based on the atomic operations, the
+ *   thread is blocked with jf_atomic_waitU32() after spinning for a while.
+ *  -# The writer state of the distributed read-write lock and sequence lock is a mutex with 3
+ *   states, the waiters are woken up only if the state is 2.
  */
 
 /* --- standard C lib header files -------------------------------------------------------------- */
@@ -20,6 +23,24 @@
 
 /* --- private data/data structure section ------------------------------------------------------ */
 
+/** Number of spins before the thread is blocked.
+ */
+#define RWLOCK_SPIN_COUNT                 (100)
+
+#if defined(LINUX)
+    #define RWLOCK_THREAD_LOCAL           __thread
+#elif defined(WINDOWS)
+    #define RWLOCK_THREAD_LOCAL           __declspec(thread)
+#endif
+
+/** The reader slot of the thread plus 1, 0 means the slot is not assigned.
+ */
+static RWLOCK_THREAD_LOCAL u32 ls_u32DrwlockReaderSlot = 0;
+
+/** The slot assigned to the next thread, the threads are spread over slots evenly.
+ */
+static volatile u32 ls_u32DrwlockNextSlot = 0;
+
 /* --- private routine section ------------------------------------------------------------------ */
 #if defined(WINDOWS)
 static u32 _acquireSyncReadlock(jf_rwlock_t * pRwlock, u32 u32Timeout)
@@ -147,6 +168,109 @@ static u32 _acquireSyncWritelock(jf_rwlock_t * pRwlock, u32 u32Timeout)
 
 #endif
 
+static inline volatile u32 * _getDrwlockReaderCount(jf_drwlock_t * pDrwlock)
+{
+    if (ls_u32DrwlockReaderSlot == 0)
+        ls_u32DrwlockReaderSlot =
+            jf_atomic_fetchAddU32(&ls_u32DrwlockNextSlot, 1) % JF_DRWLOCK_NUM_OF_READER_SLOT + 1;
+
+    return &pDrwlock->jd_jdrsReader[ls_u32DrwlockReaderSlot - 1].jdrs_u32Count;
+}
+
+static boolean_t _tryLockWriterState(volatile u32 * pu32State)
+{
+    return jf_atomic_casU32(pu32State, 0, 1);
+}
+
+static void _lockWriterState(volatile u32 * pu32State)
+{
+    u32 u32State, u32Spin;
+
+    for (u32Spin = 0; u32Spin < RWLOCK_SPIN_COUNT; u32Spin ++)
+    {
+        if ((jf_atomic_loadU32(pu32State) == 0) && _tryLockWriterState(pu32State))
+            return;
+
+        jf_atomic_pause();
+    }
+
+    /*Mark the waiter, the state is kept as 2 after the lock is acquired as there may be other
+      waiters.*/
+    u32State = jf_atomic_exchangeU32(pu32State, 2);
+    while (u32State != 0)
+    {
+        jf_atomic_waitU32(pu32State, 2, JF_ATOMIC_WAIT_FOREVER);
+        u32State = jf_atomic_exchangeU32(pu32State, 2);
+    }
+}
+
+static void _unlockWriterState(volatile u32 * pu32State)
+{
+    if (jf_atomic_exchangeU32(pu32State, 0) == 2)
+        jf_atomic_wakeU32(pu32State, TRUE);
+}
+
+/** Wait until the writer state is unlocked, the state is not acquired.
+ */
+static void _waitWriterState(volatile u32 * pu32State)
+{
+    u32 u32State, u32Spin = 0;
+
+    while ((u32State = jf_atomic_loadU32(pu32State)) != 0)
+    {
+        if (u32Spin < RWLOCK_SPIN_COUNT)
+        {
+            jf_atomic_pause();
+            u32Spin ++;
+        }
+        else if ((u32State == 2) || jf_atomic_casU32(pu32State, 1, 2))
+        {
+            jf_atomic_waitU32(pu32State, 2, JF_ATOMIC_WAIT_FOREVER);
+        }
+    }
+}
+
+static void _leaveDrwlockRead(jf_drwlock_t * pDrwlock, volatile u32 * pu32Count)
+{
+    /*The decrement is a full barrier, the writer state is read after it. The writer waiting for
+      the counter is woken up by the last reader of the slot.*/
+    if ((jf_atomic_fetchAddU32(pu32Count, (u32)-1) == 1) &&
+        (jf_atomic_loadU32(&pDrwlock->jd_u32Writer) != 0))
+        jf_atomic_wakeU32(pu32Count, TRUE);
+}
+
+static boolean_t _tryEnterDrwlockRead(jf_drwlock_t * pDrwlock, volatile u32 * pu32Count)
+{
+    /*The increment is a full barrier, the writer state is read after it.*/
+    jf_atomic_fetchAddU32(pu32Count, 1);
+
+    if (jf_atomic_loadU32(&pDrwlock->jd_u32Writer) == 0)
+        return TRUE;
+
+    /*Back off for the writer.*/
+    _leaveDrwlockRead(pDrwlock, pu32Count);
+
+    return FALSE;
+}
+
+static void _waitDrwlockReader(volatile u32 * pu32Count)
+{
+    u32 u32Count, u32Spin = 0;
+
+    while ((u32Count = jf_atomic_loadU32(pu32Count)) != 0)
+    {
+        if (u32Spin < RWLOCK_SPIN_COUNT)
+        {
+            jf_atomic_pause();
+            u32Spin ++;
+        }
+        else
+        {
+            jf_atomic_waitU32(pu32Count, u32Count, JF_ATOMIC_WAIT_FOREVER);
+        }
+    }
+}
+
 /* --- public routine section ------------------------------------------------------------------- */
 
 u32 jf_rwlock_init(jf_rwlock_t * pRwlock)
@@ -460,6 +584,164 @@ u32 jf_rwlock_releaseWritelock(jf_rwlock_t * pRwlock)
     return u32Ret;
 }
 
+u32 jf_drwlock_init(jf_drwlock_t * pDrwlock)
+{
+    assert(pDrwlock != NULL);
+
+    ol_bzero(pDrwlock, sizeof(*pDrwlock));
+
+    return JF_ERR_NO_ERROR;
+}
+
+u32 jf_drwlock_fini(jf_drwlock_t * pDrwlock)
+{
+    assert(pDrwlock != NULL);
+    assert(pDrwlock->jd_u32Writer == 0);
+
+    return JF_ERR_NO_ERROR;
+}
+
+u32 jf_drwlock_acquireReadlock(jf_drwlock_t * pDrwlock)
+{
+    volatile u32 * pu32Count = _getDrwlockReaderCount(pDrwlock);
+
+    while (! _tryEnterDrwlockRead(pDrwlock, pu32Count))
+        _waitWriterState(&pDrwlock->jd_u32Writer);
+
+    return JF_ERR_NO_ERROR;
+}
+
+u32 jf_drwlock_tryAcquireReadlock(jf_drwlock_t * pDrwlock)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+
+    if (! _tryEnterDrwlockRead(pDrwlock, _getDrwlockReaderCount(pDrwlock)))
+        u32Ret = JF_ERR_FAIL_ACQUIRE_RWLOCK;
+
+    return u32Ret;
+}
+
+u32 jf_drwlock_releaseReadlock(jf_drwlock_t * pDrwlock)
+{
+    _leaveDrwlockRead(pDrwlock, _getDrwlockReaderCount(pDrwlock));
+
+    return JF_ERR_NO_ERROR;
+}
+
+u32 jf_drwlock_acquireWritelock(jf_drwlock_t * pDrwlock)
+{
+    u32 u32Slot;
+
+    /*New readers back off after the writer state is locked.*/
+    _lockWriterState(&pDrwlock->jd_u32Writer);
+
+    for (u32Slot = 0; u32Slot < JF_DRWLOCK_NUM_OF_READER_SLOT; u32Slot ++)
+        _waitDrwlockReader(&pDrwlock->jd_jdrsReader[u32Slot].jdrs_u32Count);
+
+    return JF_ERR_NO_ERROR;
+}
+
+u32 jf_drwlock_tryAcquireWritelock(jf_drwlock_t * pDrwlock)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Slot;
+
+    if (! _tryLockWriterState(&pDrwlock->jd_u32Writer))
+        return JF_ERR_FAIL_ACQUIRE_RWLOCK;
+
+    for (u32Slot = 0; (u32Slot < JF_DRWLOCK_NUM_OF_READER_SLOT) && (u32Ret == JF_ERR_NO_ERROR);
+         u32Slot ++)
+        if (jf_atomic_loadU32(&pDrwlock->jd_jdrsReader[u32Slot].jdrs_u32Count) != 0)
+            u32Ret = JF_ERR_FAIL_ACQUIRE_RWLOCK;
+
+    /*The readers backing off are woken up.*/
+    if (u32Ret != JF_ERR_NO_ERROR)
+        _unlockWriterState(&pDrwlock->jd_u32Writer);
+
+    return u32Ret;
+}
+
+u32 jf_drwlock_releaseWritelock(jf_drwlock_t * pDrwlock)
+{
+    _unlockWriterState(&pDrwlock->jd_u32Writer);
+
+    return JF_ERR_NO_ERROR;
+}
+
+u32 jf_seqlock_init(jf_seqlock_t * pSeqlock)
+{
+    assert(pSeqlock != NULL);
+
+    ol_bzero(pSeqlock, sizeof(*pSeqlock));
+
+    return JF_ERR_NO_ERROR;
+}
+
+u32 jf_seqlock_fini(jf_seqlock_t * pSeqlock)
+{
+    assert(pSeqlock != NULL);
+    assert(pSeqlock->js_u32Writer == 0);
+
+    return JF_ERR_NO_ERROR;
+}
+
+u32 jf_seqlock_waitWriter(jf_seqlock_t * pSeqlock)
+{
+    u32 u32Sequence;
+
+    /*The sequence is even before the writer state is unlocked.*/
+    while (((u32Sequence = jf_atomic_loadU32(&pSeqlock->js_u32Sequence)) & 1) != 0)
+        _waitWriterState(&pSeqlock->js_u32Writer);
+
+    return u32Sequence;
+}
+
+u32 jf_seqlock_acquireWritelock(jf_seqlock_t * pSeqlock)
+{
+    _lockWriterState(&pSeqlock->js_u32Writer);
+
+    jf_atomic_storeU32(&pSeqlock->js_u32Sequence, pSeqlock->js_u32Sequence + 1);
+    /*The odd sequence is visible before the data is changed.*/
+    jf_atomic_fence();
+
+    return JF_ERR_NO_ERROR;
+}
+
+u32 jf_seqlock_releaseWritelock(jf_seqlock_t * pSeqlock)
+{
+    /*The store has release semantic, the data is changed before the sequence is even.*/
+    jf_atomic_storeU32(&pSeqlock->js_u32Sequence, pSeqlock->js_u32Sequence + 1);
+
+    _unlockWriterState(&pSeqlock->js_u32Writer);
+
+    return JF_ERR_NO_ERROR;
+}
+
+u32 jf_seqlock_readData(jf_seqlock_t * pSeqlock, void * pDest, const void * pSrc, olsize_t sData)
+{
+    u32 u32Sequence;
+
+    do
+    {
+        u32Sequence = jf_seqlock_beginRead(pSeqlock);
+
+        ol_memcpy(pDest, pSrc, sData);
+    } while (jf_seqlock_retryRead(pSeqlock, u32Sequence));
+
+    return JF_ERR_NO_ERROR;
+}
+
+u32 jf_seqlock_writeData(jf_seqlock_t * pSeqlock, void * pDest, const void * pSrc, olsize_t sData)
+{
+    jf_seqlock_acquireWritelock(pSeqlock);
+
+    ol_memcpy(pDest, pSrc, sData);
+
+    jf_seqlock_releaseWritelock(pSeqlock);
+
+    return JF_ERR_NO_ERROR;
+}
+
 /*------------------------------------------------------------------------------------------------*/
 
 
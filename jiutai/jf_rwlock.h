@@ -7,6 +7,12 @@
  *
  *  @note
  *  -# Routines declared in this file are included in jf_rwlock object.
+ *  -# The distributed read-write lock is for data which is read mostly. The reader only changes the
+ *   counter of its slot, the slot is assigned to thread when the thread acquires read lock first
+ *   time. The writer waits until the counters of all slots are 0, the waiting writer blocks new
+ *   readers.
+ *  -# The sequence lock is for small data which is copied by readers. The reader never blocks the
+ *   writer, the reader retries if the data is changed when it's being read.
  *
  */
 
@@ -17,9 +23,18 @@
 
 /* --- internal header files -------------------------------------------------------------------- */
 #include "jf_basic.h"
+#include "jf_atomic.h"
 
 /* --- constant definitions --------------------------------------------------------------------- */
 
+/** Number of reader slots in distributed read-write lock.
+ */
+#define JF_DRWLOCK_NUM_OF_READER_SLOT      (16)
+
+/** Size of reader slot, the slots are in different cache lines.
+ */
+#define JF_DRWLOCK_READER_SLOT_SIZE        (64)
+
 /* --- data structures -------------------------------------------------------------------------- */
 
 /** Define the read-write lock data type.
@@ -50,6 +65,39 @@ typedef struct
 #endif
 } jf_rwlock_t;
 
+/** Define the reader slot data type of distributed read-write lock.
+ */
+typedef struct
+{
+    /**Number of readers in the slot.*/
+    volatile u32 jdrs_u32Count;
+    u8 jdrs_u8Pad[JF_DRWLOCK_READER_SLOT_SIZE - sizeof(u32)];
+} jf_drwlock_reader_slot_t;
+
+/** Define the distributed read-write lock data type.
+ *
+ *  @note
+ *  -# The lock should be cache line aligned so the slots are not shared with other data.
+ */
+typedef struct
+{
+    /**The reader slots.*/
+    jf_drwlock_reader_slot_t jd_jdrsReader[JF_DRWLOCK_NUM_OF_READER_SLOT];
+    /**The writer state, 0: unlocked, 1: locked, 2: locked and there are waiters.*/
+    volatile u32 jd_u32Writer;
+    u8 jd_u8Pad[JF_DRWLOCK_READER_SLOT_SIZE - sizeof(u32)];
+} jf_drwlock_t;
+
+/** Define the sequence lock data type.
+ */
+typedef struct
+{
+    /**The sequence, it's odd when the writer is changing the data.*/
+    volatile u32 js_u32Sequence;
+    /**The writer state, 0: unlocked, 1: locked, 2: locked and there are waiters.*/
+    volatile u32 js_u32Writer;
+} jf_seqlock_t;
+
 /* --- functional routines ---------------------------------------------------------------------- */
 
 /** Initialize the read-write lock.
@@ -163,6 +211,201 @@ u32 jf_rwlock_acquireWritelockWithTimeout(jf_rwlock_t * pRwlock, u32 u32Timeout)
  */
 u32 jf_rwlock_releaseWritelock(jf_rwlock_t * pRwlock);
 
+/** Initialize the distributed read-write lock.
+ *
+ *  @param pDrwlock [in] The distributed read-write lock to be initialized.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ */
+u32 jf_drwlock_init(jf_drwlock_t * pDrwlock);
+
+/** Finalize the distributed read-write lock.
+ *
+ *  @param pDrwlock [in] The distributed read-write lock to be finalized.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ */
+u32 jf_drwlock_fini(jf_drwlock_t * pDrwlock);
+
+/** Acquire a read lock of distributed read-write lock.
+ *
+ *  @note
+ *  -# The calling thread is suspended if a writer holds the lock or is waiting for the lock.
+ *  -# The read lock is not recursive, the thread may deadlock with a waiting writer if it acquires
+ *   the read lock again.
+ *
+ *  @param pDrwlock [in] The distributed read-write lock to be acquired.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ */
+u32 jf_drwlock_acquireReadlock(jf_drwlock_t * pDrwlock);
+
+/** Try to acquire a read lock of distributed read-write lock.
+ *
+ *  @param pDrwlock [in] The distributed read-write lock to be acquired.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ *  @retval JF_ERR_FAIL_ACQUIRE_RWLOCK A writer holds the lock or is waiting for the lock.
+ */
+u32 jf_drwlock_tryAcquireReadlock(jf_drwlock_t * pDrwlock);
+
+/** Release a read lock of distributed read-write lock.
+ *
+ *  @note
+ *  -# The read lock should be released by the thread acquiring it.
+ *
+ *  @param pDrwlock [in] The distributed read-write lock to be released.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ */
+u32 jf_drwlock_releaseReadlock(jf_drwlock_t * pDrwlock);
+
+/** Acquire a write lock of distributed read-write lock.
+ *
+ *  @note
+ *  -# New readers are blocked once the writer gets the lock, the writer then waits for the readers
+ *   in all slots.
+ *
+ *  @param pDrwlock [in] The distributed read-write lock to be acquired.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ */
+u32 jf_drwlock_acquireWritelock(jf_drwlock_t * pDrwlock);
+
+/** Try to acquire a write lock of distributed read-write lock.
+ *
+ *  @param pDrwlock [in] The distributed read-write lock to be acquired.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ *  @retval JF_ERR_FAIL_ACQUIRE_RWLOCK The lock is held by reader or writer.
+ */
+u32 jf_drwlock_tryAcquireWritelock(jf_drwlock_t * pDrwlock);
+
+/** Release a write lock of distributed read-write lock.
+ *
+ *  @param pDrwlock [in] The distributed read-write lock to be released.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ */
+u32 jf_drwlock_releaseWritelock(jf_drwlock_t * pDrwlock);
+
+/** Initialize the sequence lock.
+ *
+ *  @param pSeqlock [in] The sequence lock to be initialized.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ */
+u32 jf_seqlock_init(jf_seqlock_t * pSeqlock);
+
+/** Finalize the sequence lock.
+ *
+ *  @param pSeqlock [in] The sequence lock to be finalized.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ */
+u32 jf_seqlock_fini(jf_seqlock_t * pSeqlock);
+
+/** Wait until the writer finishes changing the data.
+ *
+ *  @note
+ *  -# The routine is called by jf_seqlock_beginRead(), it spins for a while and then blocks on the
+ *   writer.
+ *
+ *  @param pSeqlock [in] The sequence lock.
+ *
+ *  @return The even sequence.
+ */
+u32 jf_seqlock_waitWriter(jf_seqlock_t * pSeqlock);
+
+/** Begin to read the data protected by sequence lock.
+ *
+ *  @note
+ *  -# The data read may be inconsistent, it can be used only after jf_seqlock_retryRead()
+ *   returns FALSE.
+ *
+ *  @param pSeqlock [in] The sequence lock.
+ *
+ *  @return The sequence for jf_seqlock_retryRead().
+ */
+static inline u32 jf_seqlock_beginRead(jf_seqlock_t * pSeqlock)
+{
+    u32 u32Sequence = jf_atomic_loadU32(&pSeqlock->js_u32Sequence);
+
+    if ((u32Sequence & 1) != 0)
+        u32Sequence = jf_seqlock_waitWriter(pSeqlock);
+
+    return u32Sequence;
+}
+
+/** Check if the data is changed after the read begins.
+ *
+ *  @param pSeqlock [in] The sequence lock.
+ *  @param u32Sequence [in] The sequence returned by jf_seqlock_beginRead().
+ *
+ *  @return If the read should be retried.
+ *  @retval TRUE The data is changed, read the data again.
+ *  @retval FALSE The data read is consistent.
+ */
+static inline boolean_t jf_seqlock_retryRead(jf_seqlock_t * pSeqlock, u32 u32Sequence)
+{
+    /*The data is read before the sequence is checked again.*/
+    jf_atomic_fenceAcquire();
+
+    return (pSeqlock->js_u32Sequence != u32Sequence);
+}
+
+/** Acquire the write lock of sequence lock, the writers are serialized.
+ *
+ *  @param pSeqlock [in] The sequence lock.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ */
+u32 jf_seqlock_acquireWritelock(jf_seqlock_t * pSeqlock);
+
+/** Release the write lock of sequence lock.
+ *
+ *  @param pSeqlock [in] The sequence lock.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ */
+u32 jf_seqlock_releaseWritelock(jf_seqlock_t * pSeqlock);
+
+/** Copy the data protected by sequence lock, the copy is consistent.
+ *
+ *  @param pSeqlock [in] The sequence lock.
+ *  @param pDest [out] The buffer for the copy.
+ *  @param pSrc [in] The data protected by sequence lock.
+ *  @param sData [in] Size of the data.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ */
+u32 jf_seqlock_readData(jf_seqlock_t * pSeqlock, void * pDest, const void * pSrc, olsize_t sData);
+
+/** Change the data protected by sequence lock with the write lock held.
+ *
+ *  @param pSeqlock [in] The sequence lock.
+ *  @param pDest [out] The data protected by sequence lock.
+ *  @param pSrc [in] The new data.
+ *  @param sData [in] Size of the data.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ */
+u32 jf_seqlock_writeData(jf_seqlock_t * pSeqlock, void * pDest, const void * pSrc, olsize_t sData);
+
 #endif /*JIUTAI_RWLOCK_H*/
 
 /*------------------------------------------------------------------------------------------------*/
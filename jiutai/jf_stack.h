@@ -10,6 +10,8 @@
  *  -# The stack is first in, last out.
  *  -# Link with jf_jiukun library for memory allocation.
  *  -# This object is not thread safe.
+ *  -# jf_stack allocates a node for each item. The intrusive stack jf_istack has the link embedded
+ *   in the item, the push and pop don't allocate memory.
  *  
  */
 
@@ -22,6 +24,7 @@
 /* --- internal header files -------------------------------------------------------------------- */
 #include "jf_basic.h"
 #include "jf_err.h"
+#include "jf_listhead.h"
 
 /* --- constant definitions --------------------------------------------------------------------- */
 
@@ -41,6 +44,22 @@ typedef struct jf_stack_node
  */
 typedef void  jf_stack_t;
 
+/** Define the link data type of intrusive stack, it's embedded in the item.
+ */
+typedef struct jf_stack_link
+{
+    /**The next link.*/
+    struct jf_stack_link * jsl_pjslNext;
+} jf_stack_link_t;
+
+/** Define the intrusive stack data type.
+ */
+typedef struct jf_istack
+{
+    /**The top link.*/
+    jf_stack_link_t * jis_pjslTop;
+} jf_istack_t;
+
 /* --- functional routines ---------------------------------------------------------------------- */
 
 /** Initialize an empty Stack.
@@ -96,6 +115,79 @@ void * jf_stack_peek(jf_stack_t ** ppStack);
  */
 void jf_stack_clear(jf_stack_t ** ppStack);
 
+/** Initialize an empty intrusive stack.
+ *
+ *  @param pjis [in] The intrusive stack to be initialized.
+ *
+ *  @return Void.
+ */
+static inline void jf_istack_init(jf_istack_t * pjis)
+{
+    pjis->jis_pjslTop = NULL;
+}
+
+/** Check to see if an intrusive stack is empty.
+ *
+ *  @param pjis [in] The intrusive stack to check.
+ *
+ *  @return The stack empty state.
+ *  @retval TRUE the stack is empty.
+ *  @retval FALSE the stack is not empty.
+ */
+static inline boolean_t jf_istack_isEmpty(jf_istack_t * pjis)
+{
+    return (pjis->jis_pjslTop == NULL) ? TRUE : FALSE;
+}
+
+/** Push an item into the intrusive stack.
+ *
+ *  @param pjis [in] The intrusive stack to push to.
+ *  @param pjsl [in] The link embedded in the item.
+ *
+ *  @return Void.
+ */
+static inline void jf_istack_push(jf_istack_t * pjis, jf_stack_link_t * pjsl)
+{
+    pjsl->jsl_pjslNext = pjis->jis_pjslTop;
+    pjis->jis_pjslTop = pjsl;
+}
+
+/** Pop an item from the intrusive stack.
+ *
+ *  @param pjis [in] The intrusive stack to pop from.
+ *
+ *  @return The link embedded in the item, NULL if the stack is empty.
+ */
+static inline jf_stack_link_t * jf_istack_pop(jf_istack_t * pjis)
+{
+    jf_stack_link_t * pjsl = pjis->jis_pjslTop;
+
+    if (pjsl != NULL)
+        pjis->jis_pjslTop = pjsl->jsl_pjslNext;
+
+    return pjsl;
+}
+
+/** Peek the item on the top of the intrusive stack, the item is still in stack.
+ *
+ *  @param pjis [in] The intrusive stack to peek from.
+ *
+ *  @return The link embedded in the item, NULL if the stack is empty.
+ */
+static inline jf_stack_link_t * jf_istack_peek(jf_istack_t * pjis)
+{
+    return pjis->jis_pjslTop;
+}
+
+/** Get the struct for this link.
+ *
+ *  @param ptr [in] The jf_stack_link_t pointer, it cannot be NULL.
+ *  @param type [in] The type of the struct this is embedded in.
+ *  @param member [in] The name of the link within the struct.
+ */
+#define jf_istack_getEntry(ptr, type, member) \
+    container_of(ptr, type, member)
+
 #endif /*JIUTAI_STACK_H*/
 
 /*------------------------------------------------------------------------------------------------*/
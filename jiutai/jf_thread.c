@@ -20,6 +20,7 @@
     #include <sys/stat.h>
     #include <fcntl.h>
     #include <sys/wait.h>
+    #include <sched.h>
 #elif defined(WINDOWS)
     #include <time.h>
     #include <process.h>
@@ -199,6 +200,54 @@ u32 jf_thread_waitForThreadTermination(jf_thread_id_t threadId, u32 * pu32RetCod
     return u32Ret;
 }
 
+u32 jf_thread_getNumOfCpu(void)
+{
+    u32 u32Cpu = 1;
+#if defined(LINUX)
+    long lCpu = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (lCpu > 0)
+        u32Cpu = (u32)lCpu;
+#elif defined(WINDOWS)
+    SYSTEM_INFO si;
+
+    GetSystemInfo(&si);
+    if (si.dwNumberOfProcessors > 0)
+        u32Cpu = si.dwNumberOfProcessors;
+#endif
+
+    return u32Cpu;
+}
+
+u32 jf_thread_setAffinity(jf_thread_id_t * pThreadId, u32 u32Cpu)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+#if defined(LINUX)
+    cpu_set_t cs;
+
+    if (u32Cpu >= CPU_SETSIZE)
+        u32Ret = JF_ERR_INVALID_PARAM;
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        CPU_ZERO(&cs);
+        CPU_SET(u32Cpu, &cs);
+
+        if (pthread_setaffinity_np(pThreadId->jti_ptThreadId, sizeof(cs), &cs) != 0)
+            u32Ret = JF_ERR_FAIL_SET_THREAD_AFFINITY;
+    }
+#elif defined(WINDOWS)
+    if (u32Cpu >= sizeof(DWORD_PTR) * BITS_PER_U8)
+        u32Ret = JF_ERR_INVALID_PARAM;
+
+    if ((u32Ret == JF_ERR_NO_ERROR) &&
+        (SetThreadAffinityMask(pThreadId->jti_hThread, (DWORD_PTR)1 << u32Cpu) == 0))
+        u32Ret = JF_ERR_FAIL_SET_THREAD_AFFINITY;
+#endif
+
+    return u32Ret;
+}
+
 u32 jf_thread_registerSignalHandlers(jf_thread_fnSignalHandler_t fnSignalHandler)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
@@ -97,6 +97,23 @@ u32 jf_thread_terminate(jf_thread_id_t * pThreadId);
  */
 u32 jf_thread_waitForThreadTermination(jf_thread_id_t threadId, u32 * pu32RetCode);
 
+/** Get the number of online CPUs.
+ *
+ *  @return The number of online CPUs, 1 if the number cannot be determined.
+ */
+u32 jf_thread_getNumOfCpu(void);
+
+/** Bind the thread to the CPU.
+ *
+ *  @param pThreadId [in] The thread id.
+ *  @param u32Cpu [in] The CPU index starting from 0.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ *  @retval JF_ERR_FAIL_SET_THREAD_AFFINITY Failed to set the affinity.
+ */
+u32 jf_thread_setAffinity(jf_thread_id_t * pThreadId, u32 u32Cpu);
+
 /** Register signal handler for thread.
  *
  *  @note
@@ -0,0 +1,717 @@
+/**
+ *  @file jf_threadpool.c
+ *
+ *  @brief Implementation file for work stealing thread pool common object.
+ *
+ *  @author Min Zhang
+ *
+ *  @note
+ *  -# The deque follows "Dynamic Circular Work-Stealing Deque" by Chase and Lev, the array is not
+ *   resized, the task is added to the shared queue if the deque is full.
+ *  -# The worker announces it's going to sleep by increasing the number of sleepers and checks the
+ *   tasks again before it's blocked on the signal. The submitter adds the task and checks the
+ *   number of sleepers after a full memory barrier, so the wake up is not missed.
+ *  -# The future is referenced by the task and the submitter, it's freed when both references are
+ *   released, so the worker can wake up the waiter after the future is done.
+ */
+
+/* --- standard C lib header files -------------------------------------------------------------- */
+#include <stdio.h>
+#include <string.h>
+
+/* --- internal header files -------------------------------------------------------------------- */
+#include "jf_basic.h"
+#include "jf_limit.h"
+#include "jf_err.h"
+#include "jf_thread.h"
+#include "jf_mutex.h"
+#include "jf_queue.h"
+#include "jf_atomic.h"
+#include "jf_jiukun.h"
+#include "jf_threadpool.h"
+
+/* --- private data/data structure section ------------------------------------------------------ */
+
+/** Default capacity of the deque of worker.
+ */
+#define THREADPOOL_DEFAULT_DEQUE_SIZE         (1024)
+
+/** Maximum capacity of the deque of worker.
+ */
+#define THREADPOOL_MAX_DEQUE_SIZE             (1024 * 1024)
+
+/** Number of tries to find task before the worker is blocked.
+ */
+#define THREADPOOL_SPIN_COUNT                 (64)
+
+/** Timeout in millisecond of worker waiting for future, the worker checks the tasks after
+ *  timeout.
+ */
+#define THREADPOOL_FUTURE_WAIT_TIMEOUT        (1)
+
+#if defined(LINUX)
+    #define THREADPOOL_THREAD_LOCAL           __thread
+#elif defined(WINDOWS)
+    #define THREADPOOL_THREAD_LOCAL           __declspec(thread)
+#endif
+
+struct internal_threadpool;
+
+typedef struct
+{
+    /**The task is done.*/
+    volatile u32 tf_u32Done;
+    /**Number of threads waiting for the future.*/
+    volatile u32 tf_u32Waiter;
+    /**Number of references, the task and the submitter.*/
+    volatile u32 tf_u32Ref;
+    u32 tf_u32Result;
+    struct internal_threadpool * tf_pitPool;
+} threadpool_future_t;
+
+typedef struct
+{
+    jf_threadpool_fnTask_t tt_fnTask;
+    void * tt_pArg;
+    jf_threadpool_fnComplete_t tt_fnComplete;
+    void * tt_pCompleteArg;
+    threadpool_future_t * tt_ptfFuture;
+    /**The link in shared queue.*/
+    jf_queue_link_t tt_jqlShared;
+} threadpool_task_t;
+
+/** The Chase-Lev deque, the top and the bottom are in different cache lines.
+ */
+typedef struct
+{
+    /**The index of the top, the thieves steal tasks from the top.*/
+    volatile u64 td_u64Top;
+    u8 td_u8Reserved[JF_JIUKUN_CACHE_LINE_SIZE - sizeof(u64)];
+    /**The index of the bottom, the owner pushes and pops tasks at the bottom.*/
+    volatile u64 td_u64Bottom;
+    u64 td_u64Mask;
+    threadpool_task_t * volatile * td_pptTask;
+} threadpool_deque_t;
+
+typedef struct
+{
+    threadpool_deque_t tw_tdDeque;
+    struct internal_threadpool * tw_pitPool;
+    jf_thread_id_t tw_jtiThread;
+    u32 tw_u32Index;
+    /**The seed to select victim.*/
+    u32 tw_u32Seed;
+    volatile u64 tw_u64Executed;
+    volatile u64 tw_u64Stolen;
+} threadpool_worker_t;
+
+typedef struct internal_threadpool
+{
+    u32 it_u32NumOfWorker;
+    u32 it_u32NumOfStarted;
+    /**The signal for sleeping workers, it's increased when workers are woken up.*/
+    volatile u32 it_u32Signal;
+    /**Number of sleeping workers.*/
+    volatile u32 it_u32Sleeper;
+    /**The pool is shutting down.*/
+    volatile u32 it_u32Shutdown;
+    /**Number of tasks in shared queue, it's checked before the lock is acquired.*/
+    volatile u32 it_u32NumOfShared;
+    volatile u64 it_u64Submitted;
+    threadpool_worker_t * it_ptwWorker;
+
+    jf_mutex_t it_jmShared;
+    /**The shared queue for tasks submitted by other threads, protected by the mutex.*/
+    jf_iqueue_t it_jiqShared;
+} internal_threadpool_t;
+
+/** The worker of the calling thread, NULL if the thread is not worker.
+ */
+static THREADPOOL_THREAD_LOCAL threadpool_worker_t * ls_ptwThreadpoolWorker = NULL;
+
+/* --- private routine section ------------------------------------------------------------------ */
+
+static u32 _initThreadpoolDeque(threadpool_deque_t * ptd, u32 u32Size)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+
+    u32Ret = jf_jiukun_allocMemory((void **)&ptd->td_pptTask, u32Size * sizeof(void *));
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ol_bzero((void *)ptd->td_pptTask, u32Size * sizeof(void *));
+        ptd->td_u64Mask = u32Size - 1;
+    }
+
+    return u32Ret;
+}
+
+/** Push the task to the bottom of the deque, it's called by the owner.
+ *
+ *  @return FALSE if the deque is full.
+ */
+static boolean_t _pushThreadpoolDeque(threadpool_deque_t * ptd, threadpool_task_t * ptt)
+{
+    u64 u64Bottom = ptd->td_u64Bottom;
+    u64 u64Top = jf_atomic_loadU64(&ptd->td_u64Top);
+
+    if (u64Bottom - u64Top > ptd->td_u64Mask)
+        return FALSE;
+
+    jf_atomic_storePointer(
+        (void * volatile *)&ptd->td_pptTask[u64Bottom & ptd->td_u64Mask], ptt);
+    /*The store has release semantic, the thief sees the task when it sees the bottom.*/
+    jf_atomic_storeU64(&ptd->td_u64Bottom, u64Bottom + 1);
+
+    return TRUE;
+}
+
+/** Pop the task from the bottom of the deque, it's called by the owner.
+ */
+static threadpool_task_t * _popThreadpoolDeque(threadpool_deque_t * ptd)
+{
+    u64 u64Bottom = ptd->td_u64Bottom - 1, u64Top;
+    threadpool_task_t * ptt = NULL;
+
+    /*Reserve the bottom task before reading the top, the thieves see the reservation.*/
+    jf_atomic_storeU64(&ptd->td_u64Bottom, u64Bottom);
+    jf_atomic_fence();
+    u64Top = jf_atomic_loadU64(&ptd->td_u64Top);
+
+    if ((s64)(u64Bottom - u64Top) >= 0)
+    {
+        ptt = jf_atomic_loadPointer(
+            (void * volatile *)&ptd->td_pptTask[u64Bottom & ptd->td_u64Mask]);
+
+        if (u64Bottom == u64Top)
+        {
+            /*The last task, race with the thieves.*/
+            if (! jf_atomic_casU64(&ptd->td_u64Top, u64Top, u64Top + 1))
+                ptt = NULL;
+
+            jf_atomic_storeU64(&ptd->td_u64Bottom, u64Bottom + 1);
+        }
+    }
+    else
+    {
+        /*The deque is empty.*/
+        jf_atomic_storeU64(&ptd->td_u64Bottom, u64Bottom + 1);
+    }
+
+    return ptt;
+}
+
+/** Steal the task from the top of the deque, it's called by other workers.
+ *
+ *  @return NULL if the deque is empty or other thread wins the race.
+ */
+static threadpool_task_t * _stealThreadpoolDeque(threadpool_deque_t * ptd)
+{
+    u64 u64Top = jf_atomic_loadU64(&ptd->td_u64Top), u64Bottom;
+    threadpool_task_t * ptt = NULL;
+
+    jf_atomic_fence();
+    u64Bottom = jf_atomic_loadU64(&ptd->td_u64Bottom);
+
+    if ((s64)(u64Bottom - u64Top) > 0)
+    {
+        ptt = jf_atomic_loadPointer((void * volatile *)&ptd->td_pptTask[u64Top & ptd->td_u64Mask]);
+
+        if (! jf_atomic_casU64(&ptd->td_u64Top, u64Top, u64Top + 1))
+            ptt = NULL;
+    }
+
+    return ptt;
+}
+
+static threadpool_task_t * _getThreadpoolSharedTask(internal_threadpool_t * pit)
+{
+    jf_queue_link_t * pjql = NULL;
+
+    if (jf_atomic_loadU32(&pit->it_u32NumOfShared) == 0)
+        return NULL;
+
+    jf_mutex_acquire(&pit->it_jmShared);
+
+    pjql = jf_iqueue_dequeue(&pit->it_jiqShared);
+    if (pjql != NULL)
+        jf_atomic_fetchAddU32(&pit->it_u32NumOfShared, (u32)-1);
+
+    jf_mutex_release(&pit->it_jmShared);
+
+    if (pjql == NULL)
+        return NULL;
+
+    return jf_iqueue_getEntry(pjql, threadpool_task_t, tt_jqlShared);
+}
+
+static threadpool_task_t * _stealThreadpoolTask(threadpool_worker_t * ptw)
+{
+    internal_threadpool_t * pit = ptw->tw_pitPool;
+    threadpool_task_t * ptt = NULL;
+    u32 u32Index, u32Victim;
+
+    /*Select the first victim randomly with xorshift, so the thieves don't contend on the same
+      deque.*/
+    ptw->tw_u32Seed ^= ptw->tw_u32Seed << 13;
+    ptw->tw_u32Seed ^= ptw->tw_u32Seed >> 17;
+    ptw->tw_u32Seed ^= ptw->tw_u32Seed << 5;
+
+    for (u32Index = 0; (u32Index < pit->it_u32NumOfWorker) && (ptt == NULL); u32Index ++)
+    {
+        u32Victim = (ptw->tw_u32Seed + u32Index) % pit->it_u32NumOfWorker;
+        if (u32Victim != ptw->tw_u32Index)
+            ptt = _stealThreadpoolDeque(&pit->it_ptwWorker[u32Victim].tw_tdDeque);
+    }
+
+    if (ptt != NULL)
+        ptw->tw_u64Stolen ++;
+
+    return ptt;
+}
+
+static threadpool_task_t * _findThreadpoolTask(threadpool_worker_t * ptw)
+{
+    threadpool_task_t * ptt = NULL;
+
+    ptt = _popThreadpoolDeque(&ptw->tw_tdDeque);
+
+    if (ptt == NULL)
+        ptt = _getThreadpoolSharedTask(ptw->tw_pitPool);
+
+    if (ptt == NULL)
+        ptt = _stealThreadpoolTask(ptw);
+
+    return ptt;
+}
+
+static void _releaseThreadpoolFuture(threadpool_future_t ** pptf)
+{
+    if (jf_atomic_fetchAddU32(&(*pptf)->tf_u32Ref, (u32)-1) == 1)
+        jf_jiukun_freeMemory((void **)pptf);
+    else
+        *pptf = NULL;
+}
+
+static void _completeThreadpoolFuture(threadpool_future_t * ptf, u32 u32Result)
+{
+    ptf->tf_u32Result = u32Result;
+
+    /*The exchange is a full barrier, the waiter is seen if it's going to sleep.*/
+    jf_atomic_exchangeU32(&ptf->tf_u32Done, TRUE);
+
+    if (jf_atomic_loadU32(&ptf->tf_u32Waiter) != 0)
+        jf_atomic_wakeU32(&ptf->tf_u32Done, TRUE);
+
+    _releaseThreadpoolFuture(&ptf);
+}
+
+static void _runThreadpoolTask(threadpool_worker_t * ptw, threadpool_task_t * ptt)
+{
+    u32 u32Result = ptt->tt_fnTask(ptt->tt_pArg);
+
+    ptw->tw_u64Executed ++;
+
+    if (ptt->tt_fnComplete != NULL)
+        ptt->tt_fnComplete(u32Result, ptt->tt_pCompleteArg);
+
+    if (ptt->tt_ptfFuture != NULL)
+        _completeThreadpoolFuture(ptt->tt_ptfFuture, u32Result);
+
+    jf_jiukun_freeMemory((void **)&ptt);
+}
+
+/** Wake up a sleeping worker after a task is added.
+ */
+static void _signalThreadpoolWorker(internal_threadpool_t * pit)
+{
+    /*The task is visible before the number of sleepers is read.*/
+    jf_atomic_fence();
+
+    if (jf_atomic_loadU32(&pit->it_u32Sleeper) != 0)
+    {
+        jf_atomic_fetchAddU32(&pit->it_u32Signal, 1);
+        jf_atomic_wakeU32(&pit->it_u32Signal, FALSE);
+    }
+}
+
+static JF_THREAD_RETURN_VALUE _threadpoolWorker(void * pArg)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    threadpool_worker_t * ptw = pArg;
+    internal_threadpool_t * pit = ptw->tw_pitPool;
+    threadpool_task_t * ptt = NULL;
+    u32 u32Spin = 0, u32Signal, u32Shutdown;
+
+    ls_ptwThreadpoolWorker = ptw;
+
+    while (TRUE)
+    {
+        /*Read the shutdown flag before finding task, all tasks submitted before shutdown are
+          found.*/
+        u32Shutdown = jf_atomic_loadU32(&pit->it_u32Shutdown);
+
+        ptt = _findThreadpoolTask(ptw);
+        if (ptt != NULL)
+        {
+            _runThreadpoolTask(ptw, ptt);
+            u32Spin = 0;
+            continue;
+        }
+
+        if (u32Shutdown != 0)
+            break;
+
+        if (u32Spin < THREADPOOL_SPIN_COUNT)
+        {
+            jf_atomic_pause();
+            u32Spin ++;
+            continue;
+        }
+
+        /*Check the tasks again after the worker is counted as sleeper.*/
+        u32Signal = jf_atomic_loadU32(&pit->it_u32Signal);
+        jf_atomic_fetchAddU32(&pit->it_u32Sleeper, 1);
+
+        ptt = _findThreadpoolTask(ptw);
+        if ((ptt == NULL) && (jf_atomic_loadU32(&pit->it_u32Shutdown) == 0))
+            jf_atomic_waitU32(&pit->it_u32Signal, u32Signal, JF_ATOMIC_WAIT_FOREVER);
+
+        jf_atomic_fetchAddU32(&pit->it_u32Sleeper, (u32)-1);
+
+        if (ptt != NULL)
+            _runThreadpoolTask(ptw, ptt);
+
+        u32Spin = 0;
+    }
+
+    ls_ptwThreadpoolWorker = NULL;
+
+    JF_THREAD_RETURN(u32Ret);
+}
+
+static u32 _submitThreadpoolTask(internal_threadpool_t * pit, threadpool_task_t * ptt)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    threadpool_worker_t * ptw = ls_ptwThreadpoolWorker;
+
+    if ((ptw != NULL) && (ptw->tw_pitPool == pit))
+    {
+        /*The task submitted by worker is accepted even if the pool is shutting down.*/
+        if (! _pushThreadpoolDeque(&ptw->tw_tdDeque, ptt))
+        {
+            jf_mutex_acquire(&pit->it_jmShared);
+            jf_iqueue_enqueue(&pit->it_jiqShared, &ptt->tt_jqlShared);
+            jf_atomic_fetchAddU32(&pit->it_u32NumOfShared, 1);
+            jf_mutex_release(&pit->it_jmShared);
+        }
+    }
+    else
+    {
+        jf_mutex_acquire(&pit->it_jmShared);
+
+        if (pit->it_u32Shutdown != 0)
+        {
+            u32Ret = JF_ERR_TERMINATED;
+        }
+        else
+        {
+            jf_iqueue_enqueue(&pit->it_jiqShared, &ptt->tt_jqlShared);
+            jf_atomic_fetchAddU32(&pit->it_u32NumOfShared, 1);
+        }
+
+        jf_mutex_release(&pit->it_jmShared);
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        jf_atomic_fetchAddU64(&pit->it_u64Submitted, 1);
+        _signalThreadpoolWorker(pit);
+    }
+
+    return u32Ret;
+}
+
+static u32 _newThreadpoolTask(
+    jf_threadpool_fnTask_t fnTask, void * pArg, jf_threadpool_fnComplete_t fnComplete,
+    void * pCompleteArg, threadpool_task_t ** pptt)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    threadpool_task_t * ptt = NULL;
+
+    u32Ret = jf_jiukun_allocMemory((void **)&ptt, sizeof(threadpool_task_t));
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ol_bzero(ptt, sizeof(threadpool_task_t));
+        ptt->tt_fnTask = fnTask;
+        ptt->tt_pArg = pArg;
+        ptt->tt_fnComplete = fnComplete;
+        ptt->tt_pCompleteArg = pCompleteArg;
+
+        *pptt = ptt;
+    }
+
+    return u32Ret;
+}
+
+static void _stopThreadpoolWorker(internal_threadpool_t * pit)
+{
+    u32 u32Index, u32RetCode;
+
+    jf_mutex_acquire(&pit->it_jmShared);
+    jf_atomic_storeU32(&pit->it_u32Shutdown, 1);
+    jf_mutex_release(&pit->it_jmShared);
+
+    jf_atomic_fetchAddU32(&pit->it_u32Signal, 1);
+    jf_atomic_wakeU32(&pit->it_u32Signal, TRUE);
+
+    for (u32Index = 0; u32Index < pit->it_u32NumOfStarted; u32Index ++)
+        jf_thread_waitForThreadTermination(
+            pit->it_ptwWorker[u32Index].tw_jtiThread, &u32RetCode);
+}
+
+/* --- public routine section ------------------------------------------------------------------- */
+
+u32 jf_threadpool_create(jf_threadpool_t ** ppjt, jf_threadpool_create_param_t * pjtcp)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_threadpool_t * pit = NULL;
+    threadpool_worker_t * ptw = NULL;
+    u32 u32Index, u32Size = 1, u32NumOfCpu = jf_thread_getNumOfCpu();
+
+    assert((ppjt != NULL) && (pjtcp != NULL));
+
+    if (pjtcp->jtcp_u32DequeSize > THREADPOOL_MAX_DEQUE_SIZE)
+        return JF_ERR_INVALID_PARAM;
+
+    /*Round up the capacity to power of 2, so the index is wrapped by mask.*/
+    while (u32Size < pjtcp->jtcp_u32DequeSize)
+        u32Size <<= 1;
+    if (pjtcp->jtcp_u32DequeSize == 0)
+        u32Size = THREADPOOL_DEFAULT_DEQUE_SIZE;
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = jf_jiukun_allocMemory((void **)&pit, sizeof(internal_threadpool_t));
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ol_bzero(pit, sizeof(internal_threadpool_t));
+        jf_iqueue_init(&pit->it_jiqShared);
+        pit->it_u32NumOfWorker = pjtcp->jtcp_u32NumOfWorker;
+        if (pit->it_u32NumOfWorker == 0)
+            pit->it_u32NumOfWorker = u32NumOfCpu;
+
+        u32Ret = jf_mutex_init(&pit->it_jmShared);
+        if (u32Ret != JF_ERR_NO_ERROR)
+            jf_jiukun_freeMemory((void **)&pit);
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        u32Ret = jf_jiukun_allocMemory(
+            (void **)&pit->it_ptwWorker, pit->it_u32NumOfWorker * sizeof(threadpool_worker_t));
+        if (u32Ret == JF_ERR_NO_ERROR)
+            ol_bzero(pit->it_ptwWorker, pit->it_u32NumOfWorker * sizeof(threadpool_worker_t));
+    }
+
+    /*Check the error code first, the pool is freed if the mutex fails to be initialized.*/
+    for (u32Index = 0;
+         (u32Ret == JF_ERR_NO_ERROR) && (u32Index < pit->it_u32NumOfWorker); u32Index ++)
+    {
+        ptw = &pit->it_ptwWorker[u32Index];
+        ptw->tw_pitPool = pit;
+        ptw->tw_u32Index = u32Index;
+        ptw->tw_u32Seed = 0x9E3779B9U * (u32Index + 1);
+
+        u32Ret = _initThreadpoolDeque(&ptw->tw_tdDeque, u32Size);
+    }
+
+    /*The workers are started after all deques are initialized, they may steal from others.*/
+    for (u32Index = 0;
+         (u32Ret == JF_ERR_NO_ERROR) && (u32Index < pit->it_u32NumOfWorker); u32Index ++)
+    {
+        ptw = &pit->it_ptwWorker[u32Index];
+
+        u32Ret = jf_thread_create(&ptw->tw_jtiThread, NULL, _threadpoolWorker, ptw);
+        if (u32Ret == JF_ERR_NO_ERROR)
+        {
+            pit->it_u32NumOfStarted ++;
+
+            if (pjtcp->jtcp_bAffinity)
+                u32Ret = jf_thread_setAffinity(
+                    &ptw->tw_jtiThread, (pjtcp->jtcp_u32FirstCpu + u32Index) % u32NumOfCpu);
+        }
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        *ppjt = pit;
+    else if (pit != NULL)
+        jf_threadpool_destroy((void **)&pit);
+
+    return u32Ret;
+}
+
+u32 jf_threadpool_destroy(jf_threadpool_t ** ppjt)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_threadpool_t * pit = NULL;
+    u32 u32Index;
+
+    assert((ppjt != NULL) && (*ppjt != NULL));
+
+    pit = *ppjt;
+    assert(ls_ptwThreadpoolWorker == NULL);
+
+    _stopThreadpoolWorker(pit);
+
+    if (pit->it_ptwWorker != NULL)
+    {
+        for (u32Index = 0; u32Index < pit->it_u32NumOfWorker; u32Index ++)
+            if (pit->it_ptwWorker[u32Index].tw_tdDeque.td_pptTask != NULL)
+                jf_jiukun_freeMemory(
+                    (void **)&pit->it_ptwWorker[u32Index].tw_tdDeque.td_pptTask);
+
+        jf_jiukun_freeMemory((void **)&pit->it_ptwWorker);
+    }
+
+    jf_mutex_fini(&pit->it_jmShared);
+
+    jf_jiukun_freeMemory(ppjt);
+
+    return u32Ret;
+}
+
+u32 jf_threadpool_submit(
+    jf_threadpool_t * pjt, jf_threadpool_fnTask_t fnTask, void * pArg,
+    jf_threadpool_fnComplete_t fnComplete, void * pCompleteArg)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_threadpool_t * pit = pjt;
+    threadpool_task_t * ptt = NULL;
+
+    assert((pjt != NULL) && (fnTask != NULL));
+
+    u32Ret = _newThreadpoolTask(fnTask, pArg, fnComplete, pCompleteArg, &ptt);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        u32Ret = _submitThreadpoolTask(pit, ptt);
+        if (u32Ret != JF_ERR_NO_ERROR)
+            jf_jiukun_freeMemory((void **)&ptt);
+    }
+
+    return u32Ret;
+}
+
+u32 jf_threadpool_submitWithFuture(
+    jf_threadpool_t * pjt, jf_threadpool_fnTask_t fnTask, void * pArg,
+    jf_threadpool_future_t ** ppjtf)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_threadpool_t * pit = pjt;
+    threadpool_task_t * ptt = NULL;
+    threadpool_future_t * ptf = NULL;
+
+    assert((pjt != NULL) && (fnTask != NULL) && (ppjtf != NULL));
+
+    u32Ret = jf_jiukun_allocMemory((void **)&ptf, sizeof(threadpool_future_t));
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ol_bzero(ptf, sizeof(threadpool_future_t));
+        ptf->tf_pitPool = pit;
+        ptf->tf_u32Ref = 2;
+
+        u32Ret = _newThreadpoolTask(fnTask, pArg, NULL, NULL, &ptt);
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ptt->tt_ptfFuture = ptf;
+
+        u32Ret = _submitThreadpoolTask(pit, ptt);
+        if (u32Ret != JF_ERR_NO_ERROR)
+            jf_jiukun_freeMemory((void **)&ptt);
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        *ppjtf = ptf;
+    else if (ptf != NULL)
+        jf_jiukun_freeMemory((void **)&ptf);
+
+    return u32Ret;
+}
+
+boolean_t jf_threadpool_isFutureDone(jf_threadpool_future_t * pjtf)
+{
+    threadpool_future_t * ptf = pjtf;
+
+    return (jf_atomic_loadU32(&ptf->tf_u32Done) != 0) ? TRUE : FALSE;
+}
+
+u32 jf_threadpool_waitFuture(jf_threadpool_future_t * pjtf, u32 * pu32Result)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    threadpool_future_t * ptf = pjtf;
+    threadpool_worker_t * ptw = ls_ptwThreadpoolWorker;
+    threadpool_task_t * ptt = NULL;
+    u32 u32Timeout = JF_ATOMIC_WAIT_FOREVER;
+
+    assert(pjtf != NULL);
+
+    /*The worker executes other tasks while waiting, the task may be in its own deque.*/
+    if ((ptw != NULL) && (ptw->tw_pitPool == ptf->tf_pitPool))
+        u32Timeout = THREADPOOL_FUTURE_WAIT_TIMEOUT;
+
+    while (jf_atomic_loadU32(&ptf->tf_u32Done) == 0)
+    {
+        if (u32Timeout != JF_ATOMIC_WAIT_FOREVER)
+        {
+            ptt = _findThreadpoolTask(ptw);
+            if (ptt != NULL)
+            {
+                _runThreadpoolTask(ptw, ptt);
+                continue;
+            }
+        }
+
+        jf_atomic_fetchAddU32(&ptf->tf_u32Waiter, 1);
+        jf_atomic_waitU32(&ptf->tf_u32Done, 0, u32Timeout);
+        jf_atomic_fetchAddU32(&ptf->tf_u32Waiter, (u32)-1);
+    }
+
+    if (pu32Result != NULL)
+        *pu32Result = ptf->tf_u32Result;
+
+    return u32Ret;
+}
+
+u32 jf_threadpool_destroyFuture(jf_threadpool_future_t ** ppjtf)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+
+    assert((ppjtf != NULL) && (*ppjtf != NULL));
+
+    u32Ret = jf_threadpool_waitFuture(*ppjtf, NULL);
+    if (u32Ret == JF_ERR_NO_ERROR)
+        _releaseThreadpoolFuture((threadpool_future_t **)ppjtf);
+
+    return u32Ret;
+}
+
+void jf_threadpool_getStat(jf_threadpool_t * pjt, jf_threadpool_stat_t * pjts)
+{
+    internal_threadpool_t * pit = pjt;
+    u32 u32Index;
+
+    ol_bzero(pjts, sizeof(*pjts));
+
+    pjts->jts_u32NumOfWorker = pit->it_u32NumOfStarted;
+    pjts->jts_u64Submitted = jf_atomic_loadU64(&pit->it_u64Submitted);
+
+    for (u32Index = 0; u32Index < pit->it_u32NumOfStarted; u32Index ++)
+    {
+        pjts->jts_u64Executed += jf_atomic_loadU64(&pit->it_ptwWorker[u32Index].tw_u64Executed);
+        pjts->jts_u64Stolen += jf_atomic_loadU64(&pit->it_ptwWorker[u32Index].tw_u64Stolen);
+    }
+}
+
+/*------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,194 @@
+/**
+ *  @file jf_threadpool.h
+ *
+ *  @brief Header file for work stealing thread pool common object.
+ *
+ *  @author Min Zhang
+ *
+ *  @note
+ *  -# Routines declared in this file are included in jf_threadpool object.
+ *  -# Link with jf_jiukun library for memory allocation, link with jf_thread and jf_mutex object.
+ *  -# Each worker has a Chase-Lev deque. The task submitted by worker is pushed to the bottom of
+ *   the deque of the worker, the worker pops the task from the bottom. The idle worker steals task
+ *   from the top of the deques of other workers.
+ *  -# The task submitted by other threads is added to the shared queue of the pool, the task is
+ *   also added to the shared queue if the deque of the worker is full.
+ *  -# The result of task is returned with future or completion callback. The completion callback
+ *   is called by the worker after the task is done.
+ *  -# The idle worker is blocked after spinning and woken up when new task is submitted.
+ */
+
+/*------------------------------------------------------------------------------------------------*/
+#ifndef JIUTAI_THREADPOOL_H
+#define JIUTAI_THREADPOOL_H
+
+/* --- standard C lib header files -------------------------------------------------------------- */
+
+/* --- internal header files -------------------------------------------------------------------- */
+#include "jf_basic.h"
+#include "jf_err.h"
+
+/* --- constant definitions --------------------------------------------------------------------- */
+
+/** Define the thread pool data type.
+ */
+typedef void  jf_threadpool_t;
+
+/** Define the future data type.
+ */
+typedef void  jf_threadpool_future_t;
+
+/* --- data structures -------------------------------------------------------------------------- */
+
+/** The task function, the return value is the result of the task.
+ */
+typedef u32 (* jf_threadpool_fnTask_t)(void * pArg);
+
+/** The completion callback function, it's called by the worker after the task is done.
+ */
+typedef void (* jf_threadpool_fnComplete_t)(u32 u32Result, void * pArg);
+
+/** Define the parameter data type for creating thread pool.
+ */
+typedef struct
+{
+    /**Number of workers, 0 means the number of online CPUs.*/
+    u32 jtcp_u32NumOfWorker;
+    /**Capacity of the deque of worker, it's rounded up to power of 2, 0 means the default
+       value.*/
+    u32 jtcp_u32DequeSize;
+    /**Bind the workers to CPUs, the worker N is bound to the CPU (first CPU + N) % number of
+       CPUs.*/
+    boolean_t jtcp_bAffinity;
+    u8 jtcp_u8Reserved[3];
+    /**The CPU for the first worker if affinity is enabled.*/
+    u32 jtcp_u32FirstCpu;
+} jf_threadpool_create_param_t;
+
+/** Define the statistic data type of thread pool.
+ */
+typedef struct
+{
+    u32 jts_u32NumOfWorker;
+    u32 jts_u32Reserved;
+    /**Number of tasks submitted.*/
+    u64 jts_u64Submitted;
+    /**Number of tasks executed.*/
+    u64 jts_u64Executed;
+    /**Number of tasks stolen from other workers.*/
+    u64 jts_u64Stolen;
+} jf_threadpool_stat_t;
+
+/* --- functional routines ---------------------------------------------------------------------- */
+
+/** Create the thread pool and start the workers.
+ *
+ *  @param ppjt [out] The thread pool to be created and returned.
+ *  @param pjtcp [in] The parameter for creating thread pool.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ *  @retval JF_ERR_OUT_OF_MEMORY Out of memory.
+ *  @retval JF_ERR_FAIL_CREATE_THREAD Failed to create worker.
+ *  @retval JF_ERR_FAIL_SET_THREAD_AFFINITY Failed to bind worker to CPU.
+ */
+u32 jf_threadpool_create(jf_threadpool_t ** ppjt, jf_threadpool_create_param_t * pjtcp);
+
+/** Shutdown the thread pool gracefully and destroy it.
+ *
+ *  @note
+ *  -# The pool doesn't accept task from other threads, the tasks submitted are executed before
+ *   the workers quit. The tasks submitted by tasks are still accepted.
+ *  -# The routine should not be called by worker.
+ *
+ *  @param ppjt [in/out] The thread pool to be destroyed.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ */
+u32 jf_threadpool_destroy(jf_threadpool_t ** ppjt);
+
+/** Submit the task with completion callback.
+ *
+ *  @param pjt [in] The thread pool.
+ *  @param fnTask [in] The task function.
+ *  @param pArg [in] The argument for the task function.
+ *  @param fnComplete [in] The completion callback function, it can be NULL.
+ *  @param pCompleteArg [in] The argument for the completion callback function.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ *  @retval JF_ERR_OUT_OF_MEMORY Out of memory.
+ *  @retval JF_ERR_TERMINATED The pool is shutting down.
+ */
+u32 jf_threadpool_submit(
+    jf_threadpool_t * pjt, jf_threadpool_fnTask_t fnTask, void * pArg,
+    jf_threadpool_fnComplete_t fnComplete, void * pCompleteArg);
+
+/** Submit the task and return the future for the result.
+ *
+ *  @note
+ *  -# The future should be destroyed by jf_threadpool_destroyFuture().
+ *
+ *  @param pjt [in] The thread pool.
+ *  @param fnTask [in] The task function.
+ *  @param pArg [in] The argument for the task function.
+ *  @param ppjtf [out] The future returned.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ *  @retval JF_ERR_OUT_OF_MEMORY Out of memory.
+ *  @retval JF_ERR_TERMINATED The pool is shutting down.
+ */
+u32 jf_threadpool_submitWithFuture(
+    jf_threadpool_t * pjt, jf_threadpool_fnTask_t fnTask, void * pArg,
+    jf_threadpool_future_t ** ppjtf);
+
+/** Check if the task of the future is done.
+ *
+ *  @param pjtf [in] The future.
+ *
+ *  @return The task state.
+ *  @retval TRUE The task is done.
+ *  @retval FALSE The task is not done.
+ */
+boolean_t jf_threadpool_isFutureDone(jf_threadpool_future_t * pjtf);
+
+/** Wait for the task of the future done and get the result.
+ *
+ *  @note
+ *  -# If the routine is called by worker, the worker executes other tasks while waiting, so the
+ *   task can wait for the sub-tasks.
+ *
+ *  @param pjtf [in] The future.
+ *  @param pu32Result [out] The result of the task, it can be NULL.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ */
+u32 jf_threadpool_waitFuture(jf_threadpool_future_t * pjtf, u32 * pu32Result);
+
+/** Destroy the future, the routine waits for the task done.
+ *
+ *  @param ppjtf [in/out] The future to be destroyed.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_NO_ERROR Success.
+ */
+u32 jf_threadpool_destroyFuture(jf_threadpool_future_t ** ppjtf);
+
+/** Get the statistic of the thread pool.
+ *
+ *  @note
+ *  -# The counters of workers are read without lock, they may be not accurate.
+ *
+ *  @param pjt [in] The thread pool.
+ *  @param pjts [out] The statistic.
+ *
+ *  @return Void.
+ */
+void jf_threadpool_getStat(jf_threadpool_t * pjt, jf_threadpool_stat_t * pjts);
+
+#endif /*JIUTAI_THREADPOOL_H*/
+
+/*------------------------------------------------------------------------------------------------*/
@@ -57,6 +57,9 @@ typedef struct
     u32 jwcp_u32PoolSize;
     /**Buffer size of the session.*/
     olsize_t jwcp_sBuffer;
+    /**Socket tuning profile of the connection, jf_network_socket_profile_t.*/
+    u8 jwcp_u8SocketProfile;
+    u8 jwcp_u8Reserved[7];
 } jf_webclient_create_param_t;
 
 /** Callback function for webclient event.
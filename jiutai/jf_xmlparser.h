@@ -48,6 +48,7 @@
 /* --- internal header files -------------------------------------------------------------------- */
 #include "jf_basic.h"
 #include "jf_ptree.h"
+#include "jf_jiukun.h"
 
 #undef XMLPARSERAPI
 #undef XMLPARSERCALL
@@ -90,6 +91,28 @@
 XMLPARSERAPI u32 XMLPARSERCALL jf_xmlparser_parseXmlDoc(
     olchar_t * pstrBuffer, olsize_t sOffset, olsize_t sBuf, jf_ptree_t ** ppPtree);
 
+/** Parse xml document in memory with the XML nodes and attributes allocated from arena.
+ *
+ *  @note
+ *  -# The intermediate XML nodes and attributes are allocated from the arena, they are not freed
+ *   individually. The memory is released when the arena is reset or destroyed, so the arena can
+ *   be reused for a batch of documents.
+ *  -# The property tree is not allocated from the arena, it should be destroyed by
+ *   jf_ptree_destroy().
+ *  -# If the arena is NULL, an arena is created for the document and destroyed after parse.
+ *
+ *  @param pstrBuffer [in] The buffer to parse.
+ *  @param sOffset [in] The offset in the buffer to start parsing.
+ *  @param sBuf [in] The length of the buffer.
+ *  @param pArena [in] The arena to allocate memory from.
+ *  @param ppPtree [out] The property tree representing the XML document.
+ *
+ *  @return The error code.
+ */
+XMLPARSERAPI u32 XMLPARSERCALL jf_xmlparser_parseXmlDocInArena(
+    olchar_t * pstrBuffer, olsize_t sOffset, olsize_t sBuf, jf_jiukun_arena_t * pArena,
+    jf_ptree_t ** ppPtree);
+
 /** Get XML error message in case there are error during parse.
  *
  *  @note
@@ -12,9 +12,9 @@
 
 SOURCES = jf_option.c jf_hex.c jf_process.c jf_thread.c jf_time.c jf_date.c  \
     jf_stack.c jf_queue.c jf_linklist.c jf_dlinklist.c jf_hashtree.c jf_mem.c jf_mutex.c  \
-    jf_rwlock.c jf_sem.c jf_array.c jf_hashtable.c jf_menu.c jf_crc.c  jf_ptree.c \
+    jf_rwlock.c jf_sem.c jf_array.c jf_hashtable.c jf_chashtable.c jf_menu.c jf_crc.c  jf_ptree.c \
     jf_sharedmemory.c jf_dynlib.c jf_hsm.c jf_host.c jf_respool.c jf_rand.c jf_user.c \
-    jf_attask.c jf_sqlite.c
+    jf_attask.c jf_sqlite.c jf_btree.c jf_art.c jf_bitarray.c jf_epoch.c jf_threadpool.c
 
 EXTRA_CFLAGS = -D_GNU_SOURCE
 
@@ -84,6 +84,8 @@ static internal_error_code_desc_t ls_iecdErrorCodeDesc[] =
 /* respool error */
     {JF_ERR_RESOURCE_BUSY, "The requested resource is busy."},
 /* hash error */
+    {JF_ERR_HASH_ENTRY_NOT_FOUND, "The hash table entry is not found."},
+    {JF_ERR_HASH_ENTRY_EXIST, "The hash table entry already exists."},
 
 /* conffile error */
 
@@ -97,6 +99,7 @@ static internal_error_code_desc_t ls_iecdErrorCodeDesc[] =
     {JF_ERR_FAIL_CREATE_PROCESS, "Failed to create process."},
 /* thread error */
     {JF_ERR_FAIL_CREATE_THREAD, "Failed to create thread."},
+    {JF_ERR_FAIL_SET_THREAD_AFFINITY, "Failed to set CPU affinity of thread."},
 /* shared memory error */
     {JF_ERR_INVALID_SHAREDMEMORY_ID, "Invalid shared memory identifier."},
     {JF_ERR_FAIL_CREATE_SHAREDMEMORY, "Failed to create shared memory."},
@@ -128,6 +131,8 @@ static internal_error_code_desc_t ls_iecdErrorCodeDesc[] =
     {JF_ERR_HOST_NO_ADDRESS, "The requested host name is valid but does not have an IP address."},
     {JF_ERR_NAME_SERVER_NO_RECOVERY, "A non-recoverable name server error occurred."},
     {JF_ERR_RESOLVE_TRY_AGAIN, "A temporary error occurred on an authoritative name server. Try again later."},
+    {JF_ERR_NAME_SERVER_NOT_FOUND, "No name server is configured."},
+    {JF_ERR_INVALID_DNS_MESSAGE, "Invalid DNS message."},
 
     {JF_ERR_FAIL_SEND_DATA, "Failed to send data."},
     {JF_ERR_FAIL_RECV_DATA, "Failed to receive data."},
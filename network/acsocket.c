@@ -22,20 +22,72 @@
 #include "jf_mutex.h"
 #include "jf_jiukun.h"
 #include "jf_listarray.h"
+#include "jf_listhead.h"
+#include "jf_hashtree.h"
+#include "jf_time.h"
 
 #include "asocket.h"
 
 /* --- private data/data structure section ------------------------------------------------------ */
 
 struct internal_acsocket;
+struct acsocket_endpoint;
+
+/** The connection is not used.
+ */
+#define ACS_CONN_STATE_FREE                (0)
+/** The connection is being set up.
+ */
+#define ACS_CONN_STATE_CONNECTING          (1)
+/** The connection is set up.
+ */
+#define ACS_CONN_STATE_CONNECTED           (2)
+/** The health of the idle connection is being checked.
+ */
+#define ACS_CONN_STATE_CHECKING            (3)
+/** The connection is being closed.
+ */
+#define ACS_CONN_STATE_CLOSING             (4)
 
 typedef struct acsocket_data
 {
     struct internal_acsocket * ad_iaAcsocket;
     void * ad_pUser;
-    u32 ad_u32Reserved[2];
+    /**The endpoint of pooled connection, NULL if the connection is not pooled.*/
+    struct acsocket_endpoint * ad_paeEndpoint;
+    /**State of pooled connection.*/
+    u8 ad_u8State;
+    /**The pooled connection is claimed by upper layer.*/
+    boolean_t ad_bClaimed;
+    u8 ad_u8Reserved[2];
+    /**Number of outstanding requests on pooled connection.*/
+    u32 ad_u32Outstanding;
+    /**The time in second when the pooled connection becomes idle.*/
+    u32 ad_u32IdleTime;
+    /**The time in second when the health of the pooled connection is checked.*/
+    u32 ad_u32CheckTime;
+    /**The connection list of the endpoint.*/
+    jf_listhead_t ad_jlEndpoint;
 } acsocket_data_t;
 
+#define ACS_ENDPOINT_KEY_LEN               (160)
+
+/** The endpoint of pooled connections.
+ */
+typedef struct acsocket_endpoint
+{
+    jf_ipaddr_t ae_jiRemote;
+    u16 ae_u16RemotePort;
+    /**Number of pooled connections to the endpoint.*/
+    u16 ae_u16NumOfConn;
+    /**Length of the key.*/
+    u32 ae_u32KeyLen;
+    /**Key in the endpoint hash tree.*/
+    olchar_t ae_strKey[ACS_ENDPOINT_KEY_LEN];
+    /**The pooled connections, most recently used idle connection is at head.*/
+    jf_listhead_t ae_jlConn;
+} acsocket_endpoint_t;
+
 typedef struct internal_acsocket
 {
     jf_network_chain_object_header_t ia_jncohHeader;
@@ -44,14 +96,20 @@ typedef struct internal_acsocket
     olchar_t ia_strName[JF_NETWORK_MAX_NAME_LEN];
 
     u16 ia_u32MaxConn;
-    u16 ia_u16Reserved[3];
+    u16 ia_u16MaxConnPerEndpoint;
+    u16 ia_u16MaxRequestPerConn;
+    u16 ia_u16IdleTimeout;
 
-    u8 ia_u8Reserved[8];
+    u16 ia_u16HealthCheckInterval;
+    /**The maintenance timer of connection pool is started.*/
+    boolean_t ia_bMaintenance;
+    u8 ia_u8Reserved[5];
 
     jf_network_fnAcsocketOnData_t ia_fnOnData;
     jf_network_fnAcsocketOnConnect_t ia_fnOnConnect;
     jf_network_fnAcsocketOnDisconnect_t ia_fnOnDisconnect;
     jf_network_fnAcsocketOnSendData_t ia_fnOnSendData;
+    jf_network_fnAcsocketOnHealthCheck_t ia_fnOnHealthCheck;
 
     jf_mutex_t ia_jmAsocket;
     jf_listarray_t * ia_pjlAsocket;
@@ -59,16 +117,25 @@ typedef struct internal_acsocket
     jf_network_asocket_t ** ia_pjnaAsockets;
     acsocket_data_t * ia_padData;
 
+    /**The endpoints of pooled connections, protected by ia_jmAsocket.*/
+    jf_hashtree_t ia_jhEndpoint;
+    /**The utimer for the maintenance of connection pool.*/
+    jf_network_utimer_t * ia_pjnuUtimer;
+
     void * ia_pTag;
 } internal_acsocket_t;
 
 #define ACS_MAX_CONNECTIONS    (100)
 
+/** The interval in second of the maintenance timer of connection pool.
+ */
+#define ACS_MAINTENANCE_INTERVAL           (1)
+
 /* --- private routine section ------------------------------------------------------------------ */
 
 /** Pre select handler for the chain
  *
- *  @param pAcsocket [in] the async client socket 
+ *  @param pAcsocket [in] the async client socket
  *  @param readset [out] the read fd set
  *  @param writeset [out] the write fd set
  *  @param errorset [out] the error fd set
@@ -89,7 +156,7 @@ static u32 _preSelectAcsocket(
 /** Post select handler for the chain
  *
  *  @param pAcsocket [in] the async client socket
- *  @param slct [in] number of ready socket 
+ *  @param slct [in] number of ready socket
  *  @param readset [in] the read fd set
  *  @param writeset [in] the write fd set
  *  @param errorset [in] the error fd set
@@ -107,12 +174,375 @@ static u32 _postSelectAcsocket(
     return u32Ret;
 }
 
+static u32 _getAcsocketCurrentTime(void)
+{
+    struct timespec tp;
+
+    ol_bzero(&tp, sizeof(tp));
+    jf_time_getClockTime(CLOCK_MONOTONIC_RAW, &tp);
+
+    return (u32)tp.tv_sec;
+}
+
+static u32 _acsGetIndexOfAsocket(jf_network_asocket_t * pAsocket)
+{
+    u32 u32Index;
+
+    u32Index = getIndexOfAsocket(pAsocket);
+
+    return u32Index;
+}
+
+static u32 _freeAcsocketEndpoint(void ** ppData)
+{
+    jf_jiukun_freeMemory(ppData);
+
+    return JF_ERR_NO_ERROR;
+}
+
+/** Find the endpoint of pooled connections, create it if it's not found.
+ *
+ *  @note
+ *  -# The mutex of acsocket must be acquired before calling this function.
+ */
+static u32 _getAcsocketEndpoint(
+    internal_acsocket_t * pia, jf_ipaddr_t * pjiRemote, u16 u16RemotePort,
+    acsocket_endpoint_t ** ppEndpoint)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    acsocket_endpoint_t * pae = NULL;
+    olchar_t strKey[ACS_ENDPOINT_KEY_LEN];
+    u32 u32KeyLen = 0;
+
+    ol_bzero(strKey, sizeof(strKey));
+    u32KeyLen = jf_ipaddr_getStringIpAddrPort(strKey, pjiRemote, u16RemotePort);
+
+    u32Ret = jf_hashtree_getEntry(&pia->ia_jhEndpoint, strKey, u32KeyLen, (void **)&pae);
+    if (u32Ret == JF_ERR_HASHTREE_ENTRY_NOT_FOUND)
+    {
+        u32Ret = jf_jiukun_allocMemory((void **)&pae, sizeof(*pae));
+        if (u32Ret == JF_ERR_NO_ERROR)
+        {
+            ol_bzero(pae, sizeof(*pae));
+            ol_memcpy(&pae->ae_jiRemote, pjiRemote, sizeof(jf_ipaddr_t));
+            pae->ae_u16RemotePort = u16RemotePort;
+            ol_memcpy(pae->ae_strKey, strKey, u32KeyLen);
+            pae->ae_u32KeyLen = u32KeyLen;
+            jf_listhead_init(&pae->ae_jlConn);
+
+            u32Ret = jf_hashtree_addEntry(
+                &pia->ia_jhEndpoint, pae->ae_strKey, pae->ae_u32KeyLen, pae);
+            if (u32Ret != JF_ERR_NO_ERROR)
+                jf_jiukun_freeMemory((void **)&pae);
+        }
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        *ppEndpoint = pae;
+
+    return u32Ret;
+}
+
+/** Delete the endpoint if there is no pooled connection to it.
+ *
+ *  @note
+ *  -# The mutex of acsocket must be acquired before calling this function.
+ */
+static void _tryDeleteAcsocketEndpoint(internal_acsocket_t * pia, acsocket_endpoint_t * pae)
+{
+    if (pae->ae_u16NumOfConn == 0)
+    {
+        jf_hashtree_deleteEntry(&pia->ia_jhEndpoint, pae->ae_strKey, pae->ae_u32KeyLen);
+        jf_jiukun_freeMemory((void **)&pae);
+    }
+}
+
+/** Remove the pooled connection from the endpoint.
+ *
+ *  @note
+ *  -# The mutex of acsocket must be acquired before calling this function.
+ */
+static void _detachAcsocketConnection(internal_acsocket_t * pia, acsocket_data_t * pad)
+{
+    acsocket_endpoint_t * pae = pad->ad_paeEndpoint;
+
+    if (pae == NULL)
+        return;
+
+    jf_listhead_del(&pad->ad_jlEndpoint);
+    pae->ae_u16NumOfConn --;
+    _tryDeleteAcsocketEndpoint(pia, pae);
+
+    pad->ad_paeEndpoint = NULL;
+    pad->ad_u8State = ACS_CONN_STATE_FREE;
+    pad->ad_bClaimed = FALSE;
+    pad->ad_u32Outstanding = 0;
+    pad->ad_pUser = NULL;
+}
+
+/** Find the most recently used idle connection of the endpoint.
+ */
+static acsocket_data_t * _findIdleAcsocketConnection(acsocket_endpoint_t * pae)
+{
+    acsocket_data_t * pad = NULL;
+    jf_listhead_t * pos = NULL;
+
+    jf_listhead_forEach(&pae->ae_jlConn, pos)
+    {
+        pad = jf_listhead_getEntry(pos, acsocket_data_t, ad_jlEndpoint);
+
+        if ((pad->ad_u8State == ACS_CONN_STATE_CONNECTED) && (pad->ad_u32Outstanding == 0))
+            return pad;
+    }
+
+    return NULL;
+}
+
+/** Find the pre-warmed connection which is still being set up.
+ */
+static acsocket_data_t * _findPrewarmAcsocketConnection(acsocket_endpoint_t * pae)
+{
+    acsocket_data_t * pad = NULL;
+    jf_listhead_t * pos = NULL;
+
+    jf_listhead_forEach(&pae->ae_jlConn, pos)
+    {
+        pad = jf_listhead_getEntry(pos, acsocket_data_t, ad_jlEndpoint);
+
+        if ((pad->ad_u8State == ACS_CONN_STATE_CONNECTING) && (! pad->ad_bClaimed))
+            return pad;
+    }
+
+    return NULL;
+}
+
+/** Find the established connection with the least outstanding requests.
+ */
+static acsocket_data_t * _findLeastOutstandingAcsocketConnection(
+    internal_acsocket_t * pia, acsocket_endpoint_t * pae)
+{
+    acsocket_data_t * pad = NULL, * padLeast = NULL;
+    jf_listhead_t * pos = NULL;
+
+    jf_listhead_forEach(&pae->ae_jlConn, pos)
+    {
+        pad = jf_listhead_getEntry(pos, acsocket_data_t, ad_jlEndpoint);
+
+        if ((pad->ad_u8State != ACS_CONN_STATE_CONNECTED) ||
+            (pad->ad_u32Outstanding >= pia->ia_u16MaxRequestPerConn))
+            continue;
+
+        if ((padLeast == NULL) || (pad->ad_u32Outstanding < padLeast->ad_u32Outstanding))
+            padLeast = pad;
+    }
+
+    return padLeast;
+}
+
+/** Allocate a new pooled connection to the endpoint.
+ *
+ *  @note
+ *  -# The mutex of acsocket must be acquired before calling this function.
+ *  -# The connection is not set up in this function.
+ */
+static u32 _newAcsocketConnection(
+    internal_acsocket_t * pia, acsocket_endpoint_t * pae, boolean_t bClaimed, void * pUser,
+    u32 * pu32Index)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    acsocket_data_t * pad = NULL;
+    u32 u32Index = JF_LISTARRAY_END;
+
+    if ((pia->ia_u16MaxConnPerEndpoint != 0) &&
+        (pae->ae_u16NumOfConn >= pia->ia_u16MaxConnPerEndpoint))
+        u32Ret = JF_ERR_SOCKET_POOL_EMPTY;
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        u32Index = jf_listarray_getNode(pia->ia_pjlAsocket);
+        if (u32Index == JF_LISTARRAY_END)
+            u32Ret = JF_ERR_SOCKET_POOL_EMPTY;
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        pad = &pia->ia_padData[u32Index];
+        pad->ad_iaAcsocket = pia;
+        pad->ad_pUser = pUser;
+        pad->ad_paeEndpoint = pae;
+        pad->ad_u8State = ACS_CONN_STATE_CONNECTING;
+        pad->ad_bClaimed = bClaimed;
+        pad->ad_u32Outstanding = bClaimed ? 1 : 0;
+        pad->ad_u32IdleTime = pad->ad_u32CheckTime = _getAcsocketCurrentTime();
+
+        jf_listhead_addTail(&pae->ae_jlConn, &pad->ad_jlEndpoint);
+        pae->ae_u16NumOfConn ++;
+
+        *pu32Index = u32Index;
+    }
+
+    return u32Ret;
+}
+
+/** Start the maintenance timer of connection pool if necessary.
+ *
+ *  @note
+ *  -# The mutex of acsocket must be acquired before calling this function.
+ *
+ *  @return TRUE if the timer should be started by the caller.
+ */
+static boolean_t _startAcsocketMaintenance(internal_acsocket_t * pia)
+{
+    if ((pia->ia_pjnuUtimer == NULL) || pia->ia_bMaintenance)
+        return FALSE;
+
+    pia->ia_bMaintenance = TRUE;
+
+    return TRUE;
+}
+
+static u32 _acsOnMaintenanceTimer(void * pData);
+
+static u32 _connectAcsocketConnection(
+    internal_acsocket_t * pia, u32 u32Index, boolean_t bMaintenance)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    acsocket_data_t * pad = &pia->ia_padData[u32Index];
+    acsocket_endpoint_t * pae = pad->ad_paeEndpoint;
+
+    if (bMaintenance)
+        jf_network_addUtimerItem(
+            pia->ia_pjnuUtimer, pia, ACS_MAINTENANCE_INTERVAL, _acsOnMaintenanceTimer, NULL);
+
+    u32Ret = connectAsocketTo(
+        pia->ia_pjnaAsockets[u32Index], &pae->ae_jiRemote, pae->ae_u16RemotePort, pad);
+    if (u32Ret != JF_ERR_NO_ERROR)
+    {
+        jf_mutex_acquire(&pia->ia_jmAsocket);
+        _detachAcsocketConnection(pia, pad);
+        jf_listarray_putNode(pia->ia_pjlAsocket, u32Index);
+        jf_mutex_release(&pia->ia_jmAsocket);
+    }
+
+    return u32Ret;
+}
+
+/** The handler of the maintenance timer, idle connections are reaped and checked here.
+ *
+ *  @note
+ *  -# The handler is called in the chain thread.
+ */
+static u32 _acsOnMaintenanceTimer(void * pData)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_acsocket_t * pia = (internal_acsocket_t *)pData;
+    acsocket_data_t * pad = NULL;
+    u32 u32Index = 0, u32Current = _getAcsocketCurrentTime();
+    u8 u8Action[ACS_MAX_CONNECTIONS];
+    boolean_t bPooled = FALSE, bClose = FALSE;
+
+    ol_bzero(u8Action, sizeof(u8Action));
+
+    jf_mutex_acquire(&pia->ia_jmAsocket);
+    for (u32Index = 0; u32Index < pia->ia_u32MaxConn; u32Index ++)
+    {
+        pad = &pia->ia_padData[u32Index];
+        if (pad->ad_paeEndpoint == NULL)
+            continue;
+
+        bPooled = TRUE;
+
+        if ((pad->ad_u8State != ACS_CONN_STATE_CONNECTED) || (pad->ad_u32Outstanding != 0))
+            continue;
+
+        if ((pia->ia_u16IdleTimeout != 0) &&
+            (u32Current - pad->ad_u32IdleTime >= pia->ia_u16IdleTimeout))
+        {
+            pad->ad_u8State = ACS_CONN_STATE_CLOSING;
+            u8Action[u32Index] = ACS_CONN_STATE_CLOSING;
+        }
+        else if ((pia->ia_fnOnHealthCheck != NULL) && (pia->ia_u16HealthCheckInterval != 0) &&
+                 (u32Current - pad->ad_u32CheckTime >= pia->ia_u16HealthCheckInterval))
+        {
+            pad->ad_u8State = ACS_CONN_STATE_CHECKING;
+            u8Action[u32Index] = ACS_CONN_STATE_CHECKING;
+        }
+    }
+
+    /*The timer is stopped if there is no pooled connection.*/
+    if (! bPooled)
+        pia->ia_bMaintenance = FALSE;
+    jf_mutex_release(&pia->ia_jmAsocket);
+
+    for (u32Index = 0; u32Index < pia->ia_u32MaxConn; u32Index ++)
+    {
+        pad = &pia->ia_padData[u32Index];
+        bClose = (u8Action[u32Index] == ACS_CONN_STATE_CLOSING);
+
+        if (u8Action[u32Index] == ACS_CONN_STATE_CHECKING)
+        {
+            u32Ret = pia->ia_fnOnHealthCheck(pia, pia->ia_pjnaAsockets[u32Index], pad->ad_pUser);
+
+            jf_mutex_acquire(&pia->ia_jmAsocket);
+            if (u32Ret == JF_ERR_NO_ERROR)
+            {
+                pad->ad_u8State = ACS_CONN_STATE_CONNECTED;
+                pad->ad_u32CheckTime = u32Current;
+            }
+            else
+            {
+                pad->ad_u8State = ACS_CONN_STATE_CLOSING;
+                bClose = TRUE;
+            }
+            jf_mutex_release(&pia->ia_jmAsocket);
+        }
+
+        if (bClose)
+        {
+            jf_logger_logInfoMsg("acs %s close idle conn, index %u", pia->ia_strName, u32Index);
+            disconnectAsocket(pia->ia_pjnaAsockets[u32Index]);
+        }
+    }
+
+    if (bPooled)
+        u32Ret = jf_network_addUtimerItem(
+            pia->ia_pjnuUtimer, pia, ACS_MAINTENANCE_INTERVAL, _acsOnMaintenanceTimer, NULL);
+
+    return u32Ret;
+}
+
+/** Get the user object if the events of the connection should be passed to upper layer.
+ *
+ *  @note
+ *  -# The events of pooled connection which is not claimed are not passed to upper layer.
+ *
+ *  @return TRUE if the events should be passed up.
+ */
+static boolean_t _isAcsocketEventPassedUp(
+    internal_acsocket_t * pia, acsocket_data_t * pad, void ** ppUser)
+{
+    boolean_t bRet = TRUE;
+
+    if (pad->ad_paeEndpoint == NULL)
+    {
+        *ppUser = pad->ad_pUser;
+        return bRet;
+    }
+
+    jf_mutex_acquire(&pia->ia_jmAsocket);
+    bRet = pad->ad_bClaimed;
+    *ppUser = pad->ad_pUser;
+    jf_mutex_release(&pia->ia_jmAsocket);
+
+    return bRet;
+}
+
 /** Internal method dispatched by the data event of the underlying asocket
  *
  *  @param pAsocket [in] the async socket
  *  @param pu8Buffer [in] the buffer
- *  @param psBeginPointer [in/out] the beging pointer of the data 
- *  @param sEndPointer [in] the end pointer of the data 
+ *  @param psBeginPointer [in/out] the beging pointer of the data
+ *  @param sEndPointer [in] the end pointer of the data
  *  @param pUser [in] the user
  *
  *  @return the error code
@@ -123,14 +553,20 @@ static u32 _acsOnData(
     u32 u32Ret = JF_ERR_NO_ERROR;
     acsocket_data_t * pad = (acsocket_data_t *) pUser;
     internal_acsocket_t * pia = pad->ad_iaAcsocket;
+    void * pUpper = NULL;
 
     jf_logger_logDebugMsg("acs %s on data", pia->ia_strName);
 
-    /*Pass the received data up*/
-    if (pia->ia_fnOnData != NULL)
+    if (! _isAcsocketEventPassedUp(pia, pad, &pUpper))
     {
+        /*Nobody is waiting for the data on the idle connection, discard it*/
+        *psBeginPointer = sEndPointer;
+    }
+    else if (pia->ia_fnOnData != NULL)
+    {
+        /*Pass the received data up*/
         pia->ia_fnOnData(
-            pad->ad_iaAcsocket, pAsocket, pu8Buffer, psBeginPointer, sEndPointer, pad->ad_pUser);
+            pad->ad_iaAcsocket, pAsocket, pu8Buffer, psBeginPointer, sEndPointer, pUpper);
     }
 
     return u32Ret;
@@ -138,7 +574,7 @@ static u32 _acsOnData(
 
 /** Internal method dispatched by the connect event of the underlying asocket
  *
- *  @param pAsocket [in] the async socket 
+ *  @param pAsocket [in] the async socket
  *  @param u32Status [in] the connection status
  *  @param pUser [in] the user
  *
@@ -149,27 +585,42 @@ static u32 _acsOnConnect(jf_network_asocket_t * pAsocket, u32 u32Status, void *
     u32 u32Ret = JF_ERR_NO_ERROR;
     acsocket_data_t * pad = (acsocket_data_t *) pUser;
     internal_acsocket_t * pia = pad->ad_iaAcsocket;
+    u32 u32Index = _acsGetIndexOfAsocket(pAsocket);
+    boolean_t bNotify = TRUE;
+    void * pUpper = NULL;
 
     jf_logger_logDebugMsg("acs %s on connect", pia->ia_strName);
 
-    /*Pass the received data up*/
-    u32Ret = pia->ia_fnOnConnect(pia, pAsocket, u32Status, pad->ad_pUser);
-
-    return u32Ret;
-}
+    jf_mutex_acquire(&pia->ia_jmAsocket);
+    bNotify = (pad->ad_paeEndpoint == NULL) || pad->ad_bClaimed;
+    pUpper = pad->ad_pUser;
 
-static u32 _acsGetIndexOfAsocket(jf_network_asocket_t * pAsocket)
-{
-    u32 u32Index;
+    if (u32Status == JF_ERR_NO_ERROR)
+    {
+        if (pad->ad_paeEndpoint != NULL)
+        {
+            pad->ad_u8State = ACS_CONN_STATE_CONNECTED;
+            pad->ad_u32IdleTime = pad->ad_u32CheckTime = _getAcsocketCurrentTime();
+        }
+    }
+    else
+    {
+        /*Asocket is freed without disconnect event if the connection is not set up*/
+        _detachAcsocketConnection(pia, pad);
+        jf_listarray_putNode(pia->ia_pjlAsocket, u32Index);
+    }
+    jf_mutex_release(&pia->ia_jmAsocket);
 
-    u32Index = getIndexOfAsocket(pAsocket);
+    /*Pass the connect event up*/
+    if (bNotify)
+        u32Ret = pia->ia_fnOnConnect(pia, pAsocket, u32Status, pUpper);
 
-    return u32Index;
+    return u32Ret;
 }
 
 /** Internal method dispatched by the disconnect event of the underlying asocket
  *
- *  @param pAsocket [in] the async socket 
+ *  @param pAsocket [in] the async socket
  *  @param u32Status [in] the status code for the disconnection
  *  @param pUser [in] the user
  *
@@ -181,17 +632,21 @@ static u32 _acsOnDisconnect(jf_network_asocket_t * pAsocket, u32 u32Status, void
     acsocket_data_t * pad = (acsocket_data_t *) pUser;
     internal_acsocket_t * pia = pad->ad_iaAcsocket;
     u32 u32Index = _acsGetIndexOfAsocket(pAsocket);
+    boolean_t bNotify = TRUE;
+    void * pUpper = NULL;
 
     jf_logger_logInfoMsg("acs %s on disconnect, put %u", pia->ia_strName, u32Index);
     jf_mutex_acquire(&pia->ia_jmAsocket);
+    bNotify = (pad->ad_paeEndpoint == NULL) || pad->ad_bClaimed;
+    pUpper = pad->ad_pUser;
+    _detachAcsocketConnection(pia, pad);
     jf_listarray_putNode(pia->ia_pjlAsocket, u32Index);
     jf_mutex_release(&pia->ia_jmAsocket);
 
     /*Pass this Disconnect event up*/
-    if (pia->ia_fnOnDisconnect != NULL)
+    if (bNotify && (pia->ia_fnOnDisconnect != NULL))
     {
-        pia->ia_fnOnDisconnect(
-            pad->ad_iaAcsocket, pAsocket, u32Status, pad->ad_pUser);
+        pia->ia_fnOnDisconnect(pia, pAsocket, u32Status, pUpper);
     }
 
     return u32Ret;
@@ -239,6 +694,9 @@ u32 jf_network_destroyAcsocket(jf_network_acsocket_t ** ppAcsocket)
 
     jf_logger_logDebugMsg("destroy acs %s", pia->ia_strName);
 
+    if (pia->ia_pjnuUtimer != NULL)
+        jf_network_destroyUtimer(&pia->ia_pjnuUtimer);
+
     if (pia->ia_pjnaAsockets != NULL)
     {
         for (u32Index = 0;
@@ -252,6 +710,8 @@ u32 jf_network_destroyAcsocket(jf_network_acsocket_t ** ppAcsocket)
         jf_jiukun_freeMemory((void **)&pia->ia_pjnaAsockets);
     }
 
+    jf_hashtree_finiHashtreeAndData(&pia->ia_jhEndpoint, _freeAcsocketEndpoint);
+
     if (pia->ia_pjlAsocket != NULL)
         jf_jiukun_freeMemory((void **)&pia->ia_pjlAsocket);
 
@@ -298,8 +758,16 @@ u32 jf_network_createAcsocket(
         pia->ia_fnOnSendData = pjnacp->jnacp_fnOnSendData;
         if (pia->ia_fnOnSendData == NULL)
             pia->ia_fnOnSendData = _acsocketOnSendData;
+        pia->ia_fnOnHealthCheck = pjnacp->jnacp_fnOnHealthCheck;
 
         pia->ia_u32MaxConn = pjnacp->jnacp_u32MaxConn;
+        pia->ia_u16MaxConnPerEndpoint = pjnacp->jnacp_u16MaxConnPerEndpoint;
+        pia->ia_u16MaxRequestPerConn = pjnacp->jnacp_u16MaxRequestPerConn;
+        if (pia->ia_u16MaxRequestPerConn == 0)
+            pia->ia_u16MaxRequestPerConn = 1;
+        pia->ia_u16IdleTimeout = pjnacp->jnacp_u16IdleTimeout;
+        pia->ia_u16HealthCheckInterval = pjnacp->jnacp_u16HealthCheckInterval;
+        jf_hashtree_init(&pia->ia_jhEndpoint);
         ol_strncpy(pia->ia_strName, pjnacp->jnacp_pstrName, JF_NETWORK_MAX_NAME_LEN - 1);
 
         u32Ret = jf_jiukun_allocMemory(
@@ -331,6 +799,14 @@ u32 jf_network_createAcsocket(
         u32Ret = jf_mutex_init(&pia->ia_jmAsocket);
     }
 
+    if ((u32Ret == JF_ERR_NO_ERROR) &&
+        ((pia->ia_u16IdleTimeout != 0) ||
+         ((pia->ia_u16HealthCheckInterval != 0) && (pia->ia_fnOnHealthCheck != NULL))))
+    {
+        /*The utimer is used to reap and check the idle pooled connections*/
+        u32Ret = jf_network_createUtimer(pChain, &pia->ia_pjnuUtimer, pia->ia_strName);
+    }
+
     if (u32Ret == JF_ERR_NO_ERROR)
     {
         ol_memset(&acp, 0, sizeof(acp));
@@ -340,11 +816,12 @@ u32 jf_network_createAcsocket(
         acp.acp_fnOnConnect = _acsOnConnect;
         acp.acp_fnOnDisconnect = _acsOnDisconnect;
         acp.acp_fnOnSendData = _acsOnSendData;
+        acp.acp_u8SocketProfile = pjnacp->jnacp_u8SocketProfile;
         strName[JF_NETWORK_MAX_NAME_LEN - 1] = '\0';
         acp.acp_pstrName = strName;
 
         /*Create our socket pool*/
-        for (u32Index = 0; 
+        for (u32Index = 0;
              ((u32Index < pjnacp->jnacp_u32MaxConn) && (u32Ret == JF_ERR_NO_ERROR));
              u32Index ++)
         {
@@ -391,10 +868,17 @@ u32 jf_network_disconnectAcsocket(
     u32 u32Ret = JF_ERR_NO_ERROR;
     internal_acsocket_t * pia = (internal_acsocket_t *) pAcsocket;
     u32 u32Index = _acsGetIndexOfAsocket(pAsocket);
+    acsocket_data_t * pad = &pia->ia_padData[u32Index];
 
     jf_logger_logDebugMsg("acs %s disconnect, index %u", pia->ia_strName, u32Index);
     assert(u32Index < pia->ia_u32MaxConn);
 
+    /*The pooled connection being closed cannot be acquired*/
+    jf_mutex_acquire(&pia->ia_jmAsocket);
+    if (pad->ad_paeEndpoint != NULL)
+        pad->ad_u8State = ACS_CONN_STATE_CLOSING;
+    jf_mutex_release(&pia->ia_jmAsocket);
+
     u32Ret = disconnectAsocket(pAsocket);
 
     return u32Ret;
@@ -457,6 +941,12 @@ u32 jf_network_connectAcsocketTo(
 
         u32Ret = connectAsocketTo(
             pia->ia_pjnaAsockets[u32Index], pjiRemote, u16RemotePort, pad);
+        if (u32Ret != JF_ERR_NO_ERROR)
+        {
+            jf_mutex_acquire(&pia->ia_jmAsocket);
+            jf_listarray_putNode(pia->ia_pjlAsocket, u32Index);
+            jf_mutex_release(&pia->ia_jmAsocket);
+        }
     }
 
     return u32Ret;
@@ -468,6 +958,155 @@ void jf_network_getLocalInterfaceOfAcsocket(
     getLocalInterfaceOfAsocket(pAsocket, pjiAddr);
 }
 
-/*------------------------------------------------------------------------------------------------*/
+u32 jf_network_acquireAcsocketConnection(
+    jf_network_acsocket_t * pAcsocket, jf_ipaddr_t * pjiRemote, u16 u16RemotePort, void * pUser,
+    jf_network_asocket_t ** ppAsocket)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_acsocket_t * pia = (internal_acsocket_t *) pAcsocket;
+    acsocket_endpoint_t * pae = NULL;
+    acsocket_data_t * pad = NULL;
+    u32 u32Index = JF_LISTARRAY_END;
+    boolean_t bMaintenance = FALSE;
+
+    assert((pAcsocket != NULL) && (pjiRemote != NULL) && (ppAsocket != NULL));
+
+    *ppAsocket = NULL;
+
+    jf_mutex_acquire(&pia->ia_jmAsocket);
+
+    u32Ret = _getAcsocketEndpoint(pia, pjiRemote, u16RemotePort, &pae);
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        /*Idle connection is the first choice, then the pre-warmed connection*/
+        pad = _findIdleAcsocketConnection(pae);
+        if (pad == NULL)
+            pad = _findPrewarmAcsocketConnection(pae);
+
+        if (pad == NULL)
+        {
+            u32Ret = _newAcsocketConnection(pia, pae, TRUE, pUser, &u32Index);
+            if (u32Ret == JF_ERR_NO_ERROR)
+            {
+                bMaintenance = _startAcsocketMaintenance(pia);
+            }
+            else
+            {
+                /*Share the connection with the least outstanding requests*/
+                pad = _findLeastOutstandingAcsocketConnection(pia, pae);
+                if (pad != NULL)
+                    u32Ret = JF_ERR_NO_ERROR;
+                else
+                    _tryDeleteAcsocketEndpoint(pia, pae);
+            }
+        }
+    }
+
+    if (pad != NULL)
+    {
+        if (! pad->ad_bClaimed)
+        {
+            pad->ad_bClaimed = TRUE;
+            pad->ad_pUser = pUser;
+        }
+        pad->ad_u32Outstanding ++;
+
+        u32Index = pad - pia->ia_padData;
+        if (pad->ad_u8State == ACS_CONN_STATE_CONNECTED)
+            *ppAsocket = pia->ia_pjnaAsockets[u32Index];
+
+        /*Move the connection to head so it's reused first when it becomes idle*/
+        jf_listhead_move(&pae->ae_jlConn, &pad->ad_jlEndpoint);
+    }
+
+    jf_mutex_release(&pia->ia_jmAsocket);
+
+    jf_logger_logDebugMsg(
+        "acs %s acquire conn, index %u, ret %u", pia->ia_strName, u32Index, u32Ret);
+
+    /*A new connection is allocated, set up the connection*/
+    if ((u32Ret == JF_ERR_NO_ERROR) && (pad == NULL))
+        u32Ret = _connectAcsocketConnection(pia, u32Index, bMaintenance);
+
+    return u32Ret;
+}
+
+u32 jf_network_releaseAcsocketConnection(
+    jf_network_acsocket_t * pAcsocket, jf_network_asocket_t * pAsocket)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_acsocket_t * pia = (internal_acsocket_t *) pAcsocket;
+    u32 u32Index = _acsGetIndexOfAsocket(pAsocket);
+    acsocket_data_t * pad = NULL;
+
+    assert(u32Index < pia->ia_u32MaxConn);
+    pad = &pia->ia_padData[u32Index];
+
+    jf_mutex_acquire(&pia->ia_jmAsocket);
+    if ((pad->ad_paeEndpoint == NULL) || (pad->ad_u32Outstanding == 0))
+    {
+        u32Ret = JF_ERR_INVALID_PARAM;
+    }
+    else
+    {
+        pad->ad_u32Outstanding --;
+        if (pad->ad_u32Outstanding == 0)
+        {
+            /*The connection becomes idle and belongs to the pool*/
+            pad->ad_bClaimed = FALSE;
+            pad->ad_u32IdleTime = pad->ad_u32CheckTime = _getAcsocketCurrentTime();
+            jf_listhead_move(&pad->ad_paeEndpoint->ae_jlConn, &pad->ad_jlEndpoint);
+        }
+    }
+    jf_mutex_release(&pia->ia_jmAsocket);
+
+    jf_logger_logDebugMsg("acs %s release conn, index %u", pia->ia_strName, u32Index);
+
+    return u32Ret;
+}
+
+u32 jf_network_prewarmAcsocket(
+    jf_network_acsocket_t * pAcsocket, jf_ipaddr_t * pjiRemote, u16 u16RemotePort,
+    u16 u16NumOfConn)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_acsocket_t * pia = (internal_acsocket_t *) pAcsocket;
+    acsocket_endpoint_t * pae = NULL;
+    u32 u32Index[ACS_MAX_CONNECTIONS];
+    u16 u16Index = 0, u16New = 0;
+    boolean_t bMaintenance = FALSE;
+
+    assert((pAcsocket != NULL) && (pjiRemote != NULL));
 
+    jf_logger_logInfoMsg("acs %s prewarm, %u conn", pia->ia_strName, u16NumOfConn);
 
+    jf_mutex_acquire(&pia->ia_jmAsocket);
+
+    u32Ret = _getAcsocketEndpoint(pia, pjiRemote, u16RemotePort, &pae);
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        while ((u32Ret == JF_ERR_NO_ERROR) && (pae->ae_u16NumOfConn < u16NumOfConn))
+        {
+            u32Ret = _newAcsocketConnection(pia, pae, FALSE, NULL, &u32Index[u16New]);
+            if (u32Ret == JF_ERR_NO_ERROR)
+                u16New ++;
+        }
+
+        if (u16New > 0)
+            bMaintenance = _startAcsocketMaintenance(pia);
+        else
+            _tryDeleteAcsocketEndpoint(pia, pae);
+    }
+
+    jf_mutex_release(&pia->ia_jmAsocket);
+
+    for (u16Index = 0; u16Index < u16New; u16Index ++)
+    {
+        _connectAcsocketConnection(pia, u32Index[u16Index], bMaintenance);
+        bMaintenance = FALSE;
+    }
+
+    return u32Ret;
+}
+
+/*------------------------------------------------------------------------------------------------*/
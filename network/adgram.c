@@ -129,6 +129,7 @@ static void _clearPendingSendOfAdgram(internal_adgram_t * pia)
     jf_listhead_forEachSafe(&pia->ia_jlSendData, pos, temppos)
     {
         pasd = jf_listhead_getEntry(pos, adgram_send_data_t, asd_jlList);
+        jf_listhead_del(pos);
 
         pia->ia_fnOnSendData(
             pia, pia->ia_u32Status, pasd->asd_pu8Buffer, pasd->asd_sBuf, pia->ia_pUser);
@@ -145,7 +146,7 @@ static void _clearPendingSendOfAdgram(internal_adgram_t * pia)
 static u32 _processAdgram(internal_adgram_t * pia)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
-    olsize_t bytesReceived;
+    olsize_t bytesReceived = pia->ia_sMalloc - pia->ia_sEndPointer;
 
     u32Ret = _adRecvfrom(
         pia->ia_pjnsSocket, pia->ia_pu8Buffer + pia->ia_sEndPointer,
@@ -193,6 +194,9 @@ static u32 _handleAdgramRequest(internal_adgram_t * pia)
         
         u32Ret = jf_network_createTypeDgramSocket(
             pasd->asd_jiRemote.ji_u8AddrType, &pia->ia_pjnsSocket);
+
+        if (u32Ret == JF_ERR_NO_ERROR)
+            jf_network_setSocketNonblock(pia->ia_pjnsSocket);
     }
 
     return u32Ret;
@@ -215,7 +219,9 @@ static u32 _preSelectAdgram(
     u32 u32Ret = JF_ERR_NO_ERROR;
     internal_adgram_t * pia = (internal_adgram_t *) pAdgram;
 
-    jf_logger_logInfoMsg("before select adgram");
+#if defined(DEBUG_ADGRAM)
+    jf_logger_logInfoMsg("before select adgram %s", pia->ia_strName);
+#endif
 
     _handleAdgramRequest(pia);
     
@@ -305,7 +311,9 @@ static u32 _postSelectAdgram(
     u32 u32Ret = JF_ERR_NO_ERROR;
     internal_adgram_t * pia = (internal_adgram_t *) pAdgram;
 
-    jf_logger_logInfoMsg("after select adgram");
+#if defined(DEBUG_ADGRAM)
+    jf_logger_logInfoMsg("after select adgram %s", pia->ia_strName);
+#endif
 
     /*Write Handling*/
     if (pia->ia_pjnsSocket != NULL &&
@@ -25,9 +25,14 @@
 #include "jf_listhead.h"
 
 #include "asocket.h"
+#include "chain.h"
 
 /* --- private data/data structure section ------------------------------------------------------ */
 
+/** The cache of send data shared by all async sockets.
+ */
+#define ASOCKET_SEND_DATA_CACHE            "asocket_send_data"
+
 typedef struct asocket_send_data
 {
     u8 * asd_pu8Buffer;
@@ -46,6 +51,8 @@ typedef struct
 {
     jf_network_chain_object_header_t ia_jncohHeader;
     jf_network_chain_t * ia_pjncChain;
+    /**Statistics of the chain.*/
+    jf_network_chain_stat_t * ia_pjncsStat;
 
     olchar_t ia_strName[JF_NETWORK_MAX_NAME_LEN];
 
@@ -67,10 +74,17 @@ typedef struct
     jf_network_utimer_t * ia_pjnuUtimer;
 
     jf_listhead_t ia_jlSendData;
+    /**The cache of send data.*/
+    jf_jiukun_cache_t * ia_pjjcSendData;
 
     /**Connection is established.*/
     boolean_t ia_bFinConnect;
-    u8 ia_u8Reserved2[7];
+    /**Receive buffer is allocated on readable event and released when it's drained.*/
+    boolean_t ia_bLazyBuffer;
+    u8 ia_u8SocketProfile;
+    /**The utimer is shared with other async sockets, it's not destroyed with the async socket.*/
+    boolean_t ia_bSharedUtimer;
+    u8 ia_u8Reserved2[4];
 
     u8 * ia_pu8Buffer;
     olsize_t ia_sMalloc;
@@ -119,7 +133,18 @@ static u32 _asRecvn(jf_network_socket_t * pSocket, void * pBuffer, olsize_t * ps
     return u32Ret;
 }
 
-static void _destroyAsocketSendData(asocket_send_data_t ** ppasd)
+/** Construct the send data when it's added to the cache, the send data is returned to the cache
+ *  in this state.
+ */
+static void _constructAsocketSendData(void * pObj)
+{
+    asocket_send_data_t * pasd = pObj;
+
+    ol_bzero(pasd, sizeof(*pasd));
+    jf_listhead_init(&pasd->asd_jlList);
+}
+
+static void _destroyAsocketSendData(internal_asocket_t * pia, asocket_send_data_t ** ppasd)
 {
     asocket_send_data_t * pasd = *ppasd;
 
@@ -127,7 +152,15 @@ static void _destroyAsocketSendData(asocket_send_data_t ** ppasd)
     {
         jf_jiukun_freeMemory((void **)&pasd->asd_pu8Buffer);
     }
-    jf_jiukun_freeMemory((void **)ppasd);
+
+    /*Only the fields set after allocation are restored, the object is returned in constructed
+      state.*/
+    pasd->asd_pu8Buffer = NULL;
+    pasd->asd_sBuf = 0;
+    pasd->asd_sBytesSent = 0;
+    pasd->asd_bStatic = FALSE;
+    jf_listhead_init(&pasd->asd_jlList);
+    jf_jiukun_freeObject(pia->ia_pjjcSendData, (void **)ppasd);
 }
 
 /** Clears all the pending data to be sent for an async socket.
@@ -159,7 +192,7 @@ static void _clearPendingSendOfAsocket(internal_asocket_t * pia)
             pia, pia->ia_u32Status, pasd->asd_pu8Buffer, pasd->asd_sBuf, pia->ia_pUser);
 
         /*Free the data.*/
-        _destroyAsocketSendData(&pasd);
+        _destroyAsocketSendData(pia, &pasd);
     }
     
 }
@@ -178,6 +211,8 @@ static u32 _freeAsocket(internal_asocket_t * pia)
     /*Initialise the buffer pointers, since no data is in them yet.*/
     pia->ia_sBeginPointer = 0;
     pia->ia_sEndPointer = 0;
+    if (pia->ia_bLazyBuffer && (pia->ia_pu8Buffer != NULL))
+        jf_jiukun_freeMemory((void **)&pia->ia_pu8Buffer);
 
     pia->ia_u32Status = 0;
 
@@ -228,12 +263,22 @@ static u32 _processAsocket(internal_asocket_t * pia)
 
     jf_logger_logDebugMsg("as %s process", pia->ia_strName);
 
-    u32Ret = _asRecvn(
-        pia->ia_pjnsSocket, pia->ia_pu8Buffer + pia->ia_sEndPointer, &bytesReceived);
+    if (pia->ia_pu8Buffer == NULL)
+        u32Ret = jf_jiukun_allocMemory((void **)&pia->ia_pu8Buffer, pia->ia_sMalloc);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        bytesReceived = pia->ia_sMalloc - pia->ia_sEndPointer;
+        u32Ret = _asRecvn(
+            pia->ia_pjnsSocket, pia->ia_pu8Buffer + pia->ia_sEndPointer, &bytesReceived);
+        pia->ia_pjncsStat->jncs_u64Recv ++;
+    }
+
     if (u32Ret == JF_ERR_NO_ERROR)
     {
         /*Data was read, so increment our counters*/
         pia->ia_sEndPointer += bytesReceived;
+        pia->ia_pjncsStat->jncs_u64BytesRecv += bytesReceived;
 
         jf_logger_logDebugMsg("as %s process, end %d", pia->ia_strName, pia->ia_sEndPointer);
 
@@ -264,6 +309,10 @@ static u32 _processAsocket(internal_asocket_t * pia)
             jf_logger_logErrMsg(JF_ERR_BUFFER_IS_FULL, "buffer is full, clear the buffer");
             pia->ia_sBeginPointer = pia->ia_sEndPointer = 0;
         }
+
+        /*Release the drained buffer, idle connection doesn't hold memory*/
+        if (pia->ia_bLazyBuffer && (pia->ia_sEndPointer == 0) && (pia->ia_pu8Buffer != NULL))
+            jf_jiukun_freeMemory((void **)&pia->ia_pu8Buffer);
     }
     else    
     {
@@ -276,6 +325,21 @@ static u32 _processAsocket(internal_asocket_t * pia)
     return u32Ret;
 }
 
+static u32 _asSetSocketProfile(internal_asocket_t * pia, jf_network_socket_t * pSocket)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+
+    if (pia->ia_u8SocketProfile == JF_NETWORK_SOCKET_PROFILE_DEFAULT)
+        return u32Ret;
+
+    u32Ret = jf_network_setSocketProfile(pSocket, pia->ia_u8SocketProfile);
+    if (u32Ret != JF_ERR_NO_ERROR)
+        /*The connection still works without the tuning, just log the error.*/
+        jf_logger_logErrMsg(u32Ret, "as %s fails to set socket profile", pia->ia_strName);
+
+    return u32Ret;
+}
+
 static u32 _asConnectTo(internal_asocket_t * pia)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
@@ -291,6 +355,9 @@ static u32 _asConnectTo(internal_asocket_t * pia)
         if (u32Ret == JF_ERR_NO_ERROR)
         {
             jf_network_setSocketNonblock(pia->ia_pjnsSocket);
+
+            if (pia->ia_jiRemote.ji_u8AddrType != JF_IPADDR_TYPE_UDS)
+                _asSetSocketProfile(pia, pia->ia_pjnsSocket);
         }
     }
 
@@ -360,9 +427,19 @@ static u32 _asPostSelectSendData(internal_asocket_t * pia)
     olsize_t bytesSent = 0;
     asocket_send_data_t * pasd = NULL;
     jf_listhead_t * pos = NULL, * temppos = NULL;
+    boolean_t bCork = FALSE;
 
     jf_logger_logDebugMsg("as %s post select, send data", pia->ia_strName);
 
+    /*Cork the socket if multi-part message is pending, e.g. http header and body, so they are
+      coalesced into full frames instead of small segments.*/
+    if ((pia->ia_jiRemote.ji_u8AddrType != JF_IPADDR_TYPE_UDS) &&
+        ! jf_listhead_isLast(&pia->ia_jlSendData, pia->ia_jlSendData.jl_pjlNext))
+    {
+        bCork = (jf_network_setSocketCork(pia->ia_pjnsSocket, TRUE) == JF_ERR_NO_ERROR);
+        pia->ia_pjncsStat->jncs_u64SockOpt ++;
+    }
+
     /*Keep trying to send data, until we are told we can't*/
     jf_listhead_forEachSafe(&pia->ia_jlSendData, pos, temppos)
     {
@@ -371,9 +448,11 @@ static u32 _asPostSelectSendData(internal_asocket_t * pia)
 
         u32Ret = jf_network_send(
             pia->ia_pjnsSocket, pasd->asd_pu8Buffer + pasd->asd_sBytesSent, &bytesSent);
+        pia->ia_pjncsStat->jncs_u64Send ++;
         if (u32Ret == JF_ERR_NO_ERROR)
         {
             pia->ia_sTotalBytesSent += bytesSent;
+            pia->ia_pjncsStat->jncs_u64BytesSent += bytesSent;
 
             pasd->asd_sBytesSent += bytesSent;
             if (pasd->asd_sBytesSent == pasd->asd_sBuf)
@@ -385,7 +464,7 @@ static u32 _asPostSelectSendData(internal_asocket_t * pia)
                 pia->ia_fnOnSendData(
                     pia, u32Ret, pasd->asd_pu8Buffer, pasd->asd_sBytesSent, pia->ia_pUser);
 
-                _destroyAsocketSendData(&pasd);
+                _destroyAsocketSendData(pia, &pasd);
             }
             else
             {
@@ -402,10 +481,19 @@ static u32 _asPostSelectSendData(internal_asocket_t * pia)
             /*disconnect the connection*/
             _asDisconnect(pia);
 
+            /*The socket is destroyed.*/
+            bCork = FALSE;
             break;
         }
     }
 
+    /*Uncork the socket to push out the remaining partial frame.*/
+    if (bCork)
+    {
+        jf_network_setSocketCork(pia->ia_pjnsSocket, FALSE);
+        pia->ia_pjncsStat->jncs_u64SockOpt ++;
+    }
+
     return u32Ret;
 }
 
@@ -452,6 +540,7 @@ static u32 _postSelectAsocket(
             pia->ia_u32Status = JF_ERR_SOCKET_CONNECTION_NOT_SETUP;
             pia->ia_fnOnConnect(pia, pia->ia_u32Status, pia->ia_pUser);
 
+            jf_network_destroySocket(&(pia->ia_pjnsSocket));
             _freeAsocket(pia);
         }
         else if ((! pia->ia_bFinConnect) &&
@@ -486,14 +575,12 @@ static u32 _asAddSendData(
     u32 u32Ret = JF_ERR_NO_ERROR;
     asocket_send_data_t * pasd = NULL;
 
-    u32Ret = jf_jiukun_allocMemory((void **)&pasd, sizeof(*pasd));
+    u32Ret = jf_jiukun_allocObject(pia->ia_pjjcSendData, (void **)&pasd);
     if (u32Ret == JF_ERR_NO_ERROR)
     {
-        ol_bzero(pasd, sizeof(*pasd));
         pasd->asd_pu8Buffer = pu8Buffer;
         pasd->asd_sBuf = sBuf;
         pasd->asd_bStatic = bStatic;
-        jf_listhead_init(&pasd->asd_jlList);
 
         /*Clone the data if it's not static data.*/
         if (! pasd->asd_bStatic)
@@ -510,7 +597,7 @@ static u32 _asAddSendData(
     }
 
     if ((u32Ret != JF_ERR_NO_ERROR) && (pasd != NULL))
-        _destroyAsocketSendData(&pasd);
+        _destroyAsocketSendData(pia, &pasd);
     
     return u32Ret;
 }
@@ -569,6 +656,16 @@ static u32 _asUtimerConnect(void * pData)
     jf_logger_logDebugMsg("as %s utimer trigger, connect", pia->ia_strName);
     
     u32Ret = _asConnectTo(pia);
+    if (u32Ret != JF_ERR_NO_ERROR)
+    {
+        /*Failed to initiate the connection, notify upper layer and free the asocket.*/
+        pia->ia_u32Status = u32Ret;
+        pia->ia_fnOnConnect(pia, pia->ia_u32Status, pia->ia_pUser);
+
+        if (pia->ia_pjnsSocket != NULL)
+            jf_network_destroySocket(&(pia->ia_pjnsSocket));
+        _freeAsocket(pia);
+    }
 
     return u32Ret;
 }
@@ -602,6 +699,9 @@ u32 destroyAsocket(jf_network_asocket_t ** ppAsocket)
     pia->ia_u32Status = JF_ERR_SOCKET_LOCAL_CLOSED;
     _clearPendingSendOfAsocket(pia);
 
+    if (pia->ia_pjjcSendData != NULL)
+        jf_jiukun_destroyCache(&pia->ia_pjjcSendData);
+
     /*Close socket if necessary*/
     if (pia->ia_pjnsSocket != NULL)
         jf_network_destroySocket(&(pia->ia_pjnsSocket));
@@ -615,7 +715,9 @@ u32 destroyAsocket(jf_network_asocket_t ** ppAsocket)
 
     jf_mutex_fini(&pia->ia_jmLock);
     
-    if (pia->ia_pjnuUtimer != NULL)
+    if (pia->ia_bSharedUtimer)
+        jf_network_removeUtimerItem(pia->ia_pjnuUtimer, pia);
+    else if (pia->ia_pjnuUtimer != NULL)
         jf_network_destroyUtimer(&pia->ia_pjnuUtimer);
 
     jf_jiukun_freeMemory(ppAsocket);
@@ -641,25 +743,54 @@ u32 createAsocket(
         pia->ia_jncohHeader.jncoh_fnPreSelect = _preSelectAsocket;
         pia->ia_jncohHeader.jncoh_fnPostSelect = _postSelectAsocket;
         pia->ia_pjncChain = pChain;
+        pia->ia_pjncsStat = getChainStat(pChain);
         pia->ia_bFree = TRUE;
         pia->ia_pjnsSocket = NULL;
         jf_listhead_init(&pia->ia_jlSendData);
         jf_listhead_init(&pia->ia_jlWaitData);
         _setInternalCallbackFunction(pia, pacp);
         pia->ia_sMalloc = pacp->acp_sInitialBuf;
+        pia->ia_bLazyBuffer = pacp->acp_bLazyBuffer;
+        pia->ia_u8SocketProfile = pacp->acp_u8SocketProfile;
         ol_strncpy(pia->ia_strName, pacp->acp_pstrName, JF_NETWORK_MAX_NAME_LEN - 1);
 
-        u32Ret = jf_jiukun_allocMemory(
-            (void **)&pia->ia_pu8Buffer, pacp->acp_sInitialBuf);
+        if (! pia->ia_bLazyBuffer)
+            u32Ret = jf_jiukun_allocMemory(
+                (void **)&pia->ia_pu8Buffer, pacp->acp_sInitialBuf);
     }
 
+    /*The send data is allocated and freed for each send, construct it only when it's added to the
+      cache.*/
     if (u32Ret == JF_ERR_NO_ERROR)
-        u32Ret = jf_mutex_init(&pia->ia_jmLock);
+    {
+        jf_jiukun_cache_create_param_t jjccp;
+
+        ol_bzero(&jjccp, sizeof(jjccp));
+        jjccp.jjccp_pstrName = ASOCKET_SEND_DATA_CACHE;
+        jjccp.jjccp_sObj = sizeof(asocket_send_data_t);
+        jjccp.jjccp_fnCtor = _constructAsocketSendData;
+        JF_FLAG_SET(jjccp.jjccp_jfCache, JF_JIUKUN_CACHE_CREATE_FLAG_SHARED);
+
+        u32Ret = jf_jiukun_createCache(&pia->ia_pjjcSendData, &jjccp);
+    }
 
     if (u32Ret == JF_ERR_NO_ERROR)
-        u32Ret = jf_network_createUtimer(pChain, &pia->ia_pjnuUtimer, pia->ia_strName);
+        u32Ret = jf_mutex_init(&pia->ia_jmLock);
 
     if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        if (pacp->acp_pjnuUtimer != NULL)
+        {
+            pia->ia_pjnuUtimer = pacp->acp_pjnuUtimer;
+            pia->ia_bSharedUtimer = TRUE;
+        }
+        else
+        {
+            u32Ret = jf_network_createUtimer(pChain, &pia->ia_pjnuUtimer, pia->ia_strName);
+        }
+    }
+
+    if ((u32Ret == JF_ERR_NO_ERROR) && (! pacp->acp_bNotInChain))
         u32Ret = jf_network_appendToChain(pChain, pia);
 
     if (u32Ret == JF_ERR_NO_ERROR)
@@ -837,6 +968,9 @@ u32 useSocketForAsocket(
         /*make sure the socket is non-blocking*/
         jf_network_setSocketNonblock(pSocket);
 
+        if (pjiRemote->ji_u8AddrType != JF_IPADDR_TYPE_UDS)
+            _asSetSocketProfile(pia, pSocket);
+
         pia->ia_pjnsSocket = pSocket;
         ol_memcpy(&pia->ia_jiRemote, pjiRemote, sizeof(*pjiRemote));
         pia->ia_u16RemotePort = u16RemotePort;
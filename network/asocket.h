@@ -69,7 +69,16 @@ typedef struct
     fnAsocketOnSendData_t acp_fnOnSendData;
     /*Name of the async socket.*/
     olchar_t * acp_pstrName;
-    u8 jnacp_u8Reserved[16];
+    /**The utimer shared by the async sockets of the owner, the async socket creates its own
+       utimer if it's NULL. The shared utimer is destroyed by the owner.*/
+    jf_network_utimer_t * acp_pjnuUtimer;
+    /**Allocate the receive buffer on readable event and release it when it's drained.*/
+    boolean_t acp_bLazyBuffer;
+    /**The socket tuning profile, jf_network_socket_profile_t.*/
+    u8 acp_u8SocketProfile;
+    /**The async socket is not added to the chain, the owner calls the select handlers.*/
+    boolean_t acp_bNotInChain;
+    u8 acp_u8Reserved[13];
 } asocket_create_param_t;
 
 
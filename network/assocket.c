@@ -36,10 +36,24 @@ typedef struct assocket_data
     u32 ad_u32Reserved[2];
 } assocket_data_t;
 
+/** Number of async sockets in one chunk of the async socket table.
+ */
+#define ASS_ASOCKET_CHUNK_SIZE     (64)
+
+/** The chunk of async socket table, the chunk is created when the first index in it is used.
+ */
+typedef struct assocket_chunk
+{
+    jf_network_asocket_t * ac_pjnaAsockets[ASS_ASOCKET_CHUNK_SIZE];
+    assocket_data_t ac_adData[ASS_ASOCKET_CHUNK_SIZE];
+} assocket_chunk_t;
+
 typedef struct internal_assocket
 {
     jf_network_chain_object_header_t ia_jncohHeader;
     jf_network_chain_t * ia_pjncChain;
+    /**The utimer shared by the async sockets.*/
+    jf_network_utimer_t * ia_pjnuUtimer;
 
     u32 ia_u32MaxConn;
     u16 ia_u16PortNumber;
@@ -47,6 +61,14 @@ typedef struct internal_assocket
     u8 ia_u8Reserved[1];
     jf_ipaddr_t ia_jiAddr;
 
+    /**The initial size of the receive buffer.*/
+    olsize_t ia_sInitialBuf;
+    /**Number of chunks in the async socket table.*/
+    u32 ia_u32NumOfChunk;
+    /**The socket tuning profile for accepted connection.*/
+    u8 ia_u8SocketProfile;
+    u8 ia_u8Reserved2[7];
+
     olchar_t ia_strName[JF_NETWORK_MAX_NAME_LEN];
 
     jf_network_socket_t * ia_pjnsListenSocket;
@@ -61,17 +83,79 @@ typedef struct internal_assocket
     jf_listarray_t * ia_pjlAsocket;
     /*end of lock protected section*/
 
-    jf_network_asocket_t ** ia_pjnaAsockets;
-    assocket_data_t * ia_padData;
+    /**The async socket table, it's accessed in chain thread only.*/
+    assocket_chunk_t ** ia_ppacChunk;
 
     void * ia_pTag;
 } internal_assocket_t;
 
-#define ASS_MAX_CONNECTIONS   4000
+/** The max size of the async socket table. The chain uses select(), on Linux the accepted socket
+ *  equal to or larger than FD_SETSIZE is rejected, so the connections are limited by FD_SETSIZE
+ *  until the chain has other backend.
+ */
+#define ASS_MAX_CONNECTIONS   (100000)
 
 /* --- private routine section ------------------------------------------------------------------ */
 
+static u32 _getAssocketAsocket(
+    internal_assocket_t * pia, u32 u32Index, jf_network_asocket_t ** ppAsocket,
+    assocket_data_t ** ppData);
+
+/** Call the preselect handler of the async sockets created in the table.
+ */
+static void _preSelectAssocketAsocket(
+    internal_assocket_t * pia, fd_set * readset, fd_set * writeset, fd_set * errorset,
+    u32 * pu32BlockTime)
+{
+    u32 u32Chunk, u32Slot;
+    assocket_chunk_t * pac = NULL;
+    jf_network_chain_object_header_t * pjncoh = NULL;
+
+    for (u32Chunk = 0; u32Chunk < pia->ia_u32NumOfChunk; u32Chunk ++)
+    {
+        pac = pia->ia_ppacChunk[u32Chunk];
+        if (pac == NULL)
+            continue;
+
+        for (u32Slot = 0; u32Slot < ASS_ASOCKET_CHUNK_SIZE; u32Slot ++)
+        {
+            pjncoh = (jf_network_chain_object_header_t *)pac->ac_pjnaAsockets[u32Slot];
+            if (pjncoh != NULL)
+                pjncoh->jncoh_fnPreSelect(pjncoh, readset, writeset, errorset, pu32BlockTime);
+        }
+    }
+}
+
+/** Call the post select handler of the async sockets created in the table.
+ */
+static void _postSelectAssocketAsocket(
+    internal_assocket_t * pia, olint_t slct, fd_set * readset, fd_set * writeset,
+    fd_set * errorset)
+{
+    u32 u32Chunk, u32Slot;
+    assocket_chunk_t * pac = NULL;
+    jf_network_chain_object_header_t * pjncoh = NULL;
+
+    for (u32Chunk = 0; u32Chunk < pia->ia_u32NumOfChunk; u32Chunk ++)
+    {
+        pac = pia->ia_ppacChunk[u32Chunk];
+        if (pac == NULL)
+            continue;
+
+        for (u32Slot = 0; u32Slot < ASS_ASOCKET_CHUNK_SIZE; u32Slot ++)
+        {
+            pjncoh = (jf_network_chain_object_header_t *)pac->ac_pjnaAsockets[u32Slot];
+            if (pjncoh != NULL)
+                pjncoh->jncoh_fnPostSelect(pjncoh, slct, readset, writeset, errorset);
+        }
+    }
+}
+
 /** preselect handler for basic chain.
+ *
+ *  @note
+ *  -# The async sockets are not in the chain, they are handled before the listen socket in index
+ *   order, no matter when they are created.
  */
 static u32 _preSelectAssocket(
     void * pAssocket, fd_set * readset, fd_set * writeset, fd_set * errorset, u32 * pu32BlockTime)
@@ -79,6 +163,8 @@ static u32 _preSelectAssocket(
     u32 u32Ret = JF_ERR_NO_ERROR;
     internal_assocket_t * pia = (internal_assocket_t *) pAssocket;
 
+    _preSelectAssocketAsocket(pia, readset, writeset, errorset, pu32BlockTime);
+
     /*The socket isn't put in listening mode, until the chain is started. If this variable is TRUE,
       that means we need to do that.*/
     if (! pia->ia_bListening)
@@ -113,10 +199,13 @@ static u32 _postSelectAssocket(
     assocket_data_t * pad = NULL;
     internal_assocket_t * pia = (internal_assocket_t *)pAssocket;
     jf_network_socket_t * pNewSocket = NULL;
+    jf_network_asocket_t * pAsocket = NULL;
     jf_ipaddr_t ipaddr;
     u16 u16Port = 0;
     u32 u32Index = 0;
 
+    _postSelectAssocketAsocket(pia, slct, readset, writeset, errorset);
+
     if (jf_network_isSocketSetInFdSet(pia->ia_pjnsListenSocket, readset))
     {
         jf_logger_logInfoMsg(
@@ -127,30 +216,55 @@ static u32 _postSelectAssocket(
         {
             u32Ret = jf_network_accept(
                 pia->ia_pjnsListenSocket, &ipaddr, &u16Port, &pNewSocket);
+            if ((u32Ret == JF_ERR_NO_ERROR) && ! jf_network_isSocketFitInFdSet(pNewSocket))
+            {
+                /*The socket cannot be selected by the chain, setting it to fd set overruns the
+                  fd set.*/
+                jf_logger_logInfoMsg(
+                    "post select assocket, reject connection, socket is out of fd set range");
+                jf_network_destroySocket(&pNewSocket);
+                continue;
+            }
+
             if (u32Ret == JF_ERR_NO_ERROR)
             {
                 /*Check to see if we have available resources to handle
                   this connection request*/
+                jf_mutex_acquire(&pia->ia_jmAsocket);
                 u32Index = jf_listarray_getNode(pia->ia_pjlAsocket);
+                jf_mutex_release(&pia->ia_jmAsocket);
+
                 if (u32Index != JF_LISTARRAY_END)
                 {
                     jf_logger_logInfoMsg(
                         "post select assocket, new connection, use %u", u32Index);
 
-                    assert(isAsocketFree(pia->ia_pjnaAsockets[u32Index]));
-                    /*Instantiate a pia to contain all the data about
-                      this connection*/
-                    pad = &(pia->ia_padData[u32Index]);
-                    pad->ad_iaAssocket = pAssocket;
-                    pad->ad_pUser = NULL;
+                    /*The async socket table grows on demand*/
+                    u32Ret = _getAssocketAsocket(pia, u32Index, &pAsocket, &pad);
+                    if (u32Ret == JF_ERR_NO_ERROR)
+                    {
+                        assert(isAsocketFree(pAsocket));
+                        /*Instantiate a pia to contain all the data about
+                          this connection*/
+                        pad->ad_iaAssocket = pAssocket;
+                        pad->ad_pUser = NULL;
+
+                        u32Ret = useSocketForAsocket(pAsocket, pNewSocket, &ipaddr, u16Port, pad);
+                    }
 
-                    u32Ret = useSocketForAsocket(
-                        pia->ia_pjnaAsockets[u32Index], pNewSocket, &ipaddr, u16Port, pad);
                     if (u32Ret == JF_ERR_NO_ERROR)
                     {
                         /*Notify the user about this new connection*/
-                        pia->ia_fnOnConnect(
-                            pia, pia->ia_pjnaAsockets[u32Index], &(pad->ad_pUser));
+                        pia->ia_fnOnConnect(pia, pAsocket, &(pad->ad_pUser));
+                    }
+                    else
+                    {
+                        jf_logger_logErrMsg(u32Ret, "post select assocket, failed to use asocket");
+                        jf_network_destroySocket(&pNewSocket);
+                        jf_mutex_acquire(&pia->ia_jmAsocket);
+                        jf_listarray_putNode(pia->ia_pjlAsocket, u32Index);
+                        jf_mutex_release(&pia->ia_jmAsocket);
+                        break;
                     }
                 }
                 else
@@ -265,6 +379,95 @@ static u32 _assocketOnSendData(
     return JF_ERR_NO_ERROR;
 }
 
+static void _destroyAssocketChunk(assocket_chunk_t ** ppChunk)
+{
+    assocket_chunk_t * pac = *ppChunk;
+    u32 u32Index;
+
+    for (u32Index = 0; u32Index < ASS_ASOCKET_CHUNK_SIZE; u32Index ++)
+    {
+        if (pac->ac_pjnaAsockets[u32Index] != NULL)
+            destroyAsocket(&pac->ac_pjnaAsockets[u32Index]);
+    }
+
+    jf_jiukun_freeMemory((void **)ppChunk);
+}
+
+/** Create the async socket with the index.
+ *
+ *  @note
+ *  -# The async socket is not appended to the chain, its select handlers are called by the
+ *   assocket. The function must be called in chain thread.
+ */
+static u32 _createAssocketAsocket(
+    internal_assocket_t * pia, u32 u32Index, jf_network_asocket_t ** ppAsocket)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    asocket_create_param_t acp;
+    olchar_t strName[JF_NETWORK_MAX_NAME_LEN];
+
+    ol_bzero(&acp, sizeof(acp));
+    ol_bzero(strName, sizeof(strName));
+
+    acp.acp_sInitialBuf = pia->ia_sInitialBuf;
+    acp.acp_fnOnData = _assOnData;
+    acp.acp_fnOnDisconnect = _assOnDisconnect;
+    acp.acp_fnOnSendData = _assOnSendData;
+    /*Most of the connections are idle, don't hold the receive buffer for them*/
+    acp.acp_bLazyBuffer = TRUE;
+    /*The async socket is handled by the assocket and uses the utimer of the assocket, the chain is
+      not changed when the table grows*/
+    acp.acp_bNotInChain = TRUE;
+    acp.acp_pjnuUtimer = pia->ia_pjnuUtimer;
+    acp.acp_u8SocketProfile = pia->ia_u8SocketProfile;
+    ol_snprintf(strName, JF_NETWORK_MAX_NAME_LEN - 1, "%s-%u", pia->ia_strName, u32Index);
+    acp.acp_pstrName = strName;
+
+    u32Ret = createAsocket(pia->ia_pjncChain, ppAsocket, &acp);
+    if (u32Ret == JF_ERR_NO_ERROR)
+        setIndexOfAsocket(*ppAsocket, u32Index);
+
+    return u32Ret;
+}
+
+/** Get the async socket and its data with the index.
+ *
+ *  @note
+ *  -# The async socket table grows in chunks, the chunk is allocated when the first index in it is
+ *   used and the async socket is created when it's used for the first time.
+ */
+static u32 _getAssocketAsocket(
+    internal_assocket_t * pia, u32 u32Index, jf_network_asocket_t ** ppAsocket,
+    assocket_data_t ** ppData)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Chunk = u32Index / ASS_ASOCKET_CHUNK_SIZE;
+    u32 u32Slot = u32Index % ASS_ASOCKET_CHUNK_SIZE;
+    assocket_chunk_t * pac = pia->ia_ppacChunk[u32Chunk];
+
+    if (pac == NULL)
+    {
+        jf_logger_logInfoMsg("create chunk %u for assocket %s", u32Chunk, pia->ia_strName);
+
+        u32Ret = jf_jiukun_allocMemory((void **)&pac, sizeof(*pac));
+        if (u32Ret == JF_ERR_NO_ERROR)
+        {
+            ol_bzero(pac, sizeof(*pac));
+            pia->ia_ppacChunk[u32Chunk] = pac;
+        }
+    }
+
+    if ((u32Ret == JF_ERR_NO_ERROR) && (pac->ac_pjnaAsockets[u32Slot] == NULL))
+        u32Ret = _createAssocketAsocket(pia, u32Index, &pac->ac_pjnaAsockets[u32Slot]);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        *ppAsocket = pac->ac_pjnaAsockets[u32Slot];
+        *ppData = &pac->ac_adData[u32Slot];
+    }
+
+    return u32Ret;
+}
 
 /* --- public routine section ------------------------------------------------------------------- */
 
@@ -276,28 +479,27 @@ u32 jf_network_destroyAssocket(jf_network_assocket_t ** ppAssocket)
 
     jf_logger_logInfoMsg("destroy assocket");
 
-    if (pia->ia_pjnaAsockets != NULL)
+    if (pia->ia_ppacChunk != NULL)
     {
-        for (u32Index = 0;
-             ((u32Index < pia->ia_u32MaxConn) && (u32Ret == JF_ERR_NO_ERROR));
-             u32Index ++)
+        for (u32Index = 0; u32Index < pia->ia_u32NumOfChunk; u32Index ++)
         {
-            if (pia->ia_pjnaAsockets[u32Index] != NULL)
-                destroyAsocket(&pia->ia_pjnaAsockets[u32Index]);
+            if (pia->ia_ppacChunk[u32Index] != NULL)
+                _destroyAssocketChunk(&pia->ia_ppacChunk[u32Index]);
         }
 
-        jf_jiukun_freeMemory((void **)&pia->ia_pjnaAsockets);
+        jf_jiukun_freeMemory((void **)&pia->ia_ppacChunk);
     }
 
     if (pia->ia_pjlAsocket != NULL)
         jf_jiukun_freeMemory((void **)&pia->ia_pjlAsocket);
 
-    if (pia->ia_padData != NULL)
-        jf_jiukun_freeMemory((void **)&pia->ia_padData);
-
     if (pia->ia_pjnsListenSocket != NULL)
         jf_network_destroySocket(&(pia->ia_pjnsListenSocket));
 
+    /*The async sockets sharing the utimer are destroyed.*/
+    if (pia->ia_pjnuUtimer != NULL)
+        jf_network_destroyUtimer(&pia->ia_pjnuUtimer);
+
     jf_mutex_fini(&pia->ia_jmAsocket);
 
     jf_jiukun_freeMemory(ppAssocket);
@@ -311,9 +513,6 @@ u32 jf_network_createAssocket(
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
     internal_assocket_t * pia = NULL;
-    asocket_create_param_t acp;
-    u32 u32Index;
-    olchar_t strName[JF_NETWORK_MAX_NAME_LEN];
 
     assert((pChain != NULL) && (ppAssocket != NULL) && (pjnacp != NULL));
     assert((pjnacp->jnacp_u32MaxConn != 0) &&
@@ -345,16 +544,20 @@ u32 jf_network_createAssocket(
         pia->ia_u32MaxConn = pjnacp->jnacp_u32MaxConn;
         pia->ia_u16PortNumber = pjnacp->jnacp_u16ServerPort;
         ol_memcpy(&(pia->ia_jiAddr), &(pjnacp->jnacp_jiServer), sizeof(jf_ipaddr_t));
+        pia->ia_sInitialBuf = pjnacp->jnacp_sInitialBuf;
+        pia->ia_u8SocketProfile = pjnacp->jnacp_u8SocketProfile;
         ol_strncpy(pia->ia_strName, pjnacp->jnacp_pstrName, JF_NETWORK_MAX_NAME_LEN - 1);
 
+        /*Only the chunk pointers are allocated, the chunks are created on demand*/
+        pia->ia_u32NumOfChunk =
+            (pjnacp->jnacp_u32MaxConn + ASS_ASOCKET_CHUNK_SIZE - 1) / ASS_ASOCKET_CHUNK_SIZE;
         u32Ret = jf_jiukun_allocMemory(
-            (void **)&pia->ia_pjnaAsockets,
-            pjnacp->jnacp_u32MaxConn * sizeof(jf_network_asocket_t *));
+            (void **)&pia->ia_ppacChunk, pia->ia_u32NumOfChunk * sizeof(assocket_chunk_t *));
     }
 
     if (u32Ret == JF_ERR_NO_ERROR)
     {
-        ol_bzero(pia->ia_pjnaAsockets, pjnacp->jnacp_u32MaxConn * sizeof(jf_network_asocket_t *));
+        ol_bzero(pia->ia_ppacChunk, pia->ia_u32NumOfChunk * sizeof(assocket_chunk_t *));
 
         u32Ret = jf_jiukun_allocMemory(
             (void **)&pia->ia_pjlAsocket, jf_listarray_getSize(pjnacp->jnacp_u32MaxConn));
@@ -365,43 +568,12 @@ u32 jf_network_createAssocket(
         ol_bzero(pia->ia_pjlAsocket, jf_listarray_getSize(pjnacp->jnacp_u32MaxConn));
         jf_listarray_init(pia->ia_pjlAsocket, pjnacp->jnacp_u32MaxConn);
 
-        u32Ret = jf_jiukun_allocMemory(
-            (void **)&pia->ia_padData, pjnacp->jnacp_u32MaxConn * sizeof(assocket_data_t));
-    }
-
-    if (u32Ret == JF_ERR_NO_ERROR)
-    {
-        ol_bzero(pia->ia_padData, pjnacp->jnacp_u32MaxConn * sizeof(assocket_data_t));
-
         u32Ret = jf_mutex_init(&pia->ia_jmAsocket);
     }
 
+    /*The utimer is shared by all async sockets, so only one utimer is added to the chain.*/
     if (u32Ret == JF_ERR_NO_ERROR)
-    {
-        ol_bzero(&acp, sizeof(acp));
-
-        acp.acp_sInitialBuf = pjnacp->jnacp_sInitialBuf;
-        acp.acp_fnOnData = _assOnData;
-        acp.acp_fnOnDisconnect = _assOnDisconnect;
-        acp.acp_fnOnSendData = _assOnSendData;
-        strName[JF_NETWORK_MAX_NAME_LEN - 1] = '\0';
-        acp.acp_pstrName = strName;
-
-        /*Create async socket pool.*/
-        for (u32Index = 0; 
-             ((u32Index < pjnacp->jnacp_u32MaxConn) && (u32Ret == JF_ERR_NO_ERROR));
-             u32Index ++)
-        {
-            ol_snprintf(
-                strName, JF_NETWORK_MAX_NAME_LEN - 1, "%s-%d", pjnacp->jnacp_pstrName, u32Index);
-
-            u32Ret = createAsocket(pChain, &pia->ia_pjnaAsockets[u32Index], &acp);
-            if (u32Ret == JF_ERR_NO_ERROR)
-            {
-                setIndexOfAsocket(pia->ia_pjnaAsockets[u32Index], u32Index);
-            }
-        }
-    }
+        u32Ret = jf_network_createUtimer(pChain, &pia->ia_pjnuUtimer, pia->ia_strName);
 
     if (u32Ret == JF_ERR_NO_ERROR)
         u32Ret = jf_network_appendToChain(pChain, pia);
@@ -21,6 +21,8 @@
 #include "jf_network.h"
 #include "jf_mutex.h"
 
+#include "chain.h"
+
 #if defined(LINUX)
     #include "signal.h"   
 #endif
@@ -43,8 +45,12 @@ typedef struct internal_basic_chain
     /** pipe, to wakeup or stop the chain*/
     jf_network_socket_t * ibc_pjnsWakeup[2];
     jf_mutex_t ibc_jmLock;
+    /** Statistics of the chain, only the first node is used */
+    jf_network_chain_stat_t ibc_jncsStat;
     /** Next chain */
     struct internal_basic_chain *ibc_pibcNext;
+    /** Last node of the chain, only the first node is used */
+    struct internal_basic_chain *ibc_pibcTail;
 } internal_basic_chain_t;
 
 
@@ -56,6 +62,7 @@ static u32 _readWakeupSocket(internal_basic_chain_t * pibc)
     olsize_t i, u32Count = 100;
 
     u32Ret = jf_network_recv(pibc->ibc_pjnsWakeup[0], u8Buffer, &u32Count);
+    pibc->ibc_jncsStat.jncs_u64WakeupRecv ++;
     if (u32Ret == JF_ERR_NO_ERROR)
     {
         for (i = 0; i < u32Count; i ++)
@@ -143,14 +150,13 @@ u32 jf_network_appendToChain(
     jf_network_chain_t * pChain, jf_network_chain_object_t * pObject)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
-    internal_basic_chain_t * pibc;
+    internal_basic_chain_t * pHead, * pibc;
 
-    pibc = (internal_basic_chain_t *) pChain;
-    /* Add link to the end of the chain (Linked List) */
-    while (pibc->ibc_pibcNext != NULL)
-    {
-        pibc = pibc->ibc_pibcNext;
-    }
+    pHead = (internal_basic_chain_t *) pChain;
+    /* Add link to the end of the chain (Linked List), the tail is saved in the first node */
+    pibc = pHead->ibc_pibcTail;
+    if (pibc == NULL)
+        pibc = pHead;
 
     if (pibc->ibc_pbcoObject != NULL)
     {
@@ -167,6 +173,7 @@ u32 jf_network_appendToChain(
     if (u32Ret == JF_ERR_NO_ERROR)
     {
         pibc->ibc_pbcoObject = pObject;
+        pHead->ibc_pibcTail = pibc;
     }
 
     return u32Ret;
@@ -221,6 +228,7 @@ u32 jf_network_startChain(jf_network_chain_t * pChain)
 #endif
         /*The actual select statement*/
         slct = select(FD_SETSIZE, &readset, &writeset, &errorset, &tv);
+        pibc->ibc_jncsStat.jncs_u64Select ++;
 #if defined(DEBUG_CHAIN)
         jf_logger_logInfoMsg("exit select, %d", slct);
 #endif
@@ -294,6 +302,7 @@ u32 jf_network_wakeupChain(jf_network_chain_t * pChain)
 
     u32Count = 1;
     u32Ret = jf_network_send(pibc->ibc_pjnsWakeup[1], "W", &u32Count);
+    pibc->ibc_jncsStat.jncs_u64Wakeup ++;
 #if defined(DEBUG_CHAIN)
     if (u32Ret == JF_ERR_NO_ERROR)
     {
@@ -304,6 +313,37 @@ u32 jf_network_wakeupChain(jf_network_chain_t * pChain)
     return u32Ret;
 }
 
+u32 jf_network_getChainStat(jf_network_chain_t * pChain, jf_network_chain_stat_t * pStat)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_basic_chain_t * pibc = (internal_basic_chain_t *) pChain;
+
+    assert((pChain != NULL) && (pStat != NULL));
+
+    ol_memcpy(pStat, &pibc->ibc_jncsStat, sizeof(*pStat));
+
+    return u32Ret;
+}
+
+u32 jf_network_clearChainStat(jf_network_chain_t * pChain)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_basic_chain_t * pibc = (internal_basic_chain_t *) pChain;
+
+    assert(pChain != NULL);
+
+    ol_bzero(&pibc->ibc_jncsStat, sizeof(pibc->ibc_jncsStat));
+
+    return u32Ret;
+}
+
+jf_network_chain_stat_t * getChainStat(jf_network_chain_t * pChain)
+{
+    internal_basic_chain_t * pibc = (internal_basic_chain_t *) pChain;
+
+    return &pibc->ibc_jncsStat;
+}
+
 /*------------------------------------------------------------------------------------------------*/
 
 
@@ -0,0 +1,36 @@
+/**
+ *  @file chain.h
+ *
+ *  @brief Header file for the internal interface of chain
+ *
+ *  @author Min Zhang
+ *
+ *  @note
+ *  
+ */
+
+#ifndef NETWORK_CHAIN_H
+#define NETWORK_CHAIN_H
+
+/* --- standard C lib header files -------------------------------------------------------------- */
+
+/* --- internal header files -------------------------------------------------------------------- */
+#include "jf_basic.h"
+#include "jf_network.h"
+
+/* --- constant definitions --------------------------------------------------------------------- */
+
+/* --- data structures -------------------------------------------------------------------------- */
+
+/* --- functional routines ---------------------------------------------------------------------- */
+
+/** Get the statistics of the chain, the chain objects use it to update the counters in chain
+ *  thread.
+ */
+jf_network_chain_stat_t * getChainStat(jf_network_chain_t * pChain);
+
+#endif /*NETWORK_CHAIN_H*/
+
+/*------------------------------------------------------------------------------------------------*/
+
+
@@ -25,6 +25,7 @@
 
     #include <netinet/in.h>
     #include <netinet/ip.h>
+    #include <netinet/tcp.h>
     #include <arpa/inet.h>
     #include <netdb.h>
 #elif defined(WINDOWS)
@@ -50,6 +51,22 @@
  */
 #define  NET_PORT_NUMBER_RANGE        (15000)
 
+/** The socket buffer size for low latency profile.
+ */
+#define  NET_LOW_LATENCY_SOCKET_BUF   (32 * 1024)
+
+/** The busy poll time in microsecond for low latency profile.
+ */
+#define  NET_LOW_LATENCY_BUSY_POLL    (50)
+
+/** The socket buffer size for bulk profile, the kernel may clamp it to the system limit.
+ */
+#define  NET_BULK_SOCKET_BUF          (4 * 1024 * 1024)
+
+/** The threshold of unsent data in kernel for bulk profile.
+ */
+#define  NET_BULK_NOTSENT_LOWAT       (128 * 1024)
+
 /* --- private routine section ------------------------------------------------------------------ */
 
 static u32 _bindUdsSocket(
@@ -1089,6 +1106,24 @@ void setIsocketToFdSet(internal_socket_t * pis, fd_set * set)
     FD_SET(pis->is_isSocket, set);
 }
 
+/** On Linux, fd set is a bit array of FD_SETSIZE bits indexed by the socket, setting the socket
+ *  equal to or larger than FD_SETSIZE overruns the fd set. On Windows, fd set is an array of
+ *  sockets, any socket can be set.
+ */
+boolean_t isIsocketFitInFdSet(internal_socket_t * pis)
+{
+    boolean_t bRet = TRUE;
+
+    assert(pis != NULL);
+
+#if defined(LINUX)
+    if (pis->is_isSocket >= FD_SETSIZE)
+        bRet = FALSE;
+#endif
+
+    return bRet;
+}
+
 void clearIsocketFdSet(fd_set * set)
 {
     FD_ZERO(set);
@@ -1125,6 +1160,79 @@ u32 isSetSockOpt(
     return u32Ret;
 }
 
+u32 isSetSocketProfile(internal_socket_t * pis, u8 u8Profile)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    olint_t nValue = 0;
+
+    assert(pis != NULL);
+
+    if (u8Profile == JF_NETWORK_SOCKET_PROFILE_LOW_LATENCY)
+    {
+        nValue = 1;
+        u32Ret = isSetSockOpt(pis, IPPROTO_TCP, TCP_NODELAY, &nValue, sizeof(nValue));
+
+        if (u32Ret == JF_ERR_NO_ERROR)
+        {
+            nValue = NET_LOW_LATENCY_SOCKET_BUF;
+            u32Ret = isSetSockOpt(pis, SOL_SOCKET, SO_SNDBUF, &nValue, sizeof(nValue));
+        }
+
+        if (u32Ret == JF_ERR_NO_ERROR)
+            u32Ret = isSetSockOpt(pis, SOL_SOCKET, SO_RCVBUF, &nValue, sizeof(nValue));
+
+#if defined(SO_BUSY_POLL)
+        if (u32Ret == JF_ERR_NO_ERROR)
+        {
+            /*Privilege is required to set busy poll time larger than the system setting, ignore
+              the error.*/
+            nValue = NET_LOW_LATENCY_BUSY_POLL;
+            isSetSockOpt(pis, SOL_SOCKET, SO_BUSY_POLL, &nValue, sizeof(nValue));
+        }
+#endif
+    }
+    else if (u8Profile == JF_NETWORK_SOCKET_PROFILE_BULK)
+    {
+        nValue = NET_BULK_SOCKET_BUF;
+        u32Ret = isSetSockOpt(pis, SOL_SOCKET, SO_SNDBUF, &nValue, sizeof(nValue));
+
+        if (u32Ret == JF_ERR_NO_ERROR)
+            u32Ret = isSetSockOpt(pis, SOL_SOCKET, SO_RCVBUF, &nValue, sizeof(nValue));
+
+#if defined(TCP_NOTSENT_LOWAT)
+        if (u32Ret == JF_ERR_NO_ERROR)
+        {
+            nValue = NET_BULK_NOTSENT_LOWAT;
+            u32Ret = isSetSockOpt(pis, IPPROTO_TCP, TCP_NOTSENT_LOWAT, &nValue, sizeof(nValue));
+        }
+#endif
+    }
+    else if (u8Profile != JF_NETWORK_SOCKET_PROFILE_DEFAULT)
+    {
+        u32Ret = JF_ERR_INVALID_PARAM;
+    }
+
+    return u32Ret;
+}
+
+u32 isSetSocketCork(internal_socket_t * pis, boolean_t bCork)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+#if defined(LINUX)
+    olint_t nValue = bCork ? 1 : 0;
+#endif
+
+    assert(pis != NULL);
+
+#if defined(LINUX)
+    u32Ret = isSetSockOpt(pis, IPPROTO_TCP, TCP_CORK, &nValue, sizeof(nValue));
+#elif defined(WINDOWS)
+    u32Ret = JF_ERR_NOT_SUPPORTED;
+#endif
+
+    return u32Ret;
+}
+
 /*------------------------------------------------------------------------------------------------*/
 
 
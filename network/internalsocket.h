@@ -164,6 +164,8 @@ boolean_t isIsocketSetInFdSet(internal_socket_t * pis, fd_set * set);
 
 void setIsocketToFdSet(internal_socket_t * pis, fd_set * set);
 
+boolean_t isIsocketFitInFdSet(internal_socket_t * pis);
+
 void clearIsocketFdSet(fd_set * set);
 
 u32 isGetSockOpt(
@@ -172,6 +174,14 @@ u32 isGetSockOpt(
 u32 isSetSockOpt(
     internal_socket_t * pis, olint_t level, olint_t optname, void * optval, olsize_t optlen);
 
+/** Apply the tuning profile to the stream socket.
+ */
+u32 isSetSocketProfile(internal_socket_t * pis, u8 u8Profile);
+
+/** Cork or uncork the stream socket, partial frame is held until the socket is uncorked.
+ */
+u32 isSetSocketCork(internal_socket_t * pis, boolean_t bCork);
+
 #if defined(WINDOWS)
 /** For internal use and Windows platform only, a wrapper to WSAIoctl
  */
@@ -15,16 +15,17 @@ SONAME = jf_network
 
 SOURCES = internalsocket.c socket.c socketpair.c \
     chain.c utimer.c asocket.c assocket.c acsocket.c \
-    adgram.c resolve.c network.c
+    adgram.c resolve.c resolver.c network.c
 
-JIUTAI_SRCS = jf_mutex.c jf_time.c
+JIUTAI_SRCS = jf_mutex.c jf_time.c jf_hashtree.c
 
-EXTRA_LIBS = -ljf_logger -ljf_ifmgmt -ljf_jiukun
+EXTRA_LIBS = -ljf_logger -ljf_ifmgmt -ljf_files -ljf_jiukun
 
 ifeq ("$(DEBUG_JIUFENG)", "yes")
 #    EXTRA_CFLAGS += -DDEBUG_CHAIN
 #    EXTRA_CFLAGS += -DDEBUG_UTIMER
 #    EXTRA_CFLAGS += -DDEBUG_ASOCKET
+#    EXTRA_CFLAGS += -DDEBUG_ADGRAM
 endif
 
 include $(TOPDIR)/mak/lnxlib.mak
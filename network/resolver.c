@@ -0,0 +1,1331 @@
+/**
+ *  @file resolver.c
+ *
+ *  @brief The async DNS resolver implementation file.
+ *
+ *  @author Min Zhang
+ *
+ *  @note
+ *  -# The resolver is a chain object. Requests are queued with lock by any thread and handled in
+ *   the thread running the chain, so the name resolution never blocks the chain.
+ *  -# The query is sent to name server with adgram, utimer is used for timeout and retransmission.
+ *  -# The static host table and the resolver configuration file are parsed when the resolver is
+ *   created.
+ *  -# The result from name server is cached according to TTL, the negative result is cached with
+ *   a fixed TTL.
+ *  -# Each query has a random ID. The response is accepted only if it's from the name server and
+ *   port the query was sent to, to prevent the off-path spoofing.
+ */
+
+/* --- standard C lib header files -------------------------------------------------------------- */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#if defined(LINUX)
+    #include <sys/random.h>
+#endif
+
+/* --- internal header files -------------------------------------------------------------------- */
+#include "jf_basic.h"
+#include "jf_limit.h"
+#include "jf_err.h"
+#include "jf_network.h"
+#include "jf_mutex.h"
+#include "jf_jiukun.h"
+#include "jf_listhead.h"
+#include "jf_filestream.h"
+#include "jf_time.h"
+
+#include "adgram.h"
+
+/* --- private data/data structure section ------------------------------------------------------ */
+
+#define RESOLVER_DEFAULT_RESOLV_CONF          "/etc/resolv.conf"
+#define RESOLVER_DEFAULT_HOSTS                "/etc/hosts"
+
+/** Maximum number of name servers, the same as MAXNS in resolv.h.
+ */
+#define RESOLVER_MAX_NAME_SERVER              (3)
+
+#define RESOLVER_DEFAULT_TIMEOUT              (5)
+#define RESOLVER_MAX_TIMEOUT                  (30)
+#define RESOLVER_DEFAULT_ATTEMPTS             (2)
+#define RESOLVER_MAX_ATTEMPTS                 (5)
+#define RESOLVER_DEFAULT_MAX_CACHE_ENTRY      (256)
+
+/** TTL in second for negative result.
+ */
+#define RESOLVER_NEGATIVE_CACHE_TTL           (30)
+
+/** Maximum TTL in second of the cache entry.
+ */
+#define RESOLVER_MAX_CACHE_TTL                (86400)
+
+#define RESOLVER_MAX_LINE_LEN                 (512)
+
+/** DNS message definition, RFC 1035.
+ */
+#define RESOLVER_DNS_PORT                     (53)
+#define RESOLVER_DNS_MAX_MESSAGE_SIZE         (512)
+#define RESOLVER_DNS_HEADER_SIZE              (12)
+#define RESOLVER_DNS_MAX_LABEL_LEN            (63)
+/** Maximum number of compression pointers in a name, to avoid dead loop.
+ */
+#define RESOLVER_DNS_MAX_POINTER              (16)
+
+#define RESOLVER_DNS_TYPE_A                   (1)
+#define RESOLVER_DNS_TYPE_AAAA                (28)
+#define RESOLVER_DNS_CLASS_IN                 (1)
+
+#define RESOLVER_DNS_FLAG_QR                  (0x8000)
+#define RESOLVER_DNS_FLAG_RD                  (0x0100)
+#define RESOLVER_DNS_RCODE_MASK               (0x000F)
+
+#define RESOLVER_DNS_RCODE_NO_ERROR           (0)
+#define RESOLVER_DNS_RCODE_NAME_ERROR         (3)
+
+/** The request from upper layer.
+ */
+typedef struct resolver_request
+{
+    olchar_t rr_strName[JF_NETWORK_RESOLVER_MAX_HOST_NAME_LEN];
+    u8 rr_u8AddrType;
+    u8 rr_u8Reserved[7];
+    jf_network_fnResolverOnResult_t rr_fnOnResult;
+    void * rr_pUser;
+
+    jf_listhead_t rr_jlList;
+} resolver_request_t;
+
+/** The query sent to name server. Requests for the same name and address type share one query.
+ */
+typedef struct resolver_query
+{
+    struct internal_resolver * rq_pirResolver;
+    u16 rq_u16Id;
+    u8 rq_u8AddrType;
+    u8 rq_u8Reserved;
+    /**Number of times the query is sent.*/
+    u32 rq_u32Sent;
+    olchar_t rq_strName[JF_NETWORK_RESOLVER_MAX_HOST_NAME_LEN];
+    /**Requests waiting for the query.*/
+    jf_listhead_t rq_jlRequest;
+
+    jf_listhead_t rq_jlList;
+} resolver_query_t;
+
+/** The entry of static host table.
+ */
+typedef struct resolver_host
+{
+    olchar_t rh_strName[JF_NETWORK_RESOLVER_MAX_HOST_NAME_LEN];
+    jf_ipaddr_t rh_jiAddr;
+
+    jf_listhead_t rh_jlList;
+} resolver_host_t;
+
+/** The entry of cache.
+ */
+typedef struct resolver_cache_entry
+{
+    olchar_t rce_strName[JF_NETWORK_RESOLVER_MAX_HOST_NAME_LEN];
+    u8 rce_u8AddrType;
+    u8 rce_u8Reserved;
+    u16 rce_u16NumOfAddr;
+    u32 rce_u32Status;
+    /**Expire time in second of monotonic clock.*/
+    u32 rce_u32Expire;
+    u32 rce_u32Reserved;
+    jf_ipaddr_t rce_jiAddr[JF_NETWORK_RESOLVER_MAX_ADDR];
+
+    jf_listhead_t rce_jlList;
+} resolver_cache_entry_t;
+
+typedef struct internal_resolver
+{
+    jf_network_chain_object_header_t ir_jncohHeader;
+    jf_network_chain_t * ir_pjncChain;
+
+    jf_network_adgram_t * ir_pjnaAdgram;
+    jf_network_utimer_t * ir_pjnuUtimer;
+
+    olchar_t ir_strName[JF_NETWORK_MAX_NAME_LEN];
+
+    jf_ipaddr_t ir_jiServer[RESOLVER_MAX_NAME_SERVER];
+    u16 ir_u16ServerPort;
+    u16 ir_u16NumOfServer;
+    u16 ir_u16Reserved[2];
+
+    u32 ir_u32Timeout;
+    u32 ir_u32Attempts;
+
+    u32 ir_u32MaxCacheEntry;
+    u32 ir_u32NumOfCacheEntry;
+    /**Cache entry list, the most recently used entry is at the head.*/
+    jf_listhead_t ir_jlCache;
+    /**Static host table.*/
+    jf_listhead_t ir_jlHost;
+    /**Queries sent to name server.*/
+    jf_listhead_t ir_jlQuery;
+
+    /*start of lock protected section*/
+    jf_mutex_t ir_jmLock;
+    /**Requests from upper layer.*/
+    jf_listhead_t ir_jlWaitRequest;
+    /*end of lock protected section*/
+} internal_resolver_t;
+
+typedef u32 (* fnParseResolverLine_t)(internal_resolver_t * pir, olchar_t * pstrLine);
+
+/* --- private routine section ------------------------------------------------------------------ */
+
+static u16 _getResolverU16(u8 * pu8Buf)
+{
+    return (u16)((pu8Buf[0] << 8) | pu8Buf[1]);
+}
+
+static u32 _getResolverU32(u8 * pu8Buf)
+{
+    return ((u32)pu8Buf[0] << 24) | ((u32)pu8Buf[1] << 16) | ((u32)pu8Buf[2] << 8) | pu8Buf[3];
+}
+
+static void _setResolverU16(u8 * pu8Buf, u16 u16Value)
+{
+    pu8Buf[0] = (u8)(u16Value >> 8);
+    pu8Buf[1] = (u8)u16Value;
+}
+
+static u32 _getResolverCurrentTime(u32 * pu32Current)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    struct timespec tp;
+
+    u32Ret = jf_time_getClockTime(CLOCK_MONOTONIC_RAW, &tp);
+    if (u32Ret == JF_ERR_NO_ERROR)
+        *pu32Current = (u32)tp.tv_sec;
+
+    return u32Ret;
+}
+
+static u16 _getResolverDnsType(u8 u8AddrType)
+{
+    if (u8AddrType == JF_IPADDR_TYPE_V6)
+        return RESOLVER_DNS_TYPE_AAAA;
+
+    return RESOLVER_DNS_TYPE_A;
+}
+
+static u32 _getResolverIpAddrFromString(
+    const olchar_t * pstrAddr, u8 u8AddrType, jf_ipaddr_t * pji)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+
+    if (u8AddrType == JF_IPADDR_TYPE_V6)
+    {
+        /*jf_ipaddr doesn't support IPv6 string*/
+        ol_bzero(pji, sizeof(jf_ipaddr_t));
+        pji->ji_u8AddrType = JF_IPADDR_TYPE_V6;
+#if defined(LINUX)
+        if (inet_pton(AF_INET6, pstrAddr, pji->ji_uAddr.ju_u8Addr) != 1)
+            u32Ret = JF_ERR_INVALID_IP;
+#elif defined(WINDOWS)
+        u32Ret = JF_ERR_NOT_IMPLEMENTED;
+#endif
+    }
+    else
+    {
+        u32Ret = jf_ipaddr_getIpAddrFromString(pstrAddr, u8AddrType, pji);
+    }
+
+    return u32Ret;
+}
+
+/** Get the next token separated by blank from the line.
+ */
+static olchar_t * _getResolverToken(olchar_t ** ppstrLine)
+{
+    olchar_t * pstr = *ppstrLine, * pstrToken = NULL;
+
+    while ((*pstr == ' ') || (*pstr == '\t'))
+        pstr ++;
+
+    if (*pstr != '\0')
+    {
+        pstrToken = pstr;
+        while ((*pstr != '\0') && (*pstr != ' ') && (*pstr != '\t'))
+            pstr ++;
+
+        if (*pstr != '\0')
+        {
+            *pstr = '\0';
+            pstr ++;
+        }
+    }
+
+    *ppstrLine = pstr;
+
+    return pstrToken;
+}
+
+/** Remove the comment and the line feed from the line.
+ */
+static void _stripResolverLine(olchar_t * pstrLine)
+{
+    olchar_t * pstr = pstrLine;
+
+    while ((*pstr != '\0') && (*pstr != '#') && (*pstr != ';') && (*pstr != '\r') &&
+           (*pstr != '\n'))
+        pstr ++;
+
+    *pstr = '\0';
+}
+
+static u32 _parseResolverFile(
+    internal_resolver_t * pir, const olchar_t * pstrFile, fnParseResolverLine_t fnParseLine)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_filestream_t * pjf = NULL;
+    olchar_t strLine[RESOLVER_MAX_LINE_LEN];
+    olsize_t sLine;
+
+    u32Ret = jf_filestream_open(pstrFile, "r", &pjf);
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        while (u32Ret == JF_ERR_NO_ERROR)
+        {
+            sLine = sizeof(strLine);
+            u32Ret = jf_filestream_readLine(pjf, strLine, &sLine);
+            if (u32Ret == JF_ERR_NO_ERROR)
+            {
+                _stripResolverLine(strLine);
+                /*ignore the error and goto the next line*/
+                fnParseLine(pir, strLine);
+            }
+        }
+
+        jf_filestream_close(&pjf);
+    }
+
+    if (u32Ret == JF_ERR_END_OF_FILE)
+        u32Ret = JF_ERR_NO_ERROR;
+
+    return u32Ret;
+}
+
+/** Parse line of static host table, the format is "address name [aliases...]".
+ */
+static u32 _parseResolverHostLine(internal_resolver_t * pir, olchar_t * pstrLine)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    olchar_t * pstrAddr = NULL, * pstrName = NULL;
+    jf_ipaddr_t jiAddr;
+    resolver_host_t * prh = NULL;
+
+    pstrAddr = _getResolverToken(&pstrLine);
+    if (pstrAddr == NULL)
+        return u32Ret;
+
+    u32Ret = _getResolverIpAddrFromString(pstrAddr, JF_IPADDR_TYPE_V4, &jiAddr);
+    if (u32Ret != JF_ERR_NO_ERROR)
+        u32Ret = _getResolverIpAddrFromString(pstrAddr, JF_IPADDR_TYPE_V6, &jiAddr);
+
+    while ((u32Ret == JF_ERR_NO_ERROR) && ((pstrName = _getResolverToken(&pstrLine)) != NULL))
+    {
+        if (ol_strlen(pstrName) >= JF_NETWORK_RESOLVER_MAX_HOST_NAME_LEN)
+            continue;
+
+        u32Ret = jf_jiukun_allocMemory((void **)&prh, sizeof(resolver_host_t));
+        if (u32Ret == JF_ERR_NO_ERROR)
+        {
+            ol_bzero(prh, sizeof(resolver_host_t));
+            ol_strcpy(prh->rh_strName, pstrName);
+            ol_memcpy(&prh->rh_jiAddr, &jiAddr, sizeof(jf_ipaddr_t));
+
+            jf_listhead_addTail(&pir->ir_jlHost, &prh->rh_jlList);
+        }
+    }
+
+    return u32Ret;
+}
+
+static void _parseResolverOption(internal_resolver_t * pir, olchar_t * pstrOption)
+{
+    u32 u32Value = 0;
+
+    if (ol_strncmp(pstrOption, "timeout:", 8) == 0)
+    {
+        /*the value in parameter has higher priority*/
+        if ((pir->ir_u32Timeout == 0) && (ol_sscanf(pstrOption + 8, "%u", &u32Value) == 1))
+            pir->ir_u32Timeout = MIN(u32Value, RESOLVER_MAX_TIMEOUT);
+    }
+    else if (ol_strncmp(pstrOption, "attempts:", 9) == 0)
+    {
+        if ((pir->ir_u32Attempts == 0) && (ol_sscanf(pstrOption + 9, "%u", &u32Value) == 1))
+            pir->ir_u32Attempts = MIN(u32Value, RESOLVER_MAX_ATTEMPTS);
+    }
+}
+
+/** Parse line of resolver configuration file, only "nameserver" and "options" are supported.
+ */
+static u32 _parseResolverConfLine(internal_resolver_t * pir, olchar_t * pstrLine)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    olchar_t * pstrKey = NULL, * pstrValue = NULL;
+    jf_ipaddr_t * pjiServer = NULL;
+
+    pstrKey = _getResolverToken(&pstrLine);
+    if (pstrKey == NULL)
+        return u32Ret;
+
+    if (ol_strcmp(pstrKey, "nameserver") == 0)
+    {
+        pstrValue = _getResolverToken(&pstrLine);
+        if ((pstrValue != NULL) && (pir->ir_u16NumOfServer < RESOLVER_MAX_NAME_SERVER))
+        {
+            pjiServer = &pir->ir_jiServer[pir->ir_u16NumOfServer];
+
+            u32Ret = _getResolverIpAddrFromString(pstrValue, JF_IPADDR_TYPE_V4, pjiServer);
+            if (u32Ret != JF_ERR_NO_ERROR)
+                u32Ret = _getResolverIpAddrFromString(pstrValue, JF_IPADDR_TYPE_V6, pjiServer);
+
+            if (u32Ret == JF_ERR_NO_ERROR)
+                pir->ir_u16NumOfServer ++;
+        }
+    }
+    else if (ol_strcmp(pstrKey, "options") == 0)
+    {
+        while ((pstrValue = _getResolverToken(&pstrLine)) != NULL)
+            _parseResolverOption(pir, pstrValue);
+    }
+
+    return u32Ret;
+}
+
+static u16 _findResolverHost(
+    internal_resolver_t * pir, const olchar_t * pstrName, u8 u8AddrType, jf_ipaddr_t * pjiAddr)
+{
+    u16 u16NumOfAddr = 0;
+    resolver_host_t * prh = NULL;
+    jf_listhead_t * pos = NULL;
+
+    jf_listhead_forEach(&pir->ir_jlHost, pos)
+    {
+        prh = jf_listhead_getEntry(pos, resolver_host_t, rh_jlList);
+
+        if ((prh->rh_jiAddr.ji_u8AddrType == u8AddrType) &&
+            (ol_strcasecmp(prh->rh_strName, pstrName) == 0))
+        {
+            ol_memcpy(&pjiAddr[u16NumOfAddr], &prh->rh_jiAddr, sizeof(jf_ipaddr_t));
+            u16NumOfAddr ++;
+            if (u16NumOfAddr == JF_NETWORK_RESOLVER_MAX_ADDR)
+                break;
+        }
+    }
+
+    return u16NumOfAddr;
+}
+
+static void _destroyResolverCacheEntry(
+    internal_resolver_t * pir, resolver_cache_entry_t ** ppEntry)
+{
+    jf_listhead_del(&(*ppEntry)->rce_jlList);
+    pir->ir_u32NumOfCacheEntry --;
+
+    jf_jiukun_freeMemory((void **)ppEntry);
+}
+
+/** Find the cache entry, the expired entry is removed.
+ */
+static resolver_cache_entry_t * _findResolverCacheEntry(
+    internal_resolver_t * pir, const olchar_t * pstrName, u8 u8AddrType)
+{
+    resolver_cache_entry_t * prce = NULL;
+    jf_listhead_t * pos = NULL, * temppos = NULL;
+    u32 u32Current = 0;
+
+    if (_getResolverCurrentTime(&u32Current) != JF_ERR_NO_ERROR)
+        return NULL;
+
+    jf_listhead_forEachSafe(&pir->ir_jlCache, pos, temppos)
+    {
+        prce = jf_listhead_getEntry(pos, resolver_cache_entry_t, rce_jlList);
+
+        if ((prce->rce_u8AddrType == u8AddrType) &&
+            (ol_strcasecmp(prce->rce_strName, pstrName) == 0))
+        {
+            if (prce->rce_u32Expire <= u32Current)
+            {
+                _destroyResolverCacheEntry(pir, &prce);
+                break;
+            }
+
+            /*move the entry to head as it's the most recently used one*/
+            jf_listhead_move(&pir->ir_jlCache, pos);
+            return prce;
+        }
+    }
+
+    return NULL;
+}
+
+static u32 _addResolverCacheEntry(
+    internal_resolver_t * pir, resolver_query_t * prq, u32 u32Status, jf_ipaddr_t * pjiAddr,
+    u16 u16NumOfAddr, u32 u32Ttl)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    resolver_cache_entry_t * prce = NULL;
+    u32 u32Current = 0;
+
+    if ((u32Ttl == 0) || (pir->ir_u32MaxCacheEntry == 0))
+        return u32Ret;
+
+    u32Ret = _getResolverCurrentTime(&u32Current);
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        if (pir->ir_u32NumOfCacheEntry >= pir->ir_u32MaxCacheEntry)
+        {
+            /*cache is full, reuse the least recently used entry at the tail*/
+            prce = jf_listhead_getEntry(
+                pir->ir_jlCache.jl_pjlPrev, resolver_cache_entry_t, rce_jlList);
+            jf_listhead_del(&prce->rce_jlList);
+        }
+        else
+        {
+            u32Ret = jf_jiukun_allocMemory((void **)&prce, sizeof(resolver_cache_entry_t));
+            if (u32Ret == JF_ERR_NO_ERROR)
+                pir->ir_u32NumOfCacheEntry ++;
+        }
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ol_bzero(prce, sizeof(resolver_cache_entry_t));
+        ol_strcpy(prce->rce_strName, prq->rq_strName);
+        prce->rce_u8AddrType = prq->rq_u8AddrType;
+        prce->rce_u32Status = u32Status;
+        prce->rce_u32Expire = u32Current + MIN(u32Ttl, RESOLVER_MAX_CACHE_TTL);
+        prce->rce_u16NumOfAddr = u16NumOfAddr;
+        if (u16NumOfAddr > 0)
+            ol_memcpy(prce->rce_jiAddr, pjiAddr, sizeof(jf_ipaddr_t) * u16NumOfAddr);
+
+        jf_listhead_add(&pir->ir_jlCache, &prce->rce_jlList);
+    }
+
+    return u32Ret;
+}
+
+static u32 _notifyResolverRequest(
+    resolver_request_t ** ppRequest, u32 u32Status, jf_ipaddr_t * pjiAddr, u16 u16NumOfAddr)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    resolver_request_t * prr = *ppRequest;
+
+    prr->rr_fnOnResult(prr->rr_strName, u32Status, pjiAddr, u16NumOfAddr, prr->rr_pUser);
+
+    jf_jiukun_freeMemory((void **)ppRequest);
+
+    return u32Ret;
+}
+
+static void _destroyResolverRequestList(jf_listhead_t * pjlRequest)
+{
+    resolver_request_t * prr = NULL;
+    jf_listhead_t * pos = NULL, * temppos = NULL;
+
+    jf_listhead_forEachSafe(pjlRequest, pos, temppos)
+    {
+        prr = jf_listhead_getEntry(pos, resolver_request_t, rr_jlList);
+        jf_listhead_del(pos);
+
+        jf_jiukun_freeMemory((void **)&prr);
+    }
+}
+
+static resolver_query_t * _findResolverQuery(
+    internal_resolver_t * pir, const olchar_t * pstrName, u8 u8AddrType)
+{
+    resolver_query_t * prq = NULL;
+    jf_listhead_t * pos = NULL;
+
+    jf_listhead_forEach(&pir->ir_jlQuery, pos)
+    {
+        prq = jf_listhead_getEntry(pos, resolver_query_t, rq_jlList);
+
+        if ((prq->rq_u8AddrType == u8AddrType) && (ol_strcasecmp(prq->rq_strName, pstrName) == 0))
+            return prq;
+    }
+
+    return NULL;
+}
+
+static resolver_query_t * _findResolverQueryById(internal_resolver_t * pir, u16 u16Id)
+{
+    resolver_query_t * prq = NULL;
+    jf_listhead_t * pos = NULL;
+
+    jf_listhead_forEach(&pir->ir_jlQuery, pos)
+    {
+        prq = jf_listhead_getEntry(pos, resolver_query_t, rq_jlList);
+
+        if (prq->rq_u16Id == u16Id)
+            return prq;
+    }
+
+    return NULL;
+}
+
+/** Get a random ID which is not used by other queries.
+ */
+static u16 _getResolverQueryId(internal_resolver_t * pir)
+{
+    u16 u16Id = 0;
+
+    do
+    {
+#if defined(LINUX)
+        if (getrandom(&u16Id, sizeof(u16Id), GRND_NONBLOCK) != sizeof(u16Id))
+#endif
+            u16Id = (u16)ol_random();
+    } while (_findResolverQueryById(pir, u16Id) != NULL);
+
+    return u16Id;
+}
+
+/** Get the index of name server with the address and port.
+ *
+ *  @return TRUE if the address and port are of name server.
+ */
+static boolean_t _getResolverServerIndex(
+    internal_resolver_t * pir, jf_ipaddr_t * pjiRemote, u16 u16Port, u16 * pu16Index)
+{
+    u16 u16Index;
+    jf_ipaddr_t * pjiServer = NULL;
+
+    if (u16Port != pir->ir_u16ServerPort)
+        return FALSE;
+
+    for (u16Index = 0; u16Index < pir->ir_u16NumOfServer; u16Index ++)
+    {
+        pjiServer = &pir->ir_jiServer[u16Index];
+
+        if (pjiServer->ji_u8AddrType != pjiRemote->ji_u8AddrType)
+            continue;
+
+        if (((pjiServer->ji_u8AddrType == JF_IPADDR_TYPE_V4) &&
+             (pjiServer->ji_uAddr.ju_nAddr == pjiRemote->ji_uAddr.ju_nAddr)) ||
+            ((pjiServer->ji_u8AddrType == JF_IPADDR_TYPE_V6) &&
+             (ol_memcmp(pjiServer->ji_uAddr.ju_u8Addr, pjiRemote->ji_uAddr.ju_u8Addr,
+                        sizeof(pjiServer->ji_uAddr.ju_u8Addr)) == 0)))
+        {
+            *pu16Index = u16Index;
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+/** Notify all the requests waiting for the query and destroy the query.
+ */
+static u32 _finishResolverQuery(
+    internal_resolver_t * pir, resolver_query_t ** ppQuery, u32 u32Status, jf_ipaddr_t * pjiAddr,
+    u16 u16NumOfAddr)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    resolver_query_t * prq = *ppQuery;
+    resolver_request_t * prr = NULL;
+    jf_listhead_t * pos = NULL, * temppos = NULL;
+
+    jf_network_removeUtimerItem(pir->ir_pjnuUtimer, prq);
+    jf_listhead_del(&prq->rq_jlList);
+
+    jf_listhead_forEachSafe(&prq->rq_jlRequest, pos, temppos)
+    {
+        prr = jf_listhead_getEntry(pos, resolver_request_t, rr_jlList);
+        jf_listhead_del(pos);
+
+        _notifyResolverRequest(&prr, u32Status, pjiAddr, u16NumOfAddr);
+    }
+
+    jf_jiukun_freeMemory((void **)ppQuery);
+
+    return u32Ret;
+}
+
+static u32 _buildResolverQueryMessage(resolver_query_t * prq, u8 * pu8Msg, olsize_t * psMsg)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    olsize_t sOffset = RESOLVER_DNS_HEADER_SIZE, sLabel = 0;
+    olchar_t * pstrLabel = prq->rq_strName, * pstrDot = NULL;
+
+    ol_bzero(pu8Msg, RESOLVER_DNS_HEADER_SIZE);
+    _setResolverU16(pu8Msg, prq->rq_u16Id);
+    _setResolverU16(pu8Msg + 2, RESOLVER_DNS_FLAG_RD);
+    /*one question*/
+    _setResolverU16(pu8Msg + 4, 1);
+
+    /*question name in labels*/
+    while ((u32Ret == JF_ERR_NO_ERROR) && (*pstrLabel != '\0'))
+    {
+        pstrDot = ol_strchr(pstrLabel, '.');
+        if (pstrDot != NULL)
+            sLabel = pstrDot - pstrLabel;
+        else
+            sLabel = ol_strlen(pstrLabel);
+
+        if ((sLabel == 0) || (sLabel > RESOLVER_DNS_MAX_LABEL_LEN) ||
+            (sOffset + sLabel + 1 + 5 > *psMsg))
+        {
+            u32Ret = JF_ERR_INVALID_NAME;
+        }
+        else
+        {
+            pu8Msg[sOffset ++] = (u8)sLabel;
+            ol_memcpy(pu8Msg + sOffset, pstrLabel, sLabel);
+            sOffset += sLabel;
+
+            pstrLabel += sLabel;
+            if (*pstrLabel == '.')
+                pstrLabel ++;
+        }
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        pu8Msg[sOffset ++] = 0;
+        _setResolverU16(pu8Msg + sOffset, _getResolverDnsType(prq->rq_u8AddrType));
+        sOffset += 2;
+        _setResolverU16(pu8Msg + sOffset, RESOLVER_DNS_CLASS_IN);
+        sOffset += 2;
+
+        *psMsg = sOffset;
+    }
+
+    return u32Ret;
+}
+
+static u32 _onResolverQueryTimeout(void * pData);
+
+/** Send the query to the next name server.
+ *
+ *  @note
+ *  -# Name servers are tried in turn, each name server is tried for ir_u32Attempts times.
+ *
+ *  @return The error code.
+ *  @retval JF_ERR_TIMEOUT All attempts are used up.
+ */
+static u32 _sendResolverQuery(internal_resolver_t * pir, resolver_query_t * prq)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u8 * pu8Msg = NULL;
+    olsize_t sMsg = RESOLVER_DNS_MAX_MESSAGE_SIZE;
+    jf_ipaddr_t * pjiServer = NULL;
+
+    if (pir->ir_u16NumOfServer == 0)
+        u32Ret = JF_ERR_NAME_SERVER_NOT_FOUND;
+    else if (prq->rq_u32Sent >= pir->ir_u32Attempts * pir->ir_u16NumOfServer)
+        u32Ret = JF_ERR_TIMEOUT;
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = jf_jiukun_allocMemory((void **)&pu8Msg, sMsg);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = _buildResolverQueryMessage(prq, pu8Msg, &sMsg);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        pjiServer = &pir->ir_jiServer[prq->rq_u32Sent % pir->ir_u16NumOfServer];
+        /*the buffer is freed by adgram after it's sent*/
+        u32Ret = sendAdgramData(pir->ir_pjnaAdgram, pu8Msg, sMsg, pjiServer, pir->ir_u16ServerPort);
+        if (u32Ret == JF_ERR_NO_ERROR)
+            pu8Msg = NULL;
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        prq->rq_u32Sent ++;
+
+        u32Ret = jf_network_addUtimerItem(
+            pir->ir_pjnuUtimer, prq, pir->ir_u32Timeout, _onResolverQueryTimeout, NULL);
+    }
+
+    if (pu8Msg != NULL)
+        jf_jiukun_freeMemory((void **)&pu8Msg);
+
+    return u32Ret;
+}
+
+static u32 _onResolverQueryTimeout(void * pData)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    resolver_query_t * prq = (resolver_query_t *)pData;
+    internal_resolver_t * pir = prq->rq_pirResolver;
+
+    jf_logger_logDebugMsg(
+        "resolver %s, query %s timeout, sent %u", pir->ir_strName, prq->rq_strName, prq->rq_u32Sent);
+
+    u32Ret = _sendResolverQuery(pir, prq);
+    if (u32Ret != JF_ERR_NO_ERROR)
+        _finishResolverQuery(pir, &prq, u32Ret, NULL, 0);
+
+    return u32Ret;
+}
+
+static u32 _createResolverQuery(
+    internal_resolver_t * pir, resolver_request_t * prr, resolver_query_t ** ppQuery)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    resolver_query_t * prq = NULL;
+
+    u32Ret = jf_jiukun_allocMemory((void **)&prq, sizeof(resolver_query_t));
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ol_bzero(prq, sizeof(resolver_query_t));
+        prq->rq_pirResolver = pir;
+        prq->rq_u16Id = _getResolverQueryId(pir);
+        prq->rq_u8AddrType = prr->rr_u8AddrType;
+        ol_strcpy(prq->rq_strName, prr->rr_strName);
+        jf_listhead_init(&prq->rq_jlRequest);
+
+        jf_listhead_addTail(&pir->ir_jlQuery, &prq->rq_jlList);
+
+        *ppQuery = prq;
+    }
+
+    return u32Ret;
+}
+
+/** Handle the request from upper layer.
+ *
+ *  @note
+ *  -# Numeric address, static host table and cache are checked in turn before the query is sent.
+ */
+static u32 _processResolverRequest(internal_resolver_t * pir, resolver_request_t * prr)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_ipaddr_t jiAddr[JF_NETWORK_RESOLVER_MAX_ADDR];
+    u16 u16NumOfAddr = 0;
+    resolver_cache_entry_t * prce = NULL;
+    resolver_query_t * prq = NULL;
+
+    if (_getResolverIpAddrFromString(prr->rr_strName, prr->rr_u8AddrType, jiAddr) ==
+        JF_ERR_NO_ERROR)
+    {
+        _notifyResolverRequest(&prr, JF_ERR_NO_ERROR, jiAddr, 1);
+    }
+    else if ((u16NumOfAddr = _findResolverHost(
+                  pir, prr->rr_strName, prr->rr_u8AddrType, jiAddr)) > 0)
+    {
+        _notifyResolverRequest(&prr, JF_ERR_NO_ERROR, jiAddr, u16NumOfAddr);
+    }
+    else if ((prce = _findResolverCacheEntry(pir, prr->rr_strName, prr->rr_u8AddrType)) != NULL)
+    {
+        _notifyResolverRequest(
+            &prr, prce->rce_u32Status, prce->rce_jiAddr, prce->rce_u16NumOfAddr);
+    }
+    else if ((prq = _findResolverQuery(pir, prr->rr_strName, prr->rr_u8AddrType)) != NULL)
+    {
+        /*the query is sent already, wait for the result*/
+        jf_listhead_addTail(&prq->rq_jlRequest, &prr->rr_jlList);
+    }
+    else
+    {
+        u32Ret = _createResolverQuery(pir, prr, &prq);
+        if (u32Ret == JF_ERR_NO_ERROR)
+        {
+            jf_listhead_addTail(&prq->rq_jlRequest, &prr->rr_jlList);
+
+            u32Ret = _sendResolverQuery(pir, prq);
+            if (u32Ret != JF_ERR_NO_ERROR)
+                _finishResolverQuery(pir, &prq, u32Ret, NULL, 0);
+        }
+        else
+        {
+            _notifyResolverRequest(&prr, u32Ret, NULL, 0);
+        }
+    }
+
+    return u32Ret;
+}
+
+/** Get the name from message, the compression pointer is supported.
+ *
+ *  @param pu8Msg [in] The DNS message.
+ *  @param sMsg [in] The size of the message.
+ *  @param psOffset [in/out] The offset of the name, it's set to the offset after the name.
+ *  @param pstrName [out] The name in dot format, it can be NULL if the name is not required.
+ *  @param sName [in] The size of the name buffer.
+ *
+ *  @return The error code.
+ */
+static u32 _getResolverDnsName(
+    u8 * pu8Msg, olsize_t sMsg, olsize_t * psOffset, olchar_t * pstrName, olsize_t sName)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    olsize_t sOffset = *psOffset, sNext = 0, sLen = 0;
+    u32 u32Pointer = 0;
+    u8 u8Len = 0;
+
+    while (u32Ret == JF_ERR_NO_ERROR)
+    {
+        if (sOffset >= sMsg)
+        {
+            u32Ret = JF_ERR_INVALID_DNS_MESSAGE;
+            break;
+        }
+
+        u8Len = pu8Msg[sOffset];
+        if (u8Len == 0)
+        {
+            sOffset ++;
+            break;
+        }
+
+        if ((u8Len & 0xC0) == 0xC0)
+        {
+            /*compression pointer*/
+            if ((sOffset + 1 >= sMsg) || (u32Pointer >= RESOLVER_DNS_MAX_POINTER))
+            {
+                u32Ret = JF_ERR_INVALID_DNS_MESSAGE;
+            }
+            else
+            {
+                if (u32Pointer == 0)
+                    sNext = sOffset + 2;
+
+                sOffset = ((u8Len & 0x3F) << 8) | pu8Msg[sOffset + 1];
+                u32Pointer ++;
+            }
+        }
+        else if (((u8Len & 0xC0) != 0) || (sOffset + 1 + u8Len > sMsg))
+        {
+            u32Ret = JF_ERR_INVALID_DNS_MESSAGE;
+        }
+        else
+        {
+            sOffset ++;
+            if (pstrName != NULL)
+            {
+                if (sLen + u8Len + 2 > sName)
+                {
+                    u32Ret = JF_ERR_INVALID_DNS_MESSAGE;
+                }
+                else
+                {
+                    if (sLen > 0)
+                        pstrName[sLen ++] = '.';
+                    ol_memcpy(pstrName + sLen, pu8Msg + sOffset, u8Len);
+                    sLen += u8Len;
+                }
+            }
+            sOffset += u8Len;
+        }
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        if (pstrName != NULL)
+            pstrName[sLen] = '\0';
+
+        if (u32Pointer > 0)
+            *psOffset = sNext;
+        else
+            *psOffset = sOffset;
+    }
+
+    return u32Ret;
+}
+
+/** Parse the answer section and save the address of requested type.
+ */
+static u32 _parseResolverAnswer(
+    resolver_query_t * prq, u8 * pu8Msg, olsize_t sMsg, olsize_t * psOffset, u16 u16AnCount,
+    jf_ipaddr_t * pjiAddr, u16 * pu16NumOfAddr, u32 * pu32Ttl)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    olsize_t sOffset = *psOffset;
+    u16 u16Index = 0, u16Type = 0, u16Class = 0, u16RdLen = 0;
+    u16 u16QueryType = _getResolverDnsType(prq->rq_u8AddrType);
+    u32 u32Ttl = 0;
+    jf_ipaddr_t * pji = NULL;
+
+    while ((u32Ret == JF_ERR_NO_ERROR) && (u16Index < u16AnCount))
+    {
+        u32Ret = _getResolverDnsName(pu8Msg, sMsg, &sOffset, NULL, 0);
+
+        if ((u32Ret == JF_ERR_NO_ERROR) && (sOffset + 10 > sMsg))
+            u32Ret = JF_ERR_INVALID_DNS_MESSAGE;
+
+        if (u32Ret == JF_ERR_NO_ERROR)
+        {
+            u16Type = _getResolverU16(pu8Msg + sOffset);
+            u16Class = _getResolverU16(pu8Msg + sOffset + 2);
+            u32Ttl = _getResolverU32(pu8Msg + sOffset + 4);
+            u16RdLen = _getResolverU16(pu8Msg + sOffset + 8);
+            sOffset += 10;
+
+            if (sOffset + u16RdLen > sMsg)
+                u32Ret = JF_ERR_INVALID_DNS_MESSAGE;
+        }
+
+        /*CNAME record is skipped, the name server returns the address of the canonical name*/
+        if ((u32Ret == JF_ERR_NO_ERROR) && (u16Class == RESOLVER_DNS_CLASS_IN) &&
+            (u16Type == u16QueryType) && (*pu16NumOfAddr < JF_NETWORK_RESOLVER_MAX_ADDR))
+        {
+            pji = &pjiAddr[*pu16NumOfAddr];
+            ol_bzero(pji, sizeof(jf_ipaddr_t));
+
+            if ((u16Type == RESOLVER_DNS_TYPE_A) && (u16RdLen == 4))
+            {
+                pji->ji_u8AddrType = JF_IPADDR_TYPE_V4;
+                ol_memcpy(&pji->ji_uAddr.ju_nAddr, pu8Msg + sOffset, 4);
+                (*pu16NumOfAddr) ++;
+                *pu32Ttl = MIN(*pu32Ttl, u32Ttl);
+            }
+            else if ((u16Type == RESOLVER_DNS_TYPE_AAAA) && (u16RdLen == 16))
+            {
+                pji->ji_u8AddrType = JF_IPADDR_TYPE_V6;
+                ol_memcpy(pji->ji_uAddr.ju_u8Addr, pu8Msg + sOffset, 16);
+                (*pu16NumOfAddr) ++;
+                *pu32Ttl = MIN(*pu32Ttl, u32Ttl);
+            }
+        }
+
+        sOffset += u16RdLen;
+        u16Index ++;
+    }
+
+    *psOffset = sOffset;
+
+    return u32Ret;
+}
+
+/** Process the response from name server.
+ *
+ *  @note
+ *  -# The name servers are tried in turn from the first one, the response is dropped if the query
+ *   is not sent to the name server yet.
+ */
+static u32 _processResolverResponse(
+    internal_resolver_t * pir, u16 u16Server, u8 * pu8Msg, olsize_t sMsg)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    resolver_query_t * prq = NULL;
+    u16 u16Flag = 0, u16AnCount = 0, u16NumOfAddr = 0;
+    u32 u32Status = JF_ERR_NO_ERROR, u32Ttl = RESOLVER_MAX_CACHE_TTL;
+    olsize_t sOffset = RESOLVER_DNS_HEADER_SIZE;
+    olchar_t strName[JF_NETWORK_RESOLVER_MAX_HOST_NAME_LEN];
+    jf_ipaddr_t jiAddr[JF_NETWORK_RESOLVER_MAX_ADDR];
+
+    if (sMsg < RESOLVER_DNS_HEADER_SIZE)
+        u32Ret = JF_ERR_INVALID_DNS_MESSAGE;
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        u16Flag = _getResolverU16(pu8Msg + 2);
+        u16AnCount = _getResolverU16(pu8Msg + 6);
+
+        prq = _findResolverQueryById(pir, _getResolverU16(pu8Msg));
+        if ((prq == NULL) || (u16Server >= prq->rq_u32Sent) ||
+            ((u16Flag & RESOLVER_DNS_FLAG_QR) == 0) ||
+            (_getResolverU16(pu8Msg + 4) != 1))
+            u32Ret = JF_ERR_INVALID_DNS_MESSAGE;
+    }
+
+    /*make sure the response is for the query*/
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = _getResolverDnsName(pu8Msg, sMsg, &sOffset, strName, sizeof(strName));
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        if ((sOffset + 4 > sMsg) || (ol_strcasecmp(strName, prq->rq_strName) != 0) ||
+            (_getResolverU16(pu8Msg + sOffset) != _getResolverDnsType(prq->rq_u8AddrType)))
+            u32Ret = JF_ERR_INVALID_DNS_MESSAGE;
+        else
+            sOffset += 4;
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        switch (u16Flag & RESOLVER_DNS_RCODE_MASK)
+        {
+        case RESOLVER_DNS_RCODE_NO_ERROR:
+            u32Ret = _parseResolverAnswer(
+                prq, pu8Msg, sMsg, &sOffset, u16AnCount, jiAddr, &u16NumOfAddr, &u32Ttl);
+            if (u16NumOfAddr == 0)
+                u32Status = JF_ERR_HOST_NO_ADDRESS;
+            break;
+        case RESOLVER_DNS_RCODE_NAME_ERROR:
+            u32Status = JF_ERR_HOST_NOT_FOUND;
+            break;
+        default:
+            u32Status = JF_ERR_NAME_SERVER_NO_RECOVERY;
+            break;
+        }
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        if (u32Status == JF_ERR_NAME_SERVER_NO_RECOVERY)
+        {
+            /*try the next name server*/
+            jf_network_removeUtimerItem(pir->ir_pjnuUtimer, prq);
+            if (_sendResolverQuery(pir, prq) != JF_ERR_NO_ERROR)
+                _finishResolverQuery(pir, &prq, u32Status, NULL, 0);
+        }
+        else
+        {
+            if (u32Status != JF_ERR_NO_ERROR)
+                u32Ttl = RESOLVER_NEGATIVE_CACHE_TTL;
+
+            _addResolverCacheEntry(pir, prq, u32Status, jiAddr, u16NumOfAddr, u32Ttl);
+            _finishResolverQuery(pir, &prq, u32Status, jiAddr, u16NumOfAddr);
+        }
+    }
+
+    return u32Ret;
+}
+
+static u32 _onResolverData(
+    jf_network_adgram_t * pAdgram, u8 * pu8Buffer, olsize_t * psBeginPointer,
+    olsize_t sEndPointer, void * pUser, jf_ipaddr_t * pjiRemote, u16 u16Port)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_resolver_t * pir = (internal_resolver_t *)pUser;
+    u16 u16Server = 0;
+
+    /*drop the datagram not from name server*/
+    if (! _getResolverServerIndex(pir, pjiRemote, u16Port, &u16Server))
+        u32Ret = JF_ERR_INVALID_DNS_MESSAGE;
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = _processResolverResponse(
+            pir, u16Server, pu8Buffer + *psBeginPointer, sEndPointer - *psBeginPointer);
+
+    if (u32Ret != JF_ERR_NO_ERROR)
+        jf_logger_logDebugMsg("resolver %s, drop response", pir->ir_strName);
+
+    /*one datagram is one message, all data are consumed*/
+    *psBeginPointer = sEndPointer;
+
+    return JF_ERR_NO_ERROR;
+}
+
+/** Pre select handler of resolver object for the chain.
+ *
+ *  @note
+ *  -# The requests from upper layer are handled here.
+ */
+static u32 _preSelectResolver(
+    jf_network_chain_object_t * pObject, fd_set * readset, fd_set * writeset, fd_set * errorset,
+    u32 * pu32BlockTime)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_resolver_t * pir = (internal_resolver_t *)pObject;
+    resolver_request_t * prr = NULL;
+    jf_listhead_t * pos = NULL, * temppos = NULL;
+    JF_LISTHEAD(jlRequest);
+
+    jf_mutex_acquire(&pir->ir_jmLock);
+    jf_listhead_spliceTail(&jlRequest, &pir->ir_jlWaitRequest);
+    jf_mutex_release(&pir->ir_jmLock);
+
+    jf_listhead_forEachSafe(&jlRequest, pos, temppos)
+    {
+        prr = jf_listhead_getEntry(pos, resolver_request_t, rr_jlList);
+        jf_listhead_del(pos);
+
+        _processResolverRequest(pir, prr);
+    }
+
+    return u32Ret;
+}
+
+/* --- public routine section ------------------------------------------------------------------- */
+
+u32 jf_network_destroyResolver(jf_network_resolver_t ** ppResolver)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_resolver_t * pir = NULL;
+    resolver_query_t * prq = NULL;
+    resolver_host_t * prh = NULL;
+    resolver_cache_entry_t * prce = NULL;
+    jf_listhead_t * pos = NULL, * temppos = NULL;
+
+    assert((ppResolver != NULL) && (*ppResolver != NULL));
+
+    pir = (internal_resolver_t *)*ppResolver;
+
+    jf_logger_logDebugMsg("destroy resolver %s", pir->ir_strName);
+
+    if (pir->ir_pjnuUtimer != NULL)
+        jf_network_destroyUtimer(&pir->ir_pjnuUtimer);
+
+    if (pir->ir_pjnaAdgram != NULL)
+        destroyAdgram(&pir->ir_pjnaAdgram);
+
+    _destroyResolverRequestList(&pir->ir_jlWaitRequest);
+
+    jf_listhead_forEachSafe(&pir->ir_jlQuery, pos, temppos)
+    {
+        prq = jf_listhead_getEntry(pos, resolver_query_t, rq_jlList);
+        jf_listhead_del(pos);
+
+        _destroyResolverRequestList(&prq->rq_jlRequest);
+        jf_jiukun_freeMemory((void **)&prq);
+    }
+
+    jf_listhead_forEachSafe(&pir->ir_jlCache, pos, temppos)
+    {
+        prce = jf_listhead_getEntry(pos, resolver_cache_entry_t, rce_jlList);
+        _destroyResolverCacheEntry(pir, &prce);
+    }
+
+    jf_listhead_forEachSafe(&pir->ir_jlHost, pos, temppos)
+    {
+        prh = jf_listhead_getEntry(pos, resolver_host_t, rh_jlList);
+        jf_listhead_del(pos);
+
+        jf_jiukun_freeMemory((void **)&prh);
+    }
+
+    jf_mutex_fini(&pir->ir_jmLock);
+
+    jf_jiukun_freeMemory(ppResolver);
+
+    return u32Ret;
+}
+
+u32 jf_network_createResolver(
+    jf_network_chain_t * pChain, jf_network_resolver_t ** ppResolver,
+    jf_network_resolver_create_param_t * pjnrcp)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_resolver_t * pir = NULL;
+    adgram_create_param_t acp;
+    const olchar_t * pstrFile = NULL;
+
+    assert((pChain != NULL) && (ppResolver != NULL) && (pjnrcp != NULL));
+
+    jf_logger_logDebugMsg("create resolver %s", pjnrcp->jnrcp_pstrName);
+
+    u32Ret = jf_jiukun_allocMemory((void **)&pir, sizeof(internal_resolver_t));
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ol_bzero(pir, sizeof(internal_resolver_t));
+        pir->ir_jncohHeader.jncoh_fnPreSelect = _preSelectResolver;
+        pir->ir_pjncChain = pChain;
+        ol_strncpy(pir->ir_strName, pjnrcp->jnrcp_pstrName, JF_NETWORK_MAX_NAME_LEN - 1);
+        pir->ir_u32Timeout = MIN(pjnrcp->jnrcp_u32Timeout, RESOLVER_MAX_TIMEOUT);
+        pir->ir_u32Attempts = MIN(pjnrcp->jnrcp_u32Attempts, RESOLVER_MAX_ATTEMPTS);
+        pir->ir_u32MaxCacheEntry = pjnrcp->jnrcp_u32MaxCacheEntry;
+        if (pir->ir_u32MaxCacheEntry == 0)
+            pir->ir_u32MaxCacheEntry = RESOLVER_DEFAULT_MAX_CACHE_ENTRY;
+        jf_listhead_init(&pir->ir_jlCache);
+        jf_listhead_init(&pir->ir_jlHost);
+        jf_listhead_init(&pir->ir_jlQuery);
+        jf_listhead_init(&pir->ir_jlWaitRequest);
+
+        u32Ret = jf_mutex_init(&pir->ir_jmLock);
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        /*the missing file is not an error*/
+        pstrFile = pjnrcp->jnrcp_pstrHosts;
+        if (pstrFile == NULL)
+            pstrFile = RESOLVER_DEFAULT_HOSTS;
+        _parseResolverFile(pir, pstrFile, _parseResolverHostLine);
+
+        pstrFile = pjnrcp->jnrcp_pstrResolvConf;
+        if (pstrFile == NULL)
+            pstrFile = RESOLVER_DEFAULT_RESOLV_CONF;
+        _parseResolverFile(pir, pstrFile, _parseResolverConfLine);
+
+        if (pjnrcp->jnrcp_u16ServerPort != 0)
+        {
+            /*use the name server in parameter*/
+            ol_memcpy(&pir->ir_jiServer[0], &pjnrcp->jnrcp_jiServer, sizeof(jf_ipaddr_t));
+            pir->ir_u16NumOfServer = 1;
+            pir->ir_u16ServerPort = pjnrcp->jnrcp_u16ServerPort;
+        }
+        else
+        {
+            pir->ir_u16ServerPort = RESOLVER_DNS_PORT;
+        }
+
+        if (pir->ir_u32Timeout == 0)
+            pir->ir_u32Timeout = RESOLVER_DEFAULT_TIMEOUT;
+        if (pir->ir_u32Attempts == 0)
+            pir->ir_u32Attempts = RESOLVER_DEFAULT_ATTEMPTS;
+
+        u32Ret = jf_network_createUtimer(pChain, &pir->ir_pjnuUtimer, pir->ir_strName);
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ol_bzero(&acp, sizeof(acp));
+        acp.acp_sInitialBuf = RESOLVER_DNS_MAX_MESSAGE_SIZE;
+        acp.acp_fnOnData = _onResolverData;
+        acp.acp_pUser = pir;
+        acp.acp_pstrName = pir->ir_strName;
+
+        u32Ret = createAdgram(pChain, &pir->ir_pjnaAdgram, &acp);
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = jf_network_appendToChain(pChain, pir);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        *ppResolver = pir;
+    else if (pir != NULL)
+        jf_network_destroyResolver((jf_network_resolver_t **)&pir);
+
+    return u32Ret;
+}
+
+u32 jf_network_resolveHostName(
+    jf_network_resolver_t * pResolver, const olchar_t * pstrName, u8 u8AddrType,
+    jf_network_fnResolverOnResult_t fnOnResult, void * pUser)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_resolver_t * pir = (internal_resolver_t *)pResolver;
+    resolver_request_t * prr = NULL;
+    olsize_t sName = 0;
+
+    assert((pResolver != NULL) && (pstrName != NULL) && (fnOnResult != NULL));
+
+    sName = ol_strlen(pstrName);
+    if ((sName == 0) || (sName >= JF_NETWORK_RESOLVER_MAX_HOST_NAME_LEN))
+        u32Ret = JF_ERR_INVALID_NAME;
+    else if ((u8AddrType != JF_IPADDR_TYPE_V4) && (u8AddrType != JF_IPADDR_TYPE_V6))
+        u32Ret = JF_ERR_INVALID_IP_ADDR_TYPE;
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = jf_jiukun_allocMemory((void **)&prr, sizeof(resolver_request_t));
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ol_bzero(prr, sizeof(resolver_request_t));
+        ol_strcpy(prr->rr_strName, pstrName);
+        /*the trailing dot of the fully qualified name is removed*/
+        if ((sName > 1) && (prr->rr_strName[sName - 1] == '.'))
+            prr->rr_strName[sName - 1] = '\0';
+        prr->rr_u8AddrType = u8AddrType;
+        prr->rr_fnOnResult = fnOnResult;
+        prr->rr_pUser = pUser;
+        jf_listhead_init(&prr->rr_jlList);
+
+        jf_mutex_acquire(&pir->ir_jmLock);
+        jf_listhead_addTail(&pir->ir_jlWaitRequest, &prr->rr_jlList);
+        jf_mutex_release(&pir->ir_jmLock);
+
+        u32Ret = jf_network_wakeupChain(pir->ir_pjncChain);
+    }
+
+    return u32Ret;
+}
+
+/*------------------------------------------------------------------------------------------------*/
+
+
@@ -461,6 +461,15 @@ void jf_network_setSocketToFdSet(jf_network_socket_t * pSocket, fd_set * set)
     setIsocketToFdSet(pis, set);
 }
 
+boolean_t jf_network_isSocketFitInFdSet(jf_network_socket_t * pSocket)
+{
+    internal_socket_t * pis = (internal_socket_t *)pSocket;
+
+    assert(pSocket != NULL);
+
+    return isIsocketFitInFdSet(pis);
+}
+
 void jf_network_clearFdSet(fd_set * set)
 {
     clearIsocketFdSet(set);
@@ -487,5 +496,23 @@ u32 jf_network_setSocketOption(
     return isSetSockOpt(pis, level, optname, pOptval, sOptval);
 }
 
+u32 jf_network_setSocketProfile(jf_network_socket_t * pSocket, u8 u8Profile)
+{
+    internal_socket_t * pis = (internal_socket_t *)pSocket;
+
+    assert(pSocket != NULL);
+
+    return isSetSocketProfile(pis, u8Profile);
+}
+
+u32 jf_network_setSocketCork(jf_network_socket_t * pSocket, boolean_t bCork)
+{
+    internal_socket_t * pis = (internal_socket_t *)pSocket;
+
+    assert(pSocket != NULL);
+
+    return isSetSocketCork(pis, bCork);
+}
+
 /*------------------------------------------------------------------------------------------------*/
 
@@ -23,6 +23,11 @@
 #include "jf_listhead.h"
 
 /* --- private data/data structure section ------------------------------------------------------ */
+
+/** The cache of utimer item shared by all utimers.
+ */
+#define UTIMER_ITEM_CACHE                  "utimer_item"
+
 typedef struct utimer_item
 {
     u32 ui_u32Expire;
@@ -38,6 +43,8 @@ typedef struct utimer
     jf_network_chain_object_header_t iu_jncohHeader;
     jf_network_chain_t * iu_pbcChain;
     utimer_item_t * iu_puiItem;
+    /**The cache of utimer item.*/
+    jf_jiukun_cache_t * iu_pjjcItem;
 
     olchar_t iu_strName[JF_NETWORK_MAX_NAME_LEN];
 
@@ -51,7 +58,18 @@ typedef struct utimer
 
 /* --- private routine section ------------------------------------------------------------------ */
 
-static u32 _freeUtimerItem(utimer_item_t ** ppItem)
+/** Construct the utimer item when it's added to the cache, the item is returned to the cache in
+ *  this state.
+ */
+static void _constructUtimerItem(void * pObj)
+{
+    utimer_item_t * item = pObj;
+
+    ol_bzero(item, sizeof(*item));
+    jf_listhead_init(&item->ui_jlList);
+}
+
+static u32 _freeUtimerItem(internal_utimer_t * piu, utimer_item_t ** ppItem)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
     utimer_item_t * item = *ppItem;
@@ -59,7 +77,14 @@ static u32 _freeUtimerItem(utimer_item_t ** ppItem)
     if (item->ui_fnDestroy != NULL)
         item->ui_fnDestroy(&item->ui_pData);
 
-    jf_jiukun_freeMemory((void **)ppItem);
+    /*Only the fields set after allocation are restored, the item is returned in constructed
+      state. The item may be still linked in the list being destroyed, reinitialize the link.*/
+    item->ui_u32Expire = 0;
+    item->ui_pData = NULL;
+    item->ui_fnCallback = NULL;
+    item->ui_fnDestroy = NULL;
+    jf_listhead_init(&item->ui_jlList);
+    jf_jiukun_freeObject(piu->iu_pjjcItem, (void **)ppItem);
 
     return u32Ret;
 }
@@ -82,7 +107,7 @@ static u32 _destroyUtimerItems(internal_utimer_t * piu, jf_listhead_t * list, bo
             "destroy item of utimer %s, expire: %d", piu->iu_strName, temp->ui_u32Expire);
 #endif
 
-        _freeUtimerItem(&temp);
+        _freeUtimerItem(piu, &temp);
     }
 
     return u32Ret;
@@ -251,7 +276,7 @@ u32 jf_network_addUtimerItem(
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
     struct timespec tp;
-    utimer_item_t * pui;
+    utimer_item_t * pui = NULL;
     internal_utimer_t * piu = (internal_utimer_t *) pUtimer;
 
     assert((pData != NULL) && (fnCallback != NULL));
@@ -259,7 +284,7 @@ u32 jf_network_addUtimerItem(
 #if defined(DEBUG_UTIMER)
     jf_logger_logInfoMsg("add item to utimer %s", piu->iu_strName);
 #endif
-    u32Ret = jf_jiukun_allocMemory((void **)&pui, sizeof(utimer_item_t));
+    u32Ret = jf_jiukun_allocObject(piu->iu_pjjcItem, (void **)&pui);
     if (u32Ret == JF_ERR_NO_ERROR)
     {
         /*Get the current time for reference*/
@@ -268,7 +293,6 @@ u32 jf_network_addUtimerItem(
 
     if (u32Ret == JF_ERR_NO_ERROR)
     {
-        ol_memset(pui, 0, sizeof(utimer_item_t));
         /*Set the trigger time*/
         pui->ui_u32Expire = (tp.tv_sec * 1000) + (tp.tv_nsec / 1000000) + (u32Seconds * 1000);
 #if defined(DEBUG_UTIMER)
@@ -279,7 +303,6 @@ u32 jf_network_addUtimerItem(
         /*Set the callback handlers*/
         pui->ui_fnCallback = fnCallback;
         pui->ui_fnDestroy = fnDestroy;
-        jf_listhead_init(&pui->ui_jlList);
 
         u32Ret = _insertUtimerItem(piu, pui);
     }
@@ -288,7 +311,7 @@ u32 jf_network_addUtimerItem(
         u32Ret = jf_network_wakeupChain(piu->iu_pbcChain);
 
     if ((u32Ret != JF_ERR_NO_ERROR) && (pui != NULL))
-        _freeUtimerItem(&pui);
+        _freeUtimerItem(piu, &pui);
 
     return u32Ret;
 }
@@ -318,6 +341,9 @@ u32 jf_network_destroyUtimer(jf_network_utimer_t ** ppUtimer)
 
     _flushUtimer(piu);
 
+    if (piu->iu_pjjcItem != NULL)
+        jf_jiukun_destroyCache(&piu->iu_pjjcItem);
+
     jf_mutex_fini(&piu->iu_jmLock);
 
     jf_jiukun_freeMemory(ppUtimer);
@@ -346,6 +372,21 @@ u32 jf_network_createUtimer(
         u32Ret = jf_mutex_init(&piu->iu_jmLock);
     }
 
+    /*The item is allocated and freed for each timeout, construct it only when it's added to the
+      cache.*/
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        jf_jiukun_cache_create_param_t jjccp;
+
+        ol_bzero(&jjccp, sizeof(jjccp));
+        jjccp.jjccp_pstrName = UTIMER_ITEM_CACHE;
+        jjccp.jjccp_sObj = sizeof(utimer_item_t);
+        jjccp.jjccp_fnCtor = _constructUtimerItem;
+        JF_FLAG_SET(jjccp.jjccp_jfCache, JF_JIUKUN_CACHE_CREATE_FLAG_SHARED);
+
+        u32Ret = jf_jiukun_createCache(&piu->iu_pjjcItem, &jjccp);
+    }
+
     if (u32Ret == JF_ERR_NO_ERROR)
     {
         u32Ret = jf_network_appendToChain(pChain, (jf_network_chain_object_t *)piu);
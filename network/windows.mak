@@ -16,14 +16,14 @@ RESOURCE = network
 
 SOURCES = internalsocket.c socket.c socketpair.c chain.c \
     utimer.c asocket.c assocket.c acsocket.c \
-    adgram.c resolve.c network.c
+    adgram.c resolve.c resolver.c network.c
 
-JIUTAI_SRCS = $(JIUTAI_DIR)\jf_mutex.c $(JIUTAI_DIR)\jf_time.c
+JIUTAI_SRCS = $(JIUTAI_DIR)\jf_mutex.c $(JIUTAI_DIR)\jf_time.c $(JIUTAI_DIR)\jf_hashtree.c
 
 EXTRA_DEFS = -DJIUFENG_NETWORK_DLL
 
 EXTRA_LIBS = ws2_32.lib Iphlpapi.lib $(LIB_DIR)\jf_logger.lib $(LIB_DIR)\jf_jiukun.lib \
-    $(LIB_DIR)\jf_ifmgmt.lib $(LIB_DIR)\jf_string.lib
+    $(LIB_DIR)\jf_ifmgmt.lib $(LIB_DIR)\jf_string.lib $(LIB_DIR)\jf_files.lib
 
 !if "$(DEBUG_JIUFENG)" == "yes"
     EXTRA_CFLAGS = -DDEBUG_CHAIN -DDEBUG_UTIMER
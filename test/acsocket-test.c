@@ -0,0 +1,404 @@
+/**
+ *  @file acsocket-test.c
+ *
+ *  @brief Test file for the connection pool of async client socket in network library.
+ *
+ *  @author Min Zhang
+ *
+ *  @note
+ *  -# An async server socket and an async client socket are created in the same chain, the
+ *   server echoes the data from client.
+ *
+ */
+
+/* --- standard C lib header files -------------------------------------------------------------- */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+/* --- internal header files -------------------------------------------------------------------- */
+#include "jf_basic.h"
+#include "jf_limit.h"
+#include "jf_err.h"
+#include "jf_network.h"
+#include "jf_process.h"
+#include "jf_thread.h"
+#include "jf_time.h"
+#include "jf_jiukun.h"
+#include "jf_option.h"
+
+/* --- private data/data structure section ------------------------------------------------------ */
+
+#define ACSOCKET_TEST                 "ACSOCKET-TEST"
+
+#define ACSOCKET_TEST_SERVER_PORT     (51254)
+
+#define ACSOCKET_TEST_MAX_CONN        (4)
+
+#define ACSOCKET_TEST_BUF_SIZE        (512)
+
+#define ACSOCKET_TEST_IDLE_TIMEOUT    (2)
+
+static jf_network_chain_t * ls_pjncAtChain = NULL;
+
+static jf_network_assocket_t * ls_pjnaAtServer = NULL;
+
+static jf_network_acsocket_t * ls_pjnaAtClient = NULL;
+
+static boolean_t ls_bToTerminateAt = FALSE;
+
+static u32 ls_u32AtServerConn = 0;
+
+static u32 ls_u32AtServerDisconn = 0;
+
+static u32 ls_u32AtClientConnect = 0;
+
+static u32 ls_u32AtClientData = 0;
+
+static u32 ls_u32AtHealthCheck = 0;
+
+/* --- private routine section ------------------------------------------------------------------ */
+
+static void _printAcsocketTestUsage(void)
+{
+    ol_printf("\
+Usage: acsocket-test [-h] [logger options] \n\
+    -h print the usage.\n\
+logger options:\n\
+    -T <0|1|2|3|4> the log level. 0: no log, 1: error, 2: info, 3: debug, 4: data.\n\
+    -F <log file> the log file.\n\
+    -S <log file size> the size of log file. No limit if not specified.\n\
+    ");
+
+    ol_printf("\n");
+
+    exit(0);
+}
+
+static u32 _parseAcsocketTestCmdLineParam(
+    olint_t argc, olchar_t ** argv, jf_logger_init_param_t * pjlip)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    olint_t nOpt;
+
+    while (((nOpt = getopt(argc, argv, "T:F:S:h")) != -1) &&
+           (u32Ret == JF_ERR_NO_ERROR))
+    {
+        switch (nOpt)
+        {
+        case '?':
+        case 'h':
+            _printAcsocketTestUsage();
+            exit(0);
+            break;
+        case ':':
+            u32Ret = JF_ERR_MISSING_PARAM;
+            break;
+        case 'T':
+            u32Ret = jf_option_getU8FromString(optarg, &pjlip->jlip_u8TraceLevel);
+            break;
+        case 'F':
+            pjlip->jlip_bLogToFile = TRUE;
+            pjlip->jlip_pstrLogFilePath = optarg;
+            break;
+        case 'S':
+            u32Ret = jf_option_getS32FromString(optarg, &pjlip->jlip_sLogFile);
+            break;
+        default:
+            u32Ret = JF_ERR_INVALID_OPTION;
+            break;
+        }
+    }
+
+    return u32Ret;
+}
+
+static void _terminate(olint_t signal)
+{
+    ol_printf("get signal\n");
+
+    if (ls_pjncAtChain != NULL)
+        jf_network_stopChain(ls_pjncAtChain);
+
+    ls_bToTerminateAt = TRUE;
+}
+
+static u32 _atServerOnConnect(
+    jf_network_assocket_t * pAssocket, jf_network_asocket_t * pAsocket, void ** ppUser)
+{
+    ls_u32AtServerConn ++;
+
+    return JF_ERR_NO_ERROR;
+}
+
+static u32 _atServerOnDisconnect(
+    jf_network_assocket_t * pAssocket, jf_network_asocket_t * pAsocket, u32 u32Status,
+    void * pUser)
+{
+    ls_u32AtServerDisconn ++;
+
+    return JF_ERR_NO_ERROR;
+}
+
+static u32 _atServerOnData(
+    jf_network_assocket_t * pAssocket, jf_network_asocket_t * pAsocket, u8 * pu8Buffer,
+    olsize_t * psBeginPointer, olsize_t sEndPointer, void * pUser)
+{
+    /*echo the data*/
+    jf_network_sendAssocketData(
+        pAssocket, pAsocket, pu8Buffer + *psBeginPointer, sEndPointer - *psBeginPointer);
+
+    *psBeginPointer = sEndPointer;
+
+    return JF_ERR_NO_ERROR;
+}
+
+static u32 _atClientOnConnect(
+    jf_network_acsocket_t * pAcsocket, jf_network_asocket_t * pAsocket, u32 u32Status,
+    void * pUser)
+{
+    ol_printf(
+        "client on connect, user %s, %s\n", (olchar_t *)pUser, jf_err_getDescription(u32Status));
+
+    ls_u32AtClientConnect ++;
+
+    return JF_ERR_NO_ERROR;
+}
+
+static u32 _atClientOnDisconnect(
+    jf_network_acsocket_t * pAcsocket, jf_network_asocket_t * pAsocket, u32 u32Status,
+    void * pUser)
+{
+    ol_printf("client on disconnect, user %s\n", (olchar_t *)pUser);
+
+    return JF_ERR_NO_ERROR;
+}
+
+static u32 _atClientOnData(
+    jf_network_acsocket_t * pAcsocket, jf_network_asocket_t * pAsocket, u8 * pu8Buffer,
+    olsize_t * psBeginPointer, olsize_t sEndPointer, void * pUser)
+{
+    ol_printf(
+        "client on data, user %s, %.*s\n", (olchar_t *)pUser, sEndPointer - *psBeginPointer,
+        pu8Buffer + *psBeginPointer);
+
+    ls_u32AtClientData ++;
+    *psBeginPointer = sEndPointer;
+
+    return JF_ERR_NO_ERROR;
+}
+
+static u32 _atClientOnHealthCheck(
+    jf_network_acsocket_t * pAcsocket, jf_network_asocket_t * pAsocket, void * pUser)
+{
+    ls_u32AtHealthCheck ++;
+
+    return JF_ERR_NO_ERROR;
+}
+
+JF_THREAD_RETURN_VALUE _atChainThread(void * pArg)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_network_assocket_create_param_t jnascp;
+    jf_network_acsocket_create_param_t jnacp;
+
+    ol_printf("acsocket chain starts\n");
+
+    u32Ret = jf_network_createChain(&ls_pjncAtChain);
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ol_bzero(&jnascp, sizeof(jnascp));
+        jnascp.jnacp_sInitialBuf = ACSOCKET_TEST_BUF_SIZE;
+        jnascp.jnacp_u32MaxConn = ACSOCKET_TEST_MAX_CONN;
+        jf_ipaddr_getIpAddrFromString("127.0.0.1", JF_IPADDR_TYPE_V4, &jnascp.jnacp_jiServer);
+        jnascp.jnacp_u16ServerPort = ACSOCKET_TEST_SERVER_PORT;
+        jnascp.jnacp_u8SocketProfile = JF_NETWORK_SOCKET_PROFILE_BULK;
+        jnascp.jnacp_fnOnConnect = _atServerOnConnect;
+        jnascp.jnacp_fnOnDisconnect = _atServerOnDisconnect;
+        jnascp.jnacp_fnOnData = _atServerOnData;
+        jnascp.jnacp_pstrName = "acsocket-test-server";
+
+        u32Ret = jf_network_createAssocket(ls_pjncAtChain, &ls_pjnaAtServer, &jnascp);
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ol_bzero(&jnacp, sizeof(jnacp));
+        jnacp.jnacp_sInitialBuf = ACSOCKET_TEST_BUF_SIZE;
+        jnacp.jnacp_u32MaxConn = ACSOCKET_TEST_MAX_CONN;
+        jnacp.jnacp_u16MaxConnPerEndpoint = 3;
+        jnacp.jnacp_u16MaxRequestPerConn = 2;
+        jnacp.jnacp_u16IdleTimeout = ACSOCKET_TEST_IDLE_TIMEOUT;
+        jnacp.jnacp_u16HealthCheckInterval = 1;
+        jnacp.jnacp_u8SocketProfile = JF_NETWORK_SOCKET_PROFILE_LOW_LATENCY;
+        jnacp.jnacp_fnOnConnect = _atClientOnConnect;
+        jnacp.jnacp_fnOnDisconnect = _atClientOnDisconnect;
+        jnacp.jnacp_fnOnData = _atClientOnData;
+        jnacp.jnacp_fnOnHealthCheck = _atClientOnHealthCheck;
+        jnacp.jnacp_pstrName = "acsocket-test-client";
+
+        u32Ret = jf_network_createAcsocket(ls_pjncAtChain, &ls_pjnaAtClient, &jnacp);
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        u32Ret = jf_network_startChain(ls_pjncAtChain);
+    }
+
+    if (ls_pjnaAtClient != NULL)
+        jf_network_destroyAcsocket(&ls_pjnaAtClient);
+
+    if (ls_pjnaAtServer != NULL)
+        jf_network_destroyAssocket(&ls_pjnaAtServer);
+
+    if (ls_pjncAtChain != NULL)
+        jf_network_destroyChain(&ls_pjncAtChain);
+
+    JF_THREAD_RETURN(u32Ret);
+}
+
+static u32 _acquireAtConnection(
+    jf_ipaddr_t * pjiServer, olchar_t * pstrUser, jf_network_asocket_t ** ppAsocket)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+
+    u32Ret = jf_network_acquireAcsocketConnection(
+        ls_pjnaAtClient, pjiServer, ACSOCKET_TEST_SERVER_PORT, pstrUser, ppAsocket);
+
+    if (u32Ret != JF_ERR_NO_ERROR)
+        ol_printf("acquire conn for %s, failed, 0x%x\n", pstrUser, u32Ret);
+    else
+        ol_printf(
+            "acquire conn for %s, %s\n", pstrUser, (*ppAsocket != NULL) ? "reused" : "connecting");
+
+    return u32Ret;
+}
+
+static u32 _testAcsocket(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_ipaddr_t jiServer;
+    jf_network_asocket_t * pjnaConn[5], * pjnaAsocket = NULL;
+    olchar_t * pstrUser[] = {"user-1", "user-2", "user-3", "user-4", "user-5"};
+    u32 u32Index = 0;
+
+    ol_bzero(pjnaConn, sizeof(pjnaConn));
+    jf_ipaddr_getIpAddrFromString("127.0.0.1", JF_IPADDR_TYPE_V4, &jiServer);
+
+    ol_printf("----- pre-warm 2 connections -----\n");
+    u32Ret = jf_network_prewarmAcsocket(
+        ls_pjnaAtClient, &jiServer, ACSOCKET_TEST_SERVER_PORT, 2);
+    jf_time_sleep(1);
+    ol_printf("server connections: %u, client connect event: %u\n",
+              ls_u32AtServerConn, ls_u32AtClientConnect);
+
+    ol_printf("----- acquire connections -----\n");
+    /*2 pre-warmed connections are reused, 1 new connection, 2 shared connections*/
+    for (u32Index = 0; (u32Ret == JF_ERR_NO_ERROR) && (u32Index < 5); u32Index ++)
+        u32Ret = _acquireAtConnection(&jiServer, pstrUser[u32Index], &pjnaConn[u32Index]);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        /*no connection is available*/
+        u32Ret = _acquireAtConnection(&jiServer, "user-6", &pjnaAsocket);
+        if (u32Ret == JF_ERR_SOCKET_POOL_EMPTY)
+            u32Ret = JF_ERR_NO_ERROR;
+        else
+            u32Ret = JF_ERR_PROGRAM_ERROR;
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        jf_time_sleep(1);
+        ol_printf("server connections: %u, client connect event: %u\n",
+                  ls_u32AtServerConn, ls_u32AtClientConnect);
+
+        for (u32Index = 0; u32Index < 2; u32Index ++)
+            jf_network_sendAcsocketData(
+                ls_pjnaAtClient, pjnaConn[u32Index], (u8 *)"hello", 5);
+        /*multi-part message, the parts are corked and sent together*/
+        jf_network_sendAcsocketData(ls_pjnaAtClient, pjnaConn[0], (u8 *)"header:", 7);
+        jf_network_sendAcsocketData(ls_pjnaAtClient, pjnaConn[0], (u8 *)"body", 4);
+        jf_time_sleep(1);
+        ol_printf("client data event: %u\n", ls_u32AtClientData);
+    }
+
+    ol_printf("----- release connections -----\n");
+    for (u32Index = 0; (u32Ret == JF_ERR_NO_ERROR) && (u32Index < 5); u32Index ++)
+        if (pjnaConn[u32Index] != NULL)
+            jf_network_releaseAcsocketConnection(ls_pjnaAtClient, pjnaConn[u32Index]);
+
+    ol_printf("----- wait for idle timeout -----\n");
+    jf_time_sleep(ACSOCKET_TEST_IDLE_TIMEOUT + 2);
+    ol_printf("server disconnections: %u, health check: %u\n",
+              ls_u32AtServerDisconn, ls_u32AtHealthCheck);
+
+    return u32Ret;
+}
+
+/* --- public routine section ------------------------------------------------------------------- */
+
+olint_t main(olint_t argc, olchar_t ** argv)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    olchar_t strErrMsg[300];
+    jf_logger_init_param_t jlipParam;
+    jf_thread_id_t chainthreadid;
+    u32 u32RetCode = 0;
+    jf_jiukun_init_param_t jjip;
+
+    ol_bzero(&jlipParam, sizeof(jlipParam));
+    jlipParam.jlip_pstrCallerName = ACSOCKET_TEST;
+    jlipParam.jlip_bLogToStdout = TRUE;
+    jlipParam.jlip_u8TraceLevel = JF_LOGGER_TRACE_LEVEL_ERROR;
+
+    ol_bzero(&jjip, sizeof(jjip));
+    jjip.jjip_sPool = JF_JIUKUN_MAX_POOL_SIZE;
+
+    u32Ret = _parseAcsocketTestCmdLineParam(argc, argv, &jlipParam);
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        jf_logger_init(&jlipParam);
+
+        u32Ret = jf_jiukun_init(&jjip);
+        if (u32Ret == JF_ERR_NO_ERROR)
+        {
+            u32Ret = jf_process_initSocket();
+            if (u32Ret == JF_ERR_NO_ERROR)
+            {
+                u32Ret = jf_process_registerSignalHandlers(_terminate);
+                if (u32Ret == JF_ERR_NO_ERROR)
+                    u32Ret = jf_thread_create(&chainthreadid, NULL, _atChainThread, NULL);
+
+                if (u32Ret == JF_ERR_NO_ERROR)
+                {
+                    jf_time_sleep(1);
+
+                    u32Ret = _testAcsocket();
+
+                    if (ls_pjncAtChain != NULL)
+                        jf_network_stopChain(ls_pjncAtChain);
+                    ls_bToTerminateAt = TRUE;
+
+                    jf_thread_waitForThreadTermination(chainthreadid, &u32RetCode);
+                }
+
+                jf_process_finiSocket();
+            }
+
+            jf_jiukun_fini();
+        }
+
+        jf_logger_fini();
+    }
+
+    if (u32Ret != JF_ERR_NO_ERROR)
+    {
+        jf_err_getMsg(u32Ret, strErrMsg, 300);
+        ol_printf("%s\n", strErrMsg);
+    }
+
+    return u32Ret;
+}
+
+/*------------------------------------------------------------------------------------------------*/
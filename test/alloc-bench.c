@@ -0,0 +1,839 @@
+/**
+ *  @file alloc-bench.c
+ *
+ *  @brief Benchmark for comparing jiukun with system malloc.
+ *
+ *  @author Min Zhang
+ *
+ *  @note
+ *  -# Three allocators are supported: jiukun memory from jf_jiukun_allocMemory(), jiukun cache and
+ *   system malloc. Only one allocator is benchmarked in one run, so the peak RSS is the memory used
+ *   by the allocator.
+ *  -# Three workloads are supported. In the short lived workload, each thread allocates a burst of
+ *   memory and frees them. In the long lived workload, each thread keeps a working set of memory
+ *   and replaces one randomly picked memory per operation. In the producer/consumer workload, the
+ *   threads are paired, the producer allocates memory and passes them to the consumer which frees
+ *   them, it's the pattern of message passing in dispatcher.
+ *  -# The sizes are from the size distribution of dispatcher messages, http parser or a fixed
+ *   size. The jiukun cache always uses the fixed size.
+ *  -# The latency of every ALLOC_BENCH_LATENCY_SAMPLE operations is measured, the percentile is
+ *   calculated from all threads.
+ *
+ */
+
+/* --- standard C lib header files -------------------------------------------------------------- */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include <sched.h>
+#include <sys/resource.h>
+
+/* --- internal header files -------------------------------------------------------------------- */
+#include "jf_basic.h"
+#include "jf_limit.h"
+#include "jf_err.h"
+#include "jf_jiukun.h"
+#include "jf_option.h"
+#include "jf_thread.h"
+#include "jf_mutex.h"
+#include "jf_time.h"
+
+/* --- private data/data structure section ------------------------------------------------------ */
+
+#define ALLOC_BENCH                        "ALLOC-BENCH"
+
+#define ALLOC_BENCH_DEFAULT_OPERATION      (1000000)
+
+#define ALLOC_BENCH_DEFAULT_THREAD         (4)
+
+#define ALLOC_BENCH_MAX_THREAD             (64)
+
+#define ALLOC_BENCH_DEFAULT_OBJECT_SIZE    (64)
+
+#define ALLOC_BENCH_CACHE                  "alloc-bench-object"
+
+/** Number of memory allocated before they are freed in short lived workload, it's also the number
+ *  of memory passed to consumer in one batch in producer/consumer workload.
+ */
+#define ALLOC_BENCH_BURST                  (32)
+
+/** Number of memory kept by each thread in long lived workload.
+ */
+#define ALLOC_BENCH_WORKING_SET            (4096)
+
+/** Size of the queue between producer and consumer.
+ */
+#define ALLOC_BENCH_QUEUE_SIZE             (1024)
+
+/** Measure the latency of one operation per the number of operations.
+ */
+#define ALLOC_BENCH_LATENCY_SAMPLE         (8)
+
+/** Bytes touched after allocation.
+ */
+#define ALLOC_BENCH_TOUCH_SIZE             (64)
+
+typedef enum
+{
+    ALLOC_BENCH_ALLOCATOR_JIUKUN = 0,
+    ALLOC_BENCH_ALLOCATOR_CACHE,
+    ALLOC_BENCH_ALLOCATOR_MALLOC,
+} alloc_bench_allocator_t;
+
+typedef enum
+{
+    ALLOC_BENCH_WORKLOAD_SHORT = 0,
+    ALLOC_BENCH_WORKLOAD_LONG,
+    ALLOC_BENCH_WORKLOAD_PRODUCER_CONSUMER,
+} alloc_bench_workload_t;
+
+/** Size distribution.
+ */
+typedef struct
+{
+    /**Description of the memory.*/
+    olchar_t * abm_pstrName;
+    /**Minimum size of the memory.*/
+    u32 abm_u32MinSize;
+    /**Maximum size of the memory.*/
+    u32 abm_u32MaxSize;
+    /**Percentage of the memory in the mix.*/
+    u32 abm_u32Percent;
+} alloc_bench_mix_t;
+
+/** Queue between producer and consumer.
+ */
+typedef struct
+{
+    jf_mutex_t abq_jmLock;
+    /**Index of the first memory in queue.*/
+    u32 abq_u32Head;
+    /**Number of memory in queue.*/
+    u32 abq_u32Count;
+    /**The producer has finished.*/
+    boolean_t abq_bDone;
+    u8 abq_u8Reserved[7];
+    void * abq_pMem[ALLOC_BENCH_QUEUE_SIZE];
+} alloc_bench_queue_t;
+
+/** Benchmark thread.
+ */
+typedef struct
+{
+    jf_thread_id_t abt_jtiThread;
+    u32 abt_u32Index;
+    u32 abt_u32Ret;
+    /**Seed of the PRNG.*/
+    u32 abt_u32Seed;
+    /**Number of latency measured.*/
+    u32 abt_u32NumOfLatency;
+    /**Number of allocation and free.*/
+    u64 abt_u64Op;
+    /**Latency in nanosecond.*/
+    u64 * abt_pu64Latency;
+    /**The queue for producer and consumer, NULL for other workloads.*/
+    alloc_bench_queue_t * abt_pabqQueue;
+} alloc_bench_thread_t;
+
+static alloc_bench_mix_t ls_abmDispatcherMix[] =
+{
+    /*Queue node and message header.*/
+    {"header", 24, 64, 40},
+    /*Control message, service status, request and response.*/
+    {"control", 65, 512, 30},
+    /*Message with payload, most of them are around the page size.*/
+    {"payload", 513, 4200, 25},
+    /*Bulk message up to the maximum message size of messaging.*/
+    {"bulk", 4201, 128 * 1024, 5},
+};
+
+static alloc_bench_mix_t ls_abmHttpMix[] =
+{
+    /*Header field name and value.*/
+    {"field", 8, 64, 55},
+    /*Packet header and field node.*/
+    {"header", 65, 512, 25},
+    /*Body chunk.*/
+    {"body", 513, 16 * 1024, 20},
+};
+
+static alloc_bench_mix_t ls_abmFixedMix[] =
+{
+    {"fixed", ALLOC_BENCH_DEFAULT_OBJECT_SIZE, ALLOC_BENCH_DEFAULT_OBJECT_SIZE, 100},
+};
+
+static olchar_t * ls_pstrAllocator[] =
+{
+    "jiukun",
+    "cache",
+    "malloc",
+};
+
+static olchar_t * ls_pstrWorkload[] =
+{
+    "short",
+    "long",
+    "pc",
+};
+
+static u8 ls_u8Allocator = ALLOC_BENCH_ALLOCATOR_JIUKUN;
+
+static u8 ls_u8Workload = ALLOC_BENCH_WORKLOAD_SHORT;
+
+static alloc_bench_mix_t * ls_pabmMix = ls_abmDispatcherMix;
+
+static olchar_t * ls_pstrMix = "dispatcher";
+
+static u32 ls_u32NumOfOperation = ALLOC_BENCH_DEFAULT_OPERATION;
+
+static u32 ls_u32NumOfThread = ALLOC_BENCH_DEFAULT_THREAD;
+
+static jf_jiukun_cache_t * ls_pjjcObject = NULL;
+
+static alloc_bench_thread_t ls_abtThread[ALLOC_BENCH_MAX_THREAD];
+
+/* --- private routine section ------------------------------------------------------------------ */
+
+static void _printAllocBenchUsage(void)
+{
+    ol_printf("\
+Usage: alloc-bench [-a jiukun|cache|malloc] [-w short|long|pc] [-s dispatcher|http|fixed]\n\
+    [-z size] [-n operations] [-t threads] [-h] [logger options] \n\
+    -a the allocator, jiukun by default.\n\
+    -w the workload, short lived, long lived or producer/consumer, short by default.\n\
+    -s the size distribution, dispatcher by default, the cache uses fixed size.\n\
+    -z the fixed size, %u by default.\n\
+    -n number of allocations per thread, or per producer, %u by default.\n\
+    -t number of threads, %u by default, it's rounded up to even for producer/consumer.\n\
+    -h print the usage.\n\
+logger options:\n\
+    -T <0|1|2|3|4> the log level. 0: no log, 1: error, 2: info, 3: debug, 4: data.\n\
+    -F <log file> the log file.\n\
+    -S <log file size> the size of log file. No limit if not specified.\n\
+    ", ALLOC_BENCH_DEFAULT_OBJECT_SIZE, ALLOC_BENCH_DEFAULT_OPERATION, ALLOC_BENCH_DEFAULT_THREAD);
+
+    ol_printf("\n");
+
+    exit(0);
+}
+
+static u32 _getAllocBenchIndex(olchar_t * pstr, olchar_t ** ppstrName, u32 u32Num, u8 * pu8Index)
+{
+    u32 u32Ret = JF_ERR_INVALID_PARAM;
+    u32 u32Index;
+
+    for (u32Index = 0; u32Index < u32Num; u32Index ++)
+    {
+        if (ol_strcmp(pstr, ppstrName[u32Index]) == 0)
+        {
+            *pu8Index = (u8)u32Index;
+            u32Ret = JF_ERR_NO_ERROR;
+            break;
+        }
+    }
+
+    return u32Ret;
+}
+
+static u32 _parseAllocBenchCmdLineParam(
+    olint_t argc, olchar_t ** argv, jf_logger_init_param_t * pjlip)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    olint_t nOpt;
+    u32 u32Size;
+
+    while (((nOpt = getopt(argc, argv, "a:w:s:z:n:t:T:F:S:h")) != -1) &&
+           (u32Ret == JF_ERR_NO_ERROR))
+    {
+        switch (nOpt)
+        {
+        case '?':
+        case 'h':
+            _printAllocBenchUsage();
+            break;
+        case ':':
+            u32Ret = JF_ERR_MISSING_PARAM;
+            break;
+        case 'a':
+            u32Ret = _getAllocBenchIndex(
+                optarg, ls_pstrAllocator, JF_BASIC_ARRAY_SIZE(ls_pstrAllocator), &ls_u8Allocator);
+            break;
+        case 'w':
+            u32Ret = _getAllocBenchIndex(
+                optarg, ls_pstrWorkload, JF_BASIC_ARRAY_SIZE(ls_pstrWorkload), &ls_u8Workload);
+            break;
+        case 's':
+            ls_pstrMix = optarg;
+            if (ol_strcmp(optarg, "dispatcher") == 0)
+                ls_pabmMix = ls_abmDispatcherMix;
+            else if (ol_strcmp(optarg, "http") == 0)
+                ls_pabmMix = ls_abmHttpMix;
+            else if (ol_strcmp(optarg, "fixed") == 0)
+                ls_pabmMix = ls_abmFixedMix;
+            else
+                u32Ret = JF_ERR_INVALID_PARAM;
+            break;
+        case 'z':
+            u32Ret = jf_option_getU32FromString(optarg, &u32Size);
+            if ((u32Ret == JF_ERR_NO_ERROR) &&
+                ((u32Size == 0) || (u32Size > JF_JIUKUN_MAX_MEMORY_SIZE)))
+                u32Ret = JF_ERR_INVALID_PARAM;
+            if (u32Ret == JF_ERR_NO_ERROR)
+            {
+                ls_abmFixedMix[0].abm_u32MinSize = u32Size;
+                ls_abmFixedMix[0].abm_u32MaxSize = u32Size;
+            }
+            break;
+        case 'n':
+            u32Ret = jf_option_getU32FromString(optarg, &ls_u32NumOfOperation);
+            if ((u32Ret == JF_ERR_NO_ERROR) && (ls_u32NumOfOperation == 0))
+                u32Ret = JF_ERR_INVALID_PARAM;
+            break;
+        case 't':
+            u32Ret = jf_option_getU32FromString(optarg, &ls_u32NumOfThread);
+            if ((u32Ret == JF_ERR_NO_ERROR) &&
+                ((ls_u32NumOfThread == 0) || (ls_u32NumOfThread > ALLOC_BENCH_MAX_THREAD)))
+                u32Ret = JF_ERR_INVALID_PARAM;
+            break;
+        case 'T':
+            u32Ret = jf_option_getU8FromString(optarg, &pjlip->jlip_u8TraceLevel);
+            break;
+        case 'F':
+            pjlip->jlip_bLogToFile = TRUE;
+            pjlip->jlip_pstrLogFilePath = optarg;
+            break;
+        case 'S':
+            u32Ret = jf_option_getS32FromString(optarg, &pjlip->jlip_sLogFile);
+            break;
+        default:
+            u32Ret = JF_ERR_INVALID_OPTION;
+            break;
+        }
+    }
+
+    return u32Ret;
+}
+
+/** Xorshift PRNG, each thread has its own seed.
+ */
+static u32 _getAllocBenchRand(alloc_bench_thread_t * pabt)
+{
+    pabt->abt_u32Seed ^= pabt->abt_u32Seed << 13;
+    pabt->abt_u32Seed ^= pabt->abt_u32Seed >> 17;
+    pabt->abt_u32Seed ^= pabt->abt_u32Seed << 5;
+
+    return pabt->abt_u32Seed;
+}
+
+static u32 _getAllocBenchSize(alloc_bench_thread_t * pabt)
+{
+    u32 u32Percent = _getAllocBenchRand(pabt) % 100;
+    alloc_bench_mix_t * pabm = ls_pabmMix;
+
+    while (u32Percent >= pabm->abm_u32Percent)
+    {
+        u32Percent -= pabm->abm_u32Percent;
+        pabm ++;
+    }
+
+    return pabm->abm_u32MinSize +
+        _getAllocBenchRand(pabt) % (pabm->abm_u32MaxSize - pabm->abm_u32MinSize + 1);
+}
+
+static u64 _getAllocBenchTime(void)
+{
+    struct timespec ts;
+
+    jf_time_getClockTime(CLOCK_MONOTONIC, &ts);
+
+    return (u64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static u32 _allocAllocBenchMemory(void ** pptr, u32 u32Size)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+
+    switch (ls_u8Allocator)
+    {
+    case ALLOC_BENCH_ALLOCATOR_JIUKUN:
+        u32Ret = jf_jiukun_allocMemory(pptr, u32Size);
+        break;
+    case ALLOC_BENCH_ALLOCATOR_CACHE:
+        u32Ret = jf_jiukun_allocObject(ls_pjjcObject, pptr);
+        break;
+    default:
+        *pptr = malloc(u32Size);
+        if (*pptr == NULL)
+            u32Ret = JF_ERR_OUT_OF_MEMORY;
+        break;
+    }
+
+    /*Touch the memory like the caller initializing the header.*/
+    if (u32Ret == JF_ERR_NO_ERROR)
+        ol_memset(*pptr, 0, u32Size < ALLOC_BENCH_TOUCH_SIZE ? u32Size : ALLOC_BENCH_TOUCH_SIZE);
+
+    return u32Ret;
+}
+
+static void _freeAllocBenchMemory(void ** pptr)
+{
+    switch (ls_u8Allocator)
+    {
+    case ALLOC_BENCH_ALLOCATOR_JIUKUN:
+        jf_jiukun_freeMemory(pptr);
+        break;
+    case ALLOC_BENCH_ALLOCATOR_CACHE:
+        jf_jiukun_freeObject(ls_pjjcObject, pptr);
+        break;
+    default:
+        free(*pptr);
+        *pptr = NULL;
+        break;
+    }
+}
+
+/** Allocate memory, the latency is recorded if the operation is sampled.
+ */
+static u32 _allocAllocBenchMemoryTimed(alloc_bench_thread_t * pabt, void ** pptr)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Size = _getAllocBenchSize(pabt);
+    u64 u64Start;
+
+    if ((pabt->abt_u64Op % ALLOC_BENCH_LATENCY_SAMPLE) == 0)
+    {
+        u64Start = _getAllocBenchTime();
+        u32Ret = _allocAllocBenchMemory(pptr, u32Size);
+        pabt->abt_pu64Latency[pabt->abt_u32NumOfLatency ++] = _getAllocBenchTime() - u64Start;
+    }
+    else
+    {
+        u32Ret = _allocAllocBenchMemory(pptr, u32Size);
+    }
+
+    pabt->abt_u64Op ++;
+
+    return u32Ret;
+}
+
+/** Free memory, the latency is recorded if the operation is sampled.
+ */
+static void _freeAllocBenchMemoryTimed(alloc_bench_thread_t * pabt, void ** pptr)
+{
+    u64 u64Start;
+
+    if ((pabt->abt_u64Op % ALLOC_BENCH_LATENCY_SAMPLE) == 0)
+    {
+        u64Start = _getAllocBenchTime();
+        _freeAllocBenchMemory(pptr);
+        pabt->abt_pu64Latency[pabt->abt_u32NumOfLatency ++] = _getAllocBenchTime() - u64Start;
+    }
+    else
+    {
+        _freeAllocBenchMemory(pptr);
+    }
+
+    pabt->abt_u64Op ++;
+}
+
+static u32 _benchAllocShortLived(alloc_bench_thread_t * pabt)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    void * pMem[ALLOC_BENCH_BURST];
+    u32 u32Op = 0, u32Index;
+
+    while ((u32Op < ls_u32NumOfOperation) && (u32Ret == JF_ERR_NO_ERROR))
+    {
+        for (u32Index = 0; (u32Index < ALLOC_BENCH_BURST) && (u32Ret == JF_ERR_NO_ERROR);
+             u32Index ++)
+        {
+            u32Ret = _allocAllocBenchMemoryTimed(pabt, &pMem[u32Index]);
+        }
+
+        u32Op += u32Index;
+
+        /*The memory is freed in the reverse order, like the request-scoped objects.*/
+        while (u32Index > 0)
+        {
+            u32Index --;
+            if (pMem[u32Index] != NULL)
+                _freeAllocBenchMemoryTimed(pabt, &pMem[u32Index]);
+        }
+    }
+
+    return u32Ret;
+}
+
+static u32 _benchAllocLongLived(alloc_bench_thread_t * pabt)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    void ** ppMem = NULL;
+    u32 u32Op, u32Index;
+
+    ppMem = malloc(ALLOC_BENCH_WORKING_SET * sizeof(void *));
+    if (ppMem == NULL)
+        return JF_ERR_OUT_OF_MEMORY;
+    ol_bzero(ppMem, ALLOC_BENCH_WORKING_SET * sizeof(void *));
+
+    /*Fill the working set.*/
+    for (u32Index = 0; (u32Index < ALLOC_BENCH_WORKING_SET) && (u32Ret == JF_ERR_NO_ERROR);
+         u32Index ++)
+        u32Ret = _allocAllocBenchMemory(&ppMem[u32Index], _getAllocBenchSize(pabt));
+
+    /*Replace the memory randomly, the memory lives for a random time.*/
+    for (u32Op = 0; (u32Op < ls_u32NumOfOperation) && (u32Ret == JF_ERR_NO_ERROR); u32Op ++)
+    {
+        u32Index = _getAllocBenchRand(pabt) % ALLOC_BENCH_WORKING_SET;
+
+        _freeAllocBenchMemoryTimed(pabt, &ppMem[u32Index]);
+        u32Ret = _allocAllocBenchMemoryTimed(pabt, &ppMem[u32Index]);
+    }
+
+    for (u32Index = 0; u32Index < ALLOC_BENCH_WORKING_SET; u32Index ++)
+    {
+        if (ppMem[u32Index] != NULL)
+            _freeAllocBenchMemory(&ppMem[u32Index]);
+    }
+
+    free(ppMem);
+
+    return u32Ret;
+}
+
+static u32 _benchAllocProducer(alloc_bench_thread_t * pabt)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    alloc_bench_queue_t * pabq = pabt->abt_pabqQueue;
+    void * pMem[ALLOC_BENCH_BURST];
+    u32 u32Op = 0, u32Index, u32Num;
+    boolean_t bPushed;
+
+    while ((u32Op < ls_u32NumOfOperation) && (u32Ret == JF_ERR_NO_ERROR))
+    {
+        for (u32Num = 0; (u32Num < ALLOC_BENCH_BURST) && (u32Ret == JF_ERR_NO_ERROR); u32Num ++)
+        {
+            u32Ret = _allocAllocBenchMemoryTimed(pabt, &pMem[u32Num]);
+            if (u32Ret != JF_ERR_NO_ERROR)
+                break;
+        }
+
+        u32Op += u32Num;
+
+        /*Pass the batch to consumer, wait if the queue is full.*/
+        bPushed = (u32Num == 0);
+        while (! bPushed)
+        {
+            jf_mutex_acquire(&pabq->abq_jmLock);
+            if (pabq->abq_u32Count + u32Num <= ALLOC_BENCH_QUEUE_SIZE)
+            {
+                for (u32Index = 0; u32Index < u32Num; u32Index ++)
+                    pabq->abq_pMem[(pabq->abq_u32Head + pabq->abq_u32Count + u32Index) %
+                                   ALLOC_BENCH_QUEUE_SIZE] = pMem[u32Index];
+                pabq->abq_u32Count += u32Num;
+                bPushed = TRUE;
+            }
+            jf_mutex_release(&pabq->abq_jmLock);
+
+            if (! bPushed)
+                sched_yield();
+        }
+    }
+
+    jf_mutex_acquire(&pabq->abq_jmLock);
+    pabq->abq_bDone = TRUE;
+    jf_mutex_release(&pabq->abq_jmLock);
+
+    return u32Ret;
+}
+
+static u32 _benchAllocConsumer(alloc_bench_thread_t * pabt)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    alloc_bench_queue_t * pabq = pabt->abt_pabqQueue;
+    void * pMem[ALLOC_BENCH_BURST];
+    u32 u32Index, u32Num;
+    boolean_t bDone = FALSE;
+
+    while (! bDone)
+    {
+        jf_mutex_acquire(&pabq->abq_jmLock);
+        u32Num = pabq->abq_u32Count < ALLOC_BENCH_BURST ? pabq->abq_u32Count : ALLOC_BENCH_BURST;
+        for (u32Index = 0; u32Index < u32Num; u32Index ++)
+        {
+            pMem[u32Index] = pabq->abq_pMem[pabq->abq_u32Head];
+            pabq->abq_u32Head = (pabq->abq_u32Head + 1) % ALLOC_BENCH_QUEUE_SIZE;
+        }
+        pabq->abq_u32Count -= u32Num;
+        bDone = pabq->abq_bDone && (pabq->abq_u32Count == 0);
+        jf_mutex_release(&pabq->abq_jmLock);
+
+        /*The memory allocated by producer is freed in the consumer thread.*/
+        for (u32Index = 0; u32Index < u32Num; u32Index ++)
+            _freeAllocBenchMemoryTimed(pabt, &pMem[u32Index]);
+
+        if ((u32Num == 0) && (! bDone))
+            sched_yield();
+    }
+
+    return u32Ret;
+}
+
+static JF_THREAD_RETURN_VALUE _benchAllocThread(void * pArg)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    alloc_bench_thread_t * pabt = pArg;
+
+    if (ls_u8Workload == ALLOC_BENCH_WORKLOAD_SHORT)
+        u32Ret = _benchAllocShortLived(pabt);
+    else if (ls_u8Workload == ALLOC_BENCH_WORKLOAD_LONG)
+        u32Ret = _benchAllocLongLived(pabt);
+    else if ((pabt->abt_u32Index % 2) == 0)
+        u32Ret = _benchAllocProducer(pabt);
+    else
+        u32Ret = _benchAllocConsumer(pabt);
+
+    pabt->abt_u32Ret = u32Ret;
+
+    JF_THREAD_RETURN(u32Ret);
+}
+
+static olint_t _compareAllocBenchLatency(const void * pa, const void * pb)
+{
+    u64 u64A = *(const u64 *)pa, u64B = *(const u64 *)pb;
+
+    return (u64A > u64B) - (u64A < u64B);
+}
+
+/** Get the peak resident set size of the process in kilo byte.
+ */
+static u64 _getAllocBenchPeakRss(void)
+{
+    struct rusage ru;
+
+    ol_bzero(&ru, sizeof(ru));
+    getrusage(RUSAGE_SELF, &ru);
+
+    return (u64)ru.ru_maxrss;
+}
+
+static void _printAllocBenchResult(u64 u64Op, u64 u64Time)
+{
+    u64 * pu64Latency = NULL;
+    u32 u32Index, u32Num = 0;
+
+    for (u32Index = 0; u32Index < ls_u32NumOfThread; u32Index ++)
+        u32Num += ls_abtThread[u32Index].abt_u32NumOfLatency;
+
+    ol_printf("allocator         : %s\n", ls_pstrAllocator[ls_u8Allocator]);
+    ol_printf("workload          : %s\n", ls_pstrWorkload[ls_u8Workload]);
+    ol_printf(
+        "size              : %s\n",
+        (ls_u8Allocator == ALLOC_BENCH_ALLOCATOR_CACHE) ? "fixed" : ls_pstrMix);
+    ol_printf("threads           : %u\n", ls_u32NumOfThread);
+    ol_printf("operations        : %llu\n", u64Op);
+    ol_printf("time              : %llu ms\n", u64Time / 1000000);
+    if (u64Time > 0)
+        ol_printf("throughput        : %llu ops/s\n", u64Op * 1000000000 / u64Time);
+
+    /*Merge the latency of all threads.*/
+    if (u32Num > 0)
+        pu64Latency = malloc(u32Num * sizeof(u64));
+
+    if (pu64Latency != NULL)
+    {
+        u32Num = 0;
+        for (u32Index = 0; u32Index < ls_u32NumOfThread; u32Index ++)
+        {
+            ol_memcpy(
+                &pu64Latency[u32Num], ls_abtThread[u32Index].abt_pu64Latency,
+                ls_abtThread[u32Index].abt_u32NumOfLatency * sizeof(u64));
+            u32Num += ls_abtThread[u32Index].abt_u32NumOfLatency;
+        }
+
+        qsort(pu64Latency, u32Num, sizeof(u64), _compareAllocBenchLatency);
+
+        ol_printf("latency p50       : %llu ns\n", pu64Latency[(u64)u32Num * 50 / 100]);
+        ol_printf("latency p99       : %llu ns\n", pu64Latency[(u64)u32Num * 99 / 100]);
+        ol_printf("latency p99.9     : %llu ns\n", pu64Latency[(u64)u32Num * 999 / 1000]);
+        ol_printf("latency max       : %llu ns\n", pu64Latency[u32Num - 1]);
+
+        free(pu64Latency);
+    }
+
+    ol_printf("peak rss          : %llu KB\n", _getAllocBenchPeakRss());
+}
+
+static void _freeAllocBenchThread(void)
+{
+    u32 u32Index;
+
+    for (u32Index = 0; u32Index < ls_u32NumOfThread; u32Index ++)
+    {
+        if (ls_abtThread[u32Index].abt_pu64Latency != NULL)
+            free(ls_abtThread[u32Index].abt_pu64Latency);
+
+        /*The queue is shared by the producer and the consumer, it's owned by the producer.*/
+        if (((u32Index % 2) == 0) && (ls_abtThread[u32Index].abt_pabqQueue != NULL))
+        {
+            jf_mutex_fini(&ls_abtThread[u32Index].abt_pabqQueue->abq_jmLock);
+            free(ls_abtThread[u32Index].abt_pabqQueue);
+        }
+    }
+}
+
+static u32 _initAllocBenchThread(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Index, u32NumOfLatency;
+    alloc_bench_thread_t * pabt = NULL;
+
+    /*Each memory is allocated and freed so there are 2 operations per allocation, the number of
+      allocation may exceed by a burst.*/
+    u32NumOfLatency =
+        (ls_u32NumOfOperation + ALLOC_BENCH_BURST) * 2 / ALLOC_BENCH_LATENCY_SAMPLE + 1;
+
+    for (u32Index = 0; (u32Index < ls_u32NumOfThread) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+    {
+        pabt = &ls_abtThread[u32Index];
+
+        pabt->abt_u32Index = u32Index;
+        pabt->abt_u32Seed = 0x414C4331 + u32Index * 0x9E3779B9;
+
+        pabt->abt_pu64Latency = malloc(u32NumOfLatency * sizeof(u64));
+        if (pabt->abt_pu64Latency == NULL)
+            u32Ret = JF_ERR_OUT_OF_MEMORY;
+
+        if ((u32Ret == JF_ERR_NO_ERROR) &&
+            (ls_u8Workload == ALLOC_BENCH_WORKLOAD_PRODUCER_CONSUMER))
+        {
+            if ((u32Index % 2) == 0)
+            {
+                pabt->abt_pabqQueue = malloc(sizeof(alloc_bench_queue_t));
+                if (pabt->abt_pabqQueue == NULL)
+                    u32Ret = JF_ERR_OUT_OF_MEMORY;
+
+                if (u32Ret == JF_ERR_NO_ERROR)
+                {
+                    ol_bzero(pabt->abt_pabqQueue, sizeof(alloc_bench_queue_t));
+                    u32Ret = jf_mutex_init(&pabt->abt_pabqQueue->abq_jmLock);
+                }
+            }
+            else
+            {
+                pabt->abt_pabqQueue = ls_abtThread[u32Index - 1].abt_pabqQueue;
+            }
+        }
+    }
+
+    return u32Ret;
+}
+
+static u32 _benchAlloc(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Index, u32RetCode, u32NumOfThread = 0;
+    u64 u64Start, u64Time, u64Op = 0;
+    jf_jiukun_cache_create_param_t jjccp;
+
+    ol_bzero(ls_abtThread, sizeof(ls_abtThread));
+
+    if (ls_u8Allocator == ALLOC_BENCH_ALLOCATOR_CACHE)
+    {
+        ls_pabmMix = ls_abmFixedMix;
+
+        ol_bzero(&jjccp, sizeof(jjccp));
+        jjccp.jjccp_pstrName = ALLOC_BENCH_CACHE;
+        jjccp.jjccp_sObj = ls_abmFixedMix[0].abm_u32MinSize;
+
+        u32Ret = jf_jiukun_createCache(&ls_pjjcObject, &jjccp);
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = _initAllocBenchThread();
+
+    u64Start = _getAllocBenchTime();
+
+    for (u32Index = 0; (u32Index < ls_u32NumOfThread) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+    {
+        u32Ret = jf_thread_create(
+            &ls_abtThread[u32Index].abt_jtiThread, NULL, _benchAllocThread,
+            &ls_abtThread[u32Index]);
+        if (u32Ret == JF_ERR_NO_ERROR)
+            u32NumOfThread ++;
+    }
+
+    for (u32Index = 0; u32Index < u32NumOfThread; u32Index ++)
+    {
+        jf_thread_waitForThreadTermination(ls_abtThread[u32Index].abt_jtiThread, &u32RetCode);
+        u64Op += ls_abtThread[u32Index].abt_u64Op;
+        if ((u32Ret == JF_ERR_NO_ERROR) && (ls_abtThread[u32Index].abt_u32Ret != JF_ERR_NO_ERROR))
+            u32Ret = ls_abtThread[u32Index].abt_u32Ret;
+    }
+
+    u64Time = _getAllocBenchTime() - u64Start;
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        _printAllocBenchResult(u64Op, u64Time);
+
+    _freeAllocBenchThread();
+
+    if (ls_pjjcObject != NULL)
+        jf_jiukun_destroyCache(&ls_pjjcObject);
+
+    return u32Ret;
+}
+
+/* --- public routine section ------------------------------------------------------------------- */
+
+olint_t main(olint_t argc, olchar_t ** argv)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    olchar_t strErrMsg[300];
+    jf_logger_init_param_t jlipParam;
+    jf_jiukun_init_param_t jjip;
+
+    ol_bzero(&jlipParam, sizeof(jlipParam));
+    jlipParam.jlip_pstrCallerName = ALLOC_BENCH;
+    jlipParam.jlip_bLogToStdout = TRUE;
+    jlipParam.jlip_u8TraceLevel = JF_LOGGER_TRACE_LEVEL_ERROR;
+
+    ol_bzero(&jjip, sizeof(jjip));
+    jjip.jjip_sPool = JF_JIUKUN_MAX_POOL_SIZE;
+
+    u32Ret = _parseAllocBenchCmdLineParam(argc, argv, &jlipParam);
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        jf_logger_init(&jlipParam);
+
+        /*The producer and the consumer are paired.*/
+        if ((ls_u8Workload == ALLOC_BENCH_WORKLOAD_PRODUCER_CONSUMER) &&
+            ((ls_u32NumOfThread % 2) != 0))
+            ls_u32NumOfThread ++;
+
+        /*Jiukun is not initialized for malloc, so the peak RSS doesn't include jiukun.*/
+        if (ls_u8Allocator != ALLOC_BENCH_ALLOCATOR_MALLOC)
+            u32Ret = jf_jiukun_init(&jjip);
+
+        if (u32Ret == JF_ERR_NO_ERROR)
+        {
+            u32Ret = _benchAlloc();
+
+            if (ls_u8Allocator != ALLOC_BENCH_ALLOCATOR_MALLOC)
+                jf_jiukun_fini();
+        }
+
+        jf_logger_fini();
+    }
+
+    if (u32Ret != JF_ERR_NO_ERROR)
+    {
+        jf_err_getMsg(u32Ret, strErrMsg, sizeof(strErrMsg));
+        ol_printf("%s\n", strErrMsg);
+    }
+
+    return u32Ret;
+}
+
+/*------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,320 @@
+/**
+ *  @file array-test.c
+ *
+ *  @brief Test file for array defined in jf_array object.
+ *
+ *  @author Min Zhang
+ *
+ *  @note
+ *  -# The array is checked against a plain C array after each operation.
+ *
+ */
+
+/* --- standard C lib header files -------------------------------------------------------------- */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+/* --- internal header files -------------------------------------------------------------------- */
+#include "jf_basic.h"
+#include "jf_limit.h"
+#include "jf_array.h"
+#include "jf_err.h"
+#include "jf_jiukun.h"
+#include "jf_option.h"
+
+/* --- private data/data structure section ------------------------------------------------------ */
+
+#define ARRAY_TEST_NUM_OF_ELEMENT       (1000)
+
+static boolean_t ls_bArray = FALSE;
+
+/** The expected elements in array.
+ */
+static jf_array_element_t * ls_pjaeArrayTestExpected[ARRAY_TEST_NUM_OF_ELEMENT * 2];
+
+static u32 ls_u32ArrayTestExpected = 0;
+
+/* --- private routine section ------------------------------------------------------------------ */
+
+static void _printArrayTestUsage(void)
+{
+    ol_printf("\
+Usage: array-test [-a] \n\
+    [-T <trace level>] [-F <trace log file>] [-S <trace file size>]\n\
+  -a test array.\n");
+
+    ol_printf("\n");
+}
+
+static u32 _parseArrayTestCmdLineParam(
+    olint_t argc, olchar_t ** argv, jf_logger_init_param_t * pjlip)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    olint_t nOpt;
+
+    while (((nOpt = getopt(argc, argv, "aT:F:S:h")) != -1) &&
+           (u32Ret == JF_ERR_NO_ERROR))
+    {
+        switch (nOpt)
+        {
+        case '?':
+        case 'h':
+            _printArrayTestUsage();
+            exit(0);
+            break;
+        case 'a':
+            ls_bArray = TRUE;
+            break;
+        case 'T':
+            u32Ret = jf_option_getU8FromString(optarg, &pjlip->jlip_u8TraceLevel);
+            break;
+        case 'F':
+            pjlip->jlip_bLogToFile = TRUE;
+            pjlip->jlip_pstrLogFilePath = optarg;
+            break;
+        case 'S':
+            u32Ret = jf_option_getS32FromString(optarg, &pjlip->jlip_sLogFile);
+            break;
+        default:
+            u32Ret = JF_ERR_INVALID_OPTION;
+            break;
+        }
+    }
+
+    return u32Ret;
+}
+
+static u32 _verifyArray(jf_array_t * pja, const olchar_t * pstrOp)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_array_element_t * pjae = NULL;
+    u32 u32Index;
+
+    if (jf_array_getSize(pja) != ls_u32ArrayTestExpected)
+    {
+        ol_printf(
+            "%s: size %u, expected %u\n", pstrOp, jf_array_getSize(pja), ls_u32ArrayTestExpected);
+        u32Ret = JF_ERR_INVALID_DATA;
+    }
+
+    for (u32Index = 0; (u32Index < ls_u32ArrayTestExpected) && (u32Ret == JF_ERR_NO_ERROR);
+         u32Index ++)
+    {
+        u32Ret = jf_array_getElementAt(pja, u32Index, &pjae);
+        if ((u32Ret == JF_ERR_NO_ERROR) && (pjae != ls_pjaeArrayTestExpected[u32Index]))
+        {
+            ol_printf(
+                "%s: element %u is %p, expected %p\n", pstrOp, u32Index, pjae,
+                ls_pjaeArrayTestExpected[u32Index]);
+            u32Ret = JF_ERR_INVALID_DATA;
+        }
+    }
+
+    if ((u32Ret == JF_ERR_NO_ERROR) &&
+        (jf_array_getElementAt(pja, ls_u32ArrayTestExpected, &pjae) != JF_ERR_OUT_OF_RANGE))
+    {
+        ol_printf("%s: element after the end is got\n", pstrOp);
+        u32Ret = JF_ERR_INVALID_DATA;
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        ol_printf(
+            "%s: %u elements, capacity %u\n", pstrOp, jf_array_getSize(pja),
+            jf_array_getCapacity(pja));
+
+    return u32Ret;
+}
+
+static boolean_t _findArrayTestElement(jf_array_element_t * pjae, void * pKey)
+{
+    return pjae == pKey;
+}
+
+static u32 _testArray(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_array_t * pja = NULL;
+    jf_array_element_t * pjae = NULL;
+    u32 u32Index;
+
+    u32Ret = jf_array_create(&pja);
+    if (u32Ret != JF_ERR_NO_ERROR)
+        return u32Ret;
+
+    /*Append.*/
+    for (u32Index = 0; (u32Index < ARRAY_TEST_NUM_OF_ELEMENT) && (u32Ret == JF_ERR_NO_ERROR);
+         u32Index ++)
+    {
+        ls_pjaeArrayTestExpected[u32Index] = (jf_array_element_t *)(ulong)(u32Index + 1);
+        u32Ret = jf_array_appendElementTo(pja, ls_pjaeArrayTestExpected[u32Index]);
+    }
+    ls_u32ArrayTestExpected = ARRAY_TEST_NUM_OF_ELEMENT;
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = _verifyArray(pja, "append");
+
+    /*Insert at the head, in the middle and out of range which is appended.*/
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        pjae = (jf_array_element_t *)(ulong)0x10001;
+        u32Ret = jf_array_insertElementAt(pja, 0, pjae);
+        ol_memmove(
+            &ls_pjaeArrayTestExpected[1], &ls_pjaeArrayTestExpected[0],
+            ls_u32ArrayTestExpected * sizeof(jf_array_element_t *));
+        ls_pjaeArrayTestExpected[0] = pjae;
+        ls_u32ArrayTestExpected ++;
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        pjae = (jf_array_element_t *)(ulong)0x10002;
+        u32Ret = jf_array_insertElementAt(pja, 500, pjae);
+        ol_memmove(
+            &ls_pjaeArrayTestExpected[501], &ls_pjaeArrayTestExpected[500],
+            (ls_u32ArrayTestExpected - 500) * sizeof(jf_array_element_t *));
+        ls_pjaeArrayTestExpected[500] = pjae;
+        ls_u32ArrayTestExpected ++;
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        pjae = (jf_array_element_t *)(ulong)0x10003;
+        u32Ret = jf_array_insertElementAt(pja, 100000, pjae);
+        ls_pjaeArrayTestExpected[ls_u32ArrayTestExpected ++] = pjae;
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = _verifyArray(pja, "insert");
+
+    /*Remove element, remove range and remove at position.*/
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = jf_array_removeElement(pja, ls_pjaeArrayTestExpected[300]);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = jf_array_removeElementsAt(pja, 100, 50);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = jf_array_removeElementAt(pja, 10);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ol_memmove(
+            &ls_pjaeArrayTestExpected[300], &ls_pjaeArrayTestExpected[301],
+            (ls_u32ArrayTestExpected - 301) * sizeof(jf_array_element_t *));
+        ls_u32ArrayTestExpected --;
+        ol_memmove(
+            &ls_pjaeArrayTestExpected[100], &ls_pjaeArrayTestExpected[150],
+            (ls_u32ArrayTestExpected - 150) * sizeof(jf_array_element_t *));
+        ls_u32ArrayTestExpected -= 50;
+        ol_memmove(
+            &ls_pjaeArrayTestExpected[10], &ls_pjaeArrayTestExpected[11],
+            (ls_u32ArrayTestExpected - 11) * sizeof(jf_array_element_t *));
+        ls_u32ArrayTestExpected --;
+
+        u32Ret = _verifyArray(pja, "remove");
+    }
+
+    if ((u32Ret == JF_ERR_NO_ERROR) &&
+        (jf_array_removeElementsAt(pja, ls_u32ArrayTestExpected - 1, 2) != JF_ERR_OUT_OF_RANGE))
+    {
+        ol_printf("remove: range out of the end is removed\n");
+        u32Ret = JF_ERR_INVALID_DATA;
+    }
+
+    /*Swap remove.*/
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = jf_array_swapRemoveElementAt(pja, 5);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ls_u32ArrayTestExpected --;
+        ls_pjaeArrayTestExpected[5] = ls_pjaeArrayTestExpected[ls_u32ArrayTestExpected];
+
+        u32Ret = _verifyArray(pja, "swap remove");
+    }
+
+    /*Bulk append and find.*/
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ol_memcpy(
+            &ls_pjaeArrayTestExpected[ls_u32ArrayTestExpected], &ls_pjaeArrayTestExpected[0],
+            500 * sizeof(jf_array_element_t *));
+
+        u32Ret = jf_array_appendElements(pja, &ls_pjaeArrayTestExpected[0], 500);
+        ls_u32ArrayTestExpected += 500;
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = _verifyArray(pja, "bulk append");
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        u32Ret = jf_array_findElementIndex(
+            pja, &u32Index, _findArrayTestElement, ls_pjaeArrayTestExpected[700]);
+        if ((u32Ret == JF_ERR_NO_ERROR) && (u32Index != 700))
+        {
+            ol_printf("find: element is found at %u, expected 700\n", u32Index);
+            u32Ret = JF_ERR_INVALID_DATA;
+        }
+    }
+
+    /*Remove all elements, the memory is kept.*/
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        jf_array_removeAllElements(pja);
+        ls_u32ArrayTestExpected = 0;
+
+        u32Ret = _verifyArray(pja, "remove all");
+    }
+
+    jf_array_destroy(&pja);
+
+    return u32Ret;
+}
+
+/* --- public routine section ------------------------------------------------------------------- */
+
+olint_t main(olint_t argc, olchar_t ** argv)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_logger_init_param_t jlipParam;
+    jf_jiukun_init_param_t jjip;
+
+    ol_bzero(&jlipParam, sizeof(jlipParam));
+    jlipParam.jlip_pstrCallerName = "ARRAY-TEST";
+    jlipParam.jlip_bLogToStdout = TRUE;
+    jlipParam.jlip_u8TraceLevel = 3;
+
+    ol_bzero(&jjip, sizeof(jjip));
+    jjip.jjip_sPool = JF_JIUKUN_MAX_POOL_SIZE;
+
+    u32Ret = _parseArrayTestCmdLineParam(argc, argv, &jlipParam);
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        jf_logger_init(&jlipParam);
+
+        u32Ret = jf_jiukun_init(&jjip);
+        if (u32Ret == JF_ERR_NO_ERROR)
+        {
+            if (ls_bArray)
+            {
+                u32Ret = _testArray();
+            }
+            else
+            {
+                ol_printf("No operation is specified !!!!\n\n");
+                _printArrayTestUsage();
+            }
+
+            jf_jiukun_fini();
+        }
+
+        jf_logger_logErrMsg(u32Ret, "Quit");
+        jf_logger_fini();
+    }
+
+    return u32Ret;
+}
+
+/*------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,779 @@
+/**
+ *  @file art-bench.c
+ *
+ *  @brief Benchmark for comparing the adaptive radix tree with the sorted linked list.
+ *
+ *  @author Min Zhang
+ *
+ *  @note
+ *  -# The baseline is the sorted jf_listhead list with string key, the keys are compared with
+ *   strcmp when walking the list.
+ *  -# The keys are path like strings sharing long prefixes. The benchmark inserts the keys in
+ *   random order, looks up all keys, iterates the keys with random prefixes and removes all keys.
+ *   The result is verified against the sorted array of keys.
+ *  -# The wide fan-out keys share a prefix followed by all 256 byte values, so a node grows to
+ *   node256 and shrinks back to node4 while the keys are inserted and removed. The tree is
+ *   verified against the sorted array of fan-out keys after each insertion and removal.
+ */
+
+/* --- standard C lib header files -------------------------------------------------------------- */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+
+/* --- internal header files -------------------------------------------------------------------- */
+#include "jf_basic.h"
+#include "jf_limit.h"
+#include "jf_err.h"
+#include "jf_jiukun.h"
+#include "jf_option.h"
+#include "jf_time.h"
+#include "jf_listhead.h"
+#include "jf_art.h"
+
+/* --- private data/data structure section ------------------------------------------------------ */
+
+#define ART_BENCH                               "ART-BENCH"
+
+#define ART_BENCH_DEFAULT_KEY                   (20000)
+
+#define ART_BENCH_DEFAULT_PREFIX                (2000)
+
+#define ART_BENCH_MAX_KEY_LEN                   (48)
+
+#define ART_BENCH_CACHE                         "art-bench-entry"
+
+#define ART_BENCH_FANOUT_PREFIX                 "/fan/"
+
+/** The prefix key and 2 keys for each non-zero byte, the prefix key has the byte 0 after the
+ *  prefix as the null terminator is part of the key.
+ */
+#define ART_BENCH_NUM_OF_FANOUT_KEY             (1 + 255 * 2)
+
+#define ART_BENCH_MAX_FANOUT_KEY_LEN            (16)
+
+typedef enum
+{
+    ART_BENCH_CONTAINER_LIST = 0,
+    ART_BENCH_CONTAINER_ART,
+} art_bench_container_t;
+
+/** The entry in sorted list.
+ */
+typedef struct
+{
+    jf_listhead_t abe_jlList;
+    olchar_t * abe_pstrKey;
+    void * abe_pValue;
+} art_bench_entry_t;
+
+/** The argument for prefix iteration.
+ */
+typedef struct
+{
+    /**Position of the next expected key in the sorted array.*/
+    u32 abp_u32Pos;
+    u32 abp_u32Count;
+} art_bench_prefix_t;
+
+static olchar_t * ls_pstrContainer[] =
+{
+    "list",
+    "art",
+};
+
+static u32 ls_u32NumOfKey = ART_BENCH_DEFAULT_KEY;
+
+static u32 ls_u32NumOfPrefix = ART_BENCH_DEFAULT_PREFIX;
+
+static jf_jiukun_cache_t * ls_pjjcEntry = NULL;
+
+/** The key buffer.
+ */
+static olchar_t * ls_pstrKeyBuf = NULL;
+
+/** The keys in insertion order.
+ */
+static olchar_t ** ls_ppstrKey = NULL;
+
+/** The keys in ascending order.
+ */
+static olchar_t ** ls_ppstrSortedKey = NULL;
+
+static JF_LISTHEAD(ls_jlList);
+
+static jf_art_t * ls_pjaTree = NULL;
+
+/** The fan-out keys.
+ */
+static olchar_t ls_strFanoutKey[ART_BENCH_NUM_OF_FANOUT_KEY][ART_BENCH_MAX_FANOUT_KEY_LEN];
+
+/** The fan-out keys in ascending order.
+ */
+static olchar_t * ls_pstrSortedFanoutKey[ART_BENCH_NUM_OF_FANOUT_KEY];
+
+/** The fan-out key in the sorted array is in the tree.
+ */
+static boolean_t ls_bFanoutKeyInTree[ART_BENCH_NUM_OF_FANOUT_KEY];
+
+/* --- private routine section ------------------------------------------------------------------ */
+
+static void _printArtBenchUsage(void)
+{
+    ol_printf("\
+Usage: art-bench [-n keys] [-p prefixes] [-h] [logger options] \n\
+    -n number of keys, %u by default.\n\
+    -p number of prefix iterations, %u by default.\n\
+    -h print the usage.\n\
+logger options:\n\
+    -T <0|1|2|3|4> the log level. 0: no log, 1: error, 2: info, 3: debug, 4: data.\n\
+    -F <log file> the log file.\n\
+    -S <log file size> the size of log file. No limit if not specified.\n\
+    ", ART_BENCH_DEFAULT_KEY, ART_BENCH_DEFAULT_PREFIX);
+
+    ol_printf("\n");
+
+    exit(0);
+}
+
+static u32 _parseArtBenchCmdLineParam(
+    olint_t argc, olchar_t ** argv, jf_logger_init_param_t * pjlip)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    olint_t nOpt;
+
+    while (((nOpt = getopt(argc, argv, "n:p:T:F:S:h")) != -1) &&
+           (u32Ret == JF_ERR_NO_ERROR))
+    {
+        switch (nOpt)
+        {
+        case '?':
+        case 'h':
+            _printArtBenchUsage();
+            break;
+        case ':':
+            u32Ret = JF_ERR_MISSING_PARAM;
+            break;
+        case 'n':
+            u32Ret = jf_option_getU32FromString(optarg, &ls_u32NumOfKey);
+            if ((u32Ret == JF_ERR_NO_ERROR) && (ls_u32NumOfKey == 0))
+                u32Ret = JF_ERR_INVALID_PARAM;
+            break;
+        case 'p':
+            u32Ret = jf_option_getU32FromString(optarg, &ls_u32NumOfPrefix);
+            break;
+        case 'T':
+            u32Ret = jf_option_getU8FromString(optarg, &pjlip->jlip_u8TraceLevel);
+            break;
+        case 'F':
+            pjlip->jlip_bLogToFile = TRUE;
+            pjlip->jlip_pstrLogFilePath = optarg;
+            break;
+        case 'S':
+            u32Ret = jf_option_getS32FromString(optarg, &pjlip->jlip_sLogFile);
+            break;
+        default:
+            u32Ret = JF_ERR_INVALID_OPTION;
+            break;
+        }
+    }
+
+    return u32Ret;
+}
+
+static u64 _getArtBenchTime(void)
+{
+    struct timespec ts;
+
+    jf_time_getClockTime(CLOCK_MONOTONIC, &ts);
+
+    return (u64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static u32 _getArtBenchRand(u32 * pu32Seed)
+{
+    *pu32Seed ^= *pu32Seed << 13;
+    *pu32Seed ^= *pu32Seed >> 17;
+    *pu32Seed ^= *pu32Seed << 5;
+
+    return *pu32Seed;
+}
+
+static olint_t _compareArtBenchKey(const void * pKey1, const void * pKey2)
+{
+    return ol_strcmp(*(olchar_t * const *)pKey1, *(olchar_t * const *)pKey2);
+}
+
+/** Generate the unique keys. The key is "/<dir>/<sub dir>/<file>", the index is spread to the
+ *  3 levels so the keys share prefixes of different length.
+ */
+static u32 _generateArtBenchKey(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Index, u32Seed = 0x41525442, u32Pos;
+    olchar_t * pstrTemp = NULL;
+
+    u32Ret = jf_jiukun_allocMemory(
+        (void **)&ls_pstrKeyBuf, ls_u32NumOfKey * ART_BENCH_MAX_KEY_LEN);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = jf_jiukun_allocMemory(
+            (void **)&ls_ppstrKey, ls_u32NumOfKey * sizeof(olchar_t *));
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = jf_jiukun_allocMemory(
+            (void **)&ls_ppstrSortedKey, ls_u32NumOfKey * sizeof(olchar_t *));
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        for (u32Index = 0; u32Index < ls_u32NumOfKey; u32Index ++)
+        {
+            ls_ppstrKey[u32Index] = ls_pstrKeyBuf + u32Index * ART_BENCH_MAX_KEY_LEN;
+            ol_snprintf(
+                ls_ppstrKey[u32Index], ART_BENCH_MAX_KEY_LEN, "/var/data%u/node%u/file%u",
+                u32Index % 7, (u32Index / 7) % 300, u32Index);
+        }
+
+        /*Shuffle the keys for insertion.*/
+        for (u32Index = ls_u32NumOfKey - 1; u32Index > 0; u32Index --)
+        {
+            u32Pos = _getArtBenchRand(&u32Seed) % (u32Index + 1);
+            pstrTemp = ls_ppstrKey[u32Index];
+            ls_ppstrKey[u32Index] = ls_ppstrKey[u32Pos];
+            ls_ppstrKey[u32Pos] = pstrTemp;
+        }
+
+        ol_memcpy(ls_ppstrSortedKey, ls_ppstrKey, ls_u32NumOfKey * sizeof(olchar_t *));
+        qsort(ls_ppstrSortedKey, ls_u32NumOfKey, sizeof(olchar_t *), _compareArtBenchKey);
+    }
+
+    return u32Ret;
+}
+
+static void _freeArtBenchKey(void)
+{
+    if (ls_pstrKeyBuf != NULL)
+        jf_jiukun_freeMemory((void **)&ls_pstrKeyBuf);
+
+    if (ls_ppstrKey != NULL)
+        jf_jiukun_freeMemory((void **)&ls_ppstrKey);
+
+    if (ls_ppstrSortedKey != NULL)
+        jf_jiukun_freeMemory((void **)&ls_ppstrSortedKey);
+}
+
+static u32 _insertArtBenchList(olchar_t * pstrKey, void * pValue)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_listhead_t * pos = NULL;
+    art_bench_entry_t * pabe = NULL, * pabeNew = NULL;
+
+    u32Ret = jf_jiukun_allocObject(ls_pjjcEntry, (void **)&pabeNew);
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        pabeNew->abe_pstrKey = pstrKey;
+        pabeNew->abe_pValue = pValue;
+
+        jf_listhead_forEach(&ls_jlList, pos)
+        {
+            pabe = jf_listhead_getEntry(pos, art_bench_entry_t, abe_jlList);
+            if (ol_strcmp(pabe->abe_pstrKey, pstrKey) > 0)
+                break;
+        }
+
+        /*Add the entry before the position, it's the tail if the position is the head.*/
+        jf_listhead_addTail(pos, &pabeNew->abe_jlList);
+    }
+
+    return u32Ret;
+}
+
+static art_bench_entry_t * _findArtBenchList(const olchar_t * pstrKey)
+{
+    jf_listhead_t * pos = NULL;
+    art_bench_entry_t * pabe = NULL;
+    olint_t nRet;
+
+    jf_listhead_forEach(&ls_jlList, pos)
+    {
+        pabe = jf_listhead_getEntry(pos, art_bench_entry_t, abe_jlList);
+        nRet = ol_strcmp(pabe->abe_pstrKey, pstrKey);
+        if (nRet == 0)
+            return pabe;
+        /*The list is sorted.*/
+        if (nRet > 0)
+            break;
+    }
+
+    return NULL;
+}
+
+static u32 _getArtBenchList(const olchar_t * pstrKey, void ** ppValue)
+{
+    art_bench_entry_t * pabe = _findArtBenchList(pstrKey);
+
+    if (pabe == NULL)
+        return JF_ERR_NOT_FOUND;
+
+    *ppValue = pabe->abe_pValue;
+
+    return JF_ERR_NO_ERROR;
+}
+
+static u32 _removeArtBenchList(const olchar_t * pstrKey)
+{
+    art_bench_entry_t * pabe = _findArtBenchList(pstrKey);
+
+    if (pabe == NULL)
+        return JF_ERR_NOT_FOUND;
+
+    jf_listhead_del(&pabe->abe_jlList);
+    jf_jiukun_freeObject(ls_pjjcEntry, (void **)&pabe);
+
+    return JF_ERR_NO_ERROR;
+}
+
+/** Check the key is the next one in the sorted array.
+ */
+static u32 _checkArtBenchEntry(const olchar_t * pstrKey, void * pValue, void * pArg)
+{
+    art_bench_prefix_t * pabp = pArg;
+
+    if ((pabp->abp_u32Pos >= ls_u32NumOfKey) ||
+        (ol_strcmp(ls_ppstrSortedKey[pabp->abp_u32Pos], pstrKey) != 0))
+        return JF_ERR_INVALID_DATA;
+
+    pabp->abp_u32Pos ++;
+    pabp->abp_u32Count ++;
+
+    return JF_ERR_NO_ERROR;
+}
+
+static u32 _iterateArtBenchListPrefix(const olchar_t * pstrPrefix, art_bench_prefix_t * pabp)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_listhead_t * pos = NULL;
+    art_bench_entry_t * pabe = NULL;
+    olsize_t sPrefix = ol_strlen(pstrPrefix);
+    olint_t nRet;
+
+    jf_listhead_forEach(&ls_jlList, pos)
+    {
+        pabe = jf_listhead_getEntry(pos, art_bench_entry_t, abe_jlList);
+        nRet = ol_strncmp(pabe->abe_pstrKey, pstrPrefix, sPrefix);
+        if (nRet < 0)
+            continue;
+        if (nRet > 0)
+            break;
+
+        u32Ret = _checkArtBenchEntry(pabe->abe_pstrKey, pabe->abe_pValue, pabp);
+        if (u32Ret != JF_ERR_NO_ERROR)
+            break;
+    }
+
+    return u32Ret;
+}
+
+/** Iterate the keys with the prefix of random key, the result is verified with the sorted array.
+ */
+static u32 _benchArtPrefix(u8 u8Container)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    art_bench_prefix_t abp;
+    u32 u32Index, u32Seed = 0x50524546, u32Pos, u32Expected;
+    olchar_t strPrefix[ART_BENCH_MAX_KEY_LEN];
+    olsize_t sPrefix;
+
+    for (u32Index = 0; (u32Index < ls_u32NumOfPrefix) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+    {
+        /*The prefix is a random key cut at random length.*/
+        u32Pos = _getArtBenchRand(&u32Seed) % ls_u32NumOfKey;
+        sPrefix = ol_strlen(ls_ppstrSortedKey[u32Pos]);
+        sPrefix = _getArtBenchRand(&u32Seed) % (sPrefix + 1);
+        ol_memcpy(strPrefix, ls_ppstrSortedKey[u32Pos], sPrefix);
+        strPrefix[sPrefix] = '\0';
+
+        /*Find the first key with the prefix in the sorted array.*/
+        while ((u32Pos > 0) && (ol_strncmp(ls_ppstrSortedKey[u32Pos - 1], strPrefix, sPrefix) == 0))
+            u32Pos --;
+        for (u32Expected = 0; (u32Pos + u32Expected < ls_u32NumOfKey) &&
+                 (ol_strncmp(ls_ppstrSortedKey[u32Pos + u32Expected], strPrefix, sPrefix) == 0);
+             u32Expected ++)
+            ;
+
+        ol_bzero(&abp, sizeof(abp));
+        abp.abp_u32Pos = u32Pos;
+
+        if (u8Container == ART_BENCH_CONTAINER_LIST)
+            u32Ret = _iterateArtBenchListPrefix(strPrefix, &abp);
+        else
+            u32Ret = jf_art_iteratePrefix(ls_pjaTree, strPrefix, _checkArtBenchEntry, &abp);
+
+        if ((u32Ret == JF_ERR_NO_ERROR) && (abp.abp_u32Count != u32Expected))
+            u32Ret = JF_ERR_INVALID_DATA;
+
+        if (u32Ret != JF_ERR_NO_ERROR)
+            ol_printf(
+                "Prefix iteration of \"%s\" is wrong, %u of %u keys are found\n", strPrefix,
+                abp.abp_u32Count, u32Expected);
+    }
+
+    return u32Ret;
+}
+
+static void _printArtBenchStat(void)
+{
+    jf_art_stat_t jas;
+
+    jf_art_getStat(ls_pjaTree, &jas);
+
+    ol_printf(
+        "art nodes: node4 %u, node16 %u, node48 %u, node256 %u\n", jas.jas_u32NumOfNode4,
+        jas.jas_u32NumOfNode16, jas.jas_u32NumOfNode48, jas.jas_u32NumOfNode256);
+}
+
+static u32 _benchArtContainer(u8 u8Container)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_art_create_param_t jacp;
+    u64 u64Start, u64Insert = 0, u64Lookup = 0, u64Prefix = 0, u64Remove = 0;
+    u32 u32Index;
+    void * pValue = NULL;
+
+    if (u8Container == ART_BENCH_CONTAINER_ART)
+    {
+        ol_bzero(&jacp, sizeof(jacp));
+        u32Ret = jf_art_create(&ls_pjaTree, &jacp);
+    }
+
+    u64Start = _getArtBenchTime();
+    for (u32Index = 0; (u32Index < ls_u32NumOfKey) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+    {
+        pValue = &ls_ppstrKey[u32Index];
+        if (u8Container == ART_BENCH_CONTAINER_LIST)
+            u32Ret = _insertArtBenchList(ls_ppstrKey[u32Index], pValue);
+        else
+            u32Ret = jf_art_insert(ls_pjaTree, ls_ppstrKey[u32Index], pValue);
+    }
+    u64Insert = _getArtBenchTime() - u64Start;
+
+    u64Start = _getArtBenchTime();
+    for (u32Index = 0; (u32Index < ls_u32NumOfKey) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+    {
+        if (u8Container == ART_BENCH_CONTAINER_LIST)
+            u32Ret = _getArtBenchList(ls_ppstrKey[u32Index], &pValue);
+        else
+            u32Ret = jf_art_get(ls_pjaTree, ls_ppstrKey[u32Index], &pValue);
+
+        if ((u32Ret == JF_ERR_NO_ERROR) && (pValue != &ls_ppstrKey[u32Index]))
+            u32Ret = JF_ERR_INVALID_DATA;
+    }
+    u64Lookup = _getArtBenchTime() - u64Start;
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        u64Start = _getArtBenchTime();
+        u32Ret = _benchArtPrefix(u8Container);
+        u64Prefix = _getArtBenchTime() - u64Start;
+    }
+
+    if ((u32Ret == JF_ERR_NO_ERROR) && (u8Container == ART_BENCH_CONTAINER_ART))
+        _printArtBenchStat();
+
+    /*Remove the keys in reverse order of insertion.*/
+    u64Start = _getArtBenchTime();
+    for (u32Index = ls_u32NumOfKey; (u32Index > 0) && (u32Ret == JF_ERR_NO_ERROR); u32Index --)
+    {
+        if (u8Container == ART_BENCH_CONTAINER_LIST)
+            u32Ret = _removeArtBenchList(ls_ppstrKey[u32Index - 1]);
+        else
+            u32Ret = jf_art_remove(ls_pjaTree, ls_ppstrKey[u32Index - 1], NULL);
+    }
+    u64Remove = _getArtBenchTime() - u64Start;
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        if (((u8Container == ART_BENCH_CONTAINER_LIST) && (! jf_listhead_isEmpty(&ls_jlList))) ||
+            ((u8Container == ART_BENCH_CONTAINER_ART) && (jf_art_getSize(ls_pjaTree) != 0)))
+        {
+            ol_printf("Container is not empty after all keys are removed\n");
+            u32Ret = JF_ERR_INVALID_DATA;
+        }
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        ol_printf(
+            "%-8s %10llu %10llu %10llu %10llu\n", ls_pstrContainer[u8Container],
+            u64Insert / 1000, u64Lookup / 1000, u64Prefix / 1000, u64Remove / 1000);
+
+    if (ls_pjaTree != NULL)
+        jf_art_destroy(&ls_pjaTree);
+
+    return u32Ret;
+}
+
+/** Generate the fan-out keys, "/fan/", "/fan/<byte>" and "/fan/<byte>/<byte>" for the byte from 1
+ *  to 255.
+ */
+static void _generateArtBenchFanoutKey(void)
+{
+    u32 u32Index, u32Byte;
+    olsize_t sPrefix = ol_strlen(ART_BENCH_FANOUT_PREFIX);
+
+    ol_bzero(ls_strFanoutKey, sizeof(ls_strFanoutKey));
+
+    ol_strcpy(ls_strFanoutKey[0], ART_BENCH_FANOUT_PREFIX);
+    for (u32Byte = 1; u32Byte <= 255; u32Byte ++)
+    {
+        u32Index = u32Byte * 2 - 1;
+        ol_strcpy(ls_strFanoutKey[u32Index], ART_BENCH_FANOUT_PREFIX);
+        ls_strFanoutKey[u32Index][sPrefix] = (olchar_t)u32Byte;
+
+        ol_strcpy(ls_strFanoutKey[u32Index + 1], ls_strFanoutKey[u32Index]);
+        ls_strFanoutKey[u32Index + 1][sPrefix + 1] = '/';
+        ls_strFanoutKey[u32Index + 1][sPrefix + 2] = (olchar_t)u32Byte;
+    }
+
+    for (u32Index = 0; u32Index < ART_BENCH_NUM_OF_FANOUT_KEY; u32Index ++)
+        ls_pstrSortedFanoutKey[u32Index] = ls_strFanoutKey[u32Index];
+
+    qsort(
+        ls_pstrSortedFanoutKey, ART_BENCH_NUM_OF_FANOUT_KEY, sizeof(olchar_t *),
+        _compareArtBenchKey);
+
+    ol_bzero(ls_bFanoutKeyInTree, sizeof(ls_bFanoutKeyInTree));
+}
+
+/** Shuffle the positions of the fan-out keys in the sorted array.
+ */
+static void _shuffleArtBenchFanoutKey(u32 * pu32Order, u32 u32Seed)
+{
+    u32 u32Index, u32Pos, u32Temp;
+
+    for (u32Index = 0; u32Index < ART_BENCH_NUM_OF_FANOUT_KEY; u32Index ++)
+        pu32Order[u32Index] = u32Index;
+
+    for (u32Index = ART_BENCH_NUM_OF_FANOUT_KEY - 1; u32Index > 0; u32Index --)
+    {
+        u32Pos = _getArtBenchRand(&u32Seed) % (u32Index + 1);
+        u32Temp = pu32Order[u32Index];
+        pu32Order[u32Index] = pu32Order[u32Pos];
+        pu32Order[u32Pos] = u32Temp;
+    }
+}
+
+/** Check the key is the next fan-out key in the tree, the value is the slot of the key in the
+ *  sorted array.
+ */
+static u32 _checkArtBenchFanoutEntry(const olchar_t * pstrKey, void * pValue, void * pArg)
+{
+    art_bench_prefix_t * pabp = pArg;
+
+    while ((pabp->abp_u32Pos < ART_BENCH_NUM_OF_FANOUT_KEY) &&
+           ! ls_bFanoutKeyInTree[pabp->abp_u32Pos])
+        pabp->abp_u32Pos ++;
+
+    if ((pabp->abp_u32Pos >= ART_BENCH_NUM_OF_FANOUT_KEY) ||
+        (ol_strcmp(ls_pstrSortedFanoutKey[pabp->abp_u32Pos], pstrKey) != 0) ||
+        (pValue != &ls_pstrSortedFanoutKey[pabp->abp_u32Pos]))
+        return JF_ERR_INVALID_DATA;
+
+    pabp->abp_u32Pos ++;
+    pabp->abp_u32Count ++;
+
+    return JF_ERR_NO_ERROR;
+}
+
+/** Iterate all keys in the tree and compare them with the fan-out keys in the tree.
+ */
+static u32 _verifyArtBenchFanout(u32 u32NumOfKey)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    art_bench_prefix_t abp;
+
+    ol_bzero(&abp, sizeof(abp));
+
+    u32Ret = jf_art_iteratePrefix(ls_pjaTree, "", _checkArtBenchFanoutEntry, &abp);
+
+    if ((u32Ret == JF_ERR_NO_ERROR) &&
+        ((abp.abp_u32Count != u32NumOfKey) || (jf_art_getSize(ls_pjaTree) != u32NumOfKey)))
+        u32Ret = JF_ERR_INVALID_DATA;
+
+    if (u32Ret != JF_ERR_NO_ERROR)
+        ol_printf(
+            "Fan-out keys are wrong, %u of %u keys are found\n", abp.abp_u32Count, u32NumOfKey);
+
+    return u32Ret;
+}
+
+/** Insert and remove the wide fan-out keys in random order. The node after the prefix grows from
+ *  node4 to node256 and shrinks back, the tree is verified after each insertion and removal.
+ */
+static u32 _benchArtFanout(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_art_create_param_t jacp;
+    jf_art_stat_t jas;
+    u32 u32Order[ART_BENCH_NUM_OF_FANOUT_KEY];
+    u32 u32Index, u32Pos, u32NumOfKey = 0;
+    void * pValue = NULL;
+
+    _generateArtBenchFanoutKey();
+
+    ol_bzero(&jacp, sizeof(jacp));
+    u32Ret = jf_art_create(&ls_pjaTree, &jacp);
+
+    _shuffleArtBenchFanoutKey(u32Order, 0x46414E49);
+    for (u32Index = 0; (u32Index < ART_BENCH_NUM_OF_FANOUT_KEY) && (u32Ret == JF_ERR_NO_ERROR);
+         u32Index ++)
+    {
+        u32Pos = u32Order[u32Index];
+        u32Ret = jf_art_insert(
+            ls_pjaTree, ls_pstrSortedFanoutKey[u32Pos], &ls_pstrSortedFanoutKey[u32Pos]);
+        if (u32Ret == JF_ERR_NO_ERROR)
+        {
+            ls_bFanoutKeyInTree[u32Pos] = TRUE;
+            u32NumOfKey ++;
+            u32Ret = _verifyArtBenchFanout(u32NumOfKey);
+        }
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        jf_art_getStat(ls_pjaTree, &jas);
+        if (jas.jas_u32NumOfNode256 == 0)
+        {
+            ol_printf("Node256 is not created for fan-out keys\n");
+            u32Ret = JF_ERR_INVALID_DATA;
+        }
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        _printArtBenchStat();
+
+    _shuffleArtBenchFanoutKey(u32Order, 0x46414E52);
+    for (u32Index = 0; (u32Index < ART_BENCH_NUM_OF_FANOUT_KEY) && (u32Ret == JF_ERR_NO_ERROR);
+         u32Index ++)
+    {
+        u32Pos = u32Order[u32Index];
+        u32Ret = jf_art_remove(ls_pjaTree, ls_pstrSortedFanoutKey[u32Pos], &pValue);
+        if ((u32Ret == JF_ERR_NO_ERROR) && (pValue != &ls_pstrSortedFanoutKey[u32Pos]))
+            u32Ret = JF_ERR_INVALID_DATA;
+
+        if (u32Ret == JF_ERR_NO_ERROR)
+        {
+            ls_bFanoutKeyInTree[u32Pos] = FALSE;
+            u32NumOfKey --;
+            if (jf_art_get(ls_pjaTree, ls_pstrSortedFanoutKey[u32Pos], &pValue) !=
+                JF_ERR_NOT_FOUND)
+                u32Ret = JF_ERR_INVALID_DATA;
+        }
+
+        if (u32Ret == JF_ERR_NO_ERROR)
+            u32Ret = _verifyArtBenchFanout(u32NumOfKey);
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        jf_art_getStat(ls_pjaTree, &jas);
+        if (jas.jas_u32NumOfNode4 + jas.jas_u32NumOfNode16 + jas.jas_u32NumOfNode48 +
+            jas.jas_u32NumOfNode256 != 0)
+        {
+            ol_printf("Nodes are not freed after all fan-out keys are removed\n");
+            u32Ret = JF_ERR_INVALID_DATA;
+        }
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        ol_printf("fan-out keys: %u, verified\n", ART_BENCH_NUM_OF_FANOUT_KEY);
+
+    if (ls_pjaTree != NULL)
+        jf_art_destroy(&ls_pjaTree);
+
+    return u32Ret;
+}
+
+static u32 _benchArt(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_jiukun_cache_create_param_t jjccp;
+    u8 u8Container;
+
+    ol_bzero(&jjccp, sizeof(jjccp));
+    jjccp.jjccp_pstrName = ART_BENCH_CACHE;
+    jjccp.jjccp_sObj = sizeof(art_bench_entry_t);
+
+    u32Ret = jf_jiukun_createCache(&ls_pjjcEntry, &jjccp);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = _generateArtBenchKey();
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ol_printf("keys: %u, prefixes: %u\n", ls_u32NumOfKey, ls_u32NumOfPrefix);
+        ol_printf(
+            "%-8s %10s %10s %10s %10s\n", "type", "insert us", "lookup us", "prefix us",
+            "remove us");
+
+        for (u8Container = ART_BENCH_CONTAINER_LIST;
+             (u8Container <= ART_BENCH_CONTAINER_ART) && (u32Ret == JF_ERR_NO_ERROR);
+             u8Container ++)
+            u32Ret = _benchArtContainer(u8Container);
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = _benchArtFanout();
+
+    _freeArtBenchKey();
+
+    if (ls_pjjcEntry != NULL)
+        jf_jiukun_destroyCache(&ls_pjjcEntry);
+
+    return u32Ret;
+}
+
+/* --- public routine section ------------------------------------------------------------------- */
+
+olint_t main(olint_t argc, olchar_t ** argv)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    olchar_t strErrMsg[300];
+    jf_logger_init_param_t jlipParam;
+    jf_jiukun_init_param_t jjip;
+
+    ol_bzero(&jlipParam, sizeof(jlipParam));
+    jlipParam.jlip_pstrCallerName = ART_BENCH;
+    jlipParam.jlip_bLogToStdout = TRUE;
+    jlipParam.jlip_u8TraceLevel = JF_LOGGER_TRACE_LEVEL_ERROR;
+
+    ol_bzero(&jjip, sizeof(jjip));
+    jjip.jjip_sPool = JF_JIUKUN_MAX_POOL_SIZE;
+
+    u32Ret = _parseArtBenchCmdLineParam(argc, argv, &jlipParam);
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        jf_logger_init(&jlipParam);
+
+        u32Ret = jf_jiukun_init(&jjip);
+        if (u32Ret == JF_ERR_NO_ERROR)
+        {
+            u32Ret = _benchArt();
+
+            jf_jiukun_fini();
+        }
+
+        jf_logger_fini();
+    }
+
+    if (u32Ret != JF_ERR_NO_ERROR)
+    {
+        jf_err_getMsg(u32Ret, strErrMsg, sizeof(strErrMsg));
+        ol_printf("%s\n", strErrMsg);
+    }
+
+    return u32Ret;
+}
+
+/*------------------------------------------------------------------------------------------------*/
@@ -6,6 +6,9 @@
  *  @author Min Zhang
  *
  *  @note
+ *  -# The routines of large bit array are verified with the result checked bit by bit, with and
+ *   without the SIMD instructions.
+ *  -# The benchmark compares the routines of large bit array with the byte and bit operations.
  *
  */
 
@@ -13,23 +16,48 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <time.h>
 
 /* --- internal header files -------------------------------------------------------------------- */
 #include "jf_basic.h"
 #include "jf_err.h"
 #include "jf_bitarray.h"
 #include "jf_string.h"
+#include "jf_time.h"
 
 /* --- private data/data structure section ------------------------------------------------------ */
+
+/** Number of char in bit array for testing the routines of large bit array.
+ */
+#define BITARRAY_TEST_CHARS            (600)
+
+/** Number of char in bit array for benchmark, the bit array is 1M bits.
+ */
+#define BITARRAY_BENCH_CHARS           (128 * 1024)
+
+#define BITARRAY_BENCH_BITS            (BITARRAY_BENCH_CHARS * JF_BITARRAY_BITS_PER_UNIT)
+
+#define BITARRAY_BENCH_ROUND           (200)
+
 static boolean_t ls_bSizeof = FALSE;
 
+static boolean_t ls_bLargeBitarray = FALSE;
+
+static boolean_t ls_bBench = FALSE;
+
+static jf_bitarray_t ls_jbTest[4][BITARRAY_TEST_CHARS];
+
+static jf_bitarray_t ls_jbBench[3][BITARRAY_BENCH_CHARS];
+
 /* --- private routine section ------------------------------------------------------------------ */
 static void _printBitarrayTestUsage(void)
 {
     ol_printf("\
-Usage: bitarray-test [-h] [-t]\n\
+Usage: bitarray-test [-h] [-t] [-l] [-b]\n\
     -h show this usage\n\
-    -t test sizeof on local machine\n");
+    -t test sizeof on local machine\n\
+    -l test routines of large bit array\n\
+    -b benchmark routines of large bit array\n");
     ol_printf("\n");
 }
 
@@ -38,7 +66,7 @@ static u32 _parseBitarrayTestCmdLineParam(olint_t argc, olchar_t ** argv)
     u32 u32Ret = JF_ERR_NO_ERROR;
     olint_t nOpt;
 
-    while (((nOpt = getopt(argc, argv, "th?")) != -1) && (u32Ret == JF_ERR_NO_ERROR))
+    while (((nOpt = getopt(argc, argv, "tlbh?")) != -1) && (u32Ret == JF_ERR_NO_ERROR))
     {
         switch (nOpt)
         {
@@ -53,6 +81,12 @@ static u32 _parseBitarrayTestCmdLineParam(olint_t argc, olchar_t ** argv)
         case 't':
             ls_bSizeof = TRUE;
             break;
+        case 'l':
+            ls_bLargeBitarray = TRUE;
+            break;
+        case 'b':
+            ls_bBench = TRUE;
+            break;
         default:
             u32Ret = JF_ERR_INVALID_OPTION;
             break;
@@ -257,6 +291,306 @@ static void _testSizeof(void)
     ol_printf("sizeof(b[1][1]) = %d\n", (s32)sizeof(b[1][1]));
 }
 
+static boolean_t _testBitarrayBit(const jf_bitarray_t * pjb, u32 u32Pos)
+{
+    return (pjb[JF_BITARRAY_BIT_CHAR(u32Pos)] & JF_BITARRAY_BIT_IN_CHAR(u32Pos)) != 0;
+}
+
+/** Fill the bit array randomly, the bit is set with the probability "u32Set / u32Total".
+ */
+static void _fillBitarrayRandomly(jf_bitarray_t * pjb, u32 u32Chars, u32 u32Set, u32 u32Total)
+{
+    u32 u32Pos;
+
+    ol_bzero(pjb, u32Chars);
+
+    for (u32Pos = 0; u32Pos < u32Chars * JF_BITARRAY_BITS_PER_UNIT; u32Pos ++)
+        if ((u32)(rand() % u32Total) < u32Set)
+            pjb[JF_BITARRAY_BIT_CHAR(u32Pos)] |= JF_BITARRAY_BIT_IN_CHAR(u32Pos);
+}
+
+static u32 _testFindAndCount(const jf_bitarray_t * pjb, u32 u32Bits)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Start, u32Pos, u32Set, u32Zero, u32Count = 0;
+
+    for (u32Pos = 0; u32Pos < u32Bits; u32Pos ++)
+        if (_testBitarrayBit(pjb, u32Pos))
+            u32Count ++;
+
+    if (jf_bitarray_countSetBit(pjb, u32Bits) != u32Count)
+    {
+        ol_printf(
+            "%u bits, count %u, expected %u\n", u32Bits, jf_bitarray_countSetBit(pjb, u32Bits),
+            u32Count);
+        u32Ret = JF_ERR_INVALID_DATA;
+    }
+
+    /*Find from every position and the end, the expected position is updated from the end.*/
+    u32Set = u32Zero = u32Bits;
+    u32Start = u32Bits + 1;
+    while ((u32Start > 0) && (u32Ret == JF_ERR_NO_ERROR))
+    {
+        u32Start --;
+        if ((u32Start < u32Bits) && _testBitarrayBit(pjb, u32Start))
+            u32Set = u32Start;
+        else if (u32Start < u32Bits)
+            u32Zero = u32Start;
+
+        if ((jf_bitarray_findFirstSetBit(pjb, u32Bits, u32Start) != u32Set) ||
+            (jf_bitarray_findFirstZeroBit(pjb, u32Bits, u32Start) != u32Zero))
+        {
+            ol_printf(
+                "%u bits, find from %u, set %u, zero %u, expected %u, %u\n", u32Bits, u32Start,
+                jf_bitarray_findFirstSetBit(pjb, u32Bits, u32Start),
+                jf_bitarray_findFirstZeroBit(pjb, u32Bits, u32Start), u32Set, u32Zero);
+            u32Ret = JF_ERR_INVALID_DATA;
+        }
+    }
+
+    return u32Ret;
+}
+
+static u32 _testRange(jf_bitarray_t * pjb, jf_bitarray_t * pjbCopy, u32 u32Bits)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Round, u32Start, u32Count, u32Pos;
+    boolean_t bSet, bExpected;
+
+    for (u32Round = 0; (u32Round < 50) && (u32Ret == JF_ERR_NO_ERROR); u32Round ++)
+    {
+        u32Start = rand() % u32Bits;
+        u32Count = rand() % (u32Bits - u32Start + 1);
+        bSet = (rand() % 2 == 0) ? TRUE : FALSE;
+
+        ol_memcpy(pjbCopy, pjb, BITARRAY_TEST_CHARS);
+        if (bSet)
+            jf_bitarray_setRange(pjb, u32Start, u32Count);
+        else
+            jf_bitarray_clearRange(pjb, u32Start, u32Count);
+
+        for (u32Pos = 0; (u32Pos < BITARRAY_TEST_CHARS * JF_BITARRAY_BITS_PER_UNIT) &&
+                 (u32Ret == JF_ERR_NO_ERROR); u32Pos ++)
+        {
+            if ((u32Pos >= u32Start) && (u32Pos < u32Start + u32Count))
+                bExpected = bSet;
+            else
+                bExpected = _testBitarrayBit(pjbCopy, u32Pos);
+
+            if (_testBitarrayBit(pjb, u32Pos) != bExpected)
+            {
+                ol_printf(
+                    "%s range from %u with %u bits, bit %u is wrong\n", bSet ? "set" : "clear",
+                    u32Start, u32Count, u32Pos);
+                u32Ret = JF_ERR_INVALID_DATA;
+            }
+        }
+    }
+
+    return u32Ret;
+}
+
+static u32 _testLogical(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Chars, u32Index;
+    jf_bitarray_t * pjbSrc1 = ls_jbTest[0], * pjbSrc2 = ls_jbTest[1], * pjbDest = ls_jbTest[2];
+    jf_bitarray_t * pjbSave = ls_jbTest[3];
+
+    _fillBitarrayRandomly(pjbSrc1, BITARRAY_TEST_CHARS, 1, 2);
+    _fillBitarrayRandomly(pjbSrc2, BITARRAY_TEST_CHARS, 1, 2);
+
+    for (u32Chars = 0; (u32Chars < BITARRAY_TEST_CHARS) && (u32Ret == JF_ERR_NO_ERROR);
+         u32Chars += 1 + rand() % 40)
+    {
+        ol_memset(pjbDest, 0xA5, BITARRAY_TEST_CHARS);
+        jf_bitarray_and(pjbDest, pjbSrc1, pjbSrc2, u32Chars);
+        for (u32Index = 0; (u32Index < u32Chars) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+            if (pjbDest[u32Index] != (pjbSrc1[u32Index] & pjbSrc2[u32Index]))
+                u32Ret = JF_ERR_INVALID_DATA;
+
+        jf_bitarray_or(pjbDest, pjbSrc1, pjbSrc2, u32Chars);
+        for (u32Index = 0; (u32Index < u32Chars) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+            if (pjbDest[u32Index] != (pjbSrc1[u32Index] | pjbSrc2[u32Index]))
+                u32Ret = JF_ERR_INVALID_DATA;
+
+        jf_bitarray_xor(pjbDest, pjbSrc1, pjbSrc2, u32Chars);
+        for (u32Index = 0; (u32Index < u32Chars) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+            if (pjbDest[u32Index] != (pjbSrc1[u32Index] ^ pjbSrc2[u32Index]))
+                u32Ret = JF_ERR_INVALID_DATA;
+
+        /*The destination is the first source.*/
+        ol_memcpy(pjbSave, pjbSrc1, BITARRAY_TEST_CHARS);
+        jf_bitarray_andNot(pjbSrc1, pjbSrc1, pjbSrc2, u32Chars);
+        for (u32Index = 0; (u32Index < u32Chars) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+            if (pjbSrc1[u32Index] != (u8)(pjbSave[u32Index] & ~pjbSrc2[u32Index]))
+                u32Ret = JF_ERR_INVALID_DATA;
+        ol_memcpy(pjbSrc1, pjbSave, BITARRAY_TEST_CHARS);
+
+        /*The chars after the bit array are not changed.*/
+        if ((u32Ret == JF_ERR_NO_ERROR) && (pjbDest[u32Chars] != 0xA5))
+            u32Ret = JF_ERR_INVALID_DATA;
+
+        if (u32Ret != JF_ERR_NO_ERROR)
+            ol_printf("logical operation with %u chars is wrong\n", u32Chars);
+    }
+
+    return u32Ret;
+}
+
+static u32 _testLargeBitarrayOnce(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Bits[] = {1, 7, 8, 9, 63, 64, 65, 255, 256, 257, 1000, 4093,
+                     BITARRAY_TEST_CHARS * JF_BITARRAY_BITS_PER_UNIT};
+    u32 u32NumOfBits = sizeof(u32Bits) / sizeof(u32);
+    /*The probability of set bit, the bit array is sparse, dense, half set, all set or empty.*/
+    u32 u32Set[][2] = {{1, 1000}, {999, 1000}, {1, 2}, {1, 1}, {0, 1}};
+    u32 u32NumOfSet = sizeof(u32Set) / sizeof(u32Set[0]);
+    u32 u32Index, u32SetIndex;
+
+    for (u32Index = 0; (u32Index < u32NumOfBits) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+    {
+        for (u32SetIndex = 0; (u32SetIndex < u32NumOfSet) && (u32Ret == JF_ERR_NO_ERROR);
+             u32SetIndex ++)
+        {
+            _fillBitarrayRandomly(
+                ls_jbTest[0], BITARRAY_TEST_CHARS, u32Set[u32SetIndex][0], u32Set[u32SetIndex][1]);
+
+            u32Ret = _testFindAndCount(ls_jbTest[0], u32Bits[u32Index]);
+
+            if (u32Ret == JF_ERR_NO_ERROR)
+                u32Ret = _testRange(ls_jbTest[0], ls_jbTest[1], u32Bits[u32Index]);
+
+            if (u32Ret == JF_ERR_NO_ERROR)
+                u32Ret = _testFindAndCount(ls_jbTest[0], u32Bits[u32Index]);
+        }
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = _testLogical();
+
+    return u32Ret;
+}
+
+static u32 _testLargeBitarray(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    boolean_t bSimd = FALSE;
+
+    srand(1);
+
+    jf_bitarray_enableSimd(FALSE);
+    u32Ret = _testLargeBitarrayOnce();
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ol_printf("large bit array without SIMD: passed\n");
+        bSimd = (jf_bitarray_enableSimd(TRUE) == JF_ERR_NO_ERROR) ? TRUE : FALSE;
+    }
+
+    if ((u32Ret == JF_ERR_NO_ERROR) && bSimd)
+    {
+        u32Ret = _testLargeBitarrayOnce();
+        if (u32Ret == JF_ERR_NO_ERROR)
+            ol_printf("large bit array with SIMD: passed\n");
+    }
+    else if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ol_printf("large bit array with SIMD: not supported\n");
+    }
+
+    return u32Ret;
+}
+
+static u64 _getBitarrayBenchTime(void)
+{
+    struct timespec ts;
+
+    jf_time_getClockTime(CLOCK_MONOTONIC, &ts);
+
+    return (u64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void _printBitarrayBenchResult(const olchar_t * pstrName, u64 u64Time, u32 u32Result)
+{
+    ol_printf(
+        "%-18s %10llu %10u\n", pstrName, u64Time / BITARRAY_BENCH_ROUND / 1000, u32Result);
+}
+
+/** Benchmark the routines with or without the SIMD instructions.
+ */
+static void _benchLargeBitarray(const olchar_t * pstrName)
+{
+    u32 u32Round, u32Result = 0;
+    u64 u64Start;
+    olchar_t strName[32];
+
+    u64Start = _getBitarrayBenchTime();
+    for (u32Round = 0; u32Round < BITARRAY_BENCH_ROUND; u32Round ++)
+        u32Result = jf_bitarray_countSetBit(ls_jbBench[0], BITARRAY_BENCH_BITS);
+    ol_snprintf(strName, sizeof(strName), "count %s", pstrName);
+    _printBitarrayBenchResult(strName, _getBitarrayBenchTime() - u64Start, u32Result);
+
+    u64Start = _getBitarrayBenchTime();
+    for (u32Round = 0; u32Round < BITARRAY_BENCH_ROUND; u32Round ++)
+        u32Result = jf_bitarray_findFirstSetBit(ls_jbBench[1], BITARRAY_BENCH_BITS, 0);
+    ol_snprintf(strName, sizeof(strName), "find %s", pstrName);
+    _printBitarrayBenchResult(strName, _getBitarrayBenchTime() - u64Start, u32Result);
+
+    u64Start = _getBitarrayBenchTime();
+    for (u32Round = 0; u32Round < BITARRAY_BENCH_ROUND; u32Round ++)
+        jf_bitarray_and(ls_jbBench[2], ls_jbBench[0], ls_jbBench[1], BITARRAY_BENCH_CHARS);
+    ol_snprintf(strName, sizeof(strName), "and %s", pstrName);
+    _printBitarrayBenchResult(
+        strName, _getBitarrayBenchTime() - u64Start,
+        jf_bitarray_countSetBit(ls_jbBench[2], BITARRAY_BENCH_BITS));
+}
+
+static u32 _benchBitarray(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Round, u32Pos, u32Result = 0;
+    u64 u64Start;
+
+    srand(1);
+    /*The first bit array is half set, the second bit array has only the last bit set.*/
+    _fillBitarrayRandomly(ls_jbBench[0], BITARRAY_BENCH_CHARS, 1, 2);
+    JF_BITARRAY_INIT(ls_jbBench[1]);
+    jf_bitarray_setBit(ls_jbBench[1], BITARRAY_BENCH_BITS - 1);
+
+    ol_printf("%u bits, average of %u rounds\n", BITARRAY_BENCH_BITS, BITARRAY_BENCH_ROUND);
+    ol_printf("%-18s %10s %10s\n", "operation", "us", "result");
+
+    u64Start = _getBitarrayBenchTime();
+    for (u32Round = 0; u32Round < BITARRAY_BENCH_ROUND; u32Round ++)
+        for (u32Pos = 0, u32Result = 0; u32Pos < BITARRAY_BENCH_BITS; u32Pos ++)
+            if (jf_bitarray_testBit(ls_jbBench[0], u32Pos))
+                u32Result ++;
+    _printBitarrayBenchResult("count bit", _getBitarrayBenchTime() - u64Start, u32Result);
+
+    u64Start = _getBitarrayBenchTime();
+    for (u32Round = 0; u32Round < BITARRAY_BENCH_ROUND; u32Round ++)
+        for (u32Result = 0; u32Result < BITARRAY_BENCH_BITS; u32Result ++)
+            if (jf_bitarray_testBit(ls_jbBench[1], u32Result))
+                break;
+    _printBitarrayBenchResult("find bit", _getBitarrayBenchTime() - u64Start, u32Result);
+
+    u64Start = _getBitarrayBenchTime();
+    for (u32Round = 0; u32Round < BITARRAY_BENCH_ROUND; u32Round ++)
+        JF_BITARRAY_AND(ls_jbBench[2], ls_jbBench[0], ls_jbBench[1]);
+    _printBitarrayBenchResult(
+        "and char", _getBitarrayBenchTime() - u64Start,
+        jf_bitarray_countSetBit(ls_jbBench[2], BITARRAY_BENCH_BITS));
+
+    jf_bitarray_enableSimd(FALSE);
+    _benchLargeBitarray("word");
+
+    if (jf_bitarray_enableSimd(TRUE) == JF_ERR_NO_ERROR)
+        _benchLargeBitarray("simd");
+
+    return u32Ret;
+}
+
 /* --- public routine section ------------------------------------------------------------------- */
 olint_t main(olint_t argc, olchar_t ** argv)
 {
@@ -270,6 +604,14 @@ olint_t main(olint_t argc, olchar_t ** argv)
         {
             _testSizeof();
         }
+        else if (ls_bLargeBitarray)
+        {
+            u32Ret = _testLargeBitarray();
+        }
+        else if (ls_bBench)
+        {
+            u32Ret = _benchBitarray();
+        }
         else
         {
             _testBitArray();
@@ -0,0 +1,564 @@
+/**
+ *  @file btree-bench.c
+ *
+ *  @brief Benchmark for comparing the B+tree with the sorted linked list.
+ *
+ *  @author Min Zhang
+ *
+ *  @note
+ *  -# The baseline is the sorted jf_listhead list, it's how utimer keeps the timers in order. The
+ *   position for insertion is found by walking the list from the head.
+ *  -# The benchmark inserts the keys in random order, looks up all keys, iterates random ranges and
+ *   removes all keys in another order. The result is verified against the sorted array of keys.
+ */
+
+/* --- standard C lib header files -------------------------------------------------------------- */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+
+/* --- internal header files -------------------------------------------------------------------- */
+#include "jf_basic.h"
+#include "jf_limit.h"
+#include "jf_err.h"
+#include "jf_jiukun.h"
+#include "jf_option.h"
+#include "jf_time.h"
+#include "jf_listhead.h"
+#include "jf_btree.h"
+
+/* --- private data/data structure section ------------------------------------------------------ */
+
+#define BTREE_BENCH                             "BTREE-BENCH"
+
+#define BTREE_BENCH_DEFAULT_KEY                 (20000)
+
+#define BTREE_BENCH_DEFAULT_RANGE               (10000)
+
+#define BTREE_BENCH_DEFAULT_RANGE_LEN           (100)
+
+#define BTREE_BENCH_CACHE                       "btree-bench-entry"
+
+typedef enum
+{
+    BTREE_BENCH_CONTAINER_LIST = 0,
+    BTREE_BENCH_CONTAINER_BTREE,
+} btree_bench_container_t;
+
+/** The entry in sorted list.
+ */
+typedef struct
+{
+    jf_listhead_t bbe_jlList;
+    u64 bbe_u64Key;
+    void * bbe_pValue;
+} btree_bench_entry_t;
+
+/** The argument for range iteration.
+ */
+typedef struct
+{
+    u32 bbr_u32Count;
+    u32 bbr_u32Max;
+    u64 bbr_u64Sum;
+} btree_bench_range_t;
+
+static olchar_t * ls_pstrContainer[] =
+{
+    "list",
+    "btree",
+};
+
+static u32 ls_u32NumOfKey = BTREE_BENCH_DEFAULT_KEY;
+
+static u32 ls_u32NumOfRange = BTREE_BENCH_DEFAULT_RANGE;
+
+static u32 ls_u32RangeLen = BTREE_BENCH_DEFAULT_RANGE_LEN;
+
+static jf_jiukun_cache_t * ls_pjjcEntry = NULL;
+
+/** The keys in insertion order.
+ */
+static u64 * ls_pu64Key = NULL;
+
+/** The keys in ascending order.
+ */
+static u64 * ls_pu64SortedKey = NULL;
+
+static JF_LISTHEAD(ls_jlList);
+
+static jf_btree_t * ls_pjbTree = NULL;
+
+/* --- private routine section ------------------------------------------------------------------ */
+
+static void _printBtreeBenchUsage(void)
+{
+    ol_printf("\
+Usage: btree-bench [-n keys] [-r ranges] [-l range length] [-h] [logger options] \n\
+    -n number of keys, %u by default.\n\
+    -r number of range iterations, %u by default.\n\
+    -l number of keys in each range, %u by default.\n\
+    -h print the usage.\n\
+logger options:\n\
+    -T <0|1|2|3|4> the log level. 0: no log, 1: error, 2: info, 3: debug, 4: data.\n\
+    -F <log file> the log file.\n\
+    -S <log file size> the size of log file. No limit if not specified.\n\
+    ", BTREE_BENCH_DEFAULT_KEY, BTREE_BENCH_DEFAULT_RANGE, BTREE_BENCH_DEFAULT_RANGE_LEN);
+
+    ol_printf("\n");
+
+    exit(0);
+}
+
+static u32 _parseBtreeBenchCmdLineParam(
+    olint_t argc, olchar_t ** argv, jf_logger_init_param_t * pjlip)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    olint_t nOpt;
+
+    while (((nOpt = getopt(argc, argv, "n:r:l:T:F:S:h")) != -1) &&
+           (u32Ret == JF_ERR_NO_ERROR))
+    {
+        switch (nOpt)
+        {
+        case '?':
+        case 'h':
+            _printBtreeBenchUsage();
+            break;
+        case ':':
+            u32Ret = JF_ERR_MISSING_PARAM;
+            break;
+        case 'n':
+            u32Ret = jf_option_getU32FromString(optarg, &ls_u32NumOfKey);
+            if ((u32Ret == JF_ERR_NO_ERROR) && (ls_u32NumOfKey == 0))
+                u32Ret = JF_ERR_INVALID_PARAM;
+            break;
+        case 'r':
+            u32Ret = jf_option_getU32FromString(optarg, &ls_u32NumOfRange);
+            break;
+        case 'l':
+            u32Ret = jf_option_getU32FromString(optarg, &ls_u32RangeLen);
+            if ((u32Ret == JF_ERR_NO_ERROR) && (ls_u32RangeLen == 0))
+                u32Ret = JF_ERR_INVALID_PARAM;
+            break;
+        case 'T':
+            u32Ret = jf_option_getU8FromString(optarg, &pjlip->jlip_u8TraceLevel);
+            break;
+        case 'F':
+            pjlip->jlip_bLogToFile = TRUE;
+            pjlip->jlip_pstrLogFilePath = optarg;
+            break;
+        case 'S':
+            u32Ret = jf_option_getS32FromString(optarg, &pjlip->jlip_sLogFile);
+            break;
+        default:
+            u32Ret = JF_ERR_INVALID_OPTION;
+            break;
+        }
+    }
+
+    return u32Ret;
+}
+
+static u64 _getBtreeBenchTime(void)
+{
+    struct timespec ts;
+
+    jf_time_getClockTime(CLOCK_MONOTONIC, &ts);
+
+    return (u64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static olint_t _compareBtreeBenchKey(const void * pKey1, const void * pKey2)
+{
+    u64 u64Key1 = *(const u64 *)pKey1, u64Key2 = *(const u64 *)pKey2;
+
+    return (u64Key1 < u64Key2) ? -1 : ((u64Key1 > u64Key2) ? 1 : 0);
+}
+
+/** Generate the unique keys, the multiplication with odd number is a bijection on u64.
+ */
+static u32 _generateBtreeBenchKey(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Index;
+
+    u32Ret = jf_jiukun_allocMemory((void **)&ls_pu64Key, ls_u32NumOfKey * sizeof(u64));
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = jf_jiukun_allocMemory((void **)&ls_pu64SortedKey, ls_u32NumOfKey * sizeof(u64));
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        for (u32Index = 0; u32Index < ls_u32NumOfKey; u32Index ++)
+            ls_pu64Key[u32Index] = ((u64)u32Index + 1) * 0x9E3779B97F4A7C15ULL;
+
+        ol_memcpy(ls_pu64SortedKey, ls_pu64Key, ls_u32NumOfKey * sizeof(u64));
+        qsort(ls_pu64SortedKey, ls_u32NumOfKey, sizeof(u64), _compareBtreeBenchKey);
+    }
+
+    return u32Ret;
+}
+
+static void _freeBtreeBenchKey(void)
+{
+    if (ls_pu64Key != NULL)
+        jf_jiukun_freeMemory((void **)&ls_pu64Key);
+
+    if (ls_pu64SortedKey != NULL)
+        jf_jiukun_freeMemory((void **)&ls_pu64SortedKey);
+}
+
+static u32 _insertBtreeBenchList(u64 u64Key, void * pValue)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_listhead_t * pos = NULL;
+    btree_bench_entry_t * pbbe = NULL, * pbbeNew = NULL;
+
+    u32Ret = jf_jiukun_allocObject(ls_pjjcEntry, (void **)&pbbeNew);
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        pbbeNew->bbe_u64Key = u64Key;
+        pbbeNew->bbe_pValue = pValue;
+
+        jf_listhead_forEach(&ls_jlList, pos)
+        {
+            pbbe = jf_listhead_getEntry(pos, btree_bench_entry_t, bbe_jlList);
+            if (pbbe->bbe_u64Key > u64Key)
+                break;
+        }
+
+        /*Add the entry before the position, it's the tail if the position is the head.*/
+        jf_listhead_addTail(pos, &pbbeNew->bbe_jlList);
+    }
+
+    return u32Ret;
+}
+
+static btree_bench_entry_t * _findBtreeBenchList(u64 u64Key)
+{
+    jf_listhead_t * pos = NULL;
+    btree_bench_entry_t * pbbe = NULL;
+
+    jf_listhead_forEach(&ls_jlList, pos)
+    {
+        pbbe = jf_listhead_getEntry(pos, btree_bench_entry_t, bbe_jlList);
+        if (pbbe->bbe_u64Key == u64Key)
+            return pbbe;
+        /*The list is sorted.*/
+        if (pbbe->bbe_u64Key > u64Key)
+            break;
+    }
+
+    return NULL;
+}
+
+static u32 _getBtreeBenchList(u64 u64Key, void ** ppValue)
+{
+    btree_bench_entry_t * pbbe = _findBtreeBenchList(u64Key);
+
+    if (pbbe == NULL)
+        return JF_ERR_NOT_FOUND;
+
+    *ppValue = pbbe->bbe_pValue;
+
+    return JF_ERR_NO_ERROR;
+}
+
+static u32 _removeBtreeBenchList(u64 u64Key)
+{
+    btree_bench_entry_t * pbbe = _findBtreeBenchList(u64Key);
+
+    if (pbbe == NULL)
+        return JF_ERR_NOT_FOUND;
+
+    jf_listhead_del(&pbbe->bbe_jlList);
+    jf_jiukun_freeObject(ls_pjjcEntry, (void **)&pbbe);
+
+    return JF_ERR_NO_ERROR;
+}
+
+static void _iterateBtreeBenchListRange(u64 u64From, btree_bench_range_t * pbbr)
+{
+    jf_listhead_t * pos = NULL;
+    btree_bench_entry_t * pbbe = NULL;
+
+    jf_listhead_forEach(&ls_jlList, pos)
+    {
+        pbbe = jf_listhead_getEntry(pos, btree_bench_entry_t, bbe_jlList);
+        if (pbbe->bbe_u64Key < u64From)
+            continue;
+        if (pbbr->bbr_u32Count == pbbr->bbr_u32Max)
+            break;
+
+        pbbr->bbr_u64Sum += pbbe->bbe_u64Key;
+        pbbr->bbr_u32Count ++;
+    }
+}
+
+static void _iterateBtreeBenchTreeRange(u64 u64From, btree_bench_range_t * pbbr)
+{
+    jf_btree_iterator_t jbi;
+    u32 u32Ret = JF_ERR_NO_ERROR;
+
+    u32Ret = jf_btree_lowerBound(ls_pjbTree, u64From, &jbi);
+    while ((u32Ret == JF_ERR_NO_ERROR) && (pbbr->bbr_u32Count < pbbr->bbr_u32Max))
+    {
+        pbbr->bbr_u64Sum += jf_btree_getIteratorKey(&jbi);
+        pbbr->bbr_u32Count ++;
+
+        u32Ret = jf_btree_getNext(&jbi);
+    }
+}
+
+static u32 _countBtreeBenchEntry(u64 u64Key, void * pValue, void * pArg)
+{
+    btree_bench_range_t * pbbr = pArg;
+
+    /*The keys are iterated in ascending order.*/
+    if (ls_pu64SortedKey[pbbr->bbr_u32Count] != u64Key)
+        return JF_ERR_INVALID_DATA;
+
+    pbbr->bbr_u64Sum += u64Key;
+    pbbr->bbr_u32Count ++;
+
+    return JF_ERR_NO_ERROR;
+}
+
+/** Check all keys are in order and the size of container.
+ */
+static u32 _verifyBtreeBenchOrder(u8 u8Container)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    btree_bench_range_t bbr;
+    jf_listhead_t * pos = NULL;
+    btree_bench_entry_t * pbbe = NULL;
+
+    ol_bzero(&bbr, sizeof(bbr));
+
+    if (u8Container == BTREE_BENCH_CONTAINER_LIST)
+    {
+        jf_listhead_forEach(&ls_jlList, pos)
+        {
+            pbbe = jf_listhead_getEntry(pos, btree_bench_entry_t, bbe_jlList);
+            u32Ret = _countBtreeBenchEntry(pbbe->bbe_u64Key, pbbe->bbe_pValue, &bbr);
+            if (u32Ret != JF_ERR_NO_ERROR)
+                break;
+        }
+    }
+    else
+    {
+        u32Ret = jf_btree_iterateRange(ls_pjbTree, 0, U64_MAX, _countBtreeBenchEntry, &bbr);
+    }
+
+    if ((u32Ret == JF_ERR_NO_ERROR) && (bbr.bbr_u32Count != ls_u32NumOfKey))
+        u32Ret = JF_ERR_INVALID_DATA;
+
+    if (u32Ret != JF_ERR_NO_ERROR)
+        ol_printf("Keys are out of order, %u keys are in order\n", bbr.bbr_u32Count);
+
+    return u32Ret;
+}
+
+/** Iterate the range starting from random key, the result is verified with the sorted array.
+ */
+static u32 _benchBtreeRange(u8 u8Container)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    btree_bench_range_t bbr;
+    u32 u32Index, u32Index2, u32Pos, u32Seed = 0x42545245, u32Len;
+    u64 u64Sum;
+
+    for (u32Index = 0; (u32Index < ls_u32NumOfRange) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+    {
+        u32Seed ^= u32Seed << 13;
+        u32Seed ^= u32Seed >> 17;
+        u32Seed ^= u32Seed << 5;
+        u32Pos = u32Seed % ls_u32NumOfKey;
+
+        ol_bzero(&bbr, sizeof(bbr));
+        bbr.bbr_u32Max = ls_u32RangeLen;
+
+        /*Start from the key between 2 keys to exercise the lower bound.*/
+        if (u8Container == BTREE_BENCH_CONTAINER_LIST)
+            _iterateBtreeBenchListRange(ls_pu64SortedKey[u32Pos] - 1, &bbr);
+        else
+            _iterateBtreeBenchTreeRange(ls_pu64SortedKey[u32Pos] - 1, &bbr);
+
+        u32Len = MIN(ls_u32RangeLen, ls_u32NumOfKey - u32Pos);
+        for (u32Index2 = 0, u64Sum = 0; u32Index2 < u32Len; u32Index2 ++)
+            u64Sum += ls_pu64SortedKey[u32Pos + u32Index2];
+
+        if ((bbr.bbr_u64Sum != u64Sum) || (bbr.bbr_u32Count != u32Len))
+        {
+            ol_printf("Range iteration from %llu is wrong\n", ls_pu64SortedKey[u32Pos]);
+            u32Ret = JF_ERR_INVALID_DATA;
+        }
+    }
+
+    return u32Ret;
+}
+
+static u32 _benchBtreeContainer(u8 u8Container)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_btree_create_param_t jbcp;
+    u64 u64Start, u64Insert = 0, u64Lookup = 0, u64Range = 0, u64Remove = 0;
+    u32 u32Index;
+    void * pValue = NULL;
+
+    if (u8Container == BTREE_BENCH_CONTAINER_BTREE)
+    {
+        ol_bzero(&jbcp, sizeof(jbcp));
+        u32Ret = jf_btree_create(&ls_pjbTree, &jbcp);
+    }
+
+    u64Start = _getBtreeBenchTime();
+    for (u32Index = 0; (u32Index < ls_u32NumOfKey) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+    {
+        pValue = &ls_pu64Key[u32Index];
+        if (u8Container == BTREE_BENCH_CONTAINER_LIST)
+            u32Ret = _insertBtreeBenchList(ls_pu64Key[u32Index], pValue);
+        else
+            u32Ret = jf_btree_insert(ls_pjbTree, ls_pu64Key[u32Index], pValue);
+    }
+    u64Insert = _getBtreeBenchTime() - u64Start;
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = _verifyBtreeBenchOrder(u8Container);
+
+    u64Start = _getBtreeBenchTime();
+    for (u32Index = 0; (u32Index < ls_u32NumOfKey) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+    {
+        if (u8Container == BTREE_BENCH_CONTAINER_LIST)
+            u32Ret = _getBtreeBenchList(ls_pu64Key[u32Index], &pValue);
+        else
+            u32Ret = jf_btree_get(ls_pjbTree, ls_pu64Key[u32Index], &pValue);
+
+        if ((u32Ret == JF_ERR_NO_ERROR) && (pValue != &ls_pu64Key[u32Index]))
+            u32Ret = JF_ERR_INVALID_DATA;
+    }
+    u64Lookup = _getBtreeBenchTime() - u64Start;
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        u64Start = _getBtreeBenchTime();
+        u32Ret = _benchBtreeRange(u8Container);
+        u64Range = _getBtreeBenchTime() - u64Start;
+    }
+
+    /*Remove the keys in reverse order of insertion.*/
+    u64Start = _getBtreeBenchTime();
+    for (u32Index = ls_u32NumOfKey; (u32Index > 0) && (u32Ret == JF_ERR_NO_ERROR); u32Index --)
+    {
+        if (u8Container == BTREE_BENCH_CONTAINER_LIST)
+            u32Ret = _removeBtreeBenchList(ls_pu64Key[u32Index - 1]);
+        else
+            u32Ret = jf_btree_remove(ls_pjbTree, ls_pu64Key[u32Index - 1], NULL);
+    }
+    u64Remove = _getBtreeBenchTime() - u64Start;
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        if (((u8Container == BTREE_BENCH_CONTAINER_LIST) && (! jf_listhead_isEmpty(&ls_jlList))) ||
+            ((u8Container == BTREE_BENCH_CONTAINER_BTREE) && (jf_btree_getSize(ls_pjbTree) != 0)))
+        {
+            ol_printf("Container is not empty after all keys are removed\n");
+            u32Ret = JF_ERR_INVALID_DATA;
+        }
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        ol_printf(
+            "%-8s %10llu %10llu %10llu %10llu\n", ls_pstrContainer[u8Container],
+            u64Insert / 1000, u64Lookup / 1000, u64Range / 1000, u64Remove / 1000);
+
+    if (ls_pjbTree != NULL)
+        jf_btree_destroy(&ls_pjbTree);
+
+    return u32Ret;
+}
+
+static u32 _benchBtree(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_jiukun_cache_create_param_t jjccp;
+    u8 u8Container;
+
+    ol_bzero(&jjccp, sizeof(jjccp));
+    jjccp.jjccp_pstrName = BTREE_BENCH_CACHE;
+    jjccp.jjccp_sObj = sizeof(btree_bench_entry_t);
+
+    u32Ret = jf_jiukun_createCache(&ls_pjjcEntry, &jjccp);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = _generateBtreeBenchKey();
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ol_printf(
+            "keys: %u, ranges: %u, range length: %u\n", ls_u32NumOfKey, ls_u32NumOfRange,
+            ls_u32RangeLen);
+        ol_printf(
+            "%-8s %10s %10s %10s %10s\n", "type", "insert us", "lookup us", "range us",
+            "remove us");
+
+        for (u8Container = BTREE_BENCH_CONTAINER_LIST;
+             (u8Container <= BTREE_BENCH_CONTAINER_BTREE) && (u32Ret == JF_ERR_NO_ERROR);
+             u8Container ++)
+            u32Ret = _benchBtreeContainer(u8Container);
+    }
+
+    _freeBtreeBenchKey();
+
+    if (ls_pjjcEntry != NULL)
+        jf_jiukun_destroyCache(&ls_pjjcEntry);
+
+    return u32Ret;
+}
+
+/* --- public routine section ------------------------------------------------------------------- */
+
+olint_t main(olint_t argc, olchar_t ** argv)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    olchar_t strErrMsg[300];
+    jf_logger_init_param_t jlipParam;
+    jf_jiukun_init_param_t jjip;
+
+    ol_bzero(&jlipParam, sizeof(jlipParam));
+    jlipParam.jlip_pstrCallerName = BTREE_BENCH;
+    jlipParam.jlip_bLogToStdout = TRUE;
+    jlipParam.jlip_u8TraceLevel = JF_LOGGER_TRACE_LEVEL_ERROR;
+
+    ol_bzero(&jjip, sizeof(jjip));
+    jjip.jjip_sPool = JF_JIUKUN_MAX_POOL_SIZE;
+
+    u32Ret = _parseBtreeBenchCmdLineParam(argc, argv, &jlipParam);
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        jf_logger_init(&jlipParam);
+
+        u32Ret = jf_jiukun_init(&jjip);
+        if (u32Ret == JF_ERR_NO_ERROR)
+        {
+            u32Ret = _benchBtree();
+
+            jf_jiukun_fini();
+        }
+
+        jf_logger_fini();
+    }
+
+    if (u32Ret != JF_ERR_NO_ERROR)
+    {
+        jf_err_getMsg(u32Ret, strErrMsg, sizeof(strErrMsg));
+        ol_printf("%s\n", strErrMsg);
+    }
+
+    return u32Ret;
+}
+
+/*------------------------------------------------------------------------------------------------*/
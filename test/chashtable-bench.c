@@ -0,0 +1,659 @@
+/**
+ *  @file chashtable-bench.c
+ *
+ *  @brief Benchmark for comparing the concurrent hash table with the mutex protected hash table.
+ *
+ *  @author Min Zhang
+ *
+ *  @note
+ *  -# The baseline is the flat jf_hashtable protected by one mutex, it's how the hash table is
+ *   shared by threads before jf_chashtable.
+ *  -# The benchmark runs with 1, 2, 4 ... threads up to the maximum number of threads. Each
+ *   operation picks a random key, the operation is lookup by the read percentage, the rest are
+ *   insertion and removal in half.
+ *  -# The reader checks the key of the entry got from the hash table, the entry is poisoned when
+ *   it's freed, so a freed entry seen by the reader is reported.
+ *
+ */
+
+/* --- standard C lib header files -------------------------------------------------------------- */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+
+/* --- internal header files -------------------------------------------------------------------- */
+#include "jf_basic.h"
+#include "jf_limit.h"
+#include "jf_err.h"
+#include "jf_jiukun.h"
+#include "jf_option.h"
+#include "jf_thread.h"
+#include "jf_mutex.h"
+#include "jf_time.h"
+#include "jf_hashtable.h"
+#include "jf_chashtable.h"
+
+/* --- private data/data structure section ------------------------------------------------------ */
+
+#define CHASHTABLE_BENCH                        "CHASHTABLE-BENCH"
+
+#define CHASHTABLE_BENCH_DEFAULT_KEY            (100000)
+
+#define CHASHTABLE_BENCH_DEFAULT_OPERATION      (1000000)
+
+#define CHASHTABLE_BENCH_DEFAULT_READ           (90)
+
+#define CHASHTABLE_BENCH_DEFAULT_THREAD         (8)
+
+#define CHASHTABLE_BENCH_MAX_THREAD             (64)
+
+#define CHASHTABLE_BENCH_CACHE                  "chashtable-bench-entry"
+
+#define CHASHTABLE_BENCH_MAGIC                  (0x43484254)
+
+#define CHASHTABLE_BENCH_POISON                 (0xDEADBEEF)
+
+typedef enum
+{
+    CHASHTABLE_BENCH_TABLE_MUTEX = 0,
+    CHASHTABLE_BENCH_TABLE_CONCURRENT,
+} chashtable_bench_table_t;
+
+/** The entry in hash table.
+ */
+typedef struct
+{
+    u32 cbe_u32Key;
+    u32 cbe_u32Magic;
+} chashtable_bench_entry_t;
+
+/** Benchmark thread.
+ */
+typedef struct
+{
+    jf_thread_id_t cbt_jtiThread;
+    u32 cbt_u32Index;
+    u32 cbt_u32Ret;
+    /**Seed of the PRNG.*/
+    u32 cbt_u32Seed;
+    /**Number of entries found by lookup.*/
+    u32 cbt_u32Hit;
+    /**Number of lookup.*/
+    u64 cbt_u64Read;
+    /**Number of insertion and removal.*/
+    u64 cbt_u64Write;
+} chashtable_bench_thread_t;
+
+static olchar_t * ls_pstrTable[] =
+{
+    "mutex",
+    "concurrent",
+};
+
+static u8 ls_u8Table = CHASHTABLE_BENCH_TABLE_MUTEX;
+
+static u32 ls_u32NumOfKey = CHASHTABLE_BENCH_DEFAULT_KEY;
+
+static u32 ls_u32NumOfOperation = CHASHTABLE_BENCH_DEFAULT_OPERATION;
+
+static u32 ls_u32ReadPercent = CHASHTABLE_BENCH_DEFAULT_READ;
+
+static u32 ls_u32MaxThread = CHASHTABLE_BENCH_DEFAULT_THREAD;
+
+static boolean_t ls_bGrow = FALSE;
+
+static u32 ls_u32NumOfThread = 0;
+
+static jf_jiukun_cache_t * ls_pjjcEntry = NULL;
+
+static jf_mutex_t ls_jmTable;
+
+static jf_hashtable_t * ls_pjhTable = NULL;
+
+static jf_chashtable_t * ls_pjcTable = NULL;
+
+static chashtable_bench_thread_t ls_cbtThread[CHASHTABLE_BENCH_MAX_THREAD];
+
+/* --- private routine section ------------------------------------------------------------------ */
+
+static void _printChashtableBenchUsage(void)
+{
+    ol_printf("\
+Usage: chashtable-bench [-n keys] [-o operations] [-r read percent] [-t threads] [-g]\n\
+    [-h] [logger options] \n\
+    -n number of keys, %u by default, half of the keys are inserted before benchmark.\n\
+    -o number of operations per thread, %u by default.\n\
+    -r percentage of lookup, %u by default, the rest are insertion and removal.\n\
+    -t maximum number of threads, %u by default.\n\
+    -g start with empty hash table of the minimal size, the hash table grows during benchmark.\n\
+    -h print the usage.\n\
+logger options:\n\
+    -T <0|1|2|3|4> the log level. 0: no log, 1: error, 2: info, 3: debug, 4: data.\n\
+    -F <log file> the log file.\n\
+    -S <log file size> the size of log file. No limit if not specified.\n\
+    ", CHASHTABLE_BENCH_DEFAULT_KEY, CHASHTABLE_BENCH_DEFAULT_OPERATION,
+           CHASHTABLE_BENCH_DEFAULT_READ, CHASHTABLE_BENCH_DEFAULT_THREAD);
+
+    ol_printf("\n");
+
+    exit(0);
+}
+
+static u32 _parseChashtableBenchCmdLineParam(
+    olint_t argc, olchar_t ** argv, jf_logger_init_param_t * pjlip)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    olint_t nOpt;
+
+    while (((nOpt = getopt(argc, argv, "n:o:r:t:gT:F:S:h")) != -1) &&
+           (u32Ret == JF_ERR_NO_ERROR))
+    {
+        switch (nOpt)
+        {
+        case '?':
+        case 'h':
+            _printChashtableBenchUsage();
+            break;
+        case ':':
+            u32Ret = JF_ERR_MISSING_PARAM;
+            break;
+        case 'n':
+            u32Ret = jf_option_getU32FromString(optarg, &ls_u32NumOfKey);
+            if ((u32Ret == JF_ERR_NO_ERROR) && (ls_u32NumOfKey == 0))
+                u32Ret = JF_ERR_INVALID_PARAM;
+            break;
+        case 'o':
+            u32Ret = jf_option_getU32FromString(optarg, &ls_u32NumOfOperation);
+            if ((u32Ret == JF_ERR_NO_ERROR) && (ls_u32NumOfOperation == 0))
+                u32Ret = JF_ERR_INVALID_PARAM;
+            break;
+        case 'r':
+            u32Ret = jf_option_getU32FromString(optarg, &ls_u32ReadPercent);
+            if ((u32Ret == JF_ERR_NO_ERROR) && (ls_u32ReadPercent > 100))
+                u32Ret = JF_ERR_INVALID_PARAM;
+            break;
+        case 't':
+            u32Ret = jf_option_getU32FromString(optarg, &ls_u32MaxThread);
+            if ((u32Ret == JF_ERR_NO_ERROR) &&
+                ((ls_u32MaxThread == 0) || (ls_u32MaxThread > CHASHTABLE_BENCH_MAX_THREAD)))
+                u32Ret = JF_ERR_INVALID_PARAM;
+            break;
+        case 'g':
+            ls_bGrow = TRUE;
+            break;
+        case 'T':
+            u32Ret = jf_option_getU8FromString(optarg, &pjlip->jlip_u8TraceLevel);
+            break;
+        case 'F':
+            pjlip->jlip_bLogToFile = TRUE;
+            pjlip->jlip_pstrLogFilePath = optarg;
+            break;
+        case 'S':
+            u32Ret = jf_option_getS32FromString(optarg, &pjlip->jlip_sLogFile);
+            break;
+        default:
+            u32Ret = JF_ERR_INVALID_OPTION;
+            break;
+        }
+    }
+
+    return u32Ret;
+}
+
+/** Xorshift PRNG, each thread has its own seed.
+ */
+static u32 _getChashtableBenchRand(chashtable_bench_thread_t * pcbt)
+{
+    pcbt->cbt_u32Seed ^= pcbt->cbt_u32Seed << 13;
+    pcbt->cbt_u32Seed ^= pcbt->cbt_u32Seed >> 17;
+    pcbt->cbt_u32Seed ^= pcbt->cbt_u32Seed << 5;
+
+    return pcbt->cbt_u32Seed;
+}
+
+static u64 _getChashtableBenchTime(void)
+{
+    struct timespec ts;
+
+    jf_time_getClockTime(CLOCK_MONOTONIC, &ts);
+
+    return (u64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void * _getKeyFromChashtableBenchEntry(void * pEntry)
+{
+    chashtable_bench_entry_t * pcbe = pEntry;
+
+    return (void *)(ulong)pcbe->cbe_u32Key;
+}
+
+static u32 _freeChashtableBenchEntry(void ** ppEntry)
+{
+    chashtable_bench_entry_t * pcbe = *ppEntry;
+
+    /*Poison the entry so the reader accessing freed entry can be detected.*/
+    pcbe->cbe_u32Magic = CHASHTABLE_BENCH_POISON;
+    jf_jiukun_freeObject(ls_pjjcEntry, ppEntry);
+
+    return JF_ERR_NO_ERROR;
+}
+
+static u32 _newChashtableBenchEntry(u32 u32Key, chashtable_bench_entry_t ** ppEntry)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    chashtable_bench_entry_t * pcbe = NULL;
+
+    u32Ret = jf_jiukun_allocObject(ls_pjjcEntry, (void **)&pcbe);
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        pcbe->cbe_u32Key = u32Key;
+        pcbe->cbe_u32Magic = CHASHTABLE_BENCH_MAGIC;
+        *ppEntry = pcbe;
+    }
+
+    return u32Ret;
+}
+
+static u32 _checkChashtableBenchEntry(chashtable_bench_entry_t * pcbe, u32 u32Key)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+
+    if ((pcbe->cbe_u32Key != u32Key) || (pcbe->cbe_u32Magic != CHASHTABLE_BENCH_MAGIC))
+    {
+        ol_printf(
+            "Invalid entry, key %u, expected %u, magic 0x%x\n", pcbe->cbe_u32Key, u32Key,
+            pcbe->cbe_u32Magic);
+        u32Ret = JF_ERR_INVALID_DATA;
+    }
+
+    return u32Ret;
+}
+
+static u32 _readMutexTable(chashtable_bench_thread_t * pcbt, u32 u32Key)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    chashtable_bench_entry_t * pcbe = NULL;
+
+    jf_mutex_acquire(&ls_jmTable);
+    if (jf_hashtable_getEntry(ls_pjhTable, (void *)(ulong)u32Key, (void **)&pcbe) ==
+        JF_ERR_NO_ERROR)
+    {
+        u32Ret = _checkChashtableBenchEntry(pcbe, u32Key);
+        pcbt->cbt_u32Hit ++;
+    }
+    jf_mutex_release(&ls_jmTable);
+
+    return u32Ret;
+}
+
+static u32 _insertMutexTable(u32 u32Key)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    chashtable_bench_entry_t * pcbe = NULL;
+
+    u32Ret = _newChashtableBenchEntry(u32Key, &pcbe);
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        jf_mutex_acquire(&ls_jmTable);
+        if (jf_hashtable_isKeyInTable(ls_pjhTable, (void *)(ulong)u32Key))
+            u32Ret = JF_ERR_HASH_ENTRY_EXIST;
+        else
+            u32Ret = jf_hashtable_insertEntry(ls_pjhTable, pcbe);
+        jf_mutex_release(&ls_jmTable);
+
+        if (u32Ret != JF_ERR_NO_ERROR)
+            _freeChashtableBenchEntry((void **)&pcbe);
+    }
+
+    if (u32Ret == JF_ERR_HASH_ENTRY_EXIST)
+        u32Ret = JF_ERR_NO_ERROR;
+
+    return u32Ret;
+}
+
+static u32 _removeMutexTable(u32 u32Key)
+{
+    chashtable_bench_entry_t cbe;
+
+    /*The entry is only used to get the key, the entry in hash table is freed.*/
+    cbe.cbe_u32Key = u32Key;
+
+    jf_mutex_acquire(&ls_jmTable);
+    jf_hashtable_removeEntry(ls_pjhTable, &cbe);
+    jf_mutex_release(&ls_jmTable);
+
+    return JF_ERR_NO_ERROR;
+}
+
+static u32 _readConcurrentTable(chashtable_bench_thread_t * pcbt, u32 u32Key)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    chashtable_bench_entry_t * pcbe = NULL;
+    u32 u32Token;
+
+    u32Token = jf_chashtable_enterRead(ls_pjcTable);
+    if (jf_chashtable_getEntry(ls_pjcTable, (void *)(ulong)u32Key, (void **)&pcbe) ==
+        JF_ERR_NO_ERROR)
+    {
+        u32Ret = _checkChashtableBenchEntry(pcbe, u32Key);
+        pcbt->cbt_u32Hit ++;
+    }
+    jf_chashtable_leaveRead(ls_pjcTable, u32Token);
+
+    return u32Ret;
+}
+
+static u32 _insertConcurrentTable(u32 u32Key)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    chashtable_bench_entry_t * pcbe = NULL;
+
+    u32Ret = _newChashtableBenchEntry(u32Key, &pcbe);
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        u32Ret = jf_chashtable_insertEntry(ls_pjcTable, pcbe);
+        if (u32Ret != JF_ERR_NO_ERROR)
+            _freeChashtableBenchEntry((void **)&pcbe);
+    }
+
+    if (u32Ret == JF_ERR_HASH_ENTRY_EXIST)
+        u32Ret = JF_ERR_NO_ERROR;
+
+    return u32Ret;
+}
+
+static u32 _removeConcurrentTable(u32 u32Key)
+{
+    jf_chashtable_removeEntry(ls_pjcTable, (void *)(ulong)u32Key);
+
+    return JF_ERR_NO_ERROR;
+}
+
+static JF_THREAD_RETURN_VALUE _benchChashtableThread(void * pArg)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    chashtable_bench_thread_t * pcbt = pArg;
+    u32 u32Index, u32Rand, u32Key;
+
+    for (u32Index = 0; (u32Index < ls_u32NumOfOperation) && (u32Ret == JF_ERR_NO_ERROR);
+         u32Index ++)
+    {
+        u32Rand = _getChashtableBenchRand(pcbt);
+        u32Key = u32Rand % ls_u32NumOfKey + 1;
+        u32Rand = (u32Rand >> 16) % 200;
+
+        if (u32Rand < ls_u32ReadPercent * 2)
+        {
+            if (ls_u8Table == CHASHTABLE_BENCH_TABLE_MUTEX)
+                u32Ret = _readMutexTable(pcbt, u32Key);
+            else
+                u32Ret = _readConcurrentTable(pcbt, u32Key);
+
+            pcbt->cbt_u64Read ++;
+        }
+        else
+        {
+            /*Half of the writes are insertion.*/
+            if (ls_u8Table == CHASHTABLE_BENCH_TABLE_MUTEX)
+                u32Ret = (u32Rand & 0x1) ? _insertMutexTable(u32Key) : _removeMutexTable(u32Key);
+            else
+                u32Ret = (u32Rand & 0x1) ?
+                    _insertConcurrentTable(u32Key) : _removeConcurrentTable(u32Key);
+
+            pcbt->cbt_u64Write ++;
+        }
+    }
+
+    pcbt->cbt_u32Ret = u32Ret;
+
+    JF_THREAD_RETURN(u32Ret);
+}
+
+static u32 _createChashtableBenchTable(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_hashtable_create_param_t jhcp;
+    jf_chashtable_create_param_t jccp;
+    u32 u32Key;
+
+    if (ls_u8Table == CHASHTABLE_BENCH_TABLE_MUTEX)
+    {
+        ol_bzero(&jhcp, sizeof(jhcp));
+        jhcp.jhcp_u32MinSize = ls_bGrow ? 0 : ls_u32NumOfKey / 2;
+        jhcp.jhcp_u8Type = JF_HASHTABLE_TYPE_FLAT;
+        jhcp.jhcp_u8KeyType = JF_HASHTABLE_KEY_TYPE_U32;
+        jhcp.jhcp_fnGetKeyFromEntry = _getKeyFromChashtableBenchEntry;
+        jhcp.jhcp_fnFreeEntry = _freeChashtableBenchEntry;
+
+        u32Ret = jf_hashtable_create(&ls_pjhTable, &jhcp);
+    }
+    else
+    {
+        ol_bzero(&jccp, sizeof(jccp));
+        jccp.jccp_u32MinSize = ls_bGrow ? 0 : ls_u32NumOfKey / 2;
+        jccp.jccp_u8KeyType = JF_HASHTABLE_KEY_TYPE_U32;
+        jccp.jccp_fnGetKeyFromEntry = _getKeyFromChashtableBenchEntry;
+        jccp.jccp_fnFreeEntry = _freeChashtableBenchEntry;
+
+        u32Ret = jf_chashtable_create(&ls_pjcTable, &jccp);
+    }
+
+    /*Insert half of the keys.*/
+    for (u32Key = 1; (u32Key <= ls_u32NumOfKey) && (! ls_bGrow) && (u32Ret == JF_ERR_NO_ERROR);
+         u32Key += 2)
+    {
+        if (ls_u8Table == CHASHTABLE_BENCH_TABLE_MUTEX)
+            u32Ret = _insertMutexTable(u32Key);
+        else
+            u32Ret = _insertConcurrentTable(u32Key);
+    }
+
+    return u32Ret;
+}
+
+/** Check the number of entries got by lookup equals to the size of the hash table.
+ */
+static u32 _verifyChashtableBenchTable(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Key, u32Count = 0, u32Size;
+
+    for (u32Key = 1; u32Key <= ls_u32NumOfKey; u32Key ++)
+    {
+        if (ls_u8Table == CHASHTABLE_BENCH_TABLE_MUTEX)
+            u32Count += jf_hashtable_isKeyInTable(ls_pjhTable, (void *)(ulong)u32Key) ? 1 : 0;
+        else
+            u32Count += jf_chashtable_isKeyInTable(ls_pjcTable, (void *)(ulong)u32Key) ? 1 : 0;
+    }
+
+    if (ls_u8Table == CHASHTABLE_BENCH_TABLE_MUTEX)
+        u32Size = jf_hashtable_getSize(ls_pjhTable);
+    else
+        u32Size = jf_chashtable_getSize(ls_pjcTable);
+
+    if (u32Count != u32Size)
+    {
+        ol_printf("Size of hash table is %u, %u keys are found\n", u32Size, u32Count);
+        u32Ret = JF_ERR_INVALID_DATA;
+    }
+
+    return u32Ret;
+}
+
+static void _destroyChashtableBenchTable(void)
+{
+    if (ls_pjhTable != NULL)
+        jf_hashtable_destroy(&ls_pjhTable);
+
+    if (ls_pjcTable != NULL)
+        jf_chashtable_destroy(&ls_pjcTable);
+}
+
+static void _printChashtableBenchResult(u64 u64Time)
+{
+    u64 u64Read = 0, u64Write = 0;
+    u32 u32Index, u32Hit = 0;
+    jf_chashtable_stat_t jcs;
+
+    for (u32Index = 0; u32Index < ls_u32NumOfThread; u32Index ++)
+    {
+        u64Read += ls_cbtThread[u32Index].cbt_u64Read;
+        u64Write += ls_cbtThread[u32Index].cbt_u64Write;
+        u32Hit += ls_cbtThread[u32Index].cbt_u32Hit;
+    }
+
+    ol_printf(
+        "%-10s %7u %12llu %12llu %8llu %14llu", ls_pstrTable[ls_u8Table], ls_u32NumOfThread,
+        u64Read, u64Write, u64Time / 1000000,
+        (u64Time > 0) ? (u64Read + u64Write) * 1000000000 / u64Time : 0);
+
+    if (ls_u8Table == CHASHTABLE_BENCH_TABLE_CONCURRENT)
+    {
+        jf_chashtable_getStat(ls_pjcTable, &jcs);
+        ol_printf(
+            "   (hit %u, size %u, resize %u, grace period %llu)", u32Hit, jcs.jcs_u32Size,
+            jcs.jcs_u32CountOfResizeOp, jcs.jcs_u64GracePeriod);
+    }
+    else
+    {
+        ol_printf("   (hit %u)", u32Hit);
+    }
+
+    ol_printf("\n");
+}
+
+static u32 _benchChashtable(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Index, u32RetCode, u32NumOfThread = 0;
+    u64 u64Start, u64Time;
+
+    ol_bzero(ls_cbtThread, sizeof(ls_cbtThread));
+
+    u32Ret = _createChashtableBenchTable();
+
+    u64Start = _getChashtableBenchTime();
+
+    for (u32Index = 0; (u32Index < ls_u32NumOfThread) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+    {
+        ls_cbtThread[u32Index].cbt_u32Index = u32Index;
+        ls_cbtThread[u32Index].cbt_u32Seed = 0x43484231 + u32Index * 0x9E3779B9;
+
+        u32Ret = jf_thread_create(
+            &ls_cbtThread[u32Index].cbt_jtiThread, NULL, _benchChashtableThread,
+            &ls_cbtThread[u32Index]);
+        if (u32Ret == JF_ERR_NO_ERROR)
+            u32NumOfThread ++;
+    }
+
+    for (u32Index = 0; u32Index < u32NumOfThread; u32Index ++)
+    {
+        jf_thread_waitForThreadTermination(ls_cbtThread[u32Index].cbt_jtiThread, &u32RetCode);
+        if ((u32Ret == JF_ERR_NO_ERROR) && (ls_cbtThread[u32Index].cbt_u32Ret != JF_ERR_NO_ERROR))
+            u32Ret = ls_cbtThread[u32Index].cbt_u32Ret;
+    }
+
+    u64Time = _getChashtableBenchTime() - u64Start;
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = _verifyChashtableBenchTable();
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        _printChashtableBenchResult(u64Time);
+
+    _destroyChashtableBenchTable();
+
+    return u32Ret;
+}
+
+static u32 _benchChashtableAll(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_jiukun_cache_create_param_t jjccp;
+    u8 u8Table;
+
+    ol_bzero(&jjccp, sizeof(jjccp));
+    jjccp.jjccp_pstrName = CHASHTABLE_BENCH_CACHE;
+    jjccp.jjccp_sObj = sizeof(chashtable_bench_entry_t);
+
+    u32Ret = jf_jiukun_createCache(&ls_pjjcEntry, &jjccp);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = jf_mutex_init(&ls_jmTable);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ol_printf(
+            "keys: %u, operations per thread: %u, read: %u%%\n", ls_u32NumOfKey,
+            ls_u32NumOfOperation, ls_u32ReadPercent);
+        ol_printf(
+            "%-10s %7s %12s %12s %8s %14s\n", "table", "threads", "reads", "writes", "ms",
+            "ops/s");
+
+        for (ls_u32NumOfThread = 1;
+             (ls_u32NumOfThread <= ls_u32MaxThread) && (u32Ret == JF_ERR_NO_ERROR);
+             ls_u32NumOfThread *= 2)
+        {
+            for (u8Table = CHASHTABLE_BENCH_TABLE_MUTEX;
+                 (u8Table <= CHASHTABLE_BENCH_TABLE_CONCURRENT) && (u32Ret == JF_ERR_NO_ERROR);
+                 u8Table ++)
+            {
+                ls_u8Table = u8Table;
+                u32Ret = _benchChashtable();
+            }
+        }
+
+        jf_mutex_fini(&ls_jmTable);
+    }
+
+    if (ls_pjjcEntry != NULL)
+        jf_jiukun_destroyCache(&ls_pjjcEntry);
+
+    return u32Ret;
+}
+
+/* --- public routine section ------------------------------------------------------------------- */
+
+olint_t main(olint_t argc, olchar_t ** argv)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    olchar_t strErrMsg[300];
+    jf_logger_init_param_t jlipParam;
+    jf_jiukun_init_param_t jjip;
+
+    ol_bzero(&jlipParam, sizeof(jlipParam));
+    jlipParam.jlip_pstrCallerName = CHASHTABLE_BENCH;
+    jlipParam.jlip_bLogToStdout = TRUE;
+    jlipParam.jlip_u8TraceLevel = JF_LOGGER_TRACE_LEVEL_ERROR;
+
+    ol_bzero(&jjip, sizeof(jjip));
+    jjip.jjip_sPool = JF_JIUKUN_MAX_POOL_SIZE;
+
+    u32Ret = _parseChashtableBenchCmdLineParam(argc, argv, &jlipParam);
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        jf_logger_init(&jlipParam);
+
+        u32Ret = jf_jiukun_init(&jjip);
+        if (u32Ret == JF_ERR_NO_ERROR)
+        {
+            u32Ret = _benchChashtableAll();
+
+            jf_jiukun_fini();
+        }
+
+        jf_logger_fini();
+    }
+
+    if (u32Ret != JF_ERR_NO_ERROR)
+    {
+        jf_err_getMsg(u32Ret, strErrMsg, sizeof(strErrMsg));
+        ol_printf("%s\n", strErrMsg);
+    }
+
+    return u32Ret;
+}
+
+/*------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,552 @@
+/**
+ *  @file chashtable-test.c
+ *
+ *  @brief Test file for concurrent hash table defined in jf_chashtable object.
+ *
+ *  @author Min Zhang
+ *
+ *  @note
+ *  -# The hash table starts with the minimal size and grows while the threads insert, overwrite
+ *   and remove entries, so the writes and lookups run with the buckets being moved.
+ *  -# Each thread owns a set of keys and remembers which of them are in the hash table, so the
+ *   result of every write and lookup of the thread's own keys is known. The thread also looks up
+ *   the keys of other threads and checks the entry found, the entry is poisoned when it's freed.
+ *  -# The content of the hash table is checked against the threads' records after the threads
+ *   quit.
+ *
+ */
+
+/* --- standard C lib header files -------------------------------------------------------------- */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+/* --- internal header files -------------------------------------------------------------------- */
+#include "jf_basic.h"
+#include "jf_limit.h"
+#include "jf_err.h"
+#include "jf_jiukun.h"
+#include "jf_option.h"
+#include "jf_thread.h"
+#include "jf_hashtable.h"
+#include "jf_chashtable.h"
+
+/* --- private data/data structure section ------------------------------------------------------ */
+
+#define CHASHTABLE_TEST_MAX_THREAD               (64)
+
+#define CHASHTABLE_TEST_DEFAULT_THREAD           (4)
+
+#define CHASHTABLE_TEST_DEFAULT_KEY              (65536)
+
+#define CHASHTABLE_TEST_DEFAULT_OPERATION        (200000)
+
+#define CHASHTABLE_TEST_CACHE                    "chashtable-test-entry"
+
+#define CHASHTABLE_TEST_MAGIC                    (0x43485453)
+
+#define CHASHTABLE_TEST_POISON                   (0xDEADBEEF)
+
+/** The entry in hash table.
+ */
+typedef struct
+{
+    u32 cte_u32Key;
+    volatile u32 cte_u32Magic;
+    /**Version of the entry, it's increased when the entry is overwritten.*/
+    u32 cte_u32Version;
+    u32 cte_u32Reserved;
+} chashtable_test_entry_t;
+
+/** The test thread.
+ */
+typedef struct
+{
+    jf_thread_id_t ctt_jtiThread;
+    u32 ctt_u32Index;
+    u32 ctt_u32Ret;
+    /**Seed of the PRNG.*/
+    u32 ctt_u32Seed;
+    /**Number of keys owned by the thread.*/
+    u32 ctt_u32NumOfKey;
+    /**The version of the key in hash table, 0 means the key is not in hash table.*/
+    u32 * ctt_pu32Version;
+    u64 ctt_u64Insert;
+    u64 ctt_u64Overwrite;
+    u64 ctt_u64Remove;
+    u64 ctt_u64Read;
+} chashtable_test_thread_t;
+
+static u32 ls_u32NumOfThread = CHASHTABLE_TEST_DEFAULT_THREAD;
+
+static u32 ls_u32NumOfKey = CHASHTABLE_TEST_DEFAULT_KEY;
+
+static u32 ls_u32NumOfOperation = CHASHTABLE_TEST_DEFAULT_OPERATION;
+
+static jf_jiukun_cache_t * ls_pjjcEntry = NULL;
+
+static jf_chashtable_t * ls_pjcTable = NULL;
+
+static chashtable_test_thread_t ls_cttThread[CHASHTABLE_TEST_MAX_THREAD];
+
+/* --- private routine section ------------------------------------------------------------------ */
+
+static void _printChashtableTestUsage(void)
+{
+    ol_printf("\
+Usage: chashtable-test [-t <threads>] [-n <keys>] [-o <operations>] \n\
+    [-T <trace level>] [-F <trace log file>] [-S <trace file size>]\n\
+  -t number of threads, default %u.\n\
+  -n number of keys, default %u.\n\
+  -o number of operations per thread, default %u.\n",
+        CHASHTABLE_TEST_DEFAULT_THREAD, CHASHTABLE_TEST_DEFAULT_KEY,
+        CHASHTABLE_TEST_DEFAULT_OPERATION);
+
+    ol_printf("\n");
+}
+
+static u32 _parseChashtableTestCmdLineParam(
+    olint_t argc, olchar_t ** argv, jf_logger_init_param_t * pjlip)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    olint_t nOpt;
+
+    while (((nOpt = getopt(argc, argv, "t:n:o:T:F:S:h")) != -1) &&
+           (u32Ret == JF_ERR_NO_ERROR))
+    {
+        switch (nOpt)
+        {
+        case '?':
+        case 'h':
+            _printChashtableTestUsage();
+            exit(0);
+            break;
+        case 't':
+            u32Ret = jf_option_getU32FromString(optarg, &ls_u32NumOfThread);
+            if ((u32Ret == JF_ERR_NO_ERROR) &&
+                ((ls_u32NumOfThread == 0) || (ls_u32NumOfThread > CHASHTABLE_TEST_MAX_THREAD)))
+                u32Ret = JF_ERR_INVALID_PARAM;
+            break;
+        case 'n':
+            u32Ret = jf_option_getU32FromString(optarg, &ls_u32NumOfKey);
+            break;
+        case 'o':
+            u32Ret = jf_option_getU32FromString(optarg, &ls_u32NumOfOperation);
+            break;
+        case 'T':
+            u32Ret = jf_option_getU8FromString(optarg, &pjlip->jlip_u8TraceLevel);
+            break;
+        case 'F':
+            pjlip->jlip_bLogToFile = TRUE;
+            pjlip->jlip_pstrLogFilePath = optarg;
+            break;
+        case 'S':
+            u32Ret = jf_option_getS32FromString(optarg, &pjlip->jlip_sLogFile);
+            break;
+        default:
+            u32Ret = JF_ERR_INVALID_OPTION;
+            break;
+        }
+    }
+
+    if ((u32Ret == JF_ERR_NO_ERROR) && (ls_u32NumOfKey < ls_u32NumOfThread))
+        u32Ret = JF_ERR_INVALID_PARAM;
+
+    return u32Ret;
+}
+
+/** Xorshift PRNG, each thread has its own seed.
+ */
+static u32 _getChashtableTestRand(chashtable_test_thread_t * pctt)
+{
+    pctt->ctt_u32Seed ^= pctt->ctt_u32Seed << 13;
+    pctt->ctt_u32Seed ^= pctt->ctt_u32Seed >> 17;
+    pctt->ctt_u32Seed ^= pctt->ctt_u32Seed << 5;
+
+    return pctt->ctt_u32Seed;
+}
+
+/** The key owned by the thread, the keys are interleaved among the threads.
+ */
+static inline u32 _getChashtableTestKey(u32 u32Thread, u32 u32Index)
+{
+    return u32Index * ls_u32NumOfThread + u32Thread + 1;
+}
+
+static void * _getKeyFromChashtableTestEntry(void * pEntry)
+{
+    chashtable_test_entry_t * pcte = pEntry;
+
+    return (void *)(ulong)pcte->cte_u32Key;
+}
+
+static u32 _freeChashtableTestEntry(void ** ppEntry)
+{
+    chashtable_test_entry_t * pcte = *ppEntry;
+
+    /*Poison the entry so the reader accessing freed entry can be detected.*/
+    pcte->cte_u32Magic = CHASHTABLE_TEST_POISON;
+    jf_jiukun_freeObject(ls_pjjcEntry, ppEntry);
+
+    return JF_ERR_NO_ERROR;
+}
+
+static u32 _newChashtableTestEntry(u32 u32Key, u32 u32Version, chashtable_test_entry_t ** ppEntry)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    chashtable_test_entry_t * pcte = NULL;
+
+    u32Ret = jf_jiukun_allocObject(ls_pjjcEntry, (void **)&pcte);
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        pcte->cte_u32Key = u32Key;
+        pcte->cte_u32Magic = CHASHTABLE_TEST_MAGIC;
+        pcte->cte_u32Version = u32Version;
+        *ppEntry = pcte;
+    }
+
+    return u32Ret;
+}
+
+/** Look up the key, the version is checked if it's not 0, the version 0 means the key is not
+ *  owned by the thread and any version is accepted.
+ */
+static u32 _readChashtableTestKey(u32 u32Key, boolean_t bOwned, u32 u32Version)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    chashtable_test_entry_t * pcte = NULL;
+    u32 u32Token;
+
+    u32Token = jf_chashtable_enterRead(ls_pjcTable);
+
+    if (jf_chashtable_getEntry(ls_pjcTable, (void *)(ulong)u32Key, (void **)&pcte) ==
+        JF_ERR_NO_ERROR)
+    {
+        if ((pcte->cte_u32Key != u32Key) || (pcte->cte_u32Magic != CHASHTABLE_TEST_MAGIC))
+        {
+            ol_printf(
+                "Invalid entry, key %u, expected %u, magic 0x%x\n", pcte->cte_u32Key, u32Key,
+                pcte->cte_u32Magic);
+            u32Ret = JF_ERR_INVALID_DATA;
+        }
+        else if (bOwned && (pcte->cte_u32Version != u32Version))
+        {
+            ol_printf(
+                "Wrong entry, key %u, version %u, expected %u\n", u32Key, pcte->cte_u32Version,
+                u32Version);
+            u32Ret = JF_ERR_INVALID_DATA;
+        }
+    }
+    else if (bOwned && (u32Version != 0))
+    {
+        ol_printf("Key %u is not found\n", u32Key);
+        u32Ret = JF_ERR_INVALID_DATA;
+    }
+
+    jf_chashtable_leaveRead(ls_pjcTable, u32Token);
+
+    return u32Ret;
+}
+
+/** Insert or overwrite the key owned by the thread, the return code is checked with the record.
+ */
+static u32 _writeChashtableTestKey(
+    chashtable_test_thread_t * pctt, u32 u32Index, boolean_t bOverwrite)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Key = _getChashtableTestKey(pctt->ctt_u32Index, u32Index);
+    u32 u32Version = pctt->ctt_pu32Version[u32Index];
+    chashtable_test_entry_t * pcte = NULL;
+
+    u32Ret = _newChashtableTestEntry(u32Key, u32Version + 1, &pcte);
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        if (bOverwrite)
+            u32Ret = jf_chashtable_overwriteEntry(ls_pjcTable, pcte);
+        else
+            u32Ret = jf_chashtable_insertEntry(ls_pjcTable, pcte);
+
+        if (u32Ret == JF_ERR_NO_ERROR)
+        {
+            if (! bOverwrite && (u32Version != 0))
+            {
+                ol_printf("Key %u is inserted twice\n", u32Key);
+                u32Ret = JF_ERR_INVALID_DATA;
+            }
+
+            pctt->ctt_pu32Version[u32Index] = u32Version + 1;
+        }
+        else
+        {
+            _freeChashtableTestEntry((void **)&pcte);
+
+            if ((u32Ret == JF_ERR_HASH_ENTRY_EXIST) && ! bOverwrite && (u32Version != 0))
+                u32Ret = JF_ERR_NO_ERROR;
+            else
+                ol_printf("Failed to write key %u, version %u\n", u32Key, u32Version);
+        }
+    }
+
+    return u32Ret;
+}
+
+/** Remove the key owned by the thread, the return code is checked with the record.
+ */
+static u32 _removeChashtableTestKey(chashtable_test_thread_t * pctt, u32 u32Index)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Key = _getChashtableTestKey(pctt->ctt_u32Index, u32Index);
+
+    u32Ret = jf_chashtable_removeEntry(ls_pjcTable, (void *)(ulong)u32Key);
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        if (pctt->ctt_pu32Version[u32Index] == 0)
+        {
+            ol_printf("Key %u is removed but it's not inserted\n", u32Key);
+            u32Ret = JF_ERR_INVALID_DATA;
+        }
+
+        pctt->ctt_pu32Version[u32Index] = 0;
+    }
+    else if ((u32Ret == JF_ERR_HASH_ENTRY_NOT_FOUND) && (pctt->ctt_pu32Version[u32Index] == 0))
+    {
+        u32Ret = JF_ERR_NO_ERROR;
+    }
+    else
+    {
+        ol_printf("Failed to remove key %u\n", u32Key);
+    }
+
+    return u32Ret;
+}
+
+/** The writes are more than removals, so the hash table keeps growing.
+ */
+static JF_THREAD_RETURN_VALUE _testChashtableThread(void * pArg)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    chashtable_test_thread_t * pctt = pArg;
+    u32 u32Op, u32Rand, u32Index, u32Key;
+
+    for (u32Op = 0; (u32Op < ls_u32NumOfOperation) && (u32Ret == JF_ERR_NO_ERROR); u32Op ++)
+    {
+        u32Rand = _getChashtableTestRand(pctt);
+        u32Index = (u32Rand >> 8) % pctt->ctt_u32NumOfKey;
+
+        switch (u32Rand % 10)
+        {
+        case 0:
+        case 1:
+        case 2:
+            u32Ret = _writeChashtableTestKey(pctt, u32Index, FALSE);
+            pctt->ctt_u64Insert ++;
+            break;
+        case 3:
+            u32Ret = _writeChashtableTestKey(pctt, u32Index, TRUE);
+            pctt->ctt_u64Overwrite ++;
+            break;
+        case 4:
+        case 5:
+            u32Ret = _removeChashtableTestKey(pctt, u32Index);
+            pctt->ctt_u64Remove ++;
+            break;
+        case 6:
+        case 7:
+            u32Key = _getChashtableTestKey(pctt->ctt_u32Index, u32Index);
+            u32Ret = _readChashtableTestKey(u32Key, TRUE, pctt->ctt_pu32Version[u32Index]);
+            pctt->ctt_u64Read ++;
+            break;
+        default:
+            /*The key may be owned by other thread.*/
+            u32Key = (u32Rand >> 8) % ls_u32NumOfKey + 1;
+            u32Ret = _readChashtableTestKey(u32Key, FALSE, 0);
+            pctt->ctt_u64Read ++;
+            break;
+        }
+    }
+
+    pctt->ctt_u32Ret = u32Ret;
+
+    JF_THREAD_RETURN(u32Ret);
+}
+
+/** Check the hash table with the records of the threads.
+ */
+static u32 _verifyChashtableTest(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    chashtable_test_thread_t * pctt;
+    u32 u32Thread, u32Index, u32Key, u32Count = 0, u32Size;
+
+    for (u32Thread = 0; (u32Thread < ls_u32NumOfThread) && (u32Ret == JF_ERR_NO_ERROR);
+         u32Thread ++)
+    {
+        pctt = &ls_cttThread[u32Thread];
+
+        for (u32Index = 0; (u32Index < pctt->ctt_u32NumOfKey) && (u32Ret == JF_ERR_NO_ERROR);
+             u32Index ++)
+        {
+            u32Key = _getChashtableTestKey(u32Thread, u32Index);
+
+            if (jf_chashtable_isKeyInTable(ls_pjcTable, (void *)(ulong)u32Key) !=
+                (pctt->ctt_pu32Version[u32Index] != 0))
+            {
+                ol_printf("Key %u, version %u\n", u32Key, pctt->ctt_pu32Version[u32Index]);
+                u32Ret = JF_ERR_INVALID_DATA;
+            }
+            else if (pctt->ctt_pu32Version[u32Index] != 0)
+            {
+                u32Ret = _readChashtableTestKey(u32Key, TRUE, pctt->ctt_pu32Version[u32Index]);
+                u32Count ++;
+            }
+        }
+    }
+
+    u32Size = jf_chashtable_getSize(ls_pjcTable);
+    if ((u32Ret == JF_ERR_NO_ERROR) && (u32Count != u32Size))
+    {
+        ol_printf("Size of hash table is %u, %u keys are inserted\n", u32Size, u32Count);
+        u32Ret = JF_ERR_INVALID_DATA;
+    }
+
+    return u32Ret;
+}
+
+static void _printChashtableTestResult(void)
+{
+    u64 u64Insert = 0, u64Overwrite = 0, u64Remove = 0, u64Read = 0;
+    u32 u32Index;
+    jf_chashtable_stat_t jcs;
+
+    for (u32Index = 0; u32Index < ls_u32NumOfThread; u32Index ++)
+    {
+        u64Insert += ls_cttThread[u32Index].ctt_u64Insert;
+        u64Overwrite += ls_cttThread[u32Index].ctt_u64Overwrite;
+        u64Remove += ls_cttThread[u32Index].ctt_u64Remove;
+        u64Read += ls_cttThread[u32Index].ctt_u64Read;
+    }
+
+    jf_chashtable_getStat(ls_pjcTable, &jcs);
+
+    ol_printf(
+        "threads: %u, insert: %llu, overwrite: %llu, remove: %llu, read: %llu\n",
+        ls_u32NumOfThread, u64Insert, u64Overwrite, u64Remove, u64Read);
+    ol_printf(
+        "entries: %u, buckets: %u, resize: %u, grace period: %llu\n", jcs.jcs_u32NumOfEntry,
+        jcs.jcs_u32Size, jcs.jcs_u32CountOfResizeOp, jcs.jcs_u64GracePeriod);
+}
+
+static u32 _testChashtable(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Index, u32RetCode, u32NumOfThread = 0;
+    chashtable_test_thread_t * pctt;
+    jf_chashtable_create_param_t jccp;
+
+    ol_bzero(ls_cttThread, sizeof(ls_cttThread));
+
+    /*Start with the minimal size, the hash table is resized during the test.*/
+    ol_bzero(&jccp, sizeof(jccp));
+    jccp.jccp_u8KeyType = JF_HASHTABLE_KEY_TYPE_U32;
+    jccp.jccp_fnGetKeyFromEntry = _getKeyFromChashtableTestEntry;
+    jccp.jccp_fnFreeEntry = _freeChashtableTestEntry;
+
+    u32Ret = jf_chashtable_create(&ls_pjcTable, &jccp);
+
+    for (u32Index = 0; (u32Index < ls_u32NumOfThread) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+    {
+        pctt = &ls_cttThread[u32Index];
+        pctt->ctt_u32Index = u32Index;
+        pctt->ctt_u32Seed = 0x43485431 + u32Index * 0x9E3779B9;
+        pctt->ctt_u32NumOfKey = (ls_u32NumOfKey - u32Index - 1) / ls_u32NumOfThread + 1;
+
+        u32Ret = jf_jiukun_allocMemory(
+            (void **)&pctt->ctt_pu32Version, pctt->ctt_u32NumOfKey * sizeof(u32));
+        if (u32Ret == JF_ERR_NO_ERROR)
+            ol_bzero(pctt->ctt_pu32Version, pctt->ctt_u32NumOfKey * sizeof(u32));
+    }
+
+    for (u32Index = 0; (u32Index < ls_u32NumOfThread) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+    {
+        u32Ret = jf_thread_create(
+            &ls_cttThread[u32Index].ctt_jtiThread, NULL, _testChashtableThread,
+            &ls_cttThread[u32Index]);
+        if (u32Ret == JF_ERR_NO_ERROR)
+            u32NumOfThread ++;
+    }
+
+    for (u32Index = 0; u32Index < u32NumOfThread; u32Index ++)
+    {
+        jf_thread_waitForThreadTermination(ls_cttThread[u32Index].ctt_jtiThread, &u32RetCode);
+        if ((u32Ret == JF_ERR_NO_ERROR) && (ls_cttThread[u32Index].ctt_u32Ret != JF_ERR_NO_ERROR))
+            u32Ret = ls_cttThread[u32Index].ctt_u32Ret;
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = _verifyChashtableTest();
+
+    if (ls_pjcTable != NULL)
+    {
+        if (u32Ret == JF_ERR_NO_ERROR)
+            _printChashtableTestResult();
+
+        jf_chashtable_destroy(&ls_pjcTable);
+    }
+
+    for (u32Index = 0; u32Index < ls_u32NumOfThread; u32Index ++)
+        if (ls_cttThread[u32Index].ctt_pu32Version != NULL)
+            jf_jiukun_freeMemory((void **)&ls_cttThread[u32Index].ctt_pu32Version);
+
+    return u32Ret;
+}
+
+/* --- public routine section ------------------------------------------------------------------- */
+
+olint_t main(olint_t argc, olchar_t ** argv)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_logger_init_param_t jlipParam;
+    jf_jiukun_init_param_t jjip;
+    jf_jiukun_cache_create_param_t jjccp;
+
+    ol_bzero(&jlipParam, sizeof(jlipParam));
+    jlipParam.jlip_pstrCallerName = "CHASHTABLE-TEST";
+    jlipParam.jlip_bLogToStdout = TRUE;
+    jlipParam.jlip_u8TraceLevel = 3;
+
+    ol_bzero(&jjip, sizeof(jjip));
+    jjip.jjip_sPool = JF_JIUKUN_MAX_POOL_SIZE;
+
+    u32Ret = _parseChashtableTestCmdLineParam(argc, argv, &jlipParam);
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        jf_logger_init(&jlipParam);
+
+        u32Ret = jf_jiukun_init(&jjip);
+        if (u32Ret == JF_ERR_NO_ERROR)
+        {
+            ol_bzero(&jjccp, sizeof(jjccp));
+            jjccp.jjccp_pstrName = CHASHTABLE_TEST_CACHE;
+            jjccp.jjccp_sObj = sizeof(chashtable_test_entry_t);
+
+            u32Ret = jf_jiukun_createCache(&ls_pjjcEntry, &jjccp);
+            if (u32Ret == JF_ERR_NO_ERROR)
+            {
+                u32Ret = _testChashtable();
+
+                jf_jiukun_destroyCache(&ls_pjjcEntry);
+            }
+
+            jf_jiukun_fini();
+        }
+
+        jf_logger_logErrMsg(u32Ret, "Quit");
+        jf_logger_fini();
+    }
+
+    return u32Ret;
+}
+
+/*------------------------------------------------------------------------------------------------*/
+
+
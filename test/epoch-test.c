@@ -0,0 +1,476 @@
+/**
+ *  @file epoch-test.c
+ *
+ *  @brief Test file for epoch based memory reclamation defined in jf_epoch object.
+ *
+ *  @author Min Zhang
+ *
+ *  @note
+ *  -# The readers dereference the shared objects in read section and check the magic of object,
+ *   the writers replace the objects and retire the old ones. The freed object is poisoned, the
+ *   reader reports error if it sees the poisoned object.
+ *  -# All retired objects should be freed after the threads are unregistered.
+ *
+ */
+
+/* --- standard C lib header files -------------------------------------------------------------- */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* --- internal header files -------------------------------------------------------------------- */
+#include "jf_basic.h"
+#include "jf_limit.h"
+#include "jf_err.h"
+#include "jf_jiukun.h"
+#include "jf_option.h"
+#include "jf_time.h"
+#include "jf_thread.h"
+#include "jf_atomic.h"
+#include "jf_epoch.h"
+
+/* --- private data/data structure section ------------------------------------------------------ */
+
+#define EPOCH_TEST_MAX_THREAD                (64)
+
+#define EPOCH_TEST_DEFAULT_THREAD            (4)
+
+#define EPOCH_TEST_DEFAULT_OPERATION         (200000)
+
+/** Number of shared objects.
+ */
+#define EPOCH_TEST_NUM_OF_SLOT               (16)
+
+/** One of the threads is writer for the number of threads.
+ */
+#define EPOCH_TEST_WRITER_RATIO              (4)
+
+#define EPOCH_TEST_MAGIC                     (0x45504f43U)
+
+#define EPOCH_TEST_POISON                    (0xDEADBEEFU)
+
+/** The shared object.
+ */
+typedef struct
+{
+    volatile u32 eto_u32Magic;
+    u32 eto_u32Slot;
+    u64 eto_u64Value;
+} epoch_test_object_t;
+
+/** The test thread.
+ */
+typedef struct
+{
+    jf_thread_id_t ett_jtiThread;
+    u32 ett_u32Index;
+    u32 ett_u32Ret;
+    boolean_t ett_bWriter;
+    u8 ett_u8Reserved[7];
+    /**Number of poisoned objects seen by reader.*/
+    u64 ett_u64Poisoned;
+    u64 ett_u64Read;
+    u64 ett_u64Write;
+} epoch_test_thread_t;
+
+static u32 ls_u32NumOfThread = EPOCH_TEST_DEFAULT_THREAD;
+
+static u32 ls_u32NumOfOperation = EPOCH_TEST_DEFAULT_OPERATION;
+
+static boolean_t ls_bNoMembarrier = FALSE;
+
+static jf_epoch_t * ls_pjeEpoch = NULL;
+
+static epoch_test_object_t * volatile ls_petoSlot[EPOCH_TEST_NUM_OF_SLOT];
+
+static epoch_test_thread_t ls_ettThread[EPOCH_TEST_MAX_THREAD];
+
+static volatile u64 ls_u64Freed = 0;
+
+static volatile u32 ls_u32ReaderState = 0;
+
+/* --- private routine section ------------------------------------------------------------------ */
+
+static void _printEpochTestUsage(void)
+{
+    ol_printf("\
+Usage: epoch-test [-t <threads>] [-o <operations>] [-n] \n\
+    [-T <trace level>] [-F <trace log file>] [-S <trace file size>]\n\
+  -t number of threads, 1 of %u threads is writer, default %u.\n\
+  -o number of operations per thread, default %u.\n\
+  -n use full memory barrier in read section instead of membarrier system call.\n",
+        EPOCH_TEST_WRITER_RATIO, EPOCH_TEST_DEFAULT_THREAD, EPOCH_TEST_DEFAULT_OPERATION);
+
+    ol_printf("\n");
+}
+
+static u32 _parseEpochTestCmdLineParam(
+    olint_t argc, olchar_t ** argv, jf_logger_init_param_t * pjlip)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    olint_t nOpt;
+
+    while (((nOpt = getopt(argc, argv, "t:o:nT:F:S:h")) != -1) &&
+           (u32Ret == JF_ERR_NO_ERROR))
+    {
+        switch (nOpt)
+        {
+        case '?':
+        case 'h':
+            _printEpochTestUsage();
+            exit(0);
+            break;
+        case 't':
+            u32Ret = jf_option_getU32FromString(optarg, &ls_u32NumOfThread);
+            if ((u32Ret == JF_ERR_NO_ERROR) &&
+                ((ls_u32NumOfThread == 0) || (ls_u32NumOfThread > EPOCH_TEST_MAX_THREAD)))
+                u32Ret = JF_ERR_INVALID_PARAM;
+            break;
+        case 'o':
+            u32Ret = jf_option_getU32FromString(optarg, &ls_u32NumOfOperation);
+            break;
+        case 'n':
+            ls_bNoMembarrier = TRUE;
+            break;
+        case 'T':
+            u32Ret = jf_option_getU8FromString(optarg, &pjlip->jlip_u8TraceLevel);
+            break;
+        case 'F':
+            pjlip->jlip_bLogToFile = TRUE;
+            pjlip->jlip_pstrLogFilePath = optarg;
+            break;
+        case 'S':
+            u32Ret = jf_option_getS32FromString(optarg, &pjlip->jlip_sLogFile);
+            break;
+        default:
+            u32Ret = JF_ERR_INVALID_OPTION;
+            break;
+        }
+    }
+
+    return u32Ret;
+}
+
+static u64 _getEpochTestTime(void)
+{
+    struct timespec ts;
+
+    jf_time_getClockTime(CLOCK_MONOTONIC, &ts);
+
+    return (u64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static u32 _newEpochTestObject(u32 u32Slot, u64 u64Value, epoch_test_object_t ** ppeto)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    epoch_test_object_t * peto = NULL;
+
+    u32Ret = jf_jiukun_allocMemory((void **)&peto, sizeof(*peto));
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        peto->eto_u32Magic = EPOCH_TEST_MAGIC;
+        peto->eto_u32Slot = u32Slot;
+        peto->eto_u64Value = u64Value;
+
+        *ppeto = peto;
+    }
+
+    return u32Ret;
+}
+
+/** Poison the object before it's freed, the reader sees the poison if the object is freed too
+ *  early and the memory is not reused yet.
+ */
+static void _freeEpochTestObject(void * pObject, void * pArg)
+{
+    epoch_test_object_t * peto = pObject;
+
+    peto->eto_u32Magic = EPOCH_TEST_POISON;
+    jf_atomic_fetchAddU64(&ls_u64Freed, 1);
+
+    jf_jiukun_freeMemory(&pObject);
+}
+
+static void _readEpochTestSlot(jf_epoch_thread_t * pjet, epoch_test_thread_t * pett, u32 u32Slot)
+{
+    epoch_test_object_t * peto = NULL;
+
+    jf_epoch_enter(pjet);
+
+    peto = jf_atomic_loadPointer((void * volatile *)&ls_petoSlot[u32Slot]);
+    if ((peto->eto_u32Magic != EPOCH_TEST_MAGIC) || (peto->eto_u32Slot != u32Slot))
+        pett->ett_u64Poisoned ++;
+
+    jf_epoch_leave(pjet);
+
+    pett->ett_u64Read ++;
+}
+
+static u32 _writeEpochTestSlot(jf_epoch_thread_t * pjet, epoch_test_thread_t * pett, u32 u32Slot)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    epoch_test_object_t * peto = NULL;
+
+    u32Ret = _newEpochTestObject(u32Slot, pett->ett_u64Write, &peto);
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        peto = jf_atomic_exchangePointer((void * volatile *)&ls_petoSlot[u32Slot], peto);
+
+        u32Ret = jf_epoch_retire(pjet, peto, _freeEpochTestObject, NULL);
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        pett->ett_u64Write ++;
+
+    return u32Ret;
+}
+
+static JF_THREAD_RETURN_VALUE _epochTestThread(void * pArg)
+{
+    epoch_test_thread_t * pett = pArg;
+    jf_epoch_thread_t * pjet = NULL;
+    u32 u32Index, u32Slot;
+
+    pett->ett_u32Ret = jf_epoch_registerThread(ls_pjeEpoch, &pjet);
+
+    for (u32Index = 0;
+         (u32Index < ls_u32NumOfOperation) && (pett->ett_u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+    {
+        u32Slot = (u32Index + pett->ett_u32Index) % EPOCH_TEST_NUM_OF_SLOT;
+
+        if (pett->ett_bWriter)
+            pett->ett_u32Ret = _writeEpochTestSlot(pjet, pett, u32Slot);
+        else
+            _readEpochTestSlot(pjet, pett, u32Slot);
+    }
+
+    if (pjet != NULL)
+        jf_epoch_unregisterThread(&pjet);
+
+    JF_THREAD_RETURN(pett->ett_u32Ret);
+}
+
+/** Reader staying in read section until the main thread checks the synchronize is blocked.
+ */
+static JF_THREAD_RETURN_VALUE _epochTestBlockingReader(void * pArg)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_epoch_thread_t * pjet = NULL;
+
+    u32Ret = jf_epoch_registerThread(ls_pjeEpoch, &pjet);
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        jf_epoch_enter(pjet);
+        jf_atomic_storeU32(&ls_u32ReaderState, 1);
+
+        jf_time_milliSleep(200);
+
+        jf_atomic_storeU32(&ls_u32ReaderState, 2);
+        jf_epoch_leave(pjet);
+
+        jf_epoch_unregisterThread(&pjet);
+    }
+
+    JF_THREAD_RETURN(u32Ret);
+}
+
+static u32 _testEpochSynchronize(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_thread_id_t jti;
+    jf_epoch_thread_t * pjet = NULL;
+    epoch_test_object_t * peto = NULL;
+    u32 u32RetCode;
+    u64 u64Freed;
+
+    ol_printf("Testing nested read section and synchronize\n");
+
+    u32Ret = jf_epoch_registerThread(ls_pjeEpoch, &pjet);
+
+    /*The object retired in nested read section is not freed by barrier until leaving it.*/
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = _newEpochTestObject(0, 0, &peto);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        jf_epoch_enter(pjet);
+        jf_epoch_enter(pjet);
+        jf_epoch_leave(pjet);
+
+        u64Freed = jf_atomic_loadU64(&ls_u64Freed);
+        u32Ret = jf_epoch_retire(pjet, peto, _freeEpochTestObject, NULL);
+
+        jf_epoch_leave(pjet);
+
+        if (u32Ret == JF_ERR_NO_ERROR)
+            u32Ret = jf_epoch_barrier(pjet);
+
+        if ((u32Ret == JF_ERR_NO_ERROR) && (jf_atomic_loadU64(&ls_u64Freed) != u64Freed + 1))
+        {
+            ol_printf("The retired object is not freed by barrier\n");
+            u32Ret = JF_ERR_INVALID_DATA;
+        }
+    }
+
+    /*The synchronize returns after the reader leaves the read section.*/
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = jf_thread_create(&jti, NULL, _epochTestBlockingReader, NULL);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        while (jf_atomic_loadU32(&ls_u32ReaderState) == 0)
+            jf_time_milliSleep(1);
+
+        jf_epoch_synchronize(ls_pjeEpoch);
+
+        if (jf_atomic_loadU32(&ls_u32ReaderState) != 2)
+        {
+            ol_printf("The synchronize returns when the reader is in read section\n");
+            u32Ret = JF_ERR_INVALID_DATA;
+        }
+
+        jf_thread_waitForThreadTermination(jti, &u32RetCode);
+    }
+
+    if (pjet != NULL)
+        jf_epoch_unregisterThread(&pjet);
+
+    return u32Ret;
+}
+
+static u32 _testEpochStress(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Index, u32RetCode, u32NumOfThread = 0;
+    u64 u64Start, u64Time, u64Read = 0, u64Write = 0, u64Poisoned = 0;
+    epoch_test_thread_t * pett = NULL;
+    jf_epoch_stat_t jes;
+
+    ol_printf(
+        "Testing %u threads, %u operations per thread\n", ls_u32NumOfThread,
+        ls_u32NumOfOperation);
+
+    ol_bzero(ls_ettThread, sizeof(ls_ettThread));
+    u64Start = _getEpochTestTime();
+
+    for (u32Index = 0; (u32Index < ls_u32NumOfThread) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+    {
+        pett = &ls_ettThread[u32Index];
+        pett->ett_u32Index = u32Index;
+        pett->ett_bWriter = ((u32Index % EPOCH_TEST_WRITER_RATIO) == 0);
+
+        u32Ret = jf_thread_create(&pett->ett_jtiThread, NULL, _epochTestThread, pett);
+        if (u32Ret == JF_ERR_NO_ERROR)
+            u32NumOfThread ++;
+    }
+
+    for (u32Index = 0; u32Index < u32NumOfThread; u32Index ++)
+    {
+        pett = &ls_ettThread[u32Index];
+        jf_thread_waitForThreadTermination(pett->ett_jtiThread, &u32RetCode);
+
+        if ((u32Ret == JF_ERR_NO_ERROR) && (pett->ett_u32Ret != JF_ERR_NO_ERROR))
+            u32Ret = pett->ett_u32Ret;
+
+        u64Read += pett->ett_u64Read;
+        u64Write += pett->ett_u64Write;
+        u64Poisoned += pett->ett_u64Poisoned;
+    }
+
+    u64Time = _getEpochTestTime() - u64Start;
+
+    jf_epoch_getStat(ls_pjeEpoch, &jes);
+
+    ol_printf(
+        "reads %llu, writes %llu, poisoned %llu, %llu ms\n", u64Read, u64Write, u64Poisoned,
+        u64Time / 1000000);
+    ol_printf(
+        "membarrier %s, advances %llu, retired %llu, freed %llu\n",
+        (jes.jes_bMembarrier ? "yes" : "no"), jes.jes_u64Advance,
+        jes.jes_u64Retired, jes.jes_u64Freed);
+
+    if ((u32Ret == JF_ERR_NO_ERROR) &&
+        ((u64Poisoned != 0) || (jes.jes_u32NumOfThread != 0) ||
+         (jes.jes_u64Retired != jes.jes_u64Freed) || (jes.jes_u64Freed != ls_u64Freed)))
+    {
+        ol_printf("The retired objects are not freed correctly\n");
+        u32Ret = JF_ERR_INVALID_DATA;
+    }
+
+    return u32Ret;
+}
+
+static u32 _testEpoch(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Index;
+    jf_epoch_create_param_t jecp;
+    void * pObject = NULL;
+
+    ol_bzero(&jecp, sizeof(jecp));
+    jecp.jecp_bNoMembarrier = ls_bNoMembarrier;
+    ol_bzero((void *)ls_petoSlot, sizeof(ls_petoSlot));
+
+    u32Ret = jf_epoch_create(&ls_pjeEpoch, &jecp);
+
+    for (u32Index = 0;
+         (u32Index < EPOCH_TEST_NUM_OF_SLOT) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+        u32Ret = _newEpochTestObject(u32Index, 0, (epoch_test_object_t **)&ls_petoSlot[u32Index]);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = _testEpochSynchronize();
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = _testEpochStress();
+
+    for (u32Index = 0; u32Index < EPOCH_TEST_NUM_OF_SLOT; u32Index ++)
+    {
+        pObject = ls_petoSlot[u32Index];
+        if (pObject != NULL)
+            jf_jiukun_freeMemory(&pObject);
+    }
+
+    if (ls_pjeEpoch != NULL)
+        jf_epoch_destroy(&ls_pjeEpoch);
+
+    return u32Ret;
+}
+
+/* --- public routine section ------------------------------------------------------------------- */
+
+olint_t main(olint_t argc, olchar_t ** argv)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_logger_init_param_t jlipParam;
+    jf_jiukun_init_param_t jjip;
+
+    ol_bzero(&jlipParam, sizeof(jlipParam));
+    jlipParam.jlip_pstrCallerName = "EPOCH-TEST";
+    jlipParam.jlip_bLogToStdout = TRUE;
+    jlipParam.jlip_u8TraceLevel = 3;
+
+    ol_bzero(&jjip, sizeof(jjip));
+    jjip.jjip_sPool = JF_JIUKUN_MAX_POOL_SIZE;
+
+    u32Ret = _parseEpochTestCmdLineParam(argc, argv, &jlipParam);
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        jf_logger_init(&jlipParam);
+
+        u32Ret = jf_jiukun_init(&jjip);
+        if (u32Ret == JF_ERR_NO_ERROR)
+        {
+            u32Ret = _testEpoch();
+
+            jf_jiukun_fini();
+        }
+
+        jf_logger_logErrMsg(u32Ret, "Quit");
+        jf_logger_fini();
+    }
+
+    return u32Ret;
+}
+
+/*------------------------------------------------------------------------------------------------*/
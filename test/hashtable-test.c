@@ -20,6 +20,7 @@
 #include "jf_err.h"
 #include "jf_hashtable.h"
 #include "jf_process.h"
+#include "jf_time.h"
 #include "jf_jiukun.h"
 
 /* --- private data/data structure section ------------------------------------------------------ */
@@ -27,17 +28,22 @@
 static boolean_t ls_bTerminateFlag = FALSE;
 static boolean_t ls_bHashU32 = FALSE;
 static boolean_t ls_bHashTable = FALSE;
+static boolean_t ls_bFlatHashTable = FALSE;
 
 #define TEST_HASHTABLE_HASHU32_BITS       (8)
 #define TEST_HASHTABLE_HASHU32_HIT_COUNT  (1 << TEST_HASHTABLE_HASHU32_BITS)
 
+#define TEST_FLAT_HASHTABLE_NUM_OF_ENTRY  (100000)
+#define TEST_FLAT_HASHTABLE_LOOKUP_ROUND  (20)
+
 /* --- private routine section ------------------------------------------------------------------ */
 static void _printHashTableTestUsage(void)
 {
     ol_printf("\
-Usage: hashtable-test [-u] [-t] [-h]\n\
+Usage: hashtable-test [-u] [-t] [-f] [-h]\n\
     -u hash u32\n\
     -t hash table\n\
+    -f flat hash table, the lookup is compared with chained hash table\n\
     -h print the usage\n");
     ol_printf("\n");
 
@@ -49,7 +55,7 @@ static u32 _parseHashTableTestCmdLineParam(
     u32 u32Ret = JF_ERR_NO_ERROR;
     olint_t nOpt;
 
-    while (((nOpt = getopt(argc, argv, "uth?")) != -1) && (u32Ret == JF_ERR_NO_ERROR))
+    while (((nOpt = getopt(argc, argv, "utfh?")) != -1) && (u32Ret == JF_ERR_NO_ERROR))
     {
         switch (nOpt)
         {
@@ -64,6 +70,9 @@ static u32 _parseHashTableTestCmdLineParam(
         case 't':
             ls_bHashTable = TRUE;
             break;
+        case 'f':
+            ls_bFlatHashTable = TRUE;
+            break;
         case ':':
             u32Ret = JF_ERR_MISSING_PARAM;
             break;
@@ -193,6 +202,244 @@ static u32 _testHashTable(void)
     return u32Ret;
 }
 
+typedef struct test_flat_entry
+{
+    u32 tfe_u32Key;
+    olchar_t tfe_strKey[12];
+} test_flat_entry_t;
+
+static olint_t _testFlatHtCmpKeys(void * pKey1, void * pKey2)
+{
+    return (pKey1 == pKey2) ? 0 : 1;
+}
+
+static olint_t _testFlatHtHashKey(void * pKey)
+{
+    /*The weak hash is mixed by flat hash table.*/
+    return (olint_t)(ulong)pKey;
+}
+
+static void * _testFlatHtGetU32Key(void * pEntry)
+{
+    return (void *)(ulong)((test_flat_entry_t *)pEntry)->tfe_u32Key;
+}
+
+static void * _testFlatHtGetStringKey(void * pEntry)
+{
+    return ((test_flat_entry_t *)pEntry)->tfe_strKey;
+}
+
+static u64 _getTestTime(void)
+{
+    struct timespec tp;
+
+    jf_time_getClockTime(CLOCK_MONOTONIC, &tp);
+
+    return (u64)tp.tv_sec * 1000000000 + tp.tv_nsec;
+}
+
+static void _printHashTableStat(const olchar_t * pstrName, jf_hashtable_t * pjh)
+{
+    jf_hashtable_stat_t stat;
+
+    jf_hashtable_getStat(pjh, &stat);
+
+    ol_printf(
+        "%s: entry %u, size %u, collisions %u, resize %u, probe max %u avg %.2f, tombstone %u\n",
+        pstrName, stat.jhs_u32NumOfEntry, stat.jhs_u32Size, stat.jhs_u32Collisions,
+        stat.jhs_u32CountOfResizeOp, stat.jhs_u32MaxProbeLength,
+        stat.jhs_u32NumOfEntry ? (double)stat.jhs_u32TotalProbeLength / stat.jhs_u32NumOfEntry : 0,
+        stat.jhs_u32NumOfTombstone);
+}
+
+static void * _getTestFlatKey(u8 u8KeyType, test_flat_entry_t * entry)
+{
+    if (u8KeyType == JF_HASHTABLE_KEY_TYPE_STRING)
+        return entry->tfe_strKey;
+
+    return (void *)(ulong)entry->tfe_u32Key;
+}
+
+/** Insert, remove and insert again, all the entries are verified after each step.
+ */
+static u32 _verifyFlatHashTable(
+    jf_hashtable_create_param_t * pjhcp, test_flat_entry_t * pEntry, u32 u32Num)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_hashtable_t * pjh = NULL;
+    jf_hashtable_iterator_t jhi;
+    u32 u32Index, u32Count;
+    void * pFound;
+
+    u32Ret = jf_hashtable_create(&pjh, pjhcp);
+
+    for (u32Index = 0; (u32Index < u32Num) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+        u32Ret = jf_hashtable_insertEntry(pjh, &pEntry[u32Index]);
+
+    for (u32Index = 0; (u32Index < u32Num) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+    {
+        u32Ret = jf_hashtable_getEntry(
+            pjh, _getTestFlatKey(pjhcp->jhcp_u8KeyType, &pEntry[u32Index]), &pFound);
+        if ((u32Ret == JF_ERR_NO_ERROR) && (pFound != &pEntry[u32Index]))
+            u32Ret = JF_ERR_INVALID_DATA;
+    }
+
+    /*Remove the odd entries.*/
+    for (u32Index = 1; (u32Index < u32Num) && (u32Ret == JF_ERR_NO_ERROR); u32Index += 2)
+        u32Ret = jf_hashtable_removeEntry(pjh, &pEntry[u32Index]);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        _printHashTableStat("after remove", pjh);
+
+    for (u32Index = 0; (u32Index < u32Num) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+    {
+        if (jf_hashtable_isEntryInTable(pjh, &pEntry[u32Index]) != ((u32Index & 1) == 0))
+            u32Ret = JF_ERR_INVALID_DATA;
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        u32Count = 0;
+        jf_hashtable_setupIterator(pjh, &jhi);
+        while (! jf_hashtable_isEndOfIterator(&jhi))
+        {
+            u32Count ++;
+            jf_hashtable_incrementIterator(&jhi);
+        }
+
+        if (u32Count != jf_hashtable_getSize(pjh))
+            u32Ret = JF_ERR_INVALID_DATA;
+    }
+
+    /*Insert the odd entries again, the deleted slots are reused.*/
+    for (u32Index = 1; (u32Index < u32Num) && (u32Ret == JF_ERR_NO_ERROR); u32Index += 2)
+        u32Ret = jf_hashtable_overwriteEntry(pjh, &pEntry[u32Index]);
+
+    for (u32Index = 0; (u32Index < u32Num) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+    {
+        if (! jf_hashtable_isKeyInTable(
+                pjh, _getTestFlatKey(pjhcp->jhcp_u8KeyType, &pEntry[u32Index])))
+            u32Ret = JF_ERR_INVALID_DATA;
+    }
+
+    if ((u32Ret == JF_ERR_NO_ERROR) && (jf_hashtable_getSize(pjh) != u32Num))
+        u32Ret = JF_ERR_INVALID_DATA;
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        _printHashTableStat("after insert", pjh);
+
+    if (pjh != NULL)
+        jf_hashtable_destroy(&pjh);
+
+    return u32Ret;
+}
+
+/** Look up all the entries for rounds, return the average time of one lookup in nanosecond.
+ */
+static u32 _lookupTestHashTable(
+    jf_hashtable_create_param_t * pjhcp, test_flat_entry_t * pEntry, u32 u32Num, u64 * pu64Ns)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_hashtable_t * pjh = NULL;
+    u32 u32Index, u32Round;
+    u64 u64Start;
+    void * pFound;
+
+    u32Ret = jf_hashtable_create(&pjh, pjhcp);
+
+    for (u32Index = 0; (u32Index < u32Num) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+        u32Ret = jf_hashtable_insertEntry(pjh, &pEntry[u32Index]);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        u64Start = _getTestTime();
+
+        for (u32Round = 0; u32Round < TEST_FLAT_HASHTABLE_LOOKUP_ROUND; u32Round ++)
+            for (u32Index = 0; (u32Index < u32Num) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+                u32Ret = jf_hashtable_getEntry(
+                    pjh, (void *)(ulong)pEntry[u32Index].tfe_u32Key, &pFound);
+
+        *pu64Ns = (_getTestTime() - u64Start) / (TEST_FLAT_HASHTABLE_LOOKUP_ROUND * u32Num);
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        _printHashTableStat(
+            (pjhcp->jhcp_u8Type == JF_HASHTABLE_TYPE_FLAT) ? "flat" : "chain", pjh);
+
+    if (pjh != NULL)
+        jf_hashtable_destroy(&pjh);
+
+    return u32Ret;
+}
+
+static u32 _testFlatHashTable(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Num = TEST_FLAT_HASHTABLE_NUM_OF_ENTRY, u32Index;
+    test_flat_entry_t * pEntry = NULL;
+    jf_hashtable_create_param_t jhcp;
+    u8 u8KeyType[] = {
+        JF_HASHTABLE_KEY_TYPE_U32, JF_HASHTABLE_KEY_TYPE_STRING, JF_HASHTABLE_KEY_TYPE_CALLBACK};
+    u64 u64Chain = 0, u64Flat = 0;
+
+    u32Ret = jf_jiukun_allocMemory((void **)&pEntry, u32Num * sizeof(test_flat_entry_t));
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        srandom(time(NULL));
+        for (u32Index = 0; u32Index < u32Num; u32Index ++)
+        {
+            /*Random keys which are unique.*/
+            pEntry[u32Index].tfe_u32Key = (random() & ~0xFFFFF) | u32Index;
+            ol_snprintf(
+                pEntry[u32Index].tfe_strKey, sizeof(pEntry[u32Index].tfe_strKey), "k%u",
+                pEntry[u32Index].tfe_u32Key);
+        }
+    }
+
+    for (u32Index = 0;
+         (u32Index < JF_BASIC_ARRAY_SIZE(u8KeyType)) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+    {
+        ol_bzero(&jhcp, sizeof(jhcp));
+        jhcp.jhcp_u8Type = JF_HASHTABLE_TYPE_FLAT;
+        jhcp.jhcp_u8KeyType = u8KeyType[u32Index];
+        jhcp.jhcp_fnCmpKeys = _testFlatHtCmpKeys;
+        jhcp.jhcp_fnHashKey = _testFlatHtHashKey;
+        jhcp.jhcp_fnGetKeyFromEntry = _testFlatHtGetU32Key;
+        if (jhcp.jhcp_u8KeyType == JF_HASHTABLE_KEY_TYPE_STRING)
+            jhcp.jhcp_fnGetKeyFromEntry = _testFlatHtGetStringKey;
+
+        ol_printf("verify flat hash table with key type %u\n", jhcp.jhcp_u8KeyType);
+        u32Ret = _verifyFlatHashTable(&jhcp, pEntry, u32Num);
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ol_bzero(&jhcp, sizeof(jhcp));
+        jhcp.jhcp_u32MinSize = u32Num;
+        jhcp.jhcp_fnCmpKeys = _testFlatHtCmpKeys;
+        jhcp.jhcp_fnHashKey = _testFlatHtHashKey;
+        jhcp.jhcp_fnGetKeyFromEntry = _testFlatHtGetU32Key;
+
+        u32Ret = _lookupTestHashTable(&jhcp, pEntry, u32Num, &u64Chain);
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        jhcp.jhcp_u8Type = JF_HASHTABLE_TYPE_FLAT;
+        jhcp.jhcp_u8KeyType = JF_HASHTABLE_KEY_TYPE_U32;
+
+        u32Ret = _lookupTestHashTable(&jhcp, pEntry, u32Num, &u64Flat);
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        ol_printf("lookup (ns): chain %llu, flat %llu\n", u64Chain, u64Flat);
+
+    if (pEntry != NULL)
+        jf_jiukun_freeMemory((void **)&pEntry);
+
+    return u32Ret;
+}
+
 /* --- public routine section ------------------------------------------------------------------- */
 
 olint_t main(olint_t argc, olchar_t ** argv)
@@ -226,6 +473,10 @@ olint_t main(olint_t argc, olchar_t ** argv)
             {
                 u32Ret = _testHashTable();
             }
+            else if (ls_bFlatHashTable)
+            {
+                u32Ret = _testFlatHashTable();
+            }
             else
             {
                 ol_printf("No operation is specified !!!!\n\n");
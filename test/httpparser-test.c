@@ -26,6 +26,7 @@
 /* --- private data/data structure section ------------------------------------------------------ */
 
 static boolean_t ls_bParseHttp = FALSE;
+static boolean_t ls_bArena = FALSE;
 static boolean_t ls_bParseUri = FALSE;
 static boolean_t ls_bGenerateHttpMsg = FALSE;
 
@@ -34,8 +35,9 @@ static boolean_t ls_bGenerateHttpMsg = FALSE;
 static void _printHttpparserTestUsage(void)
 {
     ol_printf("\
-Usage: httpparser-test [-p] [-u] [-g] [-h] [logger options] \n\
+Usage: httpparser-test [-p] [-a] [-u] [-g] [-h] [logger options] \n\
     -p parse http header.\n\
+    -a parse http header with arena, use with \"-p\".\n\
     -u parse URI.\n\
     -g generating http message.\n\
     -h print the usage.\n\
@@ -54,7 +56,7 @@ static u32 _parseHttpparserTestCmdLineParam(
     u32 u32Ret = JF_ERR_NO_ERROR;
     olint_t nOpt;
 
-    while (((nOpt = getopt(argc, argv, "gupT:F:S:h")) != -1) &&
+    while (((nOpt = getopt(argc, argv, "guapT:F:S:h")) != -1) &&
            (u32Ret == JF_ERR_NO_ERROR))
     {
         switch (nOpt)
@@ -73,6 +75,9 @@ static u32 _parseHttpparserTestCmdLineParam(
         case 'g':
             ls_bGenerateHttpMsg = TRUE;
             break;
+        case 'a':
+            ls_bArena = TRUE;
+            break;
         case 'T':
             u32Ret = jf_option_getU8FromString(optarg, &pjlip->jlip_u8TraceLevel);
             break;
@@ -283,6 +288,8 @@ typedef struct
 static u32 _testParseHttp(void)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_jiukun_arena_t * pArena = NULL;
+    jf_jiukun_arena_create_param_t jjacp;
     olchar_t strErrMsg[300];
     test_http_parser_t thp[] = {
         {HTTP_MSG_1, JF_ERR_NO_ERROR},
@@ -295,13 +302,25 @@ static u32 _testParseHttp(void)
     u32 u32Index;
     jf_httpparser_packet_header_t * pjhph = NULL;
 
+    if (ls_bArena)
+    {
+        ol_bzero(&jjacp, sizeof(jjacp));
+        u32Ret = jf_jiukun_createArena(&pArena, &jjacp);
+        if (u32Ret != JF_ERR_NO_ERROR)
+            return u32Ret;
+    }
+
     for (u32Index = 0; u32Index < u32NumOfCase; u32Index ++)
     {
         ol_printf("---------------------------------------------------\n");
         ol_printf("Parse http message:\n%s\n", thp[u32Index].pstrHttp);
 
-        u32Ret = jf_httpparser_parsePacketHeader(
-            &pjhph, thp[u32Index].pstrHttp, 0, strlen(thp[u32Index].pstrHttp));
+        if (pArena != NULL)
+            u32Ret = jf_httpparser_parsePacketHeaderInArena(
+                &pjhph, thp[u32Index].pstrHttp, 0, strlen(thp[u32Index].pstrHttp), pArena);
+        else
+            u32Ret = jf_httpparser_parsePacketHeader(
+                &pjhph, thp[u32Index].pstrHttp, 0, strlen(thp[u32Index].pstrHttp));
 
         if (u32Ret != thp[u32Index].u32ErrCode)
         {
@@ -323,8 +342,15 @@ static u32 _testParseHttp(void)
 
         ol_printf("\n");
         ol_printf("Http message after parse:\n%s\n", thp[u32Index].pstrHttp);
+
+        /*Release all packet headers parsed in the arena.*/
+        if (pArena != NULL)
+            jf_jiukun_resetArena(pArena);
     }
 
+    if (pArena != NULL)
+        jf_jiukun_destroyArena(&pArena);
+
     return u32Ret;
 }
 
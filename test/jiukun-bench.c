@@ -0,0 +1,695 @@
+/**
+ *  @file jiukun-bench.c
+ *
+ *  @brief Benchmark for jiukun library.
+ *
+ *  @author Min Zhang
+ *
+ *  @note
+ *  -# The message mix benchmark allocates the memory with the size distribution of dispatcher
+ *   messages, all memory is touched and kept until the end. The increase of RSS is the memory
+ *   used by jiukun for the messages.
+ *  -# With the power of two option, the size is rounded up to the power of two before allocation,
+ *   it's the memory usage of the general caches before the quarter power of two size classes.
+ *  -# The sizes are generated by a PRNG with fixed seed, the runs with and without power of two
+ *   option allocate the same sequence of messages.
+ *  -# With the profile option, the allocations of message mix are sampled, the profile is dumped
+ *   before the messages are freed.
+ *  -# With the reap option, jiukun is reaped after the messages of message mix are freed, the RSS
+ *   decreased is the memory returned to OS.
+ *  -# The page benchmark allocates and frees pages of order 0 to 3 in multiple threads, it's the
+ *   page usage of slab refill and large buffer. Run it with and without page cache to compare.
+ *  -# The object benchmark allocates small objects from a cache for multiple threads in round
+ *   robin, so the adjacent objects are owned by different threads. Each thread then updates its
+ *   own objects and allocates and frees objects. Run it with and without the align, pad and
+ *   color options to see the effect of false sharing.
+ *
+ */
+
+/* --- standard C lib header files -------------------------------------------------------------- */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+
+/* --- internal header files -------------------------------------------------------------------- */
+#include "jf_basic.h"
+#include "jf_limit.h"
+#include "jf_err.h"
+#include "jf_jiukun.h"
+#include "jf_option.h"
+#include "jf_thread.h"
+#include "jf_time.h"
+
+/* --- private data/data structure section ------------------------------------------------------ */
+
+#define JIUKUN_BENCH                       "JIUKUN-BENCH"
+
+#define JIUKUN_BENCH_DEFAULT_MESSAGE       (20000)
+
+#define JIUKUN_BENCH_MAX_MESSAGE           (200000)
+
+#define JIUKUN_BENCH_MIN_SIZE              (32)
+
+#define JIUKUN_BENCH_DEFAULT_THREAD        (4)
+
+#define JIUKUN_BENCH_MAX_THREAD            (64)
+
+/** Number of pages allocated before they are freed in the page benchmark.
+ */
+#define JIUKUN_BENCH_PAGE_BURST            (16)
+
+#define JIUKUN_BENCH_PAGE_MAX_ORDER        (3)
+
+#define JIUKUN_BENCH_PAGE_LOOP             (100000)
+
+/** Number of objects owned by each thread in the object benchmark.
+ */
+#define JIUKUN_BENCH_OBJECT_PER_THREAD     (64)
+
+#define JIUKUN_BENCH_OBJECT_ACCESS_LOOP    (100000)
+
+#define JIUKUN_BENCH_OBJECT_BURST          (16)
+
+#define JIUKUN_BENCH_OBJECT_LOOP           (100000)
+
+#define JIUKUN_BENCH_OBJECT_CACHE          "jiukun-bench-object"
+
+/** Page benchmark thread.
+ */
+typedef struct
+{
+    jf_thread_id_t jbpt_jtiThread;
+    u32 jbpt_u32Index;
+    u32 jbpt_u32Ret;
+    u64 jbpt_u64Op;
+} jiukun_bench_page_thread_t;
+
+/** Small object updated by the owner thread, the counters are like the statistics in socket
+ *  object.
+ */
+typedef struct
+{
+    u64 jbo_u64Read;
+    u64 jbo_u64Write;
+    u32 jbo_u32Index;
+    u32 jbo_u32Reserved;
+} jiukun_bench_object_t;
+
+/** Object benchmark thread.
+ */
+typedef struct
+{
+    jf_thread_id_t jbot_jtiThread;
+    u32 jbot_u32Ret;
+    u32 jbot_u32Reserved;
+    /**Time of updating objects in nanosecond.*/
+    u64 jbot_u64AccessTime;
+    /**Time of allocating and freeing objects in nanosecond.*/
+    u64 jbot_u64AllocTime;
+    jiukun_bench_object_t * jbot_pjboObject[JIUKUN_BENCH_OBJECT_PER_THREAD];
+} jiukun_bench_object_thread_t;
+
+/** Size distribution of dispatcher messages.
+ */
+typedef struct
+{
+    /**Description of the message.*/
+    olchar_t * jbm_pstrName;
+    /**Minimum size of the message.*/
+    u32 jbm_u32MinSize;
+    /**Maximum size of the message.*/
+    u32 jbm_u32MaxSize;
+    /**Percentage of the message in the mix.*/
+    u32 jbm_u32Percent;
+} jiukun_bench_mix_t;
+
+static jiukun_bench_mix_t ls_jbmDispatcherMix[] =
+{
+    /*Queue node and message header.*/
+    {"header", 24, 64, 40},
+    /*Control message, service status, request and response.*/
+    {"control", 65, 512, 30},
+    /*Message with payload, most of them are around the page size.*/
+    {"payload", 513, 4200, 25},
+    /*Bulk message up to the maximum message size of messaging.*/
+    {"bulk", 4201, 128 * 1024, 5},
+};
+
+static u32 ls_u32NumOfMessage = JIUKUN_BENCH_DEFAULT_MESSAGE;
+
+static boolean_t ls_bPowerOfTwo = FALSE;
+
+static u32 ls_u32Seed = 0x4A4B4E31;
+
+static boolean_t ls_bBenchPage = FALSE;
+
+static boolean_t ls_bNoPageCache = FALSE;
+
+static u32 ls_u32NumOfThread = JIUKUN_BENCH_DEFAULT_THREAD;
+
+static u32 ls_u32ProfileSample = 0;
+
+static olchar_t * ls_pstrProfileFile = NULL;
+
+static boolean_t ls_bReap = FALSE;
+
+static boolean_t ls_bBenchObject = FALSE;
+
+static jf_flag_t ls_jfObjectCache = 0;
+
+static jiukun_bench_page_thread_t ls_jbptThread[JIUKUN_BENCH_MAX_THREAD];
+
+static jiukun_bench_object_thread_t ls_jbotThread[JIUKUN_BENCH_MAX_THREAD];
+
+static jf_jiukun_cache_t * ls_pjjcObject = NULL;
+
+/* --- private routine section ------------------------------------------------------------------ */
+
+static void _printJiukunBenchUsage(void)
+{
+    ol_printf("\
+Usage: jiukun-bench [-n messages] [-2] [-P sample] [-f profile] [-r] [-p] [-t threads] [-c]\n\
+    [-o] [-a] [-d] [-k] [-h] [logger options] \n\
+    -n number of messages, %u by default.\n\
+    -2 round up the size to power of two before allocation.\n\
+    -P enable profiling, sample one allocation per the bytes.\n\
+    -f write the profile to the file in pprof format, the profile is logged if not specified.\n\
+    -r reap jiukun after the messages are freed.\n\
+    -p run page benchmark.\n\
+    -t number of threads for page and object benchmark, %u by default.\n\
+    -c disable page cache.\n\
+    -o run object benchmark.\n\
+    -a align objects to cache line for object benchmark.\n\
+    -d pad objects to cache line for object benchmark.\n\
+    -k color slabs for object benchmark.\n\
+    -h print the usage.\n\
+logger options:\n\
+    -T <0|1|2|3|4> the log level. 0: no log, 1: error, 2: info, 3: debug, 4: data.\n\
+    -F <log file> the log file.\n\
+    -S <log file size> the size of log file. No limit if not specified.\n\
+    ", JIUKUN_BENCH_DEFAULT_MESSAGE, JIUKUN_BENCH_DEFAULT_THREAD);
+
+    ol_printf("\n");
+
+    exit(0);
+}
+
+static u32 _parseJiukunBenchCmdLineParam(
+    olint_t argc, olchar_t ** argv, jf_logger_init_param_t * pjlip)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    olint_t nOpt;
+
+    while (((nOpt = getopt(argc, argv, "n:2P:f:rpt:coadkT:F:S:h")) != -1) &&
+           (u32Ret == JF_ERR_NO_ERROR))
+    {
+        switch (nOpt)
+        {
+        case '?':
+        case 'h':
+            _printJiukunBenchUsage();
+            break;
+        case ':':
+            u32Ret = JF_ERR_MISSING_PARAM;
+            break;
+        case 'n':
+            u32Ret = jf_option_getU32FromString(optarg, &ls_u32NumOfMessage);
+            if ((u32Ret == JF_ERR_NO_ERROR) &&
+                ((ls_u32NumOfMessage == 0) || (ls_u32NumOfMessage > JIUKUN_BENCH_MAX_MESSAGE)))
+                u32Ret = JF_ERR_INVALID_PARAM;
+            break;
+        case '2':
+            ls_bPowerOfTwo = TRUE;
+            break;
+        case 'P':
+            u32Ret = jf_option_getU32FromString(optarg, &ls_u32ProfileSample);
+            break;
+        case 'f':
+            ls_pstrProfileFile = optarg;
+            break;
+        case 'r':
+            ls_bReap = TRUE;
+            break;
+        case 'p':
+            ls_bBenchPage = TRUE;
+            break;
+        case 't':
+            u32Ret = jf_option_getU32FromString(optarg, &ls_u32NumOfThread);
+            if ((u32Ret == JF_ERR_NO_ERROR) &&
+                ((ls_u32NumOfThread == 0) || (ls_u32NumOfThread > JIUKUN_BENCH_MAX_THREAD)))
+                u32Ret = JF_ERR_INVALID_PARAM;
+            break;
+        case 'c':
+            ls_bNoPageCache = TRUE;
+            break;
+        case 'o':
+            ls_bBenchObject = TRUE;
+            break;
+        case 'a':
+            JF_FLAG_SET(ls_jfObjectCache, JF_JIUKUN_CACHE_CREATE_FLAG_HWCACHE_ALIGN);
+            break;
+        case 'd':
+            JF_FLAG_SET(ls_jfObjectCache, JF_JIUKUN_CACHE_CREATE_FLAG_PAD);
+            break;
+        case 'k':
+            JF_FLAG_SET(ls_jfObjectCache, JF_JIUKUN_CACHE_CREATE_FLAG_COLOR);
+            break;
+        case 'T':
+            u32Ret = jf_option_getU8FromString(optarg, &pjlip->jlip_u8TraceLevel);
+            break;
+        case 'F':
+            pjlip->jlip_bLogToFile = TRUE;
+            pjlip->jlip_pstrLogFilePath = optarg;
+            break;
+        case 'S':
+            u32Ret = jf_option_getS32FromString(optarg, &pjlip->jlip_sLogFile);
+            break;
+        default:
+            u32Ret = JF_ERR_INVALID_OPTION;
+            break;
+        }
+    }
+
+    return u32Ret;
+}
+
+/** Xorshift PRNG, the sequence is the same on every run.
+ */
+static u32 _getJiukunBenchRand(void)
+{
+    ls_u32Seed ^= ls_u32Seed << 13;
+    ls_u32Seed ^= ls_u32Seed >> 17;
+    ls_u32Seed ^= ls_u32Seed << 5;
+
+    return ls_u32Seed;
+}
+
+static u32 _getJiukunBenchMessageSize(void)
+{
+    u32 u32Percent = _getJiukunBenchRand() % 100;
+    jiukun_bench_mix_t * pjbm = ls_jbmDispatcherMix;
+
+    while (u32Percent >= pjbm->jbm_u32Percent)
+    {
+        u32Percent -= pjbm->jbm_u32Percent;
+        pjbm ++;
+    }
+
+    return pjbm->jbm_u32MinSize +
+        _getJiukunBenchRand() % (pjbm->jbm_u32MaxSize - pjbm->jbm_u32MinSize + 1);
+}
+
+static u32 _roundUpToPowerOfTwo(u32 u32Size)
+{
+    u32 u32Ret = JIUKUN_BENCH_MIN_SIZE;
+
+    while (u32Ret < u32Size)
+        u32Ret <<= 1;
+
+    return u32Ret;
+}
+
+/** Get the resident set size of the process in byte.
+ */
+static u64 _getJiukunBenchRss(void)
+{
+    u64 u64Rss = 0;
+    FILE * fp = NULL;
+    unsigned long ulSize = 0, ulResident = 0;
+
+    fp = fopen("/proc/self/statm", "r");
+    if (fp != NULL)
+    {
+        if (fscanf(fp, "%lu %lu", &ulSize, &ulResident) == 2)
+            u64Rss = (u64)ulResident * sysconf(_SC_PAGESIZE);
+
+        fclose(fp);
+    }
+
+    return u64Rss;
+}
+
+static u32 _benchJiukunMessageMix(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    void ** ppMsg = NULL;
+    u32 u32Index = 0, u32Size = 0;
+    u64 u64Request = 0, u64RssBefore = 0, u64RssAfter = 0, u64Rss = 0;
+    u64 u64RssFree = 0, u64RssReap = 0;
+    jf_jiukun_reap_stat_t jjrs;
+
+    ppMsg = malloc(ls_u32NumOfMessage * sizeof(void *));
+    if (ppMsg == NULL)
+        return JF_ERR_OUT_OF_MEMORY;
+    ol_bzero(ppMsg, ls_u32NumOfMessage * sizeof(void *));
+
+    u64RssBefore = _getJiukunBenchRss();
+
+    for (u32Index = 0; (u32Index < ls_u32NumOfMessage) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+    {
+        u32Size = _getJiukunBenchMessageSize();
+        u64Request += u32Size;
+        if (ls_bPowerOfTwo)
+            u32Size = _roundUpToPowerOfTwo(u32Size);
+
+        u32Ret = jf_jiukun_allocMemory(&ppMsg[u32Index], u32Size);
+        if (u32Ret == JF_ERR_NO_ERROR)
+            ol_memset(ppMsg[u32Index], 0xA5, u32Size);
+    }
+
+    u64RssAfter = _getJiukunBenchRss();
+
+    if ((u32Ret == JF_ERR_NO_ERROR) && (ls_u32ProfileSample != 0))
+        u32Ret = jf_jiukun_dumpProfile(ls_pstrProfileFile);
+
+    for (u32Index = 0; u32Index < ls_u32NumOfMessage; u32Index ++)
+    {
+        if (ppMsg[u32Index] != NULL)
+            jf_jiukun_freeMemory(&ppMsg[u32Index]);
+    }
+
+    free(ppMsg);
+
+    if ((u32Ret == JF_ERR_NO_ERROR) && ls_bReap)
+    {
+        u64RssFree = _getJiukunBenchRss();
+        u32Ret = jf_jiukun_reap();
+        if (u32Ret == JF_ERR_NO_ERROR)
+            u32Ret = jf_jiukun_getReapStat(&jjrs);
+        u64RssReap = _getJiukunBenchRss();
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        u64Rss = u64RssAfter - u64RssBefore;
+
+        ol_printf(
+            "size classes      : %s\n",
+            ls_bPowerOfTwo ? "power of two" : "quarter power of two");
+        ol_printf("messages          : %u\n", ls_u32NumOfMessage);
+        ol_printf("requested         : %llu bytes\n", u64Request);
+        ol_printf("rss increased     : %llu bytes\n", u64Rss);
+        if (u64Rss > u64Request)
+            ol_printf(
+                "overhead          : %llu%%\n", (u64Rss - u64Request) * 100 / u64Request);
+
+        if (ls_bReap)
+        {
+            ol_printf("slabs reaped      : %llu\n", jjrs.jjrs_u64SlabReaped);
+            ol_printf("bytes released    : %llu\n", jjrs.jjrs_u64ByteReleased);
+            ol_printf("rss after free    : %llu bytes\n", u64RssFree);
+            ol_printf("rss after reap    : %llu bytes\n", u64RssReap);
+        }
+    }
+
+    return u32Ret;
+}
+
+static u64 _getJiukunBenchTime(void)
+{
+    struct timespec ts;
+
+    jf_time_getClockTime(CLOCK_MONOTONIC, &ts);
+
+    return (u64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static JF_THREAD_RETURN_VALUE _benchJiukunPageThread(void * pArg)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jiukun_bench_page_thread_t * pjbpt = pArg;
+    void * pPage[JIUKUN_BENCH_PAGE_BURST];
+    u32 u32Loop, u32Index, u32Order;
+
+    for (u32Loop = 0; (u32Loop < JIUKUN_BENCH_PAGE_LOOP) && (u32Ret == JF_ERR_NO_ERROR); u32Loop ++)
+    {
+        /*Each thread starts from different order.*/
+        u32Order = (u32Loop + pjbpt->jbpt_u32Index) % (JIUKUN_BENCH_PAGE_MAX_ORDER + 1);
+
+        for (u32Index = 0; (u32Index < JIUKUN_BENCH_PAGE_BURST) && (u32Ret == JF_ERR_NO_ERROR);
+             u32Index ++)
+        {
+            u32Ret = jf_jiukun_allocPage(&pPage[u32Index], u32Order, 0);
+            if (u32Ret == JF_ERR_NO_ERROR)
+                *(u8 *)pPage[u32Index] = (u8)u32Index;
+        }
+
+        /*Free the pages allocated successfully.*/
+        while (u32Index > 0)
+        {
+            u32Index --;
+            if (pPage[u32Index] != NULL)
+                jf_jiukun_freePage(&pPage[u32Index]);
+        }
+
+        pjbpt->jbpt_u64Op += JIUKUN_BENCH_PAGE_BURST * 2;
+    }
+
+    pjbpt->jbpt_u32Ret = u32Ret;
+
+    JF_THREAD_RETURN(u32Ret);
+}
+
+static u32 _benchJiukunPage(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Index, u32RetCode, u32NumOfThread = 0;
+    u64 u64Start, u64Time, u64Op = 0;
+
+    ol_bzero(ls_jbptThread, sizeof(ls_jbptThread));
+
+    u64Start = _getJiukunBenchTime();
+
+    for (u32Index = 0; (u32Index < ls_u32NumOfThread) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+    {
+        ls_jbptThread[u32Index].jbpt_u32Index = u32Index;
+        u32Ret = jf_thread_create(
+            &ls_jbptThread[u32Index].jbpt_jtiThread, NULL, _benchJiukunPageThread,
+            &ls_jbptThread[u32Index]);
+        if (u32Ret == JF_ERR_NO_ERROR)
+            u32NumOfThread ++;
+    }
+
+    for (u32Index = 0; u32Index < u32NumOfThread; u32Index ++)
+    {
+        jf_thread_waitForThreadTermination(ls_jbptThread[u32Index].jbpt_jtiThread, &u32RetCode);
+        u64Op += ls_jbptThread[u32Index].jbpt_u64Op;
+        if ((u32Ret == JF_ERR_NO_ERROR) && (ls_jbptThread[u32Index].jbpt_u32Ret != JF_ERR_NO_ERROR))
+            u32Ret = ls_jbptThread[u32Index].jbpt_u32Ret;
+    }
+
+    u64Time = _getJiukunBenchTime() - u64Start;
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ol_printf("page cache        : %s\n", ls_bNoPageCache ? "disabled" : "enabled");
+        ol_printf("threads           : %u\n", u32NumOfThread);
+        ol_printf("operations        : %llu\n", u64Op);
+        ol_printf("time              : %llu ms\n", u64Time / 1000000);
+        if (u64Time > 0)
+            ol_printf("throughput        : %llu ops/s\n", u64Op * 1000000000 / u64Time);
+    }
+
+    return u32Ret;
+}
+
+static JF_THREAD_RETURN_VALUE _benchJiukunObjectThread(void * pArg)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jiukun_bench_object_thread_t * pjbot = pArg;
+    jiukun_bench_object_t * pObject[JIUKUN_BENCH_OBJECT_BURST];
+    u32 u32Loop, u32Index;
+    u64 u64Start;
+
+    /*Update the objects owned by the thread, the objects in the same cache line with the objects
+      of other threads are bounced between CPUs.*/
+    u64Start = _getJiukunBenchTime();
+    for (u32Loop = 0; u32Loop < JIUKUN_BENCH_OBJECT_ACCESS_LOOP; u32Loop ++)
+    {
+        for (u32Index = 0; u32Index < JIUKUN_BENCH_OBJECT_PER_THREAD; u32Index ++)
+        {
+            pjbot->jbot_pjboObject[u32Index]->jbo_u64Write += u32Loop;
+            pjbot->jbot_pjboObject[u32Index]->jbo_u64Read ++;
+        }
+    }
+    pjbot->jbot_u64AccessTime = _getJiukunBenchTime() - u64Start;
+
+    /*Allocate and free objects, the object is written once after allocation.*/
+    u64Start = _getJiukunBenchTime();
+    for (u32Loop = 0; (u32Loop < JIUKUN_BENCH_OBJECT_LOOP) && (u32Ret == JF_ERR_NO_ERROR);
+         u32Loop ++)
+    {
+        for (u32Index = 0; (u32Index < JIUKUN_BENCH_OBJECT_BURST) && (u32Ret == JF_ERR_NO_ERROR);
+             u32Index ++)
+        {
+            u32Ret = jf_jiukun_allocObject(ls_pjjcObject, (void **)&pObject[u32Index]);
+            if (u32Ret == JF_ERR_NO_ERROR)
+                pObject[u32Index]->jbo_u32Index = u32Index;
+        }
+
+        while (u32Index > 0)
+        {
+            u32Index --;
+            if (pObject[u32Index] != NULL)
+                jf_jiukun_freeObject(ls_pjjcObject, (void **)&pObject[u32Index]);
+        }
+    }
+    pjbot->jbot_u64AllocTime = _getJiukunBenchTime() - u64Start;
+
+    pjbot->jbot_u32Ret = u32Ret;
+
+    JF_THREAD_RETURN(u32Ret);
+}
+
+static void _freeJiukunBenchObject(void)
+{
+    u32 u32Index, u32Object;
+
+    for (u32Index = 0; u32Index < ls_u32NumOfThread; u32Index ++)
+    {
+        for (u32Object = 0; u32Object < JIUKUN_BENCH_OBJECT_PER_THREAD; u32Object ++)
+        {
+            if (ls_jbotThread[u32Index].jbot_pjboObject[u32Object] != NULL)
+                jf_jiukun_freeObject(
+                    ls_pjjcObject, (void **)&ls_jbotThread[u32Index].jbot_pjboObject[u32Object]);
+        }
+    }
+}
+
+static u32 _benchJiukunObject(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Index, u32Object, u32RetCode, u32NumOfThread = 0;
+    u64 u64AccessTime = 0, u64AllocTime = 0, u64Op;
+    jf_jiukun_cache_create_param_t jjccp;
+
+    ol_bzero(ls_jbotThread, sizeof(ls_jbotThread));
+
+    ol_bzero(&jjccp, sizeof(jjccp));
+    jjccp.jjccp_pstrName = JIUKUN_BENCH_OBJECT_CACHE;
+    jjccp.jjccp_sObj = sizeof(jiukun_bench_object_t);
+    jjccp.jjccp_jfCache = ls_jfObjectCache;
+
+    u32Ret = jf_jiukun_createCache(&ls_pjjcObject, &jjccp);
+
+    /*Allocate objects in round robin, the adjacent objects are owned by different threads.*/
+    for (u32Object = 0; (u32Object < JIUKUN_BENCH_OBJECT_PER_THREAD) && (u32Ret == JF_ERR_NO_ERROR);
+         u32Object ++)
+    {
+        for (u32Index = 0; (u32Index < ls_u32NumOfThread) && (u32Ret == JF_ERR_NO_ERROR);
+             u32Index ++)
+        {
+            u32Ret = jf_jiukun_allocObject(
+                ls_pjjcObject, (void **)&ls_jbotThread[u32Index].jbot_pjboObject[u32Object]);
+            if (u32Ret == JF_ERR_NO_ERROR)
+                ol_bzero(
+                    ls_jbotThread[u32Index].jbot_pjboObject[u32Object],
+                    sizeof(jiukun_bench_object_t));
+        }
+    }
+
+    for (u32Index = 0; (u32Index < ls_u32NumOfThread) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+    {
+        u32Ret = jf_thread_create(
+            &ls_jbotThread[u32Index].jbot_jtiThread, NULL, _benchJiukunObjectThread,
+            &ls_jbotThread[u32Index]);
+        if (u32Ret == JF_ERR_NO_ERROR)
+            u32NumOfThread ++;
+    }
+
+    for (u32Index = 0; u32Index < u32NumOfThread; u32Index ++)
+    {
+        jf_thread_waitForThreadTermination(ls_jbotThread[u32Index].jbot_jtiThread, &u32RetCode);
+        u64AccessTime += ls_jbotThread[u32Index].jbot_u64AccessTime;
+        u64AllocTime += ls_jbotThread[u32Index].jbot_u64AllocTime;
+        if ((u32Ret == JF_ERR_NO_ERROR) && (ls_jbotThread[u32Index].jbot_u32Ret != JF_ERR_NO_ERROR))
+            u32Ret = ls_jbotThread[u32Index].jbot_u32Ret;
+    }
+
+    if (ls_pjjcObject != NULL)
+    {
+        _freeJiukunBenchObject();
+        jf_jiukun_destroyCache(&ls_pjjcObject);
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ol_printf(
+            "cache flags       :%s%s%s\n",
+            JF_FLAG_GET(ls_jfObjectCache, JF_JIUKUN_CACHE_CREATE_FLAG_HWCACHE_ALIGN) ?
+            " align" : "",
+            JF_FLAG_GET(ls_jfObjectCache, JF_JIUKUN_CACHE_CREATE_FLAG_PAD) ? " pad" : "",
+            JF_FLAG_GET(ls_jfObjectCache, JF_JIUKUN_CACHE_CREATE_FLAG_COLOR) ? " color" : "");
+        ol_printf("threads           : %u\n", u32NumOfThread);
+
+        /*The time is the average of threads.*/
+        u64Op = (u64)JIUKUN_BENCH_OBJECT_ACCESS_LOOP * JIUKUN_BENCH_OBJECT_PER_THREAD;
+        u64AccessTime /= u32NumOfThread;
+        if (u64AccessTime > 0)
+            ol_printf(
+                "access            : %llu updates/s per thread\n",
+                u64Op * 1000000000 / u64AccessTime);
+
+        u64Op = (u64)JIUKUN_BENCH_OBJECT_LOOP * JIUKUN_BENCH_OBJECT_BURST * 2;
+        u64AllocTime /= u32NumOfThread;
+        if (u64AllocTime > 0)
+            ol_printf(
+                "alloc and free    : %llu ops/s per thread\n", u64Op * 1000000000 / u64AllocTime);
+    }
+
+    return u32Ret;
+}
+
+/* --- public routine section ------------------------------------------------------------------- */
+
+olint_t main(olint_t argc, olchar_t ** argv)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    olchar_t strErrMsg[300];
+    jf_logger_init_param_t jlipParam;
+    jf_jiukun_init_param_t jjip;
+
+    ol_bzero(&jlipParam, sizeof(jlipParam));
+    jlipParam.jlip_pstrCallerName = JIUKUN_BENCH;
+    jlipParam.jlip_bLogToStdout = TRUE;
+    jlipParam.jlip_u8TraceLevel = JF_LOGGER_TRACE_LEVEL_ERROR;
+
+    ol_bzero(&jjip, sizeof(jjip));
+    jjip.jjip_sPool = JF_JIUKUN_MAX_POOL_SIZE;
+
+    u32Ret = _parseJiukunBenchCmdLineParam(argc, argv, &jlipParam);
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        jf_logger_init(&jlipParam);
+
+        jjip.jjip_bNoPageCache = ls_bNoPageCache;
+        jjip.jjip_u32ProfileSample = ls_u32ProfileSample;
+
+        u32Ret = jf_jiukun_init(&jjip);
+        if (u32Ret == JF_ERR_NO_ERROR)
+        {
+            if (ls_bBenchPage)
+                u32Ret = _benchJiukunPage();
+            else if (ls_bBenchObject)
+                u32Ret = _benchJiukunObject();
+            else
+                u32Ret = _benchJiukunMessageMix();
+
+            jf_jiukun_fini();
+        }
+
+        jf_logger_fini();
+    }
+
+    if (u32Ret != JF_ERR_NO_ERROR)
+    {
+        jf_err_getMsg(u32Ret, strErrMsg, sizeof(strErrMsg));
+        ol_printf("%s\n", strErrMsg);
+    }
+
+    return u32Ret;
+}
+
+/*------------------------------------------------------------------------------------------------*/
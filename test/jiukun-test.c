@@ -47,15 +47,24 @@ boolean_t ls_bDoubleFree = FALSE;
 boolean_t ls_bUnallocatedFree = FALSE;
 boolean_t ls_bAllocateWithoutFree = FALSE;
 
+boolean_t ls_bHugePage = FALSE;
+boolean_t ls_bNuma = FALSE;
+
+boolean_t ls_bProfile = FALSE;
+
 /* --- private routine section ------------------------------------------------------------------ */
 
 static void _printUsage(void)
 {
     ol_printf("\
 Usage: jiukun-test [-t] [-j page|memory|object] [stress testing option] [allocate without free] \n\
-    [double free option] [unallocated free option] [out of bound option] [logger options]\n\
+    [double free option] [unallocated free option] [out of bound option] [pool options]\n\
+    [profile option] [logger options]\n\
     -t test in multi-threading environment.\n\
     -j specify the test target.\n\
+pool options:\n\
+    -g back the pool with huge page.\n\
+    -n create pool per NUMA node.\n\
 double free option:\n\
     -d test double free.\n\
 unallocated free option:\n\
@@ -66,6 +75,8 @@ out of bound option:\n\
     -b test out of bound.\n\
 stress testing option:\n\
     -s stress testing.\n\
+profile option:\n\
+    -p test sampled allocation of profiling in multi-threading environment.\n\
 logger options:\n\
     -T <0|1|2|3> the log level. 0: no log, 1: error only, 2: info, 3: all.\n\
     -F <log file> the log file.\n\
@@ -81,7 +92,7 @@ static u32 _parseCmdLineParam(olint_t argc, olchar_t ** argv, jf_logger_init_par
     olint_t nOpt;
     u32 u32Value;
 
-    while (((nOpt = getopt(argc, argv, "bwj:tsduOT:F:S:h")) != -1) && (u32Ret == JF_ERR_NO_ERROR))
+    while (((nOpt = getopt(argc, argv, "bwj:tsdugnpOT:F:S:h")) != -1) && (u32Ret == JF_ERR_NO_ERROR))
     {
         switch (nOpt)
         {
@@ -116,6 +127,15 @@ static u32 _parseCmdLineParam(olint_t argc, olchar_t ** argv, jf_logger_init_par
         case 'w':
             ls_bAllocateWithoutFree = TRUE;
             break;
+        case 'g':
+            ls_bHugePage = TRUE;
+            break;
+        case 'n':
+            ls_bNuma = TRUE;
+            break;
+        case 'p':
+            ls_bProfile = TRUE;
+            break;
         case 'T':
             if (sscanf(optarg, "%d", &u32Value) == 1)
                 pjlip->jlip_u8TraceLevel = (u8)u32Value;
@@ -730,6 +750,127 @@ static u32 _testJiukunOutOfBound(void)
     return u32Ret;
 }
 
+#define JIUKUN_PROFILE_TEST_THREAD      (4)
+#define JIUKUN_PROFILE_TEST_OBJECT      (1000)
+#define JIUKUN_PROFILE_TEST_LOOP_COUNT  (20)
+#define JIUKUN_PROFILE_TEST_FILE        "jiukun-test.prof"
+
+JF_THREAD_RETURN_VALUE _allocFreeSampled(void * pArg)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    void * pObj[JIUKUN_PROFILE_TEST_OBJECT];
+    u32 u32Index, u32Loop;
+
+    for (u32Loop = 0;
+         (u32Loop < JIUKUN_PROFILE_TEST_LOOP_COUNT) && (u32Ret == JF_ERR_NO_ERROR); u32Loop ++)
+    {
+        ol_bzero(pObj, sizeof(pObj));
+
+        /*All threads allocate objects from the same pages, the sampled flag of the page is set
+          concurrently.*/
+        for (u32Index = 0;
+             (u32Index < JIUKUN_PROFILE_TEST_OBJECT) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+        {
+            if ((u32Index % 2) == 0)
+                u32Ret = jf_jiukun_allocObject(ls_pacCache, &pObj[u32Index]);
+            else
+                u32Ret = jf_jiukun_allocMemory(&pObj[u32Index], 24);
+        }
+
+        for (u32Index = 0; u32Index < JIUKUN_PROFILE_TEST_OBJECT; u32Index ++)
+        {
+            if (pObj[u32Index] == NULL)
+                continue;
+
+            if ((u32Index % 2) == 0)
+                jf_jiukun_freeObject(ls_pacCache, &pObj[u32Index]);
+            else
+                jf_jiukun_freeMemory(&pObj[u32Index]);
+        }
+
+        /*The pages are returned to buddy and used by other cache, the sampled flag is cleared.*/
+        jf_jiukun_reap();
+    }
+
+    JF_THREAD_RETURN(u32Ret);
+}
+
+/** Test the sampled allocation of profiling.
+ *
+ *  @note
+ *  -# Every allocation is sampled. If the sampled flag of the page is lost, the sampled allocation
+ *   is not removed from the profile when it's freed, the profile reports live object.
+ */
+static u32 _testJiukunProfile(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_jiukun_cache_create_param_t jjccp;
+    jf_thread_id_t jtiThread[JIUKUN_PROFILE_TEST_THREAD];
+    u32 u32Index, u32RetCode;
+    FILE * fp = NULL;
+    u64 u64LiveObj = 0, u64LiveByte = 0, u64AllocObj = 0, u64AllocByte = 0;
+
+    ol_memset(&jjccp, 0, sizeof(jjccp));
+    jjccp.jjccp_pstrName = TEST_CACHE;
+    jjccp.jjccp_sObj = 24;
+
+    u32Ret = jf_jiukun_createCache(&ls_pacCache, &jjccp);
+
+    for (u32Index = 0;
+         (u32Index < JIUKUN_PROFILE_TEST_THREAD) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+    {
+        u32Ret = jf_thread_create(&jtiThread[u32Index], NULL, _allocFreeSampled, NULL);
+        if (u32Ret == JF_ERR_NO_ERROR)
+            continue;
+
+        while (u32Index > 0)
+            jf_thread_waitForThreadTermination(jtiThread[-- u32Index], &u32RetCode);
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        for (u32Index = 0; u32Index < JIUKUN_PROFILE_TEST_THREAD; u32Index ++)
+        {
+            jf_thread_waitForThreadTermination(jtiThread[u32Index], &u32RetCode);
+            if (u32Ret == JF_ERR_NO_ERROR)
+                u32Ret = u32RetCode;
+        }
+    }
+
+    if (ls_pacCache != NULL)
+        jf_jiukun_destroyCache(&ls_pacCache);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = jf_jiukun_dumpProfile(JIUKUN_PROFILE_TEST_FILE);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        fp = fopen(JIUKUN_PROFILE_TEST_FILE, "r");
+        if (fp == NULL)
+            u32Ret = JF_ERR_FAIL_OPEN_FILE;
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        if (fscanf(
+                fp, "heap profile: %llu: %llu [%llu: %llu]", &u64LiveObj, &u64LiveByte,
+                &u64AllocObj, &u64AllocByte) != 4)
+            u32Ret = JF_ERR_INVALID_DATA;
+
+        fclose(fp);
+        remove(JIUKUN_PROFILE_TEST_FILE);
+    }
+
+    ol_printf(
+        "profile, live object: %llu, live byte: %llu, allocated object: %llu\n", u64LiveObj,
+        u64LiveByte, u64AllocObj);
+
+    if ((u32Ret == JF_ERR_NO_ERROR) && ((u64LiveObj != 0) || (u64AllocObj == 0)))
+        u32Ret = JF_ERR_PROGRAM_ERROR;
+
+    return u32Ret;
+}
+
 static u32 _baseJiukunFunc(void)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
@@ -817,6 +958,11 @@ olint_t main(olint_t argc, olchar_t ** argv)
         ol_memset(&jjip, 0, sizeof(jjip));
         jjip.jjip_sPool = (1 << MAX_JIUKUN_TEST_ORDER) * JF_JIUKUN_PAGE_SIZE;
 //        jjip.jjip_bNoGrow = TRUE;
+        jjip.jjip_bHugePage = ls_bHugePage;
+        jjip.jjip_bNuma = ls_bNuma;
+        if (ls_bProfile)
+            /*Sample every allocation.*/
+            jjip.jjip_u32ProfileSample = 1;
 
         u32Ret = jf_jiukun_init(&jjip);
         if (u32Ret == JF_ERR_NO_ERROR)
@@ -833,6 +979,8 @@ olint_t main(olint_t argc, olchar_t ** argv)
                 u32Ret = _testJiukunAllocateWithoutFree();
             else if (ls_bOutOfBound)
                 u32Ret = _testJiukunOutOfBound();
+            else if (ls_bProfile)
+                u32Ret = _testJiukunProfile();
             else
                 u32Ret = _baseJiukunFunc();
 
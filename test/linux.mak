@@ -23,7 +23,10 @@ PROGRAMS = xmalloc-test hashtree-test listhead-test hlisthead-test
     archive-test user-test httpparser-test network-test linklist-test                 \
     network-test-server network-test-client network-test-client-chain                 \
     matrix-test webclient-test sqlite-test hex-test                                   \
-    utimer-test dispatcher-test-bgad dispatcher-test-sysctld
+    utimer-test dispatcher-test-bgad dispatcher-test-sysctld resolver-test acsocket-test \
+    network-bench jiukun-bench alloc-bench chashtable-bench array-test \
+    respool-bench btree-bench art-bench queue-test epoch-test \
+    threadpool-test chashtable-test
 
 SOURCES = xmalloc-test.c hashtree-test.c listhead-test.c hlisthead-test.c                       \
     listarray-test.c logger-test.c process-test.c hashtable-test.c mutex-test.c                 \
@@ -36,7 +39,10 @@ SOURCES = xmalloc-test.c hashtree-test.c listhead-test.c hlisthead-test.c
     archive-test.c user-test.c httpparser-test.c network-test.c linklist-test.c                 \
     network-test-server.c network-test-client.c network-test-client-chain.c                     \
     matrix-test.c webclient-test.c sqlite-test.c hex-test.c                                     \
-    utimer-test.c dispatcher-test-bgad.c dispatcher-test-sysctld.c
+    utimer-test.c dispatcher-test-bgad.c dispatcher-test-sysctld.c resolver-test.c             \
+    acsocket-test.c network-bench.c jiukun-bench.c alloc-bench.c \
+    chashtable-bench.c array-test.c respool-bench.c btree-bench.c art-bench.c \
+    queue-test.c epoch-test.c threadpool-test.c chashtable-test.c
 
 include $(TOPDIR)/mak/lnxobjdef.mak
 
@@ -87,10 +93,11 @@ $(BIN_DIR)/mutex-test: mutex-test.o $(JIUTAI_DIR)/jf_mutex.o $(JIUTAI_DIR)/jf_pr
 	$(CC) $(LDFLAGS) $(EXTRA_LDFLAGS) -L$(LIB_DIR) $^ -o $@ $(SYSLIBS) -ljf_logger
 
 $(BIN_DIR)/rwlock-test: rwlock-test.o $(JIUTAI_DIR)/jf_rwlock.o $(JIUTAI_DIR)/jf_process.o \
-       $(JIUTAI_DIR)/jf_thread.o
+       $(JIUTAI_DIR)/jf_thread.o $(JIUTAI_DIR)/jf_time.o $(JIUTAI_DIR)/jf_option.o
 	$(CC) $(LDFLAGS) $(EXTRA_LDFLAGS) -L$(LIB_DIR) $^ -o $@ $(SYSLIBS) -ljf_logger
 
-$(BIN_DIR)/hashtable-test: hashtable-test.o $(JIUTAI_DIR)/jf_hashtable.o $(JIUTAI_DIR)/jf_process.o
+$(BIN_DIR)/hashtable-test: hashtable-test.o $(JIUTAI_DIR)/jf_hashtable.o $(JIUTAI_DIR)/jf_process.o \
+       $(JIUTAI_DIR)/jf_time.o
 	$(CC) $(LDFLAGS) $(EXTRA_LDFLAGS) -L$(LIB_DIR) $^ -o $@ $(SYSLIBS) -ljf_logger -ljf_jiukun
 
 $(BIN_DIR)/stringparse-test: stringparse-test.o
@@ -100,7 +107,7 @@ $(BIN_DIR)/stringparse-test: stringparse-test.o
 $(BIN_DIR)/hex-test: hex-test.o $(JIUTAI_DIR)/jf_hex.o
 	$(CC) $(LDFLAGS) $(EXTRA_LDFLAGS) -L$(LIB_DIR) $^ -o $@ $(SYSLIBS) -ljf_logger
 
-$(BIN_DIR)/bitarray-test: bitarray-test.o
+$(BIN_DIR)/bitarray-test: bitarray-test.o $(JIUTAI_DIR)/jf_bitarray.o $(JIUTAI_DIR)/jf_time.o
 	$(CC) $(LDFLAGS) $(EXTRA_LDFLAGS) -L$(LIB_DIR) $^ -o $@ $(SYSLIBS) -ljf_logger -ljf_string
 
 $(BIN_DIR)/conffile-test: conffile-test.o
@@ -140,7 +147,7 @@ $(BIN_DIR)/host-test: host-test.o $(JIUTAI_DIR)/jf_host.o
 
 $(BIN_DIR)/respool-test: respool-test.o $(JIUTAI_DIR)/jf_respool.o $(JIUTAI_DIR)/jf_mutex.o \
        $(JIUTAI_DIR)/jf_array.o $(JIUTAI_DIR)/jf_process.o $(JIUTAI_DIR)/jf_sem.o \
-       $(JIUTAI_DIR)/jf_thread.o
+       $(JIUTAI_DIR)/jf_thread.o $(JIUTAI_DIR)/jf_time.o
 	$(CC) $(LDFLAGS) $(EXTRA_LDFLAGS) -L$(LIB_DIR) $^ -o $@ $(SYSLIBS) -ljf_logger -ljf_jiukun
 
 $(BIN_DIR)/bitop-test: bitop-test.o
@@ -155,6 +162,37 @@ $(BIN_DIR)/jiukun-test: jiukun-test.o $(JIUTAI_DIR)/jf_process.o $(JIUTAI_DIR)/j
        $(JIUTAI_DIR)/jf_thread.o
 	$(CC) $(LDFLAGS) $(EXTRA_LDFLAGS) -L$(LIB_DIR) $^ -o $@ $(SYSLIBS) -ljf_logger -ljf_jiukun
 
+$(BIN_DIR)/jiukun-bench: jiukun-bench.o $(JIUTAI_DIR)/jf_option.o $(JIUTAI_DIR)/jf_thread.o \
+       $(JIUTAI_DIR)/jf_time.o
+	$(CC) $(LDFLAGS) $(EXTRA_LDFLAGS) -L$(LIB_DIR) $^ -o $@ $(SYSLIBS) -ljf_logger -ljf_jiukun
+
+$(BIN_DIR)/alloc-bench: alloc-bench.o $(JIUTAI_DIR)/jf_option.o $(JIUTAI_DIR)/jf_thread.o \
+       $(JIUTAI_DIR)/jf_time.o $(JIUTAI_DIR)/jf_mutex.o
+	$(CC) $(LDFLAGS) $(EXTRA_LDFLAGS) -L$(LIB_DIR) $^ -o $@ $(SYSLIBS) -ljf_logger -ljf_jiukun
+
+$(BIN_DIR)/chashtable-bench: chashtable-bench.o $(JIUTAI_DIR)/jf_chashtable.o \
+       $(JIUTAI_DIR)/jf_hashtable.o $(JIUTAI_DIR)/jf_option.o $(JIUTAI_DIR)/jf_thread.o \
+       $(JIUTAI_DIR)/jf_time.o $(JIUTAI_DIR)/jf_mutex.o
+	$(CC) $(LDFLAGS) $(EXTRA_LDFLAGS) -L$(LIB_DIR) $^ -o $@ $(SYSLIBS) -ljf_logger -ljf_jiukun
+
+$(BIN_DIR)/chashtable-test: chashtable-test.o $(JIUTAI_DIR)/jf_chashtable.o \
+       $(JIUTAI_DIR)/jf_hashtable.o $(JIUTAI_DIR)/jf_option.o $(JIUTAI_DIR)/jf_thread.o \
+       $(JIUTAI_DIR)/jf_mutex.o
+	$(CC) $(LDFLAGS) $(EXTRA_LDFLAGS) -L$(LIB_DIR) $^ -o $@ $(SYSLIBS) -ljf_logger -ljf_jiukun
+
+$(BIN_DIR)/respool-bench: respool-bench.o $(JIUTAI_DIR)/jf_respool.o $(JIUTAI_DIR)/jf_mutex.o \
+       $(JIUTAI_DIR)/jf_array.o $(JIUTAI_DIR)/jf_thread.o $(JIUTAI_DIR)/jf_time.o \
+       $(JIUTAI_DIR)/jf_option.o
+	$(CC) $(LDFLAGS) $(EXTRA_LDFLAGS) -L$(LIB_DIR) $^ -o $@ $(SYSLIBS) -ljf_logger -ljf_jiukun
+
+$(BIN_DIR)/btree-bench: btree-bench.o $(JIUTAI_DIR)/jf_btree.o $(JIUTAI_DIR)/jf_option.o \
+       $(JIUTAI_DIR)/jf_time.o
+	$(CC) $(LDFLAGS) $(EXTRA_LDFLAGS) -L$(LIB_DIR) $^ -o $@ $(SYSLIBS) -ljf_logger -ljf_jiukun
+
+$(BIN_DIR)/art-bench: art-bench.o $(JIUTAI_DIR)/jf_art.o $(JIUTAI_DIR)/jf_option.o \
+       $(JIUTAI_DIR)/jf_time.o
+	$(CC) $(LDFLAGS) $(EXTRA_LDFLAGS) -L$(LIB_DIR) $^ -o $@ $(SYSLIBS) -ljf_logger -ljf_jiukun
+
 $(BIN_DIR)/cghash-test: cghash-test.o
 	$(CC) $(LDFLAGS) $(EXTRA_LDFLAGS) -L$(LIB_DIR) $^ -o $@ $(SYSLIBS) -ljf_cghash -ljf_logger \
        -ljf_string
@@ -211,6 +249,22 @@ $(BIN_DIR)/network-test: network-test.o $(JIUTAI_DIR)/jf_process.o $(JIUTAI_DIR)
 $(BIN_DIR)/linklist-test: linklist-test.o $(JIUTAI_DIR)/jf_linklist.o $(JIUTAI_DIR)/jf_option.o
 	$(CC) $(LDFLAGS) $(EXTRA_LDFLAGS) -L$(LIB_DIR) $^ -o $@ $(SYSLIBS) -ljf_logger -ljf_jiukun
 
+$(BIN_DIR)/array-test: array-test.o $(JIUTAI_DIR)/jf_array.o $(JIUTAI_DIR)/jf_option.o
+	$(CC) $(LDFLAGS) $(EXTRA_LDFLAGS) -L$(LIB_DIR) $^ -o $@ $(SYSLIBS) -ljf_logger -ljf_jiukun
+
+$(BIN_DIR)/queue-test: queue-test.o $(JIUTAI_DIR)/jf_queue.o $(JIUTAI_DIR)/jf_option.o \
+       $(JIUTAI_DIR)/jf_time.o
+	$(CC) $(LDFLAGS) $(EXTRA_LDFLAGS) -L$(LIB_DIR) $^ -o $@ $(SYSLIBS) -ljf_logger -ljf_jiukun
+
+$(BIN_DIR)/epoch-test: epoch-test.o $(JIUTAI_DIR)/jf_epoch.o $(JIUTAI_DIR)/jf_mutex.o \
+       $(JIUTAI_DIR)/jf_thread.o $(JIUTAI_DIR)/jf_option.o $(JIUTAI_DIR)/jf_time.o
+	$(CC) $(LDFLAGS) $(EXTRA_LDFLAGS) -L$(LIB_DIR) $^ -o $@ $(SYSLIBS) -ljf_logger -ljf_jiukun
+
+$(BIN_DIR)/threadpool-test: threadpool-test.o $(JIUTAI_DIR)/jf_threadpool.o \
+       $(JIUTAI_DIR)/jf_mutex.o $(JIUTAI_DIR)/jf_thread.o $(JIUTAI_DIR)/jf_option.o \
+       $(JIUTAI_DIR)/jf_time.o
+	$(CC) $(LDFLAGS) $(EXTRA_LDFLAGS) -L$(LIB_DIR) $^ -o $@ $(SYSLIBS) -ljf_logger -ljf_jiukun
+
 $(BIN_DIR)/dlinklist-test: dlinklist-test.o $(JIUTAI_DIR)/jf_dlinklist.o $(JIUTAI_DIR)/jf_option.o
 	$(CC) $(LDFLAGS) $(EXTRA_LDFLAGS) -L$(LIB_DIR) $^ -o $@ $(SYSLIBS) -ljf_logger -ljf_jiukun
 
@@ -246,6 +300,21 @@ $(BIN_DIR)/utimer-test: utimer-test.o $(JIUTAI_DIR)/jf_process.o $(JIUTAI_DIR)/j
 	$(CC) $(LDFLAGS) $(EXTRA_LDFLAGS) -L$(LIB_DIR) $^ -o $@ $(SYSLIBS) -ljf_network -ljf_logger \
        -ljf_ifmgmt -ljf_jiukun
 
+$(BIN_DIR)/resolver-test: resolver-test.o $(JIUTAI_DIR)/jf_process.o $(JIUTAI_DIR)/jf_thread.o \
+       $(JIUTAI_DIR)/jf_option.o
+	$(CC) $(LDFLAGS) $(EXTRA_LDFLAGS) -L$(LIB_DIR) $^ -o $@ $(SYSLIBS) -ljf_network -ljf_logger \
+       -ljf_ifmgmt -ljf_files -ljf_jiukun
+
+$(BIN_DIR)/acsocket-test: acsocket-test.o $(JIUTAI_DIR)/jf_process.o $(JIUTAI_DIR)/jf_thread.o \
+       $(JIUTAI_DIR)/jf_option.o
+	$(CC) $(LDFLAGS) $(EXTRA_LDFLAGS) -L$(LIB_DIR) $^ -o $@ $(SYSLIBS) -ljf_network -ljf_logger \
+       -ljf_ifmgmt -ljf_files -ljf_jiukun
+
+$(BIN_DIR)/network-bench: network-bench.o $(JIUTAI_DIR)/jf_process.o $(JIUTAI_DIR)/jf_thread.o \
+       $(JIUTAI_DIR)/jf_option.o
+	$(CC) $(LDFLAGS) $(EXTRA_LDFLAGS) -L$(LIB_DIR) $^ -o $@ $(SYSLIBS) -ljf_network -ljf_logger \
+       -ljf_ifmgmt -ljf_files -ljf_jiukun
+
 include $(TOPDIR)/mak/lnxobjbld.mak
 
 clean:
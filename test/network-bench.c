@@ -0,0 +1,688 @@
+/**
+ *  @file network-bench.c
+ *
+ *  @brief Microbenchmark for the async socket stack in network library.
+ *
+ *  @author Min Zhang
+ *
+ *  @note
+ *  -# An async server socket runs in its own chain and echoes the data from client. The async
+ *   client sockets are spread over multiple chains, each chain runs in its own thread.
+ *  -# Each connection sends a request with the payload and waits for the whole payload to be
+ *   echoed before sending the next one, the round trip time is the latency of the request.
+ *  -# System calls per message are from the chain statistics, CPU time per message is the CPU
+ *   time of the process including the server chain.
+ *  -# The chain is driven by select(), it's the only engine available.
+ *
+ */
+
+/* --- standard C lib header files -------------------------------------------------------------- */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+
+/* --- internal header files -------------------------------------------------------------------- */
+#include "jf_basic.h"
+#include "jf_limit.h"
+#include "jf_err.h"
+#include "jf_network.h"
+#include "jf_process.h"
+#include "jf_thread.h"
+#include "jf_time.h"
+#include "jf_jiukun.h"
+#include "jf_option.h"
+
+/* --- private data/data structure section ------------------------------------------------------ */
+
+#define NETWORK_BENCH                      "NETWORK-BENCH"
+
+#define NETWORK_BENCH_SERVER_PORT          (51256)
+
+#define NETWORK_BENCH_SERVER_BUF_SIZE      (16 * 1024)
+
+#define NETWORK_BENCH_MAX_PAYLOAD_SIZE     (1024 * 1024)
+
+#define NETWORK_BENCH_MAX_CHAIN            (64)
+
+/** The latency histogram has 1 microsecond bucket, the last bucket is for all the latency larger
+ *  than the maximum.
+ */
+#define NETWORK_BENCH_MAX_LATENCY_US       (10000)
+
+/** Timeout in second to wait for the connections or the requests.
+ */
+#define NETWORK_BENCH_TIMEOUT              (60)
+
+struct network_bench_chain;
+
+/** The client connection.
+ */
+typedef struct
+{
+    struct network_bench_chain * nbc_pnbcChain;
+    jf_network_asocket_t * nbc_pjnaAsocket;
+    /**Number of requests finished.*/
+    u32 nbc_u32Request;
+    /**Bytes received for the current request.*/
+    olsize_t nbc_sRecv;
+    /**Start time of the current request.*/
+    struct timespec nbc_tsStart;
+} network_bench_conn_t;
+
+/** The client chain.
+ */
+typedef struct network_bench_chain
+{
+    jf_network_chain_t * nbc_pjncChain;
+    jf_network_acsocket_t * nbc_pjnaAcsocket;
+    jf_thread_id_t nbc_jtiThread;
+    network_bench_conn_t * nbc_pnbcConn;
+    /**Number of connections established.*/
+    u32 nbc_u32Connected;
+    /**Number of connections finished all requests.*/
+    u32 nbc_u32Finished;
+    /**Latency statistics in nanosecond.*/
+    u64 nbc_u64TotalLatency;
+    u64 nbc_u64MinLatency;
+    u64 nbc_u64MaxLatency;
+    u32 * nbc_pu32Histogram;
+} network_bench_chain_t;
+
+static u32 ls_u32PayloadSize = 64;
+
+static u32 ls_u32ConnPerChain = 1;
+
+static u32 ls_u32NumOfChain = 1;
+
+static u32 ls_u32NumOfRequest = 10000;
+
+static u8 ls_u8SocketProfile = JF_NETWORK_SOCKET_PROFILE_DEFAULT;
+
+static u8 * ls_pu8Payload = NULL;
+
+static jf_network_chain_t * ls_pjncServerChain = NULL;
+
+static jf_network_assocket_t * ls_pjnaServer = NULL;
+
+static network_bench_chain_t ls_nbcChain[NETWORK_BENCH_MAX_CHAIN];
+
+static boolean_t ls_bToTerminateBench = FALSE;
+
+/* --- private routine section ------------------------------------------------------------------ */
+
+static void _printNetworkBenchUsage(void)
+{
+    ol_printf("\
+Usage: network-bench [-s payload size] [-c connections] [-n chains] [-r requests] \n\
+    [-p profile] [-h] [logger options] \n\
+    -s the size of payload in byte, 64 by default.\n\
+    -c number of connections per chain, 1 by default.\n\
+    -n number of client chains, 1 by default.\n\
+    -r number of requests per connection, 10000 by default.\n\
+    -p the socket profile. 0: default, 1: low latency, 2: bulk.\n\
+    -h print the usage.\n\
+logger options:\n\
+    -T <0|1|2|3|4> the log level. 0: no log, 1: error, 2: info, 3: debug, 4: data.\n\
+    -F <log file> the log file.\n\
+    -S <log file size> the size of log file. No limit if not specified.\n\
+    ");
+
+    ol_printf("\n");
+
+    exit(0);
+}
+
+static u32 _parseNetworkBenchCmdLineParam(
+    olint_t argc, olchar_t ** argv, jf_logger_init_param_t * pjlip)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    olint_t nOpt;
+
+    while (((nOpt = getopt(argc, argv, "s:c:n:r:p:T:F:S:h")) != -1) &&
+           (u32Ret == JF_ERR_NO_ERROR))
+    {
+        switch (nOpt)
+        {
+        case '?':
+        case 'h':
+            _printNetworkBenchUsage();
+            exit(0);
+            break;
+        case ':':
+            u32Ret = JF_ERR_MISSING_PARAM;
+            break;
+        case 's':
+            u32Ret = jf_option_getU32FromString(optarg, &ls_u32PayloadSize);
+            if ((u32Ret == JF_ERR_NO_ERROR) &&
+                ((ls_u32PayloadSize == 0) || (ls_u32PayloadSize > NETWORK_BENCH_MAX_PAYLOAD_SIZE)))
+                u32Ret = JF_ERR_INVALID_PARAM;
+            break;
+        case 'c':
+            u32Ret = jf_option_getU32FromString(optarg, &ls_u32ConnPerChain);
+            if ((u32Ret == JF_ERR_NO_ERROR) && (ls_u32ConnPerChain == 0))
+                u32Ret = JF_ERR_INVALID_PARAM;
+            break;
+        case 'n':
+            u32Ret = jf_option_getU32FromString(optarg, &ls_u32NumOfChain);
+            if ((u32Ret == JF_ERR_NO_ERROR) &&
+                ((ls_u32NumOfChain == 0) || (ls_u32NumOfChain > NETWORK_BENCH_MAX_CHAIN)))
+                u32Ret = JF_ERR_INVALID_PARAM;
+            break;
+        case 'r':
+            u32Ret = jf_option_getU32FromString(optarg, &ls_u32NumOfRequest);
+            if ((u32Ret == JF_ERR_NO_ERROR) && (ls_u32NumOfRequest == 0))
+                u32Ret = JF_ERR_INVALID_PARAM;
+            break;
+        case 'p':
+            u32Ret = jf_option_getU8FromString(optarg, &ls_u8SocketProfile);
+            if ((u32Ret == JF_ERR_NO_ERROR) &&
+                (ls_u8SocketProfile > JF_NETWORK_SOCKET_PROFILE_BULK))
+                u32Ret = JF_ERR_INVALID_PARAM;
+            break;
+        case 'T':
+            u32Ret = jf_option_getU8FromString(optarg, &pjlip->jlip_u8TraceLevel);
+            break;
+        case 'F':
+            pjlip->jlip_bLogToFile = TRUE;
+            pjlip->jlip_pstrLogFilePath = optarg;
+            break;
+        case 'S':
+            u32Ret = jf_option_getS32FromString(optarg, &pjlip->jlip_sLogFile);
+            break;
+        default:
+            u32Ret = JF_ERR_INVALID_OPTION;
+            break;
+        }
+    }
+
+    return u32Ret;
+}
+
+static void _terminate(olint_t signal)
+{
+    ol_printf("get signal\n");
+
+    ls_bToTerminateBench = TRUE;
+}
+
+static u64 _getBenchTime(clockid_t clkid)
+{
+    struct timespec ts;
+
+    jf_time_getClockTime(clkid, &ts);
+
+    return (u64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static u32 _serverOnConnect(
+    jf_network_assocket_t * pAssocket, jf_network_asocket_t * pAsocket, void ** ppUser)
+{
+    return JF_ERR_NO_ERROR;
+}
+
+static u32 _serverOnDisconnect(
+    jf_network_assocket_t * pAssocket, jf_network_asocket_t * pAsocket, u32 u32Status,
+    void * pUser)
+{
+    return JF_ERR_NO_ERROR;
+}
+
+static u32 _serverOnData(
+    jf_network_assocket_t * pAssocket, jf_network_asocket_t * pAsocket, u8 * pu8Buffer,
+    olsize_t * psBeginPointer, olsize_t sEndPointer, void * pUser)
+{
+    /*echo the data*/
+    jf_network_sendAssocketData(
+        pAssocket, pAsocket, pu8Buffer + *psBeginPointer, sEndPointer - *psBeginPointer);
+
+    *psBeginPointer = sEndPointer;
+
+    return JF_ERR_NO_ERROR;
+}
+
+static u32 _sendBenchRequest(network_bench_conn_t * pnbc)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+
+    pnbc->nbc_sRecv = 0;
+    jf_time_getClockTime(CLOCK_MONOTONIC, &pnbc->nbc_tsStart);
+
+    u32Ret = jf_network_sendAcsocketStaticData(
+        pnbc->nbc_pnbcChain->nbc_pjnaAcsocket, pnbc->nbc_pjnaAsocket, ls_pu8Payload,
+        ls_u32PayloadSize);
+
+    return u32Ret;
+}
+
+static void _recordBenchLatency(network_bench_conn_t * pnbc)
+{
+    network_bench_chain_t * pnbcChain = pnbc->nbc_pnbcChain;
+    struct timespec tsEnd;
+    u64 u64Latency = 0, u64Us = 0;
+
+    jf_time_getClockTime(CLOCK_MONOTONIC, &tsEnd);
+    u64Latency = (u64)(tsEnd.tv_sec - pnbc->nbc_tsStart.tv_sec) * 1000000000 +
+        tsEnd.tv_nsec - pnbc->nbc_tsStart.tv_nsec;
+
+    pnbcChain->nbc_u64TotalLatency += u64Latency;
+    if ((pnbcChain->nbc_u64MinLatency == 0) || (u64Latency < pnbcChain->nbc_u64MinLatency))
+        pnbcChain->nbc_u64MinLatency = u64Latency;
+    if (u64Latency > pnbcChain->nbc_u64MaxLatency)
+        pnbcChain->nbc_u64MaxLatency = u64Latency;
+
+    u64Us = u64Latency / 1000;
+    if (u64Us > NETWORK_BENCH_MAX_LATENCY_US)
+        u64Us = NETWORK_BENCH_MAX_LATENCY_US;
+    pnbcChain->nbc_pu32Histogram[u64Us] ++;
+}
+
+static u32 _clientOnConnect(
+    jf_network_acsocket_t * pAcsocket, jf_network_asocket_t * pAsocket, u32 u32Status,
+    void * pUser)
+{
+    network_bench_conn_t * pnbc = pUser;
+
+    if (u32Status == JF_ERR_NO_ERROR)
+    {
+        pnbc->nbc_pjnaAsocket = pAsocket;
+        pnbc->nbc_pnbcChain->nbc_u32Connected ++;
+    }
+    else
+    {
+        jf_logger_logErrMsg(u32Status, "bench client fails to connect");
+    }
+
+    return JF_ERR_NO_ERROR;
+}
+
+static u32 _clientOnDisconnect(
+    jf_network_acsocket_t * pAcsocket, jf_network_asocket_t * pAsocket, u32 u32Status,
+    void * pUser)
+{
+    return JF_ERR_NO_ERROR;
+}
+
+static u32 _clientOnData(
+    jf_network_acsocket_t * pAcsocket, jf_network_asocket_t * pAsocket, u8 * pu8Buffer,
+    olsize_t * psBeginPointer, olsize_t sEndPointer, void * pUser)
+{
+    network_bench_conn_t * pnbc = pUser;
+
+    pnbc->nbc_sRecv += sEndPointer - *psBeginPointer;
+    *psBeginPointer = sEndPointer;
+
+    if (pnbc->nbc_sRecv >= ls_u32PayloadSize)
+    {
+        /*The whole payload is echoed*/
+        _recordBenchLatency(pnbc);
+        pnbc->nbc_u32Request ++;
+
+        if (pnbc->nbc_u32Request < ls_u32NumOfRequest)
+            _sendBenchRequest(pnbc);
+        else
+            pnbc->nbc_pnbcChain->nbc_u32Finished ++;
+    }
+
+    return JF_ERR_NO_ERROR;
+}
+
+JF_THREAD_RETURN_VALUE _benchChainThread(void * pArg)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_network_chain_t * pjncChain = pArg;
+
+    u32Ret = jf_network_startChain(pjncChain);
+
+    JF_THREAD_RETURN(u32Ret);
+}
+
+static u32 _createBenchServer(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_network_assocket_create_param_t jnascp;
+
+    u32Ret = jf_network_createChain(&ls_pjncServerChain);
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ol_bzero(&jnascp, sizeof(jnascp));
+        jnascp.jnacp_sInitialBuf = NETWORK_BENCH_SERVER_BUF_SIZE;
+        jnascp.jnacp_u32MaxConn = ls_u32ConnPerChain * ls_u32NumOfChain;
+        jf_ipaddr_getIpAddrFromString("127.0.0.1", JF_IPADDR_TYPE_V4, &jnascp.jnacp_jiServer);
+        jnascp.jnacp_u16ServerPort = NETWORK_BENCH_SERVER_PORT;
+        jnascp.jnacp_u8SocketProfile = ls_u8SocketProfile;
+        jnascp.jnacp_fnOnConnect = _serverOnConnect;
+        jnascp.jnacp_fnOnDisconnect = _serverOnDisconnect;
+        jnascp.jnacp_fnOnData = _serverOnData;
+        jnascp.jnacp_pstrName = "bench-server";
+
+        u32Ret = jf_network_createAssocket(ls_pjncServerChain, &ls_pjnaServer, &jnascp);
+    }
+
+    return u32Ret;
+}
+
+static u32 _createBenchClient(u32 u32Index, network_bench_chain_t * pnbc)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_network_acsocket_create_param_t jnacp;
+    olchar_t strName[JF_NETWORK_MAX_NAME_LEN];
+    u32 u32Conn = 0;
+
+    u32Ret = jf_network_createChain(&pnbc->nbc_pjncChain);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = jf_jiukun_allocMemory(
+            (void **)&pnbc->nbc_pnbcConn, ls_u32ConnPerChain * sizeof(network_bench_conn_t));
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ol_bzero(pnbc->nbc_pnbcConn, ls_u32ConnPerChain * sizeof(network_bench_conn_t));
+        for (u32Conn = 0; u32Conn < ls_u32ConnPerChain; u32Conn ++)
+            pnbc->nbc_pnbcConn[u32Conn].nbc_pnbcChain = pnbc;
+
+        u32Ret = jf_jiukun_allocMemory(
+            (void **)&pnbc->nbc_pu32Histogram, (NETWORK_BENCH_MAX_LATENCY_US + 1) * sizeof(u32));
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ol_bzero(pnbc->nbc_pu32Histogram, (NETWORK_BENCH_MAX_LATENCY_US + 1) * sizeof(u32));
+
+        ol_bzero(&jnacp, sizeof(jnacp));
+        ol_snprintf(strName, sizeof(strName), "bench-client-%u", u32Index);
+        jnacp.jnacp_sInitialBuf = ls_u32PayloadSize;
+        jnacp.jnacp_u32MaxConn = ls_u32ConnPerChain;
+        jnacp.jnacp_u8SocketProfile = ls_u8SocketProfile;
+        jnacp.jnacp_fnOnConnect = _clientOnConnect;
+        jnacp.jnacp_fnOnDisconnect = _clientOnDisconnect;
+        jnacp.jnacp_fnOnData = _clientOnData;
+        jnacp.jnacp_pstrName = strName;
+
+        u32Ret = jf_network_createAcsocket(pnbc->nbc_pjncChain, &pnbc->nbc_pjnaAcsocket, &jnacp);
+    }
+
+    return u32Ret;
+}
+
+static void _destroyBenchClient(network_bench_chain_t * pnbc)
+{
+    if (pnbc->nbc_pjnaAcsocket != NULL)
+        jf_network_destroyAcsocket(&pnbc->nbc_pjnaAcsocket);
+
+    if (pnbc->nbc_pjncChain != NULL)
+        jf_network_destroyChain(&pnbc->nbc_pjncChain);
+
+    if (pnbc->nbc_pnbcConn != NULL)
+        jf_jiukun_freeMemory((void **)&pnbc->nbc_pnbcConn);
+
+    if (pnbc->nbc_pu32Histogram != NULL)
+        jf_jiukun_freeMemory((void **)&pnbc->nbc_pu32Histogram);
+}
+
+/** Wait until the counter of all chains reaches the expected value.
+ */
+static u32 _waitBenchChain(size_t sOffset, u32 u32Expected)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Index = 0, u32Total = 0, u32Wait = 0;
+
+    do
+    {
+        jf_time_milliSleep(1);
+
+        u32Total = 0;
+        for (u32Index = 0; u32Index < ls_u32NumOfChain; u32Index ++)
+            u32Total += *(u32 *)((u8 *)&ls_nbcChain[u32Index] + sOffset);
+
+        u32Wait ++;
+        if ((u32Wait > NETWORK_BENCH_TIMEOUT * 1000) || ls_bToTerminateBench)
+            u32Ret = JF_ERR_TIMEOUT;
+    } while ((u32Total < u32Expected) && (u32Ret == JF_ERR_NO_ERROR));
+
+    return u32Ret;
+}
+
+static void _addBenchChainStat(jf_network_chain_t * pjncChain, jf_network_chain_stat_t * pStat)
+{
+    jf_network_chain_stat_t stat;
+
+    jf_network_getChainStat(pjncChain, &stat);
+
+    pStat->jncs_u64Select += stat.jncs_u64Select;
+    pStat->jncs_u64Wakeup += stat.jncs_u64Wakeup;
+    pStat->jncs_u64WakeupRecv += stat.jncs_u64WakeupRecv;
+    pStat->jncs_u64Send += stat.jncs_u64Send;
+    pStat->jncs_u64Recv += stat.jncs_u64Recv;
+    pStat->jncs_u64SockOpt += stat.jncs_u64SockOpt;
+    pStat->jncs_u64BytesSent += stat.jncs_u64BytesSent;
+    pStat->jncs_u64BytesRecv += stat.jncs_u64BytesRecv;
+}
+
+static u64 _getBenchLatencyPercentile(u32 * pu32Histogram, u64 u64Total, u32 u32Percent)
+{
+    u64 u64Count = 0, u64Target = (u64Total * u32Percent + 99) / 100;
+    u32 u32Us = 0;
+
+    for (u32Us = 0; u32Us < NETWORK_BENCH_MAX_LATENCY_US; u32Us ++)
+    {
+        u64Count += pu32Histogram[u32Us];
+        if (u64Count >= u64Target)
+            break;
+    }
+
+    return u32Us;
+}
+
+static void _printBenchResult(u64 u64Wall, u64 u64Cpu)
+{
+    u64 u64Msg = (u64)ls_u32NumOfRequest * ls_u32ConnPerChain * ls_u32NumOfChain;
+    u64 u64TotalLatency = 0, u64MinLatency = 0, u64MaxLatency = 0;
+    u32 * pu32Histogram = ls_nbcChain[0].nbc_pu32Histogram;
+    jf_network_chain_stat_t stat;
+    u32 u32Index = 0, u32Us = 0;
+    oldouble_t dbSec = (oldouble_t)u64Wall / 1000000000;
+
+    ol_bzero(&stat, sizeof(stat));
+    _addBenchChainStat(ls_pjncServerChain, &stat);
+
+    /*Merge the statistics of all client chains to the first one*/
+    for (u32Index = 0; u32Index < ls_u32NumOfChain; u32Index ++)
+    {
+        _addBenchChainStat(ls_nbcChain[u32Index].nbc_pjncChain, &stat);
+
+        u64TotalLatency += ls_nbcChain[u32Index].nbc_u64TotalLatency;
+        if ((u64MinLatency == 0) || (ls_nbcChain[u32Index].nbc_u64MinLatency < u64MinLatency))
+            u64MinLatency = ls_nbcChain[u32Index].nbc_u64MinLatency;
+        if (ls_nbcChain[u32Index].nbc_u64MaxLatency > u64MaxLatency)
+            u64MaxLatency = ls_nbcChain[u32Index].nbc_u64MaxLatency;
+
+        if (u32Index > 0)
+            for (u32Us = 0; u32Us <= NETWORK_BENCH_MAX_LATENCY_US; u32Us ++)
+                pu32Histogram[u32Us] += ls_nbcChain[u32Index].nbc_pu32Histogram[u32Us];
+    }
+
+    ol_printf("engine: select, profile: %u\n", ls_u8SocketProfile);
+    ol_printf("payload: %u bytes, chains: %u, connections per chain: %u, requests: %llu\n",
+              ls_u32PayloadSize, ls_u32NumOfChain, ls_u32ConnPerChain, u64Msg);
+    ol_printf("elapsed: %.3f s, throughput: %.0f msg/s, %.2f MB/s\n",
+              dbSec, u64Msg / dbSec, u64Msg * ls_u32PayloadSize / dbSec / (1024 * 1024));
+    ol_printf("latency (us): avg %.1f, min %.1f, max %.1f, p50 %llu, p99 %llu\n",
+              (oldouble_t)u64TotalLatency / u64Msg / 1000, (oldouble_t)u64MinLatency / 1000,
+              (oldouble_t)u64MaxLatency / 1000,
+              _getBenchLatencyPercentile(pu32Histogram, u64Msg, 50),
+              _getBenchLatencyPercentile(pu32Histogram, u64Msg, 99));
+    ol_printf("cpu: %.2f us/msg\n", (oldouble_t)u64Cpu / u64Msg / 1000);
+    ol_printf("syscalls per message: select %.2f, wakeup send %.2f, wakeup recv %.2f, "
+              "send %.2f, recv %.2f, setsockopt %.2f, total %.2f\n",
+              (oldouble_t)stat.jncs_u64Select / u64Msg, (oldouble_t)stat.jncs_u64Wakeup / u64Msg,
+              (oldouble_t)stat.jncs_u64WakeupRecv / u64Msg, (oldouble_t)stat.jncs_u64Send / u64Msg,
+              (oldouble_t)stat.jncs_u64Recv / u64Msg, (oldouble_t)stat.jncs_u64SockOpt / u64Msg,
+              (oldouble_t)(stat.jncs_u64Select + stat.jncs_u64Wakeup + stat.jncs_u64WakeupRecv +
+                           stat.jncs_u64Send + stat.jncs_u64Recv + stat.jncs_u64SockOpt) / u64Msg);
+}
+
+static u32 _runNetworkBench(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_ipaddr_t jiServer;
+    u32 u32Index = 0, u32Conn = 0;
+    u64 u64Wall = 0, u64Cpu = 0;
+    network_bench_chain_t * pnbc = NULL;
+
+    jf_ipaddr_getIpAddrFromString("127.0.0.1", JF_IPADDR_TYPE_V4, &jiServer);
+
+    for (u32Index = 0; (u32Index < ls_u32NumOfChain) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+    {
+        pnbc = &ls_nbcChain[u32Index];
+        for (u32Conn = 0; (u32Conn < ls_u32ConnPerChain) && (u32Ret == JF_ERR_NO_ERROR); u32Conn ++)
+            u32Ret = jf_network_connectAcsocketTo(
+                pnbc->nbc_pjnaAcsocket, &jiServer, NETWORK_BENCH_SERVER_PORT,
+                &pnbc->nbc_pnbcConn[u32Conn]);
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = _waitBenchChain(
+            offsetof(network_bench_chain_t, nbc_u32Connected), ls_u32ConnPerChain * ls_u32NumOfChain);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        /*Connection setup is not counted*/
+        jf_network_clearChainStat(ls_pjncServerChain);
+        for (u32Index = 0; u32Index < ls_u32NumOfChain; u32Index ++)
+            jf_network_clearChainStat(ls_nbcChain[u32Index].nbc_pjncChain);
+
+        u64Wall = _getBenchTime(CLOCK_MONOTONIC);
+        u64Cpu = _getBenchTime(CLOCK_PROCESS_CPUTIME_ID);
+
+        for (u32Index = 0; u32Index < ls_u32NumOfChain; u32Index ++)
+            for (u32Conn = 0; u32Conn < ls_u32ConnPerChain; u32Conn ++)
+                _sendBenchRequest(&ls_nbcChain[u32Index].nbc_pnbcConn[u32Conn]);
+
+        u32Ret = _waitBenchChain(
+            offsetof(network_bench_chain_t, nbc_u32Finished), ls_u32ConnPerChain * ls_u32NumOfChain);
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        u64Wall = _getBenchTime(CLOCK_MONOTONIC) - u64Wall;
+        u64Cpu = _getBenchTime(CLOCK_PROCESS_CPUTIME_ID) - u64Cpu;
+
+        _printBenchResult(u64Wall, u64Cpu);
+    }
+
+    return u32Ret;
+}
+
+static u32 _startNetworkBench(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_thread_id_t serverthreadid;
+    u32 u32Index = 0, u32NumOfThread = 0, u32RetCode = 0;
+
+    u32Ret = jf_jiukun_allocMemory((void **)&ls_pu8Payload, ls_u32PayloadSize);
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ol_memset(ls_pu8Payload, 'a', ls_u32PayloadSize);
+
+        u32Ret = _createBenchServer();
+    }
+
+    for (u32Index = 0; (u32Index < ls_u32NumOfChain) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+        u32Ret = _createBenchClient(u32Index, &ls_nbcChain[u32Index]);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = jf_thread_create(&serverthreadid, NULL, _benchChainThread, ls_pjncServerChain);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        for (u32NumOfThread = 0;
+             (u32NumOfThread < ls_u32NumOfChain) && (u32Ret == JF_ERR_NO_ERROR); u32NumOfThread ++)
+            u32Ret = jf_thread_create(
+                &ls_nbcChain[u32NumOfThread].nbc_jtiThread, NULL, _benchChainThread,
+                ls_nbcChain[u32NumOfThread].nbc_pjncChain);
+
+        if (u32Ret == JF_ERR_NO_ERROR)
+            u32Ret = _runNetworkBench();
+
+        /*Stop the client chains which are started*/
+        for (u32Index = 0; u32Index < u32NumOfThread; u32Index ++)
+        {
+            jf_network_stopChain(ls_nbcChain[u32Index].nbc_pjncChain);
+            jf_thread_waitForThreadTermination(ls_nbcChain[u32Index].nbc_jtiThread, &u32RetCode);
+        }
+
+        jf_network_stopChain(ls_pjncServerChain);
+        jf_thread_waitForThreadTermination(serverthreadid, &u32RetCode);
+    }
+
+    for (u32Index = 0; u32Index < ls_u32NumOfChain; u32Index ++)
+        _destroyBenchClient(&ls_nbcChain[u32Index]);
+
+    if (ls_pjnaServer != NULL)
+        jf_network_destroyAssocket(&ls_pjnaServer);
+
+    if (ls_pjncServerChain != NULL)
+        jf_network_destroyChain(&ls_pjncServerChain);
+
+    if (ls_pu8Payload != NULL)
+        jf_jiukun_freeMemory((void **)&ls_pu8Payload);
+
+    return u32Ret;
+}
+
+/* --- public routine section ------------------------------------------------------------------- */
+
+olint_t main(olint_t argc, olchar_t ** argv)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    olchar_t strErrMsg[300];
+    jf_logger_init_param_t jlipParam;
+    jf_jiukun_init_param_t jjip;
+
+    ol_bzero(&jlipParam, sizeof(jlipParam));
+    jlipParam.jlip_pstrCallerName = NETWORK_BENCH;
+    jlipParam.jlip_bLogToStdout = TRUE;
+    jlipParam.jlip_u8TraceLevel = JF_LOGGER_TRACE_LEVEL_ERROR;
+
+    ol_bzero(&jjip, sizeof(jjip));
+    jjip.jjip_sPool = JF_JIUKUN_MAX_POOL_SIZE;
+
+    ol_bzero(ls_nbcChain, sizeof(ls_nbcChain));
+
+    u32Ret = _parseNetworkBenchCmdLineParam(argc, argv, &jlipParam);
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        jf_logger_init(&jlipParam);
+
+        u32Ret = jf_jiukun_init(&jjip);
+        if (u32Ret == JF_ERR_NO_ERROR)
+        {
+            u32Ret = jf_process_initSocket();
+            if (u32Ret == JF_ERR_NO_ERROR)
+            {
+                u32Ret = jf_process_registerSignalHandlers(_terminate);
+                if (u32Ret == JF_ERR_NO_ERROR)
+                    u32Ret = _startNetworkBench();
+
+                jf_process_finiSocket();
+            }
+
+            jf_jiukun_fini();
+        }
+
+        jf_logger_fini();
+    }
+
+    if (u32Ret != JF_ERR_NO_ERROR)
+    {
+        jf_err_getMsg(u32Ret, strErrMsg, 300);
+        ol_printf("%s\n", strErrMsg);
+    }
+
+    return u32Ret;
+}
+
+/*------------------------------------------------------------------------------------------------*/
+
+
@@ -0,0 +1,498 @@
+/**
+ *  @file queue-test.c
+ *
+ *  @brief Test file for queue and stack defined in jf_queue and jf_stack object.
+ *
+ *  @author Min Zhang
+ *
+ *  @note
+ *  -# The intrusive queue, ring queue and intrusive stack are checked against the item order.
+ *  -# The benchmark compares the queue allocating node for each item with the intrusive queue and
+ *   ring queue, the items are enqueued and dequeued in bursts.
+ *
+ */
+
+/* --- standard C lib header files -------------------------------------------------------------- */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* --- internal header files -------------------------------------------------------------------- */
+#include "jf_basic.h"
+#include "jf_limit.h"
+#include "jf_err.h"
+#include "jf_jiukun.h"
+#include "jf_option.h"
+#include "jf_time.h"
+#include "jf_queue.h"
+#include "jf_stack.h"
+
+/* --- private data/data structure section ------------------------------------------------------ */
+
+#define QUEUE_TEST_NUM_OF_ITEM           (1000)
+
+#define QUEUE_TEST_RING_CAPACITY         (100)
+
+#define QUEUE_TEST_BENCH_BURST           (64)
+
+#define QUEUE_TEST_BENCH_ROUND           (200000)
+
+/** The item in queue and stack.
+ */
+typedef struct
+{
+    u32 qti_u32Index;
+    u32 qti_u32Reserved;
+    jf_queue_link_t qti_jqlQueue;
+    jf_stack_link_t qti_jslStack;
+} queue_test_item_t;
+
+static boolean_t ls_bQueue = FALSE;
+
+static boolean_t ls_bBench = FALSE;
+
+static queue_test_item_t ls_qtiItem[QUEUE_TEST_NUM_OF_ITEM];
+
+/* --- private routine section ------------------------------------------------------------------ */
+
+static void _printQueueTestUsage(void)
+{
+    ol_printf("\
+Usage: queue-test [-q] [-b] \n\
+    [-T <trace level>] [-F <trace log file>] [-S <trace file size>]\n\
+  -q test intrusive queue, ring queue and intrusive stack.\n\
+  -b benchmark queues.\n");
+
+    ol_printf("\n");
+}
+
+static u32 _parseQueueTestCmdLineParam(
+    olint_t argc, olchar_t ** argv, jf_logger_init_param_t * pjlip)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    olint_t nOpt;
+
+    while (((nOpt = getopt(argc, argv, "qbT:F:S:h")) != -1) &&
+           (u32Ret == JF_ERR_NO_ERROR))
+    {
+        switch (nOpt)
+        {
+        case '?':
+        case 'h':
+            _printQueueTestUsage();
+            exit(0);
+            break;
+        case 'q':
+            ls_bQueue = TRUE;
+            break;
+        case 'b':
+            ls_bBench = TRUE;
+            break;
+        case 'T':
+            u32Ret = jf_option_getU8FromString(optarg, &pjlip->jlip_u8TraceLevel);
+            break;
+        case 'F':
+            pjlip->jlip_bLogToFile = TRUE;
+            pjlip->jlip_pstrLogFilePath = optarg;
+            break;
+        case 'S':
+            u32Ret = jf_option_getS32FromString(optarg, &pjlip->jlip_sLogFile);
+            break;
+        default:
+            u32Ret = JF_ERR_INVALID_OPTION;
+            break;
+        }
+    }
+
+    return u32Ret;
+}
+
+static u64 _getQueueTestTime(void)
+{
+    struct timespec ts;
+
+    jf_time_getClockTime(CLOCK_MONOTONIC, &ts);
+
+    return (u64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static u32 _checkQueueTestItem(const olchar_t * pstrOp, queue_test_item_t * pqti, u32 u32Expected)
+{
+    if ((pqti == NULL) || (pqti->qti_u32Index != u32Expected))
+    {
+        ol_printf(
+            "%s: item %d, expected %u\n", pstrOp, (pqti == NULL) ? -1 : (olint_t)pqti->qti_u32Index,
+            u32Expected);
+        return JF_ERR_INVALID_DATA;
+    }
+
+    return JF_ERR_NO_ERROR;
+}
+
+static queue_test_item_t * _dequeueQueueTestItem(jf_iqueue_t * pjiq)
+{
+    jf_queue_link_t * pjql = jf_iqueue_dequeue(pjiq);
+
+    if (pjql == NULL)
+        return NULL;
+
+    return jf_iqueue_getEntry(pjql, queue_test_item_t, qti_jqlQueue);
+}
+
+/** Enqueue and dequeue items in rounds, the queue is emptied in each round.
+ */
+static u32 _testIqueue(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_iqueue_t jiq;
+    u32 u32Head = 0, u32Tail = 0, u32Round, u32Index;
+
+    jf_iqueue_init(&jiq);
+
+    for (u32Round = 1; (u32Round < 40) && (u32Ret == JF_ERR_NO_ERROR); u32Round ++)
+    {
+        /*Enqueue more items than dequeue in each round.*/
+        for (u32Index = 0; u32Index < u32Round; u32Index ++)
+        {
+            jf_iqueue_enqueue(&jiq, &ls_qtiItem[u32Tail % QUEUE_TEST_NUM_OF_ITEM].qti_jqlQueue);
+            u32Tail ++;
+        }
+
+        for (u32Index = 0; (u32Index < u32Round / 2) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+        {
+            u32Ret = _checkQueueTestItem(
+                "iqueue peek",
+                jf_iqueue_getEntry(jf_iqueue_peek(&jiq), queue_test_item_t, qti_jqlQueue),
+                u32Head % QUEUE_TEST_NUM_OF_ITEM);
+
+            if (u32Ret == JF_ERR_NO_ERROR)
+                u32Ret = _checkQueueTestItem(
+                    "iqueue dequeue", _dequeueQueueTestItem(&jiq),
+                    u32Head % QUEUE_TEST_NUM_OF_ITEM);
+            u32Head ++;
+        }
+    }
+
+    while ((u32Head < u32Tail) && (u32Ret == JF_ERR_NO_ERROR))
+    {
+        u32Ret = _checkQueueTestItem(
+            "iqueue dequeue", _dequeueQueueTestItem(&jiq), u32Head % QUEUE_TEST_NUM_OF_ITEM);
+        u32Head ++;
+    }
+
+    if ((u32Ret == JF_ERR_NO_ERROR) &&
+        ((! jf_iqueue_isEmpty(&jiq)) || (_dequeueQueueTestItem(&jiq) != NULL)))
+    {
+        ol_printf("iqueue: queue is not empty\n");
+        u32Ret = JF_ERR_INVALID_DATA;
+    }
+
+    /*The queue is still usable after it's empty.*/
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        jf_iqueue_enqueue(&jiq, &ls_qtiItem[7].qti_jqlQueue);
+        u32Ret = _checkQueueTestItem("iqueue dequeue", _dequeueQueueTestItem(&jiq), 7);
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        ol_printf("iqueue: %u items are enqueued and dequeued in order\n", u32Tail);
+
+    return u32Ret;
+}
+
+static u32 _testRingqueueWrap(jf_ringqueue_t * pjrq, u32 u32Start)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Head = 0, u32Tail = 0, u32Round, u32Index;
+
+    /*The index is not wrapped, test the index crossing the maximum of u32.*/
+    pjrq->jrq_u32Head = pjrq->jrq_u32Tail = u32Start;
+
+    for (u32Round = 0; (u32Round < 50) && (u32Ret == JF_ERR_NO_ERROR); u32Round ++)
+    {
+        for (u32Index = 0; (u32Index < 13) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+        {
+            if (jf_ringqueue_isFull(pjrq))
+                break;
+
+            u32Ret = jf_ringqueue_enqueue(pjrq, &ls_qtiItem[u32Tail % QUEUE_TEST_NUM_OF_ITEM]);
+            u32Tail ++;
+        }
+
+        for (u32Index = 0; (u32Index < 11) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+        {
+            u32Ret = _checkQueueTestItem(
+                "ringqueue peek", jf_ringqueue_peek(pjrq), u32Head % QUEUE_TEST_NUM_OF_ITEM);
+
+            if (u32Ret == JF_ERR_NO_ERROR)
+                u32Ret = _checkQueueTestItem(
+                    "ringqueue dequeue", jf_ringqueue_dequeue(pjrq),
+                    u32Head % QUEUE_TEST_NUM_OF_ITEM);
+            u32Head ++;
+        }
+
+        if ((u32Ret == JF_ERR_NO_ERROR) && (jf_ringqueue_getSize(pjrq) != u32Tail - u32Head))
+        {
+            ol_printf(
+                "ringqueue: size %u, expected %u\n", jf_ringqueue_getSize(pjrq),
+                u32Tail - u32Head);
+            u32Ret = JF_ERR_INVALID_DATA;
+        }
+    }
+
+    while ((u32Head < u32Tail) && (u32Ret == JF_ERR_NO_ERROR))
+    {
+        u32Ret = _checkQueueTestItem(
+            "ringqueue dequeue", jf_ringqueue_dequeue(pjrq), u32Head % QUEUE_TEST_NUM_OF_ITEM);
+        u32Head ++;
+    }
+
+    if ((u32Ret == JF_ERR_NO_ERROR) && (jf_ringqueue_dequeue(pjrq) != NULL))
+    {
+        ol_printf("ringqueue: queue is not empty\n");
+        u32Ret = JF_ERR_INVALID_DATA;
+    }
+
+    return u32Ret;
+}
+
+static u32 _testRingqueue(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_ringqueue_t jrq;
+    u32 u32Index;
+
+    if (jf_ringqueue_init(&jrq, 0) != JF_ERR_INVALID_PARAM)
+    {
+        ol_printf("ringqueue: queue with 0 capacity is initialized\n");
+        u32Ret = JF_ERR_INVALID_DATA;
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = jf_ringqueue_init(&jrq, QUEUE_TEST_RING_CAPACITY);
+
+    /*The capacity is rounded up to power of 2.*/
+    for (u32Index = 0; (u32Index < 128) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+        u32Ret = jf_ringqueue_enqueue(&jrq, &ls_qtiItem[u32Index]);
+
+    if ((u32Ret == JF_ERR_NO_ERROR) &&
+        ((! jf_ringqueue_isFull(&jrq)) ||
+         (jf_ringqueue_enqueue(&jrq, &ls_qtiItem[0]) != JF_ERR_BUFFER_IS_FULL)))
+    {
+        ol_printf("ringqueue: queue with 128 items is not full\n");
+        u32Ret = JF_ERR_INVALID_DATA;
+    }
+
+    for (u32Index = 0; (u32Index < 128) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+        u32Ret = _checkQueueTestItem("ringqueue dequeue", jf_ringqueue_dequeue(&jrq), u32Index);
+
+    if ((u32Ret == JF_ERR_NO_ERROR) && (! jf_ringqueue_isEmpty(&jrq)))
+    {
+        ol_printf("ringqueue: queue is not empty\n");
+        u32Ret = JF_ERR_INVALID_DATA;
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = _testRingqueueWrap(&jrq, 0);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = _testRingqueueWrap(&jrq, U32_MAX - 200);
+
+    jf_ringqueue_fini(&jrq);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        ol_printf("ringqueue: items are enqueued and dequeued in order\n");
+
+    return u32Ret;
+}
+
+static u32 _testIstack(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_istack_t jis;
+    jf_stack_link_t * pjsl = NULL;
+    u32 u32Index;
+
+    jf_istack_init(&jis);
+
+    for (u32Index = 0; u32Index < QUEUE_TEST_NUM_OF_ITEM; u32Index ++)
+        jf_istack_push(&jis, &ls_qtiItem[u32Index].qti_jslStack);
+
+    for (u32Index = QUEUE_TEST_NUM_OF_ITEM; (u32Index > 0) && (u32Ret == JF_ERR_NO_ERROR);
+         u32Index --)
+    {
+        u32Ret = _checkQueueTestItem(
+            "istack peek",
+            jf_istack_getEntry(jf_istack_peek(&jis), queue_test_item_t, qti_jslStack),
+            u32Index - 1);
+
+        pjsl = jf_istack_pop(&jis);
+        if (u32Ret == JF_ERR_NO_ERROR)
+            u32Ret = _checkQueueTestItem(
+                "istack pop", jf_istack_getEntry(pjsl, queue_test_item_t, qti_jslStack),
+                u32Index - 1);
+    }
+
+    if ((u32Ret == JF_ERR_NO_ERROR) &&
+        ((! jf_istack_isEmpty(&jis)) || (jf_istack_pop(&jis) != NULL)))
+    {
+        ol_printf("istack: stack is not empty\n");
+        u32Ret = JF_ERR_INVALID_DATA;
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        ol_printf("istack: %u items are pushed and popped in order\n", QUEUE_TEST_NUM_OF_ITEM);
+
+    return u32Ret;
+}
+
+static u32 _testQueue(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Index;
+
+    for (u32Index = 0; u32Index < QUEUE_TEST_NUM_OF_ITEM; u32Index ++)
+        ls_qtiItem[u32Index].qti_u32Index = u32Index;
+
+    u32Ret = _testIqueue();
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = _testRingqueue();
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = _testIstack();
+
+    return u32Ret;
+}
+
+static u32 _benchQueue(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_queue_t jq;
+    jf_iqueue_t jiq;
+    jf_ringqueue_t jrq;
+    u32 u32Round, u32Index;
+    u64 u64Start, u64Queue, u64Iqueue, u64Ringqueue;
+    u64 u64Op = (u64)QUEUE_TEST_BENCH_ROUND * QUEUE_TEST_BENCH_BURST;
+
+    for (u32Index = 0; u32Index < QUEUE_TEST_BENCH_BURST; u32Index ++)
+        ls_qtiItem[u32Index].qti_u32Index = u32Index;
+
+    jf_queue_init(&jq);
+    u64Start = _getQueueTestTime();
+    for (u32Round = 0; (u32Round < QUEUE_TEST_BENCH_ROUND) && (u32Ret == JF_ERR_NO_ERROR);
+         u32Round ++)
+    {
+        for (u32Index = 0; (u32Index < QUEUE_TEST_BENCH_BURST) && (u32Ret == JF_ERR_NO_ERROR);
+             u32Index ++)
+            u32Ret = jf_queue_enqueue(&jq, &ls_qtiItem[u32Index]);
+
+        for (u32Index = 0; (u32Index < QUEUE_TEST_BENCH_BURST) && (u32Ret == JF_ERR_NO_ERROR);
+             u32Index ++)
+            u32Ret = _checkQueueTestItem("queue dequeue", jf_queue_dequeue(&jq), u32Index);
+    }
+    u64Queue = _getQueueTestTime() - u64Start;
+    jf_queue_fini(&jq);
+
+    jf_iqueue_init(&jiq);
+    u64Start = _getQueueTestTime();
+    for (u32Round = 0; (u32Round < QUEUE_TEST_BENCH_ROUND) && (u32Ret == JF_ERR_NO_ERROR);
+         u32Round ++)
+    {
+        for (u32Index = 0; u32Index < QUEUE_TEST_BENCH_BURST; u32Index ++)
+            jf_iqueue_enqueue(&jiq, &ls_qtiItem[u32Index].qti_jqlQueue);
+
+        for (u32Index = 0; (u32Index < QUEUE_TEST_BENCH_BURST) && (u32Ret == JF_ERR_NO_ERROR);
+             u32Index ++)
+            u32Ret = _checkQueueTestItem("iqueue dequeue", _dequeueQueueTestItem(&jiq), u32Index);
+    }
+    u64Iqueue = _getQueueTestTime() - u64Start;
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = jf_ringqueue_init(&jrq, QUEUE_TEST_BENCH_BURST);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        u64Start = _getQueueTestTime();
+        for (u32Round = 0; (u32Round < QUEUE_TEST_BENCH_ROUND) && (u32Ret == JF_ERR_NO_ERROR);
+             u32Round ++)
+        {
+            for (u32Index = 0; (u32Index < QUEUE_TEST_BENCH_BURST) && (u32Ret == JF_ERR_NO_ERROR);
+                 u32Index ++)
+                u32Ret = jf_ringqueue_enqueue(&jrq, &ls_qtiItem[u32Index]);
+
+            for (u32Index = 0; (u32Index < QUEUE_TEST_BENCH_BURST) && (u32Ret == JF_ERR_NO_ERROR);
+                 u32Index ++)
+                u32Ret = _checkQueueTestItem(
+                    "ringqueue dequeue", jf_ringqueue_dequeue(&jrq), u32Index);
+        }
+        u64Ringqueue = _getQueueTestTime() - u64Start;
+
+        jf_ringqueue_fini(&jrq);
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ol_printf(
+            "%llu items are enqueued and dequeued in burst of %u\n", u64Op,
+            QUEUE_TEST_BENCH_BURST);
+        ol_printf("%-10s %10s %10s\n", "queue", "ms", "ns/item");
+        ol_printf("%-10s %10llu %10llu\n", "queue", u64Queue / 1000000, u64Queue / u64Op);
+        ol_printf("%-10s %10llu %10llu\n", "iqueue", u64Iqueue / 1000000, u64Iqueue / u64Op);
+        ol_printf(
+            "%-10s %10llu %10llu\n", "ringqueue", u64Ringqueue / 1000000, u64Ringqueue / u64Op);
+    }
+
+    return u32Ret;
+}
+
+/* --- public routine section ------------------------------------------------------------------- */
+
+olint_t main(olint_t argc, olchar_t ** argv)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_logger_init_param_t jlipParam;
+    jf_jiukun_init_param_t jjip;
+
+    ol_bzero(&jlipParam, sizeof(jlipParam));
+    jlipParam.jlip_pstrCallerName = "QUEUE-TEST";
+    jlipParam.jlip_bLogToStdout = TRUE;
+    jlipParam.jlip_u8TraceLevel = 3;
+
+    ol_bzero(&jjip, sizeof(jjip));
+    jjip.jjip_sPool = JF_JIUKUN_MAX_POOL_SIZE;
+
+    u32Ret = _parseQueueTestCmdLineParam(argc, argv, &jlipParam);
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        jf_logger_init(&jlipParam);
+
+        u32Ret = jf_jiukun_init(&jjip);
+        if (u32Ret == JF_ERR_NO_ERROR)
+        {
+            if (ls_bQueue)
+            {
+                u32Ret = _testQueue();
+            }
+            else if (ls_bBench)
+            {
+                u32Ret = _benchQueue();
+            }
+            else
+            {
+                ol_printf("No operation is specified !!!!\n\n");
+                _printQueueTestUsage();
+            }
+
+            jf_jiukun_fini();
+        }
+
+        jf_logger_logErrMsg(u32Ret, "Quit");
+        jf_logger_fini();
+    }
+
+    return u32Ret;
+}
+
+/*------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,459 @@
+/**
+ *  @file resolver-test.c
+ *
+ *  @brief Test file for async resolver object in network library.
+ *
+ *  @author Min Zhang
+ *
+ *  @note
+ *  -# A stub DNS server is started in a thread, the resolver sends query to the stub server by
+ *   default.
+ *
+ */
+
+/* --- standard C lib header files -------------------------------------------------------------- */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+/* --- internal header files -------------------------------------------------------------------- */
+#include "jf_basic.h"
+#include "jf_limit.h"
+#include "jf_err.h"
+#include "jf_network.h"
+#include "jf_process.h"
+#include "jf_thread.h"
+#include "jf_time.h"
+#include "jf_jiukun.h"
+#include "jf_option.h"
+
+/* --- private data/data structure section ------------------------------------------------------ */
+
+#define RESOLVER_TEST                 "RESOLVER-TEST"
+
+#define RESOLVER_TEST_STUB_PORT       (51253)
+
+#define RESOLVER_TEST_MAX_MSG_SIZE    (512)
+
+/** The record in stub DNS server.
+ */
+typedef struct
+{
+    const olchar_t * rtsr_pstrName;
+    /**The rcode in response.*/
+    u8 rtsr_u8Rcode;
+    /**Don't send response if it's TRUE.*/
+    boolean_t rtsr_bNoResponse;
+    u16 rtsr_u16NumOfAddr;
+    u32 rtsr_u32Ttl;
+    u8 rtsr_u8Addr[2][4];
+} resolver_test_stub_record_t;
+
+static resolver_test_stub_record_t ls_rtsrStubRecord[] =
+{
+    {"www.jiufeng.test", 0, FALSE, 2, 60, {{10, 0, 0, 1}, {10, 0, 0, 2}}},
+    {"ftp.jiufeng.test", 0, FALSE, 1, 60, {{10, 0, 0, 3}}},
+    {"nx.jiufeng.test", 3, FALSE, 0, 0, {{0}}},
+    {"fail.jiufeng.test", 2, FALSE, 0, 0, {{0}}},
+    {"slow.jiufeng.test", 0, TRUE, 0, 0, {{0}}},
+};
+
+static const olchar_t * ls_pstrRtName[] =
+{
+    "192.168.1.1",
+    "localhost",
+    "www.jiufeng.test",
+    "www.jiufeng.test.",
+    "ftp.jiufeng.test",
+    "nx.jiufeng.test",
+    "fail.jiufeng.test",
+    "slow.jiufeng.test",
+    "unknown.jiufeng.test",
+};
+
+static jf_network_chain_t * ls_pjncRtChain = NULL;
+
+static jf_network_resolver_t * ls_pjnrRtResolver = NULL;
+
+static boolean_t ls_bToTerminateRt = FALSE;
+
+static olchar_t * ls_pstrRtHostName = NULL;
+
+static u32 ls_u32RtPendingResult = 0;
+
+static u32 ls_u32RtStubQuery = 0;
+
+/* --- private routine section ------------------------------------------------------------------ */
+
+static void _printResolverTestUsage(void)
+{
+    ol_printf("\
+Usage: resolver-test [-n name] [-h] [logger options] \n\
+    -n resolve the host name with the name server in resolv.conf.\n\
+    -h print the usage.\n\
+    By default, the resolver sends query to a stub DNS server.\n\
+logger options:\n\
+    -T <0|1|2|3|4> the log level. 0: no log, 1: error, 2: info, 3: debug, 4: data.\n\
+    -F <log file> the log file.\n\
+    -S <log file size> the size of log file. No limit if not specified.\n\
+    ");
+
+    ol_printf("\n");
+
+    exit(0);
+}
+
+static u32 _parseResolverTestCmdLineParam(
+    olint_t argc, olchar_t ** argv, jf_logger_init_param_t * pjlip)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    olint_t nOpt;
+
+    while (((nOpt = getopt(argc, argv, "n:T:F:S:h")) != -1) &&
+           (u32Ret == JF_ERR_NO_ERROR))
+    {
+        switch (nOpt)
+        {
+        case '?':
+        case 'h':
+            _printResolverTestUsage();
+            exit(0);
+            break;
+        case 'n':
+            ls_pstrRtHostName = optarg;
+            break;
+        case ':':
+            u32Ret = JF_ERR_MISSING_PARAM;
+            break;
+        case 'T':
+            u32Ret = jf_option_getU8FromString(optarg, &pjlip->jlip_u8TraceLevel);
+            break;
+        case 'F':
+            pjlip->jlip_bLogToFile = TRUE;
+            pjlip->jlip_pstrLogFilePath = optarg;
+            break;
+        case 'S':
+            u32Ret = jf_option_getS32FromString(optarg, &pjlip->jlip_sLogFile);
+            break;
+        default:
+            u32Ret = JF_ERR_INVALID_OPTION;
+            break;
+        }
+    }
+
+    return u32Ret;
+}
+
+static void _terminate(olint_t signal)
+{
+    ol_printf("get signal\n");
+
+    if (ls_pjncRtChain != NULL)
+        jf_network_stopChain(ls_pjncRtChain);
+
+    ls_bToTerminateRt = TRUE;
+}
+
+static resolver_test_stub_record_t * _findStubRecord(const olchar_t * pstrName)
+{
+    u32 u32Index = 0;
+
+    for (u32Index = 0; u32Index < JF_BASIC_ARRAY_SIZE(ls_rtsrStubRecord); u32Index ++)
+        if (ol_strcasecmp(ls_rtsrStubRecord[u32Index].rtsr_pstrName, pstrName) == 0)
+            return &ls_rtsrStubRecord[u32Index];
+
+    return NULL;
+}
+
+/** Build the response for the query, the query contains one question without compression.
+ */
+static boolean_t _buildStubResponse(u8 * pu8Msg, olsize_t * psMsg)
+{
+    olchar_t strName[JF_NETWORK_RESOLVER_MAX_HOST_NAME_LEN];
+    olsize_t sOffset = 12, sName = 0;
+    resolver_test_stub_record_t * prtsr = NULL;
+    u8 u8Rcode = 3;
+    u16 u16Index = 0, u16NumOfAddr = 0;
+
+    /*get question name*/
+    while ((sOffset < *psMsg) && (pu8Msg[sOffset] != 0))
+    {
+        if (sName > 0)
+            strName[sName ++] = '.';
+        ol_memcpy(strName + sName, pu8Msg + sOffset + 1, pu8Msg[sOffset]);
+        sName += pu8Msg[sOffset];
+        sOffset += pu8Msg[sOffset] + 1;
+    }
+    strName[sName] = '\0';
+    /*skip the end of name, type and class*/
+    sOffset += 5;
+
+    prtsr = _findStubRecord(strName);
+    if (prtsr != NULL)
+    {
+        if (prtsr->rtsr_bNoResponse)
+            return FALSE;
+
+        u8Rcode = prtsr->rtsr_u8Rcode;
+        /*only A record is supported*/
+        if (pu8Msg[sOffset - 3] == 1)
+            u16NumOfAddr = prtsr->rtsr_u16NumOfAddr;
+    }
+
+    /*QR, RD and RA are set*/
+    pu8Msg[2] = 0x81;
+    pu8Msg[3] = 0x80 | u8Rcode;
+    pu8Msg[6] = 0;
+    pu8Msg[7] = (u8)u16NumOfAddr;
+
+    for (u16Index = 0; u16Index < u16NumOfAddr; u16Index ++)
+    {
+        /*pointer to the question name*/
+        pu8Msg[sOffset ++] = 0xC0;
+        pu8Msg[sOffset ++] = 12;
+        /*type A, class IN*/
+        pu8Msg[sOffset ++] = 0;
+        pu8Msg[sOffset ++] = 1;
+        pu8Msg[sOffset ++] = 0;
+        pu8Msg[sOffset ++] = 1;
+        /*TTL*/
+        pu8Msg[sOffset ++] = (u8)(prtsr->rtsr_u32Ttl >> 24);
+        pu8Msg[sOffset ++] = (u8)(prtsr->rtsr_u32Ttl >> 16);
+        pu8Msg[sOffset ++] = (u8)(prtsr->rtsr_u32Ttl >> 8);
+        pu8Msg[sOffset ++] = (u8)prtsr->rtsr_u32Ttl;
+        /*rdata*/
+        pu8Msg[sOffset ++] = 0;
+        pu8Msg[sOffset ++] = 4;
+        ol_memcpy(pu8Msg + sOffset, prtsr->rtsr_u8Addr[u16Index], 4);
+        sOffset += 4;
+    }
+
+    *psMsg = sOffset;
+
+    return TRUE;
+}
+
+JF_THREAD_RETURN_VALUE _rtStubServerThread(void * pArg)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_network_socket_t * pSocket = NULL;
+    jf_ipaddr_t jiAddr, jiRemote;
+    u16 u16Port = RESOLVER_TEST_STUB_PORT, u16RemotePort = 0;
+    u8 u8Msg[RESOLVER_TEST_MAX_MSG_SIZE];
+    olsize_t sMsg = 0;
+
+    ol_printf("stub DNS server starts\n");
+
+    jf_ipaddr_getIpAddrFromString("127.0.0.1", JF_IPADDR_TYPE_V4, &jiAddr);
+
+    u32Ret = jf_network_createDgramSocket(&jiAddr, &u16Port, &pSocket);
+    while ((u32Ret == JF_ERR_NO_ERROR) && (! ls_bToTerminateRt))
+    {
+        sMsg = sizeof(u8Msg);
+        if ((jf_network_recvfromWithTimeout(
+                 pSocket, u8Msg, &sMsg, 1, &jiRemote, &u16RemotePort) == JF_ERR_NO_ERROR) &&
+            (sMsg > 12))
+        {
+            ls_u32RtStubQuery ++;
+
+            if (_buildStubResponse(u8Msg, &sMsg))
+                jf_network_sendto(pSocket, u8Msg, &sMsg, &jiRemote, u16RemotePort);
+        }
+    }
+
+    if (pSocket != NULL)
+        jf_network_destroySocket(&pSocket);
+
+    JF_THREAD_RETURN(u32Ret);
+}
+
+JF_THREAD_RETURN_VALUE _rtChainThread(void * pArg)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_network_resolver_create_param_t jnrcp;
+
+    ol_printf("resolver chain starts\n");
+
+    u32Ret = jf_network_createChain(&ls_pjncRtChain);
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ol_bzero(&jnrcp, sizeof(jnrcp));
+        jnrcp.jnrcp_pstrName = RESOLVER_TEST;
+
+        if (ls_pstrRtHostName == NULL)
+        {
+            /*use the stub DNS server*/
+            jf_ipaddr_getIpAddrFromString(
+                "127.0.0.1", JF_IPADDR_TYPE_V4, &jnrcp.jnrcp_jiServer);
+            jnrcp.jnrcp_u16ServerPort = RESOLVER_TEST_STUB_PORT;
+            jnrcp.jnrcp_u32Timeout = 1;
+            jnrcp.jnrcp_u32Attempts = 2;
+        }
+
+        u32Ret = jf_network_createResolver(ls_pjncRtChain, &ls_pjnrRtResolver, &jnrcp);
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        u32Ret = jf_network_startChain(ls_pjncRtChain);
+    }
+
+    if (ls_pjnrRtResolver != NULL)
+        jf_network_destroyResolver(&ls_pjnrRtResolver);
+
+    if (ls_pjncRtChain != NULL)
+        jf_network_destroyChain(&ls_pjncRtChain);
+
+    JF_THREAD_RETURN(u32Ret);
+}
+
+static u32 _onRtResult(
+    const olchar_t * pstrName, u32 u32Status, jf_ipaddr_t * pjiAddr, u16 u16NumOfAddr,
+    void * pUser)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u16 u16Index = 0;
+    olchar_t strAddr[64];
+
+    ol_printf("resolve %s, %s\n", pstrName, jf_err_getDescription(u32Status));
+
+    for (u16Index = 0; u16Index < u16NumOfAddr; u16Index ++)
+    {
+        if (jf_ipaddr_getStringIpAddr(strAddr, &pjiAddr[u16Index]) == JF_ERR_NO_ERROR)
+            ol_printf("    %s\n", strAddr);
+    }
+
+    ls_u32RtPendingResult --;
+
+    return u32Ret;
+}
+
+static u32 _resolveRtHostName(const olchar_t * pstrName)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+
+    ls_u32RtPendingResult ++;
+
+    u32Ret = jf_network_resolveHostName(
+        ls_pjnrRtResolver, pstrName, JF_IPADDR_TYPE_V4, _onRtResult, NULL);
+    if (u32Ret != JF_ERR_NO_ERROR)
+        ls_u32RtPendingResult --;
+
+    return u32Ret;
+}
+
+static void _waitRtResult(void)
+{
+    while ((ls_u32RtPendingResult > 0) && (! ls_bToTerminateRt))
+        jf_time_milliSleep(100);
+}
+
+static u32 _testResolver(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Index = 0, u32Query = 0;
+
+    if (ls_pstrRtHostName != NULL)
+    {
+        u32Ret = _resolveRtHostName(ls_pstrRtHostName);
+        if (u32Ret == JF_ERR_NO_ERROR)
+            _waitRtResult();
+
+        return u32Ret;
+    }
+
+    ol_printf("----- first round -----\n");
+    for (u32Index = 0;
+         (u32Ret == JF_ERR_NO_ERROR) && (u32Index < JF_BASIC_ARRAY_SIZE(ls_pstrRtName));
+         u32Index ++)
+        u32Ret = _resolveRtHostName(ls_pstrRtName[u32Index]);
+
+    _waitRtResult();
+    u32Query = ls_u32RtStubQuery;
+    ol_printf("number of queries to stub server: %u\n", u32Query);
+
+    /*the positive and negative results are cached*/
+    ol_printf("----- second round -----\n");
+    for (u32Index = 0;
+         (u32Ret == JF_ERR_NO_ERROR) && (u32Index < JF_BASIC_ARRAY_SIZE(ls_pstrRtName));
+         u32Index ++)
+        u32Ret = _resolveRtHostName(ls_pstrRtName[u32Index]);
+
+    _waitRtResult();
+    ol_printf("number of queries to stub server: %u\n", ls_u32RtStubQuery - u32Query);
+
+    return u32Ret;
+}
+
+/* --- public routine section ------------------------------------------------------------------- */
+
+olint_t main(olint_t argc, olchar_t ** argv)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    olchar_t strErrMsg[300];
+    jf_logger_init_param_t jlipParam;
+    jf_thread_id_t chainthreadid, stubthreadid;
+    u32 u32RetCode = 0;
+    jf_jiukun_init_param_t jjip;
+
+    ol_bzero(&jlipParam, sizeof(jlipParam));
+    jlipParam.jlip_pstrCallerName = RESOLVER_TEST;
+    jlipParam.jlip_bLogToStdout = TRUE;
+    jlipParam.jlip_u8TraceLevel = JF_LOGGER_TRACE_LEVEL_ERROR;
+
+    ol_bzero(&jjip, sizeof(jjip));
+    jjip.jjip_sPool = JF_JIUKUN_MAX_POOL_SIZE;
+
+    u32Ret = _parseResolverTestCmdLineParam(argc, argv, &jlipParam);
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        jf_logger_init(&jlipParam);
+
+        u32Ret = jf_jiukun_init(&jjip);
+        if (u32Ret == JF_ERR_NO_ERROR)
+        {
+            u32Ret = jf_process_initSocket();
+            if (u32Ret == JF_ERR_NO_ERROR)
+            {
+                u32Ret = jf_process_registerSignalHandlers(_terminate);
+                if (u32Ret == JF_ERR_NO_ERROR)
+                    u32Ret = jf_thread_create(&stubthreadid, NULL, _rtStubServerThread, NULL);
+
+                if (u32Ret == JF_ERR_NO_ERROR)
+                    u32Ret = jf_thread_create(&chainthreadid, NULL, _rtChainThread, NULL);
+
+                if (u32Ret == JF_ERR_NO_ERROR)
+                {
+                    jf_time_sleep(1);
+
+                    u32Ret = _testResolver();
+
+                    if (ls_pjncRtChain != NULL)
+                        jf_network_stopChain(ls_pjncRtChain);
+                    ls_bToTerminateRt = TRUE;
+
+                    jf_thread_waitForThreadTermination(chainthreadid, &u32RetCode);
+                    jf_thread_waitForThreadTermination(stubthreadid, &u32RetCode);
+                }
+
+                jf_process_finiSocket();
+            }
+
+            jf_jiukun_fini();
+        }
+
+        jf_logger_fini();
+    }
+
+    if (u32Ret != JF_ERR_NO_ERROR)
+    {
+        jf_err_getMsg(u32Ret, strErrMsg, 300);
+        ol_printf("%s\n", strErrMsg);
+    }
+
+    return u32Ret;
+}
+
+/*------------------------------------------------------------------------------------------------*/
+
+
@@ -0,0 +1,460 @@
+/**
+ *  @file respool-bench.c
+ *
+ *  @brief Benchmark for getting and putting resource in resource pool by threads.
+ *
+ *  @author Min Zhang
+ *
+ *  @note
+ *  -# Each thread gets resource with timeout, holds it for a while and puts it back. The number of
+ *   threads can be larger than the maximum number of resources, so the threads wait for resource.
+ *  -# The resource has an owner which is set when the resource is got and cleared when it's put,
+ *   the resource handed out to 2 threads at the same time is reported.
+ *
+ */
+
+/* --- standard C lib header files -------------------------------------------------------------- */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+
+/* --- internal header files -------------------------------------------------------------------- */
+#include "jf_basic.h"
+#include "jf_limit.h"
+#include "jf_err.h"
+#include "jf_jiukun.h"
+#include "jf_option.h"
+#include "jf_thread.h"
+#include "jf_time.h"
+#include "jf_atomic.h"
+#include "jf_respool.h"
+
+/* --- private data/data structure section ------------------------------------------------------ */
+
+#define RESPOOL_BENCH                           "RESPOOL-BENCH"
+
+#define RESPOOL_BENCH_DEFAULT_OPERATION         (100000)
+
+#define RESPOOL_BENCH_DEFAULT_THREAD            (8)
+
+#define RESPOOL_BENCH_DEFAULT_MIN_RESOURCES     (2)
+
+#define RESPOOL_BENCH_DEFAULT_MAX_RESOURCES     (4)
+
+#define RESPOOL_BENCH_DEFAULT_HOLD              (100)
+
+#define RESPOOL_BENCH_MAX_THREAD                (64)
+
+#define RESPOOL_BENCH_MAX_RESOURCES             (64)
+
+/** The resource data.
+ */
+typedef struct
+{
+    /**The index plus 1 of the thread holding the resource, 0 if the resource is free.*/
+    volatile u32 rbr_u32Owner;
+    u32 rbr_u32Reserved;
+} respool_bench_resource_t;
+
+/** The resource and the data, the bench thread finds the data by resource.
+ */
+typedef struct
+{
+    void * volatile rbs_pResource;
+    respool_bench_resource_t * volatile rbs_prbrData;
+} respool_bench_slot_t;
+
+/** Benchmark thread.
+ */
+typedef struct
+{
+    jf_thread_id_t rbt_jtiThread;
+    u32 rbt_u32Index;
+    u32 rbt_u32Ret;
+    /**Number of resources got.*/
+    u64 rbt_u64Get;
+    /**Number of get operations which time out.*/
+    u64 rbt_u64Timeout;
+} respool_bench_thread_t;
+
+static u32 ls_u32NumOfOperation = RESPOOL_BENCH_DEFAULT_OPERATION;
+
+static u32 ls_u32NumOfThread = RESPOOL_BENCH_DEFAULT_THREAD;
+
+static u32 ls_u32MinResources = RESPOOL_BENCH_DEFAULT_MIN_RESOURCES;
+
+static u32 ls_u32MaxResources = RESPOOL_BENCH_DEFAULT_MAX_RESOURCES;
+
+static u32 ls_u32Timeout = JF_RESPOOL_WAIT_FOREVER;
+
+static u32 ls_u32Hold = RESPOOL_BENCH_DEFAULT_HOLD;
+
+static jf_respool_t * ls_pjrPool = NULL;
+
+static respool_bench_slot_t ls_rbsSlot[RESPOOL_BENCH_MAX_RESOURCES];
+
+static respool_bench_thread_t ls_rbtThread[RESPOOL_BENCH_MAX_THREAD];
+
+/* --- private routine section ------------------------------------------------------------------ */
+
+static void _printRespoolBenchUsage(void)
+{
+    ol_printf("\
+Usage: respool-bench [-o operations] [-t threads] [-m min resources] [-x max resources]\n\
+    [-w timeout] [-d hold] [-h] [logger options] \n\
+    -o number of operations per thread, %u by default.\n\
+    -t number of threads, %u by default.\n\
+    -m minimum number of resources, %u by default.\n\
+    -x maximum number of resources, %u by default.\n\
+    -w timeout in millisecond for getting resource, wait forever by default.\n\
+    -d number of loops to hold the resource, %u by default.\n\
+    -h print the usage.\n\
+logger options:\n\
+    -T <0|1|2|3|4> the log level. 0: no log, 1: error, 2: info, 3: debug, 4: data.\n\
+    -F <log file> the log file.\n\
+    -S <log file size> the size of log file. No limit if not specified.\n\
+    ", RESPOOL_BENCH_DEFAULT_OPERATION, RESPOOL_BENCH_DEFAULT_THREAD,
+           RESPOOL_BENCH_DEFAULT_MIN_RESOURCES, RESPOOL_BENCH_DEFAULT_MAX_RESOURCES,
+           RESPOOL_BENCH_DEFAULT_HOLD);
+
+    ol_printf("\n");
+
+    exit(0);
+}
+
+static u32 _parseRespoolBenchCmdLineParam(
+    olint_t argc, olchar_t ** argv, jf_logger_init_param_t * pjlip)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    olint_t nOpt;
+
+    while (((nOpt = getopt(argc, argv, "o:t:m:x:w:d:T:F:S:h")) != -1) &&
+           (u32Ret == JF_ERR_NO_ERROR))
+    {
+        switch (nOpt)
+        {
+        case '?':
+        case 'h':
+            _printRespoolBenchUsage();
+            break;
+        case ':':
+            u32Ret = JF_ERR_MISSING_PARAM;
+            break;
+        case 'o':
+            u32Ret = jf_option_getU32FromString(optarg, &ls_u32NumOfOperation);
+            if ((u32Ret == JF_ERR_NO_ERROR) && (ls_u32NumOfOperation == 0))
+                u32Ret = JF_ERR_INVALID_PARAM;
+            break;
+        case 't':
+            u32Ret = jf_option_getU32FromString(optarg, &ls_u32NumOfThread);
+            if ((u32Ret == JF_ERR_NO_ERROR) &&
+                ((ls_u32NumOfThread == 0) || (ls_u32NumOfThread > RESPOOL_BENCH_MAX_THREAD)))
+                u32Ret = JF_ERR_INVALID_PARAM;
+            break;
+        case 'm':
+            u32Ret = jf_option_getU32FromString(optarg, &ls_u32MinResources);
+            break;
+        case 'x':
+            u32Ret = jf_option_getU32FromString(optarg, &ls_u32MaxResources);
+            if ((u32Ret == JF_ERR_NO_ERROR) &&
+                ((ls_u32MaxResources == 0) || (ls_u32MaxResources > RESPOOL_BENCH_MAX_RESOURCES)))
+                u32Ret = JF_ERR_INVALID_PARAM;
+            break;
+        case 'w':
+            u32Ret = jf_option_getU32FromString(optarg, &ls_u32Timeout);
+            break;
+        case 'd':
+            u32Ret = jf_option_getU32FromString(optarg, &ls_u32Hold);
+            break;
+        case 'T':
+            u32Ret = jf_option_getU8FromString(optarg, &pjlip->jlip_u8TraceLevel);
+            break;
+        case 'F':
+            pjlip->jlip_bLogToFile = TRUE;
+            pjlip->jlip_pstrLogFilePath = optarg;
+            break;
+        case 'S':
+            u32Ret = jf_option_getS32FromString(optarg, &pjlip->jlip_sLogFile);
+            break;
+        default:
+            u32Ret = JF_ERR_INVALID_OPTION;
+            break;
+        }
+    }
+
+    return u32Ret;
+}
+
+static u64 _getRespoolBenchTime(void)
+{
+    struct timespec ts;
+
+    jf_time_getClockTime(CLOCK_MONOTONIC, &ts);
+
+    return (u64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/** Create the resource, it's called with the lock of pool held.
+ */
+static u32 _createRespoolBenchResource(
+    jf_respool_resource_t * pjrr, jf_respool_resource_data_t ** ppData)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    respool_bench_resource_t * prbr = NULL;
+    u32 u32Index;
+
+    u32Ret = jf_jiukun_allocMemory((void **)&prbr, sizeof(*prbr));
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ol_bzero(prbr, sizeof(*prbr));
+
+        /*Publish the data before the resource, the reader checks the resource first.*/
+        u32Ret = JF_ERR_REACH_MAX_RESOURCES;
+        for (u32Index = 0; u32Index < RESPOOL_BENCH_MAX_RESOURCES; u32Index ++)
+        {
+            if (jf_atomic_loadPointer((void **)&ls_rbsSlot[u32Index].rbs_pResource) == NULL)
+            {
+                jf_atomic_storePointer((void **)&ls_rbsSlot[u32Index].rbs_prbrData, prbr);
+                jf_atomic_storePointer((void **)&ls_rbsSlot[u32Index].rbs_pResource, pjrr);
+                u32Ret = JF_ERR_NO_ERROR;
+                break;
+            }
+        }
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        *ppData = prbr;
+    else if (prbr != NULL)
+        jf_jiukun_freeMemory((void **)&prbr);
+
+    return u32Ret;
+}
+
+/** Destroy the resource, it's called with the lock of pool held.
+ */
+static u32 _destroyRespoolBenchResource(
+    jf_respool_resource_t * pjrr, jf_respool_resource_data_t ** ppData)
+{
+    u32 u32Index;
+
+    for (u32Index = 0; u32Index < RESPOOL_BENCH_MAX_RESOURCES; u32Index ++)
+    {
+        if (jf_atomic_loadPointer((void **)&ls_rbsSlot[u32Index].rbs_pResource) == pjrr)
+        {
+            jf_atomic_storePointer((void **)&ls_rbsSlot[u32Index].rbs_pResource, NULL);
+            break;
+        }
+    }
+
+    jf_jiukun_freeMemory((void **)ppData);
+
+    return JF_ERR_NO_ERROR;
+}
+
+static respool_bench_resource_t * _findRespoolBenchResource(jf_respool_resource_t * pjrr)
+{
+    u32 u32Index;
+
+    for (u32Index = 0; u32Index < RESPOOL_BENCH_MAX_RESOURCES; u32Index ++)
+    {
+        if (jf_atomic_loadPointer((void **)&ls_rbsSlot[u32Index].rbs_pResource) == pjrr)
+            return jf_atomic_loadPointer((void **)&ls_rbsSlot[u32Index].rbs_prbrData);
+    }
+
+    return NULL;
+}
+
+/** Use the resource, the owner of the resource is checked.
+ */
+static u32 _useRespoolBenchResource(respool_bench_thread_t * prbt, jf_respool_resource_t * pjrr)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    respool_bench_resource_t * prbr = NULL;
+    volatile u32 u32Loop;
+
+    prbr = _findRespoolBenchResource(pjrr);
+    if (prbr == NULL)
+    {
+        ol_printf("Resource %p is not found\n", pjrr);
+        return JF_ERR_INVALID_DATA;
+    }
+
+    if (! jf_atomic_casU32(&prbr->rbr_u32Owner, 0, prbt->rbt_u32Index + 1))
+    {
+        ol_printf(
+            "Resource %p is got by thread %u, it's owned by thread %u\n", pjrr,
+            prbt->rbt_u32Index, jf_atomic_loadU32(&prbr->rbr_u32Owner) - 1);
+        return JF_ERR_INVALID_DATA;
+    }
+
+    for (u32Loop = 0; u32Loop < ls_u32Hold; u32Loop ++)
+        ;
+
+    if (! jf_atomic_casU32(&prbr->rbr_u32Owner, prbt->rbt_u32Index + 1, 0))
+    {
+        ol_printf("Owner of resource %p is changed when it's used\n", pjrr);
+        u32Ret = JF_ERR_INVALID_DATA;
+    }
+
+    return u32Ret;
+}
+
+static JF_THREAD_RETURN_VALUE _benchRespoolThread(void * pArg)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    respool_bench_thread_t * prbt = pArg;
+    jf_respool_resource_t * pjrr = NULL;
+    u32 u32Index;
+
+    for (u32Index = 0; (u32Index < ls_u32NumOfOperation) && (u32Ret == JF_ERR_NO_ERROR);
+         u32Index ++)
+    {
+        u32Ret = jf_respool_getResourceWithTimeout(ls_pjrPool, &pjrr, ls_u32Timeout);
+        if (u32Ret == JF_ERR_NO_ERROR)
+        {
+            prbt->rbt_u64Get ++;
+
+            u32Ret = _useRespoolBenchResource(prbt, pjrr);
+
+            if (u32Ret == JF_ERR_NO_ERROR)
+                u32Ret = jf_respool_putResource(ls_pjrPool, &pjrr);
+        }
+        else if ((u32Ret == JF_ERR_TIMEOUT) || (u32Ret == JF_ERR_REACH_MAX_RESOURCES))
+        {
+            prbt->rbt_u64Timeout ++;
+            u32Ret = JF_ERR_NO_ERROR;
+        }
+    }
+
+    prbt->rbt_u32Ret = u32Ret;
+
+    JF_THREAD_RETURN(u32Ret);
+}
+
+static void _printRespoolBenchResult(u64 u64Time)
+{
+    u64 u64Get = 0, u64Timeout = 0;
+    u32 u32Index;
+    jf_respool_stat_t jrs;
+
+    for (u32Index = 0; u32Index < ls_u32NumOfThread; u32Index ++)
+    {
+        u64Get += ls_rbtThread[u32Index].rbt_u64Get;
+        u64Timeout += ls_rbtThread[u32Index].rbt_u64Timeout;
+    }
+
+    jf_respool_getStat(ls_pjrPool, &jrs);
+
+    ol_printf(
+        "threads: %u, resources: %u-%u, operations per thread: %u\n", ls_u32NumOfThread,
+        ls_u32MinResources, ls_u32MaxResources, ls_u32NumOfOperation);
+    ol_printf(
+        "got: %llu, timeout: %llu, time: %llu ms, ops/s: %llu\n", u64Get, u64Timeout,
+        u64Time / 1000000, (u64Time > 0) ? u64Get * 1000000000 / u64Time : 0);
+    ol_printf(
+        "pool: fulltime %u, parttime %u, busy %u, peak busy %u, waiter %u\n",
+        jrs.jrs_u32NumOfFulltime, jrs.jrs_u32NumOfParttime, jrs.jrs_u32NumOfBusy,
+        jrs.jrs_u32PeakBusy, jrs.jrs_u32NumOfWaiter);
+    ol_printf(
+        "get: %llu, fast get: %llu, wait: %llu, timeout: %llu, wait time: %llu us, "
+        "max wait time: %llu us\n", jrs.jrs_u64NumOfGet, jrs.jrs_u64NumOfFastGet,
+        jrs.jrs_u64NumOfWait, jrs.jrs_u64NumOfTimeout, jrs.jrs_u64WaitTime,
+        jrs.jrs_u64MaxWaitTime);
+}
+
+static u32 _benchRespool(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_respool_create_param_t jrcp;
+    u32 u32Index, u32RetCode, u32NumOfThread = 0;
+    u64 u64Start, u64Time;
+
+    ol_bzero(ls_rbtThread, sizeof(ls_rbtThread));
+    ol_bzero(ls_rbsSlot, sizeof(ls_rbsSlot));
+
+    ol_bzero(&jrcp, sizeof(jrcp));
+    jrcp.jrcp_pstrName = "respool-bench";
+    jrcp.jrcp_u32MinResources = ls_u32MinResources;
+    jrcp.jrcp_u32MaxResources = ls_u32MaxResources;
+    jrcp.jrcp_fnCreateResource = _createRespoolBenchResource;
+    jrcp.jrcp_fnDestroyResource = _destroyRespoolBenchResource;
+
+    u32Ret = jf_respool_create(&ls_pjrPool, &jrcp);
+    if (u32Ret != JF_ERR_NO_ERROR)
+        return u32Ret;
+
+    u64Start = _getRespoolBenchTime();
+
+    for (u32Index = 0; (u32Index < ls_u32NumOfThread) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+    {
+        ls_rbtThread[u32Index].rbt_u32Index = u32Index;
+
+        u32Ret = jf_thread_create(
+            &ls_rbtThread[u32Index].rbt_jtiThread, NULL, _benchRespoolThread,
+            &ls_rbtThread[u32Index]);
+        if (u32Ret == JF_ERR_NO_ERROR)
+            u32NumOfThread ++;
+    }
+
+    for (u32Index = 0; u32Index < u32NumOfThread; u32Index ++)
+    {
+        jf_thread_waitForThreadTermination(ls_rbtThread[u32Index].rbt_jtiThread, &u32RetCode);
+        if ((u32Ret == JF_ERR_NO_ERROR) && (ls_rbtThread[u32Index].rbt_u32Ret != JF_ERR_NO_ERROR))
+            u32Ret = ls_rbtThread[u32Index].rbt_u32Ret;
+    }
+
+    u64Time = _getRespoolBenchTime() - u64Start;
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        _printRespoolBenchResult(u64Time);
+
+    jf_respool_destroy(&ls_pjrPool);
+
+    return u32Ret;
+}
+
+/* --- public routine section ------------------------------------------------------------------- */
+
+olint_t main(olint_t argc, olchar_t ** argv)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    olchar_t strErrMsg[300];
+    jf_logger_init_param_t jlipParam;
+    jf_jiukun_init_param_t jjip;
+
+    ol_bzero(&jlipParam, sizeof(jlipParam));
+    jlipParam.jlip_pstrCallerName = RESPOOL_BENCH;
+    jlipParam.jlip_bLogToStdout = TRUE;
+    jlipParam.jlip_u8TraceLevel = JF_LOGGER_TRACE_LEVEL_ERROR;
+
+    ol_bzero(&jjip, sizeof(jjip));
+    jjip.jjip_sPool = JF_JIUKUN_MAX_POOL_SIZE;
+
+    u32Ret = _parseRespoolBenchCmdLineParam(argc, argv, &jlipParam);
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        jf_logger_init(&jlipParam);
+
+        u32Ret = jf_jiukun_init(&jjip);
+        if (u32Ret == JF_ERR_NO_ERROR)
+        {
+            u32Ret = _benchRespool();
+
+            jf_jiukun_fini();
+        }
+
+        jf_logger_fini();
+    }
+
+    if (u32Ret != JF_ERR_NO_ERROR)
+    {
+        jf_err_getMsg(u32Ret, strErrMsg, sizeof(strErrMsg));
+        ol_printf("%s\n", strErrMsg);
+    }
+
+    return u32Ret;
+}
+
+/*------------------------------------------------------------------------------------------------*/
@@ -6,6 +6,8 @@
  *  @author Min Zhang
  *
  *  @note
+ *  -# The benchmark compares the read-write lock, distributed read-write lock and sequence lock
+ *   with 1..N threads, the readers verify the data protected by lock is consistent.
  *
  */
 
@@ -21,6 +23,8 @@
 #include "jf_rwlock.h"
 #include "jf_process.h"
 #include "jf_thread.h"
+#include "jf_time.h"
+#include "jf_option.h"
 
 /* --- private data/data structure section ------------------------------------------------------ */
 static jf_rwlock_t ls_jrLock;
@@ -29,7 +33,313 @@ static olint_t nRwlock = 0;
 
 #define MAX_RESOURCE_COUNT  1
 
+#define RWLOCK_BENCH_MAX_THREAD              (64)
+
+#define RWLOCK_BENCH_DEFAULT_THREAD          (4)
+
+#define RWLOCK_BENCH_DEFAULT_OPERATION       (1000000)
+
+/** Default number of write operations per 1000 operations.
+ */
+#define RWLOCK_BENCH_DEFAULT_WRITE           (1)
+
+/** Number of words in the data protected by lock, all words have the same value.
+ */
+#define RWLOCK_BENCH_NUM_OF_WORD             (4)
+
+typedef enum
+{
+    RWLOCK_BENCH_LOCK_RWLOCK = 0,
+    RWLOCK_BENCH_LOCK_DRWLOCK,
+    RWLOCK_BENCH_LOCK_SEQLOCK,
+} rwlock_bench_lock_t;
+
+/** Benchmark thread.
+ */
+typedef struct
+{
+    jf_thread_id_t rbt_jtiThread;
+    u32 rbt_u32Index;
+    u32 rbt_u32Ret;
+    /**Number of inconsistent data read.*/
+    u32 rbt_u32Inconsistent;
+    u32 rbt_u32Reserved;
+    u64 rbt_u64Read;
+    u64 rbt_u64Write;
+} rwlock_bench_thread_t;
+
+static olchar_t * ls_pstrBenchLock[] =
+{
+    "rwlock",
+    "drwlock",
+    "seqlock",
+};
+
+static boolean_t ls_bBench = FALSE;
+
+static u32 ls_u32MaxThread = RWLOCK_BENCH_DEFAULT_THREAD;
+
+static u32 ls_u32NumOfOperation = RWLOCK_BENCH_DEFAULT_OPERATION;
+
+static u32 ls_u32WritePerMille = RWLOCK_BENCH_DEFAULT_WRITE;
+
+static u8 ls_u8BenchLock = RWLOCK_BENCH_LOCK_RWLOCK;
+
+static u32 ls_u32NumOfThread = 0;
+
+static jf_drwlock_t ls_jdLock;
+
+static jf_seqlock_t ls_jsLock;
+
+static u64 ls_u64Data[RWLOCK_BENCH_NUM_OF_WORD];
+
+static rwlock_bench_thread_t ls_rbtThread[RWLOCK_BENCH_MAX_THREAD];
+
 /* --- private routine section ------------------------------------------------------------------ */
+
+static void _printRwlockTestUsage(void)
+{
+    ol_printf("\
+Usage: rwlock-test [-b] [-t <max thread>] [-o <operations>] [-w <writes>] [-h]\n\
+  -b benchmark read-write lock, distributed read-write lock and sequence lock.\n\
+  -t maximum number of threads, the benchmark runs with 1, 2, 4 ... threads, default %u.\n\
+  -o number of operations per thread, default %u.\n\
+  -w number of write operations per 1000 operations, default %u.\n\
+Without option, the producer and consumers run with read-write lock for 30 seconds.\n",
+        RWLOCK_BENCH_DEFAULT_THREAD, RWLOCK_BENCH_DEFAULT_OPERATION, RWLOCK_BENCH_DEFAULT_WRITE);
+
+    ol_printf("\n");
+}
+
+static u32 _parseRwlockTestCmdLineParam(olint_t argc, olchar_t ** argv)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    olint_t nOpt;
+
+    while (((nOpt = getopt(argc, argv, "bt:o:w:h")) != -1) && (u32Ret == JF_ERR_NO_ERROR))
+    {
+        switch (nOpt)
+        {
+        case '?':
+        case 'h':
+            _printRwlockTestUsage();
+            exit(0);
+            break;
+        case 'b':
+            ls_bBench = TRUE;
+            break;
+        case 't':
+            u32Ret = jf_option_getU32FromString(optarg, &ls_u32MaxThread);
+            if ((u32Ret == JF_ERR_NO_ERROR) &&
+                ((ls_u32MaxThread == 0) || (ls_u32MaxThread > RWLOCK_BENCH_MAX_THREAD)))
+                u32Ret = JF_ERR_INVALID_PARAM;
+            break;
+        case 'o':
+            u32Ret = jf_option_getU32FromString(optarg, &ls_u32NumOfOperation);
+            break;
+        case 'w':
+            u32Ret = jf_option_getU32FromString(optarg, &ls_u32WritePerMille);
+            if ((u32Ret == JF_ERR_NO_ERROR) && (ls_u32WritePerMille > 1000))
+                u32Ret = JF_ERR_INVALID_PARAM;
+            break;
+        default:
+            u32Ret = JF_ERR_INVALID_OPTION;
+            break;
+        }
+    }
+
+    return u32Ret;
+}
+
+static u64 _getRwlockBenchTime(void)
+{
+    struct timespec ts;
+
+    jf_time_getClockTime(CLOCK_MONOTONIC, &ts);
+
+    return (u64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static boolean_t _isRwlockBenchDataConsistent(u64 * pu64Data)
+{
+    u32 u32Index;
+
+    for (u32Index = 1; u32Index < RWLOCK_BENCH_NUM_OF_WORD; u32Index ++)
+        if (pu64Data[u32Index] != pu64Data[0])
+            return FALSE;
+
+    return TRUE;
+}
+
+static void _writeRwlockBenchData(u64 * pu64Data)
+{
+    u32 u32Index;
+    u64 u64Value = pu64Data[0] + 1;
+
+    for (u32Index = 0; u32Index < RWLOCK_BENCH_NUM_OF_WORD; u32Index ++)
+        pu64Data[u32Index] = u64Value;
+}
+
+static void _readRwlockBench(rwlock_bench_thread_t * prbt)
+{
+    u64 u64Data[RWLOCK_BENCH_NUM_OF_WORD];
+
+    switch (ls_u8BenchLock)
+    {
+    case RWLOCK_BENCH_LOCK_RWLOCK:
+        jf_rwlock_acquireReadlock(&ls_jrLock);
+        ol_memcpy(u64Data, ls_u64Data, sizeof(u64Data));
+        jf_rwlock_releaseReadlock(&ls_jrLock);
+        break;
+    case RWLOCK_BENCH_LOCK_DRWLOCK:
+        jf_drwlock_acquireReadlock(&ls_jdLock);
+        ol_memcpy(u64Data, ls_u64Data, sizeof(u64Data));
+        jf_drwlock_releaseReadlock(&ls_jdLock);
+        break;
+    default:
+        jf_seqlock_readData(&ls_jsLock, u64Data, ls_u64Data, sizeof(u64Data));
+        break;
+    }
+
+    if (! _isRwlockBenchDataConsistent(u64Data))
+        prbt->rbt_u32Inconsistent ++;
+
+    prbt->rbt_u64Read ++;
+}
+
+static void _writeRwlockBench(rwlock_bench_thread_t * prbt)
+{
+    switch (ls_u8BenchLock)
+    {
+    case RWLOCK_BENCH_LOCK_RWLOCK:
+        jf_rwlock_acquireWritelock(&ls_jrLock);
+        _writeRwlockBenchData(ls_u64Data);
+        jf_rwlock_releaseWritelock(&ls_jrLock);
+        break;
+    case RWLOCK_BENCH_LOCK_DRWLOCK:
+        jf_drwlock_acquireWritelock(&ls_jdLock);
+        _writeRwlockBenchData(ls_u64Data);
+        jf_drwlock_releaseWritelock(&ls_jdLock);
+        break;
+    default:
+        jf_seqlock_acquireWritelock(&ls_jsLock);
+        _writeRwlockBenchData(ls_u64Data);
+        jf_seqlock_releaseWritelock(&ls_jsLock);
+        break;
+    }
+
+    prbt->rbt_u64Write ++;
+}
+
+static JF_THREAD_RETURN_VALUE _benchRwlockThread(void * pArg)
+{
+    rwlock_bench_thread_t * prbt = pArg;
+    u32 u32Index;
+
+    /*The writes are spread evenly over operations, the threads start with different offset.*/
+    for (u32Index = 0; u32Index < ls_u32NumOfOperation; u32Index ++)
+    {
+        if ((u32Index + prbt->rbt_u32Index * 97) % 1000 < ls_u32WritePerMille)
+            _writeRwlockBench(prbt);
+        else
+            _readRwlockBench(prbt);
+    }
+
+    JF_THREAD_RETURN(prbt->rbt_u32Ret);
+}
+
+static u32 _benchRwlock(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Index, u32RetCode, u32NumOfThread = 0, u32Inconsistent = 0;
+    u64 u64Start, u64Time, u64Read = 0, u64Write = 0;
+
+    ol_bzero(ls_rbtThread, sizeof(ls_rbtThread));
+    ol_bzero(ls_u64Data, sizeof(ls_u64Data));
+
+    u64Start = _getRwlockBenchTime();
+
+    for (u32Index = 0; (u32Index < ls_u32NumOfThread) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+    {
+        ls_rbtThread[u32Index].rbt_u32Index = u32Index;
+
+        u32Ret = jf_thread_create(
+            &ls_rbtThread[u32Index].rbt_jtiThread, NULL, _benchRwlockThread,
+            &ls_rbtThread[u32Index]);
+        if (u32Ret == JF_ERR_NO_ERROR)
+            u32NumOfThread ++;
+    }
+
+    for (u32Index = 0; u32Index < u32NumOfThread; u32Index ++)
+    {
+        jf_thread_waitForThreadTermination(ls_rbtThread[u32Index].rbt_jtiThread, &u32RetCode);
+
+        u64Read += ls_rbtThread[u32Index].rbt_u64Read;
+        u64Write += ls_rbtThread[u32Index].rbt_u64Write;
+        u32Inconsistent += ls_rbtThread[u32Index].rbt_u32Inconsistent;
+    }
+
+    u64Time = _getRwlockBenchTime() - u64Start;
+
+    /*The value of data is the number of writes.*/
+    if ((u32Ret == JF_ERR_NO_ERROR) &&
+        ((u32Inconsistent != 0) || (ls_u64Data[0] != u64Write) ||
+         ! _isRwlockBenchDataConsistent(ls_u64Data)))
+    {
+        ol_printf(
+            "%s: %u inconsistent reads, data %llu, writes %llu\n",
+            ls_pstrBenchLock[ls_u8BenchLock], u32Inconsistent, ls_u64Data[0], u64Write);
+        u32Ret = JF_ERR_INVALID_DATA;
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        ol_printf(
+            "%-10s %7u %12llu %10llu %8llu %14llu\n", ls_pstrBenchLock[ls_u8BenchLock],
+            ls_u32NumOfThread, u64Read, u64Write, u64Time / 1000000,
+            (u64Time > 0) ? (u64Read + u64Write) * 1000000000 / u64Time : 0);
+
+    return u32Ret;
+}
+
+static u32 _benchRwlockAll(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+
+    u32Ret = jf_rwlock_init(&ls_jrLock);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = jf_drwlock_init(&ls_jdLock);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = jf_seqlock_init(&ls_jsLock);
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ol_printf(
+            "operations per thread: %u, writes per 1000 operations: %u\n", ls_u32NumOfOperation,
+            ls_u32WritePerMille);
+        ol_printf(
+            "%-10s %7s %12s %10s %8s %14s\n", "lock", "threads", "reads", "writes", "ms",
+            "ops/s");
+
+        for (ls_u32NumOfThread = 1;
+             (ls_u32NumOfThread <= ls_u32MaxThread) && (u32Ret == JF_ERR_NO_ERROR);
+             ls_u32NumOfThread *= 2)
+        {
+            for (ls_u8BenchLock = RWLOCK_BENCH_LOCK_RWLOCK;
+                 (ls_u8BenchLock <= RWLOCK_BENCH_LOCK_SEQLOCK) && (u32Ret == JF_ERR_NO_ERROR);
+                 ls_u8BenchLock ++)
+                u32Ret = _benchRwlock();
+        }
+    }
+
+    jf_seqlock_fini(&ls_jsLock);
+    jf_drwlock_fini(&ls_jdLock);
+    jf_rwlock_fini(&ls_jrLock);
+
+    return u32Ret;
+}
+
 JF_THREAD_RETURN_VALUE consumer1(void * pArg)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
@@ -118,8 +428,17 @@ olint_t main(olint_t argc, olchar_t ** argv)
     u32 u32Ret = JF_ERR_NO_ERROR;
     olchar_t strErrMsg[300];
 
-    u32Ret = jf_rwlock_init(&ls_jrLock);
-    if (u32Ret == JF_ERR_NO_ERROR)
+    u32Ret = _parseRwlockTestCmdLineParam(argc, argv);
+    if ((u32Ret == JF_ERR_NO_ERROR) && ls_bBench)
+    {
+        u32Ret = _benchRwlockAll();
+    }
+    else if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        u32Ret = jf_rwlock_init(&ls_jrLock);
+    }
+
+    if ((u32Ret == JF_ERR_NO_ERROR) && (! ls_bBench))
     {
         u32Ret = jf_thread_create(NULL, NULL, producer, (void *)1);
         if (u32Ret == JF_ERR_NO_ERROR)
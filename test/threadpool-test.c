@@ -0,0 +1,476 @@
+/**
+ *  @file threadpool-test.c
+ *
+ *  @brief Test file for work stealing thread pool defined in jf_threadpool object.
+ *
+ *  @author Min Zhang
+ *
+ *  @note
+ *  -# The tasks are submitted by main thread with future and completion callback, the recursive
+ *   tasks are submitted by workers and the parent task waits for the sub-tasks.
+ *  -# The tasks submitted before the pool is destroyed should be executed.
+ *  -# The pool with invalid parameter should not be created.
+ *  -# The benchmark measures the throughput of tasks submitted by main thread and by workers.
+ *
+ */
+
+/* --- standard C lib header files -------------------------------------------------------------- */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* --- internal header files -------------------------------------------------------------------- */
+#include "jf_basic.h"
+#include "jf_limit.h"
+#include "jf_err.h"
+#include "jf_jiukun.h"
+#include "jf_option.h"
+#include "jf_time.h"
+#include "jf_atomic.h"
+#include "jf_threadpool.h"
+
+/* --- private data/data structure section ------------------------------------------------------ */
+
+#define THREADPOOL_TEST_NUM_OF_TASK          (10000)
+
+#define THREADPOOL_TEST_NUM_OF_FUTURE        (1000)
+
+/** The depth of recursive tasks, 2 ^ depth leaf tasks are executed.
+ */
+#define THREADPOOL_TEST_TREE_DEPTH           (12)
+
+#define THREADPOOL_BENCH_NUM_OF_TASK         (200000)
+
+/** The deque size larger than the maximum size of thread pool.
+ */
+#define THREADPOOL_TEST_INVALID_DEQUE_SIZE   (2 * 1024 * 1024)
+
+static boolean_t ls_bTest = FALSE;
+
+static boolean_t ls_bBench = FALSE;
+
+static u32 ls_u32NumOfWorker = 0;
+
+static boolean_t ls_bAffinity = FALSE;
+
+static jf_threadpool_t * ls_pjtPool = NULL;
+
+static volatile u32 ls_u32NumOfCompleted = 0;
+
+static volatile u64 ls_u64SumOfResult = 0;
+
+/* --- private routine section ------------------------------------------------------------------ */
+
+static void _printThreadpoolTestUsage(void)
+{
+    ol_printf("\
+Usage: threadpool-test [-t] [-b] [-w <workers>] [-a] \n\
+    [-T <trace level>] [-F <trace log file>] [-S <trace file size>]\n\
+  -t test thread pool.\n\
+  -b benchmark thread pool.\n\
+  -w number of workers, default is the number of CPUs.\n\
+  -a bind workers to CPUs.\n");
+
+    ol_printf("\n");
+}
+
+static u32 _parseThreadpoolTestCmdLineParam(
+    olint_t argc, olchar_t ** argv, jf_logger_init_param_t * pjlip)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    olint_t nOpt;
+
+    while (((nOpt = getopt(argc, argv, "tbw:aT:F:S:h")) != -1) &&
+           (u32Ret == JF_ERR_NO_ERROR))
+    {
+        switch (nOpt)
+        {
+        case '?':
+        case 'h':
+            _printThreadpoolTestUsage();
+            exit(0);
+            break;
+        case 't':
+            ls_bTest = TRUE;
+            break;
+        case 'b':
+            ls_bBench = TRUE;
+            break;
+        case 'w':
+            u32Ret = jf_option_getU32FromString(optarg, &ls_u32NumOfWorker);
+            break;
+        case 'a':
+            ls_bAffinity = TRUE;
+            break;
+        case 'T':
+            u32Ret = jf_option_getU8FromString(optarg, &pjlip->jlip_u8TraceLevel);
+            break;
+        case 'F':
+            pjlip->jlip_bLogToFile = TRUE;
+            pjlip->jlip_pstrLogFilePath = optarg;
+            break;
+        case 'S':
+            u32Ret = jf_option_getS32FromString(optarg, &pjlip->jlip_sLogFile);
+            break;
+        default:
+            u32Ret = JF_ERR_INVALID_OPTION;
+            break;
+        }
+    }
+
+    return u32Ret;
+}
+
+static u64 _getThreadpoolTestTime(void)
+{
+    struct timespec ts;
+
+    jf_time_getClockTime(CLOCK_MONOTONIC, &ts);
+
+    return (u64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static u32 _createThreadpoolTestPool(void)
+{
+    jf_threadpool_create_param_t jtcp;
+
+    ol_bzero(&jtcp, sizeof(jtcp));
+    jtcp.jtcp_u32NumOfWorker = ls_u32NumOfWorker;
+    jtcp.jtcp_bAffinity = ls_bAffinity;
+
+    return jf_threadpool_create(&ls_pjtPool, &jtcp);
+}
+
+static u32 _squareThreadpoolTestTask(void * pArg)
+{
+    u32 u32Value = (u32)(ulong)pArg;
+
+    return u32Value * u32Value;
+}
+
+static u32 _emptyThreadpoolTestTask(void * pArg)
+{
+    return JF_ERR_NO_ERROR;
+}
+
+static void _completeThreadpoolTestTask(u32 u32Result, void * pArg)
+{
+    jf_atomic_fetchAddU64(&ls_u64SumOfResult, u32Result);
+    jf_atomic_fetchAddU32(&ls_u32NumOfCompleted, 1);
+}
+
+/** The task splits itself to 2 sub-tasks until the depth is 0, the result is the number of leaf
+ *  tasks. One sub-task is submitted to the pool, the other one is executed by the task.
+ */
+static u32 _treeThreadpoolTestTask(void * pArg)
+{
+    u32 u32Depth = (u32)(ulong)pArg, u32Result = 0, u32Left = 0;
+    jf_threadpool_future_t * pjtf = NULL;
+
+    if (u32Depth == 0)
+        return 1;
+
+    if (jf_threadpool_submitWithFuture(
+            ls_pjtPool, _treeThreadpoolTestTask, (void *)(ulong)(u32Depth - 1), &pjtf) !=
+        JF_ERR_NO_ERROR)
+        return 0;
+
+    u32Result = _treeThreadpoolTestTask((void *)(ulong)(u32Depth - 1));
+
+    jf_threadpool_waitFuture(pjtf, &u32Left);
+    jf_threadpool_destroyFuture(&pjtf);
+
+    return u32Result + u32Left;
+}
+
+static u32 _testThreadpoolFuture(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_threadpool_future_t * pjtf[THREADPOOL_TEST_NUM_OF_FUTURE];
+    u32 u32Index, u32NumOfFuture = 0, u32Result;
+
+    ol_printf("Testing future\n");
+
+    for (u32Index = 0;
+         (u32Index < THREADPOOL_TEST_NUM_OF_FUTURE) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+    {
+        u32Ret = jf_threadpool_submitWithFuture(
+            ls_pjtPool, _squareThreadpoolTestTask, (void *)(ulong)u32Index, &pjtf[u32Index]);
+        if (u32Ret == JF_ERR_NO_ERROR)
+            u32NumOfFuture ++;
+    }
+
+    for (u32Index = 0; u32Index < u32NumOfFuture; u32Index ++)
+    {
+        jf_threadpool_waitFuture(pjtf[u32Index], &u32Result);
+        if ((u32Ret == JF_ERR_NO_ERROR) && (u32Result != u32Index * u32Index))
+        {
+            ol_printf("Wrong result %u of task %u\n", u32Result, u32Index);
+            u32Ret = JF_ERR_INVALID_DATA;
+        }
+
+        jf_threadpool_destroyFuture(&pjtf[u32Index]);
+    }
+
+    return u32Ret;
+}
+
+static u32 _testThreadpoolRecursive(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_threadpool_future_t * pjtf = NULL;
+    u32 u32Result = 0;
+
+    ol_printf("Testing recursive tasks with depth %u\n", THREADPOOL_TEST_TREE_DEPTH);
+
+    u32Ret = jf_threadpool_submitWithFuture(
+        ls_pjtPool, _treeThreadpoolTestTask, (void *)(ulong)THREADPOOL_TEST_TREE_DEPTH, &pjtf);
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        jf_threadpool_waitFuture(pjtf, &u32Result);
+        jf_threadpool_destroyFuture(&pjtf);
+
+        if (u32Result != (1U << THREADPOOL_TEST_TREE_DEPTH))
+        {
+            ol_printf("Wrong number of leaf tasks %u\n", u32Result);
+            u32Ret = JF_ERR_INVALID_DATA;
+        }
+    }
+
+    return u32Ret;
+}
+
+/** The tasks are submitted with completion callback and the pool is destroyed immediately, all
+ *  tasks should be executed before the pool is destroyed.
+ */
+static u32 _testThreadpoolShutdown(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Index, u32NumOfTask = 0;
+    u64 u64Sum = 0;
+
+    ol_printf("Testing completion callback and shutdown\n");
+
+    ls_u32NumOfCompleted = 0;
+    ls_u64SumOfResult = 0;
+
+    for (u32Index = 0;
+         (u32Index < THREADPOOL_TEST_NUM_OF_TASK) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+    {
+        u32Ret = jf_threadpool_submit(
+            ls_pjtPool, _squareThreadpoolTestTask, (void *)(ulong)u32Index,
+            _completeThreadpoolTestTask, NULL);
+        if (u32Ret == JF_ERR_NO_ERROR)
+        {
+            u64Sum += u32Index * u32Index;
+            u32NumOfTask ++;
+        }
+    }
+
+    jf_threadpool_destroy(&ls_pjtPool);
+
+    if ((u32Ret == JF_ERR_NO_ERROR) &&
+        ((ls_u32NumOfCompleted != u32NumOfTask) || (ls_u64SumOfResult != u64Sum)))
+    {
+        ol_printf(
+            "%u of %u tasks are completed, sum %llu, expected %llu\n", ls_u32NumOfCompleted,
+            u32NumOfTask, ls_u64SumOfResult, u64Sum);
+        u32Ret = JF_ERR_INVALID_DATA;
+    }
+
+    return u32Ret;
+}
+
+/** The pool should not be created if the deque size is too large.
+ */
+static u32 _testThreadpoolInvalidParam(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_threadpool_create_param_t jtcp;
+    jf_threadpool_t * pjt = NULL;
+
+    ol_printf("Testing invalid parameter\n");
+
+    ol_bzero(&jtcp, sizeof(jtcp));
+    jtcp.jtcp_u32NumOfWorker = ls_u32NumOfWorker;
+    jtcp.jtcp_u32DequeSize = THREADPOOL_TEST_INVALID_DEQUE_SIZE;
+
+    u32Ret = jf_threadpool_create(&pjt, &jtcp);
+    if ((u32Ret == JF_ERR_INVALID_PARAM) && (pjt == NULL))
+    {
+        u32Ret = JF_ERR_NO_ERROR;
+    }
+    else
+    {
+        ol_printf("Pool with deque size %u is created\n", jtcp.jtcp_u32DequeSize);
+        if (pjt != NULL)
+            jf_threadpool_destroy(&pjt);
+        u32Ret = JF_ERR_INVALID_DATA;
+    }
+
+    return u32Ret;
+}
+
+static u32 _testThreadpool(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_threadpool_stat_t jts;
+
+    u32Ret = _testThreadpoolInvalidParam();
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = _createThreadpoolTestPool();
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = _testThreadpoolFuture();
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = _testThreadpoolRecursive();
+
+    if (ls_pjtPool != NULL)
+    {
+        jf_threadpool_getStat(ls_pjtPool, &jts);
+        ol_printf(
+            "workers %u, submitted %llu, executed %llu, stolen %llu\n", jts.jts_u32NumOfWorker,
+            jts.jts_u64Submitted, jts.jts_u64Executed, jts.jts_u64Stolen);
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = _testThreadpoolShutdown();
+
+    if (ls_pjtPool != NULL)
+        jf_threadpool_destroy(&ls_pjtPool);
+
+    return u32Ret;
+}
+
+/** Submit the empty tasks from worker.
+ */
+static u32 _submitThreadpoolBenchTask(void * pArg)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Index;
+
+    for (u32Index = 0;
+         (u32Index < THREADPOOL_BENCH_NUM_OF_TASK) && (u32Ret == JF_ERR_NO_ERROR); u32Index ++)
+        u32Ret = jf_threadpool_submit(
+            ls_pjtPool, _emptyThreadpoolTestTask, NULL, _completeThreadpoolTestTask, NULL);
+
+    return u32Ret;
+}
+
+static u32 _benchThreadpool(void)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    u32 u32Index;
+    u64 u64Start, u64External = 0, u64Worker = 0;
+    jf_threadpool_future_t * pjtf = NULL;
+
+    u32Ret = _createThreadpoolTestPool();
+
+    /*The tasks are submitted by main thread to the shared queue.*/
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ls_u32NumOfCompleted = 0;
+        u64Start = _getThreadpoolTestTime();
+
+        for (u32Index = 0;
+             (u32Index < THREADPOOL_BENCH_NUM_OF_TASK) && (u32Ret == JF_ERR_NO_ERROR);
+             u32Index ++)
+            u32Ret = jf_threadpool_submit(
+                ls_pjtPool, _emptyThreadpoolTestTask, NULL, _completeThreadpoolTestTask, NULL);
+
+        while (jf_atomic_loadU32(&ls_u32NumOfCompleted) < THREADPOOL_BENCH_NUM_OF_TASK)
+            jf_time_microSleep(100);
+
+        u64External = _getThreadpoolTestTime() - u64Start;
+    }
+
+    /*The tasks are submitted by worker to its deque and stolen by other workers.*/
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ls_u32NumOfCompleted = 0;
+        u64Start = _getThreadpoolTestTime();
+
+        u32Ret = jf_threadpool_submitWithFuture(
+            ls_pjtPool, _submitThreadpoolBenchTask, NULL, &pjtf);
+        if (u32Ret == JF_ERR_NO_ERROR)
+        {
+            jf_threadpool_waitFuture(pjtf, &u32Ret);
+            jf_threadpool_destroyFuture(&pjtf);
+        }
+
+        while ((u32Ret == JF_ERR_NO_ERROR) &&
+               (jf_atomic_loadU32(&ls_u32NumOfCompleted) < THREADPOOL_BENCH_NUM_OF_TASK))
+            jf_time_microSleep(100);
+
+        u64Worker = _getThreadpoolTestTime() - u64Start;
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        ol_printf("%-20s %10s %10s\n", "submitter", "tasks", "ns/task");
+        ol_printf(
+            "%-20s %10u %10llu\n", "main thread", THREADPOOL_BENCH_NUM_OF_TASK,
+            u64External / THREADPOOL_BENCH_NUM_OF_TASK);
+        ol_printf(
+            "%-20s %10u %10llu\n", "worker", THREADPOOL_BENCH_NUM_OF_TASK,
+            u64Worker / THREADPOOL_BENCH_NUM_OF_TASK);
+    }
+
+    if (ls_pjtPool != NULL)
+        jf_threadpool_destroy(&ls_pjtPool);
+
+    return u32Ret;
+}
+
+/* --- public routine section ------------------------------------------------------------------- */
+
+olint_t main(olint_t argc, olchar_t ** argv)
+{
+    u32 u32Ret = JF_ERR_NO_ERROR;
+    jf_logger_init_param_t jlipParam;
+    jf_jiukun_init_param_t jjip;
+
+    ol_bzero(&jlipParam, sizeof(jlipParam));
+    jlipParam.jlip_pstrCallerName = "THREADPOOL-TEST";
+    jlipParam.jlip_bLogToStdout = TRUE;
+    jlipParam.jlip_u8TraceLevel = 3;
+
+    ol_bzero(&jjip, sizeof(jjip));
+    jjip.jjip_sPool = JF_JIUKUN_MAX_POOL_SIZE;
+
+    u32Ret = _parseThreadpoolTestCmdLineParam(argc, argv, &jlipParam);
+    if (u32Ret == JF_ERR_NO_ERROR)
+    {
+        jf_logger_init(&jlipParam);
+
+        u32Ret = jf_jiukun_init(&jjip);
+        if (u32Ret == JF_ERR_NO_ERROR)
+        {
+            if (ls_bTest)
+            {
+                u32Ret = _testThreadpool();
+            }
+            else if (ls_bBench)
+            {
+                u32Ret = _benchThreadpool();
+            }
+            else
+            {
+                ol_printf("No operation is specified !!!!\n\n");
+                _printThreadpoolTestUsage();
+            }
+
+            jf_jiukun_fini();
+        }
+
+        jf_logger_logErrMsg(u32Ret, "Quit");
+        jf_logger_fini();
+    }
+
+    return u32Ret;
+}
+
+/*------------------------------------------------------------------------------------------------*/
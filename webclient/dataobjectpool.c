@@ -108,7 +108,7 @@ typedef struct internal_webclient_dataobject
 
     jf_httpparser_dataobject_t * iwd_pjhdDataobject;
 
-    jf_queue_t iwd_jqRequest;
+    jf_iqueue_t iwd_jiqRequest;
 
     jf_network_asocket_t * iwd_pjnaConn;
 
@@ -193,16 +193,15 @@ static u32 _destroyWebclientDataobject(webclient_dataobject_t ** ppDataobject)
         jf_httpparser_destroyDataobject(&piwd->iwd_pjhdDataobject);
 
     /*Iterate through all the pending requests.*/
-    piwr = jf_queue_dequeue(&piwd->iwd_jqRequest);
+    piwr = dequeueWebclientRequest(&piwd->iwd_jiqRequest);
     while (piwr != NULL)
     {
         /*If this is a client request, then we need to signal that this request is being aborted.*/
         piwr->iwr_fnOnEvent(NULL, JF_WEBCLIENT_EVENT_HTTP_REQ_DELETED, NULL, piwr->iwr_pUser);
         destroyWebclientRequest(&piwr);
 
-        piwr = jf_queue_dequeue(&piwd->iwd_jqRequest);
+        piwr = dequeueWebclientRequest(&piwd->iwd_jiqRequest);
     }
-    jf_queue_fini(&piwd->iwd_jqRequest);
 
     jf_jiukun_freeMemory((void **)ppDataobject);
 
@@ -265,7 +264,7 @@ static u32 _webclientDataOjectFreeTimerHandler(void * object)
 
     jf_logger_logInfoMsg("webclient free timer handler");
 
-    if (jf_queue_isEmpty(&piwd->iwd_jqRequest))
+    if (jf_iqueue_isEmpty(&piwd->iwd_jiqRequest))
     {
         /*This connection is idle, because there are no pending requests */
         jf_logger_logInfoMsg("webclient free timer handler, queue is empty");
@@ -316,7 +315,7 @@ static boolean_t _isDataobjectRequestInQueue(jf_hsm_event_t * pEvent)
     boolean_t bRet = FALSE;
     internal_webclient_dataobject_t * piwd = (internal_webclient_dataobject_t *)pEvent->jhe_pData;
 
-    if (! jf_queue_isEmpty(&piwd->iwd_jqRequest))
+    if (! jf_iqueue_isEmpty(&piwd->iwd_jiqRequest))
         bRet = TRUE;
 
     return bRet;
@@ -327,7 +326,7 @@ static boolean_t _isEmptyDataobjectRequestQueue(jf_hsm_event_t * pEvent)
     boolean_t bRet = FALSE;
     internal_webclient_dataobject_t * piwd = (internal_webclient_dataobject_t *)pEvent->jhe_pData;
 
-    if (jf_queue_isEmpty(&piwd->iwd_jqRequest))
+    if (jf_iqueue_isEmpty(&piwd->iwd_jiqRequest))
         bRet = TRUE;
 
     return bRet;
@@ -339,7 +338,7 @@ static u32 _fnEventActionSendData(jf_hsm_event_t * pEvent)
     internal_webclient_dataobject_t * piwd = (internal_webclient_dataobject_t *)pEvent->jhe_pData;
     internal_webclient_request_t * piwr = NULL;
 
-    piwr = (internal_webclient_request_t *)jf_queue_peek(&piwd->iwd_jqRequest);
+    piwr = peekWebclientRequest(&piwd->iwd_jiqRequest);
     if (piwr != NULL)
     {
         u32Ret = _sendWebclientRequestData(
@@ -364,7 +363,7 @@ static u32 _webclientDataobjectIdleTimerHandler(void * object)
 
     jf_logger_logInfoMsg("webclient idle timer handler");
 
-    if (jf_queue_isEmpty(&piwd->iwd_jqRequest))
+    if (jf_iqueue_isEmpty(&piwd->iwd_jiqRequest))
     {
         jf_logger_logInfoMsg("webclient idle timer handler, queue is empty");
         /*This connection is idle, because there are no pending requests. We need to close this
@@ -383,7 +382,7 @@ static u32 _fnEventActionDataSent(jf_hsm_event_t * pEvent)
     internal_webclient_dataobject_t * piwd = (internal_webclient_dataobject_t *)pEvent->jhe_pData;
     internal_webclient_request_t * piwr = NULL;
 
-    piwr = (internal_webclient_request_t *)jf_queue_peek(&piwd->iwd_jqRequest);
+    piwr = peekWebclientRequest(&piwd->iwd_jiqRequest);
 
     if (piwd->iwd_u8PipelineFlags == PIPELINE_NO)
     {
@@ -423,7 +422,7 @@ static u32 _fnEventActionDisconnected(jf_hsm_event_t * pEvent)
 
     piwd->iwd_pjnaConn = NULL;
 
-    piwr = jf_queue_peek(&piwd->iwd_jqRequest);
+    piwr = peekWebclientRequest(&piwd->iwd_jiqRequest);
     if (piwr != NULL)
     {
         /*If there are still pending requests, then obviously this server doesn't do persistent
@@ -521,7 +520,7 @@ static u32 _createWebclientDataobject(
     {
         ol_bzero(piwd, sizeof(*piwd));
 
-        jf_queue_init(&piwd->iwd_jqRequest);
+        jf_iqueue_init(&piwd->iwd_jiqRequest);
         ol_memcpy(&piwd->iwd_jiRemote, pjiRemote, sizeof(jf_ipaddr_t));
         piwd->iwd_u16RemotePort = u16Port;
         piwd->iwd_piwdpPool = pPool;
@@ -585,7 +584,7 @@ static u32 _processWebclientRequestSendData(
     if (u32Ret == JF_ERR_NO_ERROR)
     {
         /*Enqueue the request.*/
-        u32Ret = jf_queue_enqueue(&piwd->iwd_jqRequest, piwr);
+        enqueueWebclientRequest(&piwd->iwd_jiqRequest, piwr);
     }
 
     if (u32Ret == JF_ERR_NO_ERROR)
@@ -616,14 +615,14 @@ static u32 _processWebclientRequestDeleteRequest(
     {
         /*Yes, iterate through them.*/
         jf_hashtree_getEntry(&pPool->iwdp_jhDataobject, key, keyLength, (void **)&piwd);
-        piwr = jf_queue_dequeue(&piwd->iwd_jqRequest);
+        piwr = dequeueWebclientRequest(&piwd->iwd_jiqRequest);
         while (piwr != NULL)
         {
             piwr->iwr_fnOnEvent(
                 NULL, JF_WEBCLIENT_EVENT_HTTP_REQ_DELETED, NULL, piwr->iwr_pUser);
             destroyWebclientRequest(&piwr);
 
-            piwr = jf_queue_dequeue(&piwd->iwd_jqRequest);
+            piwr = dequeueWebclientRequest(&piwd->iwd_jiqRequest);
         }
     }
 
@@ -645,7 +644,7 @@ static u32 _finishWebclientDataobjectResponse(internal_webclient_dataobject_t *
 
     jf_httpparser_reinitDataobject(piwd->iwd_pjhdDataobject);
 
-    piwr = jf_queue_dequeue(&piwd->iwd_jqRequest);
+    piwr = dequeueWebclientRequest(&piwd->iwd_jiqRequest);
     destroyWebclientRequest(&piwr);
 
     jf_hsm_initEvent(&event, WDE_DATA_SENT, piwd, NULL);
@@ -682,7 +681,7 @@ static u32 _webclientDataobjectOnData(
         pu8Buffer + *psBeginPointer, sEndPointer - *psBeginPointer,
         "web client data");
 */
-    piwr = (internal_webclient_request_t *)jf_queue_peek(&piwd->iwd_jqRequest);
+    piwr = peekWebclientRequest(&piwd->iwd_jiqRequest);
     if (piwr == NULL)
     {
         jf_logger_logInfoMsg("web client data, no request, ignore");
@@ -886,6 +885,7 @@ u32 createWebclientDataobjectPool(
         ol_bzero(&jnacp, sizeof(jnacp));
         jnacp.jnacp_sInitialBuf = piwdp->iwdp_sBuffer;
         jnacp.jnacp_u32MaxConn = piwdp->iwdp_u32PoolSize;
+        jnacp.jnacp_u8SocketProfile = pwdpcp->wdpcp_u8SocketProfile;
         jnacp.jnacp_fnOnData = _webclientDataobjectOnData;
         jnacp.jnacp_fnOnConnect = _webclientDataobjectOnConnect;
         jnacp.jnacp_fnOnDisconnect = _webclientDataobjectOnDisconnect;
@@ -32,6 +32,9 @@ typedef struct
     u32 wdpcp_u32PoolSize;
     /** buffer size of the session */
     olsize_t wdpcp_sBuffer;
+    /** socket tuning profile of the connection */
+    u8 wdpcp_u8SocketProfile;
+    u8 wdpcp_u8Reserved[7];
 } webclient_dataobject_pool_create_param_t;
 
 /* --- functional routines ---------------------------------------------------------------------- */
@@ -52,7 +52,7 @@ typedef struct internal_webclient
     jf_network_chain_t *iw_pjncChain;
 
     jf_mutex_t iw_jmReqeustQueueLock;
-    jf_queue_t iw_jqReqeustQueue;
+    jf_iqueue_t iw_jiqRequestQueue;
 
     webclient_dataobject_pool_t * iw_pwdpPool;
     
@@ -66,7 +66,7 @@ static u32 _enqueueWebclientRequestToQueue(
     u32 u32Ret = JF_ERR_NO_ERROR;
 
     jf_mutex_acquire(&piw->iw_jmReqeustQueueLock);
-    jf_queue_enqueue(&piw->iw_jqReqeustQueue, piwr);
+    enqueueWebclientRequest(&piw->iw_jiqRequestQueue, piwr);
     jf_mutex_release(&piw->iw_jmReqeustQueueLock);
 
     return u32Ret;
@@ -77,7 +77,7 @@ static internal_webclient_request_t * _dequeueWebclientRequestFromQueue(internal
     internal_webclient_request_t * piwr = NULL;
 
     jf_mutex_acquire(&piw->iw_jmReqeustQueueLock);
-    piwr = jf_queue_dequeue(&piw->iw_jqReqeustQueue);
+    piwr = dequeueWebclientRequest(&piw->iw_jiqRequestQueue);
     jf_mutex_release(&piw->iw_jmReqeustQueueLock);
 
     return piwr;
@@ -88,7 +88,7 @@ static boolean_t _isEmptyWebclientRequestQueue(internal_webclient_t * piw)
     boolean_t bRet = FALSE;
 
     jf_mutex_acquire(&piw->iw_jmReqeustQueueLock);
-    bRet = jf_queue_isEmpty(&piw->iw_jqReqeustQueue);
+    bRet = jf_iqueue_isEmpty(&piw->iw_jiqRequestQueue);
     jf_mutex_release(&piw->iw_jmReqeustQueueLock);
 
     return bRet;
@@ -135,13 +135,17 @@ static boolean_t _isWakeupChainRequired(internal_webclient_t * piw)
     return bWakeup;
 }
 
-static u32 _fnCallbackDestroyWebclientRequest(void ** ppData)
+static void _destroyWebclientRequestQueue(internal_webclient_t * piw)
 {
-    u32 u32Ret = JF_ERR_NO_ERROR;
+    internal_webclient_request_t * piwr = NULL;
 
-    u32Ret = destroyWebclientRequest((internal_webclient_request_t **)ppData);
+    piwr = dequeueWebclientRequest(&piw->iw_jiqRequestQueue);
+    while (piwr != NULL)
+    {
+        destroyWebclientRequest(&piwr);
 
-    return u32Ret;
+        piwr = dequeueWebclientRequest(&piw->iw_jiqRequestQueue);
+    }
 }
 
 /* --- public routine section ------------------------------------------------------------------- */
@@ -154,7 +158,7 @@ u32 jf_webclient_destroy(jf_webclient_t ** ppWebclient)
     if (piw->iw_pwdpPool != NULL)
         destroyWebclientDataobjectPool(&piw->iw_pwdpPool);
 
-    jf_queue_finiQueueAndData(&piw->iw_jqReqeustQueue, _fnCallbackDestroyWebclientRequest);
+    _destroyWebclientRequestQueue(piw);
     jf_mutex_fini(&piw->iw_jmReqeustQueueLock);
 
     jf_jiukun_freeMemory((void **)ppWebclient);
@@ -183,7 +187,7 @@ u32 jf_webclient_create(
         piw->iw_pjncChain = pjnc;
 
         jf_mutex_init(&piw->iw_jmReqeustQueueLock);
-        jf_queue_init(&piw->iw_jqReqeustQueue);
+        jf_iqueue_init(&piw->iw_jiqRequestQueue);
 
         u32Ret = jf_network_appendToChain(pjnc, piw);
     }
@@ -193,6 +197,7 @@ u32 jf_webclient_create(
         wdpcp.wdpcp_u32PoolSize = pjwcp->jwcp_u32PoolSize;
         wdpcp.wdpcp_sBuffer =
             pjwcp->jwcp_sBuffer ? pjwcp->jwcp_sBuffer : WEBCLIENT_INITIAL_BUFFER_SIZE;
+        wdpcp.wdpcp_u8SocketProfile = pjwcp->jwcp_u8SocketProfile;
 
         u32Ret = createWebclientDataobjectPool(pjnc, &piw->iw_pwdpPool, &wdpcp);
     }
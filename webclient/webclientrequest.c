@@ -140,5 +140,30 @@ u32 createWebclientRequestDeleteRequest(
     return u32Ret;
 }
 
+void enqueueWebclientRequest(jf_iqueue_t * pjiq, internal_webclient_request_t * piwr)
+{
+    jf_iqueue_enqueue(pjiq, &piwr->iwr_jqlQueue);
+}
+
+internal_webclient_request_t * dequeueWebclientRequest(jf_iqueue_t * pjiq)
+{
+    jf_queue_link_t * pjql = jf_iqueue_dequeue(pjiq);
+
+    if (pjql == NULL)
+        return NULL;
+
+    return jf_iqueue_getEntry(pjql, internal_webclient_request_t, iwr_jqlQueue);
+}
+
+internal_webclient_request_t * peekWebclientRequest(jf_iqueue_t * pjiq)
+{
+    jf_queue_link_t * pjql = jf_iqueue_peek(pjiq);
+
+    if (pjql == NULL)
+        return NULL;
+
+    return jf_iqueue_getEntry(pjql, internal_webclient_request_t, iwr_jqlQueue);
+}
+
 /*------------------------------------------------------------------------------------------------*/
 
@@ -16,6 +16,7 @@
 /* --- internal header files -------------------------------------------------------------------- */
 #include "jf_basic.h"
 #include "jf_network.h"
+#include "jf_queue.h"
 
 /* --- constant definitions --------------------------------------------------------------------- */
 
@@ -40,6 +41,9 @@ typedef struct internal_webclient_request
 
     void * iwr_pUser;
     jf_webclient_fnOnEvent_t iwr_fnOnEvent;
+
+    /**Link in the request queue, the request is in one queue at a time.*/
+    jf_queue_link_t iwr_jqlQueue;
 } internal_webclient_request_t;
 
 /* --- functional routines ---------------------------------------------------------------------- */
@@ -53,6 +57,12 @@ u32 createWebclientRequestDeleteRequest(
 
 u32 destroyWebclientRequest(internal_webclient_request_t ** ppRequest);
 
+void enqueueWebclientRequest(jf_iqueue_t * pjiq, internal_webclient_request_t * piwr);
+
+internal_webclient_request_t * dequeueWebclientRequest(jf_iqueue_t * pjiq);
+
+internal_webclient_request_t * peekWebclientRequest(jf_iqueue_t * pjiq);
+
 #endif /*WEBCLIENT_REQUEST_H*/
 
 /*------------------------------------------------------------------------------------------------*/
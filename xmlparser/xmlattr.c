@@ -48,41 +48,22 @@ typedef struct internal_xmlparser_xml_attribute
 
 /* --- private routine section ------------------------------------------------------------------ */
 
-static u32 _destroyXmlAttribute(internal_xmlparser_xml_attribute_t ** ppAttribute)
-{
-    u32 u32Ret = JF_ERR_NO_ERROR;
-
-    jf_jiukun_freeMemory((void **)ppAttribute);
-
-    return u32Ret;
-}
-
-static u32 _createXmlAttribute(internal_xmlparser_xml_attribute_t ** ppAttribute)
+/** Create XML attribute from arena, the attribute is freed with the arena.
+ */
+static u32 _createXmlAttribute(
+    internal_xmlparser_xml_attribute_t ** ppAttribute, jf_jiukun_arena_t * pArena)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
     internal_xmlparser_xml_attribute_t * retval = NULL;
 
     *ppAttribute = NULL;
     
-    u32Ret = jf_jiukun_allocMemory((void **)&retval, sizeof(*retval));
+    u32Ret = jf_jiukun_allocArenaMemory(pArena, (void **)&retval, sizeof(*retval));
     if (u32Ret == JF_ERR_NO_ERROR)
     {
         ol_bzero(retval, sizeof(*retval));
-    }
-
-    if (u32Ret == JF_ERR_NO_ERROR)
         *ppAttribute = retval;
-    else if (retval != NULL)
-        _destroyXmlAttribute(&retval);
-
-    return u32Ret;
-}
-
-static u32 _fnFreeXmlAttribute(void ** ppData)
-{
-    u32 u32Ret = JF_ERR_NO_ERROR;
-
-    u32Ret = _destroyXmlAttribute((internal_xmlparser_xml_attribute_t **) ppData);
+    }
 
     return u32Ret;
 }
@@ -128,13 +109,14 @@ static u32 _parseNameAndValueOfOneXmlAttribute(
     return u32Ret;
 }
 
-static u32 _parseOneXmlAttribute(jf_string_parse_result_field_t * field, jf_linklist_t * pLinklist)
+static u32 _parseOneXmlAttribute(
+    jf_string_parse_result_field_t * field, jf_linklist_t * pLinklist, jf_jiukun_arena_t * pArena)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
     internal_xmlparser_xml_attribute_t * retval = NULL;
     jf_string_parse_result_t * pAttr = NULL;
 
-    u32Ret = _createXmlAttribute(&retval);
+    u32Ret = _createXmlAttribute(&retval, pArena);
 
     if (u32Ret == JF_ERR_NO_ERROR)
     {
@@ -166,13 +148,11 @@ static u32 _parseOneXmlAttribute(jf_string_parse_result_field_t * field, jf_link
         /*Append to the end of the list.*/
         u32Ret = jf_linklist_appendTo(pLinklist, (void *)retval);
 
-    if ((u32Ret != JF_ERR_NO_ERROR) && (retval != NULL))
-        _destroyXmlAttribute(&retval);
-
     return u32Ret;
 }
 
-static u32 _parseXmlAttribute(jf_string_parse_result_field_t * field, jf_linklist_t * pLinklist)
+static u32 _parseXmlAttribute(
+    jf_string_parse_result_field_t * field, jf_linklist_t * pLinklist, jf_jiukun_arena_t * pArena)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
 
@@ -186,7 +166,7 @@ static u32 _parseXmlAttribute(jf_string_parse_result_field_t * field, jf_linklis
             continue;
         }
 
-        u32Ret = _parseOneXmlAttribute(field, pLinklist);
+        u32Ret = _parseOneXmlAttribute(field, pLinklist, pArena);
 
         field = field->jsprf_pjsprfNext;
     }
@@ -233,10 +213,12 @@ static u32 _fnCopyXmlAttributeToPtree(jf_linklist_node_t * pNode, void * pArg)
  *
  *  @param pElem [in] The element contain XML attribute.
  *  @param pLinklist [out] The linked list of attributes.
+ *  @param pArena [in] The arena to allocate XML attribute from.
  *
  *  @return The error code.
  */
-u32 parseXmlAttributeList(jf_string_parse_result_t * pElem, jf_linklist_t * pLinklist)
+u32 parseXmlAttributeList(
+    jf_string_parse_result_t * pElem, jf_linklist_t * pLinklist, jf_jiukun_arena_t * pArena)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
     jf_string_parse_result_t * pjspr = NULL;
@@ -260,7 +242,7 @@ u32 parseXmlAttributeList(jf_string_parse_result_t * pElem, jf_linklist_t * pLin
     {
         field = field->jsprf_pjsprfNext;
 
-        u32Ret = _parseXmlAttribute(field, pLinklist);
+        u32Ret = _parseXmlAttribute(field, pLinklist, pArena);
     }
 
     if (pjspr != NULL)
@@ -270,6 +252,9 @@ u32 parseXmlAttributeList(jf_string_parse_result_t * pElem, jf_linklist_t * pLin
 }
 
 /** Frees resources from an attribute list.
+ *
+ *  @note
+ *  -# Only the linked list is freed, the attributes are freed with the arena.
  *
  *  @param pLinklist [in/out] The linked list for XML attributes.
  *
@@ -279,7 +264,7 @@ u32 destroyXmlAttributeList(jf_linklist_t * pLinklist)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
 
-    jf_linklist_finiListAndData(pLinklist, _fnFreeXmlAttribute);
+    jf_linklist_fini(pLinklist);
 
     return u32Ret;
 }
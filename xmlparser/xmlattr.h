@@ -18,6 +18,7 @@
 #include "jf_string.h"
 #include "jf_linklist.h"
 #include "jf_ptree.h"
+#include "jf_jiukun.h"
 
 /* --- constant definitions --------------------------------------------------------------------- */
 
@@ -35,10 +36,12 @@
  *
  *  @param pElem [in] The element containing the XML attribute.
  *  @param pLinklist [in/out] The link list for XML attribute.
+ *  @param pArena [in] The arena to allocate XML attribute from.
  *
  *  @return The error code.
  */
-u32 parseXmlAttributeList(jf_string_parse_result_t * pElem, jf_linklist_t * pLinklist);
+u32 parseXmlAttributeList(
+    jf_string_parse_result_t * pElem, jf_linklist_t * pLinklist, jf_jiukun_arena_t * pArena);
 
 u32 destroyXmlAttributeList(jf_linklist_t * pLinklist);
 
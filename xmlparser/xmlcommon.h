@@ -18,6 +18,7 @@
 #include "jf_xmlparser.h"
 #include "jf_linklist.h"
 #include "jf_ptree.h"
+#include "jf_jiukun.h"
 
 /* --- constant definitions --------------------------------------------------------------------- */
 
@@ -80,7 +81,9 @@ typedef struct internal_xmlparser_xml_doc
     jf_linklist_t ixxd_jlDeclarationAttribute;
     /**The root of the XML node list.*/
     internal_xmlparser_xml_node_t * ixxd_pixxnRoot;
-    u8 ixxd_u8Reserved[32];
+    /**The arena the XML document, nodes and attributes are allocated from.*/
+    jf_jiukun_arena_t * ixxd_pjjaArena;
+    u8 ixxd_u8Reserved[24];
 } internal_xmlparser_xml_doc_t;
 
 /* --- functional routines ---------------------------------------------------------------------- */
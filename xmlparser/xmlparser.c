@@ -28,10 +28,14 @@
 
 /* --- private data/data structure section ------------------------------------------------------ */
 
-
+/** Order of pages for the chunk of the arena used by XML document.
+ */
+#define XML_DOC_ARENA_CHUNK_ORDER          (0)
 
 /* --- private routine section ------------------------------------------------------------------ */
 
+/** Destroy XML node, the node itself is freed with the arena.
+ */
 static u32 _destroyXmlNode(internal_xmlparser_xml_node_t ** ppNode)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
@@ -41,21 +45,21 @@ static u32 _destroyXmlNode(internal_xmlparser_xml_node_t ** ppNode)
     jf_hashtree_fini(&pixxn->ixxn_jhNameSpace);
     destroyXmlAttributeList(&pixxn->ixxn_jlAttribute);
 
-    jf_jiukun_freeMemory((void **)ppNode);
+    *ppNode = NULL;
     
     return u32Ret;
 }
 
 static u32 _createXmlNode(
-    internal_xmlparser_xml_node_t ** ppNode, olchar_t * pstrTagName, olsize_t sTagName,
-    olchar_t * pstrNsTag, olsize_t sNsTag)
+    internal_xmlparser_xml_node_t ** ppNode, jf_jiukun_arena_t * pArena, olchar_t * pstrTagName,
+    olsize_t sTagName, olchar_t * pstrNsTag, olsize_t sNsTag)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
     internal_xmlparser_xml_node_t * pixxn = NULL;
     
     *ppNode = NULL;
 
-    u32Ret = jf_jiukun_allocMemory((void **)&pixxn, sizeof(*pixxn));
+    u32Ret = jf_jiukun_allocArenaMemory(pArena, (void **)&pixxn, sizeof(*pixxn));
     if (u32Ret == JF_ERR_NO_ERROR)
     {
         ol_bzero(pixxn, sizeof(*pixxn));
@@ -106,6 +110,7 @@ static u32 _destroyXmlNodeList(internal_xmlparser_xml_node_t ** ppNode)
  *
  *  @param ppRoot [out] The root of the XML document, it's also the first XML node created.
  *  @param ppCurrent [in/out] The current XML node.
+ *  @param pArena [in] The arena to allocate XML node from.
  *  @param pstrNsTag [in] The element name space tag.
  *  @param sNsTag [in] The size of the element name space tag.
  *  @param pstrTagName [in] The element name tag.
@@ -120,14 +125,14 @@ static u32 _destroyXmlNodeList(internal_xmlparser_xml_node_t ** ppNode)
  */
 static u32 _newXmlNode(
     internal_xmlparser_xml_node_t ** ppRoot, internal_xmlparser_xml_node_t ** ppCurrent,
-    olchar_t * pstrNsTag, olsize_t sNsTag, olchar_t * pstrTagName, olsize_t sTagName,
-    boolean_t bStartTag, boolean_t bEmptyTag, jf_linklist_t * pLinklist,
+    jf_jiukun_arena_t * pArena, olchar_t * pstrNsTag, olsize_t sNsTag, olchar_t * pstrTagName,
+    olsize_t sTagName, boolean_t bStartTag, boolean_t bEmptyTag, jf_linklist_t * pLinklist,
     jf_string_parse_result_field_t * field, jf_string_parse_result_t * pElem)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
     internal_xmlparser_xml_node_t * pixxn = NULL;
 
-    u32Ret = _createXmlNode(&pixxn, pstrTagName, sTagName, pstrNsTag, sNsTag);
+    u32Ret = _createXmlNode(&pixxn, pArena, pstrTagName, sTagName, pstrNsTag, sNsTag);
     if (u32Ret == JF_ERR_NO_ERROR)
     {
         pixxn->ixxn_bStartTag = bStartTag;
@@ -159,7 +164,7 @@ static u32 _newXmlNode(
         {
             /*If this was an empty element, we need to create a bogus end element, just so the
               tree is consistent.*/
-            u32Ret = _createXmlNode(&pixxn, pstrTagName, sTagName, pstrNsTag, sNsTag);
+            u32Ret = _createXmlNode(&pixxn, pArena, pstrTagName, sTagName, pstrNsTag, sNsTag);
             if (u32Ret == JF_ERR_NO_ERROR)
             {
                 pixxn->ixxn_pstrSegment = (*ppCurrent)->ixxn_pstrSegment;
@@ -359,7 +364,8 @@ static u32 _parseXmlDeclaration(
     if (u32Ret == JF_ERR_NO_ERROR)
     {
         /*Parse the attribute in the declaration.*/
-        u32Ret = parseXmlAttributeList(pElem, &pixxd->ixxd_jlDeclarationAttribute);
+        u32Ret = parseXmlAttributeList(
+            pElem, &pixxd->ixxd_jlDeclarationAttribute, pixxd->ixxd_pjjaArena);
     }
 
     if (pElem != NULL)
@@ -397,15 +403,15 @@ static u32 _parseXmlNode(
     {
         jf_linklist_init(&jlAttribute);
 
-        u32Ret = parseXmlAttributeList(pElem, &jlAttribute);
+        u32Ret = parseXmlAttributeList(pElem, &jlAttribute, pixxd->ixxd_pjjaArena);
     }
 
     if ((u32Ret == JF_ERR_NO_ERROR) && (sTagName != 0))
     {
         /*All the tags are linked into the retval with next field in XML node.*/
         u32Ret = _newXmlNode(
-            ppRoot, ppCurrent, nsTag, sNsTag, tagName, sTagName, bStartTag, bEmptyTag,
-            &jlAttribute, field, pElem);
+            ppRoot, ppCurrent, pixxd->ixxd_pjjaArena, nsTag, sNsTag, tagName, sTagName, bStartTag,
+            bEmptyTag, &jlAttribute, field, pElem);
     }
 
     if (pElem != NULL)
@@ -620,6 +626,8 @@ static u32 _copyXmlTreeToPtree(internal_xmlparser_xml_doc_t * pixxd, jf_ptree_t
     return u32Ret;
 }
 
+/** Destroy XML document, the document, nodes and attributes are freed with the arena.
+ */
 static u32 _destroyXmlDoc(internal_xmlparser_xml_doc_t ** ppDoc)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
@@ -630,30 +638,27 @@ static u32 _destroyXmlDoc(internal_xmlparser_xml_doc_t ** ppDoc)
     if (pixxd->ixxd_pixxnRoot != NULL)
         _destroyXmlNodeList(&pixxd->ixxd_pixxnRoot);
 
-    jf_jiukun_freeMemory((void **)ppDoc);
+    *ppDoc = NULL;
 
     return u32Ret;
 }
 
-static u32 _createXmlDoc(internal_xmlparser_xml_doc_t ** ppDoc)
+static u32 _createXmlDoc(internal_xmlparser_xml_doc_t ** ppDoc, jf_jiukun_arena_t * pArena)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
     internal_xmlparser_xml_doc_t * pixxd = NULL;
     
     *ppDoc = NULL;
 
-    u32Ret = jf_jiukun_allocMemory((void **)&pixxd, sizeof(*pixxd));
+    u32Ret = jf_jiukun_allocArenaMemory(pArena, (void **)&pixxd, sizeof(*pixxd));
     if (u32Ret == JF_ERR_NO_ERROR)
     {
         ol_bzero(pixxd, sizeof(*pixxd));
         jf_linklist_init(&pixxd->ixxd_jlDeclarationAttribute);
+        pixxd->ixxd_pjjaArena = pArena;
 
-    }
-
-    if (u32Ret == JF_ERR_NO_ERROR)
         *ppDoc = pixxd;
-    else if (pixxd != NULL)
-        _destroyXmlDoc(&pixxd);
+    }
 
     return u32Ret;
 }
@@ -662,15 +667,34 @@ static u32 _createXmlDoc(internal_xmlparser_xml_doc_t ** ppDoc)
 
 u32 jf_xmlparser_parseXmlDoc(
     olchar_t * pstrBuf, olsize_t sOffset, olsize_t sBuf, jf_ptree_t ** ppPtree)
+{
+    return jf_xmlparser_parseXmlDocInArena(pstrBuf, sOffset, sBuf, NULL, ppPtree);
+}
+
+u32 jf_xmlparser_parseXmlDocInArena(
+    olchar_t * pstrBuf, olsize_t sOffset, olsize_t sBuf, jf_jiukun_arena_t * pArena,
+    jf_ptree_t ** ppPtree)
 {
     u32 u32Ret = JF_ERR_NO_ERROR;
     internal_xmlparser_xml_doc_t * pixxd = NULL;
     jf_ptree_t * pjpXml = NULL;
+    jf_jiukun_arena_t * pjjaDoc = pArena;
+    jf_jiukun_arena_create_param_t jjacp;
 
     *ppPtree = NULL;
     initXmlErrMsg();
 
-    u32Ret = _createXmlDoc(&pixxd);
+    if (pjjaDoc == NULL)
+    {
+        /*Create an arena for the XML document if it's not specified.*/
+        ol_bzero(&jjacp, sizeof(jjacp));
+        jjacp.jjacp_u8ChunkOrder = XML_DOC_ARENA_CHUNK_ORDER;
+
+        u32Ret = jf_jiukun_createArena(&pjjaDoc, &jjacp);
+    }
+
+    if (u32Ret == JF_ERR_NO_ERROR)
+        u32Ret = _createXmlDoc(&pixxd, pjjaDoc);
 
     if (u32Ret == JF_ERR_NO_ERROR)
     {
@@ -717,6 +741,9 @@ u32 jf_xmlparser_parseXmlDoc(
         _destroyXmlDoc(&pixxd);
     }
 
+    if ((pArena == NULL) && (pjjaDoc != NULL))
+        jf_jiukun_destroyArena(&pjjaDoc);
+
     if (u32Ret == JF_ERR_NO_ERROR)
     {
         /*Build XML name space table.*/